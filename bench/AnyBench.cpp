@@ -0,0 +1,77 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAny.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t n = 1 << 16;
+
+    using range_type = IteratorBasedForImpl::any_iterator_range<const std::uint32_t&>;
+
+    /**
+     * @brief Sums an erased range by iterating it, which calls through the table twice per element.
+     */
+    std::uint64_t iterate(const range_type& _range) {
+        std::uint64_t total = 0;
+
+        for (std::uint32_t x : _range) {
+            total += x;
+        }
+
+        return total;
+    }
+
+    std::uint64_t batched(const range_type& _range) {
+        std::uint64_t total = 0;
+        _range.for_each([&total](std::uint32_t x) { total += x; });
+        return total;
+    }
+
+    /**
+     * @brief Registers sums over a vector and a deque, directly and through an any_iterator_range iterated element
+     *        by element or in batches.
+     */
+    template <typename Container>
+    void add_any_cases(std::vector<benchmark_case>& cases, const std::string& container) {
+        auto c = std::make_shared<Container>(n);
+        std::iota(c->begin(), c->end(), 0u);
+        auto range = std::make_shared<range_type>((c->cbegin(), c->cend()));
+
+        cases.push_back({"any_range", container, n, "direct", [c]() {
+            std::uint64_t total = 0;
+
+            for (std::uint32_t x : (c->cbegin(), c->cend())) {
+                total += x;
+            }
+
+            do_not_optimize(total);
+        }});
+
+        cases.push_back({"any_range", container, n, "erased_iteration", [range]() {
+            do_not_optimize(iterate(*range));
+        }});
+
+        cases.push_back({"any_range", container, n, "erased_batches", [range]() {
+            do_not_optimize(batched(*range));
+        }});
+    }
+
+    void register_any_cases(std::vector<benchmark_case>& cases) {
+        add_any_cases<std::vector<std::uint32_t>>(cases, "vector<uint32_t>");
+        add_any_cases<std::deque<std::uint32_t>>(cases, "deque<uint32_t>");
+    }
+
+    registrar any_cases(register_any_cases);
+
+} // namespace
@@ -0,0 +1,54 @@
+#ifndef BenchHarness_H
+#define BenchHarness_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace IteratorBasedForBench
+{
+
+    /**
+     * @brief Prevents the compiler from optimizing away the computation of value without otherwise affecting the
+     *        generated code.
+     */
+    template <typename T>
+    inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const T* sink;
+        sink = &value;
+#endif
+    }
+
+    /**
+     * @brief A single benchmark case. body performs one pass over 'elements' elements and is run repeatedly by the
+     *        harness until enough time has been accumulated.
+     */
+    struct benchmark_case {
+        std::string group;
+        std::string container;
+        std::size_t elements;
+        std::string method;
+        std::function<void()> body;
+    };
+
+    /**
+     * @brief Returns the list of all registered benchmark cases.
+     */
+    std::vector<benchmark_case>& registry();
+
+    /**
+     * @brief Registers the benchmark cases added by the given function at static initialization time.
+     */
+    struct registrar {
+        explicit registrar(void (*_register)(std::vector<benchmark_case>&)) {
+            _register(registry());
+        }
+    };
+
+} // namespace IteratorBasedForBench
+
+#endif // BenchHarness_H
@@ -0,0 +1,396 @@
+#include "BenchHarness.hpp"
+#include "PerfCounters.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace IteratorBasedForBench
+{
+
+    std::vector<benchmark_case>& registry() {
+        static std::vector<benchmark_case> cases;
+        return cases;
+    }
+
+} // namespace IteratorBasedForBench
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using clock_type = std::chrono::steady_clock;
+
+    struct options {
+        std::string filter;
+        double min_time_ms;
+        std::size_t samples;
+        double warmup_ms;
+        int pin;
+        std::string baseline;
+        double threshold;
+        bool update_baseline;
+
+        options() :
+                filter(), min_time_ms(20.0), samples(5), warmup_ms(200.0), pin(-1), baseline(), threshold(10.0),
+                update_baseline(false) {
+        }
+    };
+
+    /**
+     * @brief Median, median absolute deviation and distribution-free 95% confidence interval of the median of the
+     *        times per element of the samples of a case.
+     */
+    struct summary {
+        double min;
+        double median;
+        double mad;
+        double ci_low;
+        double ci_high;
+    };
+
+    double median_of_sorted(const std::vector<double>& _sorted) {
+        std::size_t n = _sorted.size();
+        return n % 2 ? _sorted[n / 2] : (_sorted[n / 2 - 1] + _sorted[n / 2]) / 2.0;
+    }
+
+    /**
+     * @brief Summarizes the sorted times _sorted. The confidence interval lies between the order statistics whose
+     *        ranks are n / 2 -/+ 1.96 sqrt(n) / 2, the normal approximation of the binomial distribution of the number
+     *        of samples below the true median; with few samples it widens to the extreme samples.
+     */
+    summary summarize(const std::vector<double>& _sorted) {
+        std::size_t n = _sorted.size();
+        double half_width = 1.96 * std::sqrt(double(n)) / 2.0;
+        double low_rank = std::floor(double(n) / 2.0 - half_width);
+        double high_rank = std::ceil(double(n) / 2.0 + half_width);
+        std::vector<double> deviations;
+        summary result;
+
+        result.min = _sorted.front();
+        result.median = median_of_sorted(_sorted);
+
+        for (double x : _sorted) {
+            deviations.push_back(std::fabs(x - result.median));
+        }
+
+        std::sort(deviations.begin(), deviations.end());
+        result.mad = median_of_sorted(deviations);
+        result.ci_low = _sorted[low_rank < 1.0 ? 0 : std::size_t(low_rank) - 1];
+        result.ci_high = _sorted[high_rank > double(n) ? n - 1 : std::size_t(high_rank) - 1];
+        return result;
+    }
+
+    std::vector<std::string> split_csv(const std::string& _line) {
+        std::vector<std::string> fields;
+        std::istringstream in(_line);
+        std::string field;
+
+        while (std::getline(in, field, ',')) {
+            fields.push_back(field);
+        }
+
+        return fields;
+    }
+
+    /**
+     * @brief Reads the median time per element of every case from _path, the output of an earlier run, keyed by the
+     *        group/container/elements/method name. Returns false if the file cannot be read or lacks the columns.
+     */
+    bool read_baseline(const std::string& _path, std::map<std::string, double>& _medians) {
+        std::ifstream in(_path);
+        std::string line;
+
+        if (!std::getline(in, line)) {
+            return false;
+        }
+
+        std::vector<std::string> header = split_csv(line);
+        const char* const keys[] = {"group", "container", "elements", "method", "ns_per_element_median"};
+        std::size_t columns[5];
+
+        for (std::size_t k = 0; k < 5; ++k) {
+            auto column = std::find(header.begin(), header.end(), keys[k]);
+
+            if (column == header.end()) {
+                return false;
+            }
+
+            columns[k] = std::size_t(column - header.begin());
+        }
+
+        while (std::getline(in, line)) {
+            std::vector<std::string> fields = split_csv(line);
+
+            if (fields.size() < header.size()) {
+                continue;
+            }
+
+            _medians[fields[columns[0]] + "/" + fields[columns[1]] + "/" + fields[columns[2]] + "/"
+                     + fields[columns[3]]] = std::atof(fields[columns[4]].c_str());
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Keeps the processor the benchmarks run on busy for _ms milliseconds, so that a frequency governor that
+     *        scales with load has raised its clock before the first case is timed.
+     */
+    void warm_up(double _ms) {
+        auto end = clock_type::now() + std::chrono::duration<double, std::milli>(_ms);
+        std::uint64_t x = 1;
+
+        while (clock_type::now() < end) {
+            for (int i = 0; i < 1000; ++i) {
+                x = x * 6364136223846793005u + 1442695040888963407u;
+            }
+        }
+
+        do_not_optimize(x);
+    }
+
+    /**
+     * @brief Pins the calling thread, and the threads it starts later, to processor _cpu, and asks the kernel to keep
+     *        processors out of deep idle states as long as the returned descriptor is open. Warns if the processor's
+     *        frequency governor is not "performance", since its clock then follows the load. Linux only.
+     */
+    int pin_to_cpu(int _cpu) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(_cpu, &set);
+
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            std::cerr << "cannot pin to processor " << _cpu << '\n';
+        }
+
+        std::ifstream governor("/sys/devices/system/cpu/cpu" + std::to_string(_cpu) + "/cpufreq/scaling_governor");
+        std::string name;
+
+        if (governor >> name && name != "performance") {
+            std::cerr << "processor " << _cpu << " uses the " << name << " frequency governor, timings follow its "
+                      << "clock; consider cpupower frequency-set -g performance\n";
+        }
+
+        int latency = ::open("/dev/cpu_dma_latency", O_WRONLY);
+        std::int32_t zero = 0;
+
+        if (latency < 0 || ::write(latency, &zero, sizeof(zero)) != static_cast<ssize_t>(sizeof(zero))) {
+            std::cerr << "cannot set a processor latency target, idle states stay enabled\n";
+        }
+
+        return latency;
+#else
+        std::cerr << "pinning is only supported on Linux, processor " << _cpu << " ignored\n";
+        return -1;
+#endif
+    }
+
+    double time_passes(const benchmark_case& c, std::size_t passes) {
+        auto start = clock_type::now();
+
+        for (std::size_t i = 0; i < passes; ++i) {
+            c.body();
+        }
+
+        return std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+    }
+
+    /**
+     * @brief Finds a number of passes that takes at least min_time_ms to run.
+     */
+    std::size_t calibrate(const benchmark_case& c, double min_time_ms) {
+        std::size_t passes = 1;
+
+        for (;;) {
+            double ns = time_passes(c, passes);
+
+            if (ns >= min_time_ms * 1e6 || passes >= (std::size_t(1) << 30)) {
+                return passes;
+            }
+
+            double scale = ns > 0.0 ? min_time_ms * 1e6 / ns * 1.2 : 10.0;
+            passes = std::max(passes * 2, static_cast<std::size_t>(passes * std::min(scale, 100.0)));
+        }
+    }
+
+    void usage(const char* program) {
+        std::cerr << "usage: " << program << " [--filter <substring>] [--min-time-ms <ms>] [--samples <n>]"
+                  << " [--warmup-ms <ms>] [--pin <cpu>] [--baseline <file> [--threshold <percent>]"
+                  << " [--update-baseline]]\n";
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    options opts;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            opts.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) {
+            opts.min_time_ms = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            opts.samples = static_cast<std::size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--warmup-ms") == 0 && i + 1 < argc) {
+            opts.warmup_ms = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--pin") == 0 && i + 1 < argc) {
+            opts.pin = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            opts.baseline = argv[++i];
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            opts.threshold = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--update-baseline") == 0) {
+            opts.update_baseline = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    bool record_baseline = false;
+
+    if (!opts.baseline.empty()) {
+        record_baseline = opts.update_baseline || !std::ifstream(opts.baseline);
+
+        if (!record_baseline && !read_baseline(opts.baseline, baseline)) {
+            std::cerr << "cannot read the baseline " << opts.baseline << '\n';
+            return 2;
+        }
+
+        if (record_baseline) {
+            std::cerr << "recording this run as the baseline " << opts.baseline << '\n';
+        }
+    }
+
+    int latency = opts.pin >= 0 ? pin_to_cpu(opts.pin) : -1;
+    warm_up(opts.warmup_ms);
+
+    //Machine-readable output: one CSV record per benchmark case. The hardware event columns are left empty where the
+    //event cannot be counted. The statistics of the samples follow them, so that the earlier columns keep their place.
+    std::ostringstream csv;
+    csv << "group,container,elements,method,passes,samples,ns_per_element_min,ns_per_element_median,"
+           "cycles_per_element,instructions_per_element,l1d_misses_per_element,llc_misses_per_element,"
+           "branch_misses_per_element,ipc,ns_per_element_mad,ns_per_element_ci_low,ns_per_element_ci_high\n";
+    std::cout << csv.str();
+
+    perf_counters counters;
+
+    if (!counters.any()) {
+        std::cerr << "hardware performance counters are not available, leaving their columns empty\n";
+    }
+
+    std::size_t regressions = 0;
+
+    for (const benchmark_case& c : registry()) {
+        std::string name = c.group + "/" + c.container + "/" + std::to_string(c.elements) + "/" + c.method;
+
+        if (!opts.filter.empty() && name.find(opts.filter) == std::string::npos) {
+            continue;
+        }
+
+        std::size_t passes = calibrate(c, opts.min_time_ms);
+        double elements = double(passes) * double(std::max<std::size_t>(c.elements, 1));
+        //Time per element of every sample, with the event counts of that sample.
+        std::vector<std::pair<double, perf_sample>> samples;
+
+        for (std::size_t s = 0; s < opts.samples; ++s) {
+            counters.start();
+            double ns = time_passes(c, passes);
+            samples.emplace_back(ns / elements, counters.stop());
+        }
+
+        std::sort(samples.begin(), samples.end(),
+                  [](const std::pair<double, perf_sample>& a, const std::pair<double, perf_sample>& b) {
+                      return a.first < b.first;
+                  });
+
+        std::vector<double> times;
+
+        for (const auto& sample : samples) {
+            times.push_back(sample.first);
+        }
+
+        summary stats = summarize(times);
+        //The event counts are those of the median sample, so they describe the same run as the median time.
+        const perf_sample& median = samples[samples.size() / 2].second;
+        std::ostringstream record;
+
+        record << c.group << ',' << c.container << ',' << c.elements << ',' << c.method << ',' << passes << ','
+               << opts.samples << ',' << stats.min << ',' << stats.median;
+
+        for (std::size_t e = 0; e < perf_event_count; ++e) {
+            record << ',';
+
+            if (median.available[e]) {
+                record << median.counts[e] / elements;
+            }
+        }
+
+        record << ',';
+
+        if (median.available[perf_cycles] && median.available[perf_instructions] && median.counts[perf_cycles] > 0) {
+            record << median.counts[perf_instructions] / median.counts[perf_cycles];
+        }
+
+        record << ',' << stats.mad << ',' << stats.ci_low << ',' << stats.ci_high << '\n';
+        std::cout << record.str() << std::flush;
+        csv << record.str();
+
+        //A case regresses when even the lower end of the confidence interval of its median is slower than the
+        //baseline median by more than the threshold, so that noise within the interval does not fail the run.
+        auto base = baseline.find(name);
+
+        if (base != baseline.end() && base->second > 0.0) {
+            double limit = base->second * (1.0 + opts.threshold / 100.0);
+
+            if (stats.ci_low > limit) {
+                ++regressions;
+                std::cerr << "regression: " << name << " " << stats.median << " ns per element (95% CI "
+                          << stats.ci_low << " to " << stats.ci_high << ") against " << base->second << " in the "
+                          << "baseline, " << (stats.median / base->second - 1.0) * 100.0 << "% slower\n";
+            }
+        }
+    }
+
+#if defined(__linux__)
+    if (latency >= 0) {
+        ::close(latency);
+    }
+#else
+    (void)latency;
+#endif
+
+    if (record_baseline) {
+        std::ofstream out(opts.baseline);
+        out << csv.str();
+
+        if (!out) {
+            std::cerr << "cannot write the baseline " << opts.baseline << '\n';
+            return 2;
+        }
+    } else if (!opts.baseline.empty()) {
+        std::cerr << regressions << " regression(s) beyond " << opts.threshold << "% of the baseline "
+                  << opts.baseline << '\n';
+    }
+
+    return regressions ? 1 : 0;
+}
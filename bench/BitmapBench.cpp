@@ -0,0 +1,71 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t sizes[] = {65536, 1048576};
+
+    /**
+     * @brief Registers counting and visiting the set bits of a sparse std::vector<bool> one bit at a time and a
+     *        word at a time.
+     */
+    void register_bitmap_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto bits = std::make_shared<std::vector<bool>>(n);
+
+            for (std::size_t i = 0; i < n; i += 37) {
+                (*bits)[i] = true;
+            }
+
+            cases.push_back({"bitmap_count", "vector<bool>", n, "range_for", [bits]() {
+                std::size_t result = 0;
+                auto b = bits->cbegin();
+                auto e = bits->cend();
+
+                for (bool x : b, e) {
+                    result += x;
+                }
+
+                do_not_optimize(result);
+            }});
+
+            cases.push_back({"bitmap_count", "vector<bool>", n, "count", [bits]() {
+                do_not_optimize(IteratorBasedForImpl::count((bits->cbegin(), bits->cend()), true));
+            }});
+
+            cases.push_back({"bitmap_scan", "vector<bool>", n, "range_for", [bits]() {
+                std::size_t sum = 0;
+                std::size_t i = 0;
+                auto b = bits->cbegin();
+                auto e = bits->cend();
+
+                for (bool x : b, e) {
+                    if (x) {
+                        sum += i;
+                    }
+
+                    ++i;
+                }
+
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"bitmap_scan", "vector<bool>", n, "for_each_set_bit", [bits]() {
+                std::size_t sum = 0;
+                IteratorBasedForImpl::for_each_set_bit((bits->cbegin(), bits->cend()),
+                                                       [&sum](std::size_t i) { sum += i; });
+                do_not_optimize(sum);
+            }});
+        }
+    }
+
+    registrar bitmap_cases(register_bitmap_cases);
+
+} // namespace
@@ -0,0 +1,87 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t sizes[] = {1024, 65536, 1048576};
+
+    /**
+     * @brief Registers delimiter scanning over a log-like buffer with an element-wise range-based for loop and with
+     *        the byte fast paths of find, find_first_of and count.
+     */
+    void register_byte_search_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto text = std::make_shared<std::string>(n, 'x');
+            (*text)[n - 1] = '\n';
+
+            cases.push_back({"byte_find", "string", n, "range_for", [text]() {
+                std::size_t position = 0;
+                auto b = text->cbegin();
+                auto e = text->cend();
+
+                for (char c : b, e) {
+                    if (c == '\n') {
+                        break;
+                    }
+
+                    ++position;
+                }
+
+                do_not_optimize(position);
+            }});
+
+            cases.push_back({"byte_find", "string", n, "find", [text]() {
+                do_not_optimize(IteratorBasedForImpl::find((text->cbegin(), text->cend()), '\n'));
+            }});
+
+            cases.push_back({"byte_find_first_of", "string", n, "range_for", [text]() {
+                std::size_t position = 0;
+                auto b = text->cbegin();
+                auto e = text->cend();
+
+                for (char c : b, e) {
+                    if (c == '\n' || c == ',' || c == ';' || c == '\t') {
+                        break;
+                    }
+
+                    ++position;
+                }
+
+                do_not_optimize(position);
+            }});
+
+            cases.push_back({"byte_find_first_of", "string", n, "find_first_of", [text]() {
+                static const std::string delimiters("\n,;\t");
+                do_not_optimize(IteratorBasedForImpl::find_first_of((text->cbegin(), text->cend()),
+                                                                    (delimiters.cbegin(), delimiters.cend())));
+            }});
+
+            cases.push_back({"byte_count", "string", n, "range_for", [text]() {
+                std::size_t lines = 0;
+                auto b = text->cbegin();
+                auto e = text->cend();
+
+                for (char c : b, e) {
+                    lines += c == '\n';
+                }
+
+                do_not_optimize(lines);
+            }});
+
+            cases.push_back({"byte_count", "string", n, "count", [text]() {
+                do_not_optimize(IteratorBasedForImpl::count((text->cbegin(), text->cend()), '\n'));
+            }});
+        }
+    }
+
+    registrar byte_search_cases(register_byte_search_cases);
+
+} // namespace
@@ -0,0 +1,67 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t points = 1024;
+
+    /**
+     * @brief Registers summing the distances of all pairs of points on a line with two nested loops, with a
+     *        range-based for loop over their cartesian product and with for_each() of the product.
+     */
+    void register_cartesian_cases(std::vector<benchmark_case>& cases) {
+        auto data = std::make_shared<std::vector<double>>(points);
+
+        for (std::size_t i = 0; i < points; ++i) {
+            (*data)[i] = static_cast<double>((i * 7919) % points) * 0.5;
+        }
+
+        cases.push_back({"cartesian", "vector<double>", points * points, "nested_loops", [data]() {
+            double total = 0;
+
+            for (double a : data->begin(), data->end()) {
+                for (double b : data->begin(), data->end()) {
+                    total += std::fabs(a - b);
+                }
+            }
+
+            do_not_optimize(total);
+        }});
+
+        cases.push_back({"cartesian", "vector<double>", points * points, "range_for", [data]() {
+            double total = 0;
+
+            for (std::tuple<double&, double&> pair : cartesian_product((data->begin(), data->end()),
+                                                                       (data->begin(), data->end()))) {
+                total += std::fabs(std::get<0>(pair) - std::get<1>(pair));
+            }
+
+            do_not_optimize(total);
+        }});
+
+        cases.push_back({"cartesian", "vector<double>", points * points, "for_each", [data]() {
+            double total = 0;
+
+            for_each(cartesian_product((data->begin(), data->end()), (data->begin(), data->end())),
+                     [&total](std::tuple<double&, double&> _pair) {
+                total += std::fabs(std::get<0>(_pair) - std::get<1>(_pair));
+            });
+
+            do_not_optimize(total);
+        }});
+    }
+
+    registrar cartesian_cases(register_cartesian_cases);
+
+} // namespace
@@ -0,0 +1,68 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t sizes[] = {64, 4096, 1048576};
+
+    /**
+     * @brief The bitwise CRC-32C loop over one byte at a time that crc32c() replaces.
+     */
+    std::uint32_t byte_loop_crc32c(const std::vector<std::uint8_t>& _bytes) {
+        std::uint32_t crc = ~0u;
+
+        for (std::uint8_t byte : _bytes) {
+            crc ^= byte;
+
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+            }
+        }
+
+        return ~crc;
+    }
+
+    /**
+     * @brief Registers checksumming record slices of the given sizes with the byte loop, with crc32c() using the
+     *        crc32 instructions, with its slice-by-8 tables and with xxhash64().
+     */
+    void register_checksum_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto bytes = std::make_shared<std::vector<std::uint8_t>>(n);
+            std::mt19937 random(42);
+
+            for (std::uint8_t& byte : *bytes) {
+                byte = static_cast<std::uint8_t>(random());
+            }
+
+            cases.push_back({"checksum", "bytes", n, "byte_loop", [bytes]() {
+                do_not_optimize(byte_loop_crc32c(*bytes));
+            }});
+
+            cases.push_back({"checksum", "bytes", n, "crc32c", [bytes]() {
+                do_not_optimize(crc32c((bytes->cbegin(), bytes->cend())));
+            }});
+
+            cases.push_back({"checksum", "bytes", n, "crc32c_tables", [bytes]() {
+                do_not_optimize(~simd::crc32c_software(~0u, bytes->data(), bytes->size()));
+            }});
+
+            cases.push_back({"checksum", "bytes", n, "xxhash64", [bytes]() {
+                do_not_optimize(xxhash64((bytes->cbegin(), bytes->cend())));
+            }});
+        }
+    }
+
+    registrar checksum_cases(register_checksum_cases);
+
+}
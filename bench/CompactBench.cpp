@@ -0,0 +1,75 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForParallel.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t sizes[] = {65536, 16777216};
+
+    const simd::instruction_set instruction_sets[] = {
+        simd::instruction_set::scalar, simd::instruction_set::sse2, simd::instruction_set::avx2,
+        simd::instruction_set::avx512, simd::instruction_set::neon
+    };
+
+    /**
+     * @brief Registers filtering n rows down to about _percent percent with std::copy_if, with copy_if() for every
+     *        supported instruction set and with the parallel copy_if() on all hardware threads.
+     */
+    template <typename T>
+    void add_compact_cases(std::vector<benchmark_case>& cases, const std::string& name, int _percent) {
+        for (std::size_t n : sizes) {
+            auto rows = std::make_shared<std::vector<T>>(n);
+            auto out = std::make_shared<std::vector<T>>(n);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                (*rows)[i] = static_cast<T>((i * 7919) % 100);
+            }
+
+            const std::string container = name + "/" + std::to_string(_percent) + "%";
+            auto selected = [_percent](T x) { return x < T(_percent); };
+
+            cases.push_back({"compact", container, n, "std_copy_if", [rows, out, selected]() {
+                do_not_optimize(std::copy_if(rows->cbegin(), rows->cend(), out->begin(), selected));
+            }});
+
+            for (simd::instruction_set set : instruction_sets) {
+                if (!simd::is_supported(set)) {
+                    continue;
+                }
+
+                cases.push_back({"compact", container, n, simd::name(set), [rows, out, selected, set]() {
+                    simd::select_instruction_set(set);
+                    do_not_optimize(copy_if((rows->cbegin(), rows->cend()), out->begin(), selected));
+                }});
+            }
+
+            const std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+            auto pool = std::make_shared<thread_pool>(threads - 1);
+
+            cases.push_back({"compact", container, n, "par_" + std::to_string(threads), [rows, out, selected, pool]() {
+                do_not_optimize(copy_if(execution::par.on(*pool), (rows->cbegin(), rows->cend()), out->begin(),
+                                        selected));
+            }});
+        }
+    }
+
+    void register_compact_cases(std::vector<benchmark_case>& cases) {
+        add_compact_cases<float>(cases, "vector<float>", 3);
+        add_compact_cases<std::int32_t>(cases, "vector<int32_t>", 3);
+        add_compact_cases<std::int32_t>(cases, "vector<int32_t>", 50);
+    }
+
+    registrar compact_cases(register_compact_cases);
+
+}
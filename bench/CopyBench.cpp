@@ -0,0 +1,74 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t sizes[] = {65536, 1048576, 4194304};
+
+    /**
+     * @brief Registers copying between staging buffers element by element, with copy() lowered to memmove and with
+     *        copy() using non-temporal stores.
+     */
+    void register_copy_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto in = std::make_shared<std::vector<std::uint32_t>>(n, 1u);
+            auto out = std::make_shared<std::vector<std::uint32_t>>(n);
+
+            cases.push_back({"copy", "vector<uint32_t>", n, "range_for", [in, out]() {
+                auto o = out->begin();
+                auto b = in->cbegin();
+                auto e = in->cend();
+
+                for (std::uint32_t x : b, e) {
+                    *o = x;
+                    ++o;
+                }
+
+                do_not_optimize(out->back());
+            }});
+
+            cases.push_back({"copy", "vector<uint32_t>", n, "memmove", [in, out]() {
+                IteratorBasedForImpl::set_streaming_threshold(SIZE_MAX);
+                IteratorBasedForImpl::copy((in->cbegin(), in->cend()), out->begin());
+                do_not_optimize(out->back());
+            }});
+
+            cases.push_back({"copy", "vector<uint32_t>", n, "streaming", [in, out]() {
+                IteratorBasedForImpl::set_streaming_threshold(0);
+                IteratorBasedForImpl::copy((in->cbegin(), in->cend()), out->begin());
+                do_not_optimize(out->back());
+            }});
+        }
+    }
+
+    /**
+     * @brief Registers filling a buffer with normal stores and with the streaming policy.
+     */
+    void register_fill_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto out = std::make_shared<std::vector<std::uint32_t>>(n);
+
+            cases.push_back({"fill", "vector<uint32_t>", n, "range_for", [out]() {
+                IteratorBasedForImpl::fill((out->begin(), out->end()), 3u);
+                do_not_optimize(out->back());
+            }});
+
+            cases.push_back({"fill", "vector<uint32_t>", n, "streaming", [out]() {
+                IteratorBasedForImpl::fill(IteratorBasedForImpl::execution::streaming, (out->begin(), out->end()), 3u);
+                do_not_optimize(out->back());
+            }});
+        }
+    }
+
+    registrar copy_cases(register_copy_cases);
+    registrar fill_cases(register_fill_cases);
+
+} // namespace
@@ -0,0 +1,67 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t sizes[] = {1024, 262144};
+
+    /**
+     * @brief The loop decoding one big-endian field at a time, shifting its bytes together, that decode_be() and
+     *        byteswap_copy() replace.
+     */
+    void field_loop(const std::vector<std::uint8_t>& _bytes, std::vector<std::uint32_t>& _out) {
+        for (std::size_t i = 0; i < _out.size(); ++i) {
+            const std::uint8_t* p = _bytes.data() + 4 * i;
+            _out[i] = std::uint32_t(p[0]) << 24 | std::uint32_t(p[1]) << 16 | std::uint32_t(p[2]) << 8 | p[3];
+        }
+    }
+
+    /**
+     * @brief Registers decoding big-endian 32-bit fields from a byte buffer with the field loop, with copy() and
+     *        reduce() of decode_be() and with byteswap_copy() of the buffer seen as 32-bit values.
+     */
+    void register_endian_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto bytes = std::make_shared<std::vector<std::uint8_t>>(4 * n);
+            auto words = std::make_shared<std::vector<std::uint32_t>>(n);
+            auto out = std::make_shared<std::vector<std::uint32_t>>(n);
+
+            for (std::size_t i = 0; i < bytes->size(); ++i) {
+                (*bytes)[i] = static_cast<std::uint8_t>(i * 37 + (i >> 8));
+            }
+            std::memcpy(words->data(), bytes->data(), bytes->size());
+
+            cases.push_back({"endian", "uint32", n, "field_loop", [bytes, out]() {
+                field_loop(*bytes, *out);
+                do_not_optimize(out->back());
+            }});
+
+            cases.push_back({"endian", "uint32", n, "decode_be_copy", [bytes, out]() {
+                copy(decode_be<std::uint32_t>((bytes->cbegin(), bytes->cend())), out->begin());
+                do_not_optimize(out->back());
+            }});
+
+            cases.push_back({"endian", "uint32", n, "decode_be_reduce", [bytes]() {
+                do_not_optimize(reduce(decode_be<std::uint32_t>((bytes->cbegin(), bytes->cend())), std::uint64_t(0)));
+            }});
+
+            cases.push_back({"endian", "uint32", n, "byteswap_copy", [words, out]() {
+                byteswap_copy((words->cbegin(), words->cend()), out->begin());
+                do_not_optimize(out->back());
+            }});
+        }
+    }
+
+    registrar endian_cases(register_endian_cases);
+
+}
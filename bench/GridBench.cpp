@@ -0,0 +1,65 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAdaptors.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t sides[] = {256, 2048};
+
+    /**
+     * @brief Registers transposing a square image of _side x _side elements of a visit order, writing every
+     *        element to the transposed coordinates of the output.
+     */
+    template <typename Order>
+    void add_transpose_case(std::vector<benchmark_case>& cases, const std::string& method, std::size_t _side) {
+        auto in = std::make_shared<std::vector<float>>(_side * _side, 1.0f);
+        auto out = std::make_shared<std::vector<float>>(_side * _side);
+
+        cases.push_back({"grid_transpose", "vector<float>", _side * _side, method, [in, out, _side]() {
+            auto pixels = grid<Order>((in->cbegin(), in->cend()), {_side, _side});
+            float* q = out->data();
+
+            for (auto it = pixels.begin(); it != pixels.end(); ++it) {
+                q[it.coordinates()[1] * _side + it.coordinates()[0]] = *it;
+            }
+
+            do_not_optimize(out->data());
+        }});
+    }
+
+    void register_grid_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t side : sides) {
+            auto in = std::make_shared<std::vector<float>>(side * side, 1.0f);
+            auto out = std::make_shared<std::vector<float>>(side * side);
+
+            cases.push_back({"grid_transpose", "vector<float>", side * side, "nested_loops", [in, out, side]() {
+                const float* p = in->data();
+                float* q = out->data();
+
+                for (std::size_t y = 0; y < side; ++y) {
+                    for (std::size_t x = 0; x < side; ++x) {
+                        q[x * side + y] = p[y * side + x];
+                    }
+                }
+
+                do_not_optimize(out->data());
+            }});
+
+            add_transpose_case<traversal::row_major>(cases, "row_major", side);
+            add_transpose_case<traversal::tiled<16>>(cases, "tiled<16>", side);
+            add_transpose_case<traversal::tiled<64>>(cases, "tiled<64>", side);
+            add_transpose_case<traversal::morton>(cases, "morton", side);
+        }
+    }
+
+    registrar grid_cases(register_grid_cases);
+
+}
@@ -0,0 +1,68 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForParallel.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t sizes[] = {65536, 16777216};
+
+    /**
+     * @brief Registers counting the byte frequencies of a buffer of n bytes with a loop over a single table, with
+     *        histogram() and with the parallel histogram() on all hardware threads. _distinct is the number of
+     *        distinct byte values, one for a buffer of zeros such as the high bytes of small integers.
+     */
+    void add_byte_histogram_cases(std::vector<benchmark_case>& cases, unsigned _distinct) {
+        for (std::size_t n : sizes) {
+            auto bytes = std::make_shared<std::vector<std::uint8_t>>(n);
+            std::mt19937 random(42);
+
+            for (std::uint8_t& byte : *bytes) {
+                byte = static_cast<std::uint8_t>(random() % _distinct);
+            }
+
+            const std::string container = "bytes/" + std::to_string(_distinct);
+
+            cases.push_back({"histogram", container, n, "single_table", [bytes]() {
+                std::vector<std::size_t> counts(256);
+
+                for (std::uint8_t byte : *bytes) {
+                    ++counts[byte];
+                }
+
+                do_not_optimize(counts.data());
+            }});
+
+            cases.push_back({"histogram", container, n, "histogram", [bytes]() {
+                do_not_optimize(histogram((bytes->cbegin(), bytes->cend()), 256).data());
+            }});
+
+            const std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+            auto pool = std::make_shared<thread_pool>(threads - 1);
+
+            cases.push_back({"histogram", container, n, "par_" + std::to_string(threads), [bytes, pool]() {
+                do_not_optimize(histogram(execution::par.on(*pool), (bytes->cbegin(), bytes->cend()), 256).data());
+            }});
+        }
+    }
+
+    void register_histogram_cases(std::vector<benchmark_case>& cases) {
+        add_byte_histogram_cases(cases, 256);
+        add_byte_histogram_cases(cases, 4);
+        add_byte_histogram_cases(cases, 1);
+    }
+
+    registrar histogram_cases(register_histogram_cases);
+
+}
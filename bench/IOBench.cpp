@@ -0,0 +1,87 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForIO.hpp>
+
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t sizes[] = {65536, 4194304};
+
+    std::shared_ptr<std::string> make_log(std::size_t _bytes) {
+        auto log = std::make_shared<std::string>();
+
+        while (log->size() < _bytes) {
+            *log += "2024-01-01T00:00:00Z INFO request served in 12ms\n";
+        }
+
+        return log;
+    }
+
+    /**
+     * @brief Registers counting the bytes and lines of an in-memory log through istreambuf_iterator and
+     *        std::getline and through block_reader.
+     */
+    void register_io_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto log = make_log(n);
+
+            cases.push_back({"io_bytes", "istringstream", n, "istreambuf_iterator", [log]() {
+                std::istringstream stream(*log);
+                std::size_t newlines = 0;
+
+                for (auto it = std::istreambuf_iterator<char>(stream); it != std::istreambuf_iterator<char>(); ++it) {
+                    newlines += *it == '\n';
+                }
+
+                do_not_optimize(newlines);
+            }});
+
+            cases.push_back({"io_bytes", "istringstream", n, "block_reader", [log]() {
+                std::istringstream stream(*log);
+                IteratorBasedForImpl::block_reader reader(stream);
+                std::size_t newlines = 0;
+
+                for (char c : IteratorBasedForImpl::bytes(reader)) {
+                    newlines += c == '\n';
+                }
+
+                do_not_optimize(newlines);
+            }});
+
+            cases.push_back({"io_lines", "istringstream", n, "getline", [log]() {
+                std::istringstream stream(*log);
+                std::string line;
+                std::size_t length = 0;
+
+                while (std::getline(stream, line)) {
+                    length += line.size();
+                }
+
+                do_not_optimize(length);
+            }});
+
+            cases.push_back({"io_lines", "istringstream", n, "block_reader", [log]() {
+                std::istringstream stream(*log);
+                IteratorBasedForImpl::block_reader reader(stream);
+                std::size_t length = 0;
+
+                for (IteratorBasedForImpl::span<const char> line : IteratorBasedForImpl::lines(reader)) {
+                    length += line.size();
+                }
+
+                do_not_optimize(length);
+            }});
+        }
+    }
+
+    registrar io_cases(register_io_cases);
+
+} // namespace
@@ -0,0 +1,49 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t sizes[] = {65536, 1048576};
+
+    //Elements appended between two refreshes of the dashboard.
+    constexpr std::size_t batch = 4096;
+
+    /**
+     * @brief Registers growing a vector batch by batch and refreshing its sum after every batch by reducing the whole
+     *        vector again and with incremental_reduce.
+     */
+    void register_incremental_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto data = std::make_shared<std::vector<double>>(n);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                (*data)[i] = static_cast<double>(i % 1000) * 0.25;
+            }
+
+            cases.push_back({"incremental", "vector<double>", n, "reduce_all", [data]() {
+                for (std::size_t size = batch; size <= data->size(); size += batch) {
+                    do_not_optimize(reduce((data->cbegin(), data->cbegin() + std::ptrdiff_t(size)), 0.0));
+                }
+            }});
+
+            cases.push_back({"incremental", "vector<double>", n, "incremental_reduce", [data]() {
+                incremental_reduce<double> total;
+
+                for (std::size_t size = batch; size <= data->size(); size += batch) {
+                    do_not_optimize(total.update((data->cbegin(), data->cbegin() + std::ptrdiff_t(size))));
+                }
+            }});
+        }
+    }
+
+    registrar incremental_cases(register_incremental_cases);
+
+}
@@ -0,0 +1,73 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    //The values stay between 1 and 2, so repeated passes neither overflow nor turn denormal.
+    inline float scale(float _x) { return _x * 0.5f + 1.0f; }
+
+    /**
+     * @brief Registers for_each and transform over a vector<float> of _n elements as a loop comparing iterators, as
+     *        the standard algorithm and as the algorithm of this library, which runs a 32-bit index loop.
+     */
+    void register_sizes(std::vector<benchmark_case>& cases, std::size_t _n) {
+        auto v = std::make_shared<std::vector<float>>(_n, 1.0f);
+        auto out = std::make_shared<std::vector<float>>(_n);
+
+        cases.push_back({"index_loop", "vector<float>/for_each", _n, "iterator_loop", [v]() {
+            for (auto it = v->begin(); it != v->end(); ++it) {
+                *it = scale(*it);
+            }
+
+            do_not_optimize(v->front());
+        }});
+
+        cases.push_back({"index_loop", "vector<float>/for_each", _n, "std_for_each", [v]() {
+            std::for_each(v->begin(), v->end(), [](float& x) { x = scale(x); });
+            do_not_optimize(v->front());
+        }});
+
+        cases.push_back({"index_loop", "vector<float>/for_each", _n, "for_each", [v]() {
+            for_each((v->begin(), v->end()), [](float& x) { x = scale(x); });
+            do_not_optimize(v->front());
+        }});
+
+        cases.push_back({"index_loop", "vector<float>/transform", _n, "iterator_loop", [v, out]() {
+            auto o = out->begin();
+
+            for (auto it = v->cbegin(); it != v->cend(); ++it, ++o) {
+                *o = scale(*it);
+            }
+
+            do_not_optimize(out->front());
+        }});
+
+        cases.push_back({"index_loop", "vector<float>/transform", _n, "std_transform", [v, out]() {
+            std::transform(v->cbegin(), v->cend(), out->begin(), [](float x) { return scale(x); });
+            do_not_optimize(out->front());
+        }});
+
+        cases.push_back({"index_loop", "vector<float>/transform", _n, "transform", [v, out]() {
+            transform((v->cbegin(), v->cend()), out->begin(), [](float x) { return scale(x); });
+            do_not_optimize(out->front());
+        }});
+    }
+
+    void register_index_loop_cases(std::vector<benchmark_case>& cases) {
+        register_sizes(cases, 4096);
+        register_sizes(cases, std::size_t(1) << 20);
+    }
+
+    registrar index_loop_cases(register_index_loop_cases);
+
+} // namespace
@@ -0,0 +1,67 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedFor.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t sizes[] = {1024, 65536, 1048576};
+
+    /**
+     * @brief Registers an index-based kernel written as a raw index loop and as loops over iota() with 32- and 64-bit
+     *        indices, which should compile to the same vectorized code.
+     */
+    void register_iota_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto a = std::make_shared<std::vector<float>>(n, 1.5f);
+            auto b = std::make_shared<std::vector<float>>(n, 2.0f);
+            auto out = std::make_shared<std::vector<float>>(n);
+
+            cases.push_back({"iota", "vector<float>", n, "raw_loop", [a, b, out]() {
+                const int count = static_cast<int>(out->size());
+                const float* x = a->data();
+                const float* y = b->data();
+                float* z = out->data();
+
+                for (int i = 0; i < count; ++i) {
+                    z[i] = x[i] * y[i] + 1.0f;
+                }
+
+                do_not_optimize(out->back());
+            }});
+
+            cases.push_back({"iota", "vector<float>", n, "iota_int32", [a, b, out]() {
+                const float* x = a->data();
+                const float* y = b->data();
+                float* z = out->data();
+
+                for (std::int32_t i : IteratorBasedForImpl::iota<std::int32_t>(0, out->size())) {
+                    z[i] = x[i] * y[i] + 1.0f;
+                }
+
+                do_not_optimize(out->back());
+            }});
+
+            cases.push_back({"iota", "vector<float>", n, "iota_int64", [a, b, out]() {
+                const float* x = a->data();
+                const float* y = b->data();
+                float* z = out->data();
+
+                for (std::int64_t i : IteratorBasedForImpl::iota<std::int64_t>(0, out->size())) {
+                    z[i] = x[i] * y[i] + 1.0f;
+                }
+
+                do_not_optimize(out->back());
+            }});
+        }
+    }
+
+    registrar iota_cases(register_iota_cases);
+
+} // namespace
@@ -0,0 +1,125 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedFor.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t sizes[] = {16, 1024, 65536, 1048576};
+
+    template <typename T>
+    long value_of(const T& x) { return static_cast<long>(x); }
+
+    template <typename K, typename V>
+    long value_of(const std::pair<K, V>& x) { return static_cast<long>(x.second); }
+
+    template <typename Container>
+    std::shared_ptr<Container> make_container(std::size_t n);
+
+    template <>
+    std::shared_ptr<std::map<int, int>> make_container(std::size_t n) {
+        auto m = std::make_shared<std::map<int, int>>();
+
+        for (std::size_t i = 0; i < n; ++i) {
+            m->emplace(static_cast<int>(i), static_cast<int>(i));
+        }
+
+        return m;
+    }
+
+    template <>
+    std::shared_ptr<std::string> make_container(std::size_t n) {
+        auto s = std::make_shared<std::string>(n, ' ');
+
+        for (std::size_t i = 0; i < n; ++i) {
+            (*s)[i] = static_cast<char>('a' + i % 26);
+        }
+
+        return s;
+    }
+
+    template <typename Container>
+    std::shared_ptr<Container> make_container(std::size_t n) {
+        auto c = std::make_shared<Container>();
+
+        for (std::size_t i = 0; i < n; ++i) {
+            c->push_back(static_cast<typename Container::value_type>(i));
+        }
+
+        return c;
+    }
+
+    /**
+     * @brief Registers a raw iterator loop, std::for_each, an explicit iterator_range and the comma syntax over the
+     *        same container so that the four can be compared directly.
+     */
+    template <typename Container>
+    void add_iteration_cases(std::vector<benchmark_case>& cases, const std::string& name) {
+        for (std::size_t n : sizes) {
+            std::shared_ptr<const Container> c = make_container<Container>(n);
+
+            cases.push_back({"iteration", name, n, "raw_loop", [c]() {
+                long sum = 0;
+
+                for (auto it = c->begin(), e = c->end(); it != e; ++it) {
+                    sum += value_of(*it);
+                }
+
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"iteration", name, n, "std_for_each", [c]() {
+                long sum = 0;
+
+                std::for_each(c->begin(), c->end(), [&sum](const typename Container::value_type& x) {
+                    sum += value_of(x);
+                });
+
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"iteration", name, n, "iterator_range", [c]() {
+                long sum = 0;
+
+                for (const auto& x : IteratorBasedForImpl::make_iterator_range(c->begin(), c->end())) {
+                    sum += value_of(x);
+                }
+
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"iteration", name, n, "comma", [c]() {
+                long sum = 0;
+                auto b = c->begin();
+                auto e = c->end();
+
+                for (const auto& x : b, e) {
+                    sum += value_of(x);
+                }
+
+                do_not_optimize(sum);
+            }});
+        }
+    }
+
+    void register_iteration_cases(std::vector<benchmark_case>& cases) {
+        add_iteration_cases<std::vector<int>>(cases, "vector");
+        add_iteration_cases<std::deque<int>>(cases, "deque");
+        add_iteration_cases<std::list<int>>(cases, "list");
+        add_iteration_cases<std::map<int, int>>(cases, "map");
+        add_iteration_cases<std::string>(cases, "string");
+    }
+
+    registrar iteration_cases(register_iteration_cases);
+
+} // namespace
@@ -0,0 +1,79 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAdaptors.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t run_counts[] = {64, 512};
+    const std::size_t total_elements = 1048576;
+
+    /**
+     * @brief Registers merging sorted runs of 64-bit keys with a std::priority_queue of run cursors and with merge().
+     */
+    void register_merge_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t k : run_counts) {
+            auto runs = std::make_shared<std::vector<std::vector<std::uint64_t>>>(k);
+            std::uint64_t state = 88172645463325252ull;
+
+            for (std::vector<std::uint64_t>& run : *runs) {
+                for (std::size_t i = 0; i < total_elements / k; ++i) {
+                    state ^= state << 13;
+                    state ^= state >> 7;
+                    state ^= state << 17;
+                    run.push_back(state);
+                }
+
+                std::sort(run.begin(), run.end());
+            }
+
+            const std::string container = "runs<uint64>/" + std::to_string(k);
+
+            cases.push_back({"merge", container, total_elements, "priority_queue", [runs]() {
+                using cursor = std::pair<std::uint64_t, std::size_t>;
+                std::priority_queue<cursor, std::vector<cursor>, std::greater<cursor>> heap;
+                std::vector<std::size_t> positions(runs->size(), 0);
+                std::uint64_t checksum = 0;
+
+                for (std::size_t r = 0; r < runs->size(); ++r) {
+                    heap.emplace((*runs)[r][0], r);
+                }
+
+                while (!heap.empty()) {
+                    const cursor top = heap.top();
+                    heap.pop();
+                    checksum = checksum * 31 + top.first;
+
+                    if (++positions[top.second] < (*runs)[top.second].size()) {
+                        heap.emplace((*runs)[top.second][positions[top.second]], top.second);
+                    }
+                }
+
+                do_not_optimize(checksum);
+            }});
+
+            cases.push_back({"merge", container, total_elements, "loser_tree", [runs]() {
+                std::uint64_t checksum = 0;
+
+                for (std::uint64_t x : IteratorBasedForImpl::merge(*runs)) {
+                    checksum = checksum * 31 + x;
+                }
+
+                do_not_optimize(checksum);
+            }});
+        }
+    }
+
+    registrar merge_cases(register_merge_cases);
+
+} // namespace
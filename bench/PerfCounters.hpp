@@ -0,0 +1,161 @@
+#ifndef PerfCounters_H
+#define PerfCounters_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/perf_event.h>)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define ITERATOR_BASED_FOR_BENCH_HAS_PERF 1
+#endif
+#endif
+
+#ifndef ITERATOR_BASED_FOR_BENCH_HAS_PERF
+#define ITERATOR_BASED_FOR_BENCH_HAS_PERF 0
+#endif
+
+namespace IteratorBasedForBench
+{
+
+    /**
+     * @brief The hardware events counted for every benchmark case.
+     */
+    enum perf_event {
+        perf_cycles,
+        perf_instructions,
+        perf_l1d_misses,
+        perf_llc_misses,
+        perf_branch_misses,
+        perf_event_count
+    };
+
+    /**
+     * @brief Event counts of one measurement. An event the kernel or the machine does not provide, for example in a
+     *        virtual machine or with a restrictive perf_event_paranoid setting, is marked as not available.
+     */
+    struct perf_sample {
+        std::array<double, perf_event_count> counts;
+        std::array<bool, perf_event_count> available;
+
+        perf_sample() : counts(), available() { }
+    };
+
+    /**
+     * @brief Counts hardware events of the calling thread in user space through perf_event_open. Each event is opened
+     *        on its own, so events the machine lacks do not keep the others from being counted, and counts are scaled
+     *        up when the kernel had to multiplex the counters.
+     */
+    class perf_counters {
+    private:
+        std::array<int, perf_event_count> m_fds;
+
+#if ITERATOR_BASED_FOR_BENCH_HAS_PERF
+        static int open_event(std::uint32_t _type, std::uint64_t _config) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = _type;
+            attr.config = _config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+
+        static std::uint64_t cache_miss(std::uint64_t _cache) {
+            return _cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        }
+#endif
+
+    public:
+        perf_counters() : m_fds() {
+            m_fds.fill(-1);
+#if ITERATOR_BASED_FOR_BENCH_HAS_PERF
+            m_fds[perf_cycles] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+            m_fds[perf_instructions] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            m_fds[perf_l1d_misses] = open_event(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D));
+            m_fds[perf_llc_misses] = open_event(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL));
+            m_fds[perf_branch_misses] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+        }
+
+        perf_counters(const perf_counters&) = delete;
+        perf_counters& operator=(const perf_counters&) = delete;
+
+        ~perf_counters() {
+#if ITERATOR_BASED_FOR_BENCH_HAS_PERF
+            for (int fd : m_fds) {
+                if (fd >= 0) {
+                    close(fd);
+                }
+            }
+#endif
+        }
+
+        /**
+         * @brief Returns whether at least one event can be counted.
+         */
+        bool any() const {
+            for (int fd : m_fds) {
+                if (fd >= 0) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /**
+         * @brief Resets and starts all events.
+         */
+        void start() {
+#if ITERATOR_BASED_FOR_BENCH_HAS_PERF
+            for (int fd : m_fds) {
+                if (fd >= 0) {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+        }
+
+        /**
+         * @brief Stops all events and returns their counts since start().
+         */
+        perf_sample stop() {
+            perf_sample sample;
+#if ITERATOR_BASED_FOR_BENCH_HAS_PERF
+            for (int fd : m_fds) {
+                if (fd >= 0) {
+                    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                }
+            }
+
+            for (std::size_t e = 0; e < perf_event_count; ++e) {
+                //value, time enabled, time running
+                std::uint64_t values[3] = {0, 0, 0};
+
+                if (m_fds[e] < 0 || read(m_fds[e], values, sizeof(values)) != static_cast<ssize_t>(sizeof(values))
+                    || values[2] == 0) {
+                    continue;
+                }
+
+                sample.counts[e] = double(values[0]) * double(values[1]) / double(values[2]);
+                sample.available[e] = true;
+            }
+#endif
+            return sample;
+        }
+    };
+
+} // namespace IteratorBasedForBench
+
+#endif // PerfCounters_H
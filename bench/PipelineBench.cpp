@@ -0,0 +1,53 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForPipeline.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t n = 1 << 18;
+
+    /**
+     * @brief Registers a three step computation over a vector done in one loop and as a pipeline of three stages, the
+     *        overhead of moving batches between threads.
+     */
+    void register_pipeline_cases(std::vector<benchmark_case>& cases) {
+        auto v = std::make_shared<std::vector<std::uint32_t>>(n);
+        std::iota(v->begin(), v->end(), 0u);
+
+        cases.push_back({"pipeline", "vector<uint32_t>", n, "single_loop", [v]() {
+            std::uint64_t total = 0;
+
+            for (std::uint32_t x : (v->cbegin(), v->cend())) {
+                total += static_cast<std::uint64_t>(x * 3u) ^ 5u;
+            }
+
+            do_not_optimize(total);
+        }});
+
+        for (std::size_t batch : {64u, 1024u}) {
+            cases.push_back({"pipeline", "vector<uint32_t>", n, "stages_batch_" + std::to_string(batch), [v, batch]() {
+                std::uint64_t total = 0;
+
+                IteratorBasedForImpl::pipeline((v->cbegin(), v->cend()), batch)
+                        | IteratorBasedForImpl::stage([](std::uint32_t x) { return x * 3u; })
+                        | IteratorBasedForImpl::stage([](std::uint32_t x) { return static_cast<std::uint64_t>(x) ^ 5u; })
+                        | IteratorBasedForImpl::sink([&total](std::uint64_t x) { total += x; });
+
+                do_not_optimize(total);
+            }});
+        }
+    }
+
+    registrar pipeline_cases(register_pipeline_cases);
+
+} // namespace
@@ -0,0 +1,85 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForParallel.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t elements = 1 << 12;
+    const std::size_t chunks = 4;
+
+    std::size_t bench_workers() {
+        return std::max(1u, std::thread::hardware_concurrency()) - 1;
+    }
+
+    /**
+     * @brief Sums _values in chunks on _pool; a loop too short to amortize waking parked workers.
+     */
+    void small_loop(thread_pool& _pool, const std::vector<std::uint32_t>& _values) {
+        std::uint64_t sums[chunks] = {};
+
+        _pool.run_chunks(chunks, [&](std::size_t _chunk) {
+            std::uint64_t sum = 0;
+
+            for (std::size_t i = _chunk * elements / chunks; i < (_chunk + 1) * elements / chunks; ++i) {
+                sum += _values[i];
+            }
+
+            sums[_chunk] = sum;
+        });
+
+        do_not_optimize(sums);
+    }
+
+    /**
+     * @brief Registers back-to-back short loops on a pool created for every loop, on a pool whose idle workers park
+     *        at once and on one whose workers spin for the default time before parking.
+     */
+    void register_pool_cases(std::vector<benchmark_case>& cases) {
+        auto values = std::make_shared<std::vector<std::uint32_t>>(elements, 1);
+
+        cases.push_back({"pool", "vector<uint32_t>", elements, "new_pool", [values]() {
+            thread_pool pool(bench_workers());
+            small_loop(pool, *values);
+        }});
+
+        thread_pool_options park;
+        park.workers = bench_workers();
+        park.spin = std::chrono::microseconds(0);
+        auto parking = std::make_shared<std::unique_ptr<thread_pool>>();
+
+        cases.push_back({"pool", "vector<uint32_t>", elements, "park", [values, parking, park]() {
+            if (!*parking) {
+                parking->reset(new thread_pool(park));
+            }
+
+            small_loop(**parking, *values);
+        }});
+
+        thread_pool_options spin;
+        spin.workers = bench_workers();
+        auto spinning = std::make_shared<std::unique_ptr<thread_pool>>();
+
+        cases.push_back({"pool", "vector<uint32_t>", elements, "spin_then_park", [values, spinning, spin]() {
+            if (!*spinning) {
+                spinning->reset(new thread_pool(spin));
+            }
+
+            small_loop(**spinning, *values);
+        }});
+    }
+
+    registrar pool_cases(register_pool_cases);
+
+} // namespace
@@ -0,0 +1,182 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAdaptors.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <forward_list>
+#include <list>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t sizes[] = {65536, 1048576};
+
+    /**
+     * @brief Returns a list of _n shuffled values, sorted so that traversal order no longer follows the order the
+     *        nodes were allocated in and every step is a likely cache miss.
+     */
+    std::shared_ptr<std::list<int>> make_scattered_list(std::size_t _n) {
+        auto l = std::make_shared<std::list<int>>();
+        std::mt19937 generator(42);
+
+        for (std::size_t i = 0; i < _n; ++i) {
+            l->push_back(static_cast<int>(generator() % (_n * 4)));
+        }
+
+        l->sort();
+        return l;
+    }
+
+    /**
+     * @brief Registers traversal of a scattered list with a plain range and with prefetched() at a few distances.
+     */
+    void register_prefetch_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto l = make_scattered_list(n);
+
+            cases.push_back({"prefetch", "list<int>", n, "range_for", [l]() {
+                long sum = 0;
+                auto b = l->begin();
+                auto e = l->end();
+
+                for (int x : b, e) {
+                    sum += x;
+                }
+
+                do_not_optimize(sum);
+            }});
+
+            for (std::size_t distance : {4u, 16u}) {
+                cases.push_back({"prefetch", "list<int>", n, "prefetched_" + std::to_string(distance), [l, distance]() {
+                    long sum = 0;
+
+                    for (int x : IteratorBasedForImpl::prefetched((l->begin(), l->end()), distance)) {
+                        sum += x;
+                    }
+
+                    do_not_optimize(sum);
+                }});
+            }
+        }
+    }
+
+    /**
+     * @brief Registers walking 65536 lists of 16 elements each, whose nodes were allocated in random order of the
+     *        lists so that every step of a walk is a likely cache miss, one list after another and with
+     *        interleaved_for_each() at a few widths.
+     */
+    void register_interleaved_chain_cases(std::vector<benchmark_case>& cases) {
+        const std::size_t chains = 65536;
+        auto lists = std::make_shared<std::vector<std::list<int>>>(chains);
+        std::mt19937 generator(42);
+
+        for (std::size_t i = 0; i < chains * 16; ++i) {
+            (*lists)[generator() % chains].push_back(static_cast<int>(i));
+        }
+
+        using range = IteratorBasedForImpl::iterator_range<std::list<int>::const_iterator>;
+        auto ranges = std::make_shared<std::vector<range>>();
+
+        for (const std::list<int>& l : *lists) {
+            ranges->push_back((l.cbegin(), l.cend()));
+        }
+
+        cases.push_back({"interleaved_chains", "list<int>", chains * 16, "one_by_one", [lists, ranges]() {
+            long sum = 0;
+
+            for (const range& r : *ranges) {
+                for (int x : r) {
+                    sum += x;
+                }
+            }
+
+            do_not_optimize(sum);
+        }});
+
+        for (std::size_t width : {4u, 8u, 16u}) {
+            std::string method = "interleaved_" + std::to_string(width);
+
+            cases.push_back({"interleaved_chains", "list<int>", chains * 16, method, [lists, ranges, width]() {
+                long sum = 0;
+                IteratorBasedForImpl::interleaved_for_each(*ranges, [&sum](std::size_t, int x) { sum += x; }, width);
+                do_not_optimize(sum);
+            }});
+        }
+    }
+
+    /**
+     * @brief Registers the probe phase of a hash join: 1 Mi keys, half of them present, looked up in a chained hash
+     *        table of 4 Mi entries, by walking the chain of each key in turn and by walking the chains of all keys
+     *        with interleaved_for_each().
+     */
+    void register_interleaved_probe_cases(std::vector<benchmark_case>& cases) {
+        using entry = std::pair<std::uint64_t, std::uint64_t>;
+        using chain = std::forward_list<entry>;
+        using range = IteratorBasedForImpl::iterator_range<chain::const_iterator>;
+        const std::size_t n = std::size_t(1) << 22;
+        auto table = std::make_shared<std::vector<chain>>(n);
+        auto probes = std::make_shared<std::vector<std::uint64_t>>();
+        std::mt19937_64 generator(42);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint64_t key = generator() | 1;
+            (*table)[key % n].emplace_front(key, i);
+
+            if (i % 8 == 0) {
+                probes->push_back(key);
+                probes->push_back(generator() & ~std::uint64_t(1));
+            }
+        }
+
+        std::shuffle(probes->begin(), probes->end(), generator);
+
+        cases.push_back({"interleaved_probe", "chained_table", probes->size(), "one_by_one", [table, probes, n]() {
+            std::uint64_t sum = 0;
+
+            for (std::uint64_t key : *probes) {
+                for (const entry& e : (*table)[key % n]) {
+                    if (e.first == key) {
+                        sum += e.second;
+                        break;
+                    }
+                }
+            }
+
+            do_not_optimize(sum);
+        }});
+
+        for (std::size_t width : {8u, 16u}) {
+            std::string method = "interleaved_" + std::to_string(width);
+
+            cases.push_back({"interleaved_probe", "chained_table", probes->size(), method, [table, probes, n, width]() {
+                std::vector<range> chains;
+                chains.reserve(probes->size());
+
+                for (std::uint64_t key : *probes) {
+                    const chain& c = (*table)[key % n];
+                    chains.push_back((c.cbegin(), c.cend()));
+                }
+
+                std::uint64_t sum = 0;
+                auto probe = [&sum, &probes](std::size_t i, const entry& e) {
+                    return e.first == (*probes)[i] ? (sum += e.second, false) : true;
+                };
+
+                IteratorBasedForImpl::interleaved_for_each(chains, probe, width);
+                do_not_optimize(sum);
+            }});
+        }
+    }
+
+    registrar prefetch_cases(register_prefetch_cases);
+    registrar interleaved_chain_cases(register_interleaved_chain_cases);
+    registrar interleaved_probe_cases(register_interleaved_probe_cases);
+
+} // namespace
@@ -0,0 +1,171 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForParallel.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t n = 1 << 18;
+    const std::size_t capacity = 1024;
+
+    /**
+     * @brief The usual bounded queue of a mutex and two condition variables, as the baseline.
+     */
+    class mutex_queue {
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_not_empty;
+        std::condition_variable m_not_full;
+        std::deque<std::uint32_t> m_values;
+        bool m_closed;
+
+    public:
+        mutex_queue() : m_mutex(), m_not_empty(), m_not_full(), m_values(), m_closed(false) { }
+
+        void push(std::uint32_t _value) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_not_full.wait(lock, [this]() { return m_values.size() < capacity; });
+            m_values.push_back(_value);
+            lock.unlock();
+            m_not_empty.notify_one();
+        }
+
+        bool pop(std::uint32_t& _value) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_not_empty.wait(lock, [this]() { return !m_values.empty() || m_closed; });
+
+            if (m_values.empty()) {
+                return false;
+            }
+
+            _value = m_values.front();
+            m_values.pop_front();
+            lock.unlock();
+            m_not_full.notify_one();
+            return true;
+        }
+
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_closed = true;
+            }
+
+            m_not_empty.notify_all();
+        }
+    };
+
+    template <typename Queue>
+    void transfer_one_by_one() {
+        Queue queue(capacity);
+        std::thread producer([&queue]() {
+            for (std::uint32_t i = 0; i < n; ++i) {
+                queue.push(i);
+            }
+
+            queue.close();
+        });
+
+        std::uint64_t total = 0;
+
+        for (std::uint32_t x : (queue.begin(), queue.end())) {
+            total += x;
+        }
+
+        producer.join();
+        do_not_optimize(total);
+    }
+
+    void transfer_in_batches(std::size_t _batch) {
+        IteratorBasedForImpl::spsc_queue<std::uint32_t> queue(capacity);
+        std::thread producer([&queue, _batch]() {
+            std::vector<std::uint32_t> batch(_batch);
+
+            for (std::uint32_t i = 0; i < n; i += static_cast<std::uint32_t>(_batch)) {
+                for (std::size_t j = 0; j < _batch; ++j) {
+                    batch[j] = i + static_cast<std::uint32_t>(j);
+                }
+
+                for (std::size_t pushed = 0, attempts = 0; pushed < _batch;
+                     IteratorBasedForImpl::queue_back_off(attempts)) {
+                    pushed += queue.try_push(batch.data() + pushed, _batch - pushed);
+                }
+            }
+
+            queue.close();
+        });
+
+        std::vector<std::uint32_t> batch(_batch);
+        std::uint64_t total = 0;
+
+        for (std::size_t attempts = 0;;) {
+            //closed is read before popping, so an empty pop after it means that nothing is left
+            const bool closed = queue.closed();
+            const std::size_t popped = queue.try_pop(batch.data(), _batch);
+
+            for (std::size_t j = 0; j < popped; ++j) {
+                total += batch[j];
+            }
+
+            if (popped == 0) {
+                if (closed) {
+                    break;
+                }
+
+                IteratorBasedForImpl::queue_back_off(attempts);
+            }
+        }
+
+        producer.join();
+        do_not_optimize(total);
+    }
+
+    /**
+     * @brief Registers the transfer of integers from a producing to a consuming thread through a mutex and
+     *        condition variable queue and through the lock-free bounded queues, element by element and in batches.
+     */
+    void register_queue_cases(std::vector<benchmark_case>& cases) {
+        cases.push_back({"queue", "uint32_t", n, "mutex_condvar", []() {
+            mutex_queue queue;
+            std::thread producer([&queue]() {
+                for (std::uint32_t i = 0; i < n; ++i) {
+                    queue.push(i);
+                }
+
+                queue.close();
+            });
+
+            std::uint64_t total = 0;
+
+            for (std::uint32_t x; queue.pop(x);) {
+                total += x;
+            }
+
+            producer.join();
+            do_not_optimize(total);
+        }});
+
+        cases.push_back({"queue", "uint32_t", n, "bounded_queue", []() {
+            transfer_one_by_one<IteratorBasedForImpl::bounded_queue<std::uint32_t>>();
+        }});
+
+        cases.push_back({"queue", "uint32_t", n, "spsc_queue", []() {
+            transfer_one_by_one<IteratorBasedForImpl::spsc_queue<std::uint32_t>>();
+        }});
+
+        cases.push_back({"queue", "uint32_t", n, "spsc_queue_batch_64", []() { transfer_in_batches(64); }});
+    }
+
+    registrar queue_cases(register_queue_cases);
+
+} // namespace
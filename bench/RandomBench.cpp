@@ -0,0 +1,74 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForParallel.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t n = 1 << 20;
+
+    /**
+     * @brief Registers filling a million doubles with uniform and floats with normal values: serially from
+     *        std::mt19937, with generate_random() on the calling thread and with generate_random() on the default
+     *        pool.
+     */
+    void register_random_cases(std::vector<benchmark_case>& cases) {
+        auto uniform = std::make_shared<std::vector<double>>(n);
+        auto normal = std::make_shared<std::vector<float>>(n);
+
+        cases.push_back({"random", "uniform_real_distribution<double>", n, "mt19937", [uniform]() {
+            std::mt19937 engine(1);
+            std::uniform_real_distribution<double> distribution;
+
+            for (double& x : uniform->begin(), uniform->end()) {
+                x = distribution(engine);
+            }
+
+            do_not_optimize(uniform->front());
+        }});
+
+        cases.push_back({"random", "uniform_real_distribution<double>", n, "generate_random", [uniform]() {
+            generate_random((uniform->begin(), uniform->end()), std::uniform_real_distribution<double>(), 1);
+            do_not_optimize(uniform->front());
+        }});
+
+        cases.push_back({"random", "uniform_real_distribution<double>", n, "generate_random_par", [uniform]() {
+            generate_random(execution::par, (uniform->begin(), uniform->end()),
+                            std::uniform_real_distribution<double>(), 1);
+            do_not_optimize(uniform->front());
+        }});
+
+        cases.push_back({"random", "normal_distribution<float>", n, "mt19937", [normal]() {
+            std::mt19937 engine(1);
+            std::normal_distribution<float> distribution;
+
+            for (float& x : normal->begin(), normal->end()) {
+                x = distribution(engine);
+            }
+
+            do_not_optimize(normal->front());
+        }});
+
+        cases.push_back({"random", "normal_distribution<float>", n, "generate_random", [normal]() {
+            generate_random((normal->begin(), normal->end()), std::normal_distribution<float>(), 1);
+            do_not_optimize(normal->front());
+        }});
+
+        cases.push_back({"random", "normal_distribution<float>", n, "generate_random_par", [normal]() {
+            generate_random(execution::par, (normal->begin(), normal->end()), std::normal_distribution<float>(), 1);
+            do_not_optimize(normal->front());
+        }});
+    }
+
+    registrar random_cases(register_random_cases);
+
+} // namespace
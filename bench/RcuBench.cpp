@@ -0,0 +1,105 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForParallel.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t reads = 1 << 16;
+    const std::size_t table_size = 64;
+    const std::size_t readers = 2;
+
+    //Reads between two updates of the table by the first reader.
+    const std::size_t reads_per_update = 4096;
+
+    /**
+     * @brief Runs readers threads, each looking the table up reads / readers times through _read and the first one
+     *        also replacing it through _write every reads_per_update lookups.
+     */
+    template <typename Read, typename Write>
+    void read_mostly(Read _read, Write _write) {
+        std::vector<std::thread> threads;
+
+        for (std::size_t t = 0; t < readers; ++t) {
+            threads.emplace_back([t, &_read, &_write]() {
+                std::uint64_t total = 0;
+
+                for (std::size_t i = 0; i < reads / readers; ++i) {
+                    total += _read();
+
+                    if (t == 0 && i % reads_per_update == 0) {
+                        _write(static_cast<std::uint32_t>(i));
+                    }
+                }
+
+                do_not_optimize(total);
+            });
+        }
+
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    template <typename Mutex, typename ReadLock>
+    void locked_table() {
+        Mutex mutex;
+        std::vector<std::uint32_t> table(table_size, 1);
+
+        read_mostly([&]() {
+            ReadLock lock(mutex);
+            std::uint64_t sum = 0;
+
+            for (std::uint32_t x : table.begin(), table.end()) {
+                sum += x;
+            }
+
+            return sum;
+        }, [&](std::uint32_t _version) {
+            std::lock_guard<Mutex> lock(mutex);
+            table.assign(table_size, _version);
+        });
+    }
+
+    /**
+     * @brief Registers lookups of a small table that one of the reading threads occasionally replaces, guarded by a
+     *        mutex, by a reader-writer lock and published through an rcu_container.
+     */
+    void register_rcu_cases(std::vector<benchmark_case>& cases) {
+        cases.push_back({"rcu", "vector<uint32_t>", reads, "mutex", []() {
+            locked_table<std::mutex, std::lock_guard<std::mutex>>();
+        }});
+
+        cases.push_back({"rcu", "vector<uint32_t>", reads, "shared_timed_mutex", []() {
+            locked_table<std::shared_timed_mutex, std::shared_lock<std::shared_timed_mutex>>();
+        }});
+
+        cases.push_back({"rcu", "vector<uint32_t>", reads, "rcu_container", []() {
+            rcu_container<std::vector<std::uint32_t>> table(std::vector<std::uint32_t>(table_size, 1));
+
+            read_mostly([&table]() {
+                std::uint64_t sum = 0;
+
+                for (std::uint32_t x : table.snapshot()) {
+                    sum += x;
+                }
+
+                return sum;
+            }, [&table](std::uint32_t _version) { table.store(std::vector<std::uint32_t>(table_size, _version)); });
+        }});
+    }
+
+    registrar rcu_cases(register_rcu_cases);
+
+} // namespace
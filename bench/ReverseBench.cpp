@@ -0,0 +1,81 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t sizes[] = {4096, 1048576};
+
+    /**
+     * @brief Registers summing a container of n elements forwards, backwards through std::reverse_iterator and
+     *        backwards with for_each() of a reversed range.
+     */
+    template <typename Container>
+    void add_reverse_sum_cases(std::vector<benchmark_case>& cases, const std::string& name) {
+        for (std::size_t n : sizes) {
+            auto values = std::make_shared<Container>();
+
+            for (std::size_t i = 0; i < n; ++i) {
+                values->push_back(static_cast<std::int32_t>(i % 100));
+            }
+
+            cases.push_back({"reverse_sum", name, n, "forward", [values]() {
+                std::int64_t sum = 0;
+                for_each((values->cbegin(), values->cend()), [&sum](std::int32_t x) { sum += x; });
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"reverse_sum", name, n, "reverse_iterator", [values]() {
+                std::int64_t sum = 0;
+                std::for_each(values->crbegin(), values->crend(), [&sum](std::int32_t x) { sum += x; });
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"reverse_sum", name, n, "reversed", [values]() {
+                std::int64_t sum = 0;
+                for_each(reversed((values->cbegin(), values->cend())), [&sum](std::int32_t x) { sum += x; });
+                do_not_optimize(sum);
+            }});
+        }
+    }
+
+    /**
+     * @brief Registers finding the last separator of a buffer of n bytes whose only separator is its first byte, with
+     *        std::find() over std::reverse_iterator and with find() of a reversed range.
+     */
+    void add_last_match_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto text = std::make_shared<std::string>(n, 'x');
+            (*text)[0] = '/';
+
+            cases.push_back({"last_match", "string", n, "reverse_iterator", [text]() {
+                do_not_optimize(std::find(text->crbegin(), text->crend(), '/').base());
+            }});
+
+            cases.push_back({"last_match", "string", n, "reversed", [text]() {
+                do_not_optimize(find(reversed((text->cbegin(), text->cend())), '/').base());
+            }});
+        }
+    }
+
+    void register_reverse_cases(std::vector<benchmark_case>& cases) {
+        add_reverse_sum_cases<std::vector<std::int32_t>>(cases, "vector<int32_t>");
+        add_reverse_sum_cases<std::list<std::int32_t>>(cases, "list<int32_t>");
+        add_last_match_cases(cases);
+    }
+
+    registrar reverse_cases(register_reverse_cases);
+
+}
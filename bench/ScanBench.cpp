@@ -0,0 +1,76 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForParallel.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t sizes[] = {65536, 1048576, 4194304};
+
+    /**
+     * @brief Returns the thread counts the parallel scan is measured with: powers of two up to the hardware
+     *        concurrency, and the hardware concurrency itself.
+     */
+    std::vector<std::size_t> thread_counts() {
+        std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::size_t> counts;
+
+        for (std::size_t t = 1; t < hardware; t *= 2) {
+            counts.push_back(t);
+        }
+
+        counts.push_back(hardware);
+        return counts;
+    }
+
+    /**
+     * @brief Registers std::partial_sum, the sequential inclusive_scan and the parallel inclusive_scan with an
+     *        increasing number of threads over the same offset table, so that the scaling curve can be read off the
+     *        parallel cases.
+     */
+    void register_scan_cases(std::vector<benchmark_case>& cases) {
+        using IteratorBasedForImpl::thread_pool;
+        namespace execution = IteratorBasedForImpl::execution;
+
+        for (std::size_t n : sizes) {
+            auto in = std::make_shared<std::vector<long>>(n);
+            auto out = std::make_shared<std::vector<long>>(n);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                (*in)[i] = static_cast<long>(i % 17);
+            }
+
+            cases.push_back({"scan", "vector", n, "std_partial_sum", [in, out]() {
+                std::partial_sum(in->begin(), in->end(), out->begin());
+                do_not_optimize(out->back());
+            }});
+
+            cases.push_back({"scan", "vector", n, "seq", [in, out]() {
+                IteratorBasedForImpl::inclusive_scan(execution::seq, (in->cbegin(), in->cend()), out->begin());
+                do_not_optimize(out->back());
+            }});
+
+            for (std::size_t threads : thread_counts()) {
+                auto pool = std::make_shared<thread_pool>(threads - 1);
+
+                cases.push_back({"scan", "vector", n, "par_" + std::to_string(threads), [in, out, pool]() {
+                    IteratorBasedForImpl::inclusive_scan(execution::par.on(*pool), (in->cbegin(), in->cend()),
+                                                         out->begin());
+                    do_not_optimize(out->back());
+                }});
+            }
+        }
+    }
+
+    registrar scan_cases(register_scan_cases);
+
+} // namespace
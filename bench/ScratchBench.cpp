@@ -0,0 +1,71 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForParallel.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t row_length = 32;
+
+    /**
+     * @brief Returns the largest difference between neighbours of a row, computed in _buffer, as loop bodies needing
+     *        a small temporary buffer per element do.
+     */
+    template <typename Buffer>
+    float largest_step(const std::vector<float>& _row, Buffer& _buffer) {
+        _buffer.resize(_row.size());
+        std::adjacent_difference(_row.begin(), _row.end(), _buffer.begin());
+        return *std::max_element(_buffer.begin() + 1, _buffer.end());
+    }
+
+    /**
+     * @brief Registers the largest steps of _n rows on the default pool, with the temporary buffer of every row
+     *        allocated by the global allocator and by the scratch arena of the thread.
+     */
+    void register_sizes(std::vector<benchmark_case>& cases, std::size_t _n) {
+        auto rows = std::make_shared<std::vector<std::vector<float>>>(_n, std::vector<float>(row_length));
+        auto steps = std::make_shared<std::vector<float>>(_n);
+
+        for (std::size_t i = 0; i < _n; ++i) {
+            for (std::size_t j = 0; j < row_length; ++j) {
+                (*rows)[i][j] = static_cast<float>((i * 7919 + j * 104729) % 1000);
+            }
+        }
+
+        cases.push_back({"scratch", "vector<vector<float>>/largest_step", _n, "std_allocator", [rows, steps]() {
+            for_each(execution::par, (rows->begin(), rows->end()), [&rows, &steps](const std::vector<float>& r) {
+                std::vector<float> buffer;
+                (*steps)[static_cast<std::size_t>(&r - rows->data())] = largest_step(r, buffer);
+            });
+
+            do_not_optimize(steps->front());
+        }});
+
+        cases.push_back({"scratch", "vector<vector<float>>/largest_step", _n, "scratch_arena", [rows, steps]() {
+            for_each(execution::par, (rows->begin(), rows->end()),
+                     [&rows, &steps](const std::vector<float>& r, scratch_arena& arena) {
+                std::vector<float, scratch_allocator<float>> buffer{scratch_allocator<float>(arena)};
+                (*steps)[static_cast<std::size_t>(&r - rows->data())] = largest_step(r, buffer);
+            });
+
+            do_not_optimize(steps->front());
+        }});
+    }
+
+    void register_scratch_cases(std::vector<benchmark_case>& cases) {
+        register_sizes(cases, 4096);
+        register_sizes(cases, std::size_t(1) << 18);
+    }
+
+    registrar scratch_cases(register_scratch_cases);
+
+} // namespace
@@ -0,0 +1,79 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t sizes[] = {16384, 1048576, 16777216};
+
+    const std::size_t lookups = 4096;
+
+    using index_type = IteratorBasedForImpl::eytzinger_index<std::vector<std::uint32_t>::const_iterator>;
+
+    /**
+     * @brief Registers random lookups into sorted vectors of several sizes with std::lower_bound, the branchless
+     *        lower_bound and an eytzinger_index. Every pass counts the elements below 4096 random keys.
+     */
+    void register_search_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto v = std::make_shared<std::vector<std::uint32_t>>(n);
+            auto keys = std::make_shared<std::vector<std::uint32_t>>(lookups);
+            std::mt19937 random(1);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                (*v)[i] = static_cast<std::uint32_t>(2 * i);
+            }
+
+            for (std::uint32_t& key : *keys) {
+                key = static_cast<std::uint32_t>(random() % (2 * n));
+            }
+
+            auto index = std::make_shared<index_type>((v->cbegin(), v->cend()));
+            const std::string container = "vector<uint32_t>/" + std::to_string(n);
+
+            cases.push_back({"lower_bound", container, lookups, "std_lower_bound", [v, keys]() {
+                std::size_t total = 0;
+
+                for (std::uint32_t key : *keys) {
+                    total += static_cast<std::size_t>(std::lower_bound(v->cbegin(), v->cend(), key) - v->cbegin());
+                }
+
+                do_not_optimize(total);
+            }});
+
+            cases.push_back({"lower_bound", container, lookups, "branchless", [v, keys]() {
+                std::size_t total = 0;
+
+                for (std::uint32_t key : *keys) {
+                    total += static_cast<std::size_t>(IteratorBasedForImpl::lower_bound((v->cbegin(), v->cend()), key)
+                                                      - v->cbegin());
+                }
+
+                do_not_optimize(total);
+            }});
+
+            cases.push_back({"lower_bound", container, lookups, "eytzinger_index", [v, keys, index]() {
+                std::size_t total = 0;
+
+                for (std::uint32_t key : *keys) {
+                    total += static_cast<std::size_t>(index->lower_bound(key) - v->cbegin());
+                }
+
+                do_not_optimize(total);
+            }});
+        }
+    }
+
+    registrar search_cases(register_search_cases);
+
+} // namespace
@@ -0,0 +1,183 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t sizes[] = {65536, 1048576};
+
+    /**
+     * @brief Registers summing, filling and copying a std::deque with a range-based for loop and with the segmented
+     *        algorithms.
+     */
+    void register_segmented_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto d = std::make_shared<std::deque<int>>(n, 1);
+            auto out = std::make_shared<std::vector<int>>(n);
+
+            cases.push_back({"segmented_sum", "deque<int>", n, "range_for", [d]() {
+                int sum = 0;
+                auto b = d->cbegin();
+                auto e = d->cend();
+
+                for (int x : b, e) {
+                    sum += x;
+                }
+
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"segmented_sum", "deque<int>", n, "for_each", [d]() {
+                int sum = 0;
+                IteratorBasedForImpl::for_each((d->cbegin(), d->cend()), [&sum](int x) { sum += x; });
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"segmented_fill", "deque<int>", n, "range_for", [d]() {
+                auto b = d->begin();
+                auto e = d->end();
+
+                for (int& x : b, e) {
+                    x = 2;
+                }
+
+                do_not_optimize(d->back());
+            }});
+
+            cases.push_back({"segmented_fill", "deque<int>", n, "fill", [d]() {
+                IteratorBasedForImpl::fill((d->begin(), d->end()), 2);
+                do_not_optimize(d->back());
+            }});
+
+            cases.push_back({"segmented_copy", "deque<int>", n, "range_for", [d, out]() {
+                auto o = out->begin();
+                auto b = d->cbegin();
+                auto e = d->cend();
+
+                for (int x : b, e) {
+                    *o = x;
+                    ++o;
+                }
+
+                do_not_optimize(out->back());
+            }});
+
+            cases.push_back({"segmented_copy", "deque<int>", n, "copy", [d, out]() {
+                IteratorBasedForImpl::copy((d->cbegin(), d->cend()), out->begin());
+                do_not_optimize(out->back());
+            }});
+        }
+    }
+
+    /**
+     * @brief Registers summing a circular buffer that wraps halfway with a range-based for loop and with for_each.
+     */
+    void register_ring_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto buffer = std::make_shared<std::vector<int>>(n, 1);
+
+            cases.push_back({"ring_sum", "ring<int>", n, "range_for", [buffer]() {
+                int sum = 0;
+
+                for (int x : IteratorBasedForImpl::ring_range(buffer->data(), buffer->size(), buffer->size() / 2,
+                                                               buffer->size())) {
+                    sum += x;
+                }
+
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"ring_sum", "ring<int>", n, "for_each", [buffer]() {
+                int sum = 0;
+                IteratorBasedForImpl::for_each(IteratorBasedForImpl::ring_range(buffer->data(), buffer->size(),
+                                                                                buffer->size() / 2, buffer->size()),
+                                               [&sum](int x) { sum += x; });
+                do_not_optimize(sum);
+            }});
+        }
+    }
+
+    /**
+     * @brief Registers copying a message made of 32 byte fragments out of a concatenation with a range-based for
+     *        loop and with copy().
+     */
+    void register_concat_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto message = std::make_shared<const std::vector<char>>(n, 'm');
+            auto out = std::make_shared<std::vector<char>>(n);
+            std::vector<IteratorBasedForImpl::iterator_range<const char*>> fragments;
+
+            for (std::size_t i = 0; i < 32; ++i) {
+                fragments.push_back(IteratorBasedForImpl::make_iterator_range(message->data() + i * n / 32,
+                                                                              message->data() + (i + 1) * n / 32));
+            }
+
+            auto joined = IteratorBasedForImpl::concat(fragments);
+
+            cases.push_back({"concat_copy", "fragments<char>", n, "range_for", [message, out, joined]() {
+                char* o = out->data();
+
+                for (char c : joined) {
+                    *o++ = c;
+                }
+
+                do_not_optimize(out->back());
+            }});
+
+            cases.push_back({"concat_copy", "fragments<char>", n, "copy", [message, out, joined]() {
+                IteratorBasedForImpl::copy(joined, out->data());
+                do_not_optimize(out->back());
+            }});
+        }
+    }
+
+    /**
+     * @brief Registers summing a vector of 64 rows with a range-based for loop over join(), with reduce() over join()
+     *        and with a nested loop.
+     */
+    void register_join_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto rows = std::make_shared<std::vector<std::vector<int>>>(64, std::vector<int>(n / 64, 1));
+
+            cases.push_back({"join_sum", "vector<vector<int>>", n, "range_for", [rows]() {
+                int sum = 0;
+
+                for (int x : IteratorBasedForImpl::join((rows->cbegin(), rows->cend()))) {
+                    sum += x;
+                }
+
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"join_sum", "vector<vector<int>>", n, "reduce", [rows]() {
+                do_not_optimize(IteratorBasedForImpl::reduce(IteratorBasedForImpl::join((rows->cbegin(),
+                                                                                          rows->cend())), 0));
+            }});
+
+            cases.push_back({"join_sum", "vector<vector<int>>", n, "nested_loop", [rows]() {
+                int sum = 0;
+
+                for (const std::vector<int>& row : *rows) {
+                    for (int x : row) {
+                        sum += x;
+                    }
+                }
+
+                do_not_optimize(sum);
+            }});
+        }
+    }
+
+    registrar segmented_cases(register_segmented_cases);
+    registrar ring_cases(register_ring_cases);
+    registrar concat_cases(register_concat_cases);
+    registrar join_cases(register_join_cases);
+
+} // namespace
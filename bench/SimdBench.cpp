@@ -0,0 +1,164 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForSimd.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    namespace simd = IteratorBasedForImpl::simd;
+
+    const std::size_t sizes[] = {1024, 65536, 1048576};
+
+    const simd::instruction_set instruction_sets[] = {
+        simd::instruction_set::scalar, simd::instruction_set::sse2, simd::instruction_set::avx2,
+        simd::instruction_set::avx512, simd::instruction_set::neon
+    };
+
+    /**
+     * @brief Registers the sum, min_max and find kernels for every supported instruction set, next to the equivalent
+     *        standard algorithm, over the same data.
+     */
+    template <typename T>
+    void add_simd_cases(std::vector<benchmark_case>& cases, const std::string& name) {
+        for (std::size_t n : sizes) {
+            auto v = std::make_shared<std::vector<T>>(n);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                (*v)[i] = static_cast<T>(i % 100);
+            }
+
+            cases.push_back({"simd_sum", name, n, "std_accumulate", [v]() {
+                do_not_optimize(std::accumulate(v->begin(), v->end(), typename simd::sum_type<T>::type()));
+            }});
+
+            for (simd::instruction_set set : instruction_sets) {
+                if (!simd::is_supported(set)) {
+                    continue;
+                }
+
+                cases.push_back({"simd_sum", name, n, simd::name(set), [v, set]() {
+                    simd::select_instruction_set(set);
+                    do_not_optimize(simd::sum((v->cbegin(), v->cend())));
+                }});
+
+                cases.push_back({"simd_min_max", name, n, simd::name(set), [v, set]() {
+                    simd::select_instruction_set(set);
+                    do_not_optimize(simd::min_max((v->cbegin(), v->cend())));
+                }});
+
+                cases.push_back({"simd_find", name, n, simd::name(set), [v, set]() {
+                    simd::select_instruction_set(set);
+                    do_not_optimize(simd::find((v->cbegin(), v->cend()), T(101)));
+                }});
+            }
+        }
+    }
+
+    /**
+     * @brief Registers the intersection of two posting lists with random gaps, both of 1 Mi elements or of 8192 and
+     *        1 Mi elements, next to std::set_intersection.
+     */
+    template <typename T>
+    void add_set_cases(std::vector<benchmark_case>& cases, const std::string& name) {
+        const std::size_t n = 1048576;
+
+        for (std::size_t small : {n, std::size_t(8192)}) {
+            auto a = std::make_shared<std::vector<T>>();
+            auto b = std::make_shared<std::vector<T>>();
+            auto out = std::make_shared<std::vector<T>>(n);
+            std::mt19937 random(1);
+            T x = 0;
+            T y = 0;
+
+            for (std::size_t i = 0; i < n; ++i) {
+                x = static_cast<T>(x + 1 + random() % 4);
+                b->push_back(x);
+            }
+
+            for (std::size_t i = 0; i < small; ++i) {
+                y = static_cast<T>(y + 1 + random() % (4 * n / small));
+                a->push_back(y);
+            }
+
+            const std::string container = name + (small == n ? "/1:1" : "/1:128");
+
+            cases.push_back({"simd_set_intersection", container, n, "std_set_intersection", [a, b, out]() {
+                do_not_optimize(std::set_intersection(a->begin(), a->end(), b->begin(), b->end(), out->begin()));
+            }});
+
+            for (simd::instruction_set set : instruction_sets) {
+                if (!simd::is_supported(set)) {
+                    continue;
+                }
+
+                cases.push_back({"simd_set_intersection", container, n, simd::name(set), [a, b, out, set]() {
+                    simd::select_instruction_set(set);
+                    do_not_optimize(simd::set_intersection((a->cbegin(), a->cend()), (b->cbegin(), b->cend()),
+                                                           out->begin()));
+                }});
+            }
+        }
+    }
+
+    /**
+     * @brief Registers transposing a row-major matrix of _rows x _columns elements with a double loop over the
+     *        output and with simd::transpose for every supported instruction set.
+     */
+    template <typename T>
+    void add_transpose_cases(std::vector<benchmark_case>& cases, const std::string& name, std::size_t _rows,
+                             std::size_t _columns) {
+        auto in = std::make_shared<std::vector<T>>(_rows * _columns);
+        auto out = std::make_shared<std::vector<T>>(_rows * _columns);
+        std::iota(in->begin(), in->end(), T(0));
+
+        cases.push_back({"simd_transpose", name, _rows * _columns, "double_loop", [in, out, _rows, _columns]() {
+            const T* p = in->data();
+            T* q = out->data();
+
+            for (std::size_t c = 0; c < _columns; ++c) {
+                for (std::size_t r = 0; r < _rows; ++r) {
+                    q[c * _rows + r] = p[r * _columns + c];
+                }
+            }
+
+            do_not_optimize(out->data());
+        }});
+
+        for (simd::instruction_set set : instruction_sets) {
+            if (!simd::is_supported(set)) {
+                continue;
+            }
+
+            const std::size_t n = _rows * _columns;
+
+            cases.push_back({"simd_transpose", name, n, simd::name(set), [in, out, set, _rows, _columns]() {
+                simd::select_instruction_set(set);
+                do_not_optimize(simd::transpose((in->cbegin(), in->cend()), _rows, _columns, out->begin()));
+            }});
+        }
+    }
+
+    void register_simd_cases(std::vector<benchmark_case>& cases) {
+        add_simd_cases<float>(cases, "vector<float>");
+        add_simd_cases<std::int32_t>(cases, "vector<int32_t>");
+        add_simd_cases<std::uint8_t>(cases, "vector<uint8_t>");
+        add_set_cases<std::uint32_t>(cases, "vector<uint32_t>");
+        add_set_cases<std::uint64_t>(cases, "vector<uint64_t>");
+        add_transpose_cases<float>(cases, "vector<float>/2048x2048", 2048, 2048);
+        add_transpose_cases<float>(cases, "vector<float>/100000x24", 100000, 24);
+        add_transpose_cases<double>(cases, "vector<double>/1024x1024", 1024, 1024);
+        add_transpose_cases<std::uint8_t>(cases, "vector<uint8_t>/4096x4096", 4096, 4096);
+    }
+
+    registrar simd_cases(register_simd_cases);
+
+} // namespace
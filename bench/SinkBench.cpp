@@ -0,0 +1,96 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+#include <IteratorBasedForIO.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#if ITERATOR_BASED_FOR_HAS_FILE_DESCRIPTORS
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t sizes[] = {65536, 1048576};
+
+    struct record {
+        std::uint64_t key;
+        double value;
+    };
+
+    /**
+     * @brief A temporary file, removed when the last case using it is destroyed, that every pass rewrites from its
+     *        start.
+     */
+    class scratch_file {
+    private:
+        char m_path[32];
+        int m_descriptor;
+
+    public:
+        scratch_file() : m_path("/tmp/iterator_based_for_XXXXXX"), m_descriptor(::mkstemp(m_path)) { }
+
+        scratch_file(const scratch_file&) = delete;
+        scratch_file& operator=(const scratch_file&) = delete;
+
+        ~scratch_file() {
+            ::close(m_descriptor);
+            std::remove(m_path);
+        }
+
+        int rewind() const {
+            ::ftruncate(m_descriptor, 0);
+            ::lseek(m_descriptor, 0, SEEK_SET);
+            return m_descriptor;
+        }
+    };
+
+    /**
+     * @brief Registers writing records to a file with an fwrite per record through stdio's buffer, with a write
+     *        system call per record and with copy() into an async_file_sink.
+     */
+    void register_sink_cases(std::vector<benchmark_case>& cases) {
+        auto file = std::make_shared<scratch_file>();
+
+        for (std::size_t n : sizes) {
+            auto records = std::make_shared<std::vector<record>>(n);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                (*records)[i] = record{i, double(i) * 0.5};
+            }
+
+            cases.push_back({"sink", "record", n, "fwrite", [file, records]() {
+                std::FILE* stream = ::fdopen(::dup(file->rewind()), "wb");
+
+                for (const record& r : *records) {
+                    std::fwrite(&r, sizeof(record), 1, stream);
+                }
+
+                std::fclose(stream);
+            }});
+
+            cases.push_back({"sink", "record", n, "write", [file, records]() {
+                const int descriptor = file->rewind();
+
+                for (const record& r : *records) {
+                    do_not_optimize(::write(descriptor, &r, sizeof(record)));
+                }
+            }});
+
+            cases.push_back({"sink", "record", n, "async_file_sink", [file, records]() {
+                async_file_sink<record> sink(file->rewind());
+                copy((records->cbegin(), records->cend()), sink.begin());
+                sink.close();
+            }});
+        }
+    }
+
+    registrar sink_cases(register_sink_cases);
+
+}
+#endif
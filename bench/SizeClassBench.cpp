@@ -0,0 +1,66 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForParallel.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    /**
+     * @brief Registers the scaling of a tiny vector of _n floats with a plain index loop and with for_each(), which
+     *        dispatches ranges of at most tiny_range_threshold() elements to an unrolled loop.
+     */
+    void register_tiny(std::vector<benchmark_case>& cases, std::size_t _n) {
+        auto values = std::make_shared<std::vector<float>>(_n, 1.0f);
+
+        cases.push_back({"size_class", "vector<float>/tiny", _n, "raw_loop", [values]() {
+            float* data = values->data();
+            for (std::size_t i = 0; i < values->size(); ++i) {
+                data[i] *= 1.0009765625f;
+            }
+            do_not_optimize(values->front());
+        }});
+
+        cases.push_back({"size_class", "vector<float>/tiny", _n, "for_each", [values]() {
+            for_each((values->begin(), values->end()), [](float& v) { v *= 1.0009765625f; });
+            do_not_optimize(values->front());
+        }});
+    }
+
+    /**
+     * @brief Registers the parallel scaling of a medium vector of _n floats on the default pool, run on the calling
+     *        thread below parallel_range_threshold() and always split into blocks with a threshold of 0.
+     */
+    void register_medium(std::vector<benchmark_case>& cases, std::size_t _n) {
+        auto values = std::make_shared<std::vector<float>>(_n, 1.0f);
+
+        cases.push_back({"size_class", "vector<float>/medium", _n, "for_each_par_split", [values]() {
+            const std::size_t threshold = parallel_range_threshold();
+            set_parallel_range_threshold(0);
+            for_each(execution::par, (values->begin(), values->end()), [](float& v) { v *= 1.0009765625f; });
+            set_parallel_range_threshold(threshold);
+            do_not_optimize(values->front());
+        }});
+
+        cases.push_back({"size_class", "vector<float>/medium", _n, "for_each_par", [values]() {
+            for_each(execution::par, (values->begin(), values->end()), [](float& v) { v *= 1.0009765625f; });
+            do_not_optimize(values->front());
+        }});
+    }
+
+    void register_size_class_cases(std::vector<benchmark_case>& cases) {
+        register_tiny(cases, 7);
+        register_tiny(cases, 16);
+        register_medium(cases, 1024);
+        register_medium(cases, 4000);
+    }
+
+    registrar size_class_cases(register_size_class_cases);
+
+} // namespace
@@ -0,0 +1,74 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t n = 1 << 20;
+
+    /**
+     * @brief Registers building a Bloom filter, a HyperLogLog sketch and a count-min sketch of a million keys, adding
+     *        one key at a time and with the builders, which hash a block of keys in vectors first.
+     */
+    void register_sketch_cases(std::vector<benchmark_case>& cases) {
+        auto keys = std::make_shared<std::vector<std::uint64_t>>(n);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            (*keys)[i] = (i * 2654435761u) % (n / 2);
+        }
+
+        cases.push_back({"sketch", "bloom_filter", n, "add_each", [keys]() {
+            bloom_filter filter(8 * n, 6);
+
+            for (std::uint64_t k : keys->begin(), keys->end()) {
+                filter.add(k);
+            }
+
+            do_not_optimize(filter.words().front());
+        }});
+
+        cases.push_back({"sketch", "bloom_filter", n, "build_bloom", [keys]() {
+            do_not_optimize(build_bloom((keys->cbegin(), keys->cend()), 8 * n, 6).words().front());
+        }});
+
+        cases.push_back({"sketch", "hyperloglog_sketch", n, "add_each", [keys]() {
+            hyperloglog_sketch sketch;
+
+            for (std::uint64_t k : keys->begin(), keys->end()) {
+                sketch.add(k);
+            }
+
+            do_not_optimize(sketch.registers().front());
+        }});
+
+        cases.push_back({"sketch", "hyperloglog_sketch", n, "hyperloglog", [keys]() {
+            do_not_optimize(hyperloglog((keys->cbegin(), keys->cend())).registers().front());
+        }});
+
+        cases.push_back({"sketch", "count_min_sketch", n, "add_each", [keys]() {
+            count_min_sketch sketch;
+
+            for (std::uint64_t k : keys->begin(), keys->end()) {
+                sketch.add(k);
+            }
+
+            do_not_optimize(sketch.estimate(0));
+        }});
+
+        cases.push_back({"sketch", "count_min_sketch", n, "count_min", [keys]() {
+            do_not_optimize(count_min((keys->cbegin(), keys->cend())).estimate(0));
+        }});
+    }
+
+    registrar sketch_cases(register_sketch_cases);
+
+} // namespace
@@ -0,0 +1,96 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForParallel.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t sizes[] = {65536, 4194304};
+
+    std::vector<std::size_t> thread_counts() {
+        std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::size_t> counts;
+
+        for (std::size_t t = 1; t < hardware; t *= 2) {
+            counts.push_back(t);
+        }
+
+        counts.push_back(hardware);
+        return counts;
+    }
+
+    /**
+     * @brief Registers std::sort, the sequential sort and the parallel sort with an increasing number of threads,
+     *        sorting a fresh copy of the same random keys every pass. Ascending order takes the radix sort and
+     *        descending order the comparison sort. Every case includes the copy.
+     */
+    template <typename T>
+    void add_sort_cases(std::vector<benchmark_case>& cases, const std::string& name) {
+        using IteratorBasedForImpl::thread_pool;
+        namespace execution = IteratorBasedForImpl::execution;
+
+        for (std::size_t n : sizes) {
+            auto keys = std::make_shared<std::vector<T>>(n);
+            auto work = std::make_shared<std::vector<T>>(n);
+            std::mt19937_64 random(1);
+
+            for (T& key : *keys) {
+                key = static_cast<T>(random());
+            }
+
+            cases.push_back({"sort", name, n, "std_sort", [keys, work]() {
+                *work = *keys;
+                std::sort(work->begin(), work->end());
+                do_not_optimize(work->front());
+            }});
+
+            cases.push_back({"sort", name, n, "seq", [keys, work]() {
+                *work = *keys;
+                IteratorBasedForImpl::sort(execution::seq, (work->begin(), work->end()));
+                do_not_optimize(work->front());
+            }});
+
+            cases.push_back({"sort_descending", name, n, "std_sort", [keys, work]() {
+                *work = *keys;
+                std::sort(work->begin(), work->end(), std::greater<>());
+                do_not_optimize(work->front());
+            }});
+
+            for (std::size_t threads : thread_counts()) {
+                auto pool = std::make_shared<thread_pool>(threads - 1);
+
+                cases.push_back({"sort", name, n, "par_" + std::to_string(threads), [keys, work, pool]() {
+                    *work = *keys;
+                    IteratorBasedForImpl::sort(execution::par.on(*pool), (work->begin(), work->end()));
+                    do_not_optimize(work->front());
+                }});
+
+                cases.push_back({"sort_descending", name, n, "par_" + std::to_string(threads), [keys, work, pool]() {
+                    *work = *keys;
+                    IteratorBasedForImpl::sort(execution::par.on(*pool), (work->begin(), work->end()),
+                                               std::greater<>());
+                    do_not_optimize(work->front());
+                }});
+            }
+        }
+    }
+
+    void register_sort_cases(std::vector<benchmark_case>& cases) {
+        add_sort_cases<std::uint32_t>(cases, "vector<uint32_t>");
+        add_sort_cases<double>(cases, "vector<double>");
+    }
+
+    registrar sort_cases(register_sort_cases);
+
+} // namespace
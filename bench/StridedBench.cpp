@@ -0,0 +1,88 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t sizes[] = {4096, 1048576};
+
+    const simd::instruction_set instruction_sets[] = {
+        simd::instruction_set::scalar, simd::instruction_set::sse2, simd::instruction_set::avx2,
+        simd::instruction_set::avx512, simd::instruction_set::neon
+    };
+
+    /**
+     * @brief Registers pulling every _stride-th element of an interleaved buffer into a channel of n elements, with
+     *        an indexed loop and with copy() of a strided range for every supported instruction set, and summing the
+     *        channel with an indexed loop and with for_each() of a strided range.
+     */
+    template <typename T>
+    void add_strided_cases(std::vector<benchmark_case>& cases, const std::string& name, std::size_t _stride) {
+        for (std::size_t n : sizes) {
+            auto in = std::make_shared<std::vector<T>>(n * _stride);
+            auto out = std::make_shared<std::vector<T>>(n);
+
+            for (std::size_t i = 0; i < in->size(); ++i) {
+                (*in)[i] = static_cast<T>(i % 100);
+            }
+
+            cases.push_back({"strided_copy", name, n, "indexed_loop", [in, out, _stride, n]() {
+                const T* p = in->data();
+                T* q = out->data();
+
+                for (std::size_t i = 0; i < n; ++i) {
+                    q[i] = p[i * _stride];
+                }
+
+                do_not_optimize(out->data());
+            }});
+
+            cases.push_back({"strided_sum", name, n, "indexed_loop", [in, _stride, n]() {
+                const T* p = in->data();
+                typename simd::sum_type<T>::type sum = 0;
+
+                for (std::size_t i = 0; i < n; ++i) {
+                    sum += p[i * _stride];
+                }
+
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"strided_sum", name, n, "for_each", [in, _stride]() {
+                typename simd::sum_type<T>::type sum = 0;
+                for_each(strided((in->cbegin(), in->cend()), _stride), [&sum](T x) { sum += x; });
+                do_not_optimize(sum);
+            }});
+
+            for (simd::instruction_set set : instruction_sets) {
+                if (!simd::is_supported(set)) {
+                    continue;
+                }
+
+                cases.push_back({"strided_copy", name, n, simd::name(set), [in, out, _stride, set]() {
+                    simd::select_instruction_set(set);
+                    do_not_optimize(copy(strided((in->cbegin(), in->cend()), _stride), out->begin()));
+                }});
+            }
+        }
+    }
+
+    void register_strided_cases(std::vector<benchmark_case>& cases) {
+        add_strided_cases<float>(cases, "iq<float>/2", 2);
+        add_strided_cases<std::uint8_t>(cases, "rgb<uint8_t>/3", 3);
+        add_strided_cases<std::int32_t>(cases, "rgba<int32_t>/4", 4);
+        add_strided_cases<float>(cases, "channels<float>/8", 8);
+    }
+
+    registrar strided_cases(register_strided_cases);
+
+}
@@ -0,0 +1,72 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAdaptors.hpp>
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t sizes[] = {4096, 1048576};
+
+    /**
+     * @brief Registers materializing a range into a vector with the iterator pair constructor of std::vector, with a
+     *        push_back loop and with to(), for a sized contiguous range, a std::list of unknown size and a filter
+     *        view, which the constructor walks twice, running the predicate each time. The cases share the
+     *        ownership of the container the range refers to.
+     */
+    template <typename Range>
+    void add_to_cases(std::vector<benchmark_case>& cases, const std::string& container, std::size_t n,
+                      std::shared_ptr<const void> owner, std::shared_ptr<Range> range) {
+        cases.push_back({"to", container, n, "vector_constructor", [owner, range]() {
+            std::vector<int> out(range->begin(), range->end());
+            do_not_optimize(out.data());
+        }});
+
+        cases.push_back({"to", container, n, "push_back", [owner, range]() {
+            std::vector<int> out;
+
+            for (int x : *range) {
+                out.push_back(x);
+            }
+
+            do_not_optimize(out.data());
+        }});
+
+        cases.push_back({"to", container, n, "to", [owner, range]() {
+            std::vector<int> out = to<std::vector<int>>(*range);
+            do_not_optimize(out.data());
+        }});
+    }
+
+    void register_to_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto data = std::make_shared<std::vector<int>>(n);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                (*data)[i] = static_cast<int>(i * 7919 % 1000);
+            }
+
+            auto list = std::make_shared<std::list<int>>(data->begin(), data->end());
+            auto odd = [](int x) { return x % 2 != 0; };
+
+            add_to_cases(cases, "vector<int>", n, data, std::make_shared<decltype((data->cbegin(), data->cend()))>(
+                    (data->cbegin(), data->cend())));
+            add_to_cases(cases, "list<int>", n, list, std::make_shared<decltype((list->cbegin(), list->cend()))>(
+                    (list->cbegin(), list->cend())));
+            add_to_cases(cases, "filter", n, data,
+                         std::make_shared<decltype(filter((data->cbegin(), data->cend()), odd))>(
+                             filter((data->cbegin(), data->cend()), odd)));
+        }
+    }
+
+    registrar to_cases(register_to_cases);
+
+}
@@ -0,0 +1,63 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForParallel.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    /**
+     * @brief Registers the selection of the _k best of _n uniformly distributed float scores with std::partial_sort
+     *        on a copy, with std::partial_sort_copy, which keeps a heap of _k elements, and with top_k().
+     */
+    void register_sizes(std::vector<benchmark_case>& cases, std::size_t _n, std::size_t _k) {
+        auto scores = std::make_shared<std::vector<float>>(_n);
+        auto copy = std::make_shared<std::vector<float>>(_n);
+        auto best = std::make_shared<std::vector<float>>(_k);
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> score(0.0f, 1.0f);
+
+        std::generate(scores->begin(), scores->end(), [&]() { return score(random); });
+
+        const std::string container = "vector<float>/top_" + std::to_string(_k);
+
+        cases.push_back({"top_k", container, _n, "std_partial_sort", [scores, copy, _k]() {
+            std::copy(scores->begin(), scores->end(), copy->begin());
+            std::partial_sort(copy->begin(), copy->begin() + static_cast<std::ptrdiff_t>(_k), copy->end(),
+                              std::greater<float>());
+            do_not_optimize(copy->front());
+        }});
+
+        cases.push_back({"top_k", container, _n, "std_partial_sort_copy", [scores, best]() {
+            std::partial_sort_copy(scores->begin(), scores->end(), best->begin(), best->end(), std::greater<float>());
+            do_not_optimize(best->front());
+        }});
+
+        cases.push_back({"top_k", container, _n, "top_k", [scores, best, _k]() {
+            top_k((scores->cbegin(), scores->cend()), _k, best->begin());
+            do_not_optimize(best->front());
+        }});
+
+        cases.push_back({"top_k", container, _n, "top_k_par", [scores, best, _k]() {
+            top_k(execution::par, (scores->cbegin(), scores->cend()), _k, best->begin());
+            do_not_optimize(best->front());
+        }});
+    }
+
+    void register_top_k_cases(std::vector<benchmark_case>& cases) {
+        register_sizes(cases, std::size_t(1) << 16, 100);
+        register_sizes(cases, 10000000, 100);
+    }
+
+    registrar top_k_cases(register_top_k_cases);
+
+} // namespace
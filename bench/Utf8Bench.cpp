@@ -0,0 +1,103 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+    using namespace IteratorBasedForImpl;
+
+    const std::size_t sizes[] = {4096, 1048576};
+
+    /**
+     * @brief The range-based for loop over the bytes that validate_utf8() replaces, checking one sequence after the
+     *        other.
+     */
+    bool byte_loop_validate(const std::string& _text) {
+        std::size_t pending = 0;
+        unsigned low = 0x80;
+        unsigned high = 0xBF;
+
+        for (char c : _text) {
+            const unsigned byte = static_cast<unsigned char>(c);
+
+            if (pending != 0) {
+                if (byte < low || byte > high) {
+                    return false;
+                }
+
+                low = 0x80;
+                high = 0xBF;
+                --pending;
+            } else if (byte >= 0x80) {
+                if (byte < 0xC2 || byte > 0xF4) {
+                    return false;
+                }
+
+                pending = byte < 0xE0 ? 1 : byte < 0xF0 ? 2 : 3;
+                low = byte == 0xE0 ? 0xA0 : byte == 0xF0 ? 0x90 : 0x80;
+                high = byte == 0xED ? 0x9F : byte == 0xF4 ? 0x8F : 0xBF;
+            }
+        }
+
+        return pending == 0;
+    }
+
+    /**
+     * @brief Returns about _n bytes of text whose code points take one byte with probability _ascii and two or three
+     *        bytes otherwise, as in European and Asian text.
+     */
+    std::string make_text(std::size_t _n, double _ascii) {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<double> kind(0, 1);
+        std::string text;
+
+        while (text.size() < _n) {
+            const double k = kind(random);
+
+            if (k < _ascii) {
+                text += static_cast<char>('a' + random() % 26);
+            } else if (k < (1 + _ascii) / 2) {
+                text += "\xC3\xA9";
+            } else {
+                text += "\xE6\x97\xA5";
+            }
+        }
+
+        return text;
+    }
+
+    void add_utf8_cases(std::vector<benchmark_case>& cases, const std::string& _container, double _ascii) {
+        for (std::size_t n : sizes) {
+            auto text = std::make_shared<std::string>(make_text(n, _ascii));
+            auto out = std::make_shared<std::u16string>(text->size(), u'\0');
+
+            cases.push_back({"utf8", _container, n, "byte_loop", [text]() {
+                do_not_optimize(byte_loop_validate(*text));
+            }});
+
+            cases.push_back({"utf8", _container, n, "validate_utf8", [text]() {
+                do_not_optimize(validate_utf8((text->cbegin(), text->cend())));
+            }});
+
+            cases.push_back({"utf8", _container, n, "utf8_to_utf16", [text, out]() {
+                do_not_optimize(utf8_to_utf16((text->cbegin(), text->cend()), out->begin()));
+            }});
+        }
+    }
+
+    void register_utf8_cases(std::vector<benchmark_case>& cases) {
+        add_utf8_cases(cases, "ascii", 1.0);
+        add_utf8_cases(cases, "mixed", 0.7);
+    }
+
+    registrar utf8_cases(register_utf8_cases);
+
+}
@@ -0,0 +1,131 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAdaptors.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t sizes[] = {65536, 4194304};
+
+    /**
+     * @brief Registers a scale, select and sum pipeline written with vectors materialized between the stages, with
+     *        transform() and filter() views and as a hand-fused loop.
+     */
+    void register_view_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto data = std::make_shared<std::vector<int>>(n);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                (*data)[i] = static_cast<int>(i * 7919 % 1000);
+            }
+
+            cases.push_back({"views", "vector<int>", n, "materialized", [data]() {
+                std::vector<int> scaled(data->size());
+                std::transform(data->begin(), data->end(), scaled.begin(), [](int x) { return x * 3; });
+
+                std::vector<int> selected;
+                std::copy_if(scaled.begin(), scaled.end(), std::back_inserter(selected),
+                             [](int x) { return x > 1500; });
+
+                long long sum = 0;
+
+                for (int x : selected) {
+                    sum += x;
+                }
+
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"views", "vector<int>", n, "views", [data]() {
+                auto scaled = IteratorBasedForImpl::transform((data->begin(), data->end()),
+                                                              [](int x) { return x * 3; });
+                long long sum = 0;
+
+                for (int x : IteratorBasedForImpl::filter(scaled, [](int x) { return x > 1500; })) {
+                    sum += x;
+                }
+
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"views", "vector<int>", n, "raw_loop", [data]() {
+                long long sum = 0;
+
+                for (int x : *data) {
+                    if (x * 3 > 1500) {
+                        sum += x * 3;
+                    }
+                }
+
+                do_not_optimize(sum);
+            }});
+        }
+    }
+
+    registrar view_cases(register_view_cases);
+
+    /**
+     * @brief Registers a rolling sum over windows of 32 elements computed by summing each window of sliding(), with
+     *        sliding_for_each() and with a hand-written loop.
+     */
+    void register_sliding_cases(std::vector<benchmark_case>& cases) {
+        const std::size_t window = 32;
+
+        for (std::size_t n : sizes) {
+            auto ticks = std::make_shared<std::vector<double>>(n, 1.25);
+
+            cases.push_back({"sliding", "vector<double>", n, "rescan", [ticks, window]() {
+                double total = 0;
+
+                for (auto w : IteratorBasedForImpl::sliding((ticks->cbegin(), ticks->cend()), window)) {
+                    double sum = 0;
+
+                    for (double x : w) {
+                        sum += x;
+                    }
+
+                    total += sum;
+                }
+
+                do_not_optimize(total);
+            }});
+
+            cases.push_back({"sliding", "vector<double>", n, "sliding_for_each", [ticks, window]() {
+                double sum = 0;
+                double total = 0;
+
+                IteratorBasedForImpl::sliding_for_each((ticks->cbegin(), ticks->cend()), window,
+                                                       [&sum, &total](double in, const double* out) {
+                    sum += in - (out ? *out : 0.0);
+                    total += sum;
+                });
+
+                do_not_optimize(total);
+            }});
+
+            cases.push_back({"sliding", "vector<double>", n, "raw_loop", [ticks, window]() {
+                const double* x = ticks->data();
+                const std::size_t count = ticks->size();
+                double sum = 0;
+                double total = 0;
+
+                for (std::size_t i = 0; i < count; ++i) {
+                    sum += x[i] - (i >= window ? x[i - window] : 0.0);
+                    total += sum;
+                }
+
+                do_not_optimize(total);
+            }});
+        }
+    }
+
+    registrar sliding_cases(register_sliding_cases);
+
+} // namespace
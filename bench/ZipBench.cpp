@@ -0,0 +1,111 @@
+#include "BenchHarness.hpp"
+
+#include <IteratorBasedForAdaptors.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+    using namespace IteratorBasedForBench;
+
+    const std::size_t sizes[] = {1024, 65536, 1048576};
+
+    struct particles {
+        std::vector<float> x;
+        std::vector<float> vx;
+        std::vector<float> ax;
+
+        explicit particles(std::size_t _n) : x(_n, 1.0f), vx(_n, 0.5f), ax(_n, 0.25f) { }
+    };
+
+    /**
+     * @brief Registers an integration step over a struct-of-arrays layout written as an index loop and as a loop
+     *        over zip(), which should both compile to the same vectorized loop.
+     */
+    void register_zip_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto p = std::make_shared<particles>(n);
+
+            cases.push_back({"zip", "soa<float>", n, "raw_loop", [p]() {
+                float* x = p->x.data();
+                float* vx = p->vx.data();
+                const float* ax = p->ax.data();
+                const std::size_t count = p->x.size();
+
+                for (std::size_t i = 0; i < count; ++i) {
+                    vx[i] += ax[i] * 0.01f;
+                    x[i] += vx[i] * 0.01f;
+                }
+
+                do_not_optimize(p->x.back());
+            }});
+
+            cases.push_back({"zip", "soa<float>", n, "zip", [p]() {
+                for (auto particle : IteratorBasedForImpl::zip((p->x.begin(), p->x.end()),
+                                                               (p->vx.begin(), p->vx.end()),
+                                                               (p->ax.cbegin(), p->ax.cend()))) {
+                    std::get<1>(particle) += std::get<2>(particle) * 0.01f;
+                    std::get<0>(particle) += std::get<1>(particle) * 0.01f;
+                }
+
+                do_not_optimize(p->x.back());
+            }});
+        }
+    }
+
+    registrar zip_cases(register_zip_cases);
+
+    /**
+     * @brief Registers a weighted sum written with a hand-maintained counter and with enumerate() over 64- and
+     *        32-bit indices.
+     */
+    void register_enumerate_cases(std::vector<benchmark_case>& cases) {
+        for (std::size_t n : sizes) {
+            auto values = std::make_shared<std::vector<float>>(n, 1.5f);
+            auto weights = std::make_shared<std::vector<float>>(n, 0.5f);
+
+            cases.push_back({"enumerate", "vector<float>", n, "manual_counter", [values, weights]() {
+                const float* w = weights->data();
+                std::size_t i = 0;
+                float sum = 0.0f;
+
+                for (float x : *values) {
+                    sum += x * w[i];
+                    ++i;
+                }
+
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"enumerate", "vector<float>", n, "enumerate", [values, weights]() {
+                const float* w = weights->data();
+                float sum = 0.0f;
+
+                for (auto element : IteratorBasedForImpl::enumerate((values->cbegin(), values->cend()))) {
+                    sum += element.second * w[element.first];
+                }
+
+                do_not_optimize(sum);
+            }});
+
+            cases.push_back({"enumerate", "vector<float>", n, "enumerate_uint32", [values, weights]() {
+                const float* w = weights->data();
+                float sum = 0.0f;
+
+                for (auto element : IteratorBasedForImpl::enumerate<std::uint32_t>((values->cbegin(),
+                                                                                    values->cend()))) {
+                    sum += element.second * w[element.first];
+                }
+
+                do_not_optimize(sum);
+            }});
+        }
+    }
+
+    registrar enumerate_cases(register_enumerate_cases);
+
+} // namespace
@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef ITERATOR_BASED_FOR_CXX_COMPILER
+#define ITERATOR_BASED_FOR_CXX_COMPILER "c++"
+#endif
+
+#ifndef ITERATOR_BASED_FOR_CXX_COMPILER_ID
+#define ITERATOR_BASED_FOR_CXX_COMPILER_ID ""
+#endif
+
+#ifndef ITERATOR_BASED_FOR_INCLUDE_DIR
+#define ITERATOR_BASED_FOR_INCLUDE_DIR "."
+#endif
+
+namespace
+{
+
+    /**
+     * @brief The shape of a generated translation unit. Every variant defines the same number of distinct class
+     *        types so that the difference between variants is the cost of the comma overload and its traits.
+     */
+    enum class variant {
+        baseline,               //Iterator types only, no comma expressions.
+        iterator_comma,         //One (begin, end) comma expression per iterator type.
+        non_iterator_comma,     //One comma expression per non-iterator class type, which rejects the overload.
+        std_iterator_baseline,  //A loop over std::vector<type>::iterator per class type, no comma expressions.
+        std_iterator_comma      //One (begin, end) comma expression per std::vector<type>::iterator.
+    };
+
+    const char* variant_name(variant v) {
+        switch (v) {
+            case variant::baseline:              return "baseline";
+            case variant::iterator_comma:        return "iterator_comma";
+            case variant::non_iterator_comma:    return "non_iterator_comma";
+            case variant::std_iterator_baseline: return "std_iterator_baseline";
+            case variant::std_iterator_comma:    return "std_iterator_comma";
+        }
+
+        return "";
+    }
+
+    /**
+     * @brief Generates the translation unit of variant v. When scoped, the comma overload is declared in
+     *        IteratorBasedForImpl::syntax and only the functions building ranges import it.
+     */
+    std::string generate(variant v, std::size_t types, bool scoped) {
+        std::ostringstream out;
+        const char* import = scoped ? "using namespace IteratorBasedForImpl::syntax; " : "";
+
+        if (scoped) {
+            out << "#define ITERATOR_BASED_FOR_SCOPED_COMMA\n";
+        }
+
+        out << "#include <IteratorBasedFor.hpp>\n#include <vector>\n\n";
+
+        for (std::size_t i = 0; i < types; ++i) {
+            if (v == variant::std_iterator_baseline || v == variant::std_iterator_comma) {
+                out << "struct type_" << i << " { int x; };\n"
+                    << "int use_" << i << "(std::vector<type_" << i << ">& v) { int n = 0; ";
+
+                if (v == variant::std_iterator_comma) {
+                    out << import << "for (const auto& e : v.begin(), v.end()) { n += e.x; } ";
+                } else {
+                    out << "for (auto it = v.begin(); it != v.end(); ++it) { n += it->x; } ";
+                }
+
+                out << "return n; }\n";
+                continue;
+            }
+
+            if (v == variant::non_iterator_comma) {
+                out << "struct type_" << i << " { int* p; };\n"
+                    << "type_" << i << " use_" << i << "(type_" << i << " a, type_" << i << " b) { "
+                    << "return (a, b); }\n";
+                continue;
+            }
+
+            out << "struct type_" << i << " {\n"
+                << "    int* p;\n"
+                << "    int& operator*() const { return *p; }\n"
+                << "    type_" << i << "& operator++() { ++p; return *this; }\n"
+                << "    bool operator!=(const type_" << i << "& o) const { return p != o.p; }\n"
+                << "};\n";
+
+            if (v == variant::iterator_comma) {
+                out << "int use_" << i << "(type_" << i << " a, type_" << i << " b) { "
+                    << import << "int n = 0; for (int x : a, b) { n += x; } return n; }\n";
+            } else {
+                out << "int use_" << i << "(type_" << i << " a, type_" << i << " b) { "
+                    << "int n = 0; for (; a != b; ++a) { n += *a; } return n; }\n";
+            }
+        }
+
+        return out.str();
+    }
+
+    /**
+     * @brief Values read from a GCC -ftime-report for the "template instantiation" phase. Negative values mean the
+     *        compiler did not report them.
+     */
+    struct instantiation_report {
+        double wall_ms;
+        double memory_kb;
+        long count;
+
+        instantiation_report() : wall_ms(-1.0), memory_kb(-1.0), count(-1) { }
+    };
+
+    double parse_memory_kb(const std::string& token) {
+        double value = std::atof(token.c_str());
+
+        switch (token.empty() ? ' ' : token.back()) {
+            case 'k': return value;
+            case 'M': return value * 1024.0;
+            case 'G': return value * 1024.0 * 1024.0;
+            default:  return value / 1024.0;
+        }
+    }
+
+    void parse_gcc_time_report(const std::string& path, instantiation_report& report) {
+        std::ifstream in(path);
+        std::string line;
+
+        while (std::getline(in, line)) {
+            std::string::size_type phase = line.find("template instantiation");
+            std::string::size_type colon = line.find(':');
+
+            if (phase == std::string::npos || colon == std::string::npos) {
+                continue;
+            }
+
+            //Columns are usr, sys, wall and GGC memory, each followed by a parenthesized percentage.
+            std::istringstream columns(line.substr(colon + 1));
+            std::vector<std::string> values;
+            std::string token;
+
+            while (columns >> token) {
+                if (token.find('%') == std::string::npos && token != "(") {
+                    values.push_back(token);
+                }
+            }
+
+            if (values.size() >= 4) {
+                report.wall_ms = std::atof(values[2].c_str()) * 1000.0;
+                report.memory_kb = parse_memory_kb(values[3]);
+            }
+        }
+    }
+
+    long count_clang_instantiations(const std::string& path) {
+        std::ifstream in(path);
+        std::string trace((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        const std::string event = "\"name\":\"InstantiateClass\"";
+        long count = 0;
+
+        for (std::string::size_type pos = trace.find(event); pos != std::string::npos;
+             pos = trace.find(event, pos + event.size())) {
+            ++count;
+        }
+
+        return in ? count : -1;
+    }
+
+    /**
+     * @brief The public headers that need no third-party library, from the lightest to the heaviest dependencies.
+     */
+    const char* const headers[] = {
+        "IteratorBasedForTraits.hpp", "IteratorBasedFor.hpp", "IteratorBasedForAny.hpp",
+        "IteratorBasedForGenerator.hpp", "IteratorBasedForAsync.hpp", "IteratorBasedForIO.hpp",
+        "IteratorBasedForProfile.hpp", "IteratorBasedForPipeline.hpp", "IteratorBasedForParallel.hpp",
+        "IteratorBasedForSimd.hpp", "IteratorBasedForAlgorithm.hpp", "IteratorBasedForAdaptors.hpp"
+    };
+
+    /**
+     * @brief Measures the frontend time of a translation unit that only includes one header, for each header, which is
+     *        the cost a translation unit pays for including it.
+     */
+    int measure_headers(std::size_t samples, bool keep) {
+        const std::string source = "iterator_based_for_compile_bench_header.cpp";
+        std::cout << "header,samples,frontend_ms_min,frontend_ms_median\n";
+
+        for (const char* header : headers) {
+            {
+                std::ofstream out(source);
+                out << "#include <" << header << ">\n";
+            }
+
+            const std::string command = std::string(ITERATOR_BASED_FOR_CXX_COMPILER) + " -std=c++14 -I\""
+                                        + ITERATOR_BASED_FOR_INCLUDE_DIR + "\" -fsyntax-only " + source;
+            std::vector<double> wall;
+
+            for (std::size_t s = 0; s < samples; ++s) {
+                auto start = std::chrono::steady_clock::now();
+                int status = std::system(command.c_str());
+                wall.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+                if (status != 0) {
+                    std::cerr << "compilation failed: " << command << '\n';
+                    return 1;
+                }
+            }
+
+            std::sort(wall.begin(), wall.end());
+            std::cout << header << ',' << samples << ',' << wall.front() << ',' << wall[wall.size() / 2] << '\n';
+        }
+
+        if (!keep) {
+            std::remove(source.c_str());
+        }
+
+        return 0;
+    }
+
+    struct options {
+        std::vector<std::size_t> types;
+        std::size_t samples;
+        bool keep;
+        bool headers;
+        bool scoped;
+
+        options() : types(), samples(3), keep(false), headers(false), scoped(false) { }
+    };
+
+    void usage(const char* program) {
+        std::cerr << "usage: " << program << " [--types <n>]... [--samples <n>] [--keep] [--headers] [--scoped]\n";
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    options opts;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--types") == 0 && i + 1 < argc) {
+            opts.types.push_back(static_cast<std::size_t>(std::max(1, std::atoi(argv[++i]))));
+        } else if (std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            opts.samples = static_cast<std::size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--keep") == 0) {
+            opts.keep = true;
+        } else if (std::strcmp(argv[i], "--headers") == 0) {
+            opts.headers = true;
+        } else if (std::strcmp(argv[i], "--scoped") == 0) {
+            opts.scoped = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (opts.headers) {
+        return measure_headers(opts.samples, opts.keep);
+    }
+
+    if (opts.types.empty()) {
+        opts.types = {500, 2000};
+    }
+
+    const std::string compiler_id = ITERATOR_BASED_FOR_CXX_COMPILER_ID;
+    const bool gcc = compiler_id == "GNU";
+    const bool clang = compiler_id == "Clang" || compiler_id == "AppleClang";
+
+    std::cout << "variant,types,samples,frontend_ms_min,frontend_ms_median,instantiation_ms,instantiation_memory_kb,"
+                 "instantiations\n";
+
+    for (std::size_t types : opts.types) {
+        for (variant v : {variant::baseline, variant::iterator_comma, variant::non_iterator_comma,
+                          variant::std_iterator_baseline, variant::std_iterator_comma}) {
+            const std::string stem = std::string("iterator_based_for_compile_bench_") + variant_name(v) + "_"
+                                     + std::to_string(types);
+            const std::string source = stem + ".cpp";
+            const std::string report = stem + ".txt";
+
+            {
+                std::ofstream out(source);
+                out << generate(v, types, opts.scoped);
+            }
+
+            std::string command = std::string(ITERATOR_BASED_FOR_CXX_COMPILER) + " -std=c++14 -I\""
+                                  + ITERATOR_BASED_FOR_INCLUDE_DIR + "\"";
+
+            if (gcc) {
+                command += " -fsyntax-only -ftime-report";
+            } else if (clang) {
+                command += " -c -o " + stem + ".o -ftime-trace -ftime-trace-granularity=0";
+            } else {
+                command += " -fsyntax-only";
+            }
+
+            command += " " + source + " 2> " + report;
+
+            std::vector<double> wall;
+            instantiation_report instantiation;
+
+            for (std::size_t s = 0; s < opts.samples; ++s) {
+                auto start = std::chrono::steady_clock::now();
+                int status = std::system(command.c_str());
+                wall.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+                if (status != 0) {
+                    std::cerr << "compilation failed: " << command << '\n';
+                    return 1;
+                }
+            }
+
+            if (gcc) {
+                parse_gcc_time_report(report, instantiation);
+            } else if (clang) {
+                instantiation.count = count_clang_instantiations(stem + ".json");
+            }
+
+            std::sort(wall.begin(), wall.end());
+
+            std::cout << variant_name(v) << ',' << types << ',' << opts.samples << ',' << wall.front() << ','
+                      << wall[wall.size() / 2] << ',';
+
+            if (instantiation.wall_ms >= 0.0)   std::cout << instantiation.wall_ms;
+            std::cout << ',';
+            if (instantiation.memory_kb >= 0.0) std::cout << instantiation.memory_kb;
+            std::cout << ',';
+            if (instantiation.count >= 0)       std::cout << instantiation.count;
+            std::cout << '\n';
+
+            if (!opts.keep) {
+                std::remove(source.c_str());
+                std::remove(report.c_str());
+                std::remove((stem + ".o").c_str());
+                std::remove((stem + ".json").c_str());
+            }
+        }
+    }
+
+    return 0;
+}
@@ -1,159 +1,1073 @@
 #ifndef IteratorBasedFor_H
 #define IteratorBasedFor_H
 
+#include <IteratorBasedForTraits.hpp>
+
+#include <array>
+#include <cstddef>
+#include <iterator>
 #include <type_traits>
+#include <utility>
+
+//When std::span is available, contiguous ranges and span also convert to it.
+#if defined(__has_include) && __cplusplus >= 202002L
+#if __has_include(<span>)
+#include <span>
+#if defined(__cpp_lib_span) && __cpp_lib_span >= 202002L
+#define ITERATOR_BASED_FOR_HAS_STD_SPAN 1
+#endif
+#endif
+#endif
+
+#ifndef ITERATOR_BASED_FOR_HAS_STD_SPAN
+#define ITERATOR_BASED_FOR_HAS_STD_SPAN 0
+#endif
+
+//When std::ranges is available, iterator_range and blocked_iterator_range are borrowed views.
+#if defined(__has_include) && __cplusplus >= 202002L
+#if __has_include(<ranges>)
+#include <ranges>
+#if defined(__cpp_lib_ranges) && __cpp_lib_ranges >= 201911L
+#define ITERATOR_BASED_FOR_HAS_STD_RANGES 1
+#endif
+#endif
+#endif
+
+#ifndef ITERATOR_BASED_FOR_HAS_STD_RANGES
+#define ITERATOR_BASED_FOR_HAS_STD_RANGES 0
+#endif
+
+//Profiling builds, enabled by defining ITERATOR_BASED_FOR_PROFILE, record the duration of every loop over a comma
+//range, telling loops apart by the address the comma operator returns to.
+#if defined(__GNUC__) || defined(__clang__)
+#define ITERATOR_BASED_FOR_NOINLINE __attribute__((noinline))
+#define ITERATOR_BASED_FOR_RETURN_ADDRESS() __builtin_return_address(0)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define ITERATOR_BASED_FOR_NOINLINE __declspec(noinline)
+#define ITERATOR_BASED_FOR_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define ITERATOR_BASED_FOR_NOINLINE
+#define ITERATOR_BASED_FOR_RETURN_ADDRESS() nullptr
+#endif
 
 namespace IteratorBasedForImpl
 {
 
-    struct tag {};
+    /**
+     * @brief Hints the processor to load the cache line holding _address for reading. Has no effect on compilers
+     *        without a prefetch builtin.
+     */
+    inline void prefetch(const void* _address) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(_address, 0, 3);
+#else
+        (void)_address;
+#endif
+    }
 
-    template<typename T>
-    tag swap(T&, T&);
+    /**
+     * @brief Hints the processor to load the cache line holding _address for writing.
+     */
+    inline void prefetch_for_write(void* _address) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(_address, 1, 3);
+#else
+        (void)_address;
+#endif
+    }
 
-    template <typename T, typename U>
-    struct swap_call_matches_std_swap_impl {
-        template <typename V, typename W>
-        static constexpr auto check(int) -> typename std::is_same<
-            decltype(swap(std::declval<V&>(), std::declval<W&>())),
-            tag>::type;
+    /**
+     * @brief A view of _size contiguous elements starting at _data, the pointer and length pair taken by C-style
+     *        interfaces. Elements are accessed through plain pointers, so loops over a span vectorize as well as loops
+     *        over an array.
+     */
+    template <typename T>
+    class span {
+    private:
+        T* m_data;
+        std::size_t m_size;
 
-        template <typename, typename>
-        static constexpr std::false_type check(...);
+    public:
+        using element_type = T;
+        using value_type = typename std::remove_cv<T>::type;
+        using iterator = T*;
+
+        span() noexcept : m_data(nullptr), m_size(0) { }
 
-        using type = decltype(check<T, U>(0));
+        span(T* _data, std::size_t _size) noexcept : m_data(_data), m_size(_size) { }
+
+        /**
+         * @brief Converts a span of non-const elements to a span of const elements.
+         */
+        template <typename U, typename std::enable_if<std::is_convertible<U(*)[], T(*)[]>::value, int>::type = 0>
+        span(const span<U>& _other) noexcept : m_data(_other.data()), m_size(_other.size()) { }
+
+        T* data() const noexcept { return m_data; }
+        std::size_t size() const noexcept { return m_size; }
+        std::size_t size_bytes() const noexcept { return m_size * sizeof(T); }
+        bool empty() const noexcept { return m_size == 0; }
+
+        T* begin() const noexcept { return m_data; }
+        T* end() const noexcept { return m_data + m_size; }
+
+        T& operator[](std::size_t _n) const noexcept { return m_data[_n]; }
+
+#if ITERATOR_BASED_FOR_HAS_STD_SPAN
+        template <typename U, typename std::enable_if<std::is_convertible<T(*)[], U(*)[]>::value, int>::type = 0>
+        operator std::span<U>() const noexcept { return std::span<U>(m_data, m_size); }
+#endif
     };
 
-    template <typename T, typename U>
-    struct swap_call_matches_std_swap : swap_call_matches_std_swap_impl<T, U>::type { };
+    /**
+     * @brief Advances _it by _n steps, but not past _end. Takes constant time if the distance to _end can be computed
+     *        in constant time and a single pass of at most _n increments otherwise.
+     */
+    template <typename Iterator, typename Sentinel>
+    constexpr void advance_bounded(Iterator& _it, std::size_t _n, const Sentinel& _end, std::true_type) noexcept(
+            noexcept(_it += _end - _it)) {
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        difference_type remaining = _end - _it;
+        _it += static_cast<std::size_t>(remaining) < _n ? remaining : static_cast<difference_type>(_n);
+    }
+
+    template <typename Iterator, typename Sentinel>
+    constexpr void advance_bounded(Iterator& _it, std::size_t _n, const Sentinel& _end, std::false_type) noexcept(
+            noexcept(++_it) && noexcept(_it != _end)) {
+        for (; _n != 0 && _it != _end; --_n) {
+            ++_it;
+        }
+    }
 
-    template <typename T, typename U>
-    struct std_swap_call_is_valid : std::integral_constant<bool,
-            swap_call_matches_std_swap<T, U>::value
-            && std::is_move_assignable<T>::value
-            && std::is_move_assignable<U>::value
-            && std::is_move_constructible<T>::value
-            && std::is_move_constructible<U>::value> {
+    template <typename Iterator, typename Sentinel>
+    constexpr void advance_bounded(Iterator& _it, std::size_t _n, const Sentinel& _end) noexcept(
+            noexcept(advance_bounded(_it, _n, _end, typename is_sized_sentinel_for<Sentinel, Iterator>::type()))) {
+        advance_bounded(_it, _n, _end, typename is_sized_sentinel_for<Sentinel, Iterator>::type());
+    }
+
+    /**
+     * @brief Checks whether an Iterator can be copied, advanced towards a Sentinel and moved without throwing, which
+     *        makes slicing a range noexcept.
+     */
+    template <typename Iterator, typename Sentinel>
+    struct is_nothrow_bounded_advance : std::integral_constant<bool,
+            std::is_nothrow_copy_constructible<Iterator>::value && std::is_nothrow_move_constructible<Iterator>::value
+            && noexcept(advance_bounded(std::declval<Iterator&>(), std::size_t(0), std::declval<const Sentinel&>()))> {
     };
 
-    template <typename T, typename U>
-    struct swap_call_is_valid_impl {
-        //Uses comma operator to return std::true_type() if template substitution succeeds.
-        //Comma operator will always return std::true_type(), but template substitution may fail if left operand is
-        //malformed.
-        template <typename V, typename W>
-        static constexpr auto check(int) -> decltype(swap(std::declval<V&>(), std::declval<W&>()), std::true_type());
+    /**
+     * @brief Holds the two ends of an iterator_range. A Sentinel without any state, such as null_sentinel, is kept as
+     *        an empty base instead of a member, so it takes no space and the range is as small as its begin iterator.
+     */
+    template <typename Iterator, typename Sentinel,
+              bool = std::is_empty<Sentinel>::value && !std::is_final<Sentinel>::value
+                     && !std::is_base_of<Sentinel, Iterator>::value>
+    class range_storage {
+    private:
+        Iterator m_first;
+        Sentinel m_second;
 
-        template <typename, typename>
-        static constexpr std::false_type check(...);
+    public:
+        constexpr range_storage(Iterator _first, Sentinel _second) noexcept(
+                std::is_nothrow_move_constructible<Iterator>::value
+                && std::is_nothrow_move_constructible<Sentinel>::value) :
+                m_first(std::move(_first)),
+                m_second(std::move(_second)) {
+        }
 
-        using type = decltype(check<T, U>(0));
+        constexpr Iterator& first() noexcept { return m_first; }
+        constexpr const Iterator& first() const noexcept { return m_first; }
+        constexpr Sentinel& second() noexcept { return m_second; }
+        constexpr const Sentinel& second() const noexcept { return m_second; }
     };
 
-    template <typename T, typename U>
-    struct swap_call_is_valid : swap_call_is_valid_impl<T, U>::type { };
+    template <typename Iterator, typename Sentinel>
+    class range_storage<Iterator, Sentinel, true> : private Sentinel {
+    private:
+        Iterator m_first;
+
+    public:
+        constexpr range_storage(Iterator _first, Sentinel _second) noexcept(
+                std::is_nothrow_move_constructible<Iterator>::value
+                && std::is_nothrow_move_constructible<Sentinel>::value) :
+                Sentinel(std::move(_second)),
+                m_first(std::move(_first)) {
+        }
 
-    template <typename T, typename U>
-    struct is_swappable : std::integral_constant<bool,
-            swap_call_matches_std_swap<T, U>::value
-            && std_swap_call_is_valid<T, U>::value
-            || swap_call_is_valid<T, U>::value> {
+        constexpr Iterator& first() noexcept { return m_first; }
+        constexpr const Iterator& first() const noexcept { return m_first; }
+        constexpr Sentinel& second() noexcept { return *this; }
+        constexpr const Sentinel& second() const noexcept { return *this; }
     };
 
     /**
-     * @brief Checks whether T defines a pre-increment operator that returns a reference to T. Provides the member
-     *        constant 'value' which is equal to true if T passes the check. Otherwise 'value' is equal to false.
+     * @brief Represents a pseudo-range involving a begin iterator and an end, which is either an iterator of the same
+     *        type or a sentinel that the begin iterator can be compared against. Provides the methods begin() and
+     *        end() returning the respective objects.
+     *
+     * The iterators are taken by value and moved into place, so constructing a range from temporaries never copies
+     * them. For move-only iterators begin() and end() move the iterators out of the range instead of copying them;
+     * such a range, like any single-pass range, can only be iterated once.
+     *
+     * Ranges whose Sentinel differs from Iterator can be used in a range-based for statement from C++17 onwards.
      */
-    template <typename T>
-    struct has_iterator_pre_increment_impl {
-        template <typename U>
-        static constexpr auto check(int) -> typename std::is_same<decltype(++std::declval<U>()), U&>::type;
+    template <typename Iterator, typename Sentinel = Iterator>
+    class iterator_range {
+    private:
+        range_storage<Iterator, Sentinel> m_ends;
 
-        template <typename>
-        static constexpr std::false_type check(...);
+    public:
+        using iterator = Iterator;
+        using sentinel = Sentinel;
+
+        constexpr iterator_range(Iterator _begin, Sentinel _end) noexcept(
+                std::is_nothrow_move_constructible<Iterator>::value
+                && std::is_nothrow_move_constructible<Sentinel>::value) :
+                m_ends(std::move(_begin), std::move(_end)) {
+        }
+
+        template <typename I = Iterator, typename std::enable_if<std::is_copy_constructible<I>::value, int>::type = 0>
+        constexpr Iterator begin() const noexcept(std::is_nothrow_copy_constructible<I>::value) {
+            return m_ends.first();
+        }
+
+        template <typename S = Sentinel, typename std::enable_if<std::is_copy_constructible<S>::value, int>::type = 0>
+        constexpr Sentinel end() const noexcept(std::is_nothrow_copy_constructible<S>::value) {
+            return m_ends.second();
+        }
+
+        template <typename I = Iterator, typename std::enable_if<!std::is_copy_constructible<I>::value, int>::type = 0>
+        constexpr Iterator begin() noexcept(std::is_nothrow_move_constructible<I>::value) {
+            return std::move(m_ends.first());
+        }
+
+        template <typename S = Sentinel, typename std::enable_if<!std::is_copy_constructible<S>::value, int>::type = 0>
+        constexpr Sentinel end() noexcept(std::is_nothrow_move_constructible<S>::value) {
+            return std::move(m_ends.second());
+        }
+
+        /**
+         * @brief Checks whether the range is empty. Available for every range.
+         */
+        constexpr bool empty() const noexcept(
+                noexcept(std::declval<const Iterator&>() != std::declval<const Sentinel&>())) {
+            return !(m_ends.first() != m_ends.second());
+        }
+
+        /**
+         * @brief Returns the number of elements in the range. Only available if it can be computed in constant time.
+         */
+        template <typename I = Iterator, typename S = Sentinel,
+                  typename std::enable_if<is_sized_sentinel_for<S, I>::value, int>::type = 0>
+        constexpr std::size_t size() const noexcept(
+                noexcept(std::declval<const S&>() - std::declval<const I&>())) {
+            return static_cast<std::size_t>(m_ends.second() - m_ends.first());
+        }
+
+        /**
+         * @brief Returns the number of elements as a signed integer, the bound of an index loop such as the canonical
+         *        loops of #pragma omp parallel for. Only available if it can be computed in constant time.
+         */
+        template <typename I = Iterator, typename S = Sentinel,
+                  typename std::enable_if<is_sized_sentinel_for<S, I>::value, int>::type = 0>
+        constexpr typename std::iterator_traits<I>::difference_type ssize() const noexcept(
+                noexcept(std::declval<const S&>() - std::declval<const I&>())) {
+            return static_cast<typename std::iterator_traits<I>::difference_type>(m_ends.second() - m_ends.first());
+        }
+
+        /**
+         * @brief Returns the element at index _n. Only available for random access iterators.
+         */
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        constexpr typename std::iterator_traits<I>::reference operator[](
+                typename std::iterator_traits<I>::difference_type _n) const noexcept(
+                noexcept(std::declval<const I&>()[_n])) {
+            return m_ends.first()[_n];
+        }
+
+        /**
+         * @brief Returns the first element. The range must not be empty.
+         */
+        template <typename I = Iterator>
+        constexpr auto front() const noexcept(noexcept(*std::declval<const I&>()))
+                -> decltype(*std::declval<const I&>()) { return *m_ends.first(); }
+
+        /**
+         * @brief Returns the last element. Only available for bidirectional iterators with a matching end iterator.
+         *        The range must not be empty.
+         */
+        template <typename I = Iterator, typename S = Sentinel,
+                  typename std::enable_if<is_bidirectional_iterator<I>::value && std::is_same<I, S>::value,
+                                          int>::type = 0>
+        constexpr auto back() const noexcept(std::is_nothrow_copy_constructible<I>::value
+                                             && noexcept(--std::declval<I&>()) && noexcept(*std::declval<I&>()))
+                -> decltype(*std::declval<const I&>()) {
+            //Steps back by hand since std::prev is not constexpr before C++17.
+            Iterator last = m_ends.second();
+            --last;
+            return *last;
+        }
+
+        /**
+         * @brief Returns a pointer to the first element. Only available for contiguous iterators.
+         */
+        template <typename I = Iterator, typename std::enable_if<is_contiguous_iterator<I>::value, int>::type = 0>
+        constexpr auto data() const noexcept(noexcept(IteratorBasedForImpl::to_address(std::declval<const I&>())))
+                -> decltype(IteratorBasedForImpl::to_address(std::declval<const I&>())) {
+            return IteratorBasedForImpl::to_address(m_ends.first());
+        }
 
-        typedef decltype(check<T>(0)) type;
+        /**
+         * @brief Returns a span of the elements of the range without copying them. Only available for contiguous
+         *        ranges whose size is known in constant time.
+         */
+        template <typename I = Iterator, typename S = Sentinel,
+                  typename std::enable_if<is_contiguous_iterator<I>::value && is_sized_sentinel_for<S, I>::value,
+                                          int>::type = 0>
+        span<typename std::remove_reference<typename std::iterator_traits<I>::reference>::type> as_span() const
+                noexcept(noexcept(IteratorBasedForImpl::to_address(std::declval<const I&>()))) {
+            return span<typename std::remove_reference<typename std::iterator_traits<I>::reference>::type>(
+                    IteratorBasedForImpl::to_address(m_ends.first()), size());
+        }
+
+        /**
+         * @brief Converts a contiguous range whose size is known in constant time to a span, so it can be passed
+         *        directly to functions taking span<T> or, from C++20, std::span<T>. Converting to a span of const
+         *        elements is allowed; dropping const is not.
+         */
+        template <typename T, typename I = Iterator, typename S = Sentinel,
+                  typename std::enable_if<is_contiguous_iterator<I>::value && is_sized_sentinel_for<S, I>::value
+                                          && std::is_convertible<typename std::remove_reference<
+                                                 typename std::iterator_traits<I>::reference>::type(*)[], T(*)[]>::value,
+                                          int>::type = 0>
+        operator span<T>() const noexcept(noexcept(IteratorBasedForImpl::to_address(std::declval<const I&>()))) {
+            return as_span();
+        }
+
+#if ITERATOR_BASED_FOR_HAS_STD_SPAN
+        template <typename T, typename I = Iterator, typename S = Sentinel,
+                  typename std::enable_if<is_contiguous_iterator<I>::value && is_sized_sentinel_for<S, I>::value
+                                          && std::is_convertible<typename std::remove_reference<
+                                                 typename std::iterator_traits<I>::reference>::type(*)[], T(*)[]>::value,
+                                          int>::type = 0>
+        operator std::span<T>() const noexcept(noexcept(IteratorBasedForImpl::to_address(std::declval<const I&>()))) {
+            return std::span<T>(IteratorBasedForImpl::to_address(m_ends.first()), size());
+        }
+#endif
+
+        /**
+         * @brief Returns the range of the first _n elements, or the whole range if it holds fewer than _n elements.
+         *        Takes constant time for random access iterators and a single pass over those elements otherwise.
+         */
+        template <typename I = Iterator, typename std::enable_if<std::is_copy_constructible<I>::value, int>::type = 0>
+        constexpr iterator_range<Iterator> take(std::size_t _n) const noexcept(
+                is_nothrow_bounded_advance<I, Sentinel>::value) {
+            Iterator last = m_ends.first();
+            advance_bounded(last, _n, m_ends.second());
+            return iterator_range<Iterator>(m_ends.first(), std::move(last));
+        }
+
+        /**
+         * @brief Returns the range without its first _n elements, or an empty range if it holds fewer than _n
+         *        elements. Takes constant time for random access iterators and a single pass otherwise.
+         */
+        template <typename I = Iterator, typename S = Sentinel,
+                  typename std::enable_if<std::is_copy_constructible<I>::value && std::is_copy_constructible<S>::value,
+                                          int>::type = 0>
+        constexpr iterator_range<Iterator, Sentinel> drop(std::size_t _n) const noexcept(
+                is_nothrow_bounded_advance<I, S>::value && std::is_nothrow_copy_constructible<S>::value) {
+            Iterator first = m_ends.first();
+            advance_bounded(first, _n, m_ends.second());
+            return iterator_range<Iterator, Sentinel>(std::move(first), m_ends.second());
+        }
+
+        /**
+         * @brief Returns the range of the elements with indices in [_first, _last), clamped to the range. Takes
+         *        constant time for random access iterators and a single pass up to _last otherwise.
+         */
+        template <typename I = Iterator, typename std::enable_if<std::is_copy_constructible<I>::value, int>::type = 0>
+        constexpr iterator_range<Iterator> slice(std::size_t _first, std::size_t _last) const noexcept(
+                is_nothrow_bounded_advance<I, Sentinel>::value) {
+            Iterator first = m_ends.first();
+            advance_bounded(first, _first, m_ends.second());
+            Iterator last = first;
+            advance_bounded(last, _last > _first ? _last - _first : 0, m_ends.second());
+            return iterator_range<Iterator>(std::move(first), std::move(last));
+        }
+
+        /**
+         * @brief Splits the range into the range of its first _n elements and the range of the remaining elements.
+         *        Equivalent to std::make_pair(take(_n), drop(_n)) but walks to the split point only once.
+         */
+        template <typename I = Iterator, typename S = Sentinel,
+                  typename std::enable_if<std::is_copy_constructible<I>::value && std::is_copy_constructible<S>::value,
+                                          int>::type = 0>
+        std::pair<iterator_range<Iterator>, iterator_range<Iterator, Sentinel>> split_at(std::size_t _n) const noexcept(
+                is_nothrow_bounded_advance<I, S>::value && std::is_nothrow_copy_constructible<S>::value) {
+            Iterator middle = m_ends.first();
+            advance_bounded(middle, _n, m_ends.second());
+            return std::make_pair(iterator_range<Iterator>(m_ends.first(), middle),
+                                  iterator_range<Iterator, Sentinel>(middle, m_ends.second()));
+        }
+
+        /**
+         * @brief Checks whether the range holds more than one element and can therefore be split in two. Only
+         *        available for random access ranges whose end is an iterator of the same type.
+         */
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value
+                                                                 && std::is_same<I, Sentinel>::value, int>::type = 0>
+        constexpr bool is_divisible() const noexcept(noexcept(std::declval<const I&>() - std::declval<const I&>())) {
+            return m_ends.second() - m_ends.first() > 1;
+        }
+
+#if defined(TBB_VERSION_MAJOR)
+        /**
+         * @brief Splitting constructor of tbb::parallel_for, declared when a TBB header has been included first. Takes
+         *        the upper half of _range and leaves the lower half in _range, so a random access range can be passed
+         *        to TBB without wrapping it in a tbb::blocked_range.
+         */
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value
+                                                                 && std::is_same<I, Sentinel>::value, int>::type = 0>
+        iterator_range(iterator_range& _range, tbb::split) :
+                m_ends(_range.m_ends.first() + (_range.m_ends.second() - _range.m_ends.first()) / 2,
+                       _range.m_ends.second()) {
+            _range.m_ends.second() = m_ends.first();
+        }
+#endif
+
+        constexpr bool operator==(const iterator_range<Iterator, Sentinel>& rhs) const noexcept(
+                noexcept(std::declval<const Iterator&>() == std::declval<const Iterator&>()
+                         && std::declval<const Sentinel&>() == std::declval<const Sentinel&>())) {
+            return m_ends.first() == rhs.m_ends.first() && m_ends.second() == rhs.m_ends.second();
+        }
     };
 
-    template <typename T>
-    struct has_iterator_pre_increment : has_iterator_pre_increment_impl<T>::type { };
+#if defined(ITERATOR_BASED_FOR_PROFILE)
+    template <typename Iterator, typename Sentinel>
+    class profiled_iterator_range;
+#endif
 
     /**
-     * @brief Checks whether T defines an indirection operator. Provides the member constant 'value' which is equal
-     *        to true if T passes the check. Otherwise 'value' is equal to false.
+     * @brief Helper function for constructing an iterator_range object. Rvalue iterators are moved into the range and
+     *        lvalue iterators are copied.
      */
-    template <typename T>
-    struct has_iterator_indirection_impl {
-        template <typename U>
-        static constexpr auto check(int) -> typename std::is_reference<decltype(*std::declval<U>())>::type;
+    template <typename Iterator, typename Sentinel>
+    constexpr iterator_range<typename std::decay<Iterator>::type, typename std::decay<Sentinel>::type>
+    make_iterator_range(Iterator&& _begin, Sentinel&& _end) noexcept(
+            std::is_nothrow_constructible<typename std::decay<Iterator>::type, Iterator>::value
+            && std::is_nothrow_constructible<typename std::decay<Sentinel>::type, Sentinel>::value
+            && std::is_nothrow_move_constructible<typename std::decay<Iterator>::type>::value
+            && std::is_nothrow_move_constructible<typename std::decay<Sentinel>::type>::value) {
+        return iterator_range<typename std::decay<Iterator>::type, typename std::decay<Sentinel>::type>(
+                std::forward<Iterator>(_begin), std::forward<Sentinel>(_end));
+    }
 
-        template <typename>
-        static constexpr std::false_type check(...);
+    /**
+     * @brief Returns _range.as_span(): a span of the elements of a contiguous range whose size is known in constant
+     *        time, as in to_span((v.begin() + 1, v.end())).
+     */
+    template <typename Iterator, typename Sentinel>
+    auto to_span(const iterator_range<Iterator, Sentinel>& _range) -> decltype(_range.as_span()) {
+        return _range.as_span();
+    }
+
+    /**
+     * @brief The right operand of a counted range: the number of elements to iterate over. Created with counted().
+     */
+    struct counted_t {
+        std::ptrdiff_t count;
+    };
+
+    /**
+     * @brief Returns the right operand selecting the counted range of the _n elements starting at the left operand,
+     *        as in for (auto& x : it, counted(n)).
+     */
+    constexpr counted_t counted(std::ptrdiff_t _n) noexcept { return counted_t{_n}; }
+
+    /**
+     * @brief Wraps an iterator together with the number of elements left to visit. Two counted iterators are equal
+     *        when they have the same count, so the end of a counted range is found by counting down an integer rather
+     *        than by comparing the wrapped iterators, and the end never has to be computed by walking the range. The
+     *        category is that of the wrapped iterator; random access ones keep their constant-time operations.
+     */
+    template <typename Iterator>
+    class counted_iterator {
+    private:
+        Iterator m_it;
+        std::ptrdiff_t m_count;
+
+    public:
+        using iterator_category = typename std::conditional<
+                is_random_access_iterator<Iterator>::value
+                || !has_iterator_category<Iterator, std::forward_iterator_tag>::value,
+                typename std::iterator_traits<Iterator>::iterator_category,
+                std::forward_iterator_tag>::type;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::iterator_traits<Iterator>::pointer;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+        counted_iterator(Iterator _it, std::ptrdiff_t _count) noexcept(
+                std::is_nothrow_move_constructible<Iterator>::value) :
+                m_it(std::move(_it)), m_count(_count) {
+        }
+
+        /**
+         * @brief Returns the wrapped iterator.
+         */
+        const Iterator& base() const noexcept { return m_it; }
+
+        /**
+         * @brief Returns the number of elements left before the end of the range.
+         */
+        std::ptrdiff_t count() const noexcept { return m_count; }
+
+        reference operator*() const noexcept(noexcept(*std::declval<const Iterator&>())) { return *m_it; }
 
-        typedef decltype(check<T>(0)) type;
+        template <typename I = Iterator>
+        auto operator->() const noexcept(noexcept(IteratorBasedForImpl::to_address(std::declval<const I&>())))
+                -> decltype(IteratorBasedForImpl::to_address(std::declval<const I&>())) {
+            return IteratorBasedForImpl::to_address(m_it);
+        }
+
+        counted_iterator& operator++() noexcept(noexcept(++std::declval<Iterator&>())) {
+            ++m_it;
+            --m_count;
+            return *this;
+        }
+
+        counted_iterator operator++(int) noexcept(
+                std::is_nothrow_copy_constructible<Iterator>::value && noexcept(++std::declval<Iterator&>())) {
+            counted_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        counted_iterator& operator--() {
+            --m_it;
+            ++m_count;
+            return *this;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        counted_iterator operator--(int) {
+            counted_iterator previous = *this;
+            --*this;
+            return previous;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        counted_iterator& operator+=(difference_type _n) {
+            m_it += static_cast<typename std::iterator_traits<I>::difference_type>(_n);
+            m_count -= _n;
+            return *this;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        counted_iterator& operator-=(difference_type _n) { return *this += -_n; }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        counted_iterator operator+(difference_type _n) const {
+            counted_iterator result = *this;
+            return result += _n;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        counted_iterator operator-(difference_type _n) const {
+            counted_iterator result = *this;
+            return result -= _n;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        reference operator[](difference_type _n) const {
+            return m_it[static_cast<typename std::iterator_traits<I>::difference_type>(_n)];
+        }
+
+        /**
+         * @brief Returns the distance between two counted iterators over the same range, computed from their counts.
+         */
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        difference_type operator-(const counted_iterator& rhs) const noexcept { return rhs.m_count - m_count; }
+
+        bool operator==(const counted_iterator& rhs) const noexcept { return m_count == rhs.m_count; }
+        bool operator!=(const counted_iterator& rhs) const noexcept { return m_count != rhs.m_count; }
+        bool operator<(const counted_iterator& rhs) const noexcept { return m_count > rhs.m_count; }
+        bool operator>(const counted_iterator& rhs) const noexcept { return m_count < rhs.m_count; }
+        bool operator<=(const counted_iterator& rhs) const noexcept { return m_count >= rhs.m_count; }
+        bool operator>=(const counted_iterator& rhs) const noexcept { return m_count <= rhs.m_count; }
     };
 
+    template <typename Iterator>
+    Iterator counted_end(const Iterator& _first, std::ptrdiff_t _n, std::true_type) noexcept(
+            std::is_nothrow_move_constructible<Iterator>::value
+            && noexcept(_first + static_cast<typename std::iterator_traits<Iterator>::difference_type>(_n))) {
+        return _first + static_cast<typename std::iterator_traits<Iterator>::difference_type>(_n);
+    }
+
+    template <typename Iterator>
+    Iterator counted_end(const Iterator& _first, std::ptrdiff_t, std::false_type) noexcept(
+            std::is_nothrow_copy_constructible<Iterator>::value) {
+        return _first;
+    }
+
+    /**
+     * @brief Returns the range of the _n elements starting at _first. Both ends are counted_iterator objects, so the
+     *        range can be iterated with a range-based for statement in C++14. For random access iterators the end
+     *        wraps _first + _n; otherwise it wraps a copy of _first that is never dereferenced, so no end iterator is
+     *        computed by walking the range.
+     */
+    template <typename Iterator>
+    iterator_range<counted_iterator<Iterator>> make_counted_range(Iterator _first, std::ptrdiff_t _n) noexcept(
+            std::is_nothrow_move_constructible<Iterator>::value
+            && noexcept(counted_end(_first, _n, is_random_access_iterator<Iterator>()))) {
+        counted_iterator<Iterator> last(counted_end(_first, _n, is_random_access_iterator<Iterator>()), 0);
+        return iterator_range<counted_iterator<Iterator>>(counted_iterator<Iterator>(std::move(_first), _n),
+                                                          std::move(last));
+    }
+
+    /**
+     * @brief Comma overload for counted ranges, as in for (auto& x : it, counted(n)). Besides iterators accepted by
+     *        the generic comma overload, the left operand may be a pointer, since the counted_t operand makes the
+     *        overload applicable.
+     */
+    template <typename Iterator,
+              typename std::enable_if<is_comma_left_operand<typename std::decay<Iterator>::type>::value, int>::type = 0>
+    iterator_range<counted_iterator<typename std::decay<Iterator>::type>> operator,(Iterator&& _first,
+                                                                                 counted_t _count) noexcept(
+            std::is_nothrow_constructible<typename std::decay<Iterator>::type, Iterator>::value
+            && noexcept(make_counted_range(std::declval<typename std::decay<Iterator>::type>(), _count.count))) {
+        return make_counted_range(typename std::decay<Iterator>::type(std::forward<Iterator>(_first)), _count.count);
+    }
+
+    /**
+     * @brief Random access iterator over consecutive integers of type Integer. Dereferencing yields the current value
+     *        by value, so a loop over iota(0, n) compiles to the same induction variable as a hand-written index loop.
+     */
+    template <typename Integer>
+    class counting_iterator {
+        static_assert(std::is_integral<Integer>::value, "counting_iterator requires an integer type");
+
+    private:
+        Integer m_value;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Integer;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Integer;
+
+        constexpr counting_iterator() noexcept : m_value() { }
+
+        constexpr explicit counting_iterator(Integer _value) noexcept : m_value(_value) { }
+
+        constexpr Integer operator*() const noexcept { return m_value; }
+        constexpr Integer operator[](difference_type _n) const noexcept { return static_cast<Integer>(m_value + _n); }
+
+        constexpr counting_iterator& operator++() noexcept { ++m_value; return *this; }
+        constexpr counting_iterator& operator--() noexcept { --m_value; return *this; }
+        constexpr counting_iterator operator++(int) noexcept {
+            counting_iterator previous = *this;
+            ++m_value;
+            return previous;
+        }
+
+        constexpr counting_iterator operator--(int) noexcept {
+            counting_iterator previous = *this;
+            --m_value;
+            return previous;
+        }
+
+        constexpr counting_iterator& operator+=(difference_type _n) noexcept {
+            m_value = static_cast<Integer>(m_value + _n);
+            return *this;
+        }
+
+        constexpr counting_iterator& operator-=(difference_type _n) noexcept {
+            m_value = static_cast<Integer>(m_value - _n);
+            return *this;
+        }
+
+        friend constexpr counting_iterator operator+(counting_iterator _it, difference_type _n) noexcept {
+            return _it += _n;
+        }
+
+        friend constexpr counting_iterator operator+(difference_type _n, counting_iterator _it) noexcept {
+            return _it += _n;
+        }
+
+        friend constexpr counting_iterator operator-(counting_iterator _it, difference_type _n) noexcept {
+            return _it -= _n;
+        }
+
+        friend constexpr difference_type operator-(const counting_iterator& _lhs,
+                                                   const counting_iterator& _rhs) noexcept {
+            return static_cast<difference_type>(_lhs.m_value) - static_cast<difference_type>(_rhs.m_value);
+        }
+
+        friend constexpr bool operator==(const counting_iterator& _lhs, const counting_iterator& _rhs) noexcept {
+            return _lhs.m_value == _rhs.m_value;
+        }
+
+        friend constexpr bool operator!=(const counting_iterator& _lhs, const counting_iterator& _rhs) noexcept {
+            return _lhs.m_value != _rhs.m_value;
+        }
+
+        friend constexpr bool operator<(const counting_iterator& _lhs, const counting_iterator& _rhs) noexcept {
+            return _lhs.m_value < _rhs.m_value;
+        }
+
+        friend constexpr bool operator>(const counting_iterator& _lhs, const counting_iterator& _rhs) noexcept {
+            return _rhs < _lhs;
+        }
+
+        friend constexpr bool operator<=(const counting_iterator& _lhs, const counting_iterator& _rhs) noexcept {
+            return !(_rhs < _lhs);
+        }
+
+        friend constexpr bool operator>=(const counting_iterator& _lhs, const counting_iterator& _rhs) noexcept {
+            return !(_lhs < _rhs);
+        }
+    };
+
+    /**
+     * @brief Returns the range of the integers in [_first, _last), or an empty range if _last is below _first:
+     *
+     *        for (auto i : iota(0, n)) { out[i] = a[i] * b[i]; }
+     *
+     *        The index type is the common type of the bounds unless given explicitly, as in iota<std::int32_t>(0, n).
+     *        Signed 32-bit indices usually optimize best, since their overflow is undefined and the compiler may
+     *        assume it does not happen. The range is sized and random access, so it can also be passed to the
+     *        parallel algorithms.
+     */
+    template <typename Index = void, typename First, typename Last,
+              typename Integer = typename std::conditional<std::is_void<Index>::value,
+                                                           typename std::common_type<First, Last>::type, Index>::type>
+    constexpr iterator_range<counting_iterator<Integer>> iota(First _first, Last _last) noexcept {
+        const Integer first = static_cast<Integer>(_first);
+        const Integer last = static_cast<Integer>(_last);
+
+        return iterator_range<counting_iterator<Integer>>(counting_iterator<Integer>(first),
+                                                          counting_iterator<Integer>(last < first ? first : last));
+    }
+
+    /**
+     * @brief Returns the range [_first, _last) of a raw buffer, for pointer ranges the comma syntax cannot build because
+     *        the built-in comma operator always applies to two pointers.
+     */
     template <typename T>
-    struct has_iterator_indirection : has_iterator_indirection_impl<T>::type {};
+    constexpr iterator_range<T*> ptr_range(T* _first, T* _last) noexcept { return iterator_range<T*>(_first, _last); }
 
+    /**
+     * @brief Returns the range of the _n elements starting at _first, as for a buffer from a C API or mmap.
+     */
     template <typename T>
-    struct is_iterator : std::integral_constant<bool,
-            !std::is_reference<T>::value
-            && std::is_copy_constructible<T>::value
-            && std::is_copy_assignable<T>::value
-            && std::is_destructible<T>::value
-            && is_swappable<T, T>::value
-            && has_iterator_pre_increment<T>::value
-            && has_iterator_indirection<T>::value> {
+    constexpr iterator_range<T*> ptr_range(T* _first, std::size_t _n) noexcept {
+        return iterator_range<T*>(_first, _first + _n);
+    }
+
+    /**
+     * @brief Returns the range of all elements of the array _array.
+     */
+    template <typename T, std::size_t N>
+    constexpr iterator_range<T*> ptr_range(T (&_array)[N]) noexcept { return iterator_range<T*>(_array, _array + N); }
+
+    /**
+     * @brief A random access range of exactly N elements, N known at compile time, as the coordinates of a vector in
+     *        3D math or the lanes of a packet. size() is a constant expression, and for_each() and
+     *        for_each_indexed() expand into N calls through an index sequence instead of a loop, so they are unrolled
+     *        whatever the optimizer decides. A range-based for statement over it is an ordinary loop with a constant
+     *        trip count.
+     */
+    template <typename Iterator, std::size_t N>
+    class static_range : public iterator_range<Iterator> {
+        static_assert(is_random_access_iterator<Iterator>::value, "static_range requires random access iterators");
+
+    private:
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+
+        template <typename F, std::size_t... Is>
+        constexpr void for_each_impl(F& _f, std::index_sequence<Is...>) const {
+            const Iterator first = this->begin();
+            using expand = int[];
+            (void)expand{0, (_f(first[static_cast<difference_type>(Is)]), 0)...};
+        }
+
+        template <typename F, std::size_t... Is>
+        constexpr void for_each_indexed_impl(F& _f, std::index_sequence<Is...>) const {
+            const Iterator first = this->begin();
+            using expand = int[];
+            (void)expand{0, (_f(first[static_cast<difference_type>(Is)], std::integral_constant<std::size_t, Is>()),
+                             0)...};
+        }
+
+    public:
+        static constexpr std::size_t extent = N;
+
+        constexpr explicit static_range(Iterator _begin) noexcept(
+                std::is_nothrow_copy_constructible<Iterator>::value
+                && noexcept(_begin + static_cast<difference_type>(N))) :
+                iterator_range<Iterator>(_begin, _begin + static_cast<difference_type>(N)) {
+        }
+
+        static constexpr std::size_t size() noexcept { return N; }
+
+        static constexpr bool empty() noexcept { return N == 0; }
+
+        /**
+         * @brief Calls _f with every element in order, as N calls rather than a loop. Returns _f.
+         */
+        template <typename F>
+        constexpr F for_each(F _f) const {
+            for_each_impl(_f, std::make_index_sequence<N>());
+            return _f;
+        }
+
+        /**
+         * @brief Calls _f(element, std::integral_constant<std::size_t, I>()) for every element I in order, so the index
+         *        is available as a constant expression, for example to pick a std::get<I> of a tuple. Returns _f.
+         */
+        template <typename F>
+        constexpr F for_each_indexed(F _f) const {
+            for_each_indexed_impl(_f, std::make_index_sequence<N>());
+            return _f;
+        }
     };
 
+    template <typename Iterator, std::size_t N>
+    constexpr std::size_t static_range<Iterator, N>::extent;
+
+    /**
+     * @brief Returns the static_range of the N elements starting at _first.
+     */
+    template <std::size_t N, typename Iterator>
+    constexpr static_range<Iterator, N> make_static_range(Iterator _first) {
+        return static_range<Iterator, N>(std::move(_first));
+    }
+
     /**
-     * @brief Represents a pseudo-range involving a begin iterator and end iterator. Provides the methods begin() and
-     *        end() returning the respective iterators.
+     * @brief Returns the static_range of all elements of the array _array.
+     */
+    template <typename T, std::size_t N>
+    constexpr static_range<T*, N> make_static_range(T (&_array)[N]) noexcept {
+        return static_range<T*, N>(_array);
+    }
+
+    template <typename T, std::size_t N>
+    static_range<typename std::array<T, N>::iterator, N> make_static_range(std::array<T, N>& _array) {
+        return static_range<typename std::array<T, N>::iterator, N>(_array.begin());
+    }
+
+    template <typename T, std::size_t N>
+    static_range<typename std::array<T, N>::const_iterator, N> make_static_range(const std::array<T, N>& _array) {
+        return static_range<typename std::array<T, N>::const_iterator, N>(_array.begin());
+    }
+
+    /**
+     * @brief Tag selecting the splitting constructor of a splittable range.
+     */
+    struct split { };
+
+    /**
+     * @brief A random access iterator_range that can be divided into two balanced halves until it holds at most a
+     *        grain size of elements. Models the splittable range requirements of parallel runtimes: is_divisible(),
+     *        empty() and a splitting constructor R(R&, split) that moves the upper half of the argument into the new
+     *        range. When a TBB header has been included first, the splitting constructor also accepts tbb::split so
+     *        the range can be passed to tbb::parallel_for directly. Holds the two iterators and the grain size only.
      */
     template <typename Iterator>
-    class iterator_range {
+    class blocked_iterator_range : public iterator_range<Iterator> {
+        static_assert(is_random_access_iterator<Iterator>::value,
+                      "blocked_iterator_range requires random access iterators");
+
     private:
-        Iterator m_begin;
-        Iterator m_end;
+        std::size_t m_grain;
+
+        static Iterator middle(const blocked_iterator_range& _range) {
+            return _range.begin()
+                 + static_cast<typename std::iterator_traits<Iterator>::difference_type>(_range.size() / 2);
+        }
 
     public:
-        iterator_range(Iterator&& _begin, Iterator&& _end) :
-                m_begin(_begin),
-                m_end(_end) {
+        blocked_iterator_range(Iterator _begin, Iterator _end, std::size_t _grain = 1) :
+                iterator_range<Iterator>(std::move(_begin), std::move(_end)),
+                m_grain(_grain ? _grain : 1) {
+        }
+
+        explicit blocked_iterator_range(const iterator_range<Iterator>& _range, std::size_t _grain = 1) :
+                iterator_range<Iterator>(_range),
+                m_grain(_grain ? _grain : 1) {
         }
 
-        Iterator begin() const { return m_begin; }
-        Iterator end()   const { return m_end;   }
+        /**
+         * @brief Splitting constructor. Takes the upper half of _range and leaves the lower half in _range; the upper
+         *        half gets the extra element when the size is odd.
+         */
+        blocked_iterator_range(blocked_iterator_range& _range, split) :
+                iterator_range<Iterator>(middle(_range), _range.end()),
+                m_grain(_range.m_grain) {
+            _range = blocked_iterator_range(_range.begin(), this->begin(), m_grain);
+        }
 
-        bool operator==(const iterator_range<Iterator>& rhs) const {
-            return m_begin == rhs.m_begin && m_end == rhs.m_end;
+#if defined(TBB_VERSION_MAJOR)
+        blocked_iterator_range(blocked_iterator_range& _range, tbb::split) :
+                blocked_iterator_range(_range, split()) {
         }
+#endif
+
+        /**
+         * @brief Returns the number of elements below which the range is not divided further.
+         */
+        std::size_t grainsize() const { return m_grain; }
+
+        /**
+         * @brief Checks whether the range holds more than grainsize() elements and can therefore be split.
+         */
+        bool is_divisible() const { return this->size() > m_grain; }
     };
 
     /**
-     * @brief Helper function for constructing an iterator_range object.
+     * @brief Helper function for constructing a blocked_iterator_range object from an iterator_range, as in
+     *        make_blocked_range((v.begin(), v.end()), 1024).
      */
     template <typename Iterator>
-    iterator_range<Iterator> make_iterator_range(Iterator&& _begin, Iterator&& _end) {
-        return iterator_range<typename std::remove_reference<Iterator>::type>(_begin, _end);
+    blocked_iterator_range<Iterator> make_blocked_range(const iterator_range<Iterator>& _range, std::size_t _grain = 1) {
+        return blocked_iterator_range<Iterator>(_range, _grain);
     }
 
+    template <typename T>
+    class is_splittable_range_impl {
+        template <typename U>
+        static constexpr auto check(int) -> decltype(
+                std::declval<const U&>().is_divisible() ? true : false,
+                std::declval<const U&>().empty() ? true : false,
+                U(std::declval<U&>(), split()),
+                std::true_type());
+
+        template <typename>
+        static constexpr std::false_type check(...);
+
+    public:
+        using type = decltype(check<T>(0));
+    };
+
+    /**
+     * @brief Checks whether T is a splittable range: a copyable type with is_divisible(), empty() and a splitting
+     *        constructor T(T&, split).
+     */
+    template <typename T>
+    struct is_splittable_range : conjunction<std::is_copy_constructible<T>, typename is_splittable_range_impl<T>::type> {
+    };
+
+    /**
+     * @brief Empty base class of iterators whose comma expressions find the comma overload by argument-dependent lookup
+     *        when ITERATOR_BASED_FOR_SCOPED_COMMA is defined, without the user importing IteratorBasedForImpl::syntax.
+     */
+    struct comma_syntax {
+    };
+
 } // namespace IteratorBasedForImpl
 
 
+#if defined(ITERATOR_BASED_FOR_SCOPED_COMMA)
+namespace IteratorBasedForImpl
+{
+namespace syntax
+{
+#endif
+
 /**
  * @brief Templated comma operator overload for all types that appear to be an iterator. A type appears to be an
- *        iterator if it defines a pre-increment operator and an indirection operator.
+ *        iterator if it defines a pre-increment operator and an indirection operator; pointers to objects are also
+ *        accepted, which matters when the right operand is a sentinel of class type. The right operand is either an
+ *        iterator of the same type or a sentinel the left operand can be compared against with operator!=. Move-only
+ *        iterators must be passed as rvalues since the range takes ownership of them.
  *
  * @return Returns an iterator_range object that facilitates iterating over elements in the range represented by the
- *         _begin and _end iterators with a range-based-for construct.
+ *         _begin iterator and _end iterator or sentinel with a range-based-for construct.
  */
-template <typename Iterator,
-typename std::enable_if<IteratorBasedForImpl::is_iterator<typename std::remove_reference<Iterator>::type>::value, int>::type = 0>
-IteratorBasedForImpl::iterator_range<Iterator> operator,(Iterator&& _begin, Iterator&& _end)
+#if ITERATOR_BASED_FOR_HAS_CONCEPTS
+template <typename Iterator, typename Sentinel>
+    requires IteratorBasedForImpl::comma_left_operand<std::decay_t<Iterator>>
+        && IteratorBasedForImpl::comma_sentinel_for<std::decay_t<Sentinel>, std::decay_t<Iterator>>
+        && std::constructible_from<std::decay_t<Iterator>, Iterator>
+        && std::constructible_from<std::decay_t<Sentinel>, Sentinel>
+#else
+template <typename Iterator, typename Sentinel,
+typename std::enable_if<IteratorBasedForImpl::conjunction<
+    IteratorBasedForImpl::is_comma_left_operand<typename std::decay<Iterator>::type>,
+    IteratorBasedForImpl::is_sentinel_for<typename std::decay<Sentinel>::type, typename std::decay<Iterator>::type>,
+    std::is_constructible<typename std::decay<Iterator>::type, Iterator>,
+    std::is_constructible<typename std::decay<Sentinel>::type, Sentinel>>::value, int>::type = 0>
+#endif
+#if defined(ITERATOR_BASED_FOR_PROFILE)
+ITERATOR_BASED_FOR_NOINLINE
+IteratorBasedForImpl::profiled_iterator_range<typename std::decay<Iterator>::type, typename std::decay<Sentinel>::type>
+operator,(Iterator&& _begin, Sentinel&& _end)
+{
+    return IteratorBasedForImpl::profiled_iterator_range<typename std::decay<Iterator>::type,
+                                                         typename std::decay<Sentinel>::type>(
+            IteratorBasedForImpl::make_iterator_range(std::forward<Iterator>(_begin), std::forward<Sentinel>(_end)),
+            ITERATOR_BASED_FOR_RETURN_ADDRESS());
+}
+#else
+constexpr IteratorBasedForImpl::iterator_range<typename std::decay<Iterator>::type,
+                                               typename std::decay<Sentinel>::type>
+operator,(Iterator&& _begin, Sentinel&& _end) noexcept(noexcept(
+        IteratorBasedForImpl::make_iterator_range(std::forward<Iterator>(_begin), std::forward<Sentinel>(_end))))
 {
-    return IteratorBasedForImpl::make_iterator_range(_begin, _end);
+    return IteratorBasedForImpl::make_iterator_range(std::forward<Iterator>(_begin), std::forward<Sentinel>(_end));
 }
+#endif
+
+/**
+ * By default the comma overload is declared in the global namespace, so it is a candidate for every comma expression
+ * with an operand of class type. Defining ITERATOR_BASED_FOR_SCOPED_COMMA declares it in IteratorBasedForImpl::syntax
+ * instead, where only code that imports that namespace, code inside or importing IteratorBasedForImpl and iterators
+ * associated with IteratorBasedForImpl, such as the library's own or those deriving from comma_syntax, find it.
+ * IteratorBasedForImpl::syntax exists in both modes, so using namespace IteratorBasedForImpl::syntax compiles either
+ * way.
+ */
+#if defined(ITERATOR_BASED_FOR_SCOPED_COMMA)
+} // namespace syntax
+
+    using syntax::operator,;
+
+} // namespace IteratorBasedForImpl
+#else
+namespace IteratorBasedForImpl
+{
+namespace syntax
+{
+    using ::operator,;
+} // namespace syntax
+} // namespace IteratorBasedForImpl
+#endif
+
+//The module interface declares these specializations outside of its export block, see IteratorBasedFor.cppm.
+#if ITERATOR_BASED_FOR_HAS_STD_RANGES && !defined(ITERATOR_BASED_FOR_MODULE_INTERFACE)
+namespace std
+{
+namespace ranges
+{
+    template <typename Iterator, typename Sentinel>
+    inline constexpr bool enable_view<IteratorBasedForImpl::iterator_range<Iterator, Sentinel>> = true;
+
+    template <typename Iterator, typename Sentinel>
+    inline constexpr bool enable_borrowed_range<IteratorBasedForImpl::iterator_range<Iterator, Sentinel>> = true;
+
+    template <typename Iterator>
+    inline constexpr bool enable_view<IteratorBasedForImpl::blocked_iterator_range<Iterator>> = true;
+
+    template <typename Iterator>
+    inline constexpr bool enable_borrowed_range<IteratorBasedForImpl::blocked_iterator_range<Iterator>> = true;
+} // namespace ranges
+} // namespace std
+#endif
+
+#if defined(ITERATOR_BASED_FOR_PROFILE)
+#include <IteratorBasedForProfile.hpp>
+#endif
 
 #endif // IteratorBasedFor_H
@@ -0,0 +1,2744 @@
+#ifndef IteratorBasedForAdaptors_H
+#define IteratorBasedForAdaptors_H
+
+#include <IteratorBasedFor.hpp>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#endif
+
+//Define ITERATOR_BASED_FOR_CHECKED to make checked() ranges validate their iterators; without it generation_counter
+//is empty and checked() returns the range itself.
+#if defined(ITERATOR_BASED_FOR_CHECKED)
+#define ITERATOR_BASED_FOR_HAS_CHECKED 1
+#else
+#define ITERATOR_BASED_FOR_HAS_CHECKED 0
+#endif
+
+namespace IteratorBasedForImpl
+{
+
+    /**
+     * @brief Iterates over consecutive blocks of a range. Dereferencing yields the current block as an
+     *        iterator_range<Iterator>; every block holds the same number of elements except the last, which may be
+     *        partial. Finding the end of the next block takes constant time for random access iterators and one pass
+     *        over the block otherwise.
+     *
+     * The end iterator of a blocked range is a copy of its begin iterator flagged as past the end, so ranges whose
+     * Sentinel differs from Iterator can be blocked and still iterated with a range-based for statement in C++14.
+     */
+    template <typename Iterator, typename Sentinel = Iterator>
+    class block_iterator {
+    private:
+        Iterator m_first;
+        Iterator m_last;
+        Sentinel m_end;
+        std::size_t m_block_size;
+        bool m_past_end;
+
+        bool done() const { return m_past_end || !(m_first != m_end); }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = iterator_range<Iterator>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = iterator_range<Iterator>;
+
+        block_iterator(Iterator _first, Sentinel _end, std::size_t _block_size, bool _past_end = false) :
+                m_first(_first),
+                m_last(std::move(_first)),
+                m_end(std::move(_end)),
+                m_block_size(_block_size ? _block_size : 1),
+                m_past_end(_past_end) {
+            if (!m_past_end) {
+                advance_bounded(m_last, m_block_size, m_end);
+            }
+        }
+
+        reference operator*() const { return iterator_range<Iterator>(m_first, m_last); }
+
+        block_iterator& operator++() {
+            m_first = m_last;
+            advance_bounded(m_last, m_block_size, m_end);
+            return *this;
+        }
+
+        block_iterator operator++(int) {
+            block_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const block_iterator& rhs) const {
+            return done() == rhs.done() && (done() || !(m_first != rhs.m_first));
+        }
+
+        bool operator!=(const block_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief Returns a range over the consecutive blocks of _block_size elements of _range, the last block holding
+     *        the remaining elements. Each block is an iterator_range<Iterator>, so code written for plain ranges can
+     *        run on blocks sized to fit a cache level and several passes can be fused per block:
+     *
+     *        for (auto tile : blocked((v.begin(), v.end()), 4096)) {
+     *            normalize(tile); scale(tile); clamp(tile);
+     *        }
+     *
+     *        A _block_size of zero is treated as one.
+     */
+    template <typename Iterator, typename Sentinel>
+    iterator_range<block_iterator<Iterator, Sentinel>> blocked(const iterator_range<Iterator, Sentinel>& _range,
+                                                               std::size_t _block_size) {
+        block_iterator<Iterator, Sentinel> first(_range.begin(), _range.end(), _block_size);
+        block_iterator<Iterator, Sentinel> last(_range.begin(), _range.end(), _block_size, true);
+
+        return iterator_range<block_iterator<Iterator, Sentinel>>(std::move(first), std::move(last));
+    }
+
+    /**
+     * @brief Iterates over consecutive batches of a contiguous range. Dereferencing yields the current batch as a
+     *        span<T>; every batch holds the same number of elements except the last, which may be partial.
+     */
+    template <typename T>
+    class batch_iterator {
+    private:
+        T* m_first;
+        T* m_end;
+        std::size_t m_batch_size;
+
+        std::size_t current_size() const {
+            std::size_t remaining = static_cast<std::size_t>(m_end - m_first);
+            return remaining < m_batch_size ? remaining : m_batch_size;
+        }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = span<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = span<T>;
+
+        batch_iterator(T* _first, T* _end, std::size_t _batch_size) :
+                m_first(_first), m_end(_end), m_batch_size(_batch_size ? _batch_size : 1) {
+        }
+
+        reference operator*() const { return span<T>(m_first, current_size()); }
+
+        batch_iterator& operator++() {
+            m_first += current_size();
+            return *this;
+        }
+
+        batch_iterator operator++(int) {
+            batch_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const batch_iterator& rhs) const { return m_first == rhs.m_first; }
+        bool operator!=(const batch_iterator& rhs) const { return m_first != rhs.m_first; }
+    };
+
+    /**
+     * @brief Returns a range over the consecutive batches of _batch_size elements of the contiguous range _range,
+     *        the last batch holding the remaining elements. Each batch is a span of the elements, so the loop body can
+     *        hand it to memcpy or a vectorized kernel instead of processing one element at a time:
+     *
+     *        for (auto bytes : batched((buffer.begin(), buffer.end()), 4096)) {
+     *            out.write(bytes.data(), bytes.size());
+     *        }
+     *
+     *        A _batch_size of zero is treated as one.
+     */
+    template <typename Iterator, typename Sentinel,
+              typename T = typename std::remove_reference<typename std::iterator_traits<Iterator>::reference>::type>
+    iterator_range<batch_iterator<T>> batched(const iterator_range<Iterator, Sentinel>& _range,
+                                              std::size_t _batch_size) {
+        static_assert(is_contiguous_iterator<Iterator>::value && is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "batched requires a contiguous range whose size is known in constant time");
+
+        T* first = IteratorBasedForImpl::to_address(_range.begin());
+        T* last = first + _range.size();
+
+        return iterator_range<batch_iterator<T>>(batch_iterator<T>(first, last, _batch_size),
+                                                 batch_iterator<T>(last, last, _batch_size));
+    }
+
+    /**
+     * @brief Iterates over a range like Iterator while a second iterator runs a fixed distance ahead and prefetches
+     *        the element it reaches, so the element is already in cache when the loop body gets to it. Meant for
+     *        node-based ranges such as std::list and std::map, whose traversal otherwise waits on a cache miss at
+     *        every node.
+     *
+     * Like block_iterator, the end iterator is a copy of the begin iterator flagged as past the end, so ranges whose
+     * Sentinel differs from Iterator can be prefetched and still iterated with a range-based for statement in C++14.
+     */
+    template <typename Iterator, typename Sentinel = Iterator>
+    class prefetch_iterator {
+    private:
+        Iterator m_current;
+        Iterator m_ahead;
+        Sentinel m_end;
+        bool m_past_end;
+
+        bool done() const { return m_past_end || !(m_current != m_end); }
+
+        void prefetch_ahead() {
+            if (m_ahead != m_end) {
+                prefetch(std::addressof(*m_ahead));
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using pointer = typename std::iterator_traits<Iterator>::pointer;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+        static_assert(std::is_base_of<std::forward_iterator_tag,
+                              typename std::iterator_traits<Iterator>::iterator_category>::value,
+                      "prefetch_iterator requires a multi-pass iterator to run ahead of the current element");
+
+        prefetch_iterator(Iterator _first, Sentinel _end, std::size_t _distance, bool _past_end = false) :
+                m_current(_first),
+                m_ahead(std::move(_first)),
+                m_end(std::move(_end)),
+                m_past_end(_past_end) {
+            if (m_past_end) {
+                return;
+            }
+
+            //Warms up the whole window, so the first _distance elements are not left waiting on memory either.
+            for (std::size_t i = 0; i < _distance && m_ahead != m_end; ++i) {
+                ++m_ahead;
+                prefetch_ahead();
+            }
+        }
+
+        reference operator*() const { return *m_current; }
+
+        pointer operator->() const { return std::addressof(*m_current); }
+
+        prefetch_iterator& operator++() {
+            ++m_current;
+
+            if (m_ahead != m_end) {
+                ++m_ahead;
+                prefetch_ahead();
+            }
+
+            return *this;
+        }
+
+        prefetch_iterator operator++(int) {
+            prefetch_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const prefetch_iterator& rhs) const {
+            return done() == rhs.done() && (done() || !(m_current != rhs.m_current));
+        }
+
+        bool operator!=(const prefetch_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief Returns a range over the elements of _range that prefetches the element _distance positions ahead of
+     *        the current one. The distance should cover the memory latency with the work of the loop body; a few
+     *        nodes up to a few dozen are typical:
+     *
+     *        for (const order& o : prefetched((book.begin(), book.end()), 8)) {
+     *            match(o);
+     *        }
+     *
+     *        A _distance of zero iterates without prefetching.
+     */
+    template <typename Iterator, typename Sentinel>
+    iterator_range<prefetch_iterator<Iterator, Sentinel>> prefetched(const iterator_range<Iterator, Sentinel>& _range,
+                                                                     std::size_t _distance) {
+        prefetch_iterator<Iterator, Sentinel> first(_range.begin(), _range.end(), _distance);
+        prefetch_iterator<Iterator, Sentinel> last(_range.begin(), _range.end(), _distance, true);
+
+        return iterator_range<prefetch_iterator<Iterator, Sentinel>>(std::move(first), std::move(last));
+    }
+
+    /**
+     * @brief Number of ranges interleaved_for_each() walks at the same time unless told otherwise, about the number
+     *        of cache misses a core keeps in flight.
+     */
+    constexpr std::size_t interleave_width = 8;
+
+    /**
+     * @brief Calls _f with the index of a range and its element, and returns whether to go on with the range: the
+     *        result of _f if it returns one, true otherwise.
+     */
+    template <typename F, typename Reference>
+    bool interleaved_step(F& _f, std::size_t _index, Reference&& _element, std::true_type) {
+        _f(_index, std::forward<Reference>(_element));
+        return true;
+    }
+
+    template <typename F, typename Reference>
+    bool interleaved_step(F& _f, std::size_t _index, Reference&& _element, std::false_type) {
+        return static_cast<bool>(_f(_index, std::forward<Reference>(_element)));
+    }
+
+    /**
+     * @brief Calls _f(i, x) with the index i of every range of the container _ranges and each element x of that
+     *        range, in order within a range, and returns _f. Up to _width ranges are walked at the same time, one
+     *        element of each in turn, and every cursor prefetches its next element before the others take their
+     *        steps, so the cache misses of independent pointer chases, such as hash chains or tree paths, overlap
+     *        instead of stalling one after another. A range is left as soon as _f returns false for it, if _f
+     *        returns anything, and its cursor moves on to the next range not started yet:
+     *
+     *        std::vector<iterator_range<table::const_local_iterator>> chains;
+     *
+     *        for (const key& k : probes) {
+     *            chains.push_back((table.cbegin(table.bucket(k)), table.cend(table.bucket(k))));
+     *        }
+     *
+     *        interleaved_for_each(chains, [&](std::size_t i, const table::value_type& entry) {
+     *            return entry.first == probes[i] ? (emit(i, entry.second), false) : true;
+     *        });
+     *
+     *        The iterators must find the address of their element without reading it, as those of node-based
+     *        containers do. A _width of zero is treated as one.
+     */
+    template <typename Container, typename F>
+    F interleaved_for_each(const Container& _ranges, F _f, std::size_t _width = interleave_width) {
+        using range_type = typename std::decay<decltype(*std::begin(_ranges))>::type;
+        using iterator = typename std::decay<decltype(std::declval<const range_type&>().begin())>::type;
+        using sentinel = typename std::decay<decltype(std::declval<const range_type&>().end())>::type;
+        using is_void_step = std::is_void<decltype(_f(std::size_t(), *std::declval<const iterator&>()))>;
+
+        struct cursor {
+            iterator current;
+            sentinel end;
+            std::size_t index;
+        };
+
+        const std::size_t count = static_cast<std::size_t>(std::distance(std::begin(_ranges), std::end(_ranges)));
+        auto next = std::begin(_ranges);
+        std::size_t next_index = 0;
+        const std::size_t width = std::min(count, _width ? _width : 1);
+        std::vector<cursor> cursors;
+        cursors.reserve(width);
+
+        //Points _cursor to the first element of the next non-empty range not started yet, if there is one.
+        auto start = [&](cursor& _cursor) {
+            for (; next_index < count; ++next, ++next_index) {
+                if (next->begin() != next->end()) {
+                    _cursor.current = next->begin();
+                    _cursor.end = next->end();
+                    _cursor.index = next_index;
+                    prefetch(std::addressof(*_cursor.current));
+                    ++next;
+                    ++next_index;
+                    return true;
+                }
+            }
+
+            return false;
+        };
+
+        for (cursor c{iterator(), sentinel(), 0}; cursors.size() < width && start(c);) {
+            cursors.push_back(c);
+        }
+
+        while (!cursors.empty()) {
+            for (std::size_t i = 0; i < cursors.size();) {
+                cursor& c = cursors[i];
+
+                if (interleaved_step(_f, c.index, *c.current, is_void_step()) && ++c.current != c.end) {
+                    prefetch(std::addressof(*c.current));
+                    ++i;
+                } else if (!start(c)) {
+                    if (i + 1 != cursors.size()) {
+                        c = std::move(cursors.back());
+                    }
+
+                    cursors.pop_back();
+                }
+            }
+        }
+
+        return _f;
+    }
+
+    /**
+     * @brief Holds a function object and makes it copy assignable even when it is not, as with lambdas, by copy
+     *        constructing it in place. Lets iterators that store a function object satisfy the iterator requirements.
+     */
+    template <typename F>
+    class function_box {
+    private:
+        F m_function;
+
+    public:
+        explicit function_box(F _function) : m_function(std::move(_function)) { }
+
+        function_box(const function_box&) = default;
+
+        function_box& operator=(const function_box& other) {
+            if (this != &other) {
+                m_function.~F();
+                ::new (static_cast<void*>(std::addressof(m_function))) F(other.m_function);
+            }
+
+            return *this;
+        }
+
+        ~function_box() = default;
+
+        const F& get() const { return m_function; }
+    };
+
+    /**
+     * @brief Stage of a view that replaces every element x by f(x).
+     */
+    template <typename F>
+    struct transform_stage {
+        static constexpr bool filters = false;
+
+        function_box<F> function;
+
+        template <typename X>
+        auto map(X&& _x) const -> decltype(function.get()(std::forward<X>(_x))) {
+            return function.get()(std::forward<X>(_x));
+        }
+
+        template <typename X>
+        bool test(const X&) const { return true; }
+    };
+
+    /**
+     * @brief Stage of a view that skips the elements x for which p(x) is false.
+     */
+    template <typename P>
+    struct filter_stage {
+        static constexpr bool filters = true;
+
+        function_box<P> predicate;
+
+        template <typename X>
+        X map(X&& _x) const { return std::forward<X>(_x); }
+
+        template <typename X>
+        bool test(const X& _x) const { return static_cast<bool>(predicate.get()(_x)); }
+    };
+
+    /**
+     * @brief The stages of a view, applied in order to each element of the underlying range. value() runs every
+     *        stage on an element and accepts() checks whether it passes every filter, computing the transforms in
+     *        front of each filter on the way. A chain of adaptors extends a single pipeline instead of wrapping one
+     *        iterator into another, so the loop over a view stays one flat loop over the underlying iterator.
+     */
+    template <typename... Stages>
+    struct view_pipeline;
+
+    template <>
+    struct view_pipeline<> {
+        static constexpr bool filters = false;
+
+        template <typename X>
+        X value(X&& _x) const { return std::forward<X>(_x); }
+
+        template <typename X>
+        bool accepts(X&&) const { return true; }
+
+        template <typename Stage>
+        view_pipeline<Stage> append(Stage _stage) const { return view_pipeline<Stage>{std::move(_stage), {}}; }
+    };
+
+    template <typename Stage, typename... Rest>
+    struct view_pipeline<Stage, Rest...> {
+        static constexpr bool filters = Stage::filters || view_pipeline<Rest...>::filters;
+
+        Stage head;
+        view_pipeline<Rest...> tail;
+
+        template <typename X>
+        auto value(X&& _x) const -> decltype(tail.value(head.map(std::forward<X>(_x)))) {
+            return tail.value(head.map(std::forward<X>(_x)));
+        }
+
+        template <typename X>
+        bool accepts(X&& _x) const {
+            if (!head.test(_x)) {
+                return false;
+            }
+
+            return !view_pipeline<Rest...>::filters || tail.accepts(head.map(std::forward<X>(_x)));
+        }
+
+        template <typename Next>
+        view_pipeline<Stage, Rest..., Next> append(Next _next) const {
+            return view_pipeline<Stage, Rest..., Next>{head, tail.append(std::move(_next))};
+        }
+    };
+
+    /**
+     * @brief Iterator of the views returned by transform() and filter(): the underlying iterator and the pipeline of
+     *        stages applied to the element it points to. Views without filters over random access ranges are random
+     *        access, views with filters are at most forward, since skipping backwards is rarely needed.
+     *
+     * As with block_iterator, the end iterator is flagged as past the end when Sentinel differs from Iterator.
+     */
+    template <typename Iterator, typename Sentinel, typename Pipeline>
+    class view_iterator {
+    private:
+        template <typename, typename, typename>
+        friend class view_iterator;
+
+        using base_category = typename std::iterator_traits<Iterator>::iterator_category;
+
+        Iterator m_current;
+        Sentinel m_end;
+        Pipeline m_pipeline;
+        bool m_past_end;
+
+        bool done() const { return m_past_end || !(m_current != m_end); }
+
+        void satisfy() {
+            while (m_current != m_end && !m_pipeline.accepts(*m_current)) {
+                ++m_current;
+            }
+        }
+
+    public:
+        using iterator_category = typename std::conditional<
+                !Pipeline::filters && std::is_same<Iterator, Sentinel>::value
+                && std::is_base_of<std::random_access_iterator_tag, base_category>::value,
+                std::random_access_iterator_tag,
+                typename std::conditional<std::is_base_of<std::forward_iterator_tag, base_category>::value,
+                                          std::forward_iterator_tag, std::input_iterator_tag>::type>::type;
+        using reference = decltype(std::declval<const Pipeline&>().value(*std::declval<const Iterator&>()));
+        using value_type = typename std::remove_cv<typename std::remove_reference<reference>::type>::type;
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using pointer = void;
+
+        view_iterator(Iterator _current, Sentinel _end, Pipeline _pipeline, bool _past_end = false) :
+                m_current(std::move(_current)),
+                m_end(std::move(_end)),
+                m_pipeline(std::move(_pipeline)),
+                m_past_end(_past_end) {
+            if (Pipeline::filters && !m_past_end) {
+                satisfy();
+            }
+        }
+
+        const Iterator& base() const { return m_current; }
+        const Sentinel& base_end() const { return m_end; }
+        const Pipeline& pipeline() const { return m_pipeline; }
+
+        reference operator*() const { return m_pipeline.value(*m_current); }
+
+        view_iterator& operator++() {
+            ++m_current;
+
+            if (Pipeline::filters) {
+                satisfy();
+            }
+
+            return *this;
+        }
+
+        view_iterator operator++(int) {
+            view_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const view_iterator& rhs) const {
+            return done() == rhs.done() && (done() || !(m_current != rhs.m_current));
+        }
+
+        bool operator!=(const view_iterator& rhs) const { return !(*this == rhs); }
+
+        view_iterator& operator--() {
+            --m_current;
+            return *this;
+        }
+
+        view_iterator operator--(int) {
+            view_iterator previous = *this;
+            --m_current;
+            return previous;
+        }
+
+        view_iterator& operator+=(difference_type _n) {
+            m_current += _n;
+            return *this;
+        }
+
+        view_iterator& operator-=(difference_type _n) {
+            m_current -= _n;
+            return *this;
+        }
+
+        view_iterator operator+(difference_type _n) const { return view_iterator(*this) += _n; }
+        view_iterator operator-(difference_type _n) const { return view_iterator(*this) -= _n; }
+        friend view_iterator operator+(difference_type _n, const view_iterator& _it) { return _it + _n; }
+
+        difference_type operator-(const view_iterator& rhs) const { return m_current - rhs.m_current; }
+
+        reference operator[](difference_type _n) const { return m_pipeline.value(m_current[_n]); }
+
+        bool operator<(const view_iterator& rhs) const { return m_current < rhs.m_current; }
+        bool operator>(const view_iterator& rhs) const { return rhs < *this; }
+        bool operator<=(const view_iterator& rhs) const { return !(rhs < *this); }
+        bool operator>=(const view_iterator& rhs) const { return !(*this < rhs); }
+    };
+
+    template <typename Iterator>
+    Iterator view_end_position(const Iterator&, const Iterator& _last) { return _last; }
+
+    template <typename Iterator, typename Sentinel>
+    Iterator view_end_position(const Iterator& _first, const Sentinel&) { return _first; }
+
+    /**
+     * @brief Returns where the view whose end iterator is _end stops in the underlying range.
+     */
+    template <typename Iterator, typename Pipeline>
+    const Iterator& view_bound(const view_iterator<Iterator, Iterator, Pipeline>& _end) { return _end.base(); }
+
+    template <typename Iterator, typename Sentinel, typename Pipeline>
+    const Sentinel& view_bound(const view_iterator<Iterator, Sentinel, Pipeline>& _end) { return _end.base_end(); }
+
+    template <typename Iterator, typename Sentinel, typename Pipeline>
+    iterator_range<view_iterator<Iterator, Sentinel, Pipeline>> make_view(Iterator _first, Sentinel _last,
+                                                                          const Pipeline& _pipeline) {
+        //When the sentinel is an iterator, the end of the view points at it, so views are sized like their ranges.
+        const bool past_end = !std::is_same<Iterator, Sentinel>::value;
+        view_iterator<Iterator, Sentinel, Pipeline> first(_first, _last, _pipeline);
+        view_iterator<Iterator, Sentinel, Pipeline> last(view_end_position(_first, _last), _last, _pipeline,
+                                                         past_end);
+
+        return iterator_range<view_iterator<Iterator, Sentinel, Pipeline>>(std::move(first), std::move(last));
+    }
+
+    /**
+     * @brief Returns a lazy view of f(x) for every element x of _range. Nothing is computed or stored up front; the
+     *        function is called each time an element is dereferenced:
+     *
+     *        for (double price : transform((orders.begin(), orders.end()), [](const order& o) { return o.price; })) {
+     *            ...
+     *        }
+     *
+     *        Applied to a view, transform() and filter() add a stage to its pipeline rather than wrapping it, so
+     *        chains of adaptors remain a single iterator over the original range.
+     */
+    template <typename Iterator, typename Sentinel, typename F>
+    auto transform(const iterator_range<Iterator, Sentinel>& _range, F _f)
+            -> decltype(make_view(_range.begin(), _range.end(), view_pipeline<>().append(transform_stage<F>{
+                    function_box<F>(std::move(_f))}))) {
+        return make_view(_range.begin(), _range.end(),
+                         view_pipeline<>().append(transform_stage<F>{function_box<F>(std::move(_f))}));
+    }
+
+    template <typename Iterator, typename Sentinel, typename Pipeline, typename F>
+    auto transform(const iterator_range<view_iterator<Iterator, Sentinel, Pipeline>>& _view, F _f)
+            -> decltype(make_view(_view.begin().base(), view_bound(_view.end()), _view.begin().pipeline().append(
+                    transform_stage<F>{function_box<F>(std::move(_f))}))) {
+        return make_view(_view.begin().base(), view_bound(_view.end()),
+                         _view.begin().pipeline().append(transform_stage<F>{function_box<F>(std::move(_f))}));
+    }
+
+    /**
+     * @brief Returns a lazy view of the elements x of _range for which _predicate(x) is true. The predicate is called
+     *        while iterating, so no container of the selected elements is built.
+     */
+    template <typename Iterator, typename Sentinel, typename P>
+    auto filter(const iterator_range<Iterator, Sentinel>& _range, P _predicate)
+            -> decltype(make_view(_range.begin(), _range.end(), view_pipeline<>().append(filter_stage<P>{
+                    function_box<P>(std::move(_predicate))}))) {
+        return make_view(_range.begin(), _range.end(),
+                         view_pipeline<>().append(filter_stage<P>{function_box<P>(std::move(_predicate))}));
+    }
+
+    template <typename Iterator, typename Sentinel, typename Pipeline, typename P>
+    auto filter(const iterator_range<view_iterator<Iterator, Sentinel, Pipeline>>& _view, P _predicate)
+            -> decltype(make_view(_view.begin().base(), view_bound(_view.end()), _view.begin().pipeline().append(
+                    filter_stage<P>{function_box<P>(std::move(_predicate))}))) {
+        return make_view(_view.begin().base(), view_bound(_view.end()),
+                         _view.begin().pipeline().append(filter_stage<P>{function_box<P>(std::move(_predicate))}));
+    }
+
+    /**
+     * @brief Common iterator category of several iterators: the weakest of their categories, up to random access.
+     */
+    template <typename... Categories>
+    struct common_iterator_category;
+
+    template <typename Category>
+    struct common_iterator_category<Category> {
+        using type = typename std::conditional<std::is_base_of<std::random_access_iterator_tag, Category>::value,
+                                               std::random_access_iterator_tag, Category>::type;
+    };
+
+    template <typename Category, typename... Rest>
+    struct common_iterator_category<Category, Rest...> {
+        using rest = typename common_iterator_category<Rest...>::type;
+        using type = typename std::conditional<std::is_base_of<rest, Category>::value, rest,
+                                               typename common_iterator_category<Category>::type>::type;
+    };
+
+    /**
+     * @brief Iterator over several ranges in lockstep. Dereferencing yields a std::tuple of the references of every
+     *        underlying iterator, so the elements can be read and written through structured bindings without being
+     *        copied. Only the first iterator is compared, so a loop over a zipped range checks a single end.
+     */
+    template <typename... Iterators>
+    class zip_iterator {
+    private:
+        using indices = std::index_sequence_for<Iterators...>;
+
+        std::tuple<Iterators...> m_iterators;
+
+        template <std::size_t... I>
+        void increment(std::index_sequence<I...>) {
+            (void)std::initializer_list<int>{((void)++std::get<I>(m_iterators), 0)...};
+        }
+
+        template <std::size_t... I>
+        void decrement(std::index_sequence<I...>) {
+            (void)std::initializer_list<int>{((void)--std::get<I>(m_iterators), 0)...};
+        }
+
+        template <typename Difference, std::size_t... I>
+        void advance(Difference _n, std::index_sequence<I...>) {
+            (void)std::initializer_list<int>{((void)(std::get<I>(m_iterators) += _n), 0)...};
+        }
+
+        template <std::size_t... I>
+        auto dereference(std::index_sequence<I...>) const
+                -> std::tuple<typename std::iterator_traits<Iterators>::reference...> {
+            return std::tuple<typename std::iterator_traits<Iterators>::reference...>(*std::get<I>(m_iterators)...);
+        }
+
+    public:
+        using iterator_category = typename common_iterator_category<
+                typename std::iterator_traits<Iterators>::iterator_category...>::type;
+        using value_type = std::tuple<typename std::iterator_traits<Iterators>::value_type...>;
+        using difference_type = typename std::iterator_traits<
+                typename std::tuple_element<0, std::tuple<Iterators...>>::type>::difference_type;
+        using pointer = void;
+        using reference = std::tuple<typename std::iterator_traits<Iterators>::reference...>;
+
+        explicit zip_iterator(Iterators... _iterators) : m_iterators(std::move(_iterators)...) { }
+
+        const std::tuple<Iterators...>& base() const { return m_iterators; }
+
+        reference operator*() const { return dereference(indices()); }
+
+        zip_iterator& operator++() {
+            increment(indices());
+            return *this;
+        }
+
+        zip_iterator operator++(int) {
+            zip_iterator previous = *this;
+            increment(indices());
+            return previous;
+        }
+
+        bool operator==(const zip_iterator& rhs) const {
+            return !(std::get<0>(m_iterators) != std::get<0>(rhs.m_iterators));
+        }
+
+        bool operator!=(const zip_iterator& rhs) const {
+            return std::get<0>(m_iterators) != std::get<0>(rhs.m_iterators);
+        }
+
+        zip_iterator& operator--() {
+            decrement(indices());
+            return *this;
+        }
+
+        zip_iterator operator--(int) {
+            zip_iterator previous = *this;
+            decrement(indices());
+            return previous;
+        }
+
+        zip_iterator& operator+=(difference_type _n) {
+            advance(_n, indices());
+            return *this;
+        }
+
+        zip_iterator& operator-=(difference_type _n) {
+            advance(-_n, indices());
+            return *this;
+        }
+
+        zip_iterator operator+(difference_type _n) const { return zip_iterator(*this) += _n; }
+        zip_iterator operator-(difference_type _n) const { return zip_iterator(*this) -= _n; }
+        friend zip_iterator operator+(difference_type _n, const zip_iterator& _it) { return _it + _n; }
+
+        difference_type operator-(const zip_iterator& rhs) const {
+            return std::get<0>(m_iterators) - std::get<0>(rhs.m_iterators);
+        }
+
+        reference operator[](difference_type _n) const { return *(*this + _n); }
+
+        bool operator<(const zip_iterator& rhs) const {
+            return std::get<0>(m_iterators) < std::get<0>(rhs.m_iterators);
+        }
+
+        bool operator>(const zip_iterator& rhs) const { return rhs < *this; }
+        bool operator<=(const zip_iterator& rhs) const { return !(rhs < *this); }
+        bool operator>=(const zip_iterator& rhs) const { return !(*this < rhs); }
+    };
+
+    template <typename... Ranges>
+    struct are_sized_random_access_ranges : conjunction<std::integral_constant<bool,
+            is_sized_sentinel_for<typename Ranges::sentinel, typename Ranges::iterator>::value>...> { };
+
+    /**
+     * @brief When every range is sized and random access, the zipped range stops at the end of the shortest one.
+     */
+    template <typename Range, typename... Ranges>
+    zip_iterator<typename Range::iterator, typename Ranges::iterator...> zip_end(std::true_type, const Range& _first,
+                                                                                const Ranges&... _rest) {
+        std::size_t n = _first.size();
+
+        for (std::size_t size : {_rest.size()...}) {
+            n = size < n ? size : n;
+        }
+
+        return zip_iterator<typename Range::iterator, typename Ranges::iterator...>(_first.begin(), _rest.begin()...)
+               + static_cast<std::ptrdiff_t>(n);
+    }
+
+    /**
+     * @brief Otherwise the zipped range stops at the end of the first range, and the others must be at least as long.
+     */
+    template <typename Range, typename... Ranges>
+    zip_iterator<typename Range::iterator, typename Ranges::iterator...> zip_end(std::false_type, const Range& _first,
+                                                                                const Ranges&... _rest) {
+        return zip_iterator<typename Range::iterator, typename Ranges::iterator...>(_first.end(), _rest.begin()...);
+    }
+
+    /**
+     * @brief Returns a range iterating over _ranges in lockstep, for instance over the columns of a struct-of-arrays
+     *        layout, whose elements are tuples of references:
+     *
+     *        for (auto [x, y, vx, vy] : zip((xs.begin(), xs.end()), (ys.begin(), ys.end()),
+     *                                       (vxs.begin(), vxs.end()), (vys.begin(), vys.end()))) {
+     *            x += vx * dt; y += vy * dt;
+     *        }
+     *
+     *        The loop compares a single iterator against the end and, over contiguous ranges, compiles to the same
+     *        vectorizable loop as indexing every array. When every range is sized and random access the zipped range
+     *        is as long as the shortest of them; otherwise it is as long as the first range.
+     */
+    template <typename Iterator, typename Sentinel, typename... Iterators, typename... Sentinels>
+    iterator_range<zip_iterator<Iterator, Iterators...>> zip(const iterator_range<Iterator, Sentinel>& _first,
+                                                             const iterator_range<Iterators, Sentinels>&... _rest) {
+        static_assert(std::is_same<Iterator, Sentinel>::value || are_sized_random_access_ranges<
+                              iterator_range<Iterator, Sentinel>, iterator_range<Iterators, Sentinels>...>::value,
+                      "zip requires the first range to end with an iterator unless every range is sized");
+
+        zip_iterator<Iterator, Iterators...> first(_first.begin(), _rest.begin()...);
+        zip_iterator<Iterator, Iterators...> last = zip_end(
+                typename are_sized_random_access_ranges<iterator_range<Iterator, Sentinel>,
+                                                        iterator_range<Iterators, Sentinels>...>::type(),
+                _first, _rest...);
+
+        return iterator_range<zip_iterator<Iterator, Iterators...>>(std::move(first), std::move(last));
+    }
+
+    /**
+     * @brief Iterator pairing the elements of a range with their position. Dereferencing yields a std::pair of the
+     *        index and the reference to the element. The index and the underlying iterator are separate members
+     *        incremented side by side, so the compiler keeps them in two registers as it would for a hand-written
+     *        counter, and only the underlying iterator is compared against the end.
+     *
+     * Only random access ranges keep their category, since the index of the end iterator is known without a pass over
+     * the range; other ranges give forward iterators. As with block_iterator, the end iterator is flagged as past the
+     * end when Sentinel differs from Iterator.
+     */
+    template <typename Iterator, typename Sentinel, typename Index>
+    class enumerate_iterator {
+    private:
+        using base_category = typename std::iterator_traits<Iterator>::iterator_category;
+
+        Iterator m_current;
+        Sentinel m_end;
+        Index m_index;
+        bool m_past_end;
+
+        bool done() const { return m_past_end || !(m_current != m_end); }
+
+    public:
+        using iterator_category = typename std::conditional<std::is_same<Iterator, Sentinel>::value
+                && std::is_base_of<std::random_access_iterator_tag, base_category>::value,
+                std::random_access_iterator_tag,
+                typename std::conditional<std::is_base_of<std::forward_iterator_tag, base_category>::value,
+                                          std::forward_iterator_tag, std::input_iterator_tag>::type>::type;
+        using value_type = std::pair<Index, typename std::iterator_traits<Iterator>::value_type>;
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using pointer = void;
+        using reference = std::pair<Index, typename std::iterator_traits<Iterator>::reference>;
+
+        enumerate_iterator(Iterator _current, Sentinel _end, Index _index, bool _past_end = false) :
+                m_current(std::move(_current)), m_end(std::move(_end)), m_index(_index), m_past_end(_past_end) {
+        }
+
+        const Iterator& base() const { return m_current; }
+        Index index() const { return m_index; }
+
+        reference operator*() const { return reference(m_index, *m_current); }
+
+        enumerate_iterator& operator++() {
+            ++m_current;
+            ++m_index;
+            return *this;
+        }
+
+        enumerate_iterator operator++(int) {
+            enumerate_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const enumerate_iterator& rhs) const {
+            return done() == rhs.done() && (done() || !(m_current != rhs.m_current));
+        }
+
+        bool operator!=(const enumerate_iterator& rhs) const { return !(*this == rhs); }
+
+        enumerate_iterator& operator--() {
+            --m_current;
+            --m_index;
+            return *this;
+        }
+
+        enumerate_iterator operator--(int) {
+            enumerate_iterator previous = *this;
+            --*this;
+            return previous;
+        }
+
+        enumerate_iterator& operator+=(difference_type _n) {
+            m_current += _n;
+            m_index = static_cast<Index>(m_index + _n);
+            return *this;
+        }
+
+        enumerate_iterator& operator-=(difference_type _n) { return *this += -_n; }
+
+        enumerate_iterator operator+(difference_type _n) const { return enumerate_iterator(*this) += _n; }
+        enumerate_iterator operator-(difference_type _n) const { return enumerate_iterator(*this) -= _n; }
+        friend enumerate_iterator operator+(difference_type _n, const enumerate_iterator& _it) { return _it + _n; }
+
+        difference_type operator-(const enumerate_iterator& rhs) const { return m_current - rhs.m_current; }
+
+        reference operator[](difference_type _n) const { return *(*this + _n); }
+
+        bool operator<(const enumerate_iterator& rhs) const { return m_current < rhs.m_current; }
+        bool operator>(const enumerate_iterator& rhs) const { return rhs < *this; }
+        bool operator<=(const enumerate_iterator& rhs) const { return !(rhs < *this); }
+        bool operator>=(const enumerate_iterator& rhs) const { return !(*this < rhs); }
+    };
+
+    template <typename Index, typename Iterator>
+    enumerate_iterator<Iterator, Iterator, Index> enumerate_end(const iterator_range<Iterator, Iterator>& _range,
+                                                                Index _first_index, std::true_type) {
+        return enumerate_iterator<Iterator, Iterator, Index>(_range.end(), _range.end(),
+                                                             static_cast<Index>(_first_index + _range.size()));
+    }
+
+    template <typename Index, typename Iterator, typename Sentinel>
+    enumerate_iterator<Iterator, Sentinel, Index> enumerate_end(const iterator_range<Iterator, Sentinel>& _range,
+                                                                Index _first_index, std::false_type) {
+        return enumerate_iterator<Iterator, Sentinel, Index>(_range.begin(), _range.end(), _first_index, true);
+    }
+
+    /**
+     * @brief Returns a range over the elements of _range paired with their index, counted from _first_index:
+     *
+     *        for (auto element : enumerate((v.begin(), v.end()))) {
+     *            out[element.first] = element.second * weights[element.first];
+     *        }
+     *
+     *        The index type defaults to std::size_t; a narrower type such as std::uint32_t may be chosen when the
+     *        range is known to be short enough.
+     */
+    template <typename Index = std::size_t, typename Iterator, typename Sentinel>
+    iterator_range<enumerate_iterator<Iterator, Sentinel, Index>> enumerate(
+            const iterator_range<Iterator, Sentinel>& _range, Index _first_index = Index()) {
+        static_assert(std::is_integral<Index>::value, "enumerate requires an integral index type");
+
+        enumerate_iterator<Iterator, Sentinel, Index> first(_range.begin(), _range.end(), _first_index);
+        enumerate_iterator<Iterator, Sentinel, Index> last = enumerate_end(_range, _first_index,
+                std::is_same<typename enumerate_iterator<Iterator, Sentinel, Index>::iterator_category,
+                             std::random_access_iterator_tag>());
+
+        return iterator_range<enumerate_iterator<Iterator, Sentinel, Index>>(std::move(first), std::move(last));
+    }
+
+    /**
+     * @brief Iterates over the windows of _k consecutive elements of a range. Dereferencing yields the current window
+     *        as an iterator_range<Iterator>; advancing moves both of its ends by one element, so it takes constant
+     *        time whatever the window size.
+     *
+     * As with block_iterator, the end iterator is a copy of the begin iterator flagged as past the end.
+     */
+    template <typename Iterator, typename Sentinel = Iterator>
+    class sliding_iterator {
+    private:
+        Iterator m_first;
+        Iterator m_last;
+        Sentinel m_end;
+        bool m_past_end;
+
+        bool done() const { return m_past_end; }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = iterator_range<Iterator>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = iterator_range<Iterator>;
+
+        static_assert(std::is_base_of<std::forward_iterator_tag,
+                              typename std::iterator_traits<Iterator>::iterator_category>::value,
+                      "sliding_iterator requires a multi-pass iterator to hold both ends of a window");
+
+        sliding_iterator(Iterator _first, Sentinel _end, std::size_t _k, bool _past_end = false) :
+                m_first(_first), m_last(std::move(_first)), m_end(std::move(_end)), m_past_end(_past_end) {
+            if (m_past_end) {
+                return;
+            }
+
+            //A range shorter than the window has no window at all.
+            std::size_t count = 0;
+
+            for (; count < _k && m_last != m_end; ++count) {
+                ++m_last;
+            }
+
+            m_past_end = count < _k || _k == 0;
+        }
+
+        reference operator*() const { return iterator_range<Iterator>(m_first, m_last); }
+
+        sliding_iterator& operator++() {
+            if (!(m_last != m_end)) {
+                m_past_end = true;
+            } else {
+                ++m_first;
+                ++m_last;
+            }
+
+            return *this;
+        }
+
+        sliding_iterator operator++(int) {
+            sliding_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const sliding_iterator& rhs) const {
+            return done() == rhs.done() && (done() || !(m_first != rhs.m_first));
+        }
+
+        bool operator!=(const sliding_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief Returns a range over every window of _k consecutive elements of _range, from the one starting at the
+     *        first element to the one ending at the last. Each window is an iterator_range<Iterator> and the next
+     *        one is reached in constant time. A range with fewer than _k elements, or a _k of zero, yields no window:
+     *
+     *        for (auto window : sliding((ticks.begin(), ticks.end()), 16)) {
+     *            smooth.push_back(median(window));
+     *        }
+     *
+     *        Statistics that can be updated as elements enter and leave the window are cheaper with
+     *        sliding_for_each(), since rescanning each window costs _k steps.
+     */
+    template <typename Iterator, typename Sentinel>
+    iterator_range<sliding_iterator<Iterator, Sentinel>> sliding(const iterator_range<Iterator, Sentinel>& _range,
+                                                                 std::size_t _k) {
+        sliding_iterator<Iterator, Sentinel> first(_range.begin(), _range.end(), _k);
+        sliding_iterator<Iterator, Sentinel> last(_range.begin(), _range.end(), _k, true);
+
+        return iterator_range<sliding_iterator<Iterator, Sentinel>>(std::move(first), std::move(last));
+    }
+
+    /**
+     * @brief Walks _range once with a window of _k elements and calls _f(entering, leaving) for every element, where
+     *        entering is the element joining the window and leaving points to the element that drops out of it, or
+     *        is null while the first window is being filled. Rolling statistics then cost constant time per step:
+     *
+     *        double sum = 0;
+     *        sliding_for_each((ticks.begin(), ticks.end()), 16, [&](double in, const double* out) {
+     *            sum += in - (out ? *out : 0.0);
+     *        });
+     *
+     *        Returns _f.
+     */
+    template <typename Iterator, typename Sentinel, typename F>
+    F sliding_for_each(const iterator_range<Iterator, Sentinel>& _range, std::size_t _k, F _f) {
+        static_assert(std::is_base_of<std::forward_iterator_tag,
+                              typename std::iterator_traits<Iterator>::iterator_category>::value,
+                      "sliding_for_each requires a multi-pass iterator to revisit the leaving elements");
+
+        using element = typename std::remove_reference<typename std::iterator_traits<Iterator>::reference>::type;
+
+        Iterator leaving = _range.begin();
+        Iterator entering = _range.begin();
+        std::size_t filled = 0;
+
+        for (; filled < _k && entering != _range.end(); ++filled) {
+            _f(*entering, static_cast<element*>(nullptr));
+            ++entering;
+        }
+
+        for (; entering != _range.end(); ++entering) {
+            _f(*entering, std::addressof(*leaving));
+            ++leaving;
+        }
+
+        return _f;
+    }
+
+    /**
+     * @brief Iterates over the runs of adjacent elements of a range that belong together according to a binary
+     *        predicate called on neighbours. Dereferencing yields the current run as an iterator_range<Iterator>;
+     *        the end of the next run is found by a single pass over it, so walking every run visits each element
+     *        once.
+     *
+     * As with block_iterator, the end iterator is a copy of the begin iterator flagged as past the end.
+     */
+    template <typename Iterator, typename Sentinel, typename Predicate>
+    class group_iterator {
+    private:
+        Iterator m_first;
+        Iterator m_last;
+        Sentinel m_end;
+        function_box<Predicate> m_predicate;
+        bool m_past_end;
+
+        bool done() const { return m_past_end || !(m_first != m_end); }
+
+        void find_last() {
+            m_last = m_first;
+
+            if (!(m_last != m_end)) {
+                return;
+            }
+
+            Iterator previous = m_last;
+
+            while (++m_last != m_end && m_predicate.get()(*previous, *m_last)) {
+                previous = m_last;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = iterator_range<Iterator>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = iterator_range<Iterator>;
+
+        static_assert(std::is_base_of<std::forward_iterator_tag,
+                              typename std::iterator_traits<Iterator>::iterator_category>::value,
+                      "group_iterator requires a multi-pass iterator to return runs as sub-ranges");
+
+        group_iterator(Iterator _first, Sentinel _end, Predicate _predicate, bool _past_end = false) :
+                m_first(_first),
+                m_last(std::move(_first)),
+                m_end(std::move(_end)),
+                m_predicate(std::move(_predicate)),
+                m_past_end(_past_end) {
+            if (!m_past_end) {
+                find_last();
+            }
+        }
+
+        reference operator*() const { return iterator_range<Iterator>(m_first, m_last); }
+
+        group_iterator& operator++() {
+            m_first = m_last;
+            find_last();
+            return *this;
+        }
+
+        group_iterator operator++(int) {
+            group_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const group_iterator& rhs) const {
+            return done() == rhs.done() && (done() || !(m_first != rhs.m_first));
+        }
+
+        bool operator!=(const group_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief Binary predicate grouping elements whose keys compare equal.
+     */
+    template <typename Key>
+    struct equal_keys {
+        function_box<Key> key;
+
+        template <typename X, typename Y>
+        bool operator()(const X& _x, const Y& _y) const { return key.get()(_x) == key.get()(_y); }
+    };
+
+    template <typename F, typename Reference>
+    struct is_adjacent_predicate_impl {
+        template <typename G>
+        static constexpr auto check(int) -> decltype(std::declval<const G&>()(std::declval<Reference>(),
+                                                                               std::declval<Reference>()),
+                                                     std::true_type());
+
+        template <typename>
+        static constexpr std::false_type check(...);
+
+        typedef decltype(check<F>(0)) type;
+    };
+
+    template <typename Iterator, typename Sentinel, typename Predicate>
+    iterator_range<group_iterator<Iterator, Sentinel, Predicate>> make_groups(
+            const iterator_range<Iterator, Sentinel>& _range, Predicate _predicate) {
+        group_iterator<Iterator, Sentinel, Predicate> first(_range.begin(), _range.end(), _predicate);
+        group_iterator<Iterator, Sentinel, Predicate> last(_range.begin(), _range.end(), _predicate, true);
+
+        return iterator_range<group_iterator<Iterator, Sentinel, Predicate>>(std::move(first), std::move(last));
+    }
+
+    template <typename Iterator, typename Sentinel, typename F>
+    iterator_range<group_iterator<Iterator, Sentinel, F>> group_adjacent_impl(
+            const iterator_range<Iterator, Sentinel>& _range, F _predicate, std::true_type) {
+        return make_groups(_range, std::move(_predicate));
+    }
+
+    template <typename Iterator, typename Sentinel, typename F>
+    iterator_range<group_iterator<Iterator, Sentinel, equal_keys<F>>> group_adjacent_impl(
+            const iterator_range<Iterator, Sentinel>& _range, F _key, std::false_type) {
+        return make_groups(_range, equal_keys<F>{function_box<F>(std::move(_key))});
+    }
+
+    /**
+     * @brief Returns a lazy range of the runs of adjacent elements of _range that belong together, each run an
+     *        iterator_range<Iterator> into _range, so no element is copied. _key_or_predicate is either a key
+     *        function, grouping neighbours with equal keys, or a binary predicate called on neighbours, grouping
+     *        them while it returns true:
+     *
+     *        for (auto run : group_adjacent((trades.begin(), trades.end()), [](const trade& t) { return t.symbol; })) {
+     *            totals.emplace_back(run.begin()->symbol, volume(run));
+     *        }
+     *
+     *        Over sorted data the runs are the groups of equal keys.
+     */
+    template <typename Iterator, typename Sentinel, typename F>
+    auto group_adjacent(const iterator_range<Iterator, Sentinel>& _range, F _key_or_predicate)
+            -> decltype(group_adjacent_impl(_range, std::move(_key_or_predicate), typename is_adjacent_predicate_impl<
+                    F, typename std::iterator_traits<Iterator>::reference>::type())) {
+        return group_adjacent_impl(_range, std::move(_key_or_predicate), typename is_adjacent_predicate_impl<
+                F, typename std::iterator_traits<Iterator>::reference>::type());
+    }
+
+    /**
+     * @brief State of a k-way merge: the remaining part of every run and a loser tree over them. Each internal node
+     *        of the tree holds the run that lost the match played there, so replacing the winner replays only the
+     *        matches on its path to the root, one comparison per level and no sift down as in a binary heap.
+     *
+     *        When the elements are arithmetic and compared with std::less, every node also caches the current key of
+     *        its run and the matches are decided with branch-free comparisons of these keys, without dereferencing
+     *        the run iterators. Exhausted runs then hold the largest key and lose every tie.
+     *
+     *        The state and its arrays are allocated with a rebound copy of Allocator.
+     */
+    template <typename Iterator, typename Compare, typename Allocator = std::allocator<char>>
+    class merge_state {
+    private:
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        template <typename T>
+        using vector_of = std::vector<T, typename std::allocator_traits<Allocator>::template rebind_alloc<T>>;
+
+        static constexpr bool caches_keys = std::is_arithmetic<value_type>::value
+                && (std::is_same<Compare, std::less<value_type>>::value || std::is_same<Compare, std::less<>>::value);
+
+        using key_type = typename std::conditional<caches_keys, value_type, char>::type;
+
+        /**
+         * @brief The highest bit of a tag marks an exhausted run, so that comparing tags orders live runs before
+         *        exhausted ones and ties between live runs by their position, which keeps the merge stable.
+         */
+        static constexpr std::size_t exhausted_bit = ~(~std::size_t(0) >> 1);
+
+        struct entry {
+            key_type key;
+            std::size_t tag;
+        };
+
+        vector_of<Iterator> m_current;
+        vector_of<Iterator> m_end;
+        vector_of<entry> m_losers;
+        std::size_t m_leaves;
+        entry m_winner;
+        function_box<Compare> m_compare;
+
+        static key_type exhausted_key(std::true_type) {
+            return std::numeric_limits<key_type>::has_infinity ? std::numeric_limits<key_type>::infinity()
+                                                               : std::numeric_limits<key_type>::max();
+        }
+
+        static key_type exhausted_key(std::false_type) { return key_type(); }
+
+        key_type key_of(std::size_t _run, std::true_type) const { return *m_current[_run]; }
+        key_type key_of(std::size_t, std::false_type) const { return key_type(); }
+
+        entry load(std::size_t _run) const {
+            using caching = std::integral_constant<bool, caches_keys>;
+
+            if (_run >= m_current.size() || !(m_current[_run] != m_end[_run])) {
+                return entry{exhausted_key(caching()), _run | exhausted_bit};
+            }
+
+            return entry{key_of(_run, caching()), _run};
+        }
+
+        static bool beats(const entry& _a, const entry& _b, std::true_type, const merge_state&) {
+            return (_a.key < _b.key) | ((_a.key == _b.key) & (_a.tag < _b.tag));
+        }
+
+        static bool beats(const entry& _a, const entry& _b, std::false_type, const merge_state& _state) {
+            if ((_a.tag | _b.tag) & exhausted_bit) {
+                return _a.tag < _b.tag;
+            }
+
+            const Compare& compare = _state.m_compare.get();
+            auto&& a = *_state.m_current[_a.tag];
+            auto&& b = *_state.m_current[_b.tag];
+            return compare(a, b) || (!compare(b, a) && _a.tag < _b.tag);
+        }
+
+        bool beats(const entry& _a, const entry& _b) const {
+            return beats(_a, _b, std::integral_constant<bool, caches_keys>(), *this);
+        }
+
+        entry build(std::size_t _node) {
+            if (_node >= m_leaves) {
+                return load(_node - m_leaves);
+            }
+
+            const entry left = build(2 * _node);
+            const entry right = build(2 * _node + 1);
+            const bool left_wins = beats(left, right);
+            m_losers[_node] = left_wins ? right : left;
+            return left_wins ? left : right;
+        }
+
+    public:
+        template <typename Runs>
+        merge_state(const Runs& _runs, Compare _compare, const Allocator& _allocator = Allocator()) :
+                m_current(_allocator),
+                m_end(_allocator),
+                m_losers(_allocator),
+                m_leaves(1),
+                m_winner(),
+                m_compare(std::move(_compare)) {
+            m_current.reserve(_runs.size());
+            m_end.reserve(_runs.size());
+
+            for (const auto& run : _runs) {
+                m_current.push_back(Iterator(run.begin()));
+                m_end.push_back(Iterator(run.end()));
+            }
+
+            while (m_leaves < m_current.size()) {
+                m_leaves *= 2;
+            }
+
+            m_losers.resize(m_leaves);
+            m_winner = build(1);
+        }
+
+        bool done() const { return (m_winner.tag & exhausted_bit) != 0; }
+
+        typename std::iterator_traits<Iterator>::reference top() const { return *m_current[m_winner.tag]; }
+
+        /**
+         * @brief Moves past the current smallest element.
+         */
+        void pop() {
+            const std::size_t run = m_winner.tag;
+            ++m_current[run];
+            entry winner = load(run);
+
+            for (std::size_t node = (run + m_leaves) / 2; node > 0; node /= 2) {
+                const entry loser = m_losers[node];
+                const bool swap = beats(loser, winner);
+                m_losers[node] = swap ? winner : loser;
+                winner = swap ? loser : winner;
+            }
+
+            m_winner = winner;
+        }
+    };
+
+    /**
+     * @brief Input iterator over the elements of several sorted runs in merged order. Copies share the merge state,
+     *        as with other single-pass iterators.
+     */
+    template <typename Iterator, typename Compare, typename Allocator = std::allocator<char>>
+    class merge_iterator {
+    private:
+        std::shared_ptr<merge_state<Iterator, Compare, Allocator>> m_state;
+
+        bool done() const { return !m_state || m_state->done(); }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using pointer = typename std::iterator_traits<Iterator>::pointer;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+        merge_iterator() : m_state() { }
+
+        explicit merge_iterator(std::shared_ptr<merge_state<Iterator, Compare, Allocator>> _state) :
+                m_state(std::move(_state)) {
+        }
+
+        reference operator*() const { return m_state->top(); }
+        pointer operator->() const { return std::addressof(m_state->top()); }
+
+        merge_iterator& operator++() {
+            m_state->pop();
+            return *this;
+        }
+
+        merge_iterator operator++(int) {
+            merge_iterator previous = *this;
+            m_state->pop();
+            return previous;
+        }
+
+        bool operator==(const merge_iterator& rhs) const {
+            return done() ? rhs.done() : m_state == rhs.m_state;
+        }
+
+        bool operator!=(const merge_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief Returns a lazy range over the elements of the sorted ranges in the container _runs, in the order given
+     *        by _compare, std::less<> unless specified. Elements that compare equal keep the order of their runs.
+     *        The runs are merged with a loser tree, so each element costs about log2(k) comparisons for k runs:
+     *
+     *        for (const record& r : merge(runs, by_key)) {
+     *            out.write(r);
+     *        }
+     */
+    template <typename Container, typename Compare = std::less<>,
+              typename Iterator = decltype(std::declval<const Container&>().begin()->begin())>
+    iterator_range<merge_iterator<Iterator, Compare>> merge(const Container& _runs, Compare _compare = Compare()) {
+        auto state = std::make_shared<merge_state<Iterator, Compare>>(_runs, std::move(_compare));
+        return iterator_range<merge_iterator<Iterator, Compare>>(merge_iterator<Iterator, Compare>(std::move(state)),
+                                                                 merge_iterator<Iterator, Compare>());
+    }
+
+    /**
+     * @brief Same as merge(_runs, _compare), with the merge state allocated from _allocator, such as a
+     *        std::pmr::polymorphic_allocator over a request-scoped arena:
+     *
+     *        std::pmr::monotonic_buffer_resource arena;
+     *        auto merged = merge(std::allocator_arg, std::pmr::polymorphic_allocator<char>(&arena), runs);
+     */
+    template <typename Allocator, typename Container, typename Compare = std::less<>,
+              typename Iterator = decltype(std::declval<const Container&>().begin()->begin())>
+    iterator_range<merge_iterator<Iterator, Compare, Allocator>> merge(std::allocator_arg_t, const Allocator& _allocator,
+                                                                       const Container& _runs,
+                                                                       Compare _compare = Compare()) {
+        using iterator = merge_iterator<Iterator, Compare, Allocator>;
+
+        auto state = std::allocate_shared<merge_state<Iterator, Compare, Allocator>>(_allocator, _runs,
+                                                                                      std::move(_compare), _allocator);
+        return iterator_range<iterator>(iterator(std::move(state)), iterator());
+    }
+
+    /**
+     * @brief Returns a lazy range over the elements of the sorted ranges _first, _second and _rest, all of the same
+     *        iterator type, merged in ascending order.
+     */
+    template <typename Iterator, typename... Ranges>
+    iterator_range<merge_iterator<Iterator, std::less<>>> merge(const iterator_range<Iterator>& _first,
+                                                                const iterator_range<Iterator>& _second,
+                                                                const Ranges&... _rest) {
+        return merge(std::vector<iterator_range<Iterator>>{_first, _second,
+                                                           iterator_range<Iterator>(_rest.begin(), _rest.end())...});
+    }
+
+    /**
+     * @brief Elements of a range evaluated so far, and the position in the range after them. The elements are kept in
+     *        a std::deque allocated with a rebound copy of Allocator, so the references handed out stay valid while
+     *        more elements are evaluated.
+     */
+    template <typename Iterator, typename Sentinel, typename Allocator = std::allocator<char>>
+    class cache_state {
+    public:
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+    private:
+        std::deque<value_type, typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>> m_values;
+        Iterator m_current;
+        Sentinel m_end;
+
+    public:
+        cache_state(Iterator _first, Sentinel _last, const Allocator& _allocator = Allocator()) :
+                m_values(_allocator), m_current(std::move(_first)), m_end(std::move(_last)) {
+        }
+
+        /**
+         * @brief Evaluates the elements up to position _index, if the range has that many, and checks whether it has.
+         */
+        bool reaches(std::size_t _index) {
+            while (m_values.size() <= _index) {
+                if (!(m_current != m_end)) {
+                    return false;
+                }
+
+                m_values.push_back(*m_current);
+                ++m_current;
+            }
+
+            return true;
+        }
+
+        const value_type& operator[](std::size_t _index) const { return m_values[_index]; }
+
+        /**
+         * @brief Checks whether every element of the range has been evaluated.
+         */
+        bool complete() const { return !(m_current != m_end); }
+
+        std::size_t evaluated() const { return m_values.size(); }
+    };
+
+    /**
+     * @brief Forward iterator over the elements of a cache_state, evaluating them the first time one of the iterators
+     *        sharing the state reaches them. The end iterator has no position and compares equal to every iterator
+     *        past the last element.
+     */
+    template <typename Iterator, typename Sentinel, typename Allocator = std::allocator<char>>
+    class cached_iterator {
+    private:
+        using state_type = cache_state<Iterator, Sentinel, Allocator>;
+
+        static constexpr std::size_t end_index = ~std::size_t(0);
+
+        std::shared_ptr<state_type> m_state;
+        std::size_t m_index;
+
+        bool done() const { return m_index == end_index || !m_state->reaches(m_index); }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename state_type::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        cached_iterator() : m_state(), m_index(end_index) { }
+
+        cached_iterator(std::shared_ptr<state_type> _state, std::size_t _index) :
+                m_state(std::move(_state)), m_index(_index) {
+        }
+
+        reference operator*() const {
+            m_state->reaches(m_index);
+            return (*m_state)[m_index];
+        }
+
+        pointer operator->() const { return std::addressof(**this); }
+
+        cached_iterator& operator++() {
+            ++m_index;
+            return *this;
+        }
+
+        cached_iterator operator++(int) {
+            cached_iterator previous = *this;
+            ++m_index;
+            return previous;
+        }
+
+        bool operator==(const cached_iterator& rhs) const {
+            return m_index == rhs.m_index || (done() && rhs.done());
+        }
+
+        bool operator!=(const cached_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief Returns a forward range over the elements of _range that evaluates each of them once, the first time
+     *        any pass reaches it, and keeps the result. Later passes, and other copies of the range, read the kept
+     *        values, so multi-pass algorithms over an expensive transform run the transform once per element:
+     *
+     *        auto frames = cached(transform((packets.begin(), packets.end()), decode));
+     *        auto longest = std::max_element(frames.begin(), frames.end(), by_length);
+     *
+     *        _range itself is traversed once, so it may be a single-pass range.
+     */
+    template <typename Iterator, typename Sentinel>
+    iterator_range<cached_iterator<Iterator, Sentinel>> cached(const iterator_range<Iterator, Sentinel>& _range) {
+        using iterator = cached_iterator<Iterator, Sentinel>;
+
+        auto state = std::make_shared<cache_state<Iterator, Sentinel>>(_range.begin(), _range.end());
+        return iterator_range<iterator>(iterator(std::move(state), 0), iterator());
+    }
+
+    /**
+     * @brief Same as cached(_range), with the kept elements allocated from _allocator.
+     */
+    template <typename Allocator, typename Iterator, typename Sentinel>
+    iterator_range<cached_iterator<Iterator, Sentinel, Allocator>> cached(std::allocator_arg_t,
+                                                                          const Allocator& _allocator,
+                                                                          const iterator_range<Iterator, Sentinel>& _range) {
+        using iterator = cached_iterator<Iterator, Sentinel, Allocator>;
+
+        auto state = std::allocate_shared<cache_state<Iterator, Sentinel, Allocator>>(_allocator, _range.begin(),
+                                                                                       _range.end(), _allocator);
+        return iterator_range<iterator>(iterator(std::move(state), 0), iterator());
+    }
+
+    /**
+     * @brief Returns a monotonic count of processor cycles: the time stamp counter on x86, the virtual counter on
+     *        AArch64 and nanoseconds of the steady clock elsewhere.
+     */
+    inline std::uint64_t read_cycle_counter() {
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+        return __rdtsc();
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+        std::uint64_t ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /**
+     * @brief Operations counted by the iterators of an instrumented() range. A pass is a traversal that reached the
+     *        end of the range; if cycles are tracked, every pass adds the cycles from its first operation to the
+     *        comparison that found the end, including the time spent in the loop body.
+     */
+    struct iteration_counters {
+        std::uint64_t increments;
+        std::uint64_t dereferences;
+        std::uint64_t comparisons;
+        std::uint64_t advances;
+        std::uint64_t passes;
+        std::uint64_t cycles;
+        bool track_cycles;
+        bool in_pass;
+        std::uint64_t pass_start;
+
+        explicit iteration_counters(bool _track_cycles = false) :
+                increments(0), dereferences(0), comparisons(0), advances(0), passes(0), cycles(0),
+                track_cycles(_track_cycles), in_pass(false), pass_start(0) {
+        }
+
+        void reset() { *this = iteration_counters(track_cycles); }
+
+        void touch() {
+            if (track_cycles && !in_pass) {
+                in_pass = true;
+                pass_start = read_cycle_counter();
+            }
+        }
+
+        void reached_end() {
+            ++passes;
+
+            if (track_cycles && in_pass) {
+                cycles += read_cycle_counter() - pass_start;
+                in_pass = false;
+            }
+        }
+    };
+
+    /**
+     * @brief End of an instrumented() range whose Sentinel is not an iterator.
+     */
+    template <typename Sentinel>
+    class instrumented_sentinel {
+    private:
+        Sentinel m_end;
+
+    public:
+        explicit instrumented_sentinel(Sentinel _end) : m_end(std::move(_end)) { }
+
+        const Sentinel& base() const { return m_end; }
+    };
+
+    /**
+     * @brief Iterator like Iterator, of the same category, that counts its operations in an iteration_counters
+     *        object. The end iterator of an instrumented() range is flagged, so that comparisons finding it count
+     *        as the end of a pass.
+     */
+    template <typename Iterator>
+    class instrumented_iterator {
+    private:
+        Iterator m_current;
+        iteration_counters* m_counters;
+        bool m_end;
+
+        instrumented_iterator derived(Iterator _current) const {
+            return instrumented_iterator(std::move(_current), *m_counters);
+        }
+
+        bool equal(bool _equal, bool _rhs_end) const {
+            m_counters->touch();
+            ++m_counters->comparisons;
+
+            if (_equal && (m_end || _rhs_end)) {
+                m_counters->reached_end();
+            }
+
+            return _equal;
+        }
+
+    public:
+        using iterator_category = typename std::iterator_traits<Iterator>::iterator_category;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using pointer = typename std::iterator_traits<Iterator>::pointer;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+        instrumented_iterator(Iterator _current, iteration_counters& _counters, bool _end = false) :
+                m_current(std::move(_current)), m_counters(&_counters), m_end(_end) {
+        }
+
+        instrumented_iterator(const instrumented_iterator&) = default;
+        instrumented_iterator& operator=(const instrumented_iterator&) = default;
+
+        const Iterator& base() const { return m_current; }
+
+        reference operator*() const {
+            m_counters->touch();
+            ++m_counters->dereferences;
+            return *m_current;
+        }
+
+        pointer operator->() const {
+            m_counters->touch();
+            ++m_counters->dereferences;
+            return std::addressof(*m_current);
+        }
+
+        instrumented_iterator& operator++() {
+            m_counters->touch();
+            ++m_counters->increments;
+            ++m_current;
+            m_end = false;
+            return *this;
+        }
+
+        instrumented_iterator operator++(int) {
+            instrumented_iterator previous = *this;
+            ++*this;
+            previous.m_end = false;
+            return previous;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<std::is_base_of<std::bidirectional_iterator_tag,
+                typename std::iterator_traits<I>::iterator_category>::value, int>::type = 0>
+        instrumented_iterator& operator--() {
+            m_counters->touch();
+            ++m_counters->increments;
+            --m_current;
+            m_end = false;
+            return *this;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<std::is_base_of<std::bidirectional_iterator_tag,
+                typename std::iterator_traits<I>::iterator_category>::value, int>::type = 0>
+        instrumented_iterator operator--(int) {
+            instrumented_iterator previous = *this;
+            --*this;
+            previous.m_end = false;
+            return previous;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        instrumented_iterator& operator+=(difference_type _n) {
+            m_counters->touch();
+            ++m_counters->advances;
+            m_current += _n;
+            m_end = false;
+            return *this;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        instrumented_iterator& operator-=(difference_type _n) { return *this += -_n; }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        instrumented_iterator operator+(difference_type _n) const {
+            instrumented_iterator result = derived(m_current);
+            return result += _n;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        friend instrumented_iterator operator+(difference_type _n, const instrumented_iterator& _it) {
+            return _it + _n;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        instrumented_iterator operator-(difference_type _n) const {
+            instrumented_iterator result = derived(m_current);
+            return result += -_n;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        difference_type operator-(const instrumented_iterator& rhs) const {
+            m_counters->touch();
+            ++m_counters->advances;
+            return m_current - rhs.m_current;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        reference operator[](difference_type _n) const {
+            m_counters->touch();
+            ++m_counters->dereferences;
+            return m_current[_n];
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        bool operator<(const instrumented_iterator& rhs) const {
+            return equal(m_current < rhs.m_current, false);
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        bool operator>(const instrumented_iterator& rhs) const { return rhs < *this; }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        bool operator<=(const instrumented_iterator& rhs) const { return !(rhs < *this); }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        bool operator>=(const instrumented_iterator& rhs) const { return !(*this < rhs); }
+
+        bool operator==(const instrumented_iterator& rhs) const {
+            return equal(!(m_current != rhs.m_current), rhs.m_end);
+        }
+
+        bool operator!=(const instrumented_iterator& rhs) const { return !(*this == rhs); }
+
+        template <typename Sentinel>
+        bool operator==(const instrumented_sentinel<Sentinel>& rhs) const {
+            return equal(!(m_current != rhs.base()), true);
+        }
+
+        template <typename Sentinel>
+        bool operator!=(const instrumented_sentinel<Sentinel>& rhs) const { return !(*this == rhs); }
+    };
+
+    template <typename Iterator, typename Sentinel>
+    struct instrumented_end {
+        using type = instrumented_sentinel<Sentinel>;
+
+        static type make(Sentinel _end, iteration_counters&) { return type(std::move(_end)); }
+    };
+
+    template <typename Iterator>
+    struct instrumented_end<Iterator, Iterator> {
+        using type = instrumented_iterator<Iterator>;
+
+        static type make(Iterator _end, iteration_counters& _counters) { return type(std::move(_end), _counters, true); }
+    };
+
+#if !defined(ITERATOR_BASED_FOR_NO_INSTRUMENTATION)
+    /**
+     * @brief Returns a range over the elements of _range whose iterators count their increments, dereferences,
+     *        comparisons and random access jumps, as well as complete passes over the range, in _counters. Shows
+     *        what an algorithm actually does with a range, such as a hidden second pass over a forward range:
+     *
+     *        iteration_counters counters;
+     *        process(instrumented((events.begin(), events.end()), counters));
+     *        assert(counters.passes == 1);
+     *
+     *        The counters are not synchronized, so the range must not be iterated by several threads at once. Define
+     *        ITERATOR_BASED_FOR_NO_INSTRUMENTATION to make instrumented() return _range itself.
+     */
+    template <typename Iterator, typename Sentinel>
+    iterator_range<instrumented_iterator<Iterator>, typename instrumented_end<Iterator, Sentinel>::type> instrumented(
+            const iterator_range<Iterator, Sentinel>& _range, iteration_counters& _counters) {
+        using end = instrumented_end<Iterator, Sentinel>;
+
+        return iterator_range<instrumented_iterator<Iterator>, typename end::type>(
+                instrumented_iterator<Iterator>(_range.begin(), _counters), end::make(_range.end(), _counters));
+    }
+#else
+    template <typename Iterator, typename Sentinel>
+    iterator_range<Iterator, Sentinel> instrumented(const iterator_range<Iterator, Sentinel>& _range,
+                                                    iteration_counters&) {
+        return _range;
+    }
+#endif
+
+    /**
+     * @brief Thrown by the iterators of a checked() range that were invalidated or are used together with an iterator
+     *        of another container.
+     */
+    class invalid_iterator_error : public std::logic_error {
+    public:
+        explicit invalid_iterator_error(const char* _what) : std::logic_error(_what) { }
+    };
+
+    /**
+     * @brief Generation of the contents of a container, kept by its owner next to it and advanced with invalidate()
+     *        by every operation that invalidates iterators, such as a reallocation or an erase. Iterators of checked()
+     *        ranges remember the generation they were created in and refuse to be used once it has changed. A copy
+     *        starts a new history, since iterators into the original never point into the copy. Without
+     *        ITERATOR_BASED_FOR_CHECKED the counter is empty and invalidate() does nothing.
+     */
+    class generation_counter {
+#if ITERATOR_BASED_FOR_HAS_CHECKED
+    private:
+        std::uint64_t m_value;
+
+    public:
+        generation_counter() : m_value(0) { }
+        generation_counter(const generation_counter&) : m_value(0) { }
+
+        generation_counter& operator=(const generation_counter&) {
+            invalidate();
+            return *this;
+        }
+
+        void invalidate() { ++m_value; }
+
+        std::uint64_t value() const { return m_value; }
+#else
+    public:
+        void invalidate() { }
+
+        std::uint64_t value() const { return 0; }
+#endif
+    };
+
+    [[noreturn]] inline void fail_iterator_check(const char* _what) {
+        throw invalid_iterator_error(_what);
+    }
+
+    /**
+     * @brief End of a checked() range whose Sentinel is not an iterator.
+     */
+    template <typename Sentinel>
+    class checked_sentinel {
+    private:
+        Sentinel m_end;
+
+    public:
+        explicit checked_sentinel(Sentinel _end) : m_end(std::move(_end)) { }
+
+        const Sentinel& base() const { return m_end; }
+    };
+
+    /**
+     * @brief Iterator like Iterator, of the same category, that belongs to the container whose generation_counter it
+     *        was created with. Every operation first checks that the generation has not changed since, which costs a
+     *        load and a compare, and operations involving two iterators check that they belong to the same container.
+     *        Violations throw invalid_iterator_error.
+     */
+    template <typename Iterator>
+    class checked_iterator {
+    private:
+        Iterator m_current;
+        const generation_counter* m_owner;
+        std::uint64_t m_generation;
+
+        void check() const {
+            if (m_owner->value() != m_generation) {
+                fail_iterator_check("checked_iterator: used after its container invalidated it");
+            }
+        }
+
+        void check(const checked_iterator& rhs) const {
+            if (m_owner != rhs.m_owner) {
+                fail_iterator_check("checked_iterator: combined with an iterator of another container");
+            }
+
+            check();
+            rhs.check();
+        }
+
+    public:
+        using iterator_category = typename std::iterator_traits<Iterator>::iterator_category;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using pointer = typename std::iterator_traits<Iterator>::pointer;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+        checked_iterator(Iterator _current, const generation_counter& _owner) :
+                m_current(std::move(_current)), m_owner(&_owner), m_generation(_owner.value()) {
+        }
+
+        checked_iterator(const checked_iterator&) = default;
+        checked_iterator& operator=(const checked_iterator&) = default;
+
+        const Iterator& base() const { return m_current; }
+
+        reference operator*() const {
+            check();
+            return *m_current;
+        }
+
+        pointer operator->() const {
+            check();
+            return std::addressof(*m_current);
+        }
+
+        checked_iterator& operator++() {
+            check();
+            ++m_current;
+            return *this;
+        }
+
+        checked_iterator operator++(int) {
+            checked_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<std::is_base_of<std::bidirectional_iterator_tag,
+                typename std::iterator_traits<I>::iterator_category>::value, int>::type = 0>
+        checked_iterator& operator--() {
+            check();
+            --m_current;
+            return *this;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<std::is_base_of<std::bidirectional_iterator_tag,
+                typename std::iterator_traits<I>::iterator_category>::value, int>::type = 0>
+        checked_iterator operator--(int) {
+            checked_iterator previous = *this;
+            --*this;
+            return previous;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        checked_iterator& operator+=(difference_type _n) {
+            check();
+            m_current += _n;
+            return *this;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        checked_iterator& operator-=(difference_type _n) { return *this += -_n; }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        checked_iterator operator+(difference_type _n) const {
+            checked_iterator result = *this;
+            return result += _n;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        friend checked_iterator operator+(difference_type _n, const checked_iterator& _it) {
+            return _it + _n;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        checked_iterator operator-(difference_type _n) const {
+            checked_iterator result = *this;
+            return result += -_n;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        difference_type operator-(const checked_iterator& rhs) const {
+            check(rhs);
+            return m_current - rhs.m_current;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        reference operator[](difference_type _n) const {
+            check();
+            return m_current[_n];
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        bool operator<(const checked_iterator& rhs) const {
+            check(rhs);
+            return m_current < rhs.m_current;
+        }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        bool operator>(const checked_iterator& rhs) const { return rhs < *this; }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        bool operator<=(const checked_iterator& rhs) const { return !(rhs < *this); }
+
+        template <typename I = Iterator, typename std::enable_if<is_random_access_iterator<I>::value, int>::type = 0>
+        bool operator>=(const checked_iterator& rhs) const { return !(*this < rhs); }
+
+        bool operator==(const checked_iterator& rhs) const {
+            check(rhs);
+            return !(m_current != rhs.m_current);
+        }
+
+        bool operator!=(const checked_iterator& rhs) const { return !(*this == rhs); }
+
+        template <typename Sentinel>
+        bool operator==(const checked_sentinel<Sentinel>& rhs) const {
+            check();
+            return !(m_current != rhs.base());
+        }
+
+        template <typename Sentinel>
+        bool operator!=(const checked_sentinel<Sentinel>& rhs) const { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief Returns _it as a checked_iterator of the container whose generation is _owner, for containers that hand
+     *        out checked iterators themselves. A range of two such iterators, as in (a.checked_begin(), b.checked_end()),
+     *        detects on its first comparison that they belong to different containers.
+     */
+    template <typename Iterator>
+    checked_iterator<Iterator> make_checked_iterator(Iterator _it, const generation_counter& _owner) {
+        return checked_iterator<Iterator>(std::move(_it), _owner);
+    }
+
+    template <typename Iterator, typename Sentinel>
+    struct checked_end {
+        using type = checked_sentinel<Sentinel>;
+
+        static type make(Sentinel _end, const generation_counter&) { return type(std::move(_end)); }
+    };
+
+    template <typename Iterator>
+    struct checked_end<Iterator, Iterator> {
+        using type = checked_iterator<Iterator>;
+
+        static type make(Iterator _end, const generation_counter& _owner) { return type(std::move(_end), _owner); }
+    };
+
+    template <typename Iterator, typename Sentinel>
+    void check_range_order(const iterator_range<Iterator, Sentinel>& _range, std::true_type) {
+        if (_range.end() - _range.begin() < 0) {
+            fail_iterator_check("checked: the range ends before it begins, its ends belong to different containers");
+        }
+    }
+
+    template <typename Iterator, typename Sentinel>
+    void check_range_order(const iterator_range<Iterator, Sentinel>&, std::false_type) {
+    }
+
+#if ITERATOR_BASED_FOR_HAS_CHECKED
+    /**
+     * @brief Returns a range over the elements of _range, a range into the container whose generation is _owner,
+     *        whose iterators throw invalid_iterator_error when they are used after _owner was invalidated:
+     *
+     *        for (auto& order : checked((orders.begin(), orders.end()), orders_generation)) {
+     *            handle(order);                      //throws if handle() made orders reallocate
+     *        }
+     *
+     *        A random access range whose end lies before its begin, as a pair of iterators of different containers
+     *        often does, is rejected right away. Define ITERATOR_BASED_FOR_CHECKED to enable the checks; otherwise
+     *        checked() returns _range itself.
+     */
+    template <typename Iterator, typename Sentinel>
+    iterator_range<checked_iterator<Iterator>, typename checked_end<Iterator, Sentinel>::type> checked(
+            const iterator_range<Iterator, Sentinel>& _range, const generation_counter& _owner) {
+        using end = checked_end<Iterator, Sentinel>;
+
+        check_range_order(_range, is_sized_sentinel_for<Sentinel, Iterator>());
+        return iterator_range<checked_iterator<Iterator>, typename end::type>(
+                checked_iterator<Iterator>(_range.begin(), _owner), end::make(_range.end(), _owner));
+    }
+#else
+    template <typename Iterator, typename Sentinel>
+    iterator_range<Iterator, Sentinel> checked(const iterator_range<Iterator, Sentinel>& _range,
+                                               const generation_counter&) {
+        return _range;
+    }
+#endif
+
+    /**
+     * @brief A sub-range of a random access sequence stored as two offsets of type Offset from the first element of
+     *        the sequence instead of two iterators. Tables of many sub-ranges into a few shared arrays, such as the
+     *        posting lists of an inverted index, take 8 bytes per entry with 32-bit offsets instead of 16. The base is
+     *        supplied again whenever the range is accessed, either with at(base) or with the comma syntax:
+     *
+     *        for (auto& doc : postings.begin(), index[term]) { ... }
+     */
+    template <typename Iterator, typename Offset = std::uint32_t>
+    class offset_range {
+        static_assert(is_random_access_iterator<Iterator>::value, "offset_range requires random access iterators");
+        static_assert(std::is_unsigned<Offset>::value, "offset_range requires an unsigned offset type");
+
+    private:
+        Offset m_first;
+        Offset m_last;
+
+    public:
+        using iterator = Iterator;
+        using offset_type = Offset;
+
+        constexpr offset_range() noexcept : m_first(0), m_last(0) { }
+
+        constexpr offset_range(Offset _first, Offset _last) noexcept : m_first(_first), m_last(_last) { }
+
+        constexpr Offset first_offset() const noexcept { return m_first; }
+        constexpr Offset last_offset() const noexcept { return m_last; }
+        constexpr std::size_t size() const noexcept { return static_cast<std::size_t>(m_last - m_first); }
+        constexpr bool empty() const noexcept { return m_first == m_last; }
+
+        /**
+         * @brief Rebuilds the range over the elements of the sequence starting at _base.
+         */
+        constexpr iterator_range<Iterator> at(const Iterator& _base) const noexcept(
+                noexcept(_base + typename std::iterator_traits<Iterator>::difference_type())) {
+            using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+
+            return iterator_range<Iterator>(_base + static_cast<difference_type>(m_first),
+                                            _base + static_cast<difference_type>(m_last));
+        }
+
+        constexpr bool operator==(const offset_range& rhs) const noexcept {
+            return m_first == rhs.m_first && m_last == rhs.m_last;
+        }
+
+        constexpr bool operator!=(const offset_range& rhs) const noexcept { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief Returns the offsets of _range relative to _base, the first element of the sequence _range lies in.
+     *        Throws std::out_of_range if _range starts before _base or does not fit into Offset.
+     */
+    template <typename Offset = std::uint32_t, typename Iterator>
+    offset_range<Iterator, Offset> make_offset_range(const Iterator& _base, const iterator_range<Iterator>& _range) {
+        auto first = _range.begin() - _base;
+        auto last = _range.end() - _base;
+
+        if (first < 0 || last < first || static_cast<std::uintmax_t>(last) > std::numeric_limits<Offset>::max()) {
+            throw std::out_of_range("make_offset_range: the range does not fit into the offset type");
+        }
+
+        return offset_range<Iterator, Offset>(static_cast<Offset>(first), static_cast<Offset>(last));
+    }
+
+    /**
+     * @brief Comma overload resolving an offset_range against the base it was made from, as in
+     *        for (auto& x : base, offsets). The base may be a pointer or any iterator convertible to the iterator of
+     *        the offset_range, such as the non-const iterator of a container for offsets of its const_iterator.
+     */
+    template <typename Base, typename Iterator, typename Offset,
+              typename std::enable_if<std::is_convertible<Base, Iterator>::value, int>::type = 0>
+    constexpr iterator_range<Iterator> operator,(Base&& _base, const offset_range<Iterator, Offset>& _offsets) noexcept(
+            noexcept(_offsets.at(std::declval<Iterator>())) && std::is_nothrow_constructible<Iterator, Base>::value) {
+        return _offsets.at(Iterator(std::forward<Base>(_base)));
+    }
+
+    /**
+     * @brief Iterates over every _step-th element of a range, starting with its first element. Stepping takes
+     *        constant time for random access iterators with a sized end and _step increments otherwise; it never
+     *        steps past the end. Like a block_iterator, the end is a copy of the begin iterator flagged as past the
+     *        end.
+     */
+    template <typename Iterator, typename Sentinel = Iterator>
+    class stride_iterator {
+    private:
+        Iterator m_current;
+        Sentinel m_end;
+        std::size_t m_step;
+        bool m_past_end;
+
+        bool done() const { return m_past_end || !(m_current != m_end); }
+
+    public:
+        using iterator_category = typename common_iterator_category<
+                typename std::iterator_traits<Iterator>::iterator_category, std::forward_iterator_tag>::type;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::iterator_traits<Iterator>::pointer;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+        stride_iterator(Iterator _current, Sentinel _end, std::size_t _step, bool _past_end = false) :
+                m_current(std::move(_current)),
+                m_end(std::move(_end)),
+                m_step(_step ? _step : 1),
+                m_past_end(_past_end) {
+        }
+
+        reference operator*() const { return *m_current; }
+
+        stride_iterator& operator++() {
+            advance_bounded(m_current, m_step, m_end);
+            return *this;
+        }
+
+        stride_iterator operator++(int) {
+            stride_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const stride_iterator& rhs) const {
+            return done() == rhs.done() && (done() || !(m_current != rhs.m_current));
+        }
+
+        bool operator!=(const stride_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief Returns a range over every _step-th element of _range, in one pass and without allocating, as in
+     *        for (auto& frame : stride((frames.begin(), frames.end()), 10)). A _step of zero is treated as one.
+     */
+    template <typename Iterator, typename Sentinel>
+    iterator_range<stride_iterator<Iterator, Sentinel>> stride(const iterator_range<Iterator, Sentinel>& _range,
+                                                               std::size_t _step) {
+        stride_iterator<Iterator, Sentinel> first(_range.begin(), _range.end(), _step);
+        stride_iterator<Iterator, Sentinel> last(_range.begin(), _range.end(), _step, true);
+
+        return iterator_range<stride_iterator<Iterator, Sentinel>>(std::move(first), std::move(last));
+    }
+
+    /**
+     * @brief The orders in which a grid() visits its elements.
+     */
+    namespace traversal
+    {
+
+        /**
+         * @brief Visits the elements with the last coordinate changing fastest, as nested loops would.
+         */
+        struct row_major { };
+
+        /**
+         * @brief Visits the grid one hypercube tile of Side elements per dimension at a time, the tiles and the
+         *        elements within a tile in row-major order. Tiles at the upper edges are cut to the extents.
+         */
+        template <std::size_t Side>
+        struct tiled {
+            static_assert(Side > 0, "traversal::tiled requires tiles of at least one element");
+        };
+
+        /**
+         * @brief Visits the elements in Z-order, the order of the Morton codes that interleave the bits of their
+         *        coordinates, with the bits of the last coordinate lowest. Near elements stay near at every scale,
+         *        without a tile size to tune. Extents that are not powers of two are walked as part of the next
+         *        power of two, skipping the coordinates outside of them.
+         */
+        struct morton { };
+
+    } // namespace traversal
+
+    /**
+     * @brief Forward iterator over the elements of an N-dimensional grid laid over a random access range, in the
+     *        order Order of namespace traversal. The element at coordinates (c0, ..., cN-1) is the one
+     *        c0 * s0 + ... + cN-1 * sN-1 elements after the first, for the strides s of the grid.
+     */
+    template <typename Iterator, std::size_t N, typename Order = traversal::row_major>
+    class grid_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using pointer = typename std::iterator_traits<Iterator>::pointer;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+        using coordinates_type = std::array<std::size_t, N>;
+
+        static_assert(N > 0, "grid_iterator requires at least one dimension");
+
+    private:
+        Iterator m_first;
+        coordinates_type m_extents;
+        std::array<difference_type, N> m_strides;
+        coordinates_type m_coordinates;
+        //The coordinates of the current tile of traversal::tiled.
+        coordinates_type m_origin;
+        //The number of bits of every coordinate below the next power of two of its extent, for traversal::morton.
+        std::array<unsigned char, N> m_bits;
+        difference_type m_offset;
+        std::size_t m_position;
+        std::size_t m_size;
+
+        void set(std::size_t _dimension, std::size_t _coordinate) {
+            m_offset += (static_cast<difference_type>(_coordinate)
+                         - static_cast<difference_type>(m_coordinates[_dimension])) * m_strides[_dimension];
+            m_coordinates[_dimension] = _coordinate;
+        }
+
+        void step(traversal::row_major) {
+            for (std::size_t d = N; d-- > 0;) {
+                if (m_coordinates[d] + 1 < m_extents[d]) {
+                    return set(d, m_coordinates[d] + 1);
+                }
+
+                set(d, 0);
+            }
+        }
+
+        template <std::size_t Side>
+        void step(traversal::tiled<Side>) {
+            for (std::size_t d = N; d-- > 0;) {
+                if (m_coordinates[d] + 1 < std::min(m_origin[d] + Side, m_extents[d])) {
+                    return set(d, m_coordinates[d] + 1);
+                }
+
+                set(d, m_origin[d]);
+            }
+
+            for (std::size_t d = N; d-- > 0;) {
+                m_origin[d] = m_origin[d] + Side < m_extents[d] ? m_origin[d] + Side : 0;
+                set(d, m_origin[d]);
+
+                if (m_origin[d] != 0) {
+                    return;
+                }
+            }
+        }
+
+        void step(traversal::morton) {
+            //Adds one to the Morton code of the coordinates, whose bits are visited from the lowest: every bit that
+            //is set is cleared, and the first clear one is set. Codes of coordinates outside of the extents are
+            //skipped; the caller guarantees that one within them follows.
+            do {
+                bool carry = true;
+
+                for (unsigned char level = 0; carry; ++level) {
+                    for (std::size_t d = N; d-- > 0 && carry;) {
+                        if (level < m_bits[d]) {
+                            const std::size_t bit = std::size_t(1) << level;
+                            carry = (m_coordinates[d] & bit) != 0;
+                            set(d, m_coordinates[d] ^ bit);
+                        }
+                    }
+                }
+            } while (!inside());
+        }
+
+        bool inside() const {
+            for (std::size_t d = 0; d < N; ++d) {
+                if (m_coordinates[d] >= m_extents[d]) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    public:
+        grid_iterator() :
+                m_first(), m_extents(), m_strides(), m_coordinates(), m_origin(), m_bits(), m_offset(0),
+                m_position(0), m_size(0) {
+        }
+
+        /**
+         * @brief Points to the element at the _position-th place in the traversal order of the grid with the given
+         *        extents and strides over the range starting at _first. Only the first element, at position zero,
+         *        and the end, at the number of elements, can be pointed to directly.
+         */
+        grid_iterator(Iterator _first, const coordinates_type& _extents,
+                      const std::array<difference_type, N>& _strides, std::size_t _position) :
+                m_first(std::move(_first)),
+                m_extents(_extents),
+                m_strides(_strides),
+                m_coordinates(),
+                m_origin(),
+                m_bits(),
+                m_offset(0),
+                m_position(_position),
+                m_size(1) {
+            for (std::size_t d = 0; d < N; ++d) {
+                m_size *= m_extents[d];
+
+                while ((std::size_t(1) << m_bits[d]) < m_extents[d]) {
+                    ++m_bits[d];
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the coordinates of the current element.
+         */
+        const coordinates_type& coordinates() const { return m_coordinates; }
+
+        /**
+         * @brief Returns the element at the coordinates of the current one plus _delta, such as a neighbour of a
+         *        stencil. The coordinates must be within the extents of the grid.
+         */
+        reference neighbor(const std::array<difference_type, N>& _delta) const {
+            difference_type offset = m_offset;
+
+            for (std::size_t d = 0; d < N; ++d) {
+                offset += _delta[d] * m_strides[d];
+            }
+
+            return m_first[offset];
+        }
+
+        reference operator*() const { return m_first[m_offset]; }
+        pointer operator->() const { return std::addressof(**this); }
+
+        grid_iterator& operator++() {
+            if (++m_position < m_size) {
+                step(Order());
+            }
+
+            return *this;
+        }
+
+        grid_iterator operator++(int) {
+            grid_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const grid_iterator& rhs) const { return m_position == rhs.m_position; }
+        bool operator!=(const grid_iterator& rhs) const { return m_position != rhs.m_position; }
+    };
+
+    /**
+     * @brief Returns a range over the N-dimensional grid with the given extents and strides laid over the random
+     *        access range _range, visited in the order Order of namespace traversal:
+     *
+     *        auto pixels = grid<traversal::tiled<32>>((image.begin(), image.end()), {height, width}, {pitch, 1});
+     *
+     *        for (auto it = pixels.begin(); it != pixels.end(); ++it) {
+     *            out[it.coordinates()[1] * height + it.coordinates()[0]] = *it;
+     *        }
+     *
+     *        Row-major order reads a column of a transpose or a stencil from rows far apart; tiled and Morton orders
+     *        keep the rows they touch in the caches. Throws std::out_of_range if an element of the grid is outside
+     *        of _range.
+     */
+    template <typename Order = traversal::row_major, typename Iterator, typename Sentinel, std::size_t N>
+    iterator_range<grid_iterator<Iterator, N, Order>> grid(
+            const iterator_range<Iterator, Sentinel>& _range, const std::size_t (&_extents)[N],
+            const typename std::iterator_traits<Iterator>::difference_type (&_strides)[N]) {
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        std::array<std::size_t, N> extents;
+        std::array<difference_type, N> strides;
+        std::size_t size = 1;
+        difference_type low = 0;
+        difference_type high = 0;
+
+        for (std::size_t d = 0; d < N; ++d) {
+            extents[d] = _extents[d];
+            strides[d] = _strides[d];
+            size *= extents[d];
+            const difference_type reach = static_cast<difference_type>(extents[d] ? extents[d] - 1 : 0) * strides[d];
+            (reach < 0 ? low : high) += reach;
+        }
+
+        if (size != 0 && (low < 0 || high >= std::distance(_range.begin(), _range.end()))) {
+            throw std::out_of_range("grid: the grid reaches outside of the range");
+        }
+
+        return iterator_range<grid_iterator<Iterator, N, Order>>(
+                grid_iterator<Iterator, N, Order>(_range.begin(), extents, strides, 0),
+                grid_iterator<Iterator, N, Order>(_range.begin(), extents, strides, size));
+    }
+
+    /**
+     * @brief Same as grid(_range, _extents, strides) with the strides of a dense row-major array of the given extents.
+     */
+    template <typename Order = traversal::row_major, typename Iterator, typename Sentinel, std::size_t N>
+    iterator_range<grid_iterator<Iterator, N, Order>> grid(const iterator_range<Iterator, Sentinel>& _range,
+                                                           const std::size_t (&_extents)[N]) {
+        typename std::iterator_traits<Iterator>::difference_type strides[N];
+        typename std::iterator_traits<Iterator>::difference_type stride = 1;
+
+        for (std::size_t d = N; d-- > 0;) {
+            strides[d] = stride;
+            stride *= static_cast<decltype(stride)>(_extents[d]);
+        }
+
+        return grid<Order>(_range, _extents, strides);
+    }
+
+    /**
+     * @brief Returns _k elements of _range chosen uniformly at random with _rng, or all of them if it holds fewer,
+     *        in unspecified order. The range is read in a single pass, so input ranges such as telemetry streams
+     *        need not be counted first, and the result is the only allocation.
+     *
+     *        Elements are reservoir sampled with Li's Algorithm L, which draws the number of elements to skip before
+     *        the next replacement instead of a random number per element. Skipping takes constant time for random
+     *        access iterators with a sized end, so sampling a random access range of n elements takes
+     *        O(k (1 + log(n / k))) steps rather than O(n).
+     */
+    template <typename Iterator, typename Sentinel, typename UniformRandomBitGenerator>
+    std::vector<typename std::iterator_traits<Iterator>::value_type> sample(
+            const iterator_range<Iterator, Sentinel>& _range, std::size_t _k, UniformRandomBitGenerator&& _rng) {
+        std::vector<typename std::iterator_traits<Iterator>::value_type> reservoir;
+        reservoir.reserve(_k);
+        Iterator it = _range.begin();
+        const Sentinel end = _range.end();
+
+        for (; reservoir.size() < _k && it != end; ++it) {
+            reservoir.push_back(*it);
+        }
+
+        if (reservoir.size() < _k || _k == 0) {
+            return reservoir;
+        }
+
+        //Draws from (0, 1], so that the logarithms below stay finite.
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        auto draw = [&unit, &_rng]() { return 1.0 - unit(_rng); };
+        std::uniform_int_distribution<std::size_t> slot(0, _k - 1);
+        const double k = static_cast<double>(_k);
+        double weight = std::exp(std::log(draw()) / k);
+
+        for (;;) {
+            //Once the weight underflows the skip is infinite or NaN, and either ends the range.
+            const double skip = std::floor(std::log(draw()) / std::log(1.0 - weight));
+            advance_bounded(it, skip < 1e18 ? static_cast<std::size_t>(skip) : std::numeric_limits<std::size_t>::max(),
+                            end);
+
+            if (!(it != end)) {
+                return reservoir;
+            }
+
+            reservoir[slot(_rng)] = *it;
+            ++it;
+            weight *= std::exp(std::log(draw()) / k);
+        }
+    }
+
+    /**
+     * @brief Random access iterator over the buckets of an unordered associative container. Dereferencing yields the
+     *        elements of the current bucket as an iterator_range of the container's local iterators, so the generic
+     *        parallel algorithms can hand disjoint sets of buckets to their threads.
+     */
+    template <typename Container>
+    class bucket_iterator {
+    private:
+        Container* m_container;
+        std::size_t m_bucket;
+
+    public:
+        using local_iterator = decltype(std::declval<Container&>().begin(std::size_t()));
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = iterator_range<local_iterator>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = iterator_range<local_iterator>;
+
+        bucket_iterator() noexcept : m_container(nullptr), m_bucket(0) { }
+
+        bucket_iterator(Container& _container, std::size_t _bucket) noexcept :
+                m_container(std::addressof(_container)),
+                m_bucket(_bucket) {
+        }
+
+        /**
+         * @brief Returns the index of the current bucket.
+         */
+        std::size_t bucket() const noexcept { return m_bucket; }
+
+        reference operator*() const { return reference(m_container->begin(m_bucket), m_container->end(m_bucket)); }
+        reference operator[](difference_type _n) const { return *(*this + _n); }
+
+        bucket_iterator& operator++() noexcept { ++m_bucket; return *this; }
+        bucket_iterator& operator--() noexcept { --m_bucket; return *this; }
+
+        bucket_iterator operator++(int) noexcept {
+            bucket_iterator previous = *this;
+            ++m_bucket;
+            return previous;
+        }
+
+        bucket_iterator operator--(int) noexcept {
+            bucket_iterator previous = *this;
+            --m_bucket;
+            return previous;
+        }
+
+        bucket_iterator& operator+=(difference_type _n) noexcept {
+            m_bucket = static_cast<std::size_t>(static_cast<difference_type>(m_bucket) + _n);
+            return *this;
+        }
+
+        bucket_iterator& operator-=(difference_type _n) noexcept { return *this += -_n; }
+
+        friend bucket_iterator operator+(bucket_iterator _it, difference_type _n) noexcept { return _it += _n; }
+        friend bucket_iterator operator+(difference_type _n, bucket_iterator _it) noexcept { return _it += _n; }
+        friend bucket_iterator operator-(bucket_iterator _it, difference_type _n) noexcept { return _it -= _n; }
+
+        friend difference_type operator-(const bucket_iterator& _lhs, const bucket_iterator& _rhs) noexcept {
+            return static_cast<difference_type>(_lhs.m_bucket) - static_cast<difference_type>(_rhs.m_bucket);
+        }
+
+        friend bool operator==(const bucket_iterator& _lhs, const bucket_iterator& _rhs) noexcept {
+            return _lhs.m_bucket == _rhs.m_bucket;
+        }
+
+        friend bool operator!=(const bucket_iterator& _lhs, const bucket_iterator& _rhs) noexcept {
+            return _lhs.m_bucket != _rhs.m_bucket;
+        }
+
+        friend bool operator<(const bucket_iterator& _lhs, const bucket_iterator& _rhs) noexcept {
+            return _lhs.m_bucket < _rhs.m_bucket;
+        }
+
+        friend bool operator>(const bucket_iterator& _lhs, const bucket_iterator& _rhs) noexcept {
+            return _rhs < _lhs;
+        }
+
+        friend bool operator<=(const bucket_iterator& _lhs, const bucket_iterator& _rhs) noexcept {
+            return !(_rhs < _lhs);
+        }
+
+        friend bool operator>=(const bucket_iterator& _lhs, const bucket_iterator& _rhs) noexcept {
+            return !(_lhs < _rhs);
+        }
+    };
+
+    /**
+     * @brief Returns a sized random access range over the buckets of the unordered map or set _container, each of
+     *        which is an iterator_range of local iterators. Unlike the forward iterators of the container, the range
+     *        can be split, so a sweep over a large hash map runs on every thread of a pool:
+     *
+     *        for_each(execution::par, buckets(sessions), [now](auto bucket) {
+     *            for (auto& session : bucket) { session.second.expire(now); }
+     *        });
+     *
+     *        The range is invalidated by a rehash, so the loop must not insert elements.
+     */
+    template <typename Container>
+    iterator_range<bucket_iterator<Container>> buckets(Container& _container) {
+        return iterator_range<bucket_iterator<Container>>(bucket_iterator<Container>(_container, 0),
+                                                          bucket_iterator<Container>(_container,
+                                                                                     _container.bucket_count()));
+    }
+
+} // namespace IteratorBasedForImpl
+
+#endif // IteratorBasedForAdaptors_H
@@ -0,0 +1,4614 @@
+#ifndef IteratorBasedForAlgorithm_H
+#define IteratorBasedForAlgorithm_H
+
+#include <IteratorBasedFor.hpp>
+#include <IteratorBasedForSimd.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+
+namespace IteratorBasedForImpl
+{
+
+    /**
+     * @brief The classes algorithms over sized ranges sort ranges into by their number of elements, once per call,
+     *        to choose how to run them: tiny ranges run straight-line code without any vector or loop setup, medium
+     *        ones the vector kernels or vectorized loops on the calling thread, and large ones, under a parallel
+     *        policy, on the threads of the pool.
+     */
+    enum class size_class : std::size_t {
+        tiny,
+        medium,
+        large
+    };
+
+    /**
+     * @brief Largest tiny_range_threshold(), the number of elements the straight-line code of tiny ranges covers.
+     */
+    constexpr std::size_t max_tiny_range = 16;
+
+    /**
+     * @brief Returns the setting behind tiny_range_threshold().
+     */
+    inline std::atomic<std::size_t>& tiny_range_threshold_setting() {
+        static std::atomic<std::size_t> threshold(max_tiny_range);
+        return threshold;
+    }
+
+    /**
+     * @brief Returns the number of elements up to which a range is tiny. Defaults to max_tiny_range.
+     */
+    inline std::size_t tiny_range_threshold() {
+        return tiny_range_threshold_setting().load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sets tiny_range_threshold() to _n, at most max_tiny_range. Use 0 to run every range as a medium one.
+     */
+    inline void set_tiny_range_threshold(std::size_t _n) {
+        tiny_range_threshold_setting().store(std::min(_n, max_tiny_range), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the setting behind parallel_range_threshold().
+     */
+    inline std::atomic<std::size_t>& parallel_range_threshold_setting() {
+        static std::atomic<std::size_t> threshold(4096);
+        return threshold;
+    }
+
+    /**
+     * @brief Returns the number of elements from which a range is large. Parallel policies split smaller ranges
+     *        across the pool only with an explicit grain size or a grain_tuner; otherwise they run them on the
+     *        calling thread. Defaults to 4096, about as many cheap elements as a thread processes in the time waking
+     *        the pool takes.
+     */
+    inline std::size_t parallel_range_threshold() {
+        return parallel_range_threshold_setting().load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sets parallel_range_threshold() to _n. Use 0 to split every range, as for loops whose few elements are
+     *        each expensive.
+     */
+    inline void set_parallel_range_threshold(std::size_t _n) {
+        parallel_range_threshold_setting().store(_n, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the size class of a range of _n elements run on the calling thread, or by a parallel policy if
+     *        _parallel is set; only the latter can be large. Profiling builds count the ranges of every class, see
+     *        size_class_profile().
+     */
+    inline size_class classify_size(std::size_t _n, bool _parallel = false) {
+        const size_class result = _parallel && _n >= parallel_range_threshold() ? size_class::large
+                                  : _n <= tiny_range_threshold() ? size_class::tiny : size_class::medium;
+#if defined(ITERATOR_BASED_FOR_PROFILE)
+        this_thread_loop_profile().record_size_class(static_cast<std::size_t>(result));
+#endif
+        return result;
+    }
+
+#if defined(ITERATOR_BASED_FOR_PROFILE)
+    /**
+     * @brief The size class thresholds in effect and the number of ranges dispatched in every class so far.
+     */
+    struct size_class_statistics {
+        std::size_t tiny_threshold;
+        std::size_t parallel_threshold;
+        std::array<std::uint64_t, loop_size_classes> calls;
+    };
+
+    inline size_class_statistics size_class_profile() {
+        return size_class_statistics{tiny_range_threshold(), parallel_range_threshold(), size_class_calls()};
+    }
+#endif
+
+    /**
+     * @brief Calls _g(i) for every i in [0, _n), in order, for an _n of at most max_tiny_range: a single jump into
+     *        a sequence of calls at constant offsets from the end, with no loop counter or exit branch.
+     */
+    template <typename G>
+    void tiny_loop(std::int32_t _n, G&& _g) {
+        static_assert(max_tiny_range == 16, "tiny_loop() unrolls max_tiny_range calls");
+
+        switch (_n) {
+            case 16:
+                _g(_n - 16);
+                //Falls through.
+            case 15:
+                _g(_n - 15);
+                //Falls through.
+            case 14:
+                _g(_n - 14);
+                //Falls through.
+            case 13:
+                _g(_n - 13);
+                //Falls through.
+            case 12:
+                _g(_n - 12);
+                //Falls through.
+            case 11:
+                _g(_n - 11);
+                //Falls through.
+            case 10:
+                _g(_n - 10);
+                //Falls through.
+            case 9:
+                _g(_n - 9);
+                //Falls through.
+            case 8:
+                _g(_n - 8);
+                //Falls through.
+            case 7:
+                _g(_n - 7);
+                //Falls through.
+            case 6:
+                _g(_n - 6);
+                //Falls through.
+            case 5:
+                _g(_n - 5);
+                //Falls through.
+            case 4:
+                _g(_n - 4);
+                //Falls through.
+            case 3:
+                _g(_n - 3);
+                //Falls through.
+            case 2:
+                _g(_n - 2);
+                //Falls through.
+            case 1:
+                _g(_n - 1);
+                //Falls through.
+            default:
+                break;
+        }
+    }
+
+    /**
+     * @brief Checks whether T is one of the byte types char, signed char, unsigned char and, from C++17, std::byte.
+     */
+    template <typename T>
+    struct is_byte : disjunction<std::is_same<T, char>, std::is_same<T, signed char>, std::is_same<T, unsigned char>
+#if defined(__cpp_lib_byte)
+                                 , std::is_same<T, std::byte>
+#endif
+                                 > {
+    };
+
+    /**
+     * @brief Checks whether an iterator_range<Iterator, Sentinel> refers to contiguous bytes and knows its size, so
+     *        that the byte algorithms can hand it to the C library or the SIMD kernels as a pointer and a length.
+     */
+    template <typename Iterator, typename Sentinel>
+    struct is_contiguous_byte_range : std::integral_constant<bool,
+            is_contiguous_iterator<Iterator>::value
+            && is_sized_sentinel_for<Sentinel, Iterator>::value
+            && is_byte<typename std::remove_cv<typename std::remove_reference<
+                typename std::iterator_traits<Iterator>::reference>::type>::type>::value> {
+    };
+
+    template <typename Iterator>
+    const std::uint8_t* byte_address(const Iterator& _it) {
+        return reinterpret_cast<const std::uint8_t*>(IteratorBasedForImpl::to_address(_it));
+    }
+
+    template <typename Iterator>
+    Iterator advanced(Iterator _it, std::size_t _n) {
+        return _it + static_cast<typename std::iterator_traits<Iterator>::difference_type>(_n);
+    }
+
+    /**
+     * @brief Customization point describing iterators over bits packed into words, such as those of
+     *        std::vector<bool>. A specialization declares is_bit_iterator as true, names the word type and provides
+     *        static functions returning the word an iterator points into and the bit offset within it. count(),
+     *        find() and for_each_set_bit() then process a whole word per step.
+     */
+    template <typename Iterator, typename = void>
+    struct bit_iterator_traits {
+        static constexpr bool is_bit_iterator = false;
+    };
+
+#if defined(__GLIBCXX__)
+    /**
+     * @brief Bits of a libstdc++ std::vector<bool>.
+     */
+    template <typename Iterator>
+    struct libstdcxx_bit_iterator_traits {
+        using word_type = std::_Bit_type;
+
+        static constexpr bool is_bit_iterator = true;
+
+        static const word_type* word(const Iterator& _it) { return _it._M_p; }
+        static std::size_t offset(const Iterator& _it) { return _it._M_offset; }
+    };
+
+    template <>
+    struct bit_iterator_traits<std::_Bit_iterator> : libstdcxx_bit_iterator_traits<std::_Bit_iterator> { };
+
+    template <>
+    struct bit_iterator_traits<std::_Bit_const_iterator> : libstdcxx_bit_iterator_traits<std::_Bit_const_iterator> {
+    };
+#endif
+
+    /**
+     * @brief Checks whether an iterator_range<Iterator, Sentinel> holds packed bits that can be processed a word at a
+     *        time.
+     */
+    template <typename Iterator, typename Sentinel>
+    struct is_bit_range : std::integral_constant<bool,
+            bit_iterator_traits<Iterator>::is_bit_iterator && std::is_same<Iterator, Sentinel>::value> {
+    };
+
+#if defined(__GNUC__) || defined(__clang__)
+    inline int count_ones(unsigned int _word) { return __builtin_popcount(_word); }
+    inline int count_ones(unsigned long _word) { return __builtin_popcountl(_word); }
+    inline int count_ones(unsigned long long _word) { return __builtin_popcountll(_word); }
+
+    inline int count_trailing_zeros(unsigned int _word) { return __builtin_ctz(_word); }
+    inline int count_trailing_zeros(unsigned long _word) { return __builtin_ctzl(_word); }
+    inline int count_trailing_zeros(unsigned long long _word) { return __builtin_ctzll(_word); }
+
+    inline int count_leading_zeros(unsigned long long _word) { return __builtin_clzll(_word); }
+#else
+    template <typename Word>
+    int count_ones(Word _word) {
+        int ones = 0;
+
+        for (; _word != 0; _word &= static_cast<Word>(_word - 1)) {
+            ++ones;
+        }
+
+        return ones;
+    }
+
+    template <typename Word>
+    int count_trailing_zeros(Word _word) {
+        int zeros = 0;
+
+        for (; !(_word & 1); _word >>= 1) {
+            ++zeros;
+        }
+
+        return zeros;
+    }
+
+    inline int count_leading_zeros(unsigned long long _word) {
+        int zeros = 0;
+
+        for (; !(_word >> (sizeof(_word) * CHAR_BIT - 1)); _word <<= 1) {
+            ++zeros;
+        }
+
+        return zeros;
+    }
+#endif
+
+    /**
+     * @brief Calls _f(_base, _word) for each word holding bits of the _n bits starting at bit _offset of _words, with
+     *        the bits outside the range cleared and, if _invert is set, the bits inside the range inverted. Bit i of
+     *        _word is the element with index _base + i of the range, so _base is negative by _offset for the first
+     *        word. Stops early once _f returns true.
+     */
+    template <typename Word, typename F>
+    void visit_bit_words(const Word* _words, std::size_t _offset, std::size_t _n, bool _invert, F _f) {
+        const std::size_t bits = sizeof(Word) * CHAR_BIT;
+        const std::size_t end = _offset + _n;
+        const Word all = static_cast<Word>(~Word(0));
+
+        for (std::size_t i = 0; i * bits < end; ++i) {
+            Word word = _invert ? static_cast<Word>(~_words[i]) : _words[i];
+
+            if (i == 0) {
+                word &= static_cast<Word>(all << _offset);
+            }
+
+            if ((i + 1) * bits > end) {
+                word &= static_cast<Word>(all >> ((i + 1) * bits - end));
+            }
+
+            if (_f(static_cast<std::ptrdiff_t>(i * bits) - static_cast<std::ptrdiff_t>(_offset), word)) {
+                return;
+            }
+        }
+    }
+
+    template <typename Iterator, typename T>
+    std::size_t count_bits(const iterator_range<Iterator>& _range, const T& _value) {
+        using traits = bit_iterator_traits<Iterator>;
+        const std::size_t n = static_cast<std::size_t>(_range.end() - _range.begin());
+        std::size_t result = 0;
+
+        if (n != 0) {
+            visit_bit_words(traits::word(_range.begin()), traits::offset(_range.begin()), n, !_value,
+                            [&result](std::ptrdiff_t, typename traits::word_type _word) {
+                result += static_cast<std::size_t>(count_ones(_word));
+                return false;
+            });
+        }
+
+        return result;
+    }
+
+    template <typename Iterator, typename T>
+    std::size_t find_bit(const iterator_range<Iterator>& _range, const T& _value) {
+        using traits = bit_iterator_traits<Iterator>;
+        const std::size_t n = static_cast<std::size_t>(_range.end() - _range.begin());
+        std::size_t index = n;
+
+        if (n != 0) {
+            visit_bit_words(traits::word(_range.begin()), traits::offset(_range.begin()), n, !_value,
+                            [&index](std::ptrdiff_t _base, typename traits::word_type _word) {
+                if (_word == 0) {
+                    return false;
+                }
+
+                index = static_cast<std::size_t>(_base + count_trailing_zeros(_word));
+                return true;
+            });
+        }
+
+        return index;
+    }
+
+    template <typename Iterator, typename Sentinel, typename F>
+    void for_each_set_bit_impl(const iterator_range<Iterator, Sentinel>& _range, F& _f, std::false_type) {
+        Sentinel end = _range.end();
+        std::size_t index = 0;
+
+        for (Iterator it = _range.begin(); it != end; ++it) {
+            if (*it) {
+                _f(index);
+            }
+
+            ++index;
+        }
+    }
+
+    template <typename Iterator, typename Sentinel, typename F>
+    void for_each_set_bit_impl(const iterator_range<Iterator, Sentinel>& _range, F& _f, std::true_type) {
+        using traits = bit_iterator_traits<Iterator>;
+        const std::size_t n = static_cast<std::size_t>(_range.end() - _range.begin());
+
+        if (n != 0) {
+            visit_bit_words(traits::word(_range.begin()), traits::offset(_range.begin()), n, false,
+                            [&_f](std::ptrdiff_t _base, typename traits::word_type _word) {
+                for (; _word != 0; _word &= static_cast<typename traits::word_type>(_word - 1)) {
+                    _f(static_cast<std::size_t>(_base + count_trailing_zeros(_word)));
+                }
+
+                return false;
+            });
+        }
+    }
+
+    /**
+     * @brief Calls _f(i) with the index i, counted from the beginning of _range, of every element of _range that is
+     *        true, in increasing order. Packed bit ranges such as those of std::vector<bool> are scanned a word at a
+     *        time, jumping from one set bit to the next.
+     */
+    template <typename Iterator, typename Sentinel, typename F>
+    void for_each_set_bit(const iterator_range<Iterator, Sentinel>& _range, F _f) {
+        for_each_set_bit_impl(_range, _f, std::integral_constant<bool, is_bit_range<Iterator, Sentinel>::value>());
+    }
+
+    template <typename Iterator, typename Sentinel, typename T>
+    Iterator find_impl(const iterator_range<Iterator, Sentinel>& _range, const T& _value, std::false_type) {
+        Iterator it = _range.begin();
+        Sentinel end = _range.end();
+
+        while (it != end && !(*it == _value)) {
+            ++it;
+        }
+
+        return it;
+    }
+
+    template <typename Iterator, typename Sentinel, typename T>
+    Iterator find_impl(const iterator_range<Iterator, Sentinel>& _range, const T& _value, std::true_type) {
+        const std::size_t n = _range.size();
+
+        if (n == 0) {
+            return _range.begin();
+        }
+
+        const void* match = std::memchr(byte_address(_range.begin()), static_cast<unsigned char>(_value), n);
+        return match ? advanced(_range.begin(), static_cast<std::size_t>(
+                               static_cast<const std::uint8_t*>(match) - byte_address(_range.begin())))
+                     : advanced(_range.begin(), n);
+    }
+
+    template <typename Iterator, typename Sentinel, typename T>
+    Iterator find_dispatch(const iterator_range<Iterator, Sentinel>& _range, const T& _value, std::false_type) {
+        return find_impl(_range, _value, std::integral_constant<bool,
+                         is_contiguous_byte_range<Iterator, Sentinel>::value
+                         && is_byte<typename std::remove_cv<T>::type>::value>());
+    }
+
+    template <typename Iterator, typename Sentinel, typename T>
+    Iterator find_dispatch(const iterator_range<Iterator, Sentinel>& _range, const T& _value, std::true_type) {
+        return advanced(_range.begin(), find_bit(_range, _value));
+    }
+
+    /**
+     * @brief Returns an iterator to the first element of _range equal to _value, or the position of the end of the
+     *        range if there is none. Contiguous byte ranges are searched with memchr and packed bit ranges a word at a
+     *        time.
+     */
+    template <typename Iterator, typename Sentinel, typename T>
+    Iterator find(const iterator_range<Iterator, Sentinel>& _range, const T& _value) {
+        return find_dispatch(_range, _value, std::integral_constant<bool,
+                             is_bit_range<Iterator, Sentinel>::value && std::is_same<T, bool>::value>());
+    }
+
+    template <typename Iterator, typename Sentinel, typename NeedleIterator, typename NeedleSentinel>
+    Iterator find_first_of_impl(const iterator_range<Iterator, Sentinel>& _range,
+                                const iterator_range<NeedleIterator, NeedleSentinel>& _needles, std::false_type) {
+        Iterator it = _range.begin();
+        Sentinel end = _range.end();
+
+        for (; it != end; ++it) {
+            for (NeedleIterator needle = _needles.begin(), last = _needles.end(); needle != last; ++needle) {
+                if (*it == *needle) {
+                    return it;
+                }
+            }
+        }
+
+        return it;
+    }
+
+    template <typename Iterator, typename Sentinel, typename NeedleIterator, typename NeedleSentinel>
+    Iterator find_first_of_impl(const iterator_range<Iterator, Sentinel>& _range,
+                                const iterator_range<NeedleIterator, NeedleSentinel>& _needles, std::true_type) {
+        const std::size_t needle_count = _needles.size();
+
+        if (classify_size(_range.size()) == size_class::tiny) {
+            return find_first_of_impl(_range, _needles, std::false_type());
+        }
+
+        if (needle_count == 1) {
+            return find(_range, *_needles.begin());
+        }
+
+        return advanced(_range.begin(), simd::find_any(byte_address(_range.begin()), _range.size(),
+                                                       byte_address(_needles.begin()), needle_count));
+    }
+
+    /**
+     * @brief Returns an iterator to the first element of _range equal to any element of _needles, or the position of
+     *        the end of the range if there is none. When both are contiguous byte ranges, the search compares whole
+     *        vectors of bytes against up to simd::find_any_vector_needles needles at once and uses a lookup table
+     *        for larger sets.
+     */
+    template <typename Iterator, typename Sentinel, typename NeedleIterator, typename NeedleSentinel>
+    Iterator find_first_of(const iterator_range<Iterator, Sentinel>& _range,
+                           const iterator_range<NeedleIterator, NeedleSentinel>& _needles) {
+        return find_first_of_impl(_range, _needles, std::integral_constant<bool,
+                                  is_contiguous_byte_range<Iterator, Sentinel>::value
+                                  && is_contiguous_byte_range<NeedleIterator, NeedleSentinel>::value>());
+    }
+
+    template <typename Iterator, typename Sentinel, typename T>
+    std::size_t count_impl(const iterator_range<Iterator, Sentinel>& _range, const T& _value, std::false_type) {
+        std::size_t result = 0;
+        Sentinel end = _range.end();
+
+        for (Iterator it = _range.begin(); it != end; ++it) {
+            result += *it == _value;
+        }
+
+        return result;
+    }
+
+    template <typename Iterator, typename Sentinel, typename T>
+    std::size_t count_impl(const iterator_range<Iterator, Sentinel>& _range, const T& _value, std::true_type) {
+        if (classify_size(_range.size()) == size_class::tiny) {
+            return count_impl(_range, _value, std::false_type());
+        }
+
+        const std::uint8_t* p = byte_address(_range.begin());
+        return simd::count(make_iterator_range(p, p + _range.size()), static_cast<std::uint8_t>(_value));
+    }
+
+    template <typename Iterator, typename Sentinel, typename T>
+    std::size_t count_dispatch(const iterator_range<Iterator, Sentinel>& _range, const T& _value, std::false_type) {
+        return count_impl(_range, _value, std::integral_constant<bool,
+                          is_contiguous_byte_range<Iterator, Sentinel>::value
+                          && is_byte<typename std::remove_cv<T>::type>::value>());
+    }
+
+    template <typename Iterator, typename Sentinel, typename T>
+    std::size_t count_dispatch(const iterator_range<Iterator, Sentinel>& _range, const T& _value, std::true_type) {
+        return count_bits(_range, _value);
+    }
+
+    /**
+     * @brief Returns the number of elements of _range equal to _value. Contiguous byte ranges are counted a vector of
+     *        bytes at a time and packed bit ranges with one population count per word.
+     */
+    template <typename Iterator, typename Sentinel, typename T>
+    std::size_t count(const iterator_range<Iterator, Sentinel>& _range, const T& _value) {
+        return count_dispatch(_range, _value, std::integral_constant<bool,
+                              is_bit_range<Iterator, Sentinel>::value && std::is_same<T, bool>::value>());
+    }
+
+    template <typename Iterator1, typename Sentinel1, typename Iterator2, typename Sentinel2>
+    bool equal_impl(const iterator_range<Iterator1, Sentinel1>& _lhs, const iterator_range<Iterator2, Sentinel2>& _rhs,
+                    std::false_type) {
+        Iterator1 lhs = _lhs.begin();
+        Sentinel1 lhs_end = _lhs.end();
+        Iterator2 rhs = _rhs.begin();
+        Sentinel2 rhs_end = _rhs.end();
+
+        //The increments are separate statements since the comma operator is overloaded for iterators.
+        for (; lhs != lhs_end && rhs != rhs_end; ++lhs) {
+            if (!(*lhs == *rhs)) {
+                return false;
+            }
+
+            ++rhs;
+        }
+
+        return !(lhs != lhs_end) && !(rhs != rhs_end);
+    }
+
+    template <typename Iterator1, typename Sentinel1, typename Iterator2, typename Sentinel2>
+    bool equal_impl(const iterator_range<Iterator1, Sentinel1>& _lhs, const iterator_range<Iterator2, Sentinel2>& _rhs,
+                    std::true_type) {
+        const std::size_t n = _lhs.size();
+        return n == _rhs.size() && (n == 0 || std::memcmp(byte_address(_lhs.begin()), byte_address(_rhs.begin()), n) == 0);
+    }
+
+    /**
+     * @brief Checks whether _lhs and _rhs have the same length and equal elements in the same order. Contiguous byte
+     *        ranges of the same byte type are compared with memcmp.
+     */
+    template <typename Iterator1, typename Sentinel1, typename Iterator2, typename Sentinel2>
+    bool equal(const iterator_range<Iterator1, Sentinel1>& _lhs, const iterator_range<Iterator2, Sentinel2>& _rhs) {
+        using lhs_type = typename std::remove_cv<typename std::remove_reference<
+            typename std::iterator_traits<Iterator1>::reference>::type>::type;
+        using rhs_type = typename std::remove_cv<typename std::remove_reference<
+            typename std::iterator_traits<Iterator2>::reference>::type>::type;
+
+        return equal_impl(_lhs, _rhs, std::integral_constant<bool,
+                          is_contiguous_byte_range<Iterator1, Sentinel1>::value
+                          && is_contiguous_byte_range<Iterator2, Sentinel2>::value
+                          && std::is_same<lhs_type, rhs_type>::value>());
+    }
+
+    /**
+     * @brief Returns the CRC-32C (Castagnoli) checksum of the contiguous bytes of _range, the one of iSCSI, ext4 and
+     *        many storage formats. Passing the checksum of the preceding bytes as _crc continues it, so that
+     *        crc32c(b, crc32c(a)) is the checksum of a followed by b:
+     *
+     *        std::uint32_t checksum = crc32c((record.cbegin(), record.cend()));
+     *
+     *        Uses the crc32 instructions of SSE4.2 or ARMv8 where available, checksumming long ranges as three
+     *        interleaved streams that are combined every 3 * simd::crc32c_stream_bytes bytes, and slice-by-8 tables
+     *        otherwise.
+     */
+    template <typename Iterator, typename Sentinel>
+    std::uint32_t crc32c(const iterator_range<Iterator, Sentinel>& _range, std::uint32_t _crc = 0) {
+        static_assert(is_contiguous_byte_range<Iterator, Sentinel>::value,
+                      "crc32c requires a contiguous range of bytes whose size is known in constant time");
+
+        return ~simd::crc32c_update(~_crc, byte_address(_range.begin()), _range.size());
+    }
+
+    constexpr std::uint64_t xxhash64_prime1 = 0x9E3779B185EBCA87u;
+    constexpr std::uint64_t xxhash64_prime2 = 0xC2B2AE3D27D4EB4Fu;
+    constexpr std::uint64_t xxhash64_prime3 = 0x165667B19E3779F9u;
+    constexpr std::uint64_t xxhash64_prime4 = 0x85EBCA77C2B2AE63u;
+    constexpr std::uint64_t xxhash64_prime5 = 0x27D4EB2F165667C5u;
+
+    inline std::uint64_t rotate_left(std::uint64_t _x, int _bits) { return (_x << _bits) | (_x >> (64 - _bits)); }
+
+    inline std::uint64_t load_little_endian64(const std::uint8_t* _data) {
+        std::uint64_t word;
+        std::memcpy(&word, _data, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return __builtin_bswap64(word);
+#else
+        return word;
+#endif
+    }
+
+    inline std::uint64_t xxhash64_round(std::uint64_t _accumulator, std::uint64_t _input) {
+        return rotate_left(_accumulator + _input * xxhash64_prime2, 31) * xxhash64_prime1;
+    }
+
+    inline std::uint64_t xxhash64_merge(std::uint64_t _hash, std::uint64_t _accumulator) {
+        return (_hash ^ xxhash64_round(0, _accumulator)) * xxhash64_prime1 + xxhash64_prime4;
+    }
+
+    inline std::uint64_t xxhash64_bytes(const std::uint8_t* _data, std::size_t _n, std::uint64_t _seed) {
+        const std::uint64_t length = _n;
+        std::uint64_t hash;
+
+        if (_n >= 32) {
+            std::uint64_t accumulators[4] = {_seed + xxhash64_prime1 + xxhash64_prime2, _seed + xxhash64_prime2,
+                                             _seed, _seed - xxhash64_prime1};
+
+            for (; _n >= 32; _n -= 32, _data += 32) {
+                for (std::size_t lane = 0; lane < 4; ++lane) {
+                    accumulators[lane] = xxhash64_round(accumulators[lane], load_little_endian64(_data + 8 * lane));
+                }
+            }
+
+            hash = rotate_left(accumulators[0], 1) + rotate_left(accumulators[1], 7)
+                   + rotate_left(accumulators[2], 12) + rotate_left(accumulators[3], 18);
+
+            for (std::uint64_t accumulator : accumulators) {
+                hash = xxhash64_merge(hash, accumulator);
+            }
+        } else {
+            hash = _seed + xxhash64_prime5;
+        }
+
+        hash += length;
+
+        for (; _n >= 8; _n -= 8, _data += 8) {
+            hash = rotate_left(hash ^ xxhash64_round(0, load_little_endian64(_data)), 27) * xxhash64_prime1
+                   + xxhash64_prime4;
+        }
+
+        if (_n >= 4) {
+            const std::uint64_t word = std::uint64_t(_data[0]) | std::uint64_t(_data[1]) << 8
+                                       | std::uint64_t(_data[2]) << 16 | std::uint64_t(_data[3]) << 24;
+
+            hash = rotate_left(hash ^ word * xxhash64_prime1, 23) * xxhash64_prime2 + xxhash64_prime3;
+            _n -= 4;
+            _data += 4;
+        }
+
+        for (; _n != 0; --_n, ++_data) {
+            hash = rotate_left(hash ^ *_data * xxhash64_prime5, 11) * xxhash64_prime1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= xxhash64_prime2;
+        hash ^= hash >> 29;
+        hash *= xxhash64_prime3;
+        return hash ^ (hash >> 32);
+    }
+
+    /**
+     * @brief Returns the 64-bit XXH64 hash of the contiguous bytes of _range with _seed, equal to the one of the
+     *        reference implementation. Its four accumulators consume 32 bytes per step independently of each other,
+     *        so the multiplications of every step overlap instead of waiting for the previous one.
+     */
+    template <typename Iterator, typename Sentinel>
+    std::uint64_t xxhash64(const iterator_range<Iterator, Sentinel>& _range, std::uint64_t _seed = 0) {
+        static_assert(is_contiguous_byte_range<Iterator, Sentinel>::value,
+                      "xxhash64 requires a contiguous range of bytes whose size is known in constant time");
+
+        return xxhash64_bytes(byte_address(_range.begin()), _range.size(), _seed);
+    }
+
+    /**
+     * @brief Checks whether the contiguous bytes of _range are valid UTF-8, rejecting stray continuation bytes,
+     *        overlong encodings, surrogates, code points above U+10FFFF and truncated sequences. With AVX2 and
+     *        AVX-512, every vector of 32 bytes is checked with the lookup tables of the simdjson validator, in about a
+     *        tenth of a cycle per byte. Other instruction sets skip vectors of ASCII and check the rest one sequence
+     *        at a time.
+     */
+    template <typename Iterator, typename Sentinel>
+    bool validate_utf8(const iterator_range<Iterator, Sentinel>& _range) {
+        static_assert(is_contiguous_byte_range<Iterator, Sentinel>::value,
+                      "validate_utf8 requires a contiguous range of bytes whose size is known in constant time");
+
+        return simd::validate_utf8(byte_address(_range.begin()), _range.size());
+    }
+
+    /**
+     * @brief Number of bytes utf8_to_utf16() transcodes at a time into a buffer for outputs that are not contiguous
+     *        ranges of char16_t.
+     */
+    constexpr std::size_t utf8_transcode_block = 4096;
+
+    inline void check_utf8(std::size_t _written) {
+        if (_written == simd::utf8_invalid) {
+            throw std::invalid_argument("utf8_to_utf16: the range is not valid UTF-8");
+        }
+    }
+
+    template <typename OutputIterator>
+    OutputIterator utf8_to_utf16_impl(const std::uint8_t* _p, std::size_t _n, OutputIterator _out, std::true_type) {
+        const std::size_t written = simd::utf8_to_utf16(_p, _n, IteratorBasedForImpl::to_address(_out));
+
+        check_utf8(written);
+        return _out + static_cast<typename std::iterator_traits<OutputIterator>::difference_type>(written);
+    }
+
+    template <typename OutputIterator>
+    OutputIterator utf8_to_utf16_impl(const std::uint8_t* _p, std::size_t _n, OutputIterator _out, std::false_type) {
+        char16_t buffer[utf8_transcode_block];
+
+        for (std::size_t i = 0; i < _n;) {
+            std::size_t end = std::min(_n, i + utf8_transcode_block);
+
+            //A sequence cut by the end of the block is transcoded with the next one.
+            for (int k = 0; k < 3 && end < _n && (_p[end] & 0xC0) == 0x80; ++k) {
+                --end;
+            }
+
+            const std::size_t written = simd::utf8_to_utf16(_p + i, end - i, buffer);
+
+            check_utf8(written);
+            _out = std::copy(buffer, buffer + written, _out);
+            i = end;
+        }
+
+        return _out;
+    }
+
+    /**
+     * @brief Writes the UTF-16 code units of the contiguous UTF-8 bytes of _range to _out and returns the end of the
+     *        output, pairs of surrogates for code points above U+FFFF. A contiguous output of char16_t must have room
+     *        for _range.size() code units, the most the range can take; it is written directly, other outputs
+     *        through a buffer:
+     *
+     *        std::u16string text(field.size(), u'\0');
+     *        text.erase(utf8_to_utf16((field.cbegin(), field.cend()), text.begin()), text.end());
+     *
+     *        Vectors of ASCII are widened a whole vector at a time and the others transcoded one sequence at a time.
+     *        Throws std::invalid_argument if the range is not valid UTF-8, leaving the output partly written.
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator>
+    OutputIterator utf8_to_utf16(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out) {
+        static_assert(is_contiguous_byte_range<Iterator, Sentinel>::value,
+                      "utf8_to_utf16 requires a contiguous range of bytes whose size is known in constant time");
+
+        using output_type = typename std::remove_reference<
+            typename std::iterator_traits<OutputIterator>::reference>::type;
+
+        return utf8_to_utf16_impl(byte_address(_range.begin()), _range.size(), _out, std::integral_constant<bool,
+                                  is_contiguous_iterator<OutputIterator>::value
+                                  && std::is_same<output_type, char16_t>::value>());
+    }
+
+    /**
+     * @brief Customization point describing iterators that walk a sequence of contiguous segments, such as the blocks
+     *        of a std::deque, and therefore check for the end of a segment on every increment. A specialization
+     *        declares is_segmented as true, names the pointer type of the segments as local_iterator and provides
+     *
+     *        template <typename F>
+     *        static void for_each_segment(Iterator _first, Iterator _last, F& _f);
+     *
+     *        which calls _f(begin, end) with the local_iterator bounds of each non-empty contiguous piece of
+     *        [_first, _last) in order. The algorithms below then run a tight loop over each piece instead of one loop
+     *        over the whole range.
+     */
+    template <typename Iterator, typename = void>
+    struct segmented_iterator_traits {
+        static constexpr bool is_segmented = false;
+    };
+
+#if defined(__GLIBCXX__)
+    /**
+     * @brief Segments of a libstdc++ std::deque, one per allocated block.
+     */
+    template <typename T, typename Reference, typename Pointer>
+    struct segmented_iterator_traits<std::_Deque_iterator<T, Reference, Pointer>> {
+        using iterator = std::_Deque_iterator<T, Reference, Pointer>;
+        using local_iterator = Pointer;
+
+        static constexpr bool is_segmented = true;
+
+        template <typename F>
+        static void for_each_segment(iterator _first, iterator _last, F& _f) {
+            if (_first._M_node == _last._M_node) {
+                if (_first._M_cur != _last._M_cur) {
+                    _f(local_iterator(_first._M_cur), local_iterator(_last._M_cur));
+                }
+
+                return;
+            }
+
+            _f(local_iterator(_first._M_cur), local_iterator(_first._M_last));
+
+            for (auto node = _first._M_node + 1; node != _last._M_node; ++node) {
+                _f(local_iterator(*node), local_iterator(*node + iterator::_S_buffer_size()));
+            }
+
+            if (_last._M_cur != _last._M_first) {
+                _f(local_iterator(_last._M_first), local_iterator(_last._M_cur));
+            }
+        }
+    };
+#endif
+
+    /**
+     * @brief Iterates over the elements of a circular buffer from a head position onwards, wrapping to the start of
+     *        the buffer after its last slot. Positions are counted from the head, so the end of a full buffer differs
+     *        from its beginning even though both refer to the same slot.
+     */
+    template <typename T>
+    class ring_iterator {
+    private:
+        T* m_data;
+        std::size_t m_capacity;
+        std::size_t m_head;
+        std::size_t m_index;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = typename std::remove_cv<T>::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        ring_iterator() : m_data(nullptr), m_capacity(0), m_head(0), m_index(0) { }
+
+        /**
+         * @brief Creates an iterator to the element _index positions after the slot _head of the buffer of
+         *        _capacity elements at _data. _head must be less than _capacity.
+         */
+        ring_iterator(T* _data, std::size_t _capacity, std::size_t _head, std::size_t _index) :
+                m_data(_data), m_capacity(_capacity), m_head(_head), m_index(_index) {
+        }
+
+        /**
+         * @brief Converts an iterator over non-const elements to one over const elements.
+         */
+        template <typename U, typename std::enable_if<std::is_convertible<U*, T*>::value
+                                                      && !std::is_same<U, T>::value, int>::type = 0>
+        ring_iterator(const ring_iterator<U>& _other) :
+                m_data(_other.data()), m_capacity(_other.capacity()), m_head(_other.head()), m_index(_other.index()) {
+        }
+
+        T* data() const { return m_data; }
+        std::size_t capacity() const { return m_capacity; }
+        std::size_t head() const { return m_head; }
+        std::size_t index() const { return m_index; }
+
+        /**
+         * @brief Returns the slot of the buffer this iterator refers to. Positions never exceed the capacity, so a
+         *        single conditional subtraction replaces the modulo.
+         */
+        std::size_t slot() const {
+            std::size_t slot = m_head + m_index;
+            return slot >= m_capacity ? slot - m_capacity : slot;
+        }
+
+        reference operator*() const { return m_data[slot()]; }
+        pointer operator->() const { return m_data + slot(); }
+        reference operator[](difference_type _n) const { return *(*this + _n); }
+
+        ring_iterator& operator++() { ++m_index; return *this; }
+        ring_iterator& operator--() { --m_index; return *this; }
+        ring_iterator operator++(int) { ring_iterator previous = *this; ++m_index; return previous; }
+        ring_iterator operator--(int) { ring_iterator previous = *this; --m_index; return previous; }
+
+        ring_iterator& operator+=(difference_type _n) { m_index += static_cast<std::size_t>(_n); return *this; }
+        ring_iterator& operator-=(difference_type _n) { m_index -= static_cast<std::size_t>(_n); return *this; }
+
+        friend ring_iterator operator+(ring_iterator _it, difference_type _n) { return _it += _n; }
+        friend ring_iterator operator+(difference_type _n, ring_iterator _it) { return _it += _n; }
+        friend ring_iterator operator-(ring_iterator _it, difference_type _n) { return _it -= _n; }
+
+        friend difference_type operator-(const ring_iterator& _lhs, const ring_iterator& _rhs) {
+            return static_cast<difference_type>(_lhs.m_index) - static_cast<difference_type>(_rhs.m_index);
+        }
+
+        friend bool operator==(const ring_iterator& _lhs, const ring_iterator& _rhs) {
+            return _lhs.m_index == _rhs.m_index;
+        }
+
+        friend bool operator!=(const ring_iterator& _lhs, const ring_iterator& _rhs) { return !(_lhs == _rhs); }
+        friend bool operator<(const ring_iterator& _lhs, const ring_iterator& _rhs) { return _lhs.m_index < _rhs.m_index; }
+        friend bool operator>(const ring_iterator& _lhs, const ring_iterator& _rhs) { return _rhs < _lhs; }
+        friend bool operator<=(const ring_iterator& _lhs, const ring_iterator& _rhs) { return !(_rhs < _lhs); }
+        friend bool operator>=(const ring_iterator& _lhs, const ring_iterator& _rhs) { return !(_lhs < _rhs); }
+    };
+
+    /**
+     * @brief Returns the elements of the ring range [_first, _last) as at most two contiguous spans: the part up to
+     *        the end of the buffer and the part wrapped around to its start, which is empty if the range does not
+     *        wrap.
+     */
+    template <typename T>
+    std::pair<span<T>, span<T>> ring_segments(const ring_iterator<T>& _first, const ring_iterator<T>& _last) {
+        const std::size_t n = static_cast<std::size_t>(_last - _first);
+
+        if (n == 0) {
+            return std::make_pair(span<T>(), span<T>());
+        }
+
+        const std::size_t slot = _first.slot();
+        const std::size_t head = std::min(n, _first.capacity() - slot);
+
+        return std::make_pair(span<T>(_first.data() + slot, head), span<T>(_first.data(), n - head));
+    }
+
+    template <typename T>
+    std::pair<span<T>, span<T>> ring_segments(const iterator_range<ring_iterator<T>>& _range) {
+        return ring_segments(_range.begin(), _range.end());
+    }
+
+    /**
+     * @brief Segments of a circular buffer: at most the two returned by ring_segments().
+     */
+    template <typename T>
+    struct segmented_iterator_traits<ring_iterator<T>> {
+        using local_iterator = T*;
+
+        static constexpr bool is_segmented = true;
+
+        template <typename F>
+        static void for_each_segment(ring_iterator<T> _first, ring_iterator<T> _last, F& _f) {
+            std::pair<span<T>, span<T>> segments = ring_segments(_first, _last);
+
+            if (!segments.first.empty()) {
+                _f(segments.first.begin(), segments.first.end());
+            }
+
+            if (!segments.second.empty()) {
+                _f(segments.second.begin(), segments.second.end());
+            }
+        }
+    };
+
+    /**
+     * @brief Returns a range over the _size elements of the circular buffer of _capacity elements at _data that
+     *        start at slot _head, wrapping around after the last slot:
+     *
+     *        for (const sample& s : ring_range(buffer, capacity, head, size)) { ... }
+     *
+     *        The algorithms of this header walk it as two contiguous loops without a wrap check per element.
+     */
+    template <typename T>
+    iterator_range<ring_iterator<T>> ring_range(T* _data, std::size_t _capacity, std::size_t _head,
+                                                std::size_t _size) {
+        return iterator_range<ring_iterator<T>>(ring_iterator<T>(_data, _capacity, _head, 0),
+                                                ring_iterator<T>(_data, _capacity, _head, _size));
+    }
+
+    /**
+     * @brief Checks whether an iterator_range<Iterator, Sentinel> can be walked segment by segment, which requires a
+     *        segmented Iterator and a Sentinel of the same type to mark where the last segment ends.
+     */
+    template <typename Iterator, typename Sentinel>
+    struct is_segmented_range : std::integral_constant<bool,
+            segmented_iterator_traits<Iterator>::is_segmented && std::is_same<Iterator, Sentinel>::value> {
+    };
+
+    template <typename Iterator, typename Sentinel, typename F>
+    void for_each_segment_impl(const iterator_range<Iterator, Sentinel>& _range, F& _f, std::true_type) {
+        segmented_iterator_traits<Iterator>::for_each_segment(_range.begin(), _range.end(), _f);
+    }
+
+    template <typename Iterator, typename Sentinel, typename F>
+    void for_each_segment_impl(const iterator_range<Iterator, Sentinel>& _range, F& _f, std::false_type) {
+        if (_range.begin() != _range.end()) {
+            _f(_range.begin(), _range.end());
+        }
+    }
+
+    /**
+     * @brief Calls _f(begin, end) for each non-empty contiguous segment of _range, in order, with the local_iterator
+     *        bounds of segmented_iterator_traits<Iterator>. A range that is not segmented is passed whole, with its
+     *        own iterator and sentinel, so _f is usually a generic lambda.
+     */
+    template <typename Iterator, typename Sentinel, typename F>
+    void for_each_segment(const iterator_range<Iterator, Sentinel>& _range, F _f) {
+        for_each_segment_impl(_range, _f, std::integral_constant<bool, is_segmented_range<Iterator, Sentinel>::value>());
+    }
+
+    /**
+     * @brief Segment traits of a range that is a single segment, used where the segments of a range that may or may
+     *        not be segmented are walked in nested loops.
+     */
+    template <typename Iterator>
+    struct identity_segment {
+        using local_iterator = Iterator;
+    };
+
+    /**
+     * @brief Iterates over several ranges of the same iterator type one after the other. Algorithms of this header
+     *        treat each range as a segment, so they run a separate tight loop, with the fast path of the underlying
+     *        iterators, over every range instead of checking which range they are in for each element. The ranges
+     *        are shared by all the iterators of a concatenation, which only hold their position, and are allocated
+     *        with a rebound copy of Allocator.
+     */
+    template <typename Iterator, typename Allocator = std::allocator<char>>
+    class concat_iterator {
+    private:
+        using segments_type = std::vector<iterator_range<Iterator>, typename std::allocator_traits<
+                Allocator>::template rebind_alloc<iterator_range<Iterator>>>;
+
+        friend struct segmented_iterator_traits<concat_iterator<Iterator, Allocator>>;
+
+        std::shared_ptr<const segments_type> m_segments;
+        std::size_t m_segment;
+        Iterator m_current;
+
+    public:
+        using iterator_category = typename std::conditional<std::is_base_of<std::forward_iterator_tag,
+                typename std::iterator_traits<Iterator>::iterator_category>::value,
+                std::forward_iterator_tag, std::input_iterator_tag>::type;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using pointer = typename std::iterator_traits<Iterator>::pointer;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+        /**
+         * @brief Points to _current in segment _segment of _segments, or past the end if _segment is the number of
+         *        segments. Every segment must be non-empty.
+         */
+        concat_iterator(std::shared_ptr<const segments_type> _segments, std::size_t _segment, Iterator _current) :
+                m_segments(std::move(_segments)), m_segment(_segment), m_current(std::move(_current)) {
+        }
+
+        concat_iterator(const concat_iterator&) = default;
+        concat_iterator& operator=(const concat_iterator&) = default;
+
+        reference operator*() const { return *m_current; }
+        pointer operator->() const { return std::addressof(*m_current); }
+
+        concat_iterator& operator++() {
+            const iterator_range<Iterator>& segment = (*m_segments)[m_segment];
+
+            if (!(++m_current != segment.end()) && ++m_segment < m_segments->size()) {
+                m_current = (*m_segments)[m_segment].begin();
+            }
+
+            return *this;
+        }
+
+        concat_iterator operator++(int) {
+            concat_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const concat_iterator& rhs) const {
+            return m_segment == rhs.m_segment && (m_segment == m_segments->size() || !(m_current != rhs.m_current));
+        }
+
+        bool operator!=(const concat_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief The segments of a concatenation are its ranges, each further split into its own segments when their
+     *        iterators are segmented themselves, as those of a std::deque.
+     */
+    template <typename Iterator, typename Allocator>
+    struct segmented_iterator_traits<concat_iterator<Iterator, Allocator>> {
+        using local_iterator = typename std::conditional<segmented_iterator_traits<Iterator>::is_segmented,
+                segmented_iterator_traits<Iterator>, identity_segment<Iterator>>::type::local_iterator;
+
+        static constexpr bool is_segmented = true;
+
+        template <typename F>
+        static void visit(const Iterator& _first, const Iterator& _last, F& _f) {
+            if (_first != _last) {
+                IteratorBasedForImpl::for_each_segment(make_iterator_range(_first, _last),
+                                                       [&_f](local_iterator _begin, local_iterator _end) {
+                                                           _f(_begin, _end);
+                                                       });
+            }
+        }
+
+        template <typename F>
+        static void for_each_segment(const concat_iterator<Iterator, Allocator>& _first,
+                                     const concat_iterator<Iterator, Allocator>& _last, F& _f) {
+            const auto& segments = *_first.m_segments;
+
+            if (_first.m_segment == _last.m_segment) {
+                if (_first.m_segment < segments.size()) {
+                    visit(_first.m_current, _last.m_current, _f);
+                }
+
+                return;
+            }
+
+            visit(_first.m_current, segments[_first.m_segment].end(), _f);
+
+            for (std::size_t i = _first.m_segment + 1; i < _last.m_segment; ++i) {
+                visit(segments[i].begin(), segments[i].end(), _f);
+            }
+
+            if (_last.m_segment < segments.size()) {
+                visit(segments[_last.m_segment].begin(), _last.m_current, _f);
+            }
+        }
+    };
+
+    template <typename Iterator, typename Container, typename Allocator = std::allocator<char>>
+    iterator_range<concat_iterator<Iterator, Allocator>> make_concat_range(Container _ranges,
+                                                                           const Allocator& _allocator = Allocator()) {
+        using iterator = concat_iterator<Iterator, Allocator>;
+        using segments_type = std::vector<iterator_range<Iterator>, typename std::allocator_traits<
+                Allocator>::template rebind_alloc<iterator_range<Iterator>>>;
+
+        auto segments = std::allocate_shared<segments_type>(_allocator, _allocator);
+        segments->reserve(_ranges.size());
+
+        for (const auto& range : _ranges) {
+            if (range.begin() != range.end()) {
+                segments->push_back(make_iterator_range(Iterator(range.begin()), Iterator(range.end())));
+            }
+        }
+
+        const std::size_t count = segments->size();
+        Iterator first = count ? segments->front().begin() : Iterator();
+
+        return iterator_range<iterator>(iterator(segments, 0, first), iterator(segments, count, Iterator()));
+    }
+
+    /**
+     * @brief Returns a range over the elements of _first followed by those of every range in _rest, all of the same
+     *        iterator type. Nothing is copied:
+     *
+     *        for (char c : concat((header.begin(), header.end()), (body.begin(), body.end()))) { ... }
+     *
+     *        for_each(), fill(), copy() and move() process each range with its own loop, so copying a concatenation
+     *        of contiguous fragments is one memcpy per fragment.
+     */
+    template <typename Iterator, typename... Ranges>
+    iterator_range<concat_iterator<Iterator>> concat(const iterator_range<Iterator>& _first, const Ranges&... _rest) {
+        return make_concat_range<Iterator>(std::initializer_list<iterator_range<Iterator>>{
+                _first, iterator_range<Iterator>(_rest.begin(), _rest.end())...});
+    }
+
+    /**
+     * @brief Returns a range over the elements of every range in the container _ranges, in order, for a number of
+     *        ranges only known at run time, such as the fragments of a message. The elements of _ranges need
+     *        begin() and end() members returning the same iterator type, as iterator_range and span do.
+     */
+    template <typename Container,
+              typename Iterator = decltype(std::declval<const Container&>().begin()->begin())>
+    iterator_range<concat_iterator<Iterator>> concat(const Container& _ranges) {
+        return make_concat_range<Iterator>(make_iterator_range(_ranges.begin(), _ranges.end()));
+    }
+
+    /**
+     * @brief Same as concat(_ranges), with the list of ranges allocated from _allocator, such as a
+     *        std::pmr::polymorphic_allocator over a request-scoped arena.
+     */
+    template <typename Allocator, typename Container,
+              typename Iterator = decltype(std::declval<const Container&>().begin()->begin())>
+    iterator_range<concat_iterator<Iterator, Allocator>> concat(std::allocator_arg_t, const Allocator& _allocator,
+                                                                const Container& _ranges) {
+        return make_concat_range<Iterator>(make_iterator_range(_ranges.begin(), _ranges.end()), _allocator);
+    }
+
+    /**
+     * @brief Iterator type of the ranges the elements of the outer range Iterator refer to.
+     */
+    template <typename Iterator>
+    using inner_iterator_t = decltype(std::begin(*std::declval<const Iterator&>()));
+
+    /**
+     * @brief Iterates over the elements of the ranges an outer range refers to, such as the inner vectors of a vector
+     *        of vectors, skipping empty ones. Algorithms of this header walk every inner range as a segment, with a
+     *        separate loop over its own iterators instead of stepping both levels for each element.
+     */
+    template <typename Iterator>
+    class join_iterator {
+    private:
+        using inner_iterator = inner_iterator_t<Iterator>;
+
+        friend struct segmented_iterator_traits<join_iterator<Iterator>>;
+
+        Iterator m_outer;
+        Iterator m_outer_end;
+        inner_iterator m_inner;
+        inner_iterator m_inner_end;
+
+        void skip_empty() {
+            for (; m_outer != m_outer_end; ++m_outer) {
+                m_inner = std::begin(*m_outer);
+                m_inner_end = std::end(*m_outer);
+
+                if (m_inner != m_inner_end) {
+                    return;
+                }
+            }
+        }
+
+    public:
+        using iterator_category = typename std::conditional<std::is_base_of<std::forward_iterator_tag,
+                typename std::iterator_traits<inner_iterator>::iterator_category>::value,
+                std::forward_iterator_tag, std::input_iterator_tag>::type;
+        using value_type = typename std::iterator_traits<inner_iterator>::value_type;
+        using difference_type = typename std::iterator_traits<inner_iterator>::difference_type;
+        using pointer = typename std::iterator_traits<inner_iterator>::pointer;
+        using reference = typename std::iterator_traits<inner_iterator>::reference;
+
+        static_assert(std::is_base_of<std::forward_iterator_tag,
+                              typename std::iterator_traits<Iterator>::iterator_category>::value,
+                      "join_iterator requires a multi-pass outer range");
+
+        /**
+         * @brief Points to the first element of the first non-empty range in [_outer, _outer_end).
+         */
+        join_iterator(Iterator _outer, Iterator _outer_end) :
+                m_outer(std::move(_outer)), m_outer_end(std::move(_outer_end)), m_inner(), m_inner_end() {
+            skip_empty();
+        }
+
+        reference operator*() const { return *m_inner; }
+        pointer operator->() const { return std::addressof(*m_inner); }
+
+        join_iterator& operator++() {
+            if (!(++m_inner != m_inner_end)) {
+                ++m_outer;
+                skip_empty();
+            }
+
+            return *this;
+        }
+
+        join_iterator operator++(int) {
+            join_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const join_iterator& rhs) const {
+            return !(m_outer != rhs.m_outer) && (!(m_outer != m_outer_end) || !(m_inner != rhs.m_inner));
+        }
+
+        bool operator!=(const join_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief The segments of a joined range are its inner ranges, each further split into its own segments when
+     *        their iterators are segmented themselves.
+     */
+    template <typename Iterator>
+    struct segmented_iterator_traits<join_iterator<Iterator>> {
+        using inner_iterator = inner_iterator_t<Iterator>;
+        using local_iterator = typename std::conditional<segmented_iterator_traits<inner_iterator>::is_segmented,
+                segmented_iterator_traits<inner_iterator>, identity_segment<inner_iterator>>::type::local_iterator;
+
+        static constexpr bool is_segmented = true;
+
+        template <typename F>
+        static void visit(const inner_iterator& _first, const inner_iterator& _last, F& _f) {
+            if (_first != _last) {
+                IteratorBasedForImpl::for_each_segment(make_iterator_range(_first, _last),
+                                                       [&_f](local_iterator _begin, local_iterator _end) {
+                                                           _f(_begin, _end);
+                                                       });
+            }
+        }
+
+        template <typename F>
+        static void for_each_segment(const join_iterator<Iterator>& _first, const join_iterator<Iterator>& _last,
+                                     F& _f) {
+            if (!(_first.m_outer != _last.m_outer)) {
+                if (_first.m_outer != _first.m_outer_end) {
+                    visit(_first.m_inner, _last.m_inner, _f);
+                }
+
+                return;
+            }
+
+            visit(_first.m_inner, _first.m_inner_end, _f);
+
+            Iterator outer = _first.m_outer;
+
+            for (++outer; outer != _last.m_outer; ++outer) {
+                visit(std::begin(*outer), std::end(*outer), _f);
+            }
+
+            if (_last.m_outer != _last.m_outer_end) {
+                visit(std::begin(*_last.m_outer), _last.m_inner, _f);
+            }
+        }
+    };
+
+    /**
+     * @brief Returns a range over the elements of the ranges the elements of _outer refer to, in order, as one flat
+     *        sequence:
+     *
+     *        std::vector<std::vector<float>> rows = ...;
+     *        float total = reduce(join((rows.begin(), rows.end())), 0.0f);
+     *
+     *        for_each(), reduce(), fill() and copy() run a separate loop over each inner range, so the loop over
+     *        contiguous inner ranges stays vectorizable. The outer range must be multi-pass and end with an
+     *        iterator.
+     */
+    template <typename Iterator>
+    iterator_range<join_iterator<Iterator>> join(const iterator_range<Iterator>& _outer) {
+        return iterator_range<join_iterator<Iterator>>(join_iterator<Iterator>(_outer.begin(), _outer.end()),
+                                                       join_iterator<Iterator>(_outer.end(), _outer.end()));
+    }
+
+    /**
+     * @brief Random access iterator over every stride-th element of a random access range. It keeps the iterator to
+     *        the first element and the index of the current one, so the end of a strided range is never stepped to
+     *        or past, even when the size of the range is not a multiple of the stride.
+     */
+    template <typename Iterator>
+    class strided_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using pointer = typename std::iterator_traits<Iterator>::pointer;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+    private:
+        Iterator m_first;
+        difference_type m_index;
+        difference_type m_stride;
+
+    public:
+        strided_iterator() : m_first(), m_index(0), m_stride(1) { }
+
+        /**
+         * @brief Points to the element _index * _stride elements after _first.
+         */
+        strided_iterator(Iterator _first, difference_type _index, difference_type _stride) :
+                m_first(std::move(_first)), m_index(_index), m_stride(_stride) {
+        }
+
+        /**
+         * @brief Returns the iterator to the first element of the underlying range.
+         */
+        const Iterator& first() const { return m_first; }
+
+        /**
+         * @brief Returns the number of strides from the first element of the underlying range to the current one.
+         */
+        difference_type index() const { return m_index; }
+
+        /**
+         * @brief Returns the number of elements of the underlying range between two elements of the strided one.
+         */
+        difference_type stride() const { return m_stride; }
+
+        reference operator*() const { return m_first[m_index * m_stride]; }
+        pointer operator->() const { return std::addressof(**this); }
+        reference operator[](difference_type _n) const { return m_first[(m_index + _n) * m_stride]; }
+
+        strided_iterator& operator++() { ++m_index; return *this; }
+        strided_iterator& operator--() { --m_index; return *this; }
+
+        strided_iterator operator++(int) {
+            strided_iterator previous = *this;
+            ++m_index;
+            return previous;
+        }
+
+        strided_iterator operator--(int) {
+            strided_iterator previous = *this;
+            --m_index;
+            return previous;
+        }
+
+        strided_iterator& operator+=(difference_type _n) { m_index += _n; return *this; }
+        strided_iterator& operator-=(difference_type _n) { m_index -= _n; return *this; }
+
+        friend strided_iterator operator+(strided_iterator _it, difference_type _n) { return _it += _n; }
+        friend strided_iterator operator+(difference_type _n, strided_iterator _it) { return _it += _n; }
+        friend strided_iterator operator-(strided_iterator _it, difference_type _n) { return _it -= _n; }
+
+        friend difference_type operator-(const strided_iterator& _lhs, const strided_iterator& _rhs) {
+            return _lhs.m_index - _rhs.m_index;
+        }
+
+        friend bool operator==(const strided_iterator& _lhs, const strided_iterator& _rhs) {
+            return _lhs.m_index == _rhs.m_index;
+        }
+
+        friend bool operator!=(const strided_iterator& _lhs, const strided_iterator& _rhs) {
+            return _lhs.m_index != _rhs.m_index;
+        }
+
+        friend bool operator<(const strided_iterator& _lhs, const strided_iterator& _rhs) {
+            return _lhs.m_index < _rhs.m_index;
+        }
+
+        friend bool operator>(const strided_iterator& _lhs, const strided_iterator& _rhs) { return _rhs < _lhs; }
+        friend bool operator<=(const strided_iterator& _lhs, const strided_iterator& _rhs) { return !(_rhs < _lhs); }
+        friend bool operator>=(const strided_iterator& _lhs, const strided_iterator& _rhs) { return !(_lhs < _rhs); }
+    };
+
+    /**
+     * @brief Returns a random access range over every _stride-th element of the random access range _range,
+     *        starting with its first element, such as one channel of interleaved samples:
+     *
+     *        std::vector<float> iq = ...;
+     *        std::vector<float> in_phase(iq.size() / 2);
+     *        copy(strided((iq.cbegin(), iq.cend()), 2), in_phase.begin());
+     *
+     *        Unlike stride(), the range knows its size and can be indexed and split. copy() and move() of a strided
+     *        range of float, double, int32_t or uint8_t elements of a contiguous range to a contiguous output run
+     *        simd::deinterleave(). A _stride of zero is treated as one.
+     */
+    template <typename Iterator, typename Sentinel>
+    iterator_range<strided_iterator<Iterator>> strided(const iterator_range<Iterator, Sentinel>& _range,
+                                                       std::size_t _stride) {
+        static_assert(std::is_base_of<std::random_access_iterator_tag,
+                              typename std::iterator_traits<Iterator>::iterator_category>::value
+                      && is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "strided requires a random access range that knows its size");
+
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        const difference_type stride = static_cast<difference_type>(_stride ? _stride : 1);
+        const difference_type count = (static_cast<difference_type>(_range.size()) + stride - 1) / stride;
+
+        return iterator_range<strided_iterator<Iterator>>(strided_iterator<Iterator>(_range.begin(), 0, stride),
+                                                          strided_iterator<Iterator>(_range.begin(), count, stride));
+    }
+
+    /**
+     * @brief Bidirectional or random access iterator walking a range backwards. Like std::reverse_iterator it holds
+     *        the position one past the element it refers to, which base() returns, so the end of a reversed range is
+     *        the beginning of the underlying one and is never stepped past.
+     */
+    template <typename Iterator>
+    class reversed_iterator {
+    public:
+        using iterator_category = typename std::conditional<std::is_base_of<std::random_access_iterator_tag,
+                typename std::iterator_traits<Iterator>::iterator_category>::value,
+                std::random_access_iterator_tag, std::bidirectional_iterator_tag>::type;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using pointer = typename std::iterator_traits<Iterator>::pointer;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+    private:
+        Iterator m_base;
+
+    public:
+        reversed_iterator() : m_base() { }
+
+        /**
+         * @brief Refers to the element before _base.
+         */
+        explicit reversed_iterator(Iterator _base) : m_base(std::move(_base)) { }
+
+        /**
+         * @brief Returns the iterator one past the current element in the underlying range.
+         */
+        const Iterator& base() const { return m_base; }
+
+        reference operator*() const {
+            Iterator it = m_base;
+            return *--it;
+        }
+
+        pointer operator->() const { return std::addressof(**this); }
+        reference operator[](difference_type _n) const { return *(*this + _n); }
+
+        reversed_iterator& operator++() { --m_base; return *this; }
+        reversed_iterator& operator--() { ++m_base; return *this; }
+
+        reversed_iterator operator++(int) {
+            reversed_iterator previous = *this;
+            --m_base;
+            return previous;
+        }
+
+        reversed_iterator operator--(int) {
+            reversed_iterator previous = *this;
+            ++m_base;
+            return previous;
+        }
+
+        reversed_iterator& operator+=(difference_type _n) { m_base -= _n; return *this; }
+        reversed_iterator& operator-=(difference_type _n) { m_base += _n; return *this; }
+
+        friend reversed_iterator operator+(reversed_iterator _it, difference_type _n) { return _it += _n; }
+        friend reversed_iterator operator+(difference_type _n, reversed_iterator _it) { return _it += _n; }
+        friend reversed_iterator operator-(reversed_iterator _it, difference_type _n) { return _it -= _n; }
+
+        friend difference_type operator-(const reversed_iterator& _lhs, const reversed_iterator& _rhs) {
+            return _rhs.m_base - _lhs.m_base;
+        }
+
+        friend bool operator==(const reversed_iterator& _lhs, const reversed_iterator& _rhs) {
+            return _lhs.m_base == _rhs.m_base;
+        }
+
+        friend bool operator!=(const reversed_iterator& _lhs, const reversed_iterator& _rhs) {
+            return !(_lhs.m_base == _rhs.m_base);
+        }
+
+        friend bool operator<(const reversed_iterator& _lhs, const reversed_iterator& _rhs) {
+            return _rhs.m_base < _lhs.m_base;
+        }
+
+        friend bool operator>(const reversed_iterator& _lhs, const reversed_iterator& _rhs) { return _rhs < _lhs; }
+        friend bool operator<=(const reversed_iterator& _lhs, const reversed_iterator& _rhs) { return !(_rhs < _lhs); }
+        friend bool operator>=(const reversed_iterator& _lhs, const reversed_iterator& _rhs) { return !(_lhs < _rhs); }
+    };
+
+    /**
+     * @brief The iterator a reversed range over Iterator walks backwards: a pointer for contiguous iterators, so the
+     *        backward loops decrement a pointer, and Iterator itself otherwise.
+     */
+    template <typename Iterator>
+    using reversed_base_t = typename std::conditional<is_contiguous_iterator<Iterator>::value,
+            simd::element_t<Iterator>*, Iterator>::type;
+
+    template <typename Iterator>
+    Iterator reversed_base(Iterator _it, std::false_type) {
+        return _it;
+    }
+
+    template <typename Iterator>
+    simd::element_t<Iterator>* reversed_base(const Iterator& _it, std::true_type) {
+        return IteratorBasedForImpl::to_address(_it);
+    }
+
+    template <typename Iterator, typename Sentinel>
+    Iterator reversed_end(const iterator_range<Iterator, Sentinel>& _range, std::true_type) {
+        return _range.end();
+    }
+
+    template <typename Iterator, typename Sentinel>
+    Iterator reversed_end(const iterator_range<Iterator, Sentinel>& _range, std::false_type) {
+        return advanced(_range.begin(), _range.size());
+    }
+
+    /**
+     * @brief Returns a range over the elements of the bidirectional range _range from the last to the first:
+     *
+     *        std::vector<int> v = ...;
+     *        int suffix = 0;
+     *        for_each(reversed((v.begin(), v.end())), [&suffix](int& _x) { _x = suffix += _x; });
+     *
+     *        Contiguous ranges are reversed as pointers. for_each(), reduce(), find() and copy() of a reversed range
+     *        run their own backward loop, decrementing the underlying iterator once per element rather than once to
+     *        step and once more to dereference; find() of contiguous bytes uses memrchr where the C library has it.
+     *        Reversing a reversed range returns the underlying range. _range must end with an iterator or know its
+     *        size.
+     */
+    template <typename Iterator, typename Sentinel>
+    iterator_range<reversed_iterator<reversed_base_t<Iterator>>> reversed(
+            const iterator_range<Iterator, Sentinel>& _range) {
+        static_assert(std::is_base_of<std::bidirectional_iterator_tag,
+                              typename std::iterator_traits<Iterator>::iterator_category>::value
+                      && (std::is_same<Iterator, Sentinel>::value || is_sized_sentinel_for<Sentinel, Iterator>::value),
+                      "reversed requires a bidirectional range that ends with an iterator or knows its size");
+
+        using base_iterator = reversed_base_t<Iterator>;
+        using contiguous = std::integral_constant<bool, is_contiguous_iterator<Iterator>::value>;
+        const Iterator last = reversed_end(_range, std::is_same<Iterator, Sentinel>());
+
+        return iterator_range<reversed_iterator<base_iterator>>(
+                reversed_iterator<base_iterator>(reversed_base(last, contiguous())),
+                reversed_iterator<base_iterator>(reversed_base(_range.begin(), contiguous())));
+    }
+
+    template <typename Iterator>
+    iterator_range<Iterator> reversed(const iterator_range<reversed_iterator<Iterator>>& _range) {
+        return iterator_range<Iterator>(_range.end().base(), _range.begin().base());
+    }
+
+    /**
+     * @brief Calls _f with every element of the reversed range _range, from the last element of the underlying range
+     *        to the first, and returns _f.
+     */
+    template <typename Iterator, typename F>
+    F for_each(const iterator_range<reversed_iterator<Iterator>>& _range, F _f) {
+        const Iterator first = _range.end().base();
+
+        for (Iterator it = _range.begin().base(); it != first;) {
+            --it;
+            _f(*it);
+        }
+
+        return _f;
+    }
+
+    /**
+     * @brief Returns _init combined with every element of the reversed range _range, from the last element of the
+     *        underlying range to the first, using _op.
+     */
+    template <typename Iterator, typename T, typename BinaryOp = std::plus<>>
+    T reduce(const iterator_range<reversed_iterator<Iterator>>& _range, T _init, BinaryOp _op = BinaryOp()) {
+        const Iterator first = _range.end().base();
+
+        for (Iterator it = _range.begin().base(); it != first;) {
+            --it;
+            _init = _op(std::move(_init), *it);
+        }
+
+        return _init;
+    }
+
+    template <typename Iterator, typename T>
+    Iterator find_last_impl(Iterator _first, Iterator _last, const T& _value, std::false_type) {
+        while (_last != _first) {
+            --_last;
+
+            if (*_last == _value) {
+                return ++_last;
+            }
+        }
+
+        return _first;
+    }
+
+    template <typename Iterator, typename T>
+    Iterator find_last_impl(Iterator _first, Iterator _last, const T& _value, std::true_type) {
+#if defined(__GLIBC__) && defined(_GNU_SOURCE)
+        const std::size_t n = static_cast<std::size_t>(_last - _first);
+        const void* match = n ? ::memrchr(_first, static_cast<unsigned char>(_value), n) : nullptr;
+
+        return match ? _first + (static_cast<const std::uint8_t*>(match) - byte_address(_first)) + 1 : _first;
+#else
+        return find_last_impl(_first, _last, _value, std::false_type());
+#endif
+    }
+
+    /**
+     * @brief Returns an iterator to the first element of the reversed range _range equal to _value, that is the last
+     *        such element of the underlying range, or the end of _range if there is none. Contiguous byte ranges are
+     *        searched with memrchr where the C library has it.
+     */
+    template <typename Iterator, typename T>
+    reversed_iterator<Iterator> find(const iterator_range<reversed_iterator<Iterator>>& _range, const T& _value) {
+        return reversed_iterator<Iterator>(find_last_impl(_range.end().base(), _range.begin().base(), _value,
+                std::integral_constant<bool, std::is_pointer<Iterator>::value
+                                             && is_byte<typename std::remove_cv<simd::element_t<Iterator>>::type>::value
+                                             && is_byte<typename std::remove_cv<T>::type>::value>()));
+    }
+
+    /**
+     * @brief Byte order of the values decode_le() and decode_be() read.
+     */
+    enum class byte_order { little, big };
+
+    /**
+     * @brief Returns the byte order of the processor compiled for.
+     */
+    inline constexpr byte_order native_byte_order() {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return byte_order::big;
+#else
+        return byte_order::little;
+#endif
+    }
+
+    /**
+     * @brief Reads the value of type T stored in byte order Order at _p, which need not be aligned.
+     */
+    template <typename T, byte_order Order>
+    T decode_value(const std::uint8_t* _p) {
+        std::uint8_t bytes[sizeof(T)];
+        std::memcpy(bytes, _p, sizeof(T));
+
+        if (Order != native_byte_order()) {
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        return value;
+    }
+
+    /**
+     * @brief Decodes the _n values of type T stored in byte order Order at _p into _out, swapping their bytes with
+     *        the SIMD kernels a whole vector at a time or copying them if Order is the native one.
+     */
+    template <typename T, byte_order Order>
+    void decode_values(const std::uint8_t* _p, std::size_t _n, T* _out) {
+        if (Order == native_byte_order() || sizeof(T) == 1) {
+            std::memmove(_out, _p, _n * sizeof(T));
+        } else {
+            simd::byteswap(_p, sizeof(T), _n, reinterpret_cast<std::uint8_t*>(_out));
+        }
+    }
+
+    /**
+     * @brief Random access iterator reading values of the arithmetic type T stored in byte order Order, at any
+     *        alignment, from a contiguous range of bytes. Dereferencing returns the value decoded.
+     */
+    template <typename T, byte_order Order>
+    class decoded_iterator {
+        static_assert(std::is_arithmetic<T>::value, "decoded_iterator requires an arithmetic value type");
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = T;
+
+    private:
+        const std::uint8_t* m_p;
+
+    public:
+        decoded_iterator() : m_p(nullptr) { }
+
+        /**
+         * @brief Refers to the value whose first byte is at _p.
+         */
+        explicit decoded_iterator(const std::uint8_t* _p) : m_p(_p) { }
+
+        /**
+         * @brief Returns the address of the first byte of the current value.
+         */
+        const std::uint8_t* base() const { return m_p; }
+
+        T operator*() const { return decode_value<T, Order>(m_p); }
+        T operator[](difference_type _n) const { return *(*this + _n); }
+
+        decoded_iterator& operator++() { m_p += sizeof(T); return *this; }
+        decoded_iterator& operator--() { m_p -= sizeof(T); return *this; }
+
+        decoded_iterator operator++(int) {
+            decoded_iterator previous = *this;
+            m_p += sizeof(T);
+            return previous;
+        }
+
+        decoded_iterator operator--(int) {
+            decoded_iterator previous = *this;
+            m_p -= sizeof(T);
+            return previous;
+        }
+
+        decoded_iterator& operator+=(difference_type _n) { m_p += _n * difference_type(sizeof(T)); return *this; }
+        decoded_iterator& operator-=(difference_type _n) { m_p -= _n * difference_type(sizeof(T)); return *this; }
+
+        friend decoded_iterator operator+(decoded_iterator _it, difference_type _n) { return _it += _n; }
+        friend decoded_iterator operator+(difference_type _n, decoded_iterator _it) { return _it += _n; }
+        friend decoded_iterator operator-(decoded_iterator _it, difference_type _n) { return _it -= _n; }
+
+        friend difference_type operator-(const decoded_iterator& _lhs, const decoded_iterator& _rhs) {
+            return (_lhs.m_p - _rhs.m_p) / difference_type(sizeof(T));
+        }
+
+        friend bool operator==(const decoded_iterator& _lhs, const decoded_iterator& _rhs) {
+            return _lhs.m_p == _rhs.m_p;
+        }
+
+        friend bool operator!=(const decoded_iterator& _lhs, const decoded_iterator& _rhs) {
+            return _lhs.m_p != _rhs.m_p;
+        }
+
+        friend bool operator<(const decoded_iterator& _lhs, const decoded_iterator& _rhs) {
+            return _lhs.m_p < _rhs.m_p;
+        }
+
+        friend bool operator>(const decoded_iterator& _lhs, const decoded_iterator& _rhs) { return _rhs < _lhs; }
+        friend bool operator<=(const decoded_iterator& _lhs, const decoded_iterator& _rhs) { return !(_rhs < _lhs); }
+        friend bool operator>=(const decoded_iterator& _lhs, const decoded_iterator& _rhs) { return !(_lhs < _rhs); }
+    };
+
+    /**
+     * @brief Number of values the algorithms over decoded ranges decode at a time into a buffer on the stack.
+     */
+    constexpr std::size_t decode_block = 256;
+
+    /**
+     * @brief Calls _f(first, last) with the bounds of buffers holding the values of the decoded range _range in
+     *        order, decode_block values at a time.
+     */
+    template <typename T, byte_order Order, typename F>
+    void for_each_decoded_block(const iterator_range<decoded_iterator<T, Order>>& _range, F _f) {
+        T buffer[decode_block];
+        const std::uint8_t* p = _range.begin().base();
+        const std::size_t n = _range.size();
+
+        for (std::size_t i = 0; i < n; i += decode_block) {
+            const std::size_t count = std::min(decode_block, n - i);
+
+            decode_values<T, Order>(p + i * sizeof(T), count, buffer);
+            _f(static_cast<const T*>(buffer), static_cast<const T*>(buffer + count));
+        }
+    }
+
+    template <typename T, byte_order Order, typename Iterator, typename Sentinel>
+    iterator_range<decoded_iterator<T, Order>> decode(const iterator_range<Iterator, Sentinel>& _range) {
+        static_assert(is_contiguous_byte_range<Iterator, Sentinel>::value,
+                      "decode_le and decode_be require a contiguous range of bytes whose size is known in constant "
+                      "time");
+
+        const std::uint8_t* first = byte_address(_range.begin());
+        return iterator_range<decoded_iterator<T, Order>>(decoded_iterator<T, Order>(first),
+                decoded_iterator<T, Order>(first + _range.size() / sizeof(T) * sizeof(T)));
+    }
+
+    /**
+     * @brief Returns a range over the values of the arithmetic type T stored little-endian in the contiguous range of
+     *        bytes _range, such as a mapped_file_range<char> of records in a binary format. Bytes after the last
+     *        whole value are not part of the range:
+     *
+     *        mapped_file_range<char> file("samples.bin");
+     *        double total = reduce(decode_le<float>((file.begin(), file.end())), 0.0);
+     *
+     *        Dereferencing an iterator of the range decodes a single value; for_each(), reduce() and copy() of the
+     *        range decode decode_block values at a time with the byteswap() kernel instead, which swaps the bytes of
+     *        whole vectors on processors of the other byte order and is a copy on those of the same.
+     */
+    template <typename T, typename Iterator, typename Sentinel>
+    iterator_range<decoded_iterator<T, byte_order::little>> decode_le(
+            const iterator_range<Iterator, Sentinel>& _range) {
+        return decode<T, byte_order::little>(_range);
+    }
+
+    /**
+     * @brief Returns a range over the values of the arithmetic type T stored big-endian, the byte order of network
+     *        formats, in the contiguous range of bytes _range. Otherwise the same as decode_le().
+     */
+    template <typename T, typename Iterator, typename Sentinel>
+    iterator_range<decoded_iterator<T, byte_order::big>> decode_be(const iterator_range<Iterator, Sentinel>& _range) {
+        return decode<T, byte_order::big>(_range);
+    }
+
+    /**
+     * @brief Calls _f with every value of the decoded range _range, decoded a block at a time, and returns _f.
+     */
+    template <typename T, byte_order Order, typename F>
+    F for_each(const iterator_range<decoded_iterator<T, Order>>& _range, F _f) {
+        for_each_decoded_block(_range, [&_f](const T* _first, const T* _last) {
+            for (; _first != _last; ++_first) {
+                _f(*_first);
+            }
+        });
+
+        return _f;
+    }
+
+    /**
+     * @brief Returns _init combined with every value of the decoded range _range, in order, using _op.
+     */
+    template <typename T, byte_order Order, typename U, typename BinaryOp = std::plus<>>
+    U reduce(const iterator_range<decoded_iterator<T, Order>>& _range, U _init, BinaryOp _op = BinaryOp()) {
+        for_each_decoded_block(_range, [&_init, &_op](const T* _first, const T* _last) {
+            for (; _first != _last; ++_first) {
+                _init = _op(std::move(_init), *_first);
+            }
+        });
+
+        return _init;
+    }
+
+    /**
+     * @brief Iterator over every combination of one element of each of several ranges, the last range varying
+     *        fastest. Dereferencing yields a std::tuple of the references of the current elements. Incrementing
+     *        advances the last iterator and carries into the one before at the end of its range, as an odometer does;
+     *        for_each() of a product runs nested loops instead, whose innermost loop has no carry to check.
+     */
+    template <typename... Ranges>
+    class cartesian_product_iterator {
+    public:
+        using ranges_type = std::tuple<Ranges...>;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::tuple<typename std::iterator_traits<typename Ranges::iterator>::value_type...>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::tuple<typename std::iterator_traits<typename Ranges::iterator>::reference...>;
+
+    private:
+        using indices = std::index_sequence_for<Ranges...>;
+
+        ranges_type m_ranges;
+        std::tuple<typename Ranges::iterator...> m_current;
+        //Set for the end iterator and when one of the ranges is empty, and so is the product.
+        bool m_end;
+
+        template <std::size_t... I>
+        static std::tuple<typename Ranges::iterator...> begins(const ranges_type& _ranges, std::index_sequence<I...>) {
+            return std::tuple<typename Ranges::iterator...>(std::get<I>(_ranges).begin()...);
+        }
+
+        template <std::size_t... I>
+        static bool any_empty(const ranges_type& _ranges, std::index_sequence<I...>) {
+            bool empty = false;
+            (void)std::initializer_list<int>{((void)(empty = empty || std::get<I>(_ranges).empty()), 0)...};
+            return empty;
+        }
+
+        template <std::size_t... I>
+        reference dereference(std::index_sequence<I...>) const { return reference(*std::get<I>(m_current)...); }
+
+        void increment(std::integral_constant<std::size_t, 0>) { ++std::get<0>(m_current); }
+
+        template <std::size_t I>
+        void increment(std::integral_constant<std::size_t, I>) {
+            if (++std::get<I>(m_current) != std::get<I>(m_ranges).end()) {
+                return;
+            }
+
+            std::get<I>(m_current) = std::get<I>(m_ranges).begin();
+            increment(std::integral_constant<std::size_t, I - 1>());
+        }
+
+        bool at_end() const { return m_end || !(std::get<0>(m_current) != std::get<0>(m_ranges).end()); }
+
+    public:
+        /**
+         * @brief Creates the first iterator of the product of _ranges, or the end iterator if _end is true.
+         */
+        cartesian_product_iterator(ranges_type _ranges, bool _end) :
+                m_ranges(std::move(_ranges)),
+                m_current(begins(m_ranges, indices())),
+                m_end(_end || any_empty(m_ranges, indices())) {
+        }
+
+        const ranges_type& ranges() const { return m_ranges; }
+
+        reference operator*() const { return dereference(indices()); }
+
+        cartesian_product_iterator& operator++() {
+            increment(std::integral_constant<std::size_t, sizeof...(Ranges) - 1>());
+            return *this;
+        }
+
+        cartesian_product_iterator operator++(int) {
+            cartesian_product_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const cartesian_product_iterator& rhs) const {
+            return at_end() ? rhs.at_end() : !rhs.at_end() && m_current == rhs.m_current;
+        }
+
+        bool operator!=(const cartesian_product_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief Returns a range over every combination of one element of each of _ranges, the last range varying
+     *        fastest as in nested loops over the ranges in order, whose elements are tuples of references:
+     *
+     *        for_each(cartesian_product((points.begin(), points.end()), (points.begin(), points.end())),
+     *                 [&](std::tuple<const point&, const point&> _pair) {
+     *            nearest = std::min(nearest, distance(std::get<0>(_pair), std::get<1>(_pair)));
+     *        });
+     *
+     *        for_each() of a product runs one native loop per range, so the innermost loop only increments and
+     *        compares a single iterator, as a hand-written nest of loops would; with a parallel policy it splits the
+     *        first range across the threads. A range-based for loop over the product steps an odometer iterator,
+     *        which checks every position for a carry. Only the first range may be single-pass.
+     */
+    template <typename Iterator, typename Sentinel, typename... Iterators, typename... Sentinels>
+    iterator_range<cartesian_product_iterator<iterator_range<Iterator, Sentinel>,
+                                              iterator_range<Iterators, Sentinels>...>>
+    cartesian_product(const iterator_range<Iterator, Sentinel>& _first,
+                      const iterator_range<Iterators, Sentinels>&... _rest) {
+        static_assert(conjunction<std::is_base_of<std::forward_iterator_tag,
+                              typename std::iterator_traits<Iterators>::iterator_category>...>::value,
+                      "cartesian_product requires every range but the first to be multi-pass");
+
+        using iterator = cartesian_product_iterator<iterator_range<Iterator, Sentinel>,
+                                                    iterator_range<Iterators, Sentinels>...>;
+
+        typename iterator::ranges_type ranges(_first, _rest...);
+        iterator last(ranges, true);
+
+        return iterator_range<iterator>(iterator(std::move(ranges), false), std::move(last));
+    }
+
+    template <typename Reference, std::size_t I, typename Ranges, typename F, typename... Iterators>
+    void cartesian_loops(const Ranges&, F& _f, std::true_type, const Iterators&... _iterators) {
+        _f(Reference(*_iterators...));
+    }
+
+    template <typename Reference, std::size_t I, typename Ranges, typename F, typename... Iterators>
+    void cartesian_loops(const Ranges& _ranges, F& _f, std::false_type, const Iterators&... _iterators) {
+        using range = typename std::tuple_element<I, Ranges>::type;
+        using innermost = std::integral_constant<bool, I + 1 == std::tuple_size<Ranges>::value>;
+        const range& current = std::get<I>(_ranges);
+
+        for (typename range::iterator it = current.begin(), end = current.end(); it != end; ++it) {
+            cartesian_loops<Reference, I + 1>(_ranges, _f, innermost(), _iterators..., it);
+        }
+    }
+
+    /**
+     * @brief Calls _f with every combination of an element of _outer and one of each of the ranges after the first in
+     *        _ranges, the ranges of a cartesian product, in nested loops; _outer is the first range or a part of it.
+     */
+    template <typename Reference, typename Outer, typename Ranges, typename F>
+    void cartesian_for_each(const Outer& _outer, const Ranges& _ranges, F& _f) {
+        using innermost = std::integral_constant<bool, std::tuple_size<Ranges>::value == 1>;
+
+        for (typename Outer::iterator it = _outer.begin(), end = _outer.end(); it != end; ++it) {
+            cartesian_loops<Reference, 1>(_ranges, _f, innermost(), it);
+        }
+    }
+
+    /**
+     * @brief Calls _f with every element of the cartesian product _range, in the order of its iterators, and returns
+     *        _f.
+     */
+    template <typename... Ranges, typename F>
+    F for_each(const iterator_range<cartesian_product_iterator<Ranges...>>& _range, F _f) {
+        using reference = typename cartesian_product_iterator<Ranges...>::reference;
+        const cartesian_product_iterator<Ranges...> first = _range.begin();
+
+        cartesian_for_each<reference>(std::get<0>(first.ranges()), first.ranges(), _f);
+        return _f;
+    }
+
+    /**
+     * @brief Number of elements of the fixed-length inner loop of index loops, a multiple of the elements of a vector
+     *        register for every element type, so that the compiler vectorizes it without a remainder loop even where
+     *        its cost model does not allow one, as for GCC at -O2.
+     */
+    constexpr std::int32_t index_loop_block = 16;
+
+    /**
+     * @brief Checks whether the loops of for_each() and transform() over an iterator_range<Iterator, Sentinel> are run
+     *        as 32-bit index loops over a base pointer: contiguous ranges whose size is known in constant time.
+     */
+    template <typename Iterator, typename Sentinel>
+    struct is_index_loop_range : std::integral_constant<bool,
+            is_contiguous_iterator<Iterator>::value && is_sized_sentinel_for<Sentinel, Iterator>::value
+            && !is_segmented_range<Iterator, Sentinel>::value> {
+    };
+
+    /**
+     * @brief Checks whether calls to an F are inlined into index loops. Function objects are; calls through function
+     *        pointers are resolved only after inlining, so they stay calls in each of the loops and are not worth the
+     *        larger code.
+     */
+    template <typename F>
+    struct is_index_loop_function : std::is_class<F> {
+    };
+
+    /**
+     * @brief Checks whether the _n elements of _range fit a 32-bit signed index, returning their count as one.
+     */
+    template <typename Iterator, typename Sentinel>
+    bool narrow_size(const iterator_range<Iterator, Sentinel>& _range, std::int32_t& _n) {
+        const auto n = _range.end() - _range.begin();
+
+        if (n < 0 || static_cast<std::uint64_t>(n) > static_cast<std::uint64_t>(INT32_MAX)) {
+            return false;
+        }
+
+        _n = static_cast<std::int32_t>(n);
+        return true;
+    }
+
+    /**
+     * @brief Calls _f(_data[i]) for every i in [0, _n) in order, in blocks of index_loop_block elements: a 32-bit
+     *        index needs no 64-bit induction variable and the fixed-length inner loop needs no trip count check.
+     */
+    template <typename T, typename F>
+    void index_loop(T* _data, std::int32_t _n, F& _f) {
+        std::int32_t i = 0;
+
+        for (; i <= _n - index_loop_block; i += index_loop_block) {
+            T* block = _data + i;
+
+            for (std::int32_t j = 0; j < index_loop_block; ++j) {
+                _f(block[j]);
+            }
+        }
+
+        for (; i < _n; ++i) {
+            _f(_data[i]);
+        }
+    }
+
+    template <typename Iterator, typename Sentinel, typename F>
+    void for_each_impl(const iterator_range<Iterator, Sentinel>& _range, F& _f, std::false_type) {
+        for_each_segment(_range, [&_f](auto _first, auto _last) {
+            for (; _first != _last; ++_first) {
+                _f(*_first);
+            }
+        });
+    }
+
+    template <typename Iterator, typename Sentinel, typename F>
+    void for_each_impl(const iterator_range<Iterator, Sentinel>& _range, F& _f, std::true_type) {
+        std::int32_t n = 0;
+
+        if (!narrow_size(_range, n)) {
+            for_each_impl(_range, _f, std::false_type());
+        } else if (classify_size(static_cast<std::size_t>(n)) == size_class::tiny) {
+            auto* data = _range.data();
+            tiny_loop(n, [data, &_f](std::int32_t _i) { _f(data[_i]); });
+        } else {
+            index_loop(_range.data(), n, _f);
+        }
+    }
+
+    /**
+     * @brief Calls _f with every element of _range and returns _f. Segmented ranges such as those of std::deque are
+     *        walked as a loop over segments around a tight loop over each segment, which the compiler can vectorize.
+     *        Contiguous sized ranges of fewer than 2^31 elements are walked with index_loop() when _f is a function
+     *        object.
+     */
+    template <typename Iterator, typename Sentinel, typename F>
+    F for_each(const iterator_range<Iterator, Sentinel>& _range, F _f) {
+        for_each_impl(_range, _f, std::integral_constant<bool,
+                      is_index_loop_range<Iterator, Sentinel>::value && is_index_loop_function<F>::value>());
+        return _f;
+    }
+
+    /**
+     * @brief Returns _init combined with every element of _range, in order, using _op. Segmented ranges are reduced
+     *        with a separate loop over each segment.
+     */
+    template <typename Iterator, typename Sentinel, typename T, typename BinaryOp = std::plus<>>
+    T reduce(const iterator_range<Iterator, Sentinel>& _range, T _init, BinaryOp _op = BinaryOp()) {
+        for_each_segment(_range, [&_init, &_op](auto _first, auto _last) {
+            for (; _first != _last; ++_first) {
+                _init = _op(std::move(_init), *_first);
+            }
+        });
+
+        return _init;
+    }
+
+    template <typename Iterator, typename Sentinel>
+    struct is_random_access_sized_range : std::integral_constant<bool,
+            std::is_base_of<std::random_access_iterator_tag,
+                            typename std::iterator_traits<Iterator>::iterator_category>::value
+            && is_sized_sentinel_for<Sentinel, Iterator>::value> {
+    };
+
+    /**
+     * @brief Aggregate of the elements of a container that is only appended to, such as a growing std::vector or
+     *        std::deque, kept up to date by combining only the elements appended since the last update:
+     *
+     *        incremental_reduce<double> total;
+     *        ...
+     *        samples.insert(samples.end(), batch.begin(), batch.end());
+     *        display(total.update((samples.cbegin(), samples.cend())));
+     *
+     *        Elements are tracked by position, since appending may invalidate the iterators of the container, so
+     *        every update must be passed the whole container as a random access range. erase_front() takes the
+     *        elements at the front out of the aggregate through the inverse of _op, such as std::minus<> for sums,
+     *        which keeps a window over the most recent elements; windowed_reduce does this for operations without an
+     *        inverse.
+     */
+    template <typename T, typename BinaryOp = std::plus<>>
+    class incremental_reduce {
+    private:
+        T m_value;
+        BinaryOp m_op;
+        std::size_t m_first;
+        std::size_t m_last;
+
+        template <typename Iterator, typename Sentinel>
+        static void check_range(const iterator_range<Iterator, Sentinel>&) {
+            static_assert(is_random_access_sized_range<Iterator, Sentinel>::value,
+                          "incremental_reduce requires a random access range that knows its size");
+        }
+
+    public:
+        /**
+         * @brief Starts with the aggregate _init of no elements.
+         */
+        explicit incremental_reduce(T _init = T(), BinaryOp _op = BinaryOp()) :
+                m_value(std::move(_init)), m_op(std::move(_op)), m_first(0), m_last(0) { }
+
+        /**
+         * @brief Combines the elements of _range after those already aggregated into the aggregate and returns it.
+         *        _range must hold the elements seen by the previous updates at the same positions.
+         */
+        template <typename Iterator, typename Sentinel>
+        const T& update(const iterator_range<Iterator, Sentinel>& _range) {
+            check_range(_range);
+
+            const std::size_t size = _range.size();
+            if (size > m_last) {
+                m_value = reduce(make_iterator_range(advanced(_range.begin(), m_last), advanced(_range.begin(), size)),
+                                 std::move(m_value), m_op);
+                m_last = size;
+            }
+
+            return m_value;
+        }
+
+        /**
+         * @brief Takes the first _n aggregated elements of _range out of the aggregate with _inverse, which must undo
+         *        _op, so that _inverse(_op(a, x), x) equals a, and returns the aggregate.
+         */
+        template <typename Iterator, typename Sentinel, typename InverseOp>
+        const T& erase_front(const iterator_range<Iterator, Sentinel>& _range, std::size_t _n, InverseOp _inverse) {
+            check_range(_range);
+
+            const std::size_t last = m_first + std::min(_n, m_last - m_first);
+            for (Iterator it = advanced(_range.begin(), m_first); m_first != last; ++m_first, ++it) {
+                m_value = _inverse(std::move(m_value), *it);
+            }
+
+            return m_value;
+        }
+
+        const T& value() const { return m_value; }
+
+        /**
+         * @brief Returns the position in the container of the first element aggregated.
+         */
+        std::size_t first() const { return m_first; }
+
+        /**
+         * @brief Returns the position in the container after the last element aggregated.
+         */
+        std::size_t last() const { return m_last; }
+    };
+
+    /**
+     * @brief Aggregate of a window of the elements of an append-only container for operations without an inverse,
+     *        such as the maximum: update() adds the elements appended since the last update and erase_front()
+     *        drops the oldest elements, both in amortized constant time per element:
+     *
+     *        auto larger = [](double _a, double _b) { return std::max(_a, _b); };
+     *        windowed_reduce<double, decltype(larger)> peak(-HUGE_VAL, larger);
+     *        peak.update((prices.cbegin(), prices.cend()));
+     *        peak.erase_front(peak.size() > 600 ? peak.size() - 600 : 0);
+     *
+     *        _init must be an identity of _op, such as 0 for a sum or the lowest value for a maximum, and _op must be
+     *        associative; it need not be commutative, the elements being combined in order. The window is kept as two
+     *        stacks: the elements added since the last drop with their running aggregate, and, for the older ones,
+     *        the aggregate of each element with all that follow it, which are recomputed when the older stack runs
+     *        out. Each element is therefore copied into the window and combined at most twice.
+     */
+    template <typename T, typename BinaryOp = std::plus<>>
+    class windowed_reduce {
+    private:
+        T m_identity;
+        BinaryOp m_op;
+        std::vector<T> m_back;
+        T m_back_value;
+        std::vector<T> m_front;
+        std::size_t m_last;
+
+        void move_back_to_front() {
+            T suffix = m_identity;
+
+            for (std::size_t i = m_back.size(); i-- > 0;) {
+                suffix = m_op(std::move(m_back[i]), std::move(suffix));
+                m_front.push_back(suffix);
+            }
+
+            m_back.clear();
+            m_back_value = m_identity;
+        }
+
+    public:
+        explicit windowed_reduce(T _init = T(), BinaryOp _op = BinaryOp()) :
+                m_identity(_init), m_op(std::move(_op)), m_back(), m_back_value(std::move(_init)), m_front(),
+                m_last(0) { }
+
+        /**
+         * @brief Adds the elements of _range after the position of the last element added to the window and returns
+         *        the aggregate. _range must hold the elements seen by the previous updates at the same positions.
+         */
+        template <typename Iterator, typename Sentinel>
+        T update(const iterator_range<Iterator, Sentinel>& _range) {
+            static_assert(is_random_access_sized_range<Iterator, Sentinel>::value,
+                          "windowed_reduce requires a random access range that knows its size");
+
+            const std::size_t size = _range.size();
+            for (Iterator it = advanced(_range.begin(), m_last); m_last < size; ++m_last, ++it) {
+                m_back.push_back(*it);
+                m_back_value = m_op(std::move(m_back_value), m_back.back());
+            }
+
+            return value();
+        }
+
+        /**
+         * @brief Drops the _n oldest elements of the window, or all of them if it holds fewer, and returns the
+         *        aggregate.
+         */
+        T erase_front(std::size_t _n) {
+            for (; _n && !empty(); --_n) {
+                if (m_front.empty()) {
+                    move_back_to_front();
+                }
+
+                m_front.pop_back();
+            }
+
+            return value();
+        }
+
+        /**
+         * @brief Returns the aggregate of the elements in the window, in order.
+         */
+        T value() const { return m_front.empty() ? m_back_value : m_op(m_front.back(), m_back_value); }
+
+        std::size_t size() const { return m_front.size() + m_back.size(); }
+        bool empty() const { return m_front.empty() && m_back.empty(); }
+    };
+
+    template <typename Reference, typename Functions, std::size_t... I>
+    void call_fused(Reference& _x, Functions& _f, std::index_sequence<I...>) {
+        int expand[] = {0, (std::get<I>(_f)(_x), 0)...};
+        (void)expand;
+    }
+
+    /**
+     * @brief Calls every function of _f, in order, with each element of _range and returns the functions. Unlike
+     *        separate for_each() calls, the range is traversed once, so several passes such as collecting a minimum,
+     *        a maximum and a histogram share the memory traffic, and single-pass ranges can feed all of them:
+     *
+     *        auto result = for_each_fused((stream.begin(), stream.end()), count_lines, update_histogram);
+     */
+    template <typename Iterator, typename Sentinel, typename... F>
+    std::tuple<F...> for_each_fused(const iterator_range<Iterator, Sentinel>& _range, F... _f) {
+        std::tuple<F...> functions(std::move(_f)...);
+
+        for_each_segment(_range, [&functions](auto _first, auto _last) {
+            for (; _first != _last; ++_first) {
+                auto&& x = *_first;
+                call_fused(x, functions, std::index_sequence_for<F...>());
+            }
+        });
+
+        return functions;
+    }
+
+    template <typename Reference, typename Values, typename Operations, std::size_t... I>
+    void reduce_fused(Reference& _x, Values& _values, Operations& _ops, std::index_sequence<I...>) {
+        int expand[] = {0, (std::get<I>(_values) = std::get<I>(_ops)(std::move(std::get<I>(_values)), _x), 0)...};
+        (void)expand;
+    }
+
+    /**
+     * @brief Computes several reductions of _range in a single traversal. Element i of the returned tuple is element
+     *        i of _init combined with every element of _range, in order, using the i-th operation of _ops:
+     *
+     *        auto stats = reduce_many(range, std::make_tuple(0.0, lowest, highest), std::plus<>(), min_op, max_op);
+     */
+    template <typename Iterator, typename Sentinel, typename... T, typename... BinaryOp>
+    std::tuple<T...> reduce_many(const iterator_range<Iterator, Sentinel>& _range, std::tuple<T...> _init,
+                                 BinaryOp... _ops) {
+        static_assert(sizeof...(T) == sizeof...(BinaryOp), "reduce_many needs one initial value per operation");
+        std::tuple<BinaryOp...> ops(std::move(_ops)...);
+
+        for_each_segment(_range, [&_init, &ops](auto _first, auto _last) {
+            for (; _first != _last; ++_first) {
+                auto&& x = *_first;
+                reduce_fused(x, _init, ops, std::index_sequence_for<T...>());
+            }
+        });
+
+        return _init;
+    }
+
+    template <typename Iterator>
+    void prefetch_element(const Iterator& _it, std::true_type) {
+        prefetch(IteratorBasedForImpl::to_address(_it));
+    }
+
+    template <typename Iterator>
+    void prefetch_element(const Iterator&, std::false_type) { }
+
+    /**
+     * @brief Returns the first iterator _it of the sorted range [_first, _first + _n) for which _goes_right(*_it) is
+     *        false. The search halves the range without branching on the comparisons, which the compiler turns into
+     *        conditional moves, so its time does not depend on how predictable they are. Contiguous ranges have the
+     *        midpoints of both halves prefetched while the current comparison loads, which overlaps the cache misses
+     *        of consecutive steps.
+     */
+    template <typename Iterator, typename GoesRight>
+    Iterator branchless_partition_point(Iterator _first, std::size_t _n, GoesRight _goes_right) {
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using prefetching = std::integral_constant<bool, is_contiguous_iterator<Iterator>::value>;
+
+        if (_n == 0) {
+            return _first;
+        }
+
+        while (_n > 1) {
+            const std::size_t half = _n / 2;
+            prefetch_element(_first + static_cast<difference_type>(half / 2), prefetching());
+            prefetch_element(_first + static_cast<difference_type>(half + half / 2), prefetching());
+            _first += _goes_right(_first[static_cast<difference_type>(half)]) ? static_cast<difference_type>(half) : 0;
+            _n -= half;
+        }
+
+        return _first + (_goes_right(*_first) ? 1 : 0);
+    }
+
+    /**
+     * @brief Returns the first element of the random access range _range, sorted with respect to _compare, that is
+     *        not less than _value, like std::lower_bound but without branch mispredictions.
+     */
+    template <typename Iterator, typename Sentinel, typename T, typename Compare = std::less<>,
+              typename std::enable_if<is_sized_sentinel_for<Sentinel, Iterator>::value, int>::type = 0>
+    Iterator lower_bound(const iterator_range<Iterator, Sentinel>& _range, const T& _value,
+                         Compare _compare = Compare()) {
+        return branchless_partition_point(_range.begin(), _range.size(), [&](const auto& _element) {
+            return _compare(_element, _value);
+        });
+    }
+
+    /**
+     * @brief Returns the first element of the random access range _range, sorted with respect to _compare, that is
+     *        greater than _value, like std::upper_bound but without branch mispredictions.
+     */
+    template <typename Iterator, typename Sentinel, typename T, typename Compare = std::less<>,
+              typename std::enable_if<is_sized_sentinel_for<Sentinel, Iterator>::value, int>::type = 0>
+    Iterator upper_bound(const iterator_range<Iterator, Sentinel>& _range, const T& _value,
+                         Compare _compare = Compare()) {
+        return branchless_partition_point(_range.begin(), _range.size(), [&](const auto& _element) {
+            return !_compare(_value, _element);
+        });
+    }
+
+    /**
+     * @brief Returns the elements of the random access range _range, sorted with respect to _compare, that are
+     *        equivalent to _value, as the pair of lower_bound() and upper_bound().
+     */
+    template <typename Iterator, typename Sentinel, typename T, typename Compare = std::less<>,
+              typename std::enable_if<is_sized_sentinel_for<Sentinel, Iterator>::value, int>::type = 0>
+    iterator_range<Iterator> equal_range(const iterator_range<Iterator, Sentinel>& _range, const T& _value,
+                                         Compare _compare = Compare()) {
+        Iterator first = IteratorBasedForImpl::lower_bound(_range, _value, _compare);
+        Iterator last = IteratorBasedForImpl::upper_bound(iterator_range<Iterator, Sentinel>(first, _range.end()),
+                                                          _value, _compare);
+        return iterator_range<Iterator>(first, last);
+    }
+
+    /**
+     * @brief Search index over a sorted random access range. The index copies the elements in the Eytzinger layout,
+     *        the breadth-first order of the implicit binary search tree, where the elements a search compares next
+     *        are stored next to each other, so the first levels of the tree share few cache lines and every step
+     *        prefetches the cache line four levels down. Repeated lookups into a large range then cost a fraction of
+     *        the cache misses of a binary search over the range itself.
+     *
+     *        The searches return iterators into the indexed range, which must outlive the index and must not be
+     *        modified while the index is used. The copies are allocated with a rebound copy of Allocator.
+     */
+    template <typename Iterator, typename Compare = std::less<>, typename Allocator = std::allocator<char>>
+    class eytzinger_index {
+    public:
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using allocator_type = Allocator;
+
+    private:
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+
+        /**
+         * @brief Number of elements in a cache line, the number of nodes four levels below a node lie in.
+         */
+        static constexpr std::size_t line_elements = sizeof(value_type) < 64 ? 64 / sizeof(value_type) : 1;
+
+        Iterator m_first;
+        std::size_t m_size;
+
+        //Node k, from 1 on, has the children 2k and 2k + 1. m_ranks[k] is the position of its element in the
+        //indexed range, and m_ranks[0] the size of the range, which a search past the last element ends at.
+        std::vector<value_type, typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>> m_nodes;
+        std::vector<std::size_t, typename std::allocator_traits<Allocator>::template rebind_alloc<std::size_t>> m_ranks;
+        Compare m_compare;
+
+        /**
+         * @brief Stores the elements from position _rank on in the subtree of _node, in order, and returns the
+         *        position after them.
+         */
+        std::size_t build(std::size_t _node, std::size_t _rank) {
+            if (_node > m_size) {
+                return _rank;
+            }
+
+            _rank = build(2 * _node, _rank);
+            m_nodes[_node] = m_first[static_cast<difference_type>(_rank)];
+            m_ranks[_node] = _rank;
+            return build(2 * _node + 1, _rank + 1);
+        }
+
+        template <typename GoesRight>
+        Iterator search(GoesRight _goes_right) const {
+            const value_type* nodes = m_nodes.data();
+            std::size_t node = 1;
+
+            while (node <= m_size) {
+                //Only an address is computed, which is harmless past the end of the nodes.
+                prefetch(reinterpret_cast<const void*>(reinterpret_cast<std::uintptr_t>(nodes)
+                                                       + node * line_elements * sizeof(value_type)));
+                node = 2 * node + (_goes_right(nodes[node]) ? 1 : 0);
+            }
+
+            //The path went left for the last time at the node found. Dropping the right turns taken after it and
+            //that left turn leads back to it, or to 0 if the path never went left.
+            node >>= count_trailing_zeros(~node) + 1;
+            return m_first + static_cast<difference_type>(m_ranks[node]);
+        }
+
+    public:
+        template <typename Sentinel>
+        explicit eytzinger_index(const iterator_range<Iterator, Sentinel>& _range, Compare _compare = Compare(),
+                                 const Allocator& _allocator = Allocator()) :
+                m_first(_range.begin()),
+                m_size(_range.size()),
+                m_nodes(m_size + 1, value_type(), _allocator),
+                m_ranks(m_size + 1, 0, _allocator),
+                m_compare(std::move(_compare)) {
+            m_ranks[0] = m_size;
+            build(1, 0);
+        }
+
+        std::size_t size() const { return m_size; }
+
+        /**
+         * @brief Returns the first element of the indexed range that is not less than _value.
+         */
+        template <typename T>
+        Iterator lower_bound(const T& _value) const {
+            return search([&](const value_type& _element) { return m_compare(_element, _value); });
+        }
+
+        /**
+         * @brief Returns the first element of the indexed range that is greater than _value.
+         */
+        template <typename T>
+        Iterator upper_bound(const T& _value) const {
+            return search([&](const value_type& _element) { return !m_compare(_value, _element); });
+        }
+
+        /**
+         * @brief Returns the elements of the indexed range equivalent to _value.
+         */
+        template <typename T>
+        iterator_range<Iterator> equal_range(const T& _value) const {
+            return iterator_range<Iterator>(lower_bound(_value), upper_bound(_value));
+        }
+    };
+
+    /**
+     * @brief Returns an eytzinger_index over the random access range _range, sorted with respect to _compare.
+     */
+    template <typename Iterator, typename Sentinel, typename Compare = std::less<>>
+    eytzinger_index<Iterator, Compare> make_eytzinger_index(const iterator_range<Iterator, Sentinel>& _range,
+                                                            Compare _compare = Compare()) {
+        return eytzinger_index<Iterator, Compare>(_range, std::move(_compare));
+    }
+
+    /**
+     * @brief Returns the size in bytes of the largest cache level the operating system reports, or 8 MiB if it
+     *        reports none.
+     */
+    inline std::size_t last_level_cache_size() {
+        static const std::size_t size = []() -> std::size_t {
+#if defined(_SC_LEVEL3_CACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+            const long sizes[] = {sysconf(_SC_LEVEL3_CACHE_SIZE), sysconf(_SC_LEVEL2_CACHE_SIZE)};
+
+            for (long bytes : sizes) {
+                if (bytes > 0) {
+                    return static_cast<std::size_t>(bytes);
+                }
+            }
+#endif
+            return std::size_t(8) << 20;
+        }();
+
+        return size;
+    }
+
+    /**
+     * @brief Returns the setting behind streaming_threshold().
+     */
+    inline std::atomic<std::size_t>& streaming_threshold_setting() {
+        static std::atomic<std::size_t> threshold(last_level_cache_size());
+        return threshold;
+    }
+
+    /**
+     * @brief Returns the size in bytes from which copy() and move() write contiguous trivially copyable ranges with
+     *        non-temporal stores instead of memmove, leaving the cache to the data that is still in use. Defaults to
+     *        last_level_cache_size(), since a write that large would evict the whole cache anyway.
+     */
+    inline std::size_t streaming_threshold() {
+        return streaming_threshold_setting().load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sets streaming_threshold() to _bytes. Use SIZE_MAX to never use non-temporal stores.
+     */
+    inline void set_streaming_threshold(std::size_t _bytes) {
+        streaming_threshold_setting().store(_bytes, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Checks whether copying an iterator_range<Iterator, Sentinel> to OutputIterator can be done with a single
+     *        memmove: both sides are contiguous, the range knows its size and the elements are of the same trivially
+     *        copyable type.
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator>
+    struct is_bulk_copyable {
+        template <typename I>
+        using element = typename std::remove_reference<typename std::iterator_traits<I>::reference>::type;
+
+        template <typename I, typename S, typename O>
+        static constexpr auto check(int) -> std::integral_constant<bool,
+                is_contiguous_iterator<I>::value
+                && is_contiguous_iterator<O>::value
+                && is_sized_sentinel_for<S, I>::value
+                && std::is_same<typename std::remove_const<element<I>>::type, element<O>>::value
+                && std::is_trivially_copyable<element<O>>::value>;
+
+        template <typename, typename, typename>
+        static constexpr std::false_type check(...);
+
+        static constexpr bool value = decltype(check<Iterator, Sentinel, OutputIterator>(0))::value;
+    };
+
+    /**
+     * @brief Copies _bytes bytes from _source to _destination, which may overlap, with non-temporal stores if there
+     *        are at least _threshold bytes and the two do not overlap, and with memmove otherwise.
+     */
+    inline void bulk_copy(void* _destination, const void* _source, std::size_t _bytes, std::size_t _threshold) {
+        const std::uintptr_t out = reinterpret_cast<std::uintptr_t>(_destination);
+        const std::uintptr_t in = reinterpret_cast<std::uintptr_t>(_source);
+        const bool overlapping = out < in + _bytes && in < out + _bytes;
+
+        if (simd::has_streaming_stores() && !overlapping && _bytes >= _threshold) {
+            simd::stream_copy(_destination, _source, _bytes);
+        } else if (_bytes != 0) {
+            std::memmove(_destination, _source, _bytes);
+        }
+    }
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename Transfer>
+    OutputIterator copy_impl(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out, Transfer _transfer,
+                             std::size_t, std::false_type) {
+        Sentinel end = _range.end();
+
+        for (Iterator it = _range.begin(); it != end; ++it) {
+            *_out = _transfer(*it);
+            ++_out;
+        }
+
+        return _out;
+    }
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename Transfer>
+    OutputIterator copy_impl(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out, Transfer,
+                             std::size_t _threshold, std::true_type) {
+        const std::size_t n = _range.size();
+
+        bulk_copy(IteratorBasedForImpl::to_address(_out), IteratorBasedForImpl::to_address(_range.begin()),
+                  n * sizeof(*IteratorBasedForImpl::to_address(_out)), _threshold);
+        return advanced(_out, n);
+    }
+
+    /**
+     * @brief Checks whether a strided range over Iterator is copied with simd::deinterleave() rather than an element
+     *        at a time.
+     */
+    template <typename Iterator>
+    struct is_deinterleavable : std::integral_constant<bool, simd::is_kernel_range<Iterator, Iterator>::value> { };
+
+    /**
+     * @brief Copies a strided range over a contiguous range to a contiguous output with simd::deinterleave().
+     */
+    template <typename Iterator, typename OutputIterator, typename Transfer,
+              typename std::enable_if<is_deinterleavable<Iterator>::value
+                                      && is_contiguous_iterator<OutputIterator>::value
+                                      && std::is_same<typename std::remove_const<simd::element_t<Iterator>>::type,
+                                                      simd::element_t<OutputIterator>>::value, int>::type = 0>
+    OutputIterator copy_impl(const iterator_range<strided_iterator<Iterator>>& _range, OutputIterator _out, Transfer,
+                             std::size_t, std::false_type) {
+        const auto n = _range.end() - _range.begin();
+        const auto stride = _range.begin().stride();
+
+        if (n <= 0) {
+            return _out;
+        }
+
+        const Iterator first = _range.begin().first() + _range.begin().index() * stride;
+        return simd::deinterleave(make_iterator_range(first, first + ((n - 1) * stride + 1)),
+                                  static_cast<std::size_t>(stride), std::move(_out));
+    }
+
+    /**
+     * @brief Copies a reversed range with a backward loop over the underlying range.
+     */
+    template <typename Iterator, typename OutputIterator, typename Transfer>
+    OutputIterator copy_impl(const iterator_range<reversed_iterator<Iterator>>& _range, OutputIterator _out,
+                             Transfer _transfer, std::size_t, std::false_type) {
+        const Iterator first = _range.end().base();
+
+        for (Iterator it = _range.begin().base(); it != first;) {
+            --it;
+            *_out = _transfer(*it);
+            ++_out;
+        }
+
+        return _out;
+    }
+
+    template <typename T, byte_order Order, typename OutputIterator>
+    OutputIterator copy_decoded(const iterator_range<decoded_iterator<T, Order>>& _range, OutputIterator _out,
+                                std::true_type) {
+        decode_values<T, Order>(_range.begin().base(), _range.size(), IteratorBasedForImpl::to_address(_out));
+        return _out + static_cast<typename std::iterator_traits<OutputIterator>::difference_type>(_range.size());
+    }
+
+    template <typename T, byte_order Order, typename OutputIterator>
+    OutputIterator copy_decoded(const iterator_range<decoded_iterator<T, Order>>& _range, OutputIterator _out,
+                                std::false_type) {
+        for_each_decoded_block(_range, [&_out](const T* _first, const T* _last) {
+            _out = std::copy(_first, _last, std::move(_out));
+        });
+
+        return _out;
+    }
+
+    /**
+     * @brief Copies a decoded range a block at a time, straight into the output if it is a contiguous range of T.
+     */
+    template <typename T, byte_order Order, typename OutputIterator, typename Transfer>
+    OutputIterator copy_impl(const iterator_range<decoded_iterator<T, Order>>& _range, OutputIterator _out,
+                             Transfer, std::size_t, std::false_type) {
+        using output_type = typename std::remove_reference<
+            typename std::iterator_traits<OutputIterator>::reference>::type;
+
+        return copy_decoded(_range, std::move(_out), std::integral_constant<bool,
+                            is_contiguous_iterator<OutputIterator>::value && std::is_same<output_type, T>::value>());
+    }
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename Transfer>
+    OutputIterator copy_segmented(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out,
+                                  Transfer _transfer, std::size_t _threshold, std::false_type) {
+        return copy_impl(_range, std::move(_out), _transfer, _threshold, std::integral_constant<bool,
+                         is_bulk_copyable<Iterator, Sentinel, OutputIterator>::value>());
+    }
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename Transfer>
+    OutputIterator copy_segmented(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out,
+                                  Transfer _transfer, std::size_t _threshold, std::true_type) {
+        using local_iterator = typename segmented_iterator_traits<Iterator>::local_iterator;
+
+        for_each_segment(_range, [&_out, &_transfer, _threshold](local_iterator _first, local_iterator _last) {
+            _out = copy_segmented(make_iterator_range(_first, _last), std::move(_out), _transfer, _threshold,
+                                  std::false_type());
+        });
+
+        return _out;
+    }
+
+    /**
+     * @brief Copies or moves _range to _out with the fastest applicable form: segmented ranges segment by segment,
+     *        each segment with a memmove if possible, and other ranges whole.
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename Transfer>
+    OutputIterator copy_dispatch(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out,
+                                 Transfer _transfer, std::size_t _threshold) {
+        return copy_segmented(_range, std::move(_out), _transfer, _threshold,
+                              std::integral_constant<bool, is_segmented_range<Iterator, Sentinel>::value>());
+    }
+
+    struct copy_element {
+        template <typename T>
+        T& operator()(T& _x) const { return _x; }
+    };
+
+    struct move_element {
+        template <typename T>
+        typename std::remove_reference<T>::type&& operator()(T&& _x) const { return std::move(_x); }
+    };
+
+    /**
+     * @brief Copies the elements of _range to the output starting at _out and returns the end of the output. A
+     *        contiguous range of trivially copyable elements copied to a contiguous output of the same element type
+     *        is copied with a single memmove, or with non-temporal stores from streaming_threshold() bytes on, and a
+     *        segmented range with one such copy per segment. The output may overlap the range only if it starts at or
+     *        before the range's first element.
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator>
+    OutputIterator copy(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out) {
+        return copy_dispatch(_range, std::move(_out), copy_element(), streaming_threshold());
+    }
+
+    /**
+     * @brief Moves the elements of _range to the output starting at _out and returns the end of the output. Takes
+     *        the same fast paths as copy(), since moving a trivially copyable element copies it.
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator>
+    OutputIterator move(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out) {
+        return copy_dispatch(_range, std::move(_out), move_element(), streaming_threshold());
+    }
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator>
+    OutputIterator byteswap_copy_impl(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out,
+                                      std::true_type) {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        constexpr byte_order swapped = native_byte_order() == byte_order::little ? byte_order::big
+                                                                                 : byte_order::little;
+        using swapped_iterator = decoded_iterator<value_type, swapped>;
+        const std::uint8_t* first = byte_address(_range.begin());
+
+        return copy(iterator_range<swapped_iterator>(swapped_iterator(first),
+                                                     swapped_iterator(first + _range.size() * sizeof(value_type))),
+                    std::move(_out));
+    }
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator>
+    OutputIterator byteswap_copy_impl(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out,
+                                      std::false_type) {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        constexpr byte_order swapped = native_byte_order() == byte_order::little ? byte_order::big
+                                                                                 : byte_order::little;
+
+        for (auto it = _range.begin(); it != _range.end(); ++it, ++_out) {
+            const value_type value = *it;
+            *_out = decode_value<value_type, swapped>(reinterpret_cast<const std::uint8_t*>(&value));
+        }
+
+        return _out;
+    }
+
+    /**
+     * @brief Copies the arithmetic values of _range to the output starting at _out with the order of their bytes
+     *        reversed, converting between little-endian and big-endian, and returns the end of the output. A
+     *        contiguous range is swapped a whole vector at a time by the byteswap() kernel, straight into the output
+     *        if it is a contiguous range of the same type and through a buffer otherwise.
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator>
+    OutputIterator byteswap_copy(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out) {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        static_assert(std::is_arithmetic<value_type>::value, "byteswap_copy requires a range of arithmetic values");
+
+        return byteswap_copy_impl(_range, std::move(_out), std::integral_constant<bool,
+                                  is_contiguous_iterator<Iterator>::value
+                                  && is_sized_sentinel_for<Sentinel, Iterator>::value>());
+    }
+
+    /**
+     * @brief Checks whether Container has a reserve() member, as std::vector and std::basic_string do.
+     */
+    template <typename Container>
+    struct has_reserve_impl {
+        template <typename U>
+        static constexpr auto check(int) -> decltype(std::declval<U&>().reserve(std::size_t()), std::true_type());
+
+        template <typename>
+        static constexpr std::false_type check(...);
+
+        typedef decltype(check<Container>(0)) type;
+    };
+
+    template <typename Container>
+    struct has_reserve : has_reserve_impl<Container>::type { };
+
+    /**
+     * @brief Capacity of the first chunk to() collects a range of unknown size into. Every further chunk is twice as
+     *        large as the one before.
+     */
+    constexpr std::size_t to_first_chunk = 64;
+
+    template <typename Container>
+    void reserve_if_possible(Container& _container, std::size_t _n, std::true_type) {
+        _container.reserve(_n);
+    }
+
+    template <typename Container>
+    void reserve_if_possible(Container&, std::size_t, std::false_type) { }
+
+    template <typename Container, typename Iterator, typename Sentinel>
+    void append_each(Container& _container, const iterator_range<Iterator, Sentinel>& _range) {
+        for (auto it = _range.begin(); it != _range.end(); ++it) {
+            _container.insert(_container.end(), *it);
+        }
+    }
+
+    //Sequence containers insert a range at their end, associative containers where its elements belong.
+    template <typename Container, typename Iterator>
+    auto insert_range(Container& _container, Iterator _first, Iterator _last, int)
+            -> decltype(_container.insert(_container.end(), _first, _last), void()) {
+        _container.insert(_container.end(), _first, _last);
+    }
+
+    template <typename Container, typename Iterator>
+    void insert_range(Container& _container, Iterator _first, Iterator _last, long) {
+        _container.insert(_first, _last);
+    }
+
+    //Contiguous ranges are inserted as pointers, which the standard containers copy with a memmove when the elements
+    //are trivially copyable, and other ranges that end with an iterator with a single range insertion.
+    template <typename Container, typename Iterator, typename Sentinel>
+    void append_sized(Container& _container, const iterator_range<Iterator, Sentinel>& _range, std::true_type) {
+        const auto first = IteratorBasedForImpl::to_address(_range.begin());
+        insert_range(_container, first, first + _range.size(), 0);
+    }
+
+    template <typename Container, typename Iterator>
+    void append_sized(Container& _container, const iterator_range<Iterator, Iterator>& _range, std::false_type) {
+        insert_range(_container, _range.begin(), _range.end(), 0);
+    }
+
+    template <typename Container, typename Iterator, typename Sentinel>
+    void append_sized(Container& _container, const iterator_range<Iterator, Sentinel>& _range, std::false_type) {
+        append_each(_container, _range);
+    }
+
+    template <typename Container, typename Iterator, typename Sentinel>
+    void to_impl(Container& _container, const iterator_range<Iterator, Sentinel>& _range, std::true_type) {
+        reserve_if_possible(_container, _range.size(), has_reserve<Container>());
+        append_sized(_container, _range, std::integral_constant<bool, is_contiguous_iterator<Iterator>::value>());
+    }
+
+    //A range of unknown size is read into the container up to a first reservation, and the rest into chunks of
+    //doubling capacity, which are never reallocated. They are moved into the container once their total is known,
+    //so that it is reallocated at most once and is no larger than needed.
+    template <typename Container, typename Iterator, typename Sentinel>
+    void collect_chunked(Container& _container, const iterator_range<Iterator, Sentinel>& _range, std::true_type) {
+        using value_type = typename Container::value_type;
+        auto it = _range.begin();
+
+        _container.reserve(_container.size() + to_first_chunk);
+        for (; it != _range.end() && _container.size() < _container.capacity(); ++it) {
+            _container.insert(_container.end(), *it);
+        }
+
+        if (it == _range.end()) {
+            return;
+        }
+
+        std::vector<std::vector<value_type>> chunks;
+        std::size_t capacity = _container.capacity();
+        std::size_t total = 0;
+
+        while (it != _range.end()) {
+            chunks.emplace_back();
+            std::vector<value_type>& chunk = chunks.back();
+            chunk.reserve(capacity);
+            capacity *= 2;
+
+            for (; it != _range.end() && chunk.size() < chunk.capacity(); ++it) {
+                chunk.emplace_back(*it);
+            }
+
+            total += chunk.size();
+        }
+
+        _container.reserve(_container.size() + total);
+        for (std::vector<value_type>& chunk : chunks) {
+            _container.insert(_container.end(), std::make_move_iterator(chunk.begin()),
+                              std::make_move_iterator(chunk.end()));
+        }
+    }
+
+    template <typename Container, typename Iterator, typename Sentinel>
+    void collect_chunked(Container& _container, const iterator_range<Iterator, Sentinel>& _range, std::false_type) {
+        append_each(_container, _range);
+    }
+
+    template <typename Container, typename Iterator, typename Sentinel>
+    void to_impl(Container& _container, const iterator_range<Iterator, Sentinel>& _range, std::false_type) {
+        collect_chunked(_container, _range, has_reserve<Container>());
+    }
+
+    /**
+     * @brief Returns a Container holding the elements of _range in order, for views and other lazy ranges that must
+     *        be materialized:
+     *
+     *        auto large = to<std::vector<double>>(filter((totals.begin(), totals.end()), [](double _x) {
+     *            return _x > 1000.0;
+     *        }));
+     *
+     *        If the size of _range is known in constant time, the container is reserved for it first, and contiguous
+     *        ranges of trivially copyable elements are copied with a memmove. A range of unknown size is read once,
+     *        into chunks of geometrically growing capacity that are moved into the container at the end, instead of
+     *        reallocating the container as it grows or walking the range twice to count it. Containers without
+     *        reserve(), such as std::list and std::set, are filled by inserting at their end.
+     */
+    template <typename Container, typename Iterator, typename Sentinel>
+    Container to(const iterator_range<Iterator, Sentinel>& _range) {
+        Container container;
+        to_impl(container, _range, std::integral_constant<bool, is_sized_sentinel_for<Sentinel, Iterator>::value>());
+        return container;
+    }
+
+    /**
+     * @brief Returns a Container of the value type of _range holding its elements, so that to<std::vector>(range)
+     *        need not name the element type. Otherwise the same as to<Container<T>>(_range).
+     */
+    template <template <typename...> class Container, typename Iterator, typename Sentinel>
+    Container<typename std::iterator_traits<Iterator>::value_type> to(
+            const iterator_range<Iterator, Sentinel>& _range) {
+        return to<Container<typename std::iterator_traits<Iterator>::value_type>>(_range);
+    }
+
+    /**
+     * @brief Assigns _value to every element of _range, segment by segment for segmented ranges.
+     */
+    template <typename Iterator, typename Sentinel, typename T>
+    void fill(const iterator_range<Iterator, Sentinel>& _range, const T& _value) {
+        for_each_segment(_range, [&_value](auto _first, auto _last) {
+            for (; _first != _last; ++_first) {
+                *_first = _value;
+            }
+        });
+    }
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename F>
+    OutputIterator transform_impl(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out, F& _f,
+                                  std::false_type) {
+        Sentinel end = _range.end();
+
+        for (Iterator it = _range.begin(); it != end; ++it) {
+            *_out = _f(*it);
+            ++_out;
+        }
+
+        return _out;
+    }
+
+    /**
+     * @brief Transforms a contiguous range into a contiguous output with 32-bit index loops. The results of a block
+     *        are gathered in a local array and then stored, so that the compiler need not prove that the output does
+     *        not overlap the input to vectorize the block; this gives the same results as storing them one by one
+     *        unless the output starts inside the input, which is transformed element by element.
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename F>
+    OutputIterator transform_impl(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out, F& _f,
+                                  std::true_type) {
+        using value_type = typename std::iterator_traits<OutputIterator>::value_type;
+        std::int32_t n = 0;
+
+        if (!narrow_size(_range, n) || n == 0) {
+            return transform_impl(_range, _out, _f, std::false_type());
+        }
+
+        const auto* in = _range.data();
+        value_type* out = IteratorBasedForImpl::to_address(_out);
+        const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(in);
+        const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(out);
+
+        if (start > first && start < reinterpret_cast<std::uintptr_t>(in + n)) {
+            return transform_impl(_range, _out, _f, std::false_type());
+        }
+
+        if (classify_size(static_cast<std::size_t>(n)) == size_class::tiny) {
+            tiny_loop(n, [in, out, &_f](std::int32_t _i) { out[_i] = _f(in[_i]); });
+            return _out + n;
+        }
+
+        std::int32_t i = 0;
+
+        for (; i <= n - index_loop_block; i += index_loop_block) {
+            value_type block[index_loop_block];
+
+            for (std::int32_t j = 0; j < index_loop_block; ++j) {
+                block[j] = _f(in[i + j]);
+            }
+
+            for (std::int32_t j = 0; j < index_loop_block; ++j) {
+                out[i + j] = std::move(block[j]);
+            }
+        }
+
+        for (; i < n; ++i) {
+            out[i] = _f(in[i]);
+        }
+
+        return _out + n;
+    }
+
+    /**
+     * @brief Writes _f applied to every element of _range to the output starting at _out and returns the end of the
+     *        output. Function objects transforming contiguous sized ranges of fewer than 2^31 elements into trivially
+     *        copyable results in a contiguous output run in 32-bit index loops.
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename F>
+    OutputIterator transform(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out, F _f) {
+        using value_type = typename std::iterator_traits<OutputIterator>::value_type;
+
+        return transform_impl(_range, _out, _f, std::integral_constant<bool,
+                              is_index_loop_range<Iterator, Sentinel>::value && is_index_loop_function<F>::value
+                              && is_contiguous_iterator<OutputIterator>::value
+                              && std::is_trivially_copyable<value_type>::value
+                              && std::is_default_constructible<value_type>::value>());
+    }
+
+    /**
+     * @brief Number of elements whose predicate results copy_if() and remove_if() collect before handing them to
+     *        simd::compress().
+     */
+    constexpr std::size_t compress_block = 256;
+
+    /**
+     * @brief Checks whether the elements of an iterator_range<Iterator, Sentinel> that satisfy a predicate are copied
+     *        to OutputIterator with simd::compress(). Only 32-bit elements are, as the compiler does not vectorize
+     *        narrowing the predicate results of wider elements to bytes, and there are no byte kernels.
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator>
+    struct is_compressible : std::integral_constant<bool,
+            simd::is_kernel_range<Iterator, Sentinel>::value
+            && sizeof(simd::element_t<Iterator>) == 4
+            && is_contiguous_iterator<OutputIterator>::value
+            && std::is_same<typename std::remove_const<simd::element_t<Iterator>>::type,
+                            simd::element_t<OutputIterator>>::value> {
+    };
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename Predicate>
+    OutputIterator copy_if_impl(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out,
+                                Predicate& _pred, std::false_type) {
+        Sentinel end = _range.end();
+
+        for (Iterator it = _range.begin(); it != end; ++it) {
+            if (_pred(*it)) {
+                *_out = *it;
+                ++_out;
+            }
+        }
+
+        return _out;
+    }
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename Predicate>
+    OutputIterator copy_if_impl(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out,
+                                Predicate& _pred, std::true_type) {
+        const std::size_t n = _range.size();
+
+        if (!simd::has_vector_compress() || classify_size(n) == size_class::tiny) {
+            return copy_if_impl(_range, std::move(_out), _pred, std::false_type());
+        }
+
+        const simd::element_t<Iterator>* in = IteratorBasedForImpl::to_address(_range.begin());
+        std::uint8_t keep[compress_block];
+
+        std::size_t i = 0;
+
+        //A constant trip count lets the compiler vectorize the predicate.
+        for (; i + compress_block <= n; i += compress_block) {
+            for (std::size_t j = 0; j < compress_block; ++j) {
+                keep[j] = _pred(in[i + j]) ? 1 : 0;
+            }
+
+            _out = simd::compress(make_iterator_range(in + i, in + i + compress_block), keep, std::move(_out));
+        }
+
+        for (std::size_t j = 0; i + j < n; ++j) {
+            keep[j] = _pred(in[i + j]) ? 1 : 0;
+        }
+
+        return simd::compress(make_iterator_range(in + i, in + n), keep, std::move(_out));
+    }
+
+    /**
+     * @brief Copies the elements of _range that satisfy _pred to the output starting at _out, in order, and returns
+     *        the end of the output. Contiguous ranges of float or int32_t elements copied to a contiguous output
+     *        evaluate _pred for a block of elements and then store the selected ones with simd::compress() where
+     *        AVX2 or AVX-512 is active, which keeps the loop free of a branch per element.
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename Predicate>
+    OutputIterator copy_if(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out, Predicate _pred) {
+        return copy_if_impl(_range, std::move(_out), _pred,
+                            typename is_compressible<Iterator, Sentinel, OutputIterator>::type());
+    }
+
+    template <typename Iterator, typename Sentinel, typename Predicate>
+    Iterator remove_if_impl(const iterator_range<Iterator, Sentinel>& _range, Predicate& _pred, std::false_type) {
+        Iterator out = _range.begin();
+        Sentinel end = _range.end();
+
+        while (out != end && !_pred(*out)) {
+            ++out;
+        }
+
+        if (out == end) {
+            return out;
+        }
+
+        Iterator it = out;
+
+        for (++it; it != end; ++it) {
+            if (!_pred(*it)) {
+                *out = std::move(*it);
+                ++out;
+            }
+        }
+
+        return out;
+    }
+
+    template <typename Iterator, typename Sentinel, typename Predicate>
+    Iterator remove_if_impl(const iterator_range<Iterator, Sentinel>& _range, Predicate& _pred, std::true_type) {
+        auto keep = [&_pred](const simd::element_t<Iterator>& _value) { return !_pred(_value); };
+        return copy_if_impl(_range, _range.begin(), keep, std::true_type());
+    }
+
+    /**
+     * @brief Moves the elements of _range that do not satisfy _pred to its front, in order, and returns the end of
+     *        those elements; the elements after it are left in a valid but unspecified state. Contiguous ranges of
+     *        float or int32_t elements are compacted in place like copy_if().
+     */
+    template <typename Iterator, typename Sentinel, typename Predicate>
+    Iterator remove_if(const iterator_range<Iterator, Sentinel>& _range, Predicate _pred) {
+        return remove_if_impl(_range, _pred, typename is_compressible<Iterator, Sentinel, Iterator>::type());
+    }
+
+    /**
+     * @brief Number of candidates beyond 2 * k that top_k() collects before it trims them back to k, so that the
+     *        vector kernels always have room for a whole vector.
+     */
+    constexpr std::size_t top_k_slack = 256;
+
+    inline std::size_t top_k_capacity(std::size_t _k) {
+        return _k <= (SIZE_MAX - top_k_slack) / 2 ? 2 * _k + top_k_slack : SIZE_MAX;
+    }
+
+    /**
+     * @brief Checks whether top_k() selects the elements of an iterator_range<Iterator, Sentinel> compared with Compare
+     *        with simd::select_beyond(): contiguous ranges of kernel elements compared with std::greater or std::less.
+     */
+    template <typename Iterator, typename Sentinel, typename Compare>
+    struct is_threshold_selectable : std::integral_constant<bool,
+            simd::is_kernel_range<Iterator, Sentinel>::value
+            && (std::is_same<Compare, std::greater<>>::value || std::is_same<Compare, std::less<>>::value
+                || std::is_same<Compare, std::greater<typename std::iterator_traits<Iterator>::value_type>>::value
+                || std::is_same<Compare, std::less<typename std::iterator_traits<Iterator>::value_type>>::value)> {
+    };
+
+    /**
+     * @brief Keeps the _k candidates of _candidates that come first with respect to _compare, the last of which, at
+     *        _k - 1, is the bound later candidates must beat.
+     */
+    template <typename T, typename Compare>
+    void trim_candidates(std::vector<T>& _candidates, std::size_t _k, Compare& _compare) {
+        std::nth_element(_candidates.begin(), _candidates.begin() + static_cast<std::ptrdiff_t>(_k - 1),
+                         _candidates.end(), std::ref(_compare));
+        _candidates.resize(_k);
+    }
+
+    template <typename T, typename OutputIterator, typename Compare>
+    OutputIterator emit_candidates(std::vector<T>& _candidates, std::size_t _k, OutputIterator _out,
+                                   Compare& _compare) {
+        if (_candidates.size() > _k) {
+            trim_candidates(_candidates, _k, _compare);
+        }
+
+        std::sort(_candidates.begin(), _candidates.end(), std::ref(_compare));
+        return std::move(_candidates.begin(), _candidates.end(), std::move(_out));
+    }
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename Compare>
+    OutputIterator top_k_impl(const iterator_range<Iterator, Sentinel>& _range, std::size_t _k, OutputIterator _out,
+                              Compare& _compare, std::false_type) {
+        const std::size_t capacity = top_k_capacity(_k);
+        std::vector<typename std::iterator_traits<Iterator>::value_type> candidates;
+        Iterator it = _range.begin();
+        Sentinel end = _range.end();
+
+        for (; it != end && candidates.size() < _k; ++it) {
+            candidates.push_back(*it);
+        }
+
+        if (it != end) {
+            trim_candidates(candidates, _k, _compare);
+        }
+
+        for (; it != end; ++it) {
+            if (_compare(*it, candidates[_k - 1])) {
+                candidates.push_back(*it);
+
+                if (candidates.size() == capacity) {
+                    trim_candidates(candidates, _k, _compare);
+                }
+            }
+        }
+
+        return emit_candidates(candidates, _k, std::move(_out), _compare);
+    }
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename Compare>
+    OutputIterator top_k_impl(const iterator_range<Iterator, Sentinel>& _range, std::size_t _k, OutputIterator _out,
+                              Compare& _compare, std::true_type) {
+        using value_type = typename std::remove_const<simd::element_t<Iterator>>::type;
+
+        const value_type* p = IteratorBasedForImpl::to_address(_range.begin());
+        const std::size_t n = _range.size();
+        const bool greater = _compare(value_type(1), value_type(0));
+
+        if (classify_size(n) == size_class::tiny) {
+            return top_k_impl(_range, _k, std::move(_out), _compare, std::false_type());
+        }
+
+        if (n <= _k) {
+            std::vector<value_type> candidates(p, p + n);
+            return emit_candidates(candidates, _k, std::move(_out), _compare);
+        }
+
+        const std::size_t capacity = top_k_capacity(_k);
+        std::vector<value_type> candidates(capacity);
+        std::copy(p, p + _k, candidates.begin());
+        std::nth_element(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(_k - 1),
+                         candidates.begin() + static_cast<std::ptrdiff_t>(_k), std::ref(_compare));
+
+        std::size_t written = _k;
+
+        for (std::size_t i = _k; i < n;) {
+            i += simd::select_beyond(make_iterator_range(p + i, p + n), candidates[_k - 1], greater,
+                                     candidates.data(), capacity, written);
+
+            if (i < n) {
+                std::nth_element(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(_k - 1),
+                                 candidates.begin() + static_cast<std::ptrdiff_t>(written), std::ref(_compare));
+                written = _k;
+            }
+        }
+
+        candidates.resize(written);
+        return emit_candidates(candidates, _k, std::move(_out), _compare);
+    }
+
+    /**
+     * @brief Writes the min(_k, size) elements of _range that a sort with respect to _compare would put first to the
+     *        output starting at _out, sorted, and returns the end of the output; by default these are the _k largest
+     *        elements, largest first. Instead of keeping a heap, the elements beating the last of the best _k
+     *        candidates found so far are appended to a buffer of about 2 * _k candidates, which nth_element trims
+     *        back to the best _k whenever it is full, so that after the first elements most of them are rejected by a
+     *        single comparison. Contiguous ranges of float, double, int32_t or uint8_t compared with std::greater or
+     *        std::less reject them a vector at a time with simd::select_beyond(). Which of several equivalent
+     *        elements is selected is unspecified, and so is the result if floating-point elements include NaN.
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename Compare = std::greater<>>
+    OutputIterator top_k(const iterator_range<Iterator, Sentinel>& _range, std::size_t _k, OutputIterator _out,
+                         Compare _compare = Compare()) {
+        if (_k == 0) {
+            return _out;
+        }
+
+        return top_k_impl(_range, _k, std::move(_out), _compare,
+                          typename is_threshold_selectable<Iterator, Sentinel, Compare>::type());
+    }
+
+    /**
+     * @brief Number of sub-histograms histogram() counts consecutive elements into, so that runs of equal keys do not
+     *        wait for the previous increment of the same counter to reach memory.
+     */
+    constexpr std::size_t histogram_lanes = 4;
+
+    /**
+     * @brief Largest number of bins histogram() keeps several sub-histograms of, which must fit the first level cache
+     *        together. Larger histograms are counted into a single table.
+     */
+    constexpr std::size_t histogram_lane_bins = 2048;
+
+    /**
+     * @brief Number of elements every sub-histogram counts before its 32-bit counters are added to the result.
+     */
+    constexpr std::size_t histogram_flush_elements = std::size_t(1) << 31;
+
+    /**
+     * @brief The key histogram() counts an element under by default: the element itself, bytes read as unsigned.
+     */
+    struct element_key {
+        template <typename T, typename std::enable_if<is_byte<T>::value, int>::type = 0>
+        std::size_t operator()(T _value) const { return static_cast<unsigned char>(_value); }
+
+        template <typename T, typename std::enable_if<!is_byte<T>::value, int>::type = 0>
+        std::size_t operator()(T _value) const { return static_cast<std::size_t>(_value); }
+    };
+
+    template <typename Word>
+    void flush_histogram(std::vector<Word>& _tables, std::size_t _bins, std::size_t* _counts) {
+        for (std::size_t i = 0; i < _tables.size(); ++i) {
+            _counts[i % _bins] += std::exchange(_tables[i], 0);
+        }
+    }
+
+    inline void check_histogram_key(bool _outside) {
+        if (_outside) {
+            throw std::out_of_range("histogram: a key is not less than the number of bins");
+        }
+    }
+
+    template <typename Iterator, typename KeyFn>
+    void count_histogram_lane(Iterator _element, std::size_t _bins, KeyFn& _key, std::uint32_t* _table) {
+        const std::size_t key = static_cast<std::size_t>(_key(*_element));
+
+        check_histogram_key(key >= _bins);
+        ++_table[key];
+    }
+
+    //Spelled out rather than looped over so that every lane gets its own increment without relying on unrolling.
+    template <typename Iterator, typename KeyFn, std::size_t... Lane>
+    void count_histogram_lanes(Iterator _first, std::size_t _bins, KeyFn& _key, std::uint32_t* _tables,
+                               std::index_sequence<Lane...>) {
+        int expand[] = {0, (count_histogram_lane(_first + static_cast<std::ptrdiff_t>(Lane), _bins, _key,
+                                                 _tables + Lane * _bins), 0)...};
+        (void)expand;
+    }
+
+    template <std::size_t Lanes, typename Iterator, typename Sentinel, typename KeyFn>
+    void histogram_impl(const iterator_range<Iterator, Sentinel>& _range, std::size_t _bins, KeyFn& _key,
+                        std::size_t* _counts, std::false_type) {
+        std::vector<std::uint32_t> tables(Lanes * _bins);
+        Iterator it = _range.begin();
+        Sentinel end = _range.end();
+
+        while (it != end) {
+            for (std::size_t round = 0; round < histogram_flush_elements && it != end; ++round) {
+                for (std::size_t lane = 0; lane < Lanes && it != end; ++lane) {
+                    const std::size_t key = static_cast<std::size_t>(_key(*it));
+
+                    check_histogram_key(key >= _bins);
+                    ++tables[lane * _bins + key];
+                    ++it;
+                }
+            }
+
+            flush_histogram(tables, _bins, _counts);
+        }
+    }
+
+    //Ranges that know their size count Lanes elements per step, one into every table.
+    template <std::size_t Lanes, typename Iterator, typename Sentinel, typename KeyFn>
+    void histogram_impl(const iterator_range<Iterator, Sentinel>& _range, std::size_t _bins, KeyFn& _key,
+                        std::size_t* _counts, std::true_type) {
+        std::vector<std::uint32_t> tables(Lanes * _bins);
+        std::uint32_t* const table = tables.data();
+        const Iterator first = _range.begin();
+        const std::size_t n = _range.size();
+        std::size_t i = 0;
+
+        while (i + Lanes <= n) {
+            const std::size_t last = i + std::min((n - i) / Lanes, histogram_flush_elements) * Lanes;
+
+            for (; i < last; i += Lanes) {
+                count_histogram_lanes(first + static_cast<std::ptrdiff_t>(i), _bins, _key, table,
+                                      std::make_index_sequence<Lanes>());
+            }
+
+            flush_histogram(tables, _bins, _counts);
+        }
+
+        for (; i < n; ++i) {
+            const std::size_t key = static_cast<std::size_t>(_key(first[static_cast<std::ptrdiff_t>(i)]));
+
+            check_histogram_key(key >= _bins);
+            ++_counts[key];
+        }
+    }
+
+    /**
+     * @brief Adds the number of elements of _range under every key of [0, _bins) that _key assigns them to _counts.
+     *        Throws std::out_of_range if a key is not less than _bins.
+     */
+    template <typename Iterator, typename Sentinel, typename KeyFn>
+    void histogram_into(const iterator_range<Iterator, Sentinel>& _range, std::size_t _bins, KeyFn& _key,
+                        std::size_t* _counts) {
+        using sized = std::integral_constant<bool, is_sized_sentinel_for<Sentinel, Iterator>::value>;
+
+        if (_bins <= histogram_lane_bins) {
+            histogram_impl<histogram_lanes>(_range, _bins, _key, _counts, sized());
+        } else {
+            histogram_impl<1>(_range, _bins, _key, _counts, sized());
+        }
+    }
+
+    /**
+     * @brief Returns the number of elements of _range under every key from 0 to _bins - 1 that _key assigns them,
+     *        the elements themselves by default, such as the byte frequencies of a buffer:
+     *
+     *        std::vector<std::size_t> frequencies = histogram((buffer.cbegin(), buffer.cend()), 256);
+     *
+     *        Histograms of up to histogram_lane_bins bins count consecutive elements into histogram_lanes separate
+     *        tables that are added up at the end, so that runs of equal keys, which are common in real data, do not
+     *        serialize on one counter. Throws std::out_of_range if a key is not less than _bins.
+     */
+    template <typename Iterator, typename Sentinel, typename KeyFn = element_key>
+    std::vector<std::size_t> histogram(const iterator_range<Iterator, Sentinel>& _range, std::size_t _bins,
+                                       KeyFn _key = KeyFn()) {
+        std::vector<std::size_t> counts(_bins);
+        histogram_into(_range, _bins, _key, counts.data());
+        return counts;
+    }
+
+    /**
+     * @brief Number of keys the sketches hash at a time with simd::hash64().
+     */
+    constexpr std::size_t sketch_block = 256;
+
+    /**
+     * @brief Returns the 64-bit hash the sketches file _key under, the same one for equal integral or enumeration
+     *        keys of any type.
+     */
+    template <typename Key>
+    std::uint64_t sketch_hash(const Key& _key) {
+        return simd::scalar_kernels::mix64(static_cast<std::uint64_t>(_key));
+    }
+
+    /**
+     * @brief Adds every key of _range to _sketch, hashing sketch_block keys at a time with the vector kernel of the
+     *        active instruction set before handing their hashes to _sketch.add_hashes().
+     */
+    template <typename Iterator, typename Sentinel, typename Sketch>
+    void sketch_into(const iterator_range<Iterator, Sentinel>& _range, Sketch& _sketch) {
+        using key_type = typename std::iterator_traits<Iterator>::value_type;
+
+        static_assert(std::is_integral<key_type>::value || std::is_enum<key_type>::value,
+                      "the sketches require integral or enumeration keys");
+
+        std::uint64_t keys[sketch_block];
+        std::uint64_t hashes[sketch_block];
+        Iterator it = _range.begin();
+        const Sentinel end = _range.end();
+
+        while (it != end) {
+            std::size_t n = 0;
+
+            for (; n < sketch_block && it != end; ++n, ++it) {
+                keys[n] = static_cast<std::uint64_t>(*it);
+            }
+
+            simd::hash64(keys, n, hashes);
+            _sketch.add_hashes(hashes, n);
+        }
+    }
+
+    /**
+     * @brief Calls _f with the _count positions that double hashing derives from _hash, each step being odd so that
+     *        the positions are distinct within a power-of-two table of at least _count entries, until _f returns
+     *        false.
+     */
+    template <typename F>
+    void for_each_hashed_position(std::uint64_t _hash, unsigned _count, F _f) {
+        const std::uint64_t step = (_hash >> 32) | 1;
+
+        for (unsigned i = 0; i < _count && _f(_hash); ++i) {
+            _hash += step;
+        }
+    }
+
+    /**
+     * @brief Number of bits of a block of a bloom_filter, a cache line, which holds all the bits of the keys it is
+     *        chosen for.
+     */
+    constexpr std::size_t bloom_block_bits = 512;
+
+    /**
+     * @brief Blocked Bloom filter, a set of keys that may report keys it does not hold but never misses one it does.
+     *        The hash of a key picks one of a power-of-two number of blocks of bloom_block_bits bits, a cache line,
+     *        and sets hashes() bits within it, so that adding or looking up a key touches one cache line instead of
+     *        one per bit. A filter of m bits holding n keys with k hashes reports a missing key with a probability
+     *        slightly above the (1 - e^(-kn/m))^k of a filter spreading the bits over all of them.
+     */
+    class bloom_filter {
+    private:
+        static constexpr std::size_t block_words = bloom_block_bits / 64;
+
+        std::vector<std::uint64_t> m_words;
+        std::uint64_t m_block_mask;
+        unsigned m_hashes;
+
+        static std::size_t round_blocks(std::size_t _bits) {
+            std::size_t blocks = 1;
+
+            while (blocks * bloom_block_bits < _bits) {
+                blocks *= 2;
+            }
+
+            return blocks;
+        }
+
+        //The high half of the hash picks the block and the low half the bits within it, its lower 16 bits the first
+        //one and its upper 16 bits the step between them.
+        static std::uint64_t bits_in_block(std::uint64_t _hash) {
+            return (_hash & 0xFFFF) | ((_hash & 0xFFFF0000) << 16);
+        }
+
+        std::uint64_t* block(std::uint64_t _hash) {
+            return m_words.data() + static_cast<std::size_t>((_hash >> 32) & m_block_mask) * block_words;
+        }
+
+        const std::uint64_t* block(std::uint64_t _hash) const {
+            return m_words.data() + static_cast<std::size_t>((_hash >> 32) & m_block_mask) * block_words;
+        }
+
+    public:
+        /**
+         * @brief Creates an empty filter of at least _bits bits, rounded up to a power-of-two number of blocks,
+         *        setting _hashes bits per key. Throws std::invalid_argument if _hashes is 0.
+         */
+        bloom_filter(std::size_t _bits, unsigned _hashes) :
+                m_words(round_blocks(_bits) * block_words), m_block_mask(round_blocks(_bits) - 1), m_hashes(_hashes) {
+            if (_hashes == 0) {
+                throw std::invalid_argument("bloom_filter: a key must set at least one bit");
+            }
+        }
+
+        std::size_t bits() const { return m_words.size() * 64; }
+        unsigned hashes() const { return m_hashes; }
+        const std::vector<std::uint64_t>& words() const { return m_words; }
+
+        void add_hash(std::uint64_t _hash) {
+            std::uint64_t* const words = block(_hash);
+
+            for_each_hashed_position(bits_in_block(_hash), m_hashes, [words](std::uint64_t _position) {
+                const std::size_t bit = static_cast<std::size_t>(_position % bloom_block_bits);
+                words[bit / 64] |= std::uint64_t(1) << (bit % 64);
+                return true;
+            });
+        }
+
+        void add_hashes(const std::uint64_t* _hashes, std::size_t _n) {
+            for (std::size_t i = 0; i < _n; ++i) {
+                add_hash(_hashes[i]);
+            }
+        }
+
+        bool contains_hash(std::uint64_t _hash) const {
+            const std::uint64_t* const words = block(_hash);
+            bool found = true;
+
+            for_each_hashed_position(bits_in_block(_hash), m_hashes, [words, &found](std::uint64_t _position) {
+                const std::size_t bit = static_cast<std::size_t>(_position % bloom_block_bits);
+                found = ((words[bit / 64] >> (bit % 64)) & 1) != 0;
+                return found;
+            });
+
+            return found;
+        }
+
+        template <typename Key>
+        void add(const Key& _key) { add_hash(sketch_hash(_key)); }
+
+        template <typename Key>
+        bool contains(const Key& _key) const { return contains_hash(sketch_hash(_key)); }
+
+        /**
+         * @brief Adds the keys of _other, a filter of the same size and number of hashes, to this filter. Throws
+         *        std::invalid_argument if the filters differ.
+         */
+        bloom_filter& merge(const bloom_filter& _other) {
+            if (_other.m_block_mask != m_block_mask || _other.m_hashes != m_hashes) {
+                throw std::invalid_argument("bloom_filter: only filters of the same shape can be merged");
+            }
+
+            for (std::size_t i = 0; i < m_words.size(); ++i) {
+                m_words[i] |= _other.m_words[i];
+            }
+
+            return *this;
+        }
+    };
+
+    /**
+     * @brief HyperLogLog sketch estimating the number of distinct keys in 2^precision one-byte registers, with a
+     *        relative standard error of about 1.04 / sqrt(2^precision), 0.8% for the default precision of 14. The
+     *        first precision bits of a key's hash select a register, which keeps the longest run of leading zeros
+     *        seen in the remaining bits.
+     */
+    class hyperloglog_sketch {
+    private:
+        std::vector<std::uint8_t> m_registers;
+        unsigned m_precision;
+
+        static std::size_t check_precision(unsigned _precision) {
+            if (_precision < 4 || _precision > 18) {
+                throw std::invalid_argument("hyperloglog_sketch: the precision must be from 4 to 18");
+            }
+
+            return std::size_t(1) << _precision;
+        }
+
+    public:
+        /**
+         * @brief Creates an empty sketch of 2^_precision registers. Throws std::invalid_argument unless _precision
+         *        is from 4 to 18.
+         */
+        explicit hyperloglog_sketch(unsigned _precision = 14) :
+                m_registers(check_precision(_precision)), m_precision(_precision) {
+        }
+
+        unsigned precision() const { return m_precision; }
+        const std::vector<std::uint8_t>& registers() const { return m_registers; }
+
+        void add_hash(std::uint64_t _hash) {
+            //The set bit bounds the run of zeros, so that the rank fits the register even for the hash 0.
+            const std::uint64_t rest = (_hash << m_precision) | (std::uint64_t(1) << (m_precision - 1));
+            const std::uint8_t rank = static_cast<std::uint8_t>(count_leading_zeros(rest) + 1);
+            std::uint8_t& reg = m_registers[static_cast<std::size_t>(_hash >> (64 - m_precision))];
+
+            reg = std::max(reg, rank);
+        }
+
+        void add_hashes(const std::uint64_t* _hashes, std::size_t _n) {
+            for (std::size_t i = 0; i < _n; ++i) {
+                add_hash(_hashes[i]);
+            }
+        }
+
+        template <typename Key>
+        void add(const Key& _key) { add_hash(sketch_hash(_key)); }
+
+        /**
+         * @brief Returns the estimated number of distinct keys added, by linear counting of the empty registers while
+         *        many are left and from the harmonic mean of the registers otherwise.
+         */
+        double estimate() const {
+            const double m = static_cast<double>(m_registers.size());
+            const double alpha = m_precision == 4 ? 0.673 : m_precision == 5 ? 0.697 : m_precision == 6 ? 0.709
+                                                                                      : 0.7213 / (1 + 1.079 / m);
+            double sum = 0;
+            std::size_t zeros = 0;
+
+            for (std::uint8_t reg : m_registers) {
+                sum += std::ldexp(1.0, -static_cast<int>(reg));
+                zeros += reg == 0 ? 1 : 0;
+            }
+
+            const double raw = alpha * m * m / sum;
+
+            return raw <= 2.5 * m && zeros != 0 ? m * std::log(m / static_cast<double>(zeros)) : raw;
+        }
+
+        /**
+         * @brief Adds the keys of _other, a sketch of the same precision, to this sketch. Throws std::invalid_argument
+         *        if the precisions differ.
+         */
+        hyperloglog_sketch& merge(const hyperloglog_sketch& _other) {
+            if (_other.m_precision != m_precision) {
+                throw std::invalid_argument("hyperloglog_sketch: only sketches of the same precision can be merged");
+            }
+
+            for (std::size_t i = 0; i < m_registers.size(); ++i) {
+                m_registers[i] = std::max(m_registers[i], _other.m_registers[i]);
+            }
+
+            return *this;
+        }
+    };
+
+    /**
+     * @brief Count-min sketch estimating how often every key occurs, never below the true count. A key adds to one
+     *        counter in each of depth() rows of width() counters, a power of two, and its estimate is the smallest
+     *        of them: with probability 1 - e^-depth it exceeds the true count by at most e / width() times the total
+     *        of all counts.
+     */
+    class count_min_sketch {
+    private:
+        std::vector<std::uint64_t> m_counters;
+        std::uint64_t m_mask;
+        unsigned m_depth;
+
+        static std::size_t round_width(std::size_t _width) {
+            std::size_t width = 1;
+
+            while (width < _width) {
+                width *= 2;
+            }
+
+            return width;
+        }
+
+    public:
+        /**
+         * @brief Creates an empty sketch of _depth rows of at least _width counters, rounded up to a power of two.
+         *        Throws std::invalid_argument if _depth is 0.
+         */
+        explicit count_min_sketch(std::size_t _width = 2048, unsigned _depth = 4) :
+                m_counters(round_width(_width) * _depth), m_mask(round_width(_width) - 1), m_depth(_depth) {
+            if (_depth == 0) {
+                throw std::invalid_argument("count_min_sketch: at least one row is required");
+            }
+        }
+
+        std::size_t width() const { return static_cast<std::size_t>(m_mask + 1); }
+        unsigned depth() const { return m_depth; }
+
+        void add_hash(std::uint64_t _hash, std::uint64_t _count = 1) {
+            std::uint64_t* row = m_counters.data();
+            const std::uint64_t mask = m_mask;
+
+            for_each_hashed_position(_hash, m_depth, [mask, &row, _count](std::uint64_t _position) {
+                row[_position & mask] += _count;
+                row += mask + 1;
+                return true;
+            });
+        }
+
+        void add_hashes(const std::uint64_t* _hashes, std::size_t _n) {
+            for (std::size_t i = 0; i < _n; ++i) {
+                add_hash(_hashes[i]);
+            }
+        }
+
+        std::uint64_t estimate_hash(std::uint64_t _hash) const {
+            const std::uint64_t* row = m_counters.data();
+            std::uint64_t estimate = ~std::uint64_t(0);
+
+            for_each_hashed_position(_hash, m_depth, [this, &row, &estimate](std::uint64_t _position) {
+                estimate = std::min(estimate, row[_position & m_mask]);
+                row += m_mask + 1;
+                return true;
+            });
+
+            return estimate;
+        }
+
+        template <typename Key>
+        void add(const Key& _key, std::uint64_t _count = 1) { add_hash(sketch_hash(_key), _count); }
+
+        template <typename Key>
+        std::uint64_t estimate(const Key& _key) const { return estimate_hash(sketch_hash(_key)); }
+
+        /**
+         * @brief Adds the counts of _other, a sketch of the same width and depth, to this sketch. Throws
+         *        std::invalid_argument if the sketches differ.
+         */
+        count_min_sketch& merge(const count_min_sketch& _other) {
+            if (_other.m_mask != m_mask || _other.m_depth != m_depth) {
+                throw std::invalid_argument("count_min_sketch: only sketches of the same shape can be merged");
+            }
+
+            for (std::size_t i = 0; i < m_counters.size(); ++i) {
+                m_counters[i] += _other.m_counters[i];
+            }
+
+            return *this;
+        }
+    };
+
+    /**
+     * @brief Returns a Bloom filter of at least _bits bits holding every integral key of _range with _hashes bits per
+     *        key, built in a single pass that hashes the keys a block at a time in vectors:
+     *
+     *        bloom_filter build_keys = build_bloom((build.cbegin(), build.cend()), 8 * build.size(), 6);
+     *        auto candidates = filter((probe.cbegin(), probe.cend()), [&](key k) { return build_keys.contains(k); });
+     */
+    template <typename Iterator, typename Sentinel>
+    bloom_filter build_bloom(const iterator_range<Iterator, Sentinel>& _range, std::size_t _bits, unsigned _hashes) {
+        bloom_filter filter(_bits, _hashes);
+        sketch_into(_range, filter);
+        return filter;
+    }
+
+    /**
+     * @brief Returns a HyperLogLog sketch of 2^_precision registers of the integral keys of _range, whose estimate()
+     *        is the approximate number of distinct keys.
+     */
+    template <typename Iterator, typename Sentinel>
+    hyperloglog_sketch hyperloglog(const iterator_range<Iterator, Sentinel>& _range, unsigned _precision = 14) {
+        hyperloglog_sketch sketch(_precision);
+        sketch_into(_range, sketch);
+        return sketch;
+    }
+
+    /**
+     * @brief Returns a count-min sketch of _depth rows of _width counters of the integral keys of _range, whose
+     *        estimate(key) is at least the number of occurrences of key in _range.
+     */
+    template <typename Iterator, typename Sentinel>
+    count_min_sketch count_min(const iterator_range<Iterator, Sentinel>& _range, std::size_t _width = 2048,
+                               unsigned _depth = 4) {
+        count_min_sketch sketch(_width, _depth);
+        sketch_into(_range, sketch);
+        return sketch;
+    }
+
+    /**
+     * @brief Uniform random bit generator drawing the words of the Philox4x32 counters of the stream _stream under
+     *        the key _seed in order, so that any number of independent, reproducible engines can be made from one
+     *        seed. Works with the distributions of <random>.
+     */
+    class philox_engine {
+    private:
+        std::uint64_t m_key;
+        std::uint64_t m_stream;
+        std::uint64_t m_block;
+        std::uint32_t m_words[4];
+        unsigned m_next;
+
+    public:
+        using result_type = std::uint32_t;
+
+        explicit philox_engine(std::uint64_t _seed = 0, std::uint64_t _stream = 0) :
+                m_key(_seed),
+                m_stream(_stream),
+                m_block(0),
+                m_words(),
+                m_next(4) {
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+        result_type operator()() {
+            if (m_next == 4) {
+                simd::scalar_kernels::philox4x32(m_key, m_stream, m_block++, 1, m_words);
+                m_next = 0;
+            }
+
+            return m_words[m_next++];
+        }
+
+        /**
+         * @brief Skips _n words in constant time.
+         */
+        void discard(unsigned long long _n) {
+            const std::uint64_t position = 4 * m_block - (4 - m_next) + _n;
+            m_block = position / 4;
+            m_next = 4;
+
+            if (position % 4 != 0) {
+                simd::scalar_kernels::philox4x32(m_key, m_stream, m_block++, 1, m_words);
+                m_next = static_cast<unsigned>(position % 4);
+            }
+        }
+    };
+
+    /**
+     * @brief Returns the high 64 bits of the 128-bit product of _a and _b.
+     */
+    inline std::uint64_t multiply_high64(std::uint64_t _a, std::uint64_t _b) {
+        const std::uint64_t a_low = _a & UINT64_C(0xFFFFFFFF), a_high = _a >> 32;
+        const std::uint64_t b_low = _b & UINT64_C(0xFFFFFFFF), b_high = _b >> 32;
+        const std::uint64_t low_low = a_low * b_low, high_low = a_high * b_low, low_high = a_low * b_high;
+        const std::uint64_t cross = (low_low >> 32) + (high_low & UINT64_C(0xFFFFFFFF)) + low_high;
+        return a_high * b_high + (high_low >> 32) + (cross >> 32);
+    }
+
+    /**
+     * @brief Maps the 24 high bits of _word to a float in [0, 1).
+     */
+    inline float unit_float(std::uint32_t _word) {
+        return static_cast<float>(_word >> 8) * 5.9604644775390625e-8f;
+    }
+
+    /**
+     * @brief Maps the 53 high bits of the 64-bit word made of _low and _high to a double in [0, 1).
+     */
+    inline double unit_double(std::uint32_t _low, std::uint32_t _high) {
+        return static_cast<double>(((static_cast<std::uint64_t>(_high) << 32) | _low) >> 11) * 1.1102230246251565e-16;
+    }
+
+    /**
+     * @brief Number of words the uniform values of Real in [0, 1) take, without a conversion for types other than
+     *        float and double.
+     */
+    template <typename Real>
+    struct unit_real {
+        static constexpr std::size_t words = 0;
+    };
+
+    template <>
+    struct unit_real<float> {
+        static constexpr std::size_t words = 1;
+
+        static float get(const std::uint32_t* _words) { return unit_float(_words[0]); }
+
+        //In (0, 1], for logarithms.
+        static float positive(const std::uint32_t* _words) { return 1.0f - unit_float(_words[0]); }
+    };
+
+    template <>
+    struct unit_real<double> {
+        static constexpr std::size_t words = 2;
+
+        static double get(const std::uint32_t* _words) { return unit_double(_words[0], _words[1]); }
+        static double positive(const std::uint32_t* _words) { return 1.0 - unit_double(_words[0], _words[1]); }
+    };
+
+    /**
+     * @brief How generate_random() turns the words of Philox4x32 into values of Distribution: element i takes the
+     *        words words * i to words * (i + 1) of the stream of counters, pairs of elements 2i and 2i + 1 taking
+     *        theirs together when paired. Specialized for the distributions of <random> it computes directly; every
+     *        other distribution draws each element from an engine of its own.
+     */
+    template <typename Distribution>
+    struct counter_distribution {
+        static constexpr bool direct = false;
+    };
+
+    template <typename Real>
+    struct counter_distribution<std::uniform_real_distribution<Real>> {
+        static constexpr bool direct = std::is_same<Real, float>::value || std::is_same<Real, double>::value;
+        static constexpr std::size_t words = unit_real<Real>::words;
+        static constexpr bool paired = false;
+
+        template <typename T>
+        static void generate(const std::uniform_real_distribution<Real>& _distribution, const std::uint32_t* _words,
+                             std::size_t _n, T* _out) {
+            const Real a = _distribution.a(), width = _distribution.b() - _distribution.a();
+
+            for (std::size_t i = 0; i < _n; ++i) {
+                _out[i] = static_cast<T>(a + width * unit_real<Real>::get(_words + words * i));
+            }
+        }
+    };
+
+    /**
+     * @brief Uniform integers from the high 64 bits of the product of a 64-bit word and the width of the interval,
+     *        without rejection, so that the probability of any value differs from the exact one by less than
+     *        width / 2^64.
+     */
+    template <typename Integer>
+    struct counter_distribution<std::uniform_int_distribution<Integer>> {
+        static constexpr bool direct = sizeof(Integer) <= sizeof(std::uint64_t);
+        static constexpr std::size_t words = 2;
+        static constexpr bool paired = false;
+
+        template <typename T>
+        static void generate(const std::uniform_int_distribution<Integer>& _distribution, const std::uint32_t* _words,
+                             std::size_t _n, T* _out) {
+            const std::uint64_t a = static_cast<std::uint64_t>(_distribution.a());
+            const std::uint64_t width = static_cast<std::uint64_t>(_distribution.b()) - a + 1;
+
+            for (std::size_t i = 0; i < _n; ++i) {
+                const std::uint64_t bits = (static_cast<std::uint64_t>(_words[2 * i + 1]) << 32) | _words[2 * i];
+                _out[i] = static_cast<T>(static_cast<Integer>(a + (width ? multiply_high64(bits, width) : bits)));
+            }
+        }
+    };
+
+    /**
+     * @brief Normal values by the Box-Muller transform, which turns the two uniform values of a pair of elements into
+     *        two independent normal ones.
+     */
+    template <typename Real>
+    struct counter_distribution<std::normal_distribution<Real>> {
+        static constexpr bool direct = std::is_same<Real, float>::value || std::is_same<Real, double>::value;
+        static constexpr std::size_t words = unit_real<Real>::words;
+        static constexpr bool paired = true;
+
+        template <typename T>
+        static void generate(const std::normal_distribution<Real>& _distribution, const std::uint32_t* _words,
+                             std::size_t _n, T* _out) {
+            const Real mean = _distribution.mean(), stddev = _distribution.stddev();
+            const Real two_pi = static_cast<Real>(6.283185307179586);
+
+            for (std::size_t i = 0; i < _n; i += 2) {
+                const Real radius = stddev * std::sqrt(-2 * std::log(unit_real<Real>::positive(_words + words * i)));
+                const Real angle = two_pi * unit_real<Real>::get(_words + words * (i + 1));
+                _out[i] = static_cast<T>(mean + radius * std::cos(angle));
+
+                if (i + 1 < _n) {
+                    _out[i + 1] = static_cast<T>(mean + radius * std::sin(angle));
+                }
+            }
+        }
+    };
+
+    template <typename Real>
+    struct counter_distribution<std::exponential_distribution<Real>> {
+        static constexpr bool direct = std::is_same<Real, float>::value || std::is_same<Real, double>::value;
+        static constexpr std::size_t words = unit_real<Real>::words;
+        static constexpr bool paired = false;
+
+        template <typename T>
+        static void generate(const std::exponential_distribution<Real>& _distribution, const std::uint32_t* _words,
+                             std::size_t _n, T* _out) {
+            const Real scale = 1 / _distribution.lambda();
+
+            for (std::size_t i = 0; i < _n; ++i) {
+                _out[i] = static_cast<T>(-scale * std::log(unit_real<Real>::positive(_words + words * i)));
+            }
+        }
+    };
+
+    template <>
+    struct counter_distribution<std::bernoulli_distribution> {
+        static constexpr bool direct = true;
+        static constexpr std::size_t words = 1;
+        static constexpr bool paired = false;
+
+        template <typename T>
+        static void generate(const std::bernoulli_distribution& _distribution, const std::uint32_t* _words,
+                             std::size_t _n, T* _out) {
+            const double p = _distribution.p();
+
+            for (std::size_t i = 0; i < _n; ++i) {
+                _out[i] = static_cast<T>(static_cast<double>(_words[i]) * 2.3283064365386963e-10 < p);
+            }
+        }
+    };
+
+    /**
+     * @brief Number of elements generate_random() converts at a time, from the words of one call of
+     *        simd::philox4x32().
+     */
+    constexpr std::size_t random_block = 256;
+
+    /**
+     * @brief The index of the first element of a range passed to generate_random_at() must be a multiple of
+     *        random_alignment, so that every piece of a range starts at the first word of a counter.
+     */
+    constexpr std::size_t random_alignment = 4;
+
+    template <typename T, typename Distribution>
+    void generate_random_at(T* _out, std::size_t _n, const Distribution& _distribution, std::uint64_t _seed,
+                            std::uint64_t _first, std::true_type) {
+        using traits = counter_distribution<Distribution>;
+
+        std::uint32_t words[2 * random_block + 4];
+
+        for (std::size_t done = 0; done < _n; done += random_block) {
+            const std::size_t n = std::min(random_block, _n - done);
+            const std::size_t drawn = traits::paired ? n + (n & 1) : n;
+            const std::uint64_t first_word = (_first + done) * traits::words;
+
+            simd::philox4x32(_seed, 0, first_word / 4, (drawn * traits::words + 3) / 4, words);
+            traits::generate(_distribution, words, n, _out + done);
+        }
+    }
+
+    template <typename T, typename Distribution>
+    void generate_random_at(T* _out, std::size_t _n, const Distribution& _distribution, std::uint64_t _seed,
+                            std::uint64_t _first, std::false_type) {
+        Distribution distribution(_distribution);
+
+        //Element i draws from the stream i + 1, stream 0 being that of the distributions computed directly, and the
+        //distribution forgets values it kept from the previous element.
+        for (std::size_t i = 0; i < _n; ++i) {
+            philox_engine engine(_seed, _first + i + 1);
+            distribution.reset();
+            _out[i] = static_cast<T>(distribution(engine));
+        }
+    }
+
+    /**
+     * @brief Fills the contiguous range _range with values of _distribution as the elements at the indices _first,
+     *        _first + 1, ... of a range filled by generate_random(range, _distribution, _seed), so that pieces of a
+     *        larger range can be filled independently, on any thread or process, with the same result. Throws
+     *        std::invalid_argument if _first is not a multiple of random_alignment.
+     */
+    template <typename Iterator, typename Sentinel, typename Distribution>
+    void generate_random_at(const iterator_range<Iterator, Sentinel>& _range, const Distribution& _distribution,
+                            std::uint64_t _seed, std::uint64_t _first) {
+        static_assert(is_contiguous_iterator<Iterator>::value && is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "generate_random requires a contiguous range whose size is known in constant time");
+
+        using traits = counter_distribution<Distribution>;
+
+        if (_first % random_alignment != 0) {
+            throw std::invalid_argument("generate_random_at: the first index must be a multiple of random_alignment");
+        }
+
+        generate_random_at(IteratorBasedForImpl::to_address(_range.begin()), _range.size(), _distribution, _seed,
+                           _first, std::integral_constant<bool, traits::direct>());
+    }
+
+    /**
+     * @brief Fills the contiguous range _range with values of _distribution drawn from the counter-based generator
+     *        Philox4x32 under the key _seed. Every element depends on _seed, _distribution and its index only, so
+     *        pieces of the range can be filled independently, and in parallel, with the same result. The uniform,
+     *        normal and exponential distributions of float and double, uniform_int_distribution and
+     *        bernoulli_distribution are computed from a vector of counters at a time; any other distribution is
+     *        called with a philox_engine of its own per element.
+     */
+    template <typename Iterator, typename Sentinel, typename Distribution>
+    void generate_random(const iterator_range<Iterator, Sentinel>& _range, const Distribution& _distribution,
+                         std::uint64_t _seed) {
+        generate_random_at(_range, _distribution, _seed, 0);
+    }
+
+    namespace execution
+    {
+
+        /**
+         * @brief Requests that fill(), transform() and copy() write contiguous outputs of trivially copyable elements
+         *        with non-temporal stores, so that rewriting a large buffer does not evict the data the program is
+         *        still working on from the cache. Outputs smaller than threshold() bytes are written normally.
+         */
+        class streaming_policy {
+        private:
+            std::size_t m_threshold;
+
+        public:
+            constexpr explicit streaming_policy(std::size_t _threshold = 0) : m_threshold(_threshold) { }
+
+            /**
+             * @brief Returns a copy of this policy that streams outputs of at least _bytes bytes.
+             */
+            constexpr streaming_policy above(std::size_t _bytes) const { return streaming_policy(_bytes); }
+
+            /**
+             * @brief Returns a copy of this policy that streams outputs larger than the last level cache.
+             */
+            streaming_policy automatic() const { return streaming_policy(last_level_cache_size()); }
+
+            constexpr std::size_t threshold() const { return m_threshold; }
+        };
+
+        constexpr streaming_policy streaming;
+
+    } // namespace execution
+
+    /**
+     * @brief Size of the cache-resident buffer the streaming algorithms assemble output in before streaming it out.
+     */
+    constexpr std::size_t streaming_block_bytes = 4096;
+
+    /**
+     * @brief Writes _n elements of type T to _out with non-temporal stores, a block at a time. _produce(_block,
+     *        _first, _count) stores the elements with indices [_first, _first + _count) into the raw buffer _block.
+     */
+    template <typename T, typename Produce>
+    void stream_elements(T* _out, std::size_t _n, Produce _produce) {
+        constexpr std::size_t block_elements = streaming_block_bytes / sizeof(T) ? streaming_block_bytes / sizeof(T) : 1;
+        alignas(64) unsigned char block[block_elements * sizeof(T)];
+
+        for (std::size_t first = 0; first < _n; first += block_elements) {
+            const std::size_t count = std::min(block_elements, _n - first);
+            _produce(block, first, count);
+            simd::stream_copy(_out + first, block, count * sizeof(T));
+        }
+    }
+
+    /**
+     * @brief Checks whether the streaming algorithms can write to OutputIterator with non-temporal stores.
+     */
+    template <typename OutputIterator>
+    struct is_streamable_output {
+        template <typename O, typename T = typename std::remove_reference<typename std::iterator_traits<O>::reference>::type>
+        static constexpr auto check(int) -> std::integral_constant<bool,
+                is_contiguous_iterator<O>::value && !std::is_const<T>::value && std::is_trivially_copyable<T>::value>;
+
+        template <typename>
+        static constexpr std::false_type check(...);
+
+        static constexpr bool value = simd::has_streaming_stores() && decltype(check<OutputIterator>(0))::value;
+    };
+
+    template <typename Iterator, typename Sentinel, typename T>
+    void fill_streaming(const execution::streaming_policy&, const iterator_range<Iterator, Sentinel>& _range,
+                        const T& _value, std::false_type) {
+        fill(_range, _value);
+    }
+
+    template <typename Iterator, typename Sentinel, typename T>
+    void fill_streaming(const execution::streaming_policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                        const T& _value, std::true_type) {
+        using element = typename std::remove_reference<typename std::iterator_traits<Iterator>::reference>::type;
+        const std::size_t n = _range.size();
+
+        if (n * sizeof(element) < _policy.threshold()) {
+            fill(_range, _value);
+            return;
+        }
+
+        const element value = _value;
+
+        stream_elements(IteratorBasedForImpl::to_address(_range.begin()), n,
+                        [&value](unsigned char* _block, std::size_t _first, std::size_t _count) {
+            //Every block holds the same values and the first one is the largest, so the buffer is filled only once.
+            if (_first != 0) {
+                return;
+            }
+
+            for (std::size_t i = 0; i < _count; ++i) {
+                std::memcpy(_block + i * sizeof(element), &value, sizeof(element));
+            }
+        });
+    }
+
+    /**
+     * @brief Assigns _value to every element of _range, with non-temporal stores if the range is contiguous, holds
+     *        trivially copyable elements and spans at least _policy.threshold() bytes.
+     */
+    template <typename Iterator, typename Sentinel, typename T>
+    void fill(const execution::streaming_policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+              const T& _value) {
+        fill_streaming(_policy, _range, _value, std::integral_constant<bool,
+                       is_streamable_output<Iterator>::value && is_sized_sentinel_for<Sentinel, Iterator>::value>());
+    }
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename F>
+    OutputIterator transform_streaming(const execution::streaming_policy&,
+                                       const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out, F& _f,
+                                       std::false_type) {
+        return transform(_range, std::move(_out), std::ref(_f));
+    }
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename F>
+    OutputIterator transform_streaming(const execution::streaming_policy& _policy,
+                                       const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out, F& _f,
+                                       std::true_type) {
+        using element = typename std::remove_reference<typename std::iterator_traits<OutputIterator>::reference>::type;
+        const std::size_t n = _range.size();
+
+        if (n * sizeof(element) < _policy.threshold()) {
+            return transform(_range, std::move(_out), std::ref(_f));
+        }
+
+        Iterator in = _range.begin();
+
+        stream_elements(IteratorBasedForImpl::to_address(_out), n,
+                        [&in, &_f](unsigned char* _block, std::size_t, std::size_t _count) {
+            for (std::size_t i = 0; i < _count; ++i) {
+                const element value = _f(*in);
+                std::memcpy(_block + i * sizeof(element), &value, sizeof(element));
+                ++in;
+            }
+        });
+
+        return advanced(_out, n);
+    }
+
+    /**
+     * @brief Writes _f applied to every element of _range to the output starting at _out and returns the end of the
+     *        output. The results are assembled in a small cache-resident buffer and written to the output with
+     *        non-temporal stores if the output is contiguous, holds trivially copyable elements and receives at least
+     *        _policy.threshold() bytes. The output must not overlap the range.
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename F>
+    OutputIterator transform(const execution::streaming_policy& _policy,
+                             const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out, F _f) {
+        return transform_streaming(_policy, _range, std::move(_out), _f, std::integral_constant<bool,
+                                   is_streamable_output<OutputIterator>::value
+                                   && is_sized_sentinel_for<Sentinel, Iterator>::value>());
+    }
+
+    /**
+     * @brief Copies the elements of _range to the output starting at _out like copy(_range, _out), with
+     *        non-temporal stores from _policy.threshold() bytes on rather than from streaming_threshold().
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator>
+    OutputIterator copy(const execution::streaming_policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                        OutputIterator _out) {
+        return copy_dispatch(_range, std::move(_out), copy_element(), _policy.threshold());
+    }
+
+    /**
+     * @brief Share of the budget of resumable_range::resume_for() that the elements processed between two looks at
+     *        the clock should take, as a divisor: the call overruns its budget by at most about this share.
+     */
+    constexpr unsigned resumable_clock_checks = 16;
+
+    /**
+     * @brief Loop over an iterator_range that can be suspended after a number of elements or a time budget and
+     *        resumed later, for event loops that must not block for long. The state of the loop is the position in
+     *        the range, so iterators of adaptors carry their own state over to the next call, and remaining() is the
+     *        part of the range still to be processed.
+     *
+     *        resume_for() reads the clock after every few elements only. It learns how many elements fit into a
+     *        sixteenth of its budget and keeps that number for the next call, so cheap elements are not slowed down
+     *        by the clock and expensive ones do not overrun the budget by more than about one sixteenth.
+     */
+    template <typename Iterator, typename Sentinel = Iterator>
+    class resumable_range {
+    public:
+        using clock = std::chrono::steady_clock;
+
+    private:
+        Iterator m_position;
+        Sentinel m_end;
+        std::size_t m_stride;
+
+    public:
+        explicit resumable_range(const iterator_range<Iterator, Sentinel>& _range) :
+                m_position(_range.begin()), m_end(_range.end()), m_stride(1) {
+        }
+
+        /**
+         * @brief Checks whether every element has been processed.
+         */
+        bool done() const { return !(m_position != m_end); }
+
+        /**
+         * @brief Returns the elements that have not been processed yet.
+         */
+        iterator_range<Iterator, Sentinel> remaining() const {
+            return iterator_range<Iterator, Sentinel>(m_position, m_end);
+        }
+
+        /**
+         * @brief Returns the number of elements resume_for() processes between two looks at the clock.
+         */
+        std::size_t stride() const { return m_stride; }
+
+        /**
+         * @brief Calls _f on at most _elements further elements in order. Returns true if elements remain.
+         */
+        template <typename F>
+        bool resume(std::size_t _elements, F _f) {
+            for (; _elements != 0 && m_position != m_end; --_elements, ++m_position) {
+                _f(*m_position);
+            }
+
+            return !done();
+        }
+
+        /**
+         * @brief Calls _f on further elements in order until _budget has elapsed. Returns true if elements remain.
+         *        At least one element is processed whenever one remains.
+         */
+        template <typename Rep, typename Period, typename F>
+        bool resume_for(const std::chrono::duration<Rep, Period>& _budget, F _f) {
+            const clock::time_point start = clock::now();
+            const clock::time_point deadline = start + std::chrono::duration_cast<clock::duration>(_budget);
+            const clock::duration slice = std::chrono::duration_cast<clock::duration>(_budget) / resumable_clock_checks;
+            clock::time_point last = start;
+
+            while (m_position != m_end) {
+                for (std::size_t i = 0; i != m_stride && m_position != m_end; ++i, ++m_position) {
+                    _f(*m_position);
+                }
+
+                const clock::time_point now = clock::now();
+                const clock::duration elapsed = now - last;
+                last = now;
+
+                if (elapsed * 2 < slice) {
+                    m_stride *= 2;
+                } else if (elapsed > slice && m_stride > 1) {
+                    m_stride /= 2;
+                }
+
+                if (now >= deadline) {
+                    break;
+                }
+            }
+
+            return !done();
+        }
+    };
+
+    /**
+     * @brief Returns a resumable_range over _range.
+     */
+    template <typename Iterator, typename Sentinel>
+    resumable_range<Iterator, Sentinel> make_resumable(const iterator_range<Iterator, Sentinel>& _range) {
+        return resumable_range<Iterator, Sentinel>(_range);
+    }
+
+    template <typename Iterator, typename Sentinel>
+    Iterator end_of_run(const Iterator& _first, const Sentinel& _end, std::size_t& _count, std::false_type) {
+        Iterator last = _first;
+        _count = 1;
+
+        while (++last != _end && *last == *_first) {
+            ++_count;
+        }
+
+        return last;
+    }
+
+    template <typename Iterator, typename Sentinel>
+    Iterator end_of_run(const Iterator& _first, const Sentinel& _end, std::size_t& _count, std::true_type) {
+        Iterator last = simd::find_not(iterator_range<Iterator, Sentinel>(_first, _end), *_first);
+        _count = static_cast<std::size_t>(last - _first);
+
+        return last;
+    }
+
+    /**
+     * @brief Iterates over the runs of equal adjacent elements of a range. Dereferencing yields the first element of
+     *        the current run, or, if Counted is true, a pair of it and the length of the run. Contiguous ranges of
+     *        arithmetic elements with a sized end find the end of a run with SIMD comparisons against its first
+     *        element; other ranges compare neighbours one at a time. Either way each element is visited once.
+     *
+     * As with group_iterator, the end iterator is a copy of the begin iterator flagged as past the end.
+     */
+    template <typename Iterator, typename Sentinel, bool Counted>
+    class run_iterator {
+    private:
+        Iterator m_first;
+        Iterator m_last;
+        Sentinel m_end;
+        std::size_t m_count;
+        bool m_past_end;
+
+        bool done() const { return m_past_end || !(m_first != m_end); }
+
+        void find_last() {
+            if (m_first != m_end) {
+                m_last = end_of_run(m_first, m_end, m_count, std::integral_constant<bool,
+                                    simd::is_kernel_range<Iterator, Sentinel>::value>());
+            } else {
+                m_count = 0;
+            }
+        }
+
+        typename std::iterator_traits<Iterator>::reference dereference(std::false_type) const { return *m_first; }
+
+        std::pair<typename std::iterator_traits<Iterator>::reference, std::size_t> dereference(std::true_type) const {
+            return std::pair<typename std::iterator_traits<Iterator>::reference, std::size_t>(*m_first, m_count);
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename std::conditional<Counted,
+                std::pair<typename std::iterator_traits<Iterator>::value_type, std::size_t>,
+                typename std::iterator_traits<Iterator>::value_type>::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = typename std::conditional<Counted,
+                std::pair<typename std::iterator_traits<Iterator>::reference, std::size_t>,
+                typename std::iterator_traits<Iterator>::reference>::type;
+
+        static_assert(std::is_base_of<std::forward_iterator_tag,
+                              typename std::iterator_traits<Iterator>::iterator_category>::value,
+                      "run_iterator requires a multi-pass iterator to compare a run with its first element");
+
+        run_iterator(Iterator _first, Sentinel _end, bool _past_end = false) :
+                m_first(_first),
+                m_last(std::move(_first)),
+                m_end(std::move(_end)),
+                m_count(0),
+                m_past_end(_past_end) {
+            if (!m_past_end) {
+                find_last();
+            }
+        }
+
+        reference operator*() const { return dereference(std::integral_constant<bool, Counted>()); }
+
+        /**
+         * @brief Returns the run as an iterator_range<Iterator>.
+         */
+        iterator_range<Iterator> run() const { return iterator_range<Iterator>(m_first, m_last); }
+
+        /**
+         * @brief Returns the number of elements of the run.
+         */
+        std::size_t count() const { return m_count; }
+
+        run_iterator& operator++() {
+            m_first = m_last;
+            find_last();
+            return *this;
+        }
+
+        run_iterator operator++(int) {
+            run_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const run_iterator& rhs) const {
+            return done() == rhs.done() && (done() || !(m_first != rhs.m_first));
+        }
+
+        bool operator!=(const run_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    template <bool Counted, typename Iterator, typename Sentinel>
+    iterator_range<run_iterator<Iterator, Sentinel, Counted>> make_runs(
+            const iterator_range<Iterator, Sentinel>& _range) {
+        run_iterator<Iterator, Sentinel, Counted> first(_range.begin(), _range.end());
+        run_iterator<Iterator, Sentinel, Counted> last(_range.begin(), _range.end(), true);
+
+        return iterator_range<run_iterator<Iterator, Sentinel, Counted>>(std::move(first), std::move(last));
+    }
+
+    /**
+     * @brief Returns a lazy range of the first element of every run of equal adjacent elements of _range, which over
+     *        sorted data are its distinct elements, without erasing or copying anything:
+     *
+     *        for (std::uint32_t id : unique((ids.begin(), ids.end()))) { ... }
+     */
+    template <typename Iterator, typename Sentinel>
+    iterator_range<run_iterator<Iterator, Sentinel, false>> unique(const iterator_range<Iterator, Sentinel>& _range) {
+        return make_runs<false>(_range);
+    }
+
+    /**
+     * @brief Returns a lazy run-length encoding of _range: a pair of the first element and the length of every run of
+     *        equal adjacent elements.
+     *
+     *        for (auto run : run_length((ids.begin(), ids.end()))) { out.write(run.first, run.second); }
+     */
+    template <typename Iterator, typename Sentinel>
+    iterator_range<run_iterator<Iterator, Sentinel, true>> run_length(
+            const iterator_range<Iterator, Sentinel>& _range) {
+        return make_runs<true>(_range);
+    }
+
+} // namespace IteratorBasedForImpl
+
+#endif // IteratorBasedForAlgorithm_H
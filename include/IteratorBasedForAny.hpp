@@ -0,0 +1,602 @@
+#ifndef IteratorBasedForAny_H
+#define IteratorBasedForAny_H
+
+#include <IteratorBasedFor.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace IteratorBasedForImpl
+{
+
+    /**
+     * @brief Iterator over a range whose Sentinel differs from Iterator, with an end iterator of the same type. The
+     *        end iterator is a copy of the begin iterator flagged as past the end, and an iterator compares equal to
+     *        it once it reaches the sentinel, so such ranges can be used where a single iterator type is needed.
+     */
+    template <typename Iterator, typename Sentinel>
+    class common_iterator {
+    public:
+        using iterator_category = typename std::conditional<
+                std::is_base_of<std::forward_iterator_tag,
+                                typename std::iterator_traits<Iterator>::iterator_category>::value,
+                std::forward_iterator_tag, std::input_iterator_tag>::type;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+        using pointer = typename std::iterator_traits<Iterator>::pointer;
+
+    private:
+        Iterator m_current;
+        Sentinel m_end;
+        bool m_past_end;
+
+        bool done() const { return m_past_end || !(m_current != m_end); }
+
+    public:
+        common_iterator(Iterator _current, Sentinel _end, bool _past_end = false) :
+                m_current(std::move(_current)), m_end(std::move(_end)), m_past_end(_past_end) {
+        }
+
+        reference operator*() const { return *m_current; }
+
+        common_iterator& operator++() {
+            ++m_current;
+            return *this;
+        }
+
+        common_iterator operator++(int) {
+            common_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const common_iterator& rhs) const {
+            return done() == rhs.done() && (done() || !(m_current != rhs.m_current));
+        }
+
+        bool operator!=(const common_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief Size of the storage inside an any_iterator. Iterators that fit, and are nothrow move constructible, are
+     *        stored without allocating.
+     */
+    constexpr std::size_t any_iterator_inline_size = 32;
+
+    /**
+     * @brief Number of elements any_iterator_range::for_each_batch copies per indirect call.
+     */
+    constexpr std::size_t any_iterator_batch_size = 64;
+
+    /**
+     * @brief Iterator of category Category over elements accessed as Reference that holds an iterator of any type
+     *        meeting these requirements. The operations on the held iterator go through a table of functions
+     *        instantiated once per iterator type, so code using an any_iterator is compiled once for all the ranges it
+     *        accepts, including ranges of libraries built separately.
+     *
+     *        Iterators of up to any_iterator_inline_size bytes are stored in the any_iterator itself; larger ones are
+     *        allocated. Two any_iterators may only be compared or subtracted if they hold iterators of the same type,
+     *        as the iterators of one range do.
+     */
+    template <typename Reference, typename Category = std::forward_iterator_tag, typename Difference = std::ptrdiff_t>
+    class any_iterator {
+    public:
+        using iterator_category = Category;
+        using value_type = typename std::remove_cv<typename std::remove_reference<Reference>::type>::type;
+        using difference_type = Difference;
+        using reference = Reference;
+        using pointer = typename std::remove_reference<Reference>::type*;
+
+        /**
+         * @brief Type of the elements as seen through contiguous(): the referenced type, or const value_type if
+         *        Reference is not a reference.
+         */
+        using element_type = typename std::conditional<std::is_reference<Reference>::value,
+                                                       typename std::remove_reference<Reference>::type,
+                                                       const value_type>::type;
+
+    private:
+        template <typename Tag>
+        using has_category = std::is_base_of<Tag, Category>;
+
+        /**
+         * @brief The operations on a held iterator. Those the category does not provide are null.
+         */
+        struct operations {
+            void (*copy)(void*, const void*);
+            void (*move)(void*, void*);
+            void (*destroy)(void*);
+            Reference (*dereference)(const void*);
+            void (*increment)(void*);
+            bool (*equal)(const void*, const void*);
+            void (*decrement)(void*);
+            void (*advance)(void*, Difference);
+            Difference (*distance)(const void*, const void*);
+            std::size_t (*next_batch)(void*, const void*, value_type*, std::size_t);
+            element_type* (*address)(const void*);
+        };
+
+        /**
+         * @brief Stores an Iterator in the inline storage.
+         */
+        template <typename Iterator>
+        struct inline_holder {
+            using type = Iterator;
+
+            static Iterator& get(void* _storage) { return *static_cast<Iterator*>(_storage); }
+            static const Iterator& get(const void* _storage) { return *static_cast<const Iterator*>(_storage); }
+
+            static void create(void* _storage, Iterator _it) { new (_storage) Iterator(std::move(_it)); }
+            static void copy(void* _storage, const void* _source) { new (_storage) Iterator(get(_source)); }
+            static void move(void* _storage, void* _source) { new (_storage) Iterator(std::move(get(_source))); }
+            static void destroy(void* _storage) { get(_storage).~Iterator(); }
+        };
+
+        /**
+         * @brief Stores a pointer to an allocated Iterator in the inline storage.
+         */
+        template <typename Iterator>
+        struct allocated_holder {
+            using type = Iterator;
+
+            static Iterator& get(void* _storage) { return **static_cast<Iterator**>(_storage); }
+            static const Iterator& get(const void* _storage) { return **static_cast<Iterator* const*>(_storage); }
+
+            static void create(void* _storage, Iterator _it) { new (_storage) Iterator*(new Iterator(std::move(_it))); }
+            static void copy(void* _storage, const void* _source) { create(_storage, get(_source)); }
+
+            static void move(void* _storage, void* _source) {
+                new (_storage) Iterator*(*static_cast<Iterator**>(_source));
+                *static_cast<Iterator**>(_source) = nullptr;
+            }
+
+            static void destroy(void* _storage) { delete *static_cast<Iterator**>(_storage); }
+        };
+
+        template <typename Holder>
+        static std::size_t next_batch(void* _storage, const void* _last, value_type* _out, std::size_t _n,
+                                      std::random_access_iterator_tag) {
+            typename Holder::type& it = Holder::get(_storage);
+            const std::size_t count = (std::min)(_n, static_cast<std::size_t>(Holder::get(_last) - it));
+            typename Holder::type stop = it;
+            stop += static_cast<typename std::iterator_traits<typename Holder::type>::difference_type>(count);
+            std::copy(it, stop, _out);
+            it = stop;
+            return count;
+        }
+
+        template <typename Holder>
+        static std::size_t next_batch(void* _storage, const void* _last, value_type* _out, std::size_t _n,
+                                      std::input_iterator_tag) {
+            typename Holder::type& it = Holder::get(_storage);
+            const typename Holder::type& last = Holder::get(_last);
+            std::size_t count = 0;
+
+            for (; count < _n && it != last; ++count) {
+                _out[count] = *it;
+                ++it;
+            }
+
+            return count;
+        }
+
+        template <typename Holder>
+        static element_type* address(const void* _storage, std::true_type) {
+            return IteratorBasedForImpl::to_address(Holder::get(_storage));
+        }
+
+        template <typename Holder>
+        static element_type* address(const void*, std::false_type) {
+            return nullptr;
+        }
+
+        /**
+         * @brief Checks whether the elements of an Iterator can be viewed directly as a span of element_type.
+         */
+        template <typename Iterator>
+        struct exposes_elements : std::integral_constant<bool,
+                is_contiguous_iterator<Iterator>::value
+                && std::is_same<typename std::iterator_traits<Iterator>::value_type, value_type>::value
+                && std::is_convertible<decltype(IteratorBasedForImpl::to_address(std::declval<const Iterator&>())),
+                                       element_type*>::value> {
+        };
+
+        template <typename Holder>
+        static void decrement(void* _storage, std::true_type) { --Holder::get(_storage); }
+
+        template <typename Holder>
+        static void advance(void* _storage, Difference _n, std::true_type) {
+            using iterator_difference = typename std::iterator_traits<
+                    typename std::decay<decltype(Holder::get(_storage))>::type>::difference_type;
+            Holder::get(_storage) += static_cast<iterator_difference>(_n);
+        }
+
+        template <typename Holder>
+        static Difference distance(const void* _from, const void* _to, std::true_type) {
+            return static_cast<Difference>(Holder::get(_to) - Holder::get(_from));
+        }
+
+        template <typename Holder>
+        static const operations& operations_for(std::false_type, std::false_type) {
+            static const operations table = {&Holder::copy, &Holder::move, &Holder::destroy,
+                                             [](const void* _storage) -> Reference { return *Holder::get(_storage); },
+                                             [](void* _storage) { ++Holder::get(_storage); },
+                                             [](const void* _lhs, const void* _rhs) {
+                                                 return !(Holder::get(_lhs) != Holder::get(_rhs));
+                                             },
+                                             nullptr, nullptr, nullptr,
+                                             [](void* _storage, const void* _last, value_type* _out, std::size_t _n) {
+                                                 return next_batch<Holder>(
+                                                         _storage, _last, _out, _n,
+                                                         typename std::iterator_traits<
+                                                                 typename Holder::type>::iterator_category());
+                                             },
+                                             [](const void* _storage) {
+                                                 return address<Holder>(
+                                                         _storage, exposes_elements<typename Holder::type>());
+                                             }};
+            return table;
+        }
+
+        template <typename Holder>
+        static const operations& operations_for(std::true_type, std::false_type) {
+            static const operations table = [] {
+                operations result = operations_for<Holder>(std::false_type(), std::false_type());
+                result.decrement = [](void* _storage) { decrement<Holder>(_storage, std::true_type()); };
+                return result;
+            }();
+            return table;
+        }
+
+        template <typename Holder>
+        static const operations& operations_for(std::true_type, std::true_type) {
+            static const operations table = [] {
+                operations result = operations_for<Holder>(std::true_type(), std::false_type());
+                result.advance = [](void* _storage, Difference _n) { advance<Holder>(_storage, _n, std::true_type()); };
+                result.distance = [](const void* _from, const void* _to) {
+                    return distance<Holder>(_from, _to, std::true_type());
+                };
+                return result;
+            }();
+            return table;
+        }
+
+        alignas(std::max_align_t) unsigned char m_storage[any_iterator_inline_size];
+        const operations* m_operations;
+
+        template <typename Iterator>
+        void assign(Iterator _it, std::true_type) {
+            inline_holder<Iterator>::create(m_storage, std::move(_it));
+            m_operations = &operations_for<inline_holder<Iterator>>(has_category<std::bidirectional_iterator_tag>(),
+                                                                     has_category<std::random_access_iterator_tag>());
+        }
+
+        template <typename Iterator>
+        void assign(Iterator _it, std::false_type) {
+            allocated_holder<Iterator>::create(m_storage, std::move(_it));
+            m_operations = &operations_for<allocated_holder<Iterator>>(has_category<std::bidirectional_iterator_tag>(),
+                                                                        has_category<std::random_access_iterator_tag>());
+        }
+
+        void reset() {
+            if (m_operations) {
+                m_operations->destroy(m_storage);
+                m_operations = nullptr;
+            }
+        }
+
+    public:
+        /**
+         * @brief Checks whether an Iterator is stored without allocating.
+         */
+        template <typename Iterator>
+        static constexpr bool stores_inline() {
+            return sizeof(Iterator) <= any_iterator_inline_size && alignof(Iterator) <= alignof(std::max_align_t)
+                   && std::is_nothrow_move_constructible<Iterator>::value;
+        }
+
+        /**
+         * @brief Creates a singular iterator, which may only be assigned to or destroyed.
+         */
+        any_iterator() : m_storage(), m_operations(nullptr) { }
+
+        /**
+         * @brief Creates an any_iterator holding a copy of _it, whose category must include Category and whose
+         *        reference must convert to Reference.
+         */
+        template <typename Iterator,
+                  typename std::enable_if<!std::is_same<typename std::decay<Iterator>::type, any_iterator>::value
+                                          && is_iterator<typename std::decay<Iterator>::type>::value, int>::type = 0>
+        any_iterator(Iterator&& _it) : m_storage(), m_operations(nullptr) {
+            using iterator = typename std::decay<Iterator>::type;
+
+            static_assert(std::is_base_of<Category, typename std::iterator_traits<iterator>::iterator_category>::value,
+                          "the iterator does not provide the category of the any_iterator");
+            static_assert(std::is_convertible<typename std::iterator_traits<iterator>::reference, Reference>::value,
+                          "the reference of the iterator does not convert to the reference of the any_iterator");
+
+            assign(iterator(std::forward<Iterator>(_it)),
+                   std::integral_constant<bool, stores_inline<iterator>()>());
+        }
+
+        any_iterator(const any_iterator& other) : m_storage(), m_operations(other.m_operations) {
+            if (m_operations) {
+                m_operations->copy(m_storage, other.m_storage);
+            }
+        }
+
+        any_iterator(any_iterator&& other) noexcept : m_storage(), m_operations(other.m_operations) {
+            if (m_operations) {
+                m_operations->move(m_storage, other.m_storage);
+            }
+        }
+
+        any_iterator& operator=(const any_iterator& other) {
+            if (this != &other) {
+                reset();
+
+                if (other.m_operations) {
+                    other.m_operations->copy(m_storage, other.m_storage);
+                    m_operations = other.m_operations;
+                }
+            }
+
+            return *this;
+        }
+
+        any_iterator& operator=(any_iterator&& other) noexcept {
+            if (this != &other) {
+                reset();
+
+                if (other.m_operations) {
+                    other.m_operations->move(m_storage, other.m_storage);
+                    m_operations = other.m_operations;
+                }
+            }
+
+            return *this;
+        }
+
+        ~any_iterator() { reset(); }
+
+        Reference operator*() const { return m_operations->dereference(m_storage); }
+
+        template <typename R = Reference, typename std::enable_if<std::is_reference<R>::value, int>::type = 0>
+        pointer operator->() const { return std::addressof(**this); }
+
+        /**
+         * @brief Copies the elements from this iterator on, up to _last and at most _n of them, to _out, advances past
+         *        them and returns their number. The copies take one indirect call rather than two per element.
+         */
+        std::size_t next_batch(const any_iterator& _last, value_type* _out, std::size_t _n) {
+            return m_operations ? m_operations->next_batch(m_storage, _last.m_storage, _out, _n) : 0;
+        }
+
+        /**
+         * @brief Returns the address of the element this iterator refers to if the held iterator is contiguous and its
+         *        value type is value_type, and nullptr otherwise.
+         */
+        element_type* contiguous() const {
+            return m_operations ? m_operations->address(m_storage) : nullptr;
+        }
+
+        any_iterator& operator++() {
+            m_operations->increment(m_storage);
+            return *this;
+        }
+
+        any_iterator operator++(int) {
+            any_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        template <typename C = Category,
+                  typename std::enable_if<std::is_base_of<std::bidirectional_iterator_tag, C>::value, int>::type = 0>
+        any_iterator& operator--() {
+            m_operations->decrement(m_storage);
+            return *this;
+        }
+
+        template <typename C = Category,
+                  typename std::enable_if<std::is_base_of<std::bidirectional_iterator_tag, C>::value, int>::type = 0>
+        any_iterator operator--(int) {
+            any_iterator previous = *this;
+            --*this;
+            return previous;
+        }
+
+        template <typename C = Category,
+                  typename std::enable_if<std::is_base_of<std::random_access_iterator_tag, C>::value, int>::type = 0>
+        any_iterator& operator+=(Difference _n) {
+            m_operations->advance(m_storage, _n);
+            return *this;
+        }
+
+        template <typename C = Category,
+                  typename std::enable_if<std::is_base_of<std::random_access_iterator_tag, C>::value, int>::type = 0>
+        any_iterator& operator-=(Difference _n) {
+            m_operations->advance(m_storage, -_n);
+            return *this;
+        }
+
+        template <typename C = Category,
+                  typename std::enable_if<std::is_base_of<std::random_access_iterator_tag, C>::value, int>::type = 0>
+        any_iterator operator+(Difference _n) const {
+            any_iterator result = *this;
+            result += _n;
+            return result;
+        }
+
+        template <typename C = Category,
+                  typename std::enable_if<std::is_base_of<std::random_access_iterator_tag, C>::value, int>::type = 0>
+        friend any_iterator operator+(Difference _n, const any_iterator& _it) {
+            return _it + _n;
+        }
+
+        template <typename C = Category,
+                  typename std::enable_if<std::is_base_of<std::random_access_iterator_tag, C>::value, int>::type = 0>
+        any_iterator operator-(Difference _n) const {
+            any_iterator result = *this;
+            result -= _n;
+            return result;
+        }
+
+        template <typename C = Category,
+                  typename std::enable_if<std::is_base_of<std::random_access_iterator_tag, C>::value, int>::type = 0>
+        Difference operator-(const any_iterator& rhs) const {
+            return m_operations->distance(rhs.m_storage, m_storage);
+        }
+
+        template <typename C = Category,
+                  typename std::enable_if<std::is_base_of<std::random_access_iterator_tag, C>::value, int>::type = 0>
+        Reference operator[](Difference _n) const {
+            return *(*this + _n);
+        }
+
+        bool operator==(const any_iterator& rhs) const {
+            return m_operations ? rhs.m_operations && m_operations->equal(m_storage, rhs.m_storage) : !rhs.m_operations;
+        }
+
+        bool operator!=(const any_iterator& rhs) const { return !(*this == rhs); }
+
+        template <typename C = Category,
+                  typename std::enable_if<std::is_base_of<std::random_access_iterator_tag, C>::value, int>::type = 0>
+        bool operator<(const any_iterator& rhs) const { return rhs - *this > 0; }
+
+        template <typename C = Category,
+                  typename std::enable_if<std::is_base_of<std::random_access_iterator_tag, C>::value, int>::type = 0>
+        bool operator>(const any_iterator& rhs) const { return rhs < *this; }
+
+        template <typename C = Category,
+                  typename std::enable_if<std::is_base_of<std::random_access_iterator_tag, C>::value, int>::type = 0>
+        bool operator<=(const any_iterator& rhs) const { return !(rhs < *this); }
+
+        template <typename C = Category,
+                  typename std::enable_if<std::is_base_of<std::random_access_iterator_tag, C>::value, int>::type = 0>
+        bool operator>=(const any_iterator& rhs) const { return !(*this < rhs); }
+    };
+
+    /**
+     * @brief Returns the end of _range as an iterator of the type of its begin: the end itself if the types match,
+     *        the begin advanced by the size for sized random access ranges, and otherwise a flagged common_iterator.
+     */
+    template <typename Iterator>
+    iterator_range<Iterator> make_common_range(const iterator_range<Iterator, Iterator>& _range, int) {
+        return _range;
+    }
+
+    template <typename Iterator, typename Sentinel,
+              typename std::enable_if<is_sized_sentinel_for<Sentinel, Iterator>::value, int>::type = 0>
+    iterator_range<Iterator> make_common_range(const iterator_range<Iterator, Sentinel>& _range, long) {
+        Iterator first = _range.begin();
+        return iterator_range<Iterator>(first, first + static_cast<typename std::iterator_traits<Iterator>::difference_type>(
+                _range.size()));
+    }
+
+    template <typename Iterator, typename Sentinel>
+    iterator_range<common_iterator<Iterator, Sentinel>> make_common_range(const iterator_range<Iterator, Sentinel>& _range,
+                                                                          ...) {
+        return iterator_range<common_iterator<Iterator, Sentinel>>(
+                common_iterator<Iterator, Sentinel>(_range.begin(), _range.end()),
+                common_iterator<Iterator, Sentinel>(_range.begin(), _range.end(), true));
+    }
+
+    /**
+     * @brief Range of any_iterator<Reference, Category>, which any iterator_range whose iterators provide Category
+     *        and whose elements convert to Reference converts to. A function taking an any_iterator_range is compiled
+     *        once and accepts ranges over vectors, deques, adaptors or the containers of another library without
+     *        copying their elements into a std::vector. Sized ranges of random access iterators keep their size.
+     *
+     *        void print_all(any_iterator_range<const std::string&> names);
+     *
+     *        print_all((names.begin(), names.end()));
+     *        print_all((tree.begin(), tree.end()));
+     */
+    template <typename Reference, typename Category = std::forward_iterator_tag>
+    class any_iterator_range : public iterator_range<any_iterator<Reference, Category>> {
+    private:
+        using base = iterator_range<any_iterator<Reference, Category>>;
+
+        template <typename Iterator>
+        static base erase(const iterator_range<Iterator, Iterator>& _range) {
+            return base(any_iterator<Reference, Category>(_range.begin()), any_iterator<Reference, Category>(_range.end()));
+        }
+
+    public:
+        using iterator = any_iterator<Reference, Category>;
+        using value_type = typename iterator::value_type;
+        using element_type = typename iterator::element_type;
+
+        /**
+         * @brief Creates an empty range.
+         */
+        any_iterator_range() : base(iterator(), iterator()) { }
+
+        template <typename Iterator, typename Sentinel>
+        any_iterator_range(const iterator_range<Iterator, Sentinel>& _range) :
+                base(erase(IteratorBasedForImpl::make_common_range(_range, 0))) {
+        }
+
+        /**
+         * @brief Checks whether the erased range is contiguous, so that contiguous() views its elements.
+         */
+        bool is_contiguous() const { return this->begin().contiguous() != nullptr; }
+
+        /**
+         * @brief Returns a span of the elements of a contiguous erased range, found with two indirect calls, or an
+         *        empty span if the range is not contiguous.
+         */
+        span<element_type> contiguous() const {
+            element_type* first = this->begin().contiguous();
+            return first ? span<element_type>(first, static_cast<std::size_t>(this->end().contiguous() - first))
+                         : span<element_type>();
+        }
+
+        /**
+         * @brief Calls _function with consecutive span<const value_type> batches covering the range: a single span
+         *        of the elements themselves if the range is contiguous, and otherwise copies of up to
+         *        any_iterator_batch_size elements, fetched with one indirect call per batch. value_type must be
+         *        default constructible.
+         */
+        template <typename Function>
+        void for_each_batch(Function _function) const {
+            element_type* first = this->begin().contiguous();
+
+            if (first) {
+                _function(span<const value_type>(first, static_cast<std::size_t>(this->end().contiguous() - first)));
+                return;
+            }
+
+            value_type batch[any_iterator_batch_size];
+            iterator it = this->begin();
+            const iterator last = this->end();
+
+            for (std::size_t count; (count = it.next_batch(last, batch, any_iterator_batch_size)) != 0;) {
+                _function(span<const value_type>(batch, count));
+            }
+        }
+
+        /**
+         * @brief Calls _function with a const value_type& to every element, in batches as for_each_batch. This is
+         *        the fast way to read an erased range; iterating it calls through the table twice per element.
+         */
+        template <typename Function>
+        void for_each(Function _function) const {
+            for_each_batch([&_function](span<const value_type> _batch) {
+                for (const value_type& element : _batch) {
+                    _function(element);
+                }
+            });
+        }
+    };
+
+} // namespace IteratorBasedForImpl
+
+#endif // IteratorBasedForAny_H
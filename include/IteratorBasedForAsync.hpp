@@ -0,0 +1,275 @@
+#ifndef IteratorBasedForAsync_H
+#define IteratorBasedForAsync_H
+
+#include <IteratorBasedForGenerator.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#if ITERATOR_BASED_FOR_HAS_COROUTINES
+namespace IteratorBasedForImpl
+{
+
+    /**
+     * @brief Queue feeding one consuming coroutine from any number of producer threads. Elements pushed while the
+     *        consumer is busy accumulate, and the consumer takes all of them at once, so a burst of elements costs a
+     *        single wakeup. A producer that pushes to an idle consumer resumes it on the producer's thread.
+     *
+     *        The consumer side (ready, suspend_unless_ready and take) is what async_iterator_range expects from a
+     *        source, so other sources, such as a socket polled by an event loop, can be iterated the same way.
+     */
+    template <typename T>
+    class async_channel {
+    public:
+        using value_type = T;
+
+    private:
+        std::mutex m_mutex;
+        std::vector<T> m_pending;
+        std::coroutine_handle<> m_waiter;
+        bool m_closed;
+
+        /**
+         * @brief Hands the waiting consumer, if any, to the caller, which resumes it after releasing the lock.
+         */
+        std::coroutine_handle<> release_waiter() {
+            return std::exchange(m_waiter, nullptr);
+        }
+
+        static void resume(std::coroutine_handle<> _waiter) {
+            if (_waiter) {
+                _waiter.resume();
+            }
+        }
+
+    public:
+        async_channel() : m_mutex(), m_pending(), m_waiter(nullptr), m_closed(false) { }
+
+        async_channel(const async_channel&) = delete;
+        async_channel& operator=(const async_channel&) = delete;
+
+        void push(T _value) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_pending.push_back(std::move(_value));
+            std::coroutine_handle<> waiter = release_waiter();
+            lock.unlock();
+            resume(waiter);
+        }
+
+        /**
+         * @brief Pushes the elements [_first, _last) with a single wakeup of the consumer.
+         */
+        template <typename Iterator>
+        void push(Iterator _first, Iterator _last) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_pending.insert(m_pending.end(), _first, _last);
+            std::coroutine_handle<> waiter = m_pending.empty() ? nullptr : release_waiter();
+            lock.unlock();
+            resume(waiter);
+        }
+
+        /**
+         * @brief Ends the iteration of the consumer once the elements already pushed have been taken.
+         */
+        void close() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_closed = true;
+            std::coroutine_handle<> waiter = release_waiter();
+            lock.unlock();
+            resume(waiter);
+        }
+
+        /**
+         * @brief Checks whether take would deliver elements or report the end without waiting.
+         */
+        bool ready() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return !m_pending.empty() || m_closed;
+        }
+
+        /**
+         * @brief Registers _consumer to be resumed by the next push or close and returns true, or returns false
+         *        without registering it if elements are already pending or the channel is closed.
+         */
+        bool suspend_unless_ready(std::coroutine_handle<> _consumer) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (!m_pending.empty() || m_closed) {
+                return false;
+            }
+
+            m_waiter = _consumer;
+            return true;
+        }
+
+        /**
+         * @brief Replaces the contents of _batch with every pending element. An empty batch means that the channel
+         *        is closed and drained.
+         */
+        void take(std::vector<T>& _batch) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            _batch.clear();
+            _batch.swap(m_pending);
+        }
+    };
+
+    template <typename Source>
+    class async_iterator_range;
+
+    /**
+     * @brief Iterator of an async_iterator_range. Dereferencing and comparing are ordinary, but the increment returns
+     *        an awaitable that suspends the coroutine only when the current batch is exhausted and the source has
+     *        nothing pending, so it is written co_await ++it. The end iterator compares equal to every iterator of a
+     *        range whose source is drained.
+     */
+    template <typename Source>
+    class async_iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = typename Source::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type&;
+        using pointer = value_type*;
+
+    private:
+        friend class async_iterator_range<Source>;
+
+        async_iterator_range<Source>* m_range;
+
+        explicit async_iterator(async_iterator_range<Source>* _range) : m_range(_range) { }
+
+    public:
+        async_iterator() : m_range(nullptr) { }
+
+        /**
+         * @brief Awaitable advancing the iterator. await_resume returns the iterator.
+         */
+        class increment {
+        private:
+            async_iterator* m_iterator;
+
+        public:
+            explicit increment(async_iterator* _iterator) : m_iterator(_iterator) { }
+
+            bool await_ready() { return m_iterator->m_range->advance(); }
+
+            bool await_suspend(std::coroutine_handle<> _consumer) {
+                return m_iterator->m_range->m_source->suspend_unless_ready(_consumer);
+            }
+
+            async_iterator& await_resume() {
+                m_iterator->m_range->refill();
+                return *m_iterator;
+            }
+        };
+
+        reference operator*() const { return m_range->m_batch[m_range->m_index]; }
+        pointer operator->() const { return &**this; }
+
+        increment operator++() { return increment(this); }
+
+        bool operator==(const async_iterator& rhs) const {
+            return (m_range && !m_range->m_done ? m_range : nullptr)
+                   == (rhs.m_range && !rhs.m_range->m_done ? rhs.m_range : nullptr);
+        }
+
+        bool operator!=(const async_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief Single-pass range over the elements of an asynchronous source, such as an async_channel, consumed by one
+     *        coroutine in the usual (begin, end) style with awaited increments:
+     *
+     *        async_iterator_range<async_channel<packet>> packets(channel);
+     *
+     *        for (auto it = co_await packets.begin(); it != packets.end(); co_await ++it) {
+     *            handle(*it);
+     *        }
+     *
+     *        The range takes every element the source holds at once and steps through them without suspending, so
+     *        the coroutine is resumed once per batch rather than once per element. batch() exposes the rest of the
+     *        current batch for loops that process it as a whole.
+     *
+     *        A Source provides value_type and the members ready(), suspend_unless_ready(handle) and
+     *        take(std::vector<value_type>&) of async_channel.
+     */
+    template <typename Source>
+    class async_iterator_range {
+    public:
+        using value_type = typename Source::value_type;
+        using iterator = async_iterator<Source>;
+
+    private:
+        friend class async_iterator<Source>;
+
+        Source* m_source;
+        std::vector<value_type> m_batch;
+        std::size_t m_index;
+        bool m_done;
+        iterator m_current;
+
+        /**
+         * @brief Steps to the next element of the batch. Returns true when no suspension is needed, because the
+         *        batch has another element or the source can deliver without waiting.
+         */
+        bool advance() {
+            return ++m_index < m_batch.size() || m_source->ready();
+        }
+
+        void refill() {
+            if (m_index < m_batch.size()) {
+                return;
+            }
+
+            m_source->take(m_batch);
+            m_index = 0;
+            m_done = m_batch.empty();
+        }
+
+    public:
+        explicit async_iterator_range(Source& _source) :
+                m_source(&_source), m_batch(), m_index(0), m_done(false), m_current(this) { }
+
+        async_iterator_range(const async_iterator_range&) = delete;
+        async_iterator_range& operator=(const async_iterator_range&) = delete;
+
+        /**
+         * @brief Awaitable returning the iterator to the first element, waiting for the source if it holds none.
+         */
+        typename iterator::increment begin() {
+            //The awaitable steps forward first, so step back from the current element.
+            if (m_index < m_batch.size()) {
+                --m_index;
+            }
+
+            return typename iterator::increment(&m_current);
+        }
+
+        iterator end() const { return iterator(); }
+
+        /**
+         * @brief The elements of the current batch from the current one on. Advancing past them with
+         *        skip_batch() processes a whole batch per iteration.
+         */
+        span<value_type> batch() {
+            return m_done ? span<value_type>() : span<value_type>(m_batch.data() + m_index, m_batch.size() - m_index);
+        }
+
+        /**
+         * @brief Moves the current position to the last element of the batch, so that the next increment fetches
+         *        the following batch.
+         */
+        void skip_batch() {
+            if (!m_batch.empty()) {
+                m_index = m_batch.size() - 1;
+            }
+        }
+    };
+
+} // namespace IteratorBasedForImpl
+#endif
+
+#endif
@@ -0,0 +1,413 @@
+#ifndef IteratorBasedForGenerator_H
+#define IteratorBasedForGenerator_H
+
+#include <IteratorBasedFor.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//Generators are written as C++20 coroutines, so this header provides them only when the compiler supports coroutines.
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define ITERATOR_BASED_FOR_HAS_COROUTINES 1
+#endif
+#endif
+
+#ifndef ITERATOR_BASED_FOR_HAS_COROUTINES
+#define ITERATOR_BASED_FOR_HAS_COROUTINES 0
+#endif
+
+#if ITERATOR_BASED_FOR_HAS_COROUTINES
+namespace IteratorBasedForImpl
+{
+
+    /**
+     * @brief Per-thread free lists of coroutine frames, one per size class of frame_pool::granularity bytes up to
+     *        frame_pool::max_pooled_bytes. A frame released to the pool is reused by the next generator of the same
+     *        size class created on that thread, so creating short-lived generators in a loop does not reach malloc
+     *        after the first few. Larger frames are allocated with operator new. A frame may be released on another
+     *        thread than the one that allocated it; it then joins the free list of the releasing thread.
+     */
+    class frame_pool {
+    public:
+        static constexpr std::size_t granularity = 64;
+        static constexpr std::size_t max_pooled_bytes = 4096;
+
+    private:
+        static constexpr std::size_t class_count = max_pooled_bytes / granularity;
+
+        struct free_frame {
+            free_frame* next;
+        };
+
+        free_frame* m_free[class_count];
+        std::size_t m_cached;
+
+        static std::size_t size_class(std::size_t _bytes) {
+            return (_bytes + granularity - 1) / granularity - 1;
+        }
+
+        frame_pool() : m_free(), m_cached(0) { }
+
+    public:
+        frame_pool(const frame_pool&) = delete;
+        frame_pool& operator=(const frame_pool&) = delete;
+
+        ~frame_pool() {
+            release_cached();
+        }
+
+        /**
+         * @brief Returns the pool of the calling thread.
+         */
+        static frame_pool& local() {
+            thread_local frame_pool pool;
+            return pool;
+        }
+
+        void* allocate(std::size_t _bytes) {
+            if (_bytes == 0 || _bytes > max_pooled_bytes) {
+                return ::operator new(_bytes);
+            }
+
+            const std::size_t index = size_class(_bytes);
+
+            if (free_frame* frame = m_free[index]) {
+                m_free[index] = frame->next;
+                --m_cached;
+                return frame;
+            }
+
+            return ::operator new((index + 1) * granularity);
+        }
+
+        void deallocate(void* _frame, std::size_t _bytes) noexcept {
+            if (_bytes == 0 || _bytes > max_pooled_bytes) {
+                ::operator delete(_frame);
+                return;
+            }
+
+            const std::size_t index = size_class(_bytes);
+            free_frame* frame = ::new (_frame) free_frame{m_free[index]};
+            m_free[index] = frame;
+            ++m_cached;
+        }
+
+        /**
+         * @brief Number of frames held in the free lists of this pool.
+         */
+        std::size_t cached() const { return m_cached; }
+
+        /**
+         * @brief Returns every cached frame to operator delete.
+         */
+        void release_cached() noexcept {
+            for (free_frame*& head : m_free) {
+                while (head) {
+                    free_frame* next = head->next;
+                    ::operator delete(head);
+                    head = next;
+                }
+            }
+
+            m_cached = 0;
+        }
+    };
+
+    /**
+     * @brief Where coroutine frames created on the current thread are allocated: allocate returns a block of at least
+     *        the requested size aligned for max_align_t and deallocate receives it back with the same size.
+     */
+    struct frame_source {
+        void* (*allocate)(void* _context, std::size_t _bytes);
+        void (*deallocate)(void* _context, void* _block, std::size_t _bytes);
+        void* context;
+    };
+
+    /**
+     * @brief The frame source installed on the calling thread, or nullptr when frames come from frame_pool::local().
+     */
+    inline const frame_source*& current_frame_source() {
+        thread_local const frame_source* source = nullptr;
+        return source;
+    }
+
+    /**
+     * @brief Every frame starts with the deallocation function of the source it came from, since operator delete of
+     *        a coroutine only receives the frame and its size.
+     */
+    struct frame_header {
+        void (*deallocate)(void*, void*, std::size_t);
+        void* context;
+    };
+
+    constexpr std::size_t frame_header_bytes = (sizeof(frame_header) + alignof(std::max_align_t) - 1)
+                                               / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    inline void deallocate_pooled_frame(void*, void* _block, std::size_t _bytes) {
+        frame_pool::local().deallocate(_block, _bytes);
+    }
+
+    inline void* allocate_frame(std::size_t _bytes) {
+        const frame_source* source = current_frame_source();
+        const std::size_t bytes = frame_header_bytes + _bytes;
+        void* block;
+        frame_header header;
+
+        if (source) {
+            block = source->allocate(source->context, bytes);
+            header = frame_header{source->deallocate, source->context};
+        } else {
+            block = frame_pool::local().allocate(bytes);
+            header = frame_header{&deallocate_pooled_frame, nullptr};
+        }
+
+        ::new (block) frame_header(header);
+        return static_cast<char*>(block) + frame_header_bytes;
+    }
+
+    inline void deallocate_frame(void* _frame, std::size_t _bytes) noexcept {
+        void* block = static_cast<char*>(_frame) - frame_header_bytes;
+        const frame_header header = *static_cast<frame_header*>(block);
+        header.deallocate(header.context, block, frame_header_bytes + _bytes);
+    }
+
+    /**
+     * @brief Makes the coroutine frames created on the calling thread during its lifetime come from a copy of
+     *        _allocator, e.g. one drawing from an arena owned by the request being served, and restores the previous
+     *        source when destroyed. The frames are returned to the same allocator whenever they are destroyed, so the
+     *        scope must outlive the generators created in it.
+     */
+    template <typename Allocator>
+    class scoped_frame_allocator {
+    private:
+        using byte_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::max_align_t>;
+        using traits = std::allocator_traits<byte_allocator>;
+
+        byte_allocator m_allocator;
+        frame_source m_source;
+        const frame_source* m_previous;
+
+        static std::size_t units(std::size_t _bytes) {
+            return (_bytes + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+        }
+
+        static void* allocate(void* _context, std::size_t _bytes) {
+            return traits::allocate(static_cast<scoped_frame_allocator*>(_context)->m_allocator, units(_bytes));
+        }
+
+        static void deallocate(void* _context, void* _block, std::size_t _bytes) {
+            traits::deallocate(static_cast<scoped_frame_allocator*>(_context)->m_allocator,
+                               static_cast<std::max_align_t*>(_block), units(_bytes));
+        }
+
+    public:
+        explicit scoped_frame_allocator(const Allocator& _allocator) :
+                m_allocator(_allocator), m_source{&allocate, &deallocate, this}, m_previous(current_frame_source()) {
+            current_frame_source() = &m_source;
+        }
+
+        scoped_frame_allocator(const scoped_frame_allocator&) = delete;
+        scoped_frame_allocator& operator=(const scoped_frame_allocator&) = delete;
+
+        ~scoped_frame_allocator() {
+            current_frame_source() = m_previous;
+        }
+    };
+
+    template <typename T>
+    class generator;
+
+    /**
+     * @brief Input iterator over the values a generator yields. Incrementing resumes the coroutine until its next
+     *        co_yield. A value-initialized iterator is the end iterator, and an iterator whose coroutine has finished
+     *        compares equal to it.
+     */
+    template <typename T>
+    class generator_iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = typename std::remove_cv<typename std::remove_reference<T>::type>::type;
+        using difference_type = std::ptrdiff_t;
+        using reference = typename std::conditional<std::is_reference<T>::value, T, const value_type&>::type;
+        using pointer = typename std::add_pointer<reference>::type;
+
+    private:
+        using promise_type = typename generator<T>::promise_type;
+        using handle_type = std::coroutine_handle<promise_type>;
+
+        handle_type m_coroutine;
+
+        bool finished() const { return !m_coroutine || m_coroutine.done(); }
+
+    public:
+        generator_iterator() : m_coroutine(nullptr) { }
+
+        explicit generator_iterator(handle_type _coroutine) : m_coroutine(_coroutine) { }
+
+        reference operator*() const { return static_cast<reference>(*m_coroutine.promise().m_value); }
+        pointer operator->() const { return std::addressof(**this); }
+
+        generator_iterator& operator++() {
+            m_coroutine.resume();
+            m_coroutine.promise().rethrow_if_failed();
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        bool operator==(const generator_iterator& rhs) const {
+            return finished() ? rhs.finished() : m_coroutine == rhs.m_coroutine;
+        }
+
+        bool operator!=(const generator_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+    /**
+     * @brief Range of the values yielded by a coroutine. The coroutine starts suspended and runs up to its first
+     *        co_yield when begin() is called, so it is consumed like any other single-pass range:
+     *
+     *        generator<int> squares(int n) {
+     *            for (int i = 0; i < n; ++i) {
+     *                co_yield i * i;
+     *            }
+     *        }
+     *
+     *        for (int x : (g.begin(), g.end())) { ... }
+     *
+     *        The coroutine frame comes from frame_pool::local(), or from the allocator of the innermost
+     *        scoped_frame_allocator alive on the thread. An exception leaving the coroutine is rethrown from begin()
+     *        or from the increment that resumed it.
+     */
+    template <typename T>
+    class generator {
+    public:
+        class promise_type;
+
+        using iterator = generator_iterator<T>;
+        using handle_type = std::coroutine_handle<promise_type>;
+
+    private:
+        handle_type m_coroutine;
+        bool m_started;
+
+        explicit generator(handle_type _coroutine) : m_coroutine(_coroutine), m_started(false) { }
+
+    public:
+        class promise_type {
+            friend class generator_iterator<T>;
+
+        private:
+            using value_type = typename generator_iterator<T>::value_type;
+            using stored_type = typename std::conditional<std::is_reference<T>::value,
+                                                          typename std::remove_reference<T>::type,
+                                                          const value_type>::type;
+
+            stored_type* m_value;
+            std::exception_ptr m_error;
+
+        public:
+            promise_type() : m_value(nullptr), m_error() { }
+
+            promise_type(const promise_type&) = delete;
+            promise_type& operator=(const promise_type&) = delete;
+
+            generator get_return_object() { return generator(handle_type::from_promise(*this)); }
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            std::suspend_always final_suspend() const noexcept { return {}; }
+
+            /**
+             * @brief The yielded object outlives the suspension, since it lives until the end of the co_yield
+             *        expression, so only its address is kept.
+             */
+            std::suspend_always yield_value(stored_type& _value) noexcept {
+                m_value = std::addressof(_value);
+                return {};
+            }
+
+            template <typename U = T, typename = typename std::enable_if<!std::is_reference<U>::value>::type>
+            std::suspend_always yield_value(value_type&& _value) noexcept {
+                m_value = std::addressof(_value);
+                return {};
+            }
+
+            void return_void() const noexcept { }
+
+            void unhandled_exception() { m_error = std::current_exception(); }
+
+            void rethrow_if_failed() {
+                if (m_error) {
+                    std::rethrow_exception(std::exchange(m_error, nullptr));
+                }
+            }
+
+            static void* operator new(std::size_t _bytes) { return allocate_frame(_bytes); }
+
+            static void operator delete(void* _frame, std::size_t _bytes) noexcept { deallocate_frame(_frame, _bytes); }
+        };
+
+        generator(generator&& other) noexcept :
+                m_coroutine(std::exchange(other.m_coroutine, nullptr)), m_started(other.m_started) { }
+
+        generator& operator=(generator&& other) noexcept {
+            if (this != &other) {
+                if (m_coroutine) {
+                    m_coroutine.destroy();
+                }
+
+                m_coroutine = std::exchange(other.m_coroutine, nullptr);
+                m_started = other.m_started;
+            }
+
+            return *this;
+        }
+
+        generator(const generator&) = delete;
+        generator& operator=(const generator&) = delete;
+
+        ~generator() {
+            if (m_coroutine) {
+                m_coroutine.destroy();
+            }
+        }
+
+        /**
+         * @brief Runs the coroutine up to its first co_yield on the first call. Later calls continue where the
+         *        previous iteration stopped.
+         */
+        iterator begin() {
+            if (!m_coroutine) {
+                return iterator();
+            }
+
+            if (!m_started) {
+                m_started = true;
+                m_coroutine.resume();
+                m_coroutine.promise().rethrow_if_failed();
+            }
+
+            return iterator(m_coroutine);
+        }
+
+        iterator end() const { return iterator(); }
+
+        /**
+         * @brief Returns the values yielded by the coroutine as an iterator_range.
+         */
+        iterator_range<iterator> range() {
+            iterator first = begin();
+            return iterator_range<iterator>(first, end());
+        }
+    };
+
+} // namespace IteratorBasedForImpl
+#endif
+
+#endif
@@ -0,0 +1,426 @@
+#ifndef IteratorBasedForGpu_H
+#define IteratorBasedForGpu_H
+
+#include <IteratorBasedForParallel.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//Define ITERATOR_BASED_FOR_USE_SYCL to offload the execution::par_gpu algorithms with SYCL 2020, whose
+//implementations (DPC++, AdaptiveCpp) target CUDA and HIP devices as well. Sorting on the device also needs oneDPL.
+//Without them, or without a GPU at run time, the algorithms run on the host threads instead.
+#if defined(ITERATOR_BASED_FOR_USE_SYCL) && defined(__has_include)
+#if __has_include(<sycl/sycl.hpp>)
+#include <sycl/sycl.hpp>
+#define ITERATOR_BASED_FOR_HAS_SYCL 1
+#if __has_include(<oneapi/dpl/algorithm>)
+#include <oneapi/dpl/execution>
+#include <oneapi/dpl/algorithm>
+#define ITERATOR_BASED_FOR_HAS_ONEDPL 1
+#endif
+#endif
+#endif
+
+#ifndef ITERATOR_BASED_FOR_HAS_SYCL
+#define ITERATOR_BASED_FOR_HAS_SYCL 0
+#endif
+
+#ifndef ITERATOR_BASED_FOR_HAS_ONEDPL
+#define ITERATOR_BASED_FOR_HAS_ONEDPL 0
+#endif
+
+namespace IteratorBasedForImpl
+{
+
+    /**
+     * @brief Number of elements from which execution::par_gpu offloads by default. Below it the transfers to and from
+     *        the device take longer than the host threads need for the whole range.
+     */
+    constexpr std::size_t gpu_offload_threshold = std::size_t(1) << 22;
+
+#if ITERATOR_BASED_FOR_HAS_SYCL
+    /**
+     * @brief Returns an in-order queue on the default GPU, or nullptr if there is no GPU.
+     */
+    inline sycl::queue* default_gpu_queue() {
+        static const std::unique_ptr<sycl::queue> queue = []() -> std::unique_ptr<sycl::queue> {
+            try {
+                return std::unique_ptr<sycl::queue>(
+                        new sycl::queue(sycl::gpu_selector_v, sycl::property_list{sycl::property::queue::in_order()}));
+            } catch (const sycl::exception&) {
+                return nullptr;
+            }
+        }();
+
+        return queue.get();
+    }
+#endif
+
+    /**
+     * @brief Checks whether a GPU is available to execution::par_gpu.
+     */
+    inline bool gpu_available() {
+#if ITERATOR_BASED_FOR_HAS_SYCL
+        return default_gpu_queue() != nullptr;
+#else
+        return false;
+#endif
+    }
+
+    namespace execution
+    {
+
+        /**
+         * @brief Requests that transform(), reduce() and sort() run on a GPU for contiguous ranges of arithmetic
+         *        types with at least threshold() elements, copying the data to the device and back unless it already
+         *        lives in memory the device can access, such as memory from a pinned_allocator. Smaller ranges,
+         *        other ranges and machines without a GPU use host_policy(), execution::par by default.
+         */
+        class gpu_policy {
+        private:
+            std::size_t m_threshold;
+            parallel_policy m_host;
+#if ITERATOR_BASED_FOR_HAS_SYCL
+            sycl::queue* m_queue;
+#endif
+
+        public:
+            constexpr gpu_policy() :
+                    m_threshold(gpu_offload_threshold), m_host()
+#if ITERATOR_BASED_FOR_HAS_SYCL
+                    , m_queue(nullptr)
+#endif
+            {
+            }
+
+            /**
+             * @brief Returns a copy of this policy that offloads ranges of at least _elements elements.
+             */
+            gpu_policy above(std::size_t _elements) const {
+                gpu_policy policy = *this;
+                policy.m_threshold = _elements;
+                return policy;
+            }
+
+            /**
+             * @brief Returns a copy of this policy that runs the work staying on the host with _host.
+             */
+            gpu_policy host(const parallel_policy& _host) const {
+                gpu_policy policy = *this;
+                policy.m_host = _host;
+                return policy;
+            }
+
+#if ITERATOR_BASED_FOR_HAS_SYCL
+            /**
+             * @brief Returns a copy of this policy that offloads to the device of _queue.
+             */
+            gpu_policy on(sycl::queue& _queue) const {
+                gpu_policy policy = *this;
+                policy.m_queue = &_queue;
+                return policy;
+            }
+
+            sycl::queue* queue() const { return m_queue ? m_queue : default_gpu_queue(); }
+#endif
+
+            std::size_t threshold() const { return m_threshold; }
+
+            const parallel_policy& host_policy() const { return m_host; }
+
+            /**
+             * @brief Checks whether a range of _n elements that could be offloaded is.
+             */
+            bool offloads(std::size_t _n) const {
+#if ITERATOR_BASED_FOR_HAS_SYCL
+                return _n >= m_threshold && queue() != nullptr;
+#else
+                (void)_n;
+                return false;
+#endif
+            }
+        };
+
+        constexpr gpu_policy par_gpu;
+
+    } // namespace execution
+
+    /**
+     * @brief Allocator of page-locked host memory, which the GPU reads and writes directly and transfers from and to
+     *        at full bus speed. Without a GPU it allocates ordinary memory.
+     */
+    template <typename T>
+    class pinned_allocator {
+    public:
+        using value_type = T;
+
+        pinned_allocator() = default;
+
+        template <typename U>
+        pinned_allocator(const pinned_allocator<U>&) { }
+
+        T* allocate(std::size_t _n) {
+#if ITERATOR_BASED_FOR_HAS_SYCL
+            if (sycl::queue* queue = default_gpu_queue()) {
+                if (T* memory = sycl::malloc_host<T>(_n, *queue)) {
+                    return memory;
+                }
+
+                throw std::bad_alloc();
+            }
+#endif
+            return std::allocator<T>().allocate(_n);
+        }
+
+        void deallocate(T* _memory, std::size_t _n) {
+#if ITERATOR_BASED_FOR_HAS_SYCL
+            if (sycl::queue* queue = default_gpu_queue()) {
+                sycl::free(_memory, *queue);
+                return;
+            }
+#endif
+            std::allocator<T>().deallocate(_memory, _n);
+        }
+
+        template <typename U>
+        bool operator==(const pinned_allocator<U>&) const { return true; }
+
+        template <typename U>
+        bool operator!=(const pinned_allocator<U>&) const { return false; }
+    };
+
+    /**
+     * @brief Checks whether ranges from Iterator can be offloaded: their elements are stored contiguously and are of
+     *        an arithmetic type.
+     */
+    template <typename Iterator>
+    struct is_offloadable : std::integral_constant<bool,
+            is_contiguous_iterator<Iterator>::value
+            && std::is_arithmetic<typename std::iterator_traits<Iterator>::value_type>::value> {
+    };
+
+#if ITERATOR_BASED_FOR_HAS_SYCL
+    /**
+     * @brief Memory of _n elements of type T the device of _queue can access: _data itself if it is USM memory of the
+     *        queue's context, such as memory from a pinned_allocator, or else a device buffer that the elements are
+     *        copied to if _upload is set, and from which they are copied back to _data by download().
+     */
+    template <typename T>
+    class device_view {
+    private:
+        using element_type = typename std::remove_const<T>::type;
+
+        sycl::queue& m_queue;
+        T* m_host;
+        element_type* m_staging;
+        std::size_t m_size;
+        bool m_staged;
+
+    public:
+        device_view(sycl::queue& _queue, T* _data, std::size_t _n, bool _upload) :
+                m_queue(_queue), m_host(_data), m_staging(nullptr), m_size(_n),
+                m_staged(sycl::get_pointer_type(_data, _queue.get_context()) == sycl::usm::alloc::unknown) {
+            if (!m_staged) {
+                return;
+            }
+
+            //The device copy of a const range is still written by the upload, so it is allocated without the const.
+            m_staging = sycl::malloc_device<element_type>(_n, m_queue);
+
+            if (!m_staging) {
+                throw std::bad_alloc();
+            }
+
+            if (_upload) {
+                m_queue.memcpy(m_staging, m_host, _n * sizeof(T)).wait();
+            }
+        }
+
+        device_view(const device_view&) = delete;
+        device_view& operator=(const device_view&) = delete;
+
+        ~device_view() {
+            if (m_staged) {
+                sycl::free(m_staging, m_queue);
+            }
+        }
+
+        T* data() const { return m_staged ? m_staging : m_host; }
+
+        void download() {
+            if (m_staged) {
+                m_queue.memcpy(const_cast<element_type*>(m_host), m_staging, m_size * sizeof(T)).wait();
+            }
+        }
+    };
+#endif
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename F>
+    OutputIterator transform_gpu(const execution::gpu_policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                                 OutputIterator _out, F& _f, std::false_type) {
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+
+        const Iterator first = _range.begin();
+
+        parallel_for(_policy.host_policy(), _range, [&](const iterator_range<Iterator>& _piece) {
+            std::transform(_piece.begin(), _piece.end(), _out + (_piece.begin() - first), _f);
+        });
+
+        return _out + static_cast<difference_type>(_range.size());
+    }
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename F>
+    OutputIterator transform_gpu(const execution::gpu_policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                                 OutputIterator _out, F& _f, std::true_type) {
+        const std::size_t n = _range.size();
+
+        if (!_policy.offloads(n)) {
+            return transform_gpu(_policy, _range, std::move(_out), _f, std::false_type());
+        }
+
+#if ITERATOR_BASED_FOR_HAS_SYCL
+        using input_type = typename std::remove_reference<typename std::iterator_traits<Iterator>::reference>::type;
+        using output_type = typename std::remove_reference<decltype(*_out)>::type;
+
+        sycl::queue& queue = *_policy.queue();
+        device_view<input_type> input(queue, to_address(_range.begin()), n, true);
+        device_view<output_type> output(queue, to_address(_out), n, false);
+        input_type* in = input.data();
+        output_type* out = output.data();
+        F f = _f;
+
+        queue.parallel_for(sycl::range<1>(n), [=](sycl::id<1> _i) { out[_i] = f(in[_i]); }).wait();
+        output.download();
+#endif
+        return _out + static_cast<typename std::iterator_traits<Iterator>::difference_type>(n);
+    }
+
+    /**
+     * @brief Writes _f applied to every element of the sized range _range to the random access output starting at
+     *        _out and returns the end of the output. Contiguous ranges of arithmetic types with a contiguous output
+     *        of at least _policy.threshold() elements are transformed on the GPU, with _f called in device code;
+     *        everything else is split across the threads of _policy.host_policy().
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename F>
+    OutputIterator transform(const execution::gpu_policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                             OutputIterator _out, F _f) {
+        static_assert(is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "transform with execution::par_gpu requires a range whose size is known in constant time");
+
+        return transform_gpu(_policy, _range, std::move(_out), _f, std::integral_constant<bool,
+                             is_offloadable<Iterator>::value && is_offloadable<OutputIterator>::value>());
+    }
+
+    template <typename Iterator, typename Sentinel, typename T, typename BinaryOp>
+    T reduce_gpu(const execution::gpu_policy& _policy, const iterator_range<Iterator, Sentinel>& _range, T _init,
+                 BinaryOp& _op, std::false_type) {
+        return reduce(_policy.host_policy(), _range, std::move(_init), _op);
+    }
+
+    template <typename Iterator, typename Sentinel, typename T, typename BinaryOp>
+    T reduce_gpu(const execution::gpu_policy& _policy, const iterator_range<Iterator, Sentinel>& _range, T _init,
+                 BinaryOp& _op, std::true_type) {
+        const std::size_t n = _range.size();
+
+        if (!_policy.offloads(n)) {
+            return reduce_gpu(_policy, _range, std::move(_init), _op, std::false_type());
+        }
+
+#if ITERATOR_BASED_FOR_HAS_SYCL
+        using input_type = typename std::remove_reference<typename std::iterator_traits<Iterator>::reference>::type;
+
+        sycl::queue& queue = *_policy.queue();
+        device_view<input_type> input(queue, to_address(_range.begin()), n, true);
+        const input_type* in = input.data();
+        T* result = sycl::malloc_shared<T>(1, queue);
+
+        if (!result) {
+            throw std::bad_alloc();
+        }
+
+        //The reduction combines the elements into the value it starts from.
+        *result = _init;
+        BinaryOp op = _op;
+
+        try {
+            queue.parallel_for(sycl::range<1>(n), sycl::reduction(result, op),
+                               [=](sycl::id<1> _i, auto& _sum) { _sum.combine(static_cast<T>(in[_i])); }).wait();
+        } catch (...) {
+            sycl::free(result, queue);
+            throw;
+        }
+
+        _init = *result;
+        sycl::free(result, queue);
+#endif
+        return _init;
+    }
+
+    /**
+     * @brief Returns _init combined with every element of the sized range _range using _op, which must be associative
+     *        and commutative. Contiguous ranges of arithmetic types with at least _policy.threshold() elements are
+     *        reduced on the GPU, with _op called in device code; everything else is reduced by the threads of
+     *        _policy.host_policy().
+     */
+    template <typename Iterator, typename Sentinel, typename T, typename BinaryOp = std::plus<T>>
+    T reduce(const execution::gpu_policy& _policy, const iterator_range<Iterator, Sentinel>& _range, T _init,
+             BinaryOp _op = BinaryOp()) {
+        static_assert(is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "reduce with execution::par_gpu requires a range whose size is known in constant time");
+
+        if (_range.empty()) {
+            return _init;
+        }
+
+        return reduce_gpu(_policy, _range, std::move(_init), _op,
+                          std::integral_constant<bool, is_offloadable<Iterator>::value
+                              && std::is_arithmetic<T>::value>());
+    }
+
+    template <typename Iterator, typename Sentinel, typename Compare>
+    void sort_gpu(const execution::gpu_policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                  Compare& _compare, std::false_type) {
+        sort(_policy.host_policy(), _range, _compare);
+    }
+
+    template <typename Iterator, typename Sentinel, typename Compare>
+    void sort_gpu(const execution::gpu_policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                  Compare& _compare, std::true_type) {
+        const std::size_t n = _range.size();
+
+        if (!_policy.offloads(n) || !ITERATOR_BASED_FOR_HAS_ONEDPL) {
+            sort_gpu(_policy, _range, _compare, std::false_type());
+            return;
+        }
+
+#if ITERATOR_BASED_FOR_HAS_SYCL && ITERATOR_BASED_FOR_HAS_ONEDPL
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        sycl::queue& queue = *_policy.queue();
+        device_view<value_type> data(queue, to_address(_range.begin()), n, true);
+
+        oneapi::dpl::sort(oneapi::dpl::execution::make_device_policy(queue), data.data(), data.data() + n, _compare);
+        data.download();
+#endif
+    }
+
+    /**
+     * @brief Sorts the random access range _range with respect to _compare. Contiguous ranges of arithmetic types with
+     *        at least _policy.threshold() elements are sorted on the GPU where oneDPL is available; everything else
+     *        is sorted by the threads of _policy.host_policy().
+     */
+    template <typename Iterator, typename Sentinel, typename Compare = std::less<>>
+    void sort(const execution::gpu_policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+              Compare _compare = Compare()) {
+        sort_gpu(_policy, _range, _compare, typename is_offloadable<Iterator>::type());
+    }
+
+} // namespace IteratorBasedForImpl
+
+#endif // IteratorBasedForGpu_H
@@ -0,0 +1,2735 @@
+#ifndef IteratorBasedForIO_H
+#define IteratorBasedForIO_H
+
+#include <IteratorBasedFor.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#define ITERATOR_BASED_FOR_HAS_FILE_DESCRIPTORS 1
+#else
+#define ITERATOR_BASED_FOR_HAS_FILE_DESCRIPTORS 0
+#endif
+
+//Define ITERATOR_BASED_FOR_USE_ZSTD or ITERATOR_BASED_FOR_USE_LZ4, and link libzstd or liblz4, to decompress Zstandard
+//or LZ4 frames with zstd_decoder or lz4_decoder.
+#if defined(ITERATOR_BASED_FOR_USE_ZSTD) && defined(__has_include)
+#if __has_include(<zstd.h>)
+#include <zstd.h>
+#define ITERATOR_BASED_FOR_HAS_ZSTD 1
+#endif
+#endif
+
+#ifndef ITERATOR_BASED_FOR_HAS_ZSTD
+#define ITERATOR_BASED_FOR_HAS_ZSTD 0
+#endif
+
+#if defined(ITERATOR_BASED_FOR_USE_LZ4) && defined(__has_include)
+#if __has_include(<lz4frame.h>)
+#include <lz4frame.h>
+#define ITERATOR_BASED_FOR_HAS_LZ4 1
+#endif
+#endif
+
+#ifndef ITERATOR_BASED_FOR_HAS_LZ4
+#define ITERATOR_BASED_FOR_HAS_LZ4 0
+#endif
+
+//Define ITERATOR_BASED_FOR_USE_IO_URING to let async_file_range keep its reads in flight through io_uring on Linux. The
+//ring is driven with raw system calls, so there is no library to link, and ranges fall back to pread threads at run
+//time where the kernel refuses to set one up.
+#if defined(ITERATOR_BASED_FOR_USE_IO_URING) && defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define ITERATOR_BASED_FOR_HAS_IO_URING 1
+#endif
+#endif
+#endif
+
+#ifndef ITERATOR_BASED_FOR_HAS_IO_URING
+#define ITERATOR_BASED_FOR_HAS_IO_URING 0
+#endif
+
+namespace IteratorBasedForImpl
+{
+
+    /**
+     * @brief Reads an input stream or file descriptor in large blocks into an aligned buffer, from which the
+     *        iterators below hand out bytes, lines and fixed-size records. The source is asked for data once per
+     *        block instead of once per element, so iterating byte by byte costs a buffer access and a bounds check.
+     *
+     * A record or line that straddles two blocks is moved to the start of the buffer before the next block is read
+     * behind it; a line longer than the buffer grows it. The reader must outlive every range created from it, and all
+     * ranges of one reader share its position, like std::istream_iterator objects of one stream.
+     */
+    class block_reader {
+    public:
+        /**
+         * @brief Default size of the blocks read from the source.
+         */
+        static constexpr std::size_t default_block_size = std::size_t(64) << 10;
+
+        /**
+         * @brief Alignment of the buffer, which lets file descriptors opened for direct I/O read into it.
+         */
+        static constexpr std::size_t buffer_alignment = 4096;
+
+    private:
+        std::istream* m_stream;
+        int m_descriptor;
+        std::function<std::size_t(char*, std::size_t)> m_source;
+        std::size_t m_block_size;
+        std::unique_ptr<char[]> m_storage;
+        char* m_buffer;
+        std::size_t m_capacity;
+        std::size_t m_begin;
+        std::size_t m_end;
+        bool m_eof;
+
+        void allocate(std::size_t _capacity) {
+            std::unique_ptr<char[]> storage(new char[_capacity + buffer_alignment]);
+            const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(storage.get());
+            char* buffer = storage.get() + (buffer_alignment - address % buffer_alignment) % buffer_alignment;
+
+            if (m_end > m_begin) {
+                std::memcpy(buffer, m_buffer + m_begin, m_end - m_begin);
+            }
+
+            m_end -= m_begin;
+            m_begin = 0;
+            m_storage = std::move(storage);
+            m_buffer = buffer;
+            m_capacity = _capacity;
+        }
+
+        std::size_t read_some(char* _destination, std::size_t _bytes) {
+            if (m_stream) {
+                m_stream->read(_destination, static_cast<std::streamsize>(_bytes));
+
+                if (m_stream->bad()) {
+                    throw std::system_error(std::make_error_code(std::errc::io_error), "block_reader: stream read failed");
+                }
+
+                return static_cast<std::size_t>(m_stream->gcount());
+            }
+
+            if (m_source) {
+                return m_source(_destination, _bytes);
+            }
+
+#if ITERATOR_BASED_FOR_HAS_FILE_DESCRIPTORS
+            for (;;) {
+                const ssize_t bytes = ::read(m_descriptor, _destination, _bytes);
+
+                if (bytes >= 0) {
+                    return static_cast<std::size_t>(bytes);
+                }
+
+                if (errno != EINTR) {
+                    throw std::system_error(errno, std::generic_category(), "block_reader: read failed");
+                }
+            }
+#else
+            return 0;
+#endif
+        }
+
+    public:
+        /**
+         * @brief Creates a reader of _stream that reads _block_size bytes at a time.
+         */
+        explicit block_reader(std::istream& _stream, std::size_t _block_size = default_block_size) :
+                m_stream(&_stream), m_descriptor(-1), m_source(), m_block_size(_block_size ? _block_size : 1),
+                m_storage(), m_buffer(nullptr), m_capacity(0), m_begin(0), m_end(0), m_eof(false) {
+            allocate(m_block_size);
+        }
+
+#if ITERATOR_BASED_FOR_HAS_FILE_DESCRIPTORS
+        /**
+         * @brief Creates a reader of the file descriptor _descriptor that reads _block_size bytes at a time. The
+         *        descriptor is not closed by the reader.
+         */
+        explicit block_reader(int _descriptor, std::size_t _block_size = default_block_size) :
+                m_stream(nullptr), m_descriptor(_descriptor), m_source(), m_block_size(_block_size ? _block_size : 1),
+                m_storage(), m_buffer(nullptr), m_capacity(0), m_begin(0), m_end(0), m_eof(false) {
+            allocate(m_block_size);
+        }
+#endif
+
+        /**
+         * @brief Creates a reader of the function _source, which is called as _source(destination, bytes) to store at
+         *        most bytes bytes at destination and returns how many it stored, zero at the end of its input.
+         */
+        explicit block_reader(std::function<std::size_t(char*, std::size_t)> _source,
+                              std::size_t _block_size = default_block_size) :
+                m_stream(nullptr), m_descriptor(-1), m_source(std::move(_source)),
+                m_block_size(_block_size ? _block_size : 1), m_storage(), m_buffer(nullptr), m_capacity(0), m_begin(0),
+                m_end(0), m_eof(false) {
+            allocate(m_block_size);
+        }
+
+        block_reader(const block_reader&) = delete;
+        block_reader& operator=(const block_reader&) = delete;
+
+        /**
+         * @brief Returns the buffered bytes that have not been consumed yet.
+         */
+        const char* data() const { return m_buffer + m_begin; }
+        std::size_t available() const { return m_end - m_begin; }
+
+        /**
+         * @brief Marks the first _bytes buffered bytes as consumed. _bytes must not exceed available().
+         */
+        void consume(std::size_t _bytes) { m_begin += _bytes; }
+
+        /**
+         * @brief Reads another block behind the bytes still buffered, moving them to the start of the buffer and
+         *        growing it if there is no room for a whole block. Returns false once the source is exhausted.
+         */
+        bool refill() {
+            if (m_eof) {
+                return false;
+            }
+
+            if (m_capacity - available() < m_block_size) {
+                allocate(m_capacity * 2);
+            } else if (m_capacity - m_end < m_block_size) {
+                allocate(m_capacity);
+            }
+
+            const std::size_t bytes = read_some(m_buffer + m_end, m_block_size);
+            m_end += bytes;
+            m_eof = bytes == 0;
+            return bytes != 0;
+        }
+
+        /**
+         * @brief Makes at least _bytes bytes available unless the source ends first. Returns whether it succeeded.
+         */
+        bool ensure(std::size_t _bytes) {
+            while (available() < _bytes) {
+                if (!refill()) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Stores the next line, without its terminating newline, in _line and consumes it. The span refers to
+         *        the buffer and stays valid until the reader is used again. A last line without a newline is returned
+         *        as well. Returns false at the end of the input.
+         */
+        bool next_line(span<const char>& _line) {
+            std::size_t searched = 0;
+
+            for (;;) {
+                const void* newline = std::memchr(data() + searched, '\n', available() - searched);
+
+                if (newline) {
+                    const std::size_t length = static_cast<std::size_t>(static_cast<const char*>(newline) - data());
+                    _line = span<const char>(data(), length);
+                    consume(length + 1);
+                    return true;
+                }
+
+                searched = available();
+
+                if (!refill()) {
+                    if (available() == 0) {
+                        return false;
+                    }
+
+                    _line = span<const char>(data(), available());
+                    consume(available());
+                    return true;
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief Input iterator over the bytes of a block_reader. A value-initialized iterator is the end iterator.
+     */
+    class block_byte_iterator {
+    private:
+        block_reader* m_reader;
+
+        void settle() {
+            if (m_reader && m_reader->available() == 0 && !m_reader->refill()) {
+                m_reader = nullptr;
+            }
+        }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = char;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const char*;
+        using reference = const char&;
+
+        block_byte_iterator() : m_reader(nullptr) { }
+
+        explicit block_byte_iterator(block_reader& _reader) : m_reader(&_reader) { settle(); }
+
+        reference operator*() const { return *m_reader->data(); }
+
+        block_byte_iterator& operator++() {
+            m_reader->consume(1);
+            settle();
+            return *this;
+        }
+
+        block_byte_iterator operator++(int) {
+            block_byte_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const block_byte_iterator& rhs) const { return m_reader == rhs.m_reader; }
+        bool operator!=(const block_byte_iterator& rhs) const { return m_reader != rhs.m_reader; }
+    };
+
+    /**
+     * @brief Input iterator over the lines of a block_reader, each a span<const char> without the newline. A
+     *        value-initialized iterator is the end iterator.
+     */
+    class block_line_iterator {
+    private:
+        block_reader* m_reader;
+        span<const char> m_line;
+
+        void next() {
+            if (!m_reader->next_line(m_line)) {
+                m_reader = nullptr;
+            }
+        }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = span<const char>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const span<const char>*;
+        using reference = const span<const char>&;
+
+        block_line_iterator() : m_reader(nullptr), m_line() { }
+
+        explicit block_line_iterator(block_reader& _reader) : m_reader(&_reader), m_line() { next(); }
+
+        reference operator*() const { return m_line; }
+        pointer operator->() const { return &m_line; }
+
+        block_line_iterator& operator++() {
+            next();
+            return *this;
+        }
+
+        block_line_iterator operator++(int) {
+            block_line_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const block_line_iterator& rhs) const { return m_reader == rhs.m_reader; }
+        bool operator!=(const block_line_iterator& rhs) const { return m_reader != rhs.m_reader; }
+    };
+
+    /**
+     * @brief Input iterator over the consecutive trivially copyable records of type T stored in the input of a
+     *        block_reader. A trailing partial record is ignored. A value-initialized iterator is the end iterator.
+     */
+    template <typename T>
+    class block_record_iterator {
+        static_assert(std::is_trivially_copyable<T>::value, "block_record_iterator requires trivially copyable records");
+
+    private:
+        block_reader* m_reader;
+        T m_record;
+
+        void next() {
+            if (!m_reader->ensure(sizeof(T))) {
+                m_reader = nullptr;
+                return;
+            }
+
+            std::memcpy(&m_record, m_reader->data(), sizeof(T));
+            m_reader->consume(sizeof(T));
+        }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        block_record_iterator() : m_reader(nullptr), m_record() { }
+
+        explicit block_record_iterator(block_reader& _reader) : m_reader(&_reader), m_record() { next(); }
+
+        reference operator*() const { return m_record; }
+        pointer operator->() const { return &m_record; }
+
+        block_record_iterator& operator++() {
+            next();
+            return *this;
+        }
+
+        block_record_iterator operator++(int) {
+            block_record_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const block_record_iterator& rhs) const { return m_reader == rhs.m_reader; }
+        bool operator!=(const block_record_iterator& rhs) const { return m_reader != rhs.m_reader; }
+    };
+
+    /**
+     * @brief Returns a range over the bytes of _reader, as in
+     *
+     *        block_reader reader(file);
+     *        for (char c : bytes(reader)) { ... }
+     *
+     *        The same range is obtained with (block_byte_iterator(reader), block_byte_iterator()).
+     */
+    inline iterator_range<block_byte_iterator> bytes(block_reader& _reader) {
+        return iterator_range<block_byte_iterator>(block_byte_iterator(_reader), block_byte_iterator());
+    }
+
+    /**
+     * @brief Returns a range over the lines of _reader, each a span<const char> into the reader's buffer that is
+     *        valid until the next line is read.
+     */
+    inline iterator_range<block_line_iterator> lines(block_reader& _reader) {
+        return iterator_range<block_line_iterator>(block_line_iterator(_reader), block_line_iterator());
+    }
+
+    /**
+     * @brief Returns a range over the consecutive records of type T in the input of _reader.
+     */
+    template <typename T>
+    iterator_range<block_record_iterator<T>> records(block_reader& _reader) {
+        return iterator_range<block_record_iterator<T>>(block_record_iterator<T>(_reader), block_record_iterator<T>());
+    }
+
+#if ITERATOR_BASED_FOR_HAS_FILE_DESCRIPTORS
+    /**
+     * @brief How a mapped_file_range expects its records to be accessed, passed on to the kernel with madvise.
+     */
+    enum class access_pattern {
+        normal,
+        sequential,
+        random
+    };
+
+    /**
+     * @brief Options of a mapped_file_range. will_need asks the kernel to start reading the whole file right away,
+     *        huge_pages asks for transparent huge pages where the kernel supports them for file mappings, and
+     *        readahead is the size in bytes of the window a readahead_iterator requests ahead of its position.
+     */
+    struct mapped_file_options {
+        access_pattern pattern = access_pattern::sequential;
+        bool will_need = false;
+        bool huge_pages = false;
+        std::size_t readahead = std::size_t(8) << 20;
+    };
+
+    /**
+     * @brief Hints the kernel that the pages of [_first, _first + _bytes) will be needed soon. _first need not be page
+     *        aligned. Failures are ignored since the hint is only advisory.
+     */
+    inline void advise_will_need(const void* _first, std::size_t _bytes) {
+        const std::uintptr_t page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+        const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(_first) / page * page;
+        const std::uintptr_t last = reinterpret_cast<std::uintptr_t>(_first) + _bytes;
+
+        if (_bytes != 0) {
+            ::madvise(reinterpret_cast<void*>(first), last - first, MADV_WILLNEED);
+        }
+    }
+
+    /**
+     * @brief Contiguous iterator over the records of a mapped_file_range that asks the kernel to read the next window
+     *        of the file whenever it enters a new one, so the pages are resident by the time the loop reaches them.
+     *        Between window boundaries an increment costs one extra pointer comparison.
+     */
+    template <typename T>
+    class readahead_iterator {
+    private:
+        const T* m_position;
+        const T* m_next_window;
+        const T* m_end;
+        std::size_t m_window;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        readahead_iterator() : m_position(nullptr), m_next_window(nullptr), m_end(nullptr), m_window(1) { }
+
+        readahead_iterator(const T* _position, const T* _end, std::size_t _window) :
+                m_position(_position), m_next_window(_position), m_end(_end), m_window(_window ? _window : 1) {
+            advise();
+        }
+
+        readahead_iterator(const readahead_iterator&) = default;
+        readahead_iterator& operator=(const readahead_iterator&) = default;
+
+        /**
+         * @brief Requests the window after the current position once the position has reached it.
+         */
+        void advise() {
+            if (m_position >= m_next_window && m_position < m_end) {
+                const std::size_t records = static_cast<std::size_t>(m_end - m_position);
+                const std::size_t window = records < m_window ? records : m_window;
+                advise_will_need(m_position, window * sizeof(T));
+                m_next_window = m_position + window / 2 + 1;
+            }
+        }
+
+        const T* base() const { return m_position; }
+
+        reference operator*() const { return *m_position; }
+        pointer operator->() const { return m_position; }
+        reference operator[](difference_type _n) const { return m_position[_n]; }
+
+        readahead_iterator& operator++() {
+            ++m_position;
+
+            if (m_position == m_next_window) {
+                advise();
+            }
+
+            return *this;
+        }
+
+        readahead_iterator operator++(int) {
+            readahead_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        readahead_iterator& operator--() { --m_position; return *this; }
+
+        readahead_iterator operator--(int) {
+            readahead_iterator previous = *this;
+            --m_position;
+            return previous;
+        }
+
+        readahead_iterator& operator+=(difference_type _n) {
+            m_position += _n;
+            advise();
+            return *this;
+        }
+
+        readahead_iterator& operator-=(difference_type _n) { m_position -= _n; return *this; }
+
+        friend readahead_iterator operator+(readahead_iterator _it, difference_type _n) { return _it += _n; }
+        friend readahead_iterator operator+(difference_type _n, readahead_iterator _it) { return _it += _n; }
+        friend readahead_iterator operator-(readahead_iterator _it, difference_type _n) { return _it -= _n; }
+
+        friend difference_type operator-(const readahead_iterator& _lhs, const readahead_iterator& _rhs) {
+            return _lhs.m_position - _rhs.m_position;
+        }
+
+        friend bool operator==(const readahead_iterator& _lhs, const readahead_iterator& _rhs) {
+            return _lhs.m_position == _rhs.m_position;
+        }
+
+        friend bool operator!=(const readahead_iterator& _lhs, const readahead_iterator& _rhs) {
+            return _lhs.m_position != _rhs.m_position;
+        }
+
+        friend bool operator<(const readahead_iterator& _lhs, const readahead_iterator& _rhs) {
+            return _lhs.m_position < _rhs.m_position;
+        }
+
+        friend bool operator>(const readahead_iterator& _lhs, const readahead_iterator& _rhs) { return _rhs < _lhs; }
+        friend bool operator<=(const readahead_iterator& _lhs, const readahead_iterator& _rhs) { return !(_rhs < _lhs); }
+        friend bool operator>=(const readahead_iterator& _lhs, const readahead_iterator& _rhs) { return !(_lhs < _rhs); }
+    };
+
+    template <typename T>
+    struct is_contiguous_iterator<readahead_iterator<T>> : std::true_type { };
+
+    /**
+     * @brief Maps a file into memory read-only and presents it as a contiguous range of trivially copyable records
+     *        of type T, so multi-gigabyte files are iterated without reading them into a buffer first:
+     *
+     *        mapped_file_range<trade> trades("trades.bin");
+     *        for (const trade& t : trades) { ... }
+     *
+     *        A trailing partial record is not part of the range. The mapping is released by the destructor; ranges
+     *        and pointers obtained from it must not outlive it.
+     */
+    template <typename T>
+    class mapped_file_range {
+        static_assert(std::is_trivially_copyable<T>::value, "mapped_file_range requires trivially copyable records");
+
+    private:
+        void* m_mapping;
+        std::size_t m_bytes;
+        std::size_t m_readahead;
+
+        static void advise(void* _mapping, std::size_t _bytes, const mapped_file_options& _options) {
+            const int pattern = _options.pattern == access_pattern::sequential ? MADV_SEQUENTIAL
+                              : _options.pattern == access_pattern::random ? MADV_RANDOM : MADV_NORMAL;
+            ::madvise(_mapping, _bytes, pattern);
+
+            if (_options.will_need) {
+                ::madvise(_mapping, _bytes, MADV_WILLNEED);
+            }
+
+#if defined(MADV_HUGEPAGE)
+            if (_options.huge_pages) {
+                ::madvise(_mapping, _bytes, MADV_HUGEPAGE);
+            }
+#endif
+        }
+
+        void release() {
+            if (m_mapping) {
+                ::munmap(m_mapping, m_bytes);
+                m_mapping = nullptr;
+            }
+        }
+
+    public:
+        using iterator = const T*;
+
+        /**
+         * @brief Maps the file at _path. Throws std::system_error if it cannot be opened or mapped.
+         */
+        explicit mapped_file_range(const std::string& _path, const mapped_file_options& _options = mapped_file_options()) :
+                m_mapping(nullptr), m_bytes(0), m_readahead(_options.readahead) {
+            const int descriptor = ::open(_path.c_str(), O_RDONLY);
+
+            if (descriptor < 0) {
+                throw std::system_error(errno, std::generic_category(), "mapped_file_range: cannot open " + _path);
+            }
+
+            struct stat status;
+
+            if (::fstat(descriptor, &status) != 0) {
+                const int error = errno;
+                ::close(descriptor);
+                throw std::system_error(error, std::generic_category(), "mapped_file_range: cannot stat " + _path);
+            }
+
+            m_bytes = static_cast<std::size_t>(status.st_size);
+
+            if (m_bytes != 0) {
+                void* mapping = ::mmap(nullptr, m_bytes, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+                if (mapping == MAP_FAILED) {
+                    const int error = errno;
+                    ::close(descriptor);
+                    throw std::system_error(error, std::generic_category(), "mapped_file_range: cannot map " + _path);
+                }
+
+                m_mapping = mapping;
+                advise(m_mapping, m_bytes, _options);
+            }
+
+            ::close(descriptor);
+        }
+
+        mapped_file_range(mapped_file_range&& _other) noexcept :
+                m_mapping(_other.m_mapping), m_bytes(_other.m_bytes), m_readahead(_other.m_readahead) {
+            _other.m_mapping = nullptr;
+            _other.m_bytes = 0;
+        }
+
+        mapped_file_range& operator=(mapped_file_range&& _other) noexcept {
+            if (this != &_other) {
+                release();
+                m_mapping = _other.m_mapping;
+                m_bytes = _other.m_bytes;
+                m_readahead = _other.m_readahead;
+                _other.m_mapping = nullptr;
+                _other.m_bytes = 0;
+            }
+
+            return *this;
+        }
+
+        mapped_file_range(const mapped_file_range&) = delete;
+        mapped_file_range& operator=(const mapped_file_range&) = delete;
+
+        ~mapped_file_range() { release(); }
+
+        const T* data() const { return static_cast<const T*>(m_mapping); }
+        std::size_t size() const { return m_bytes / sizeof(T); }
+        bool empty() const { return size() == 0; }
+
+        const T* begin() const { return data(); }
+        const T* end() const { return data() + size(); }
+
+        const T& operator[](std::size_t _n) const { return data()[_n]; }
+
+        /**
+         * @brief Returns the records as an iterator_range of pointers, with the accessors and algorithm fast paths of
+         *        contiguous ranges.
+         */
+        iterator_range<const T*> range() const { return iterator_range<const T*>(begin(), end()); }
+
+        /**
+         * @brief Returns the records as a range of readahead_iterator objects that request the next
+         *        mapped_file_options::readahead bytes of the file as iteration progresses.
+         */
+        iterator_range<readahead_iterator<T>> with_readahead() const {
+            const std::size_t window = m_readahead / sizeof(T);
+            return iterator_range<readahead_iterator<T>>(readahead_iterator<T>(begin(), end(), window),
+                                                         readahead_iterator<T>(end(), end(), window));
+        }
+    };
+
+    template <typename T>
+    class async_file_range;
+
+    /**
+     * @brief Input iterator over the records of an async_file_range. A value-initialized iterator is the end iterator.
+     */
+    template <typename T>
+    class async_record_iterator {
+    private:
+        async_file_range<T>* m_range;
+        const T* m_position;
+        const T* m_end;
+
+        void settle() {
+            while (m_range && m_position == m_end) {
+                if (!m_range->next_block(m_position, m_end)) {
+                    *this = async_record_iterator();
+                }
+            }
+        }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        async_record_iterator() : m_range(nullptr), m_position(nullptr), m_end(nullptr) { }
+
+        explicit async_record_iterator(async_file_range<T>& _range) :
+                m_range(&_range), m_position(nullptr), m_end(nullptr) {
+            settle();
+        }
+
+        async_record_iterator(const async_record_iterator&) = default;
+        async_record_iterator& operator=(const async_record_iterator&) = default;
+
+        reference operator*() const { return *m_position; }
+        pointer operator->() const { return m_position; }
+
+        async_record_iterator& operator++() {
+            ++m_position;
+            settle();
+            return *this;
+        }
+
+        async_record_iterator operator++(int) {
+            async_record_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const async_record_iterator& rhs) const {
+            return m_range == rhs.m_range && m_position == rhs.m_position;
+        }
+
+        bool operator!=(const async_record_iterator& rhs) const { return !(*this == rhs); }
+    };
+
+#if ITERATOR_BASED_FOR_HAS_IO_URING
+    /**
+     * @brief An io_uring instance set up with raw system calls, through which a single thread queues reads into its
+     *        own buffers and collects their completions. Every read carries a tag below the number of reads the ring
+     *        was created for, which is handed back with its result, and at most that many reads may be queued or in
+     *        flight at a time. The ring has room for a cancellation of each of them besides. Throws
+     *        std::system_error if the kernel cannot set the ring up.
+     */
+    class read_ring {
+    private:
+        int m_descriptor;
+        unsigned m_reads;
+        void* m_submission_ring;
+        std::size_t m_submission_bytes;
+        void* m_completion_ring;
+        std::size_t m_completion_bytes;
+        io_uring_sqe* m_submissions;
+        std::size_t m_submissions_bytes;
+        unsigned* m_submission_tail;
+        unsigned* m_submission_mask;
+        unsigned* m_submission_array;
+        unsigned* m_completion_head;
+        unsigned* m_completion_tail;
+        unsigned* m_completion_mask;
+        io_uring_cqe* m_completions;
+        std::vector<iovec> m_vectors;
+        std::vector<bool> m_in_flight;
+        unsigned m_pending;
+        unsigned m_queued;
+
+        void* map(std::size_t _bytes, off_t _offset) const {
+            void* const address = ::mmap(nullptr, _bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                         m_descriptor, _offset);
+
+            if (address == MAP_FAILED) {
+                throw std::system_error(errno, std::generic_category(), "read_ring: cannot map the ring");
+            }
+
+            return address;
+        }
+
+        void release() {
+            if (m_submissions) {
+                ::munmap(m_submissions, m_submissions_bytes);
+            }
+
+            if (m_completion_ring && m_completion_ring != m_submission_ring) {
+                ::munmap(m_completion_ring, m_completion_bytes);
+            }
+
+            if (m_submission_ring) {
+                ::munmap(m_submission_ring, m_submission_bytes);
+            }
+
+            if (m_descriptor >= 0) {
+                ::close(m_descriptor);
+            }
+        }
+
+        template <typename P>
+        static P* at(void* _ring, std::uint32_t _offset) {
+            return reinterpret_cast<P*>(static_cast<char*>(_ring) + _offset);
+        }
+
+        /**
+         * @brief Returns the next free submission entry, cleared. This thread is the only producer, so the tail is
+         *        only published, with release semantics, once the entry is filled in by queue().
+         */
+        io_uring_sqe& next_submission() {
+            io_uring_sqe& submission = m_submissions[*m_submission_tail & *m_submission_mask];
+            std::memset(&submission, 0, sizeof(submission));
+            return submission;
+        }
+
+        void queue() {
+            const unsigned tail = *m_submission_tail;
+            const unsigned index = tail & *m_submission_mask;
+            m_submission_array[index] = index;
+            __atomic_store_n(m_submission_tail, tail + 1, __ATOMIC_RELEASE);
+            ++m_queued;
+        }
+
+        void enter(unsigned _wait_for) {
+            for (;;) {
+                const long submitted = ::syscall(__NR_io_uring_enter, m_descriptor, m_queued, _wait_for,
+                                                 _wait_for ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+
+                if (submitted >= 0) {
+                    m_queued -= static_cast<unsigned>(submitted);
+
+                    //The kernel does not wait after a partial submission, so the rest is submitted by calling again.
+                    if (m_queued == 0) {
+                        return;
+                    }
+                } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    throw std::system_error(errno, std::generic_category(), "read_ring: io_uring_enter failed");
+                }
+            }
+        }
+
+    public:
+        /**
+         * @brief Sets up a ring for _reads reads at a time.
+         */
+        explicit read_ring(unsigned _reads) :
+                m_descriptor(-1), m_reads(_reads), m_submission_ring(nullptr), m_submission_bytes(0),
+                m_completion_ring(nullptr), m_completion_bytes(0), m_submissions(nullptr), m_submissions_bytes(0),
+                m_submission_tail(nullptr), m_submission_mask(nullptr), m_submission_array(nullptr),
+                m_completion_head(nullptr), m_completion_tail(nullptr), m_completion_mask(nullptr),
+                m_completions(nullptr), m_vectors(_reads), m_in_flight(_reads, false), m_pending(0), m_queued(0) {
+            io_uring_params parameters;
+            std::memset(&parameters, 0, sizeof(parameters));
+            const long descriptor = ::syscall(__NR_io_uring_setup, 2 * _reads, &parameters);
+
+            if (descriptor < 0) {
+                throw std::system_error(errno, std::generic_category(), "read_ring: io_uring_setup failed");
+            }
+
+            m_descriptor = static_cast<int>(descriptor);
+            m_submission_bytes = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned);
+            m_completion_bytes = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+
+            try {
+#if defined(IORING_FEAT_SINGLE_MMAP)
+                //Both rings share one mapping since Linux 5.4.
+                if (parameters.features & IORING_FEAT_SINGLE_MMAP) {
+                    m_submission_bytes = m_completion_bytes = std::max(m_submission_bytes, m_completion_bytes);
+                    m_submission_ring = m_completion_ring = map(m_submission_bytes, IORING_OFF_SQ_RING);
+                }
+#endif
+
+                if (!m_submission_ring) {
+                    m_submission_ring = map(m_submission_bytes, IORING_OFF_SQ_RING);
+                    m_completion_ring = map(m_completion_bytes, IORING_OFF_CQ_RING);
+                }
+
+                m_submissions_bytes = parameters.sq_entries * sizeof(io_uring_sqe);
+                m_submissions = static_cast<io_uring_sqe*>(map(m_submissions_bytes, IORING_OFF_SQES));
+            } catch (...) {
+                release();
+                throw;
+            }
+
+            m_submission_tail = at<unsigned>(m_submission_ring, parameters.sq_off.tail);
+            m_submission_mask = at<unsigned>(m_submission_ring, parameters.sq_off.ring_mask);
+            m_submission_array = at<unsigned>(m_submission_ring, parameters.sq_off.array);
+            m_completion_head = at<unsigned>(m_completion_ring, parameters.cq_off.head);
+            m_completion_tail = at<unsigned>(m_completion_ring, parameters.cq_off.tail);
+            m_completion_mask = at<unsigned>(m_completion_ring, parameters.cq_off.ring_mask);
+            m_completions = at<io_uring_cqe>(m_completion_ring, parameters.cq_off.cqes);
+        }
+
+        read_ring(const read_ring&) = delete;
+        read_ring& operator=(const read_ring&) = delete;
+
+        ~read_ring() {
+            release();
+        }
+
+        /**
+         * @brief Queues a read of _bytes bytes at _offset of _descriptor into _destination, tagged with _tag. The read
+         *        is handed to the kernel by the next submit() or wait().
+         */
+        void read(int _descriptor, void* _destination, std::size_t _bytes, std::uint64_t _offset, unsigned _tag) {
+            m_vectors[_tag].iov_base = _destination;
+            m_vectors[_tag].iov_len = _bytes;
+
+            io_uring_sqe& submission = next_submission();
+            submission.opcode = IORING_OP_READV;
+            submission.fd = _descriptor;
+            submission.addr = reinterpret_cast<std::uint64_t>(&m_vectors[_tag]);
+            submission.len = 1;
+            submission.off = _offset;
+            submission.user_data = _tag;
+            queue();
+
+            m_in_flight[_tag] = true;
+            ++m_pending;
+        }
+
+        /**
+         * @brief Hands the queued reads to the kernel without waiting for them.
+         */
+        void submit() {
+            enter(0);
+        }
+
+        /**
+         * @brief Hands the queued reads to the kernel and waits until at least one completion can be collected.
+         */
+        void wait() {
+            enter(1);
+        }
+
+        /**
+         * @brief Calls _f(tag, result) for every completed read, where result is the number of bytes read or a
+         *        negated errno value, such as -ECANCELED for a cancelled read.
+         */
+        template <typename F>
+        void collect(F&& _f) {
+            unsigned head = *m_completion_head;
+            const unsigned tail = __atomic_load_n(m_completion_tail, __ATOMIC_ACQUIRE);
+
+            for (; head != tail; ++head) {
+                const io_uring_cqe& completion = m_completions[head & *m_completion_mask];
+
+                //Cancellations are tagged past the reads and only matter through the reads they complete.
+                if (completion.user_data < m_reads) {
+                    const unsigned tag = static_cast<unsigned>(completion.user_data);
+                    m_in_flight[tag] = false;
+                    --m_pending;
+                    _f(tag, completion.res);
+                }
+            }
+
+            __atomic_store_n(m_completion_head, head, __ATOMIC_RELEASE);
+        }
+
+        /**
+         * @brief Asks the kernel to cancel every read queued or in flight. Reads already running may still complete.
+         */
+        void cancel() {
+            for (unsigned tag = 0; tag < m_reads; ++tag) {
+                if (m_in_flight[tag]) {
+                    io_uring_sqe& submission = next_submission();
+                    submission.opcode = IORING_OP_ASYNC_CANCEL;
+                    submission.fd = -1;
+                    submission.addr = tag;
+                    submission.user_data = m_reads + tag;
+                    queue();
+                }
+            }
+        }
+
+        /**
+         * @brief Waits until every read has completed and discards the results, so that no more writes reach the
+         *        buffers. Returns false if the ring fails first, in which case the kernel may still write to them.
+         */
+        bool drain() noexcept {
+            try {
+                while (m_pending != 0) {
+                    wait();
+                    collect([](unsigned, int) { });
+                }
+
+                return true;
+            } catch (const std::system_error&) {
+                return false;
+            }
+        }
+
+        /**
+         * @brief Returns the number of reads queued or in flight.
+         */
+        unsigned pending() const { return m_pending; }
+
+        /**
+         * @brief Returns the number of reads the ring accepts at a time.
+         */
+        unsigned entries() const { return m_reads; }
+    };
+#endif
+
+    /**
+     * @brief Options of an async_file_range: the size in bytes of a block, rounded down to whole records, the number
+     *        of blocks buffered ahead of the consumer and the number of threads issuing reads. With use_io_uring, the
+     *        reads of builds defining ITERATOR_BASED_FOR_USE_IO_URING are kept in flight by one thread through
+     *        io_uring instead, where the kernel can set up a ring.
+     */
+    struct async_file_options {
+        std::size_t block_size = std::size_t(1) << 20;
+        std::size_t depth = 4;
+        std::size_t threads = 1;
+        bool use_io_uring = true;
+    };
+
+    /**
+     * @brief Streams the trivially copyable records of type T stored in a file while the next blocks are being read
+     *        by background threads with pread, or through io_uring where it is enabled and available, keeping up to
+     *        depth blocks in flight or buffered, so reading the file overlaps with processing it. The loop iterates
+     *        one block while the following ones are filled:
+     *
+     *        async_file_range<record> records("huge.bin");
+     *        for (const record& r : records) { ... }
+     *
+     *        The range is single-pass: begin() continues where the previous iteration stopped. A read error is
+     *        rethrown as std::system_error from the iterator increment that needs the failed block, and a trailing
+     *        partial record is not part of the range.
+     */
+    template <typename T>
+    class async_file_range {
+        static_assert(std::is_trivially_copyable<T>::value, "async_file_range requires trivially copyable records");
+
+        friend class async_record_iterator<T>;
+
+    private:
+        enum class slot_state {
+            free,
+            reading,
+            ready
+        };
+
+        struct slot {
+            std::unique_ptr<char[]> storage;
+            char* data;
+            std::size_t bytes;
+            std::size_t block;
+            slot_state state;
+            std::exception_ptr error;
+
+            slot() : storage(), data(nullptr), bytes(0), block(0), state(slot_state::free), error() { }
+            slot(slot&&) = default;
+            slot& operator=(slot&&) = default;
+            slot(const slot&) = delete;
+            slot& operator=(const slot&) = delete;
+        };
+
+        int m_descriptor;
+        bool m_owns_descriptor;
+        std::size_t m_block_size;
+        std::vector<slot> m_slots;
+        std::mutex m_mutex;
+        std::condition_variable m_changed;
+        std::size_t m_next_read;
+        std::size_t m_end_block;
+        std::size_t m_current;
+        bool m_holding;
+        bool m_stop;
+        std::vector<std::thread> m_threads;
+#if ITERATOR_BASED_FOR_HAS_IO_URING
+        std::unique_ptr<read_ring> m_ring;
+#endif
+
+        void read_blocks() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            while (!m_stop && m_next_read < m_end_block) {
+                const std::size_t block = m_next_read++;
+                slot& target = m_slots[block % m_slots.size()];
+
+                m_changed.wait(lock, [this, &target, block]() {
+                    return m_stop || (target.state == slot_state::free && target.block == block);
+                });
+
+                if (m_stop) {
+                    break;
+                }
+
+                if (block >= m_end_block) {
+                    target.bytes = 0;
+                    target.state = slot_state::ready;
+                    m_changed.notify_all();
+                    continue;
+                }
+
+                target.state = slot_state::reading;
+                lock.unlock();
+
+                std::size_t bytes = 0;
+                std::exception_ptr error;
+
+                try {
+                    bytes = read_block(target.data, block);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+
+                lock.lock();
+                target.bytes = bytes;
+                target.error = error;
+                target.state = slot_state::ready;
+
+                if (bytes < m_block_size) {
+                    m_end_block = std::min(m_end_block, block + 1);
+                }
+
+                m_changed.notify_all();
+            }
+        }
+
+#if ITERATOR_BASED_FOR_HAS_IO_URING
+        /**
+         * @brief Keeps a read in flight through the ring for every free slot whose block is due, and marks the blocks
+         *        ready as their reads complete. Short reads are continued where they stopped, and the reads still in
+         *        flight are waited for before returning, since they write into the slots.
+         */
+        void ring_blocks() {
+            struct progress {
+                std::size_t block;
+                std::size_t filled;
+                int error;
+                bool done;
+            };
+
+            std::vector<progress> reads(m_slots.size(), progress{0, 0, 0, false});
+            std::size_t in_flight = 0;
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            const auto queue = [this, &reads](unsigned _slot) {
+                const progress& read = reads[_slot];
+                m_ring->read(m_descriptor, m_slots[_slot].data + read.filled, m_block_size - read.filled,
+                             read.block * m_block_size + read.filled, _slot);
+            };
+
+            for (;;) {
+                while (!m_stop && m_next_read < m_end_block) {
+                    const unsigned index = static_cast<unsigned>(m_next_read % m_slots.size());
+                    slot& target = m_slots[index];
+
+                    if (target.state != slot_state::free || target.block != m_next_read) {
+                        break;
+                    }
+
+                    target.state = slot_state::reading;
+                    reads[index] = progress{m_next_read++, 0, 0, false};
+                    queue(index);
+                    ++in_flight;
+                }
+
+                if (in_flight == 0) {
+                    if (m_stop || m_next_read >= m_end_block) {
+                        return;
+                    }
+
+                    m_changed.wait(lock);
+                    continue;
+                }
+
+                lock.unlock();
+
+                try {
+                    m_ring->wait();
+                } catch (...) {
+                    //The ring itself failed, so the blocks being read report the error once the kernel is done with
+                    //their slots. Should the ring not even tell when that is, the slots are leaked rather than reused.
+                    const std::exception_ptr error = std::current_exception();
+                    m_ring->cancel();
+                    const bool drained = m_ring->drain();
+                    lock.lock();
+
+                    for (slot& target : m_slots) {
+                        if (target.state == slot_state::reading) {
+                            if (!drained) {
+                                static_cast<void>(target.storage.release());
+                            }
+
+                            target.bytes = 0;
+                            target.error = error;
+                            target.state = slot_state::ready;
+                            m_end_block = std::min(m_end_block, target.block + 1);
+                        }
+                    }
+
+                    m_changed.notify_all();
+                    return;
+                }
+
+                m_ring->collect([&reads, &queue, this](unsigned _slot, int _result) {
+                    progress& read = reads[_slot];
+
+                    if (_result == -EINTR || _result == -EAGAIN) {
+                        queue(_slot);
+                    } else if (_result < 0) {
+                        read.error = -_result;
+                        read.done = true;
+                    } else {
+                        read.filled += static_cast<std::size_t>(_result);
+                        read.done = _result == 0 || read.filled == m_block_size;
+
+                        if (!read.done) {
+                            queue(_slot);
+                        }
+                    }
+                });
+
+                lock.lock();
+
+                for (std::size_t i = 0; i < reads.size(); ++i) {
+                    progress& read = reads[i];
+
+                    if (!read.done) {
+                        continue;
+                    }
+
+                    slot& target = m_slots[i];
+                    target.bytes = read.error ? 0 : read.filled;
+                    target.error = read.error ? std::make_exception_ptr(std::system_error(
+                            read.error, std::generic_category(), "async_file_range: read failed")) : nullptr;
+                    target.state = slot_state::ready;
+
+                    if (target.bytes < m_block_size) {
+                        m_end_block = std::min(m_end_block, read.block + 1);
+                    }
+
+                    read.done = false;
+                    --in_flight;
+                }
+
+                m_changed.notify_all();
+            }
+        }
+#endif
+
+        std::size_t read_block(char* _destination, std::size_t _block) {
+            const off_t offset = static_cast<off_t>(_block * m_block_size);
+            std::size_t bytes = 0;
+
+            while (bytes < m_block_size) {
+                const ssize_t result = ::pread(m_descriptor, _destination + bytes, m_block_size - bytes,
+                                               offset + static_cast<off_t>(bytes));
+
+                if (result == 0) {
+                    break;
+                }
+
+                if (result < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    throw std::system_error(errno, std::generic_category(), "async_file_range: read failed");
+                }
+
+                bytes += static_cast<std::size_t>(result);
+            }
+
+            return bytes;
+        }
+
+        /**
+         * @brief Releases the block the consumer holds, waits for the next one and stores its records in [_first,
+         *        _last). Returns false at the end of the file.
+         */
+        bool next_block(const T*& _first, const T*& _last) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            if (m_holding) {
+                slot& done = m_slots[m_current % m_slots.size()];
+                done.state = slot_state::free;
+                done.block += m_slots.size();
+                ++m_current;
+                m_holding = false;
+                m_changed.notify_all();
+            }
+
+            if (m_current >= m_end_block) {
+                return false;
+            }
+
+            slot& next = m_slots[m_current % m_slots.size()];
+            m_changed.wait(lock, [&next, this]() {
+                return (next.state == slot_state::ready && next.block == m_current) || m_current >= m_end_block;
+            });
+
+            if (next.state != slot_state::ready || next.block != m_current) {
+                return false;
+            }
+
+            m_holding = true;
+
+            if (next.error) {
+                std::rethrow_exception(next.error);
+            }
+
+            _first = reinterpret_cast<const T*>(next.data);
+            _last = _first + next.bytes / sizeof(T);
+            return next.bytes != 0;
+        }
+
+        void start(const async_file_options& _options) {
+            const std::size_t depth = std::max<std::size_t>(_options.depth, 1);
+            m_slots.resize(depth);
+
+            for (std::size_t i = 0; i < depth; ++i) {
+                m_slots[i].storage.reset(new char[m_block_size + block_reader::buffer_alignment]);
+                const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(m_slots[i].storage.get());
+                m_slots[i].data = m_slots[i].storage.get() + (block_reader::buffer_alignment
+                                  - address % block_reader::buffer_alignment) % block_reader::buffer_alignment;
+                m_slots[i].bytes = 0;
+                m_slots[i].block = i;
+                m_slots[i].state = slot_state::free;
+            }
+
+#if ITERATOR_BASED_FOR_HAS_IO_URING
+            if (_options.use_io_uring) {
+                try {
+                    m_ring.reset(new read_ring(static_cast<unsigned>(depth)));
+                } catch (const std::system_error&) {
+                    //Kernels without io_uring, and sandboxes forbidding it, are served by the pread threads.
+                }
+
+                if (m_ring) {
+                    m_threads.emplace_back(&async_file_range::ring_blocks, this);
+                    return;
+                }
+            }
+#endif
+
+            for (std::size_t i = 0; i < std::max<std::size_t>(_options.threads, 1); ++i) {
+                m_threads.emplace_back(&async_file_range::read_blocks, this);
+            }
+        }
+
+        static int open_descriptor(const std::string& _path) {
+            const int descriptor = ::open(_path.c_str(), O_RDONLY);
+
+            if (descriptor < 0) {
+                throw std::system_error(errno, std::generic_category(), "async_file_range: cannot open " + _path);
+            }
+
+            return descriptor;
+        }
+
+        static std::size_t record_block_size(const async_file_options& _options) {
+            const std::size_t records = _options.block_size / sizeof(T);
+            return (records ? records : 1) * sizeof(T);
+        }
+
+    public:
+        using iterator = async_record_iterator<T>;
+
+        /**
+         * @brief Streams the file descriptor _descriptor from its start. The descriptor must support pread and is not
+         *        closed by the range.
+         */
+        explicit async_file_range(int _descriptor, const async_file_options& _options = async_file_options()) :
+                m_descriptor(_descriptor), m_owns_descriptor(false), m_block_size(record_block_size(_options)),
+                m_slots(), m_mutex(), m_changed(), m_next_read(0), m_end_block(SIZE_MAX), m_current(0),
+                m_holding(false), m_stop(false), m_threads()
+#if ITERATOR_BASED_FOR_HAS_IO_URING
+                , m_ring()
+#endif
+        {
+            start(_options);
+        }
+
+        /**
+         * @brief Streams the file at _path. Throws std::system_error if it cannot be opened.
+         */
+        explicit async_file_range(const std::string& _path, const async_file_options& _options = async_file_options()) :
+                async_file_range(open_descriptor(_path), _options) {
+            m_owns_descriptor = true;
+        }
+
+        async_file_range(const async_file_range&) = delete;
+        async_file_range& operator=(const async_file_range&) = delete;
+
+        ~async_file_range() {
+            stop();
+
+            if (m_owns_descriptor) {
+                ::close(m_descriptor);
+            }
+        }
+
+        /**
+         * @brief Stops the background reads and waits for the threads. Iteration past the blocks already read ends.
+         */
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+                m_end_block = std::min(m_end_block, m_current + (m_holding ? 1 : 0));
+            }
+
+            m_changed.notify_all();
+
+            for (std::thread& thread : m_threads) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+            }
+        }
+
+        /**
+         * @brief Returns whether the blocks are read through io_uring rather than by pread threads.
+         */
+        bool uses_io_uring() const {
+#if ITERATOR_BASED_FOR_HAS_IO_URING
+            return m_ring != nullptr;
+#else
+            return false;
+#endif
+        }
+
+        iterator begin() { return iterator(*this); }
+        iterator end() { return iterator(); }
+    };
+
+    template <typename T>
+    class async_file_sink;
+
+    /**
+     * @brief Output iterator appending every record assigned through it to an async_file_sink, so that
+     *        copy(range, sink.begin()) writes a range.
+     */
+    template <typename T>
+    class async_sink_iterator {
+    private:
+        async_file_sink<T>* m_sink;
+
+    public:
+        using iterator_category = std::output_iterator_tag;
+        using value_type = void;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = void;
+
+        explicit async_sink_iterator(async_file_sink<T>& _sink) : m_sink(&_sink) { }
+
+        async_sink_iterator& operator=(const T& _record) {
+            m_sink->push(_record);
+            return *this;
+        }
+
+        async_sink_iterator& operator*() { return *this; }
+        async_sink_iterator& operator++() { return *this; }
+        async_sink_iterator operator++(int) { return *this; }
+    };
+
+    /**
+     * @brief Options of an async_file_sink: the size in bytes of a block, rounded down to whole records, and the
+     *        number of blocks, one of which is filled while the others are written.
+     */
+    struct async_sink_options {
+        std::size_t block_size = std::size_t(1) << 20;
+        std::size_t depth = 2;
+    };
+
+    /**
+     * @brief Buffers the trivially copyable records of type T written to it in large aligned blocks and writes every
+     *        full block to a file on a background thread, while the next block is being filled, so that writing the
+     *        results of a loop costs a copy into memory instead of a system call per record:
+     *
+     *        async_file_sink<result> out("results.bin");
+     *        copy((results.begin(), results.end()), out.begin());
+     *        out.close();
+     *
+     *        With the default depth of 2 the blocks are double-buffered; a producer faster than the file waits for a
+     *        free block. A write error is rethrown as std::system_error from the push(), write() or flush() that
+     *        follows it, and the blocks after the failed one are discarded. The destructor closes the sink but
+     *        ignores errors, so call close() to see them.
+     */
+    template <typename T>
+    class async_file_sink {
+        static_assert(std::is_trivially_copyable<T>::value, "async_file_sink requires trivially copyable records");
+
+    private:
+        struct slot {
+            std::unique_ptr<char[]> storage;
+            char* data;
+            std::size_t bytes;
+            bool queued;
+
+            slot() : storage(), data(nullptr), bytes(0), queued(false) { }
+            slot(slot&&) = default;
+            slot& operator=(slot&&) = default;
+            slot(const slot&) = delete;
+            slot& operator=(const slot&) = delete;
+        };
+
+        int m_descriptor;
+        bool m_owns_descriptor;
+        std::size_t m_block_size;
+        std::vector<slot> m_slots;
+        std::mutex m_mutex;
+        std::condition_variable m_changed;
+        std::size_t m_filling;
+        std::size_t m_written;
+        char* m_position;
+        char* m_end;
+        bool m_stop;
+        std::exception_ptr m_error;
+        std::thread m_thread;
+
+        void write_blocks() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            for (;;) {
+                slot& next = m_slots[m_written % m_slots.size()];
+                m_changed.wait(lock, [this, &next]() { return m_stop || next.queued; });
+
+                if (!next.queued) {
+                    break;
+                }
+
+                if (!m_error) {
+                    lock.unlock();
+                    std::exception_ptr error;
+
+                    try {
+                        write_block(next.data, next.bytes);
+                    } catch (...) {
+                        error = std::current_exception();
+                    }
+
+                    lock.lock();
+                    m_error = error;
+                }
+
+                next.queued = false;
+                ++m_written;
+                m_changed.notify_all();
+            }
+        }
+
+        void write_block(const char* _source, std::size_t _bytes) {
+            std::size_t bytes = 0;
+
+            while (bytes < _bytes) {
+                const ssize_t result = ::write(m_descriptor, _source + bytes, _bytes - bytes);
+
+                if (result < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    throw std::system_error(errno, std::generic_category(), "async_file_sink: write failed");
+                }
+
+                bytes += static_cast<std::size_t>(result);
+            }
+        }
+
+        /**
+         * @brief Hands the block being filled to the background thread if it holds any records and waits until the
+         *        next block is free to be filled.
+         */
+        void submit() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            slot& filled = m_slots[m_filling % m_slots.size()];
+
+            if (m_position != filled.data) {
+                filled.bytes = static_cast<std::size_t>(m_position - filled.data);
+                filled.queued = true;
+                ++m_filling;
+                m_changed.notify_all();
+            }
+
+            slot& next = m_slots[m_filling % m_slots.size()];
+            m_changed.wait(lock, [&next]() { return !next.queued; });
+            m_position = next.data;
+            m_end = next.data + m_block_size;
+
+            if (m_error) {
+                std::rethrow_exception(m_error);
+            }
+        }
+
+        void start(const async_sink_options& _options) {
+            const std::size_t depth = std::max<std::size_t>(_options.depth, 1);
+            m_slots.resize(depth);
+
+            for (slot& s : m_slots) {
+                s.storage.reset(new char[m_block_size + block_reader::buffer_alignment]);
+                const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(s.storage.get());
+                s.data = s.storage.get() + (block_reader::buffer_alignment - address % block_reader::buffer_alignment)
+                         % block_reader::buffer_alignment;
+            }
+
+            m_position = m_slots[0].data;
+            m_end = m_position + m_block_size;
+            m_thread = std::thread(&async_file_sink::write_blocks, this);
+        }
+
+        static int open_descriptor(const std::string& _path) {
+            const int descriptor = ::open(_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+            if (descriptor < 0) {
+                throw std::system_error(errno, std::generic_category(), "async_file_sink: cannot open " + _path);
+            }
+
+            return descriptor;
+        }
+
+        static std::size_t record_block_size(const async_sink_options& _options) {
+            const std::size_t records = _options.block_size / sizeof(T);
+            return (records ? records : 1) * sizeof(T);
+        }
+
+    public:
+        using iterator = async_sink_iterator<T>;
+
+        /**
+         * @brief Writes to the file descriptor _descriptor from its current offset. The descriptor is not closed by
+         *        the sink.
+         */
+        explicit async_file_sink(int _descriptor, const async_sink_options& _options = async_sink_options()) :
+                m_descriptor(_descriptor), m_owns_descriptor(false), m_block_size(record_block_size(_options)),
+                m_slots(), m_mutex(), m_changed(), m_filling(0), m_written(0), m_position(nullptr), m_end(nullptr),
+                m_stop(false), m_error(), m_thread() {
+            start(_options);
+        }
+
+        /**
+         * @brief Creates or truncates the file at _path and writes to it. Throws std::system_error if it cannot be
+         *        opened.
+         */
+        explicit async_file_sink(const std::string& _path, const async_sink_options& _options = async_sink_options()) :
+                async_file_sink(open_descriptor(_path), _options) {
+            m_owns_descriptor = true;
+        }
+
+        async_file_sink(const async_file_sink&) = delete;
+        async_file_sink& operator=(const async_file_sink&) = delete;
+
+        ~async_file_sink() {
+            try {
+                close();
+            } catch (...) {
+            }
+        }
+
+        /**
+         * @brief Appends _record to the block being filled, handing the block to the background thread once it is
+         *        full.
+         */
+        void push(const T& _record) {
+            if (static_cast<std::size_t>(m_end - m_position) < sizeof(T)) {
+                submit();
+            }
+
+            std::memcpy(m_position, &_record, sizeof(T));
+            m_position += sizeof(T);
+        }
+
+        /**
+         * @brief Appends the _n records at _records, copying them into the blocks a block at a time.
+         */
+        void write(const T* _records, std::size_t _n) {
+            const char* source = reinterpret_cast<const char*>(_records);
+            std::size_t bytes = _n * sizeof(T);
+
+            while (bytes) {
+                if (m_position == m_end) {
+                    submit();
+                }
+
+                const std::size_t count = std::min(bytes, static_cast<std::size_t>(m_end - m_position));
+                std::memcpy(m_position, source, count);
+                m_position += count;
+                source += count;
+                bytes -= count;
+            }
+        }
+
+        /**
+         * @brief Writes the records pushed so far, including a partly filled block, and waits until they are
+         *        written. Throws std::system_error if a write failed.
+         */
+        void flush() {
+            if (m_thread.joinable()) {
+                submit();
+
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_changed.wait(lock, [this]() { return m_written == m_filling; });
+            }
+
+            if (m_error) {
+                std::rethrow_exception(m_error);
+            }
+        }
+
+        /**
+         * @brief Flushes the sink, stops the background thread and closes the file if the sink opened it. Records
+         *        cannot be pushed afterwards.
+         */
+        void close() {
+            std::exception_ptr error;
+
+            try {
+                flush();
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            if (m_thread.joinable()) {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stop = true;
+                }
+
+                m_changed.notify_all();
+                m_thread.join();
+            }
+
+            if (m_owns_descriptor) {
+                m_owns_descriptor = false;
+
+                if (::close(m_descriptor) != 0 && !error) {
+                    error = std::make_exception_ptr(std::system_error(errno, std::generic_category(),
+                                                                      "async_file_sink: close failed"));
+                }
+            }
+
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        iterator begin() { return iterator(*this); }
+    };
+
+#endif
+
+    /**
+     * @brief Element types of the columns of a columnar file.
+     */
+    enum class column_type : std::uint32_t {
+        int8 = 1,
+        uint8,
+        int16,
+        uint16,
+        int32,
+        uint32,
+        int64,
+        uint64,
+        float32,
+        float64
+    };
+
+    template <typename T>
+    struct column_type_of;
+
+    template <> struct column_type_of<std::int8_t> : std::integral_constant<column_type, column_type::int8> { };
+    template <> struct column_type_of<std::uint8_t> : std::integral_constant<column_type, column_type::uint8> { };
+    template <> struct column_type_of<std::int16_t> : std::integral_constant<column_type, column_type::int16> { };
+    template <> struct column_type_of<std::uint16_t> : std::integral_constant<column_type, column_type::uint16> { };
+    template <> struct column_type_of<std::int32_t> : std::integral_constant<column_type, column_type::int32> { };
+    template <> struct column_type_of<std::uint32_t> : std::integral_constant<column_type, column_type::uint32> { };
+    template <> struct column_type_of<std::int64_t> : std::integral_constant<column_type, column_type::int64> { };
+    template <> struct column_type_of<std::uint64_t> : std::integral_constant<column_type, column_type::uint64> { };
+    template <> struct column_type_of<float> : std::integral_constant<column_type, column_type::float32> { };
+    template <> struct column_type_of<double> : std::integral_constant<column_type, column_type::float64> { };
+
+    /**
+     * @brief Returns the size of an element of type _type, or zero if _type is not a column_type.
+     */
+    inline std::size_t column_type_size(column_type _type) {
+        switch (_type) {
+            case column_type::int8: case column_type::uint8: return 1;
+            case column_type::int16: case column_type::uint16: return 2;
+            case column_type::int32: case column_type::uint32: case column_type::float32: return 4;
+            case column_type::int64: case column_type::uint64: case column_type::float64: return 8;
+        }
+
+        return 0;
+    }
+
+    /**
+     * @brief Alignment of the columns and statistics in a columnar file, one cache line, so that every column can be
+     *        scanned with aligned vector loads straight from the mapping.
+     */
+    constexpr std::size_t columnar_alignment = 64;
+
+    /**
+     * @brief The first 64 bytes of a columnar file, in the byte order of the machine that wrote it. The header is
+     *        followed by one columnar_column_entry per column; the columns and their statistics follow at the offsets
+     *        the entries give.
+     */
+    struct columnar_header {
+        char magic[8];
+        std::uint64_t rows;
+        std::uint64_t block_rows;
+        std::uint32_t columns;
+        std::uint32_t reserved;
+        std::uint64_t padding[4];
+    };
+
+    /**
+     * @brief The description of a column in a columnar file. The statistics are the smallest and the largest value of
+     *        every block of block_rows rows, stored as pairs of elements.
+     */
+    struct columnar_column_entry {
+        char name[40];
+        column_type type;
+        std::uint32_t reserved;
+        std::uint64_t data_offset;
+        std::uint64_t statistics_offset;
+    };
+
+    static_assert(sizeof(columnar_header) == 64 && sizeof(columnar_column_entry) == 64,
+                  "columnar file structures must keep their on-disk size");
+
+    constexpr char columnar_magic[8] = {'I', 'B', 'F', 'C', 'O', 'L', 'S', '1'};
+
+    inline std::size_t columnar_aligned(std::size_t _offset) {
+        return (_offset + columnar_alignment - 1) / columnar_alignment * columnar_alignment;
+    }
+
+    /**
+     * @brief Writes columns of equal length to a columnar file together with the minimum and maximum of every block
+     *        of their rows, which columnar_file readers use to skip blocks:
+     *
+     *        columnar_writer writer;
+     *        writer.add_column("price", (prices.begin(), prices.end()));
+     *        writer.add_column("volume", (volumes.begin(), volumes.end()));
+     *        writer.write("trades.col");
+     *
+     *        The columns are not copied, so their elements must stay valid until write() has returned.
+     */
+    class columnar_writer {
+    public:
+        /**
+         * @brief Default number of rows of a block with statistics.
+         */
+        static constexpr std::size_t default_block_rows = std::size_t(1) << 16;
+
+    private:
+        struct column {
+            std::string name;
+            column_type type;
+            const char* data;
+            std::size_t bytes;
+            std::vector<char> statistics;
+        };
+
+        std::size_t m_block_rows;
+        std::size_t m_rows;
+        std::vector<column> m_columns;
+
+        static void pad(std::ostream& _out, std::size_t& _offset, std::size_t _target) {
+            static const char zeros[columnar_alignment] = {};
+
+            _out.write(zeros, static_cast<std::streamsize>(_target - _offset));
+            _offset = _target;
+        }
+
+    public:
+        /**
+         * @brief Creates a writer whose statistics cover blocks of _block_rows rows. Throws std::invalid_argument if
+         *        _block_rows is zero.
+         */
+        explicit columnar_writer(std::size_t _block_rows = default_block_rows) :
+                m_block_rows(_block_rows), m_rows(0), m_columns() {
+            if (_block_rows == 0) {
+                throw std::invalid_argument("columnar_writer: blocks must have at least one row");
+            }
+        }
+
+        /**
+         * @brief Adds the column _name with the elements of the contiguous range _values. Throws
+         *        std::invalid_argument if the name is empty, longer than 39 bytes or already taken, or if the column
+         *        length differs from that of the columns added before.
+         */
+        template <typename Iterator, typename Sentinel>
+        void add_column(const std::string& _name, const iterator_range<Iterator, Sentinel>& _values) {
+            using T = typename std::remove_const<typename std::iterator_traits<Iterator>::value_type>::type;
+
+            static_assert(is_contiguous_iterator<Iterator>::value && is_sized_sentinel_for<Sentinel, Iterator>::value,
+                          "columnar_writer requires contiguous columns");
+
+            if (_name.empty() || _name.size() >= sizeof(columnar_column_entry().name)) {
+                throw std::invalid_argument("columnar_writer: column names must have 1 to 39 bytes");
+            }
+
+            for (const column& c : m_columns) {
+                if (c.name == _name) {
+                    throw std::invalid_argument("columnar_writer: duplicate column " + _name);
+                }
+            }
+
+            const std::size_t rows = _values.size();
+
+            if (!m_columns.empty() && rows != m_rows) {
+                throw std::invalid_argument("columnar_writer: column " + _name + " differs in length");
+            }
+
+            const T* values = IteratorBasedForImpl::to_address(_values.begin());
+            std::vector<char> statistics((rows + m_block_rows - 1) / m_block_rows * 2 * sizeof(T));
+
+            for (std::size_t first = 0, block = 0; first < rows; first += m_block_rows, ++block) {
+                const auto bounds = std::minmax_element(values + first, values + std::min(rows, first + m_block_rows));
+
+                std::memcpy(statistics.data() + 2 * block * sizeof(T), bounds.first, sizeof(T));
+                std::memcpy(statistics.data() + (2 * block + 1) * sizeof(T), bounds.second, sizeof(T));
+            }
+
+            m_rows = rows;
+            m_columns.push_back(column{_name, column_type_of<T>::value, reinterpret_cast<const char*>(values),
+                                       rows * sizeof(T), std::move(statistics)});
+        }
+
+        /**
+         * @brief Writes the columns added so far to the file at _path, replacing it. Throws std::system_error if the
+         *        file cannot be written.
+         */
+        void write(const std::string& _path) const {
+            std::ofstream out(_path, std::ios::binary | std::ios::trunc);
+
+            if (!out) {
+                throw std::system_error(std::make_error_code(std::errc::io_error),
+                                        "columnar_writer: cannot open " + _path);
+            }
+
+            columnar_header header = {};
+            std::memcpy(header.magic, columnar_magic, sizeof(columnar_magic));
+            header.rows = m_rows;
+            header.block_rows = m_block_rows;
+            header.columns = static_cast<std::uint32_t>(m_columns.size());
+
+            std::vector<columnar_column_entry> entries(m_columns.size());
+            std::size_t offset = sizeof(header) + entries.size() * sizeof(columnar_column_entry);
+
+            for (std::size_t c = 0; c < m_columns.size(); ++c) {
+                entries[c] = columnar_column_entry();
+                std::memcpy(entries[c].name, m_columns[c].name.data(), m_columns[c].name.size());
+                entries[c].type = m_columns[c].type;
+                entries[c].data_offset = columnar_aligned(offset);
+                entries[c].statistics_offset = columnar_aligned(entries[c].data_offset + m_columns[c].bytes);
+                offset = entries[c].statistics_offset + m_columns[c].statistics.size();
+            }
+
+            offset = 0;
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(entries.data()),
+                      static_cast<std::streamsize>(entries.size() * sizeof(columnar_column_entry)));
+            offset += sizeof(header) + entries.size() * sizeof(columnar_column_entry);
+
+            for (std::size_t c = 0; c < m_columns.size(); ++c) {
+                pad(out, offset, entries[c].data_offset);
+                out.write(m_columns[c].data, static_cast<std::streamsize>(m_columns[c].bytes));
+                offset += m_columns[c].bytes;
+                pad(out, offset, entries[c].statistics_offset);
+                out.write(m_columns[c].statistics.data(), static_cast<std::streamsize>(m_columns[c].statistics.size()));
+                offset += m_columns[c].statistics.size();
+            }
+
+            out.flush();
+
+            if (!out) {
+                throw std::system_error(std::make_error_code(std::errc::io_error),
+                                        "columnar_writer: cannot write " + _path);
+            }
+        }
+    };
+
+    /**
+     * @brief The smallest and the largest value of every block of rows of a column, to skip the blocks a scan's
+     *        predicate rules out. The bounds are unspecified for blocks of floating-point values that include NaN.
+     */
+    template <typename T>
+    class column_statistics {
+    private:
+        const T* m_bounds;
+        std::size_t m_blocks;
+
+    public:
+        column_statistics(const T* _bounds, std::size_t _blocks) : m_bounds(_bounds), m_blocks(_blocks) { }
+
+        std::size_t blocks() const { return m_blocks; }
+
+        const T& min(std::size_t _block) const { return m_bounds[2 * _block]; }
+        const T& max(std::size_t _block) const { return m_bounds[2 * _block + 1]; }
+
+        /**
+         * @brief Returns whether block _block may contain values in [_low, _high].
+         */
+        bool overlaps(std::size_t _block, const T& _low, const T& _high) const {
+            return !(max(_block) < _low) && !(_high < min(_block));
+        }
+
+        /**
+         * @brief Returns the blocks that may contain values in [_low, _high], in ascending order.
+         */
+        std::vector<std::size_t> blocks_overlapping(const T& _low, const T& _high) const {
+            std::vector<std::size_t> result;
+
+            for (std::size_t block = 0; block < m_blocks; ++block) {
+                if (overlaps(block, _low, _high)) {
+                    result.push_back(block);
+                }
+            }
+
+            return result;
+        }
+    };
+
+#if ITERATOR_BASED_FOR_HAS_FILE_DESCRIPTORS
+    /**
+     * @brief Maps a file written by columnar_writer and presents every column as a contiguous
+     *        iterator_range<const T*> into the mapping, so a scan reads only the pages of the columns it touches.
+     *        Together with the block statistics, a scan can skip the blocks its predicate rules out:
+     *
+     *        columnar_file trades("trades.col");
+     *        auto price = trades.column<double>("price");
+     *        auto volume = trades.column<std::int64_t>("volume");
+     *        for (std::size_t block : trades.statistics<double>("price").blocks_overlapping(100.0, 101.0)) {
+     *            for (std::size_t row : trades.rows_of_block(block)) { ... price.begin()[row] ... }
+     *        }
+     *
+     *        Ranges obtained from the file must not outlive it.
+     */
+    class columnar_file {
+    private:
+        mapped_file_range<char> m_file;
+        columnar_header m_header;
+        const columnar_column_entry* m_columns;
+
+        [[noreturn]] static void malformed(const std::string& _path) {
+            throw std::runtime_error("columnar_file: " + _path + " is not a valid columnar file");
+        }
+
+        const columnar_column_entry& entry(const std::string& _name, column_type _type) const {
+            for (std::size_t c = 0; c < m_header.columns; ++c) {
+                if (_name == m_columns[c].name) {
+                    if (m_columns[c].type != _type) {
+                        throw std::invalid_argument("columnar_file: column " + _name + " has another element type");
+                    }
+
+                    return m_columns[c];
+                }
+            }
+
+            throw std::invalid_argument("columnar_file: no column " + _name);
+        }
+
+    public:
+        /**
+         * @brief Maps the columnar file at _path. Throws std::system_error if it cannot be mapped and
+         *        std::runtime_error if it is not a valid columnar file.
+         */
+        explicit columnar_file(const std::string& _path, const mapped_file_options& _options = mapped_file_options()) :
+                m_file(_path, _options), m_header(), m_columns(nullptr) {
+            const std::size_t bytes = m_file.size();
+
+            if (bytes < sizeof(m_header)) {
+                malformed(_path);
+            }
+
+            std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+
+            if (std::memcmp(m_header.magic, columnar_magic, sizeof(columnar_magic)) != 0 || m_header.block_rows == 0
+                || m_header.columns > (bytes - sizeof(m_header)) / sizeof(columnar_column_entry)) {
+                malformed(_path);
+            }
+
+            m_columns = reinterpret_cast<const columnar_column_entry*>(m_file.data() + sizeof(m_header));
+
+            for (std::size_t c = 0; c < m_header.columns; ++c) {
+                const columnar_column_entry& column = m_columns[c];
+                const std::uint64_t size = column_type_size(column.type);
+                const std::uint64_t blocks = block_count();
+
+                if (size == 0 || column.name[sizeof(column.name) - 1] != '\0'
+                    || column.data_offset % columnar_alignment != 0
+                    || column.statistics_offset % columnar_alignment != 0
+                    || column.data_offset > bytes || m_header.rows > (bytes - column.data_offset) / size
+                    || column.statistics_offset > bytes || 2 * blocks > (bytes - column.statistics_offset) / size) {
+                    malformed(_path);
+                }
+            }
+        }
+
+        columnar_file(columnar_file&&) = default;
+        columnar_file& operator=(columnar_file&&) = default;
+
+        columnar_file(const columnar_file&) = delete;
+        columnar_file& operator=(const columnar_file&) = delete;
+
+        std::size_t rows() const { return static_cast<std::size_t>(m_header.rows); }
+
+        std::size_t block_rows() const { return static_cast<std::size_t>(m_header.block_rows); }
+
+        std::size_t block_count() const {
+            return static_cast<std::size_t>((m_header.rows + m_header.block_rows - 1) / m_header.block_rows);
+        }
+
+        std::size_t column_count() const { return m_header.columns; }
+
+        std::string column_name(std::size_t _column) const { return m_columns[_column].name; }
+
+        column_type type(std::size_t _column) const { return m_columns[_column].type; }
+
+        /**
+         * @brief Returns the column _name. Throws std::invalid_argument if there is no such column or its elements are
+         *        not of type T.
+         */
+        template <typename T>
+        iterator_range<const T*> column(const std::string& _name) const {
+            const columnar_column_entry& column = entry(_name, column_type_of<T>::value);
+            const T* first = reinterpret_cast<const T*>(m_file.data() + column.data_offset);
+
+            return iterator_range<const T*>(first, first + rows());
+        }
+
+        /**
+         * @brief Returns the block statistics of the column _name, with the exceptions of column().
+         */
+        template <typename T>
+        column_statistics<T> statistics(const std::string& _name) const {
+            const columnar_column_entry& column = entry(_name, column_type_of<T>::value);
+
+            return column_statistics<T>(reinterpret_cast<const T*>(m_file.data() + column.statistics_offset),
+                                        block_count());
+        }
+
+        /**
+         * @brief Returns the indices of the rows of block _block.
+         */
+        iterator_range<counting_iterator<std::size_t>> rows_of_block(std::size_t _block) const {
+            return iota<std::size_t>(_block * block_rows(), std::min(rows(), (_block + 1) * block_rows()));
+        }
+    };
+
+    class buffer_pool;
+
+    /**
+     * @brief A buffer lent by a buffer_pool, which gets it back when the handle is destroyed or reset. Handles are
+     *        move-only; a default-constructed handle holds no buffer. Of the buffer's capacity(), the first size()
+     *        bytes are in use, for example by a received message.
+     */
+    class pooled_buffer {
+    private:
+        buffer_pool* m_pool;
+        char* m_data;
+        std::size_t m_capacity;
+        std::size_t m_size;
+        bool m_truncated;
+
+        friend class buffer_pool;
+
+        pooled_buffer(buffer_pool& _pool, char* _data, std::size_t _capacity) noexcept :
+                m_pool(&_pool), m_data(_data), m_capacity(_capacity), m_size(0), m_truncated(false) {
+        }
+
+    public:
+        pooled_buffer() noexcept : m_pool(nullptr), m_data(nullptr), m_capacity(0), m_size(0), m_truncated(false) { }
+
+        pooled_buffer(pooled_buffer&& _other) noexcept :
+                m_pool(_other.m_pool), m_data(_other.m_data), m_capacity(_other.m_capacity), m_size(_other.m_size),
+                m_truncated(_other.m_truncated) {
+            _other.m_pool = nullptr;
+            _other.m_data = nullptr;
+        }
+
+        pooled_buffer& operator=(pooled_buffer&& _other) noexcept {
+            if (this != &_other) {
+                reset();
+                m_pool = _other.m_pool;
+                m_data = _other.m_data;
+                m_capacity = _other.m_capacity;
+                m_size = _other.m_size;
+                m_truncated = _other.m_truncated;
+                _other.m_pool = nullptr;
+                _other.m_data = nullptr;
+            }
+
+            return *this;
+        }
+
+        pooled_buffer(const pooled_buffer&) = delete;
+        pooled_buffer& operator=(const pooled_buffer&) = delete;
+
+        ~pooled_buffer() { reset(); }
+
+        /**
+         * @brief Returns the buffer to its pool.
+         */
+        inline void reset() noexcept;
+
+        explicit operator bool() const noexcept { return m_data != nullptr; }
+
+        char* data() const noexcept { return m_data; }
+        std::size_t capacity() const noexcept { return m_capacity; }
+        std::size_t size() const noexcept { return m_size; }
+        bool empty() const noexcept { return m_size == 0; }
+
+        /**
+         * @brief Returns whether the message was longer than the buffer and its end was discarded.
+         */
+        bool truncated() const noexcept { return m_truncated; }
+
+        /**
+         * @brief Sets the number of bytes in use, at most capacity(), and whether they are a truncated message.
+         */
+        void resize(std::size_t _size, bool _truncated = false) noexcept {
+            m_size = _size;
+            m_truncated = _truncated;
+        }
+
+        const char* begin() const noexcept { return m_data; }
+        const char* end() const noexcept { return m_data + m_size; }
+
+        /**
+         * @brief Returns the bytes in use as an iterator_range into the buffer, valid while the handle holds it.
+         */
+        iterator_range<const char*> range() const noexcept { return iterator_range<const char*>(begin(), end()); }
+    };
+
+    /**
+     * @brief A fixed number of equally sized buffers allocated once, page aligned and, where the process may lock
+     *        memory, pinned in RAM with mlock so that receiving into them never takes a page fault. Buffers are lent
+     *        as pooled_buffer handles; any thread may return them. The pool must outlive its handles.
+     */
+    class buffer_pool {
+    private:
+        std::size_t m_buffer_size;
+        std::size_t m_buffer_count;
+        std::unique_ptr<char[]> m_storage;
+        char* m_buffers;
+        bool m_pinned;
+        std::mutex m_mutex;
+        std::condition_variable m_released;
+        std::vector<char*> m_free;
+
+        friend class pooled_buffer;
+
+        void release(char* _buffer) noexcept {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_free.push_back(_buffer);
+            }
+
+            m_released.notify_one();
+        }
+
+        pooled_buffer take() {
+            char* buffer = m_free.back();
+            m_free.pop_back();
+            return pooled_buffer(*this, buffer, m_buffer_size);
+        }
+
+    public:
+        /**
+         * @brief Alignment of the pool's memory.
+         */
+        static constexpr std::size_t alignment = 4096;
+
+        /**
+         * @brief Allocates _buffer_count buffers of _buffer_size bytes each, rounded up to a multiple of 64, and pins
+         *        them if _pin is set. Pinning is best effort; see pinned().
+         */
+        buffer_pool(std::size_t _buffer_count, std::size_t _buffer_size, bool _pin = true) :
+                m_buffer_size((std::max<std::size_t>(_buffer_size, 1) + 63) / 64 * 64),
+                m_buffer_count(_buffer_count),
+                m_storage(new char[m_buffer_size * _buffer_count + alignment]),
+                m_buffers(nullptr),
+                m_pinned(false),
+                m_mutex(),
+                m_released(),
+                m_free() {
+            const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(m_storage.get());
+            m_buffers = m_storage.get() + (alignment - address % alignment) % alignment;
+
+            if (_pin && m_buffer_count != 0) {
+                m_pinned = ::mlock(m_buffers, m_buffer_size * m_buffer_count) == 0;
+            }
+
+            m_free.reserve(m_buffer_count);
+
+            for (std::size_t i = m_buffer_count; i-- > 0;) {
+                m_free.push_back(m_buffers + i * m_buffer_size);
+            }
+        }
+
+        buffer_pool(const buffer_pool&) = delete;
+        buffer_pool& operator=(const buffer_pool&) = delete;
+
+        ~buffer_pool() {
+            if (m_pinned) {
+                ::munlock(m_buffers, m_buffer_size * m_buffer_count);
+            }
+        }
+
+        /**
+         * @brief Lends a buffer, waiting until another thread returns one if all are lent.
+         */
+        pooled_buffer acquire() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_released.wait(lock, [this]() { return !m_free.empty(); });
+            return take();
+        }
+
+        /**
+         * @brief Lends a buffer, or returns an empty handle if all are lent.
+         */
+        pooled_buffer try_acquire() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_free.empty() ? pooled_buffer() : take();
+        }
+
+        std::size_t buffer_size() const { return m_buffer_size; }
+        std::size_t buffer_count() const { return m_buffer_count; }
+
+        /**
+         * @brief Returns the number of buffers not lent at the moment.
+         */
+        std::size_t available() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_free.size();
+        }
+
+        /**
+         * @brief Returns whether the buffers are locked in RAM. mlock fails without the privilege or beyond the
+         *        RLIMIT_MEMLOCK limit of the process, in which case the pool works with ordinary pages.
+         */
+        bool pinned() const { return m_pinned; }
+    };
+
+    inline void pooled_buffer::reset() noexcept {
+        if (m_data) {
+            m_pool->release(m_data);
+            m_pool = nullptr;
+            m_data = nullptr;
+        }
+
+        m_size = 0;
+        m_truncated = false;
+    }
+
+    /**
+     * @brief Input range over the messages received from a socket, each read straight into a buffer of a
+     *        buffer_pool and handed out as the pooled_buffer holding it, so nothing is copied between the kernel and
+     *        the parser:
+     *
+     *        buffer_pool pool(64, 2048);
+     *        socket_receive_range feed(descriptor, pool);
+     *        for (pooled_buffer& packet : feed) { parse(packet.range()); }
+     *
+     *        Every datagram of a datagram socket is one message; a stream socket yields whatever each read returns.
+     *        The previous message goes back to the pool when the iteration advances unless it was moved out of the
+     *        range first, which keeps its buffer until that handle is destroyed. The range ends when a stream socket
+     *        is shut down by its peer or, for a non-blocking socket, when no message is pending. While every buffer
+     *        of the pool is held elsewhere, receiving waits for one to be returned. Receive errors are thrown as
+     *        std::system_error. The descriptor is not closed by the range.
+     */
+    class socket_receive_range {
+    private:
+        int m_socket;
+        buffer_pool* m_pool;
+        bool m_stream;
+        pooled_buffer m_message;
+
+        static bool is_stream_socket(int _socket) {
+            int type = 0;
+            socklen_t length = sizeof(type);
+
+            return ::getsockopt(_socket, SOL_SOCKET, SO_TYPE, &type, &length) == 0 && type == SOCK_STREAM;
+        }
+
+    public:
+        /**
+         * @brief Input iterator over the messages of a socket_receive_range. A value-initialized iterator is the end
+         *        iterator.
+         */
+        class iterator {
+        private:
+            socket_receive_range* m_range;
+
+            void next() {
+                if (!m_range->receive()) {
+                    m_range = nullptr;
+                }
+            }
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = pooled_buffer;
+            using difference_type = std::ptrdiff_t;
+            using pointer = pooled_buffer*;
+            using reference = pooled_buffer&;
+
+            iterator() : m_range(nullptr) { }
+
+            explicit iterator(socket_receive_range& _range) : m_range(&_range) { next(); }
+
+            reference operator*() const { return m_range->m_message; }
+            pointer operator->() const { return &m_range->m_message; }
+
+            iterator& operator++() {
+                next();
+                return *this;
+            }
+
+            bool operator==(const iterator& rhs) const { return m_range == rhs.m_range; }
+            bool operator!=(const iterator& rhs) const { return m_range != rhs.m_range; }
+        };
+
+        socket_receive_range(int _socket, buffer_pool& _pool) :
+                m_socket(_socket), m_pool(&_pool), m_stream(is_stream_socket(_socket)), m_message() {
+        }
+
+        socket_receive_range(const socket_receive_range&) = delete;
+        socket_receive_range& operator=(const socket_receive_range&) = delete;
+
+        /**
+         * @brief Releases the current message and receives the next one into it. Returns false at the end of the
+         *        range.
+         */
+        bool receive() {
+            m_message.reset();
+
+            pooled_buffer buffer = m_pool->acquire();
+            iovec vector;
+            vector.iov_base = buffer.data();
+            vector.iov_len = buffer.capacity();
+
+            msghdr header;
+            std::memset(&header, 0, sizeof(header));
+            header.msg_iov = &vector;
+            header.msg_iovlen = 1;
+
+            for (;;) {
+                const ssize_t bytes = ::recvmsg(m_socket, &header, 0);
+
+                if (bytes >= 0) {
+                    if (bytes == 0 && m_stream) {
+                        return false;
+                    }
+
+                    buffer.resize(std::min(static_cast<std::size_t>(bytes), buffer.capacity()),
+                                  (header.msg_flags & MSG_TRUNC) != 0);
+                    m_message = std::move(buffer);
+                    return true;
+                }
+
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return false;
+                }
+
+                if (errno != EINTR) {
+                    throw std::system_error(errno, std::generic_category(), "socket_receive_range: recvmsg failed");
+                }
+            }
+        }
+
+        iterator begin() { return iterator(*this); }
+        iterator end() { return iterator(); }
+    };
+#endif
+
+    /**
+     * @brief What one call of a decoder did: the compressed bytes it consumed, the bytes it produced, and whether the
+     *        input consumed so far ends with a complete frame whose output has been produced entirely.
+     */
+    struct decode_step {
+        std::size_t consumed;
+        std::size_t produced;
+        bool finished;
+    };
+
+#if ITERATOR_BASED_FOR_HAS_ZSTD
+    /**
+     * @brief Streaming decoder of Zstandard frames for decompressing_range.
+     */
+    class zstd_decoder {
+    private:
+        std::unique_ptr<ZSTD_DCtx, std::size_t (*)(ZSTD_DCtx*)> m_context;
+
+    public:
+        zstd_decoder() : m_context(ZSTD_createDCtx(), &ZSTD_freeDCtx) {
+            if (!m_context) {
+                throw std::bad_alloc();
+            }
+        }
+
+        decode_step decode(const char* _input, std::size_t _input_size, char* _output, std::size_t _output_size) {
+            ZSTD_inBuffer input = {_input, _input_size, 0};
+            ZSTD_outBuffer output = {_output, _output_size, 0};
+            const std::size_t result = ZSTD_decompressStream(m_context.get(), &output, &input);
+
+            if (ZSTD_isError(result)) {
+                throw std::runtime_error(std::string("zstd_decoder: ") + ZSTD_getErrorName(result));
+            }
+
+            return decode_step{input.pos, output.pos, result == 0};
+        }
+    };
+#endif
+
+#if ITERATOR_BASED_FOR_HAS_LZ4
+    /**
+     * @brief Streaming decoder of LZ4 frames for decompressing_range.
+     */
+    class lz4_decoder {
+    private:
+        std::unique_ptr<LZ4F_dctx, LZ4F_errorCode_t (*)(LZ4F_dctx*)> m_context;
+
+        static LZ4F_dctx* create_context() {
+            LZ4F_dctx* context = nullptr;
+
+            if (LZ4F_isError(LZ4F_createDecompressionContext(&context, LZ4F_VERSION))) {
+                throw std::bad_alloc();
+            }
+
+            return context;
+        }
+
+    public:
+        lz4_decoder() : m_context(create_context(), &LZ4F_freeDecompressionContext) { }
+
+        decode_step decode(const char* _input, std::size_t _input_size, char* _output, std::size_t _output_size) {
+            std::size_t consumed = _input_size;
+            std::size_t produced = _output_size;
+            const std::size_t result = LZ4F_decompress(m_context.get(), _output, &produced, _input, &consumed, nullptr);
+
+            if (LZ4F_isError(result)) {
+                throw std::runtime_error(std::string("lz4_decoder: ") + LZ4F_getErrorName(result));
+            }
+
+            return decode_step{consumed, produced, result == 0};
+        }
+    };
+#endif
+
+    /**
+     * @brief Decompresses a byte range or the input of a block_reader as it is iterated. Decoder is a streaming
+     *        decoder such as zstd_decoder or lz4_decoder, called as
+     *        decode(input, input_size, output, output_size) -> decode_step. The output is decoded a block at a time
+     *        into the buffer of a block_reader, which is reused for every block, so only one block of the decompressed
+     *        payload is held in memory at any time.
+     *
+     *        The range iterates over the decompressed bytes; lines(range.reader()) and records<T>(range.reader())
+     *        iterate over its lines and records. Like the ranges of a block_reader it is a single pass input range.
+     *        Iteration throws std::runtime_error if the compressed input is corrupt or ends within a frame.
+     */
+    template <typename Decoder>
+    class decompressing_range {
+    private:
+        struct state {
+            span<const char> compressed;
+            block_reader* compressed_reader;
+            Decoder decoder;
+            bool finished;
+            block_reader reader;
+
+            state(span<const char> _compressed, block_reader* _compressed_reader, Decoder&& _decoder,
+                  std::size_t _block_size) :
+                    compressed(_compressed),
+                    compressed_reader(_compressed_reader),
+                    decoder(std::move(_decoder)),
+                    finished(true),
+                    reader([this](char* _output, std::size_t _bytes) { return decode(_output, _bytes); }, _block_size) {
+            }
+
+            state(const state&) = delete;
+            state& operator=(const state&) = delete;
+
+            span<const char> pending() {
+                if (compressed_reader) {
+                    if (compressed_reader->available() == 0) {
+                        compressed_reader->refill();
+                    }
+
+                    return span<const char>(compressed_reader->data(), compressed_reader->available());
+                }
+
+                return compressed;
+            }
+
+            void consume(std::size_t _bytes) {
+                if (compressed_reader) {
+                    compressed_reader->consume(_bytes);
+                } else {
+                    compressed = span<const char>(compressed.data() + _bytes, compressed.size() - _bytes);
+                }
+            }
+
+            std::size_t decode(char* _output, std::size_t _bytes) {
+                for (;;) {
+                    const span<const char> input = pending();
+                    const decode_step step = decoder.decode(input.data(), input.size(), _output, _bytes);
+
+                    consume(step.consumed);
+
+                    if (step.consumed != 0 || step.produced != 0) {
+                        finished = step.finished;
+                    }
+
+                    if (step.produced != 0) {
+                        return step.produced;
+                    }
+
+                    if (input.empty()) {
+                        if (!finished) {
+                            throw std::runtime_error("decompressing_range: the compressed input ends within a frame");
+                        }
+
+                        return 0;
+                    }
+
+                    if (step.consumed == 0) {
+                        throw std::runtime_error("decompressing_range: the decoder makes no progress");
+                    }
+                }
+            }
+        };
+
+        std::unique_ptr<state> m_state;
+
+    public:
+        using iterator = block_byte_iterator;
+
+        /**
+         * @brief Decompresses the bytes of _compressed, which must stay valid while the range is iterated.
+         */
+        explicit decompressing_range(span<const char> _compressed, Decoder _decoder = Decoder(),
+                                     std::size_t _block_size = block_reader::default_block_size) :
+                m_state(new state(_compressed, nullptr, std::move(_decoder), _block_size)) {
+        }
+
+        /**
+         * @brief Decompresses the input of _compressed, reading it a block at a time. The reader must outlive the
+         *        range.
+         */
+        explicit decompressing_range(block_reader& _compressed, Decoder _decoder = Decoder(),
+                                     std::size_t _block_size = block_reader::default_block_size) :
+                m_state(new state(span<const char>(), &_compressed, std::move(_decoder), _block_size)) {
+        }
+
+        /**
+         * @brief Returns the reader of the decompressed bytes.
+         */
+        block_reader& reader() { return m_state->reader; }
+
+        iterator begin() { return iterator(m_state->reader); }
+        iterator end() { return iterator(); }
+    };
+
+    /**
+     * @brief Returns a range over the decompressed bytes of the contiguous range of compressed bytes _compressed,
+     *        such as a mapped_file_range<char>:
+     *
+     *        mapped_file_range<char> archive("events.zst");
+     *        auto events = decompress<zstd_decoder>((archive.begin(), archive.end()));
+     *        for (const event& e : records<event>(events.reader())) { ... }
+     */
+    template <typename Decoder, typename Iterator, typename Sentinel>
+    decompressing_range<Decoder> decompress(const iterator_range<Iterator, Sentinel>& _compressed,
+                                            Decoder _decoder = Decoder(),
+                                            std::size_t _block_size = block_reader::default_block_size) {
+        static_assert(is_contiguous_iterator<Iterator>::value && is_sized_sentinel_for<Sentinel, Iterator>::value
+                      && sizeof(typename std::iterator_traits<Iterator>::value_type) == 1,
+                      "decompress requires a contiguous range of bytes; wrap other sources in a block_reader");
+
+        const char* first = reinterpret_cast<const char*>(IteratorBasedForImpl::to_address(_compressed.begin()));
+
+        return decompressing_range<Decoder>(span<const char>(first, _compressed.size()), std::move(_decoder),
+                                            _block_size);
+    }
+
+    /**
+     * @brief Returns a range over the decompressed bytes of the input of _compressed, for files and streams that are
+     *        read a block at a time.
+     */
+    template <typename Decoder>
+    decompressing_range<Decoder> decompress(block_reader& _compressed, Decoder _decoder = Decoder(),
+                                            std::size_t _block_size = block_reader::default_block_size) {
+        return decompressing_range<Decoder>(_compressed, std::move(_decoder), _block_size);
+    }
+
+} // namespace IteratorBasedForImpl
+
+#endif // IteratorBasedForIO_H
@@ -0,0 +1,394 @@
+#ifndef IteratorBasedForMpi_H
+#define IteratorBasedForMpi_H
+
+#include <IteratorBasedForParallel.hpp>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace IteratorBasedForImpl
+{
+
+    /**
+     * @brief Block distribution of a global index space of size() elements over the ranks of a communicator. Rank r
+     *        owns the count(r) indices from first(r); the blocks follow each other in rank order and differ in size
+     *        by at most one element.
+     */
+    class mpi_partition {
+    private:
+        MPI_Comm m_communicator;
+        int m_rank;
+        int m_ranks;
+        std::size_t m_size;
+
+    public:
+        explicit mpi_partition(std::size_t _size, MPI_Comm _communicator = MPI_COMM_WORLD) :
+                m_communicator(_communicator), m_rank(0), m_ranks(1), m_size(_size) {
+            MPI_Comm_rank(m_communicator, &m_rank);
+            MPI_Comm_size(m_communicator, &m_ranks);
+        }
+
+        MPI_Comm communicator() const { return m_communicator; }
+
+        int rank() const { return m_rank; }
+
+        int ranks() const { return m_ranks; }
+
+        std::size_t size() const { return m_size; }
+
+        std::size_t first(int _rank) const {
+            const std::size_t rank = static_cast<std::size_t>(_rank);
+            const std::size_t ranks = static_cast<std::size_t>(m_ranks);
+            return rank * (m_size / ranks) + std::min(rank, m_size % ranks);
+        }
+
+        std::size_t count(int _rank) const { return first(_rank + 1) - first(_rank); }
+
+        std::size_t first() const { return first(m_rank); }
+
+        std::size_t count() const { return count(m_rank); }
+
+        /**
+         * @brief Returns the rank owning the global index _index.
+         */
+        int owner(std::size_t _index) const {
+            const std::size_t ranks = static_cast<std::size_t>(m_ranks);
+            const std::size_t large = m_size % ranks;
+            const std::size_t small_count = m_size / ranks;
+
+            if (_index < large * (small_count + 1)) {
+                return static_cast<int>(_index / (small_count + 1));
+            }
+
+            return static_cast<int>(large + (_index - large * (small_count + 1)) / small_count);
+        }
+
+        /**
+         * @brief Returns the block of _global owned by this rank. _global must have size() elements.
+         */
+        template <typename Iterator, typename Sentinel>
+        iterator_range<Iterator> local(const iterator_range<Iterator, Sentinel>& _global) const {
+            using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+
+            const Iterator begin = _global.begin() + static_cast<difference_type>(first());
+            return iterator_range<Iterator>(begin, begin + static_cast<difference_type>(count()));
+        }
+    };
+
+    /**
+     * @brief Returns the block of the sized range _range that the calling rank of _communicator works on, when the
+     *        range describes the same global index space on every rank.
+     */
+    template <typename Iterator, typename Sentinel>
+    iterator_range<Iterator> partition(const iterator_range<Iterator, Sentinel>& _range,
+                                       MPI_Comm _communicator = MPI_COMM_WORLD) {
+        static_assert(is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "partition requires a range whose size is known in constant time");
+
+        return mpi_partition(_range.size(), _communicator).local(_range);
+    }
+
+    namespace execution
+    {
+
+        /**
+         * @brief Runs the algorithms across the ranks of a communicator: a sized range stands for the same global
+         *        index space on every rank, each rank processes its block of it (see mpi_partition) with the local
+         *        policy, such as execution::par, and reductions and scans combine the blocks with collective
+         *        operations. Every rank of the communicator must call the same algorithms in the same order.
+         */
+        template <typename LocalPolicy>
+        class distributed_policy {
+        private:
+            LocalPolicy m_local;
+            MPI_Comm m_communicator;
+
+        public:
+            distributed_policy(const LocalPolicy& _local, MPI_Comm _communicator) :
+                    m_local(_local), m_communicator(_communicator) {
+            }
+
+            const LocalPolicy& local_policy() const { return m_local; }
+
+            MPI_Comm communicator() const { return m_communicator; }
+
+            template <typename Iterator, typename Sentinel>
+            mpi_partition partition(const iterator_range<Iterator, Sentinel>& _range) const {
+                static_assert(is_sized_sentinel_for<Sentinel, Iterator>::value,
+                              "distributed algorithms require ranges whose size is known in constant time");
+
+                return mpi_partition(_range.size(), m_communicator);
+            }
+        };
+
+    } // namespace execution
+
+    /**
+     * @brief Returns a policy running algorithms on the ranks of _communicator, each rank using _local for its block.
+     */
+    template <typename LocalPolicy, typename std::enable_if<is_execution_policy<LocalPolicy>::value, int>::type = 0>
+    execution::distributed_policy<LocalPolicy> distributed(const LocalPolicy& _local,
+                                                           MPI_Comm _communicator = MPI_COMM_WORLD) {
+        return execution::distributed_policy<LocalPolicy>(_local, _communicator);
+    }
+
+    /**
+     * @brief MPI datatype of the arithmetic type T, for the reductions MPI can compute itself.
+     */
+    template <typename T>
+    struct mpi_datatype {
+        static constexpr bool exists = false;
+    };
+
+#define ITERATOR_BASED_FOR_MPI_DATATYPE(_type, _datatype) \
+    template <> \
+    struct mpi_datatype<_type> { \
+        static constexpr bool exists = true; \
+        static MPI_Datatype get() { return _datatype; } \
+    };
+
+    ITERATOR_BASED_FOR_MPI_DATATYPE(char, MPI_CHAR)
+    ITERATOR_BASED_FOR_MPI_DATATYPE(signed char, MPI_SIGNED_CHAR)
+    ITERATOR_BASED_FOR_MPI_DATATYPE(unsigned char, MPI_UNSIGNED_CHAR)
+    ITERATOR_BASED_FOR_MPI_DATATYPE(short, MPI_SHORT)
+    ITERATOR_BASED_FOR_MPI_DATATYPE(unsigned short, MPI_UNSIGNED_SHORT)
+    ITERATOR_BASED_FOR_MPI_DATATYPE(int, MPI_INT)
+    ITERATOR_BASED_FOR_MPI_DATATYPE(unsigned, MPI_UNSIGNED)
+    ITERATOR_BASED_FOR_MPI_DATATYPE(long, MPI_LONG)
+    ITERATOR_BASED_FOR_MPI_DATATYPE(unsigned long, MPI_UNSIGNED_LONG)
+    ITERATOR_BASED_FOR_MPI_DATATYPE(long long, MPI_LONG_LONG)
+    ITERATOR_BASED_FOR_MPI_DATATYPE(unsigned long long, MPI_UNSIGNED_LONG_LONG)
+    ITERATOR_BASED_FOR_MPI_DATATYPE(float, MPI_FLOAT)
+    ITERATOR_BASED_FOR_MPI_DATATYPE(double, MPI_DOUBLE)
+    ITERATOR_BASED_FOR_MPI_DATATYPE(long double, MPI_LONG_DOUBLE)
+
+#undef ITERATOR_BASED_FOR_MPI_DATATYPE
+
+    /**
+     * @brief Predefined MPI operation computing BinaryOp on values of type T, with its identity. Other operations are
+     *        combined on every rank from the gathered partial results.
+     */
+    template <typename BinaryOp, typename T, typename = void>
+    struct mpi_operation {
+        static constexpr bool exists = false;
+    };
+
+    template <typename T>
+    struct mpi_operation<std::plus<T>, T, typename std::enable_if<mpi_datatype<T>::exists>::type> {
+        static constexpr bool exists = true;
+        static MPI_Op get() { return MPI_SUM; }
+        static T identity() { return T(0); }
+    };
+
+    template <typename T>
+    struct mpi_operation<std::plus<>, T, typename std::enable_if<mpi_datatype<T>::exists>::type> :
+            mpi_operation<std::plus<T>, T> {
+    };
+
+    template <typename T>
+    struct mpi_operation<std::multiplies<T>, T, typename std::enable_if<mpi_datatype<T>::exists>::type> {
+        static constexpr bool exists = true;
+        static MPI_Op get() { return MPI_PROD; }
+        static T identity() { return T(1); }
+    };
+
+    template <typename T>
+    struct mpi_operation<std::multiplies<>, T, typename std::enable_if<mpi_datatype<T>::exists>::type> :
+            mpi_operation<std::multiplies<T>, T> {
+    };
+
+    /**
+     * @brief Result of a rank for its block, which is empty if the block is.
+     */
+    template <typename T>
+    struct mpi_partial {
+        T value;
+        bool engaged;
+    };
+
+    /**
+     * @brief Returns the partial results of all ranks of _communicator in rank order.
+     */
+    template <typename T>
+    std::vector<mpi_partial<T>> mpi_gather_partials(const mpi_partial<T>& _partial, MPI_Comm _communicator) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "distributed algorithms exchange partial results as bytes, which requires trivially copyable types");
+
+        int ranks = 1;
+        MPI_Comm_size(_communicator, &ranks);
+
+        std::vector<mpi_partial<T>> partials(static_cast<std::size_t>(ranks));
+        MPI_Allgather(&_partial, static_cast<int>(sizeof(_partial)), MPI_BYTE, partials.data(),
+                      static_cast<int>(sizeof(_partial)), MPI_BYTE, _communicator);
+        return partials;
+    }
+
+    /**
+     * @brief Folds _partials[0, _count) into _init in rank order with _op.
+     */
+    template <typename T, typename BinaryOp>
+    mpi_partial<T> mpi_fold_partials(mpi_partial<T> _init, const std::vector<mpi_partial<T>>& _partials,
+                                     std::size_t _count, BinaryOp& _op) {
+        for (std::size_t i = 0; i < _count; ++i) {
+            if (_partials[i].engaged) {
+                _init.value = _init.engaged ? _op(std::move(_init.value), _partials[i].value) : _partials[i].value;
+                _init.engaged = true;
+            }
+        }
+
+        return _init;
+    }
+
+    template <typename T, typename BinaryOp>
+    T mpi_combine(const mpi_partial<T>& _partial, T _init, BinaryOp& _op, MPI_Comm _communicator, std::true_type) {
+        using operation = mpi_operation<BinaryOp, T>;
+
+        T local = _partial.engaged ? _partial.value : operation::identity();
+        T global = local;
+        MPI_Allreduce(&local, &global, 1, mpi_datatype<T>::get(), operation::get(), _communicator);
+        return _op(std::move(_init), global);
+    }
+
+    template <typename T, typename BinaryOp>
+    T mpi_combine(const mpi_partial<T>& _partial, T _init, BinaryOp& _op, MPI_Comm _communicator, std::false_type) {
+        const std::vector<mpi_partial<T>> partials = mpi_gather_partials(_partial, _communicator);
+        return mpi_fold_partials(mpi_partial<T>{std::move(_init), true}, partials, partials.size(), _op).value;
+    }
+
+    /**
+     * @brief Returns the reduction of the local block _local with _reduce and _transform, disengaged if it is empty.
+     */
+    template <typename LocalPolicy, typename Iterator, typename T, typename BinaryOp, typename UnaryOp>
+    mpi_partial<T> mpi_local_partial(const LocalPolicy& _policy, const iterator_range<Iterator>& _local,
+                                     BinaryOp& _reduce, UnaryOp& _transform) {
+        if (_local.empty()) {
+            return mpi_partial<T>{T(), false};
+        }
+
+        Iterator first = _local.begin();
+        T init = _transform(*first);
+        ++first;
+
+        return mpi_partial<T>{transform_reduce(_policy, iterator_range<Iterator>(first, _local.end()), std::move(init),
+                                               _reduce, _transform), true};
+    }
+
+    /**
+     * @brief Calls _f on every element of the calling rank's block of _range with the local policy.
+     */
+    template <typename LocalPolicy, typename Iterator, typename Sentinel, typename F>
+    void for_each(const execution::distributed_policy<LocalPolicy>& _policy,
+                  const iterator_range<Iterator, Sentinel>& _range, F _f) {
+        for_each(_policy.local_policy(), _policy.partition(_range).local(_range), std::move(_f));
+    }
+
+    /**
+     * @brief Returns, on every rank, _init combined with _transform(x) for every element x of the whole of _range
+     *        using _reduce, which must be associative and commutative. Every rank reduces its block with the local
+     *        policy; the partial results are combined with MPI_Allreduce for sums and products of arithmetic types,
+     *        and otherwise gathered to every rank and combined there in rank order.
+     */
+    template <typename LocalPolicy, typename Iterator, typename Sentinel, typename T, typename BinaryOp,
+              typename UnaryOp>
+    T transform_reduce(const execution::distributed_policy<LocalPolicy>& _policy,
+                       const iterator_range<Iterator, Sentinel>& _range, T _init, BinaryOp _reduce,
+                       UnaryOp _transform) {
+        const mpi_partial<T> partial = mpi_local_partial<LocalPolicy, Iterator, T>(
+                _policy.local_policy(), _policy.partition(_range).local(_range), _reduce, _transform);
+
+        return mpi_combine(partial, std::move(_init), _reduce, _policy.communicator(),
+                           std::integral_constant<bool, mpi_operation<BinaryOp, T>::exists>());
+    }
+
+    /**
+     * @brief Returns, on every rank, _init combined with every element of the whole of _range using _op. See
+     *        transform_reduce().
+     */
+    template <typename LocalPolicy, typename Iterator, typename Sentinel, typename T, typename BinaryOp = std::plus<T>>
+    T reduce(const execution::distributed_policy<LocalPolicy>& _policy,
+             const iterator_range<Iterator, Sentinel>& _range, T _init, BinaryOp _op = BinaryOp()) {
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+        return transform_reduce(_policy, _range, std::move(_init), std::move(_op),
+                                [](reference _x) -> reference { return static_cast<reference>(_x); });
+    }
+
+    /**
+     * @brief Returns the combination of _init, if engaged, with the blocks of all ranks before the calling one.
+     */
+    template <typename LocalPolicy, typename Iterator, typename T, typename BinaryOp>
+    mpi_partial<T> mpi_scan_prefix(const execution::distributed_policy<LocalPolicy>& _policy,
+                                   const mpi_partition& _partition, const iterator_range<Iterator>& _local,
+                                   mpi_partial<T> _init, BinaryOp& _op) {
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+        auto identity = [](reference _x) -> T { return static_cast<T>(_x); };
+        const mpi_partial<T> total = mpi_local_partial<LocalPolicy, Iterator, T>(_policy.local_policy(), _local, _op,
+                                                                              identity);
+        const std::vector<mpi_partial<T>> partials = mpi_gather_partials(total, _policy.communicator());
+
+        return mpi_fold_partials(std::move(_init), partials, static_cast<std::size_t>(_partition.rank()), _op);
+    }
+
+    /**
+     * @brief Writes the inclusive scan of the whole of _range with _op to the output starting at _out, which
+     *        describes the same global index space as _range: every rank writes the results for its block, at the
+     *        same offset from _out, and the returned end of the output is the same on all ranks. Every rank first
+     *        reduces its block, the block totals are gathered to compute the prefix of every rank, and every rank
+     *        then scans its block from its prefix with the local policy. _op must be associative.
+     */
+    template <typename LocalPolicy, typename Iterator, typename Sentinel, typename OutputIterator,
+              typename BinaryOp = std::plus<>>
+    OutputIterator inclusive_scan(const execution::distributed_policy<LocalPolicy>& _policy,
+                                  const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out,
+                                  BinaryOp _op = BinaryOp()) {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using out_difference_type = typename std::iterator_traits<OutputIterator>::difference_type;
+
+        const mpi_partition partition = _policy.partition(_range);
+        const iterator_range<Iterator> local = partition.local(_range);
+        const mpi_partial<value_type> prefix = mpi_scan_prefix(_policy, partition, local,
+                                                               mpi_partial<value_type>{value_type(), false}, _op);
+        OutputIterator out = _out + static_cast<out_difference_type>(partition.first());
+
+        if (prefix.engaged) {
+            inclusive_scan(_policy.local_policy(), local, out, _op, prefix.value);
+        } else {
+            inclusive_scan(_policy.local_policy(), local, out, _op);
+        }
+
+        return _out + static_cast<out_difference_type>(partition.size());
+    }
+
+    /**
+     * @brief Like inclusive_scan(_policy, _range, _out, _op), but every element of the output combines _init with
+     *        the elements before the corresponding element of _range only.
+     */
+    template <typename LocalPolicy, typename Iterator, typename Sentinel, typename OutputIterator, typename T,
+              typename BinaryOp = std::plus<>>
+    OutputIterator exclusive_scan(const execution::distributed_policy<LocalPolicy>& _policy,
+                                  const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out, T _init,
+                                  BinaryOp _op = BinaryOp()) {
+        using out_difference_type = typename std::iterator_traits<OutputIterator>::difference_type;
+
+        const mpi_partition partition = _policy.partition(_range);
+        const iterator_range<Iterator> local = partition.local(_range);
+        const mpi_partial<T> prefix = mpi_scan_prefix(_policy, partition, local, mpi_partial<T>{std::move(_init), true},
+                                                      _op);
+
+        exclusive_scan(_policy.local_policy(), local, _out + static_cast<out_difference_type>(partition.first()),
+                       prefix.value, _op);
+
+        return _out + static_cast<out_difference_type>(partition.size());
+    }
+
+} // namespace IteratorBasedForImpl
+
+#endif // IteratorBasedForMpi_H
@@ -0,0 +1,4687 @@
+#ifndef IteratorBasedForParallel_H
+#define IteratorBasedForParallel_H
+
+#include <IteratorBasedFor.hpp>
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//Define ITERATOR_BASED_FOR_USE_STD_EXECUTION to run the parallel algorithms through the standard library's parallel
+//algorithms where they are available instead of the built-in thread pool.
+#if defined(ITERATOR_BASED_FOR_USE_STD_EXECUTION) && defined(__has_include)
+#if __has_include(<execution>)
+#include <execution>
+#endif
+#endif
+
+#if defined(ITERATOR_BASED_FOR_USE_STD_EXECUTION) && defined(__cpp_lib_execution) && __cpp_lib_execution >= 201603L
+#define ITERATOR_BASED_FOR_HAS_STD_EXECUTION 1
+#else
+#define ITERATOR_BASED_FOR_HAS_STD_EXECUTION 0
+#endif
+
+//From C++17, the scratch arenas of parallel loops are also std::pmr::memory_resources.
+#if defined(__has_include) && __cplusplus >= 201703L
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#endif
+
+#if defined(__cpp_lib_memory_resource) && __cpp_lib_memory_resource >= 201603L
+#define ITERATOR_BASED_FOR_HAS_STD_MEMORY_RESOURCE 1
+#else
+#define ITERATOR_BASED_FOR_HAS_STD_MEMORY_RESOURCE 0
+#endif
+
+//Thread affinity and NUMA node queries are implemented for Linux; elsewhere threads are not pinned and the node of
+//threads and memory is unknown.
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define ITERATOR_BASED_FOR_HAS_AFFINITY 1
+#else
+#define ITERATOR_BASED_FOR_HAS_AFFINITY 0
+#endif
+
+//Define ITERATOR_BASED_FOR_TRACE to annotate the tasks of parallel loops and pipelines and the steals between workers:
+//as ITT tasks where <ittnotify.h> is available (link against libittnotify for VTune), as USDT probes in the provider
+//iterator_based_for where <sys/sdt.h> is (for perf and bpftrace), and through the hooks installed with
+//set_trace_hooks(), which can forward them to Perfetto or any other tracer. Without the macro the annotations compile
+//to nothing.
+#if defined(ITERATOR_BASED_FOR_TRACE)
+#define ITERATOR_BASED_FOR_HAS_TRACE 1
+#if defined(__has_include)
+#if __has_include(<ittnotify.h>)
+#include <ittnotify.h>
+#define ITERATOR_BASED_FOR_HAS_ITT 1
+#endif
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define ITERATOR_BASED_FOR_HAS_USDT 1
+#endif
+#endif
+#else
+#define ITERATOR_BASED_FOR_HAS_TRACE 0
+#endif
+
+#ifndef ITERATOR_BASED_FOR_HAS_ITT
+#define ITERATOR_BASED_FOR_HAS_ITT 0
+#endif
+
+#ifndef ITERATOR_BASED_FOR_HAS_USDT
+#define ITERATOR_BASED_FOR_HAS_USDT 0
+#endif
+
+namespace IteratorBasedForImpl
+{
+
+    /**
+     * @brief The kinds of task reported to tracers.
+     */
+    enum class trace_task {
+        //A piece of a parallel_for, with the number of elements of the piece if it is known.
+        loop_piece,
+        //A chunk of thread_pool::run_chunks().
+        chunk,
+        //A block of thread_pool::run_placed().
+        block,
+        //A batch of elements passing through a pipeline stage, with the number of elements of the batch.
+        pipeline_batch
+    };
+
+    /**
+     * @brief Returns the name under which tasks of kind _task are reported.
+     */
+    inline const char* trace_task_name(trace_task _task) {
+        switch (_task) {
+        case trace_task::loop_piece:
+            return "iterator_based_for.loop_piece";
+        case trace_task::chunk:
+            return "iterator_based_for.chunk";
+        case trace_task::block:
+            return "iterator_based_for.block";
+        case trace_task::pipeline_batch:
+            return "iterator_based_for.pipeline_batch";
+        }
+
+        return "iterator_based_for";
+    }
+
+    /**
+     * @brief Callbacks receiving the trace events of builds with ITERATOR_BASED_FOR_TRACE defined. Any of them may be
+     *        null. They are called on the thread the event happens on, so they must be thread-safe.
+     */
+    struct trace_hooks {
+        void (*task_begin)(trace_task _task, std::size_t _elements);
+        void (*task_end)(trace_task _task);
+        //A worker with index _thief (see thread_pool::thread_index()) took a task from the deque of worker _victim.
+        void (*steal)(std::size_t _thief, std::size_t _victim);
+    };
+
+    inline std::atomic<const trace_hooks*>& installed_trace_hooks() {
+        static std::atomic<const trace_hooks*> hooks(nullptr);
+        return hooks;
+    }
+
+    /**
+     * @brief Installs _hooks, which must outlive every traced operation, or removes the hooks if _hooks is null.
+     */
+    inline void set_trace_hooks(const trace_hooks* _hooks) {
+        installed_trace_hooks().store(_hooks, std::memory_order_release);
+    }
+
+#if ITERATOR_BASED_FOR_HAS_ITT
+    inline __itt_domain* itt_trace_domain() {
+        static __itt_domain* domain = __itt_domain_create("iterator_based_for");
+        return domain;
+    }
+
+    inline __itt_string_handle* itt_trace_name(trace_task _task) {
+        static __itt_string_handle* names[] = {
+                __itt_string_handle_create(trace_task_name(trace_task::loop_piece)),
+                __itt_string_handle_create(trace_task_name(trace_task::chunk)),
+                __itt_string_handle_create(trace_task_name(trace_task::block)),
+                __itt_string_handle_create(trace_task_name(trace_task::pipeline_batch))};
+        return names[static_cast<int>(_task)];
+    }
+#endif
+
+    /**
+     * @brief Reports the start of a task of kind _task over _elements elements, or 0 if the number is unknown.
+     */
+    inline void trace_task_begin(trace_task _task, std::size_t _elements) {
+#if ITERATOR_BASED_FOR_HAS_ITT
+        static __itt_string_handle* elements = __itt_string_handle_create("elements");
+        unsigned long long count = _elements;
+        __itt_task_begin(itt_trace_domain(), __itt_null, __itt_null, itt_trace_name(_task));
+        __itt_metadata_add(itt_trace_domain(), __itt_null, elements, __itt_metadata_u64, 1, &count);
+#endif
+#if ITERATOR_BASED_FOR_HAS_USDT
+        DTRACE_PROBE2(iterator_based_for, task_begin, static_cast<int>(_task), _elements);
+#endif
+#if ITERATOR_BASED_FOR_HAS_TRACE
+        const trace_hooks* hooks = installed_trace_hooks().load(std::memory_order_acquire);
+
+        if (hooks && hooks->task_begin) {
+            hooks->task_begin(_task, _elements);
+        }
+#else
+        (void)_task;
+        (void)_elements;
+#endif
+    }
+
+    /**
+     * @brief Reports the end of the innermost task of kind _task started on the calling thread.
+     */
+    inline void trace_task_end(trace_task _task) {
+#if ITERATOR_BASED_FOR_HAS_ITT
+        __itt_task_end(itt_trace_domain());
+#endif
+#if ITERATOR_BASED_FOR_HAS_USDT
+        DTRACE_PROBE1(iterator_based_for, task_end, static_cast<int>(_task));
+#endif
+#if ITERATOR_BASED_FOR_HAS_TRACE
+        const trace_hooks* hooks = installed_trace_hooks().load(std::memory_order_acquire);
+
+        if (hooks && hooks->task_end) {
+            hooks->task_end(_task);
+        }
+#else
+        (void)_task;
+#endif
+    }
+
+    /**
+     * @brief Reports that worker _thief took a task queued by worker _victim.
+     */
+    inline void trace_steal(std::size_t _thief, std::size_t _victim) {
+#if ITERATOR_BASED_FOR_HAS_USDT
+        DTRACE_PROBE2(iterator_based_for, steal, _thief, _victim);
+#endif
+#if ITERATOR_BASED_FOR_HAS_TRACE
+        const trace_hooks* hooks = installed_trace_hooks().load(std::memory_order_acquire);
+
+        if (hooks && hooks->steal) {
+            hooks->steal(_thief, _victim);
+        }
+#else
+        (void)_thief;
+        (void)_victim;
+#endif
+    }
+
+    /**
+     * @brief Reports a task from its construction to its destruction.
+     */
+    class trace_scope {
+    private:
+        trace_task m_task;
+
+    public:
+        trace_scope(trace_task _task, std::size_t _elements) : m_task(_task) { trace_task_begin(_task, _elements); }
+
+        trace_scope(const trace_scope&) = delete;
+        trace_scope& operator=(const trace_scope&) = delete;
+
+        ~trace_scope() { trace_task_end(m_task); }
+    };
+
+    template <typename Range>
+    auto trace_elements(const Range& _range, int) -> decltype(static_cast<std::size_t>(_range.size())) {
+        return static_cast<std::size_t>(_range.size());
+    }
+
+    template <typename Range>
+    std::size_t trace_elements(const Range&, long) {
+        return 0;
+    }
+
+    /**
+     * @brief Returns the CPUs the calling thread may run on, or an empty vector if they are unknown.
+     */
+    inline std::vector<unsigned> allowed_cpus() {
+        std::vector<unsigned> cpus;
+#if ITERATOR_BASED_FOR_HAS_AFFINITY
+        cpu_set_t set;
+        CPU_ZERO(&set);
+
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+#endif
+        return cpus;
+    }
+
+    /**
+     * @brief Restricts the calling thread to _cpu. Returns false if the thread could not be pinned.
+     */
+    inline bool pin_current_thread(unsigned _cpu) {
+#if ITERATOR_BASED_FOR_HAS_AFFINITY
+        if (_cpu >= CPU_SETSIZE) {
+            return false;
+        }
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(_cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)_cpu;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Returns the NUMA node of the CPU the calling thread is running on, or -1 if it is unknown.
+     */
+    inline int current_numa_node() {
+#if ITERATOR_BASED_FOR_HAS_AFFINITY && defined(SYS_getcpu)
+        unsigned cpu = 0;
+        unsigned node = 0;
+
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+            return static_cast<int>(node);
+        }
+#endif
+        return -1;
+    }
+
+    /**
+     * @brief Returns the NUMA node holding the page of _address, or -1 if it is unknown. A page that has not been
+     *        touched yet is allocated as if it were read by the calling thread.
+     */
+    inline int numa_node_of(const void* _address) {
+#if ITERATOR_BASED_FOR_HAS_AFFINITY && defined(SYS_get_mempolicy)
+        //MPOL_F_NODE | MPOL_F_ADDR from <numaif.h>, which is not available without libnuma.
+        const unsigned long node_of_address = 1 | 2;
+        int node = -1;
+
+        if (syscall(SYS_get_mempolicy, &node, nullptr, 0UL, const_cast<void*>(_address), node_of_address) == 0) {
+            return node;
+        }
+#else
+        (void)_address;
+#endif
+        return -1;
+    }
+
+    /**
+     * @brief Placement of the worker threads of a thread_pool on the CPUs.
+     */
+    enum class thread_affinity {
+        //Workers run wherever the operating system schedules them.
+        none,
+        //Worker i is pinned to the (i + 1)-th CPU the creating thread may run on, leaving the first one to the
+        //creating thread, so that consecutive workers share cores, sockets and NUMA nodes.
+        compact
+    };
+
+    /**
+     * @brief Configuration of a thread_pool.
+     */
+    struct thread_pool_options {
+        //Worker threads in addition to the threads calling into the pool; by default one less than the hardware
+        //concurrency.
+        std::size_t workers;
+        thread_affinity affinity;
+        //How long an idle worker keeps polling for tasks, yielding in between, before it parks on a condition
+        //variable. Loops that follow each other within that time find the workers awake instead of waiting for the
+        //operating system to wake them; 0 parks at once.
+        std::chrono::microseconds spin;
+
+        thread_pool_options() :
+                workers(std::max(1u, std::thread::hardware_concurrency()) - 1), affinity(thread_affinity::none),
+                spin(50) {
+        }
+    };
+
+    /**
+     * @brief Counters of a thread_pool since it was created or its statistics were last reset: the queued tasks
+     *        that were run, how many of them were stolen from another worker's deque, how often a worker parked and
+     *        how long the workers were idle in total, spinning or parked.
+     */
+    struct thread_pool_statistics {
+        std::uint64_t tasks;
+        std::uint64_t steals;
+        std::uint64_t parks;
+        std::chrono::nanoseconds idle;
+    };
+
+    /**
+     * @brief A fixed set of worker threads executing parallel loops with work stealing. Every worker owns a deque of
+     *        tasks: it pushes and pops tasks at the back of its own deque and, when that is empty, takes tasks from the
+     *        front of the pool's shared queue or steals them from the front of other workers' deques. Threads that
+     *        are not workers submit tasks to the shared queue.
+     *
+     * A thread waiting for a parallel loop to finish keeps executing queued tasks, so a pool without any worker
+     * threads runs loops sequentially and nested parallel loops cannot deadlock. An idle worker spins for the time
+     * given by its thread_pool_options before it parks.
+     */
+    class thread_pool {
+    private:
+        /**
+         * @brief Statistics of the thread owning a task_queue, or of all non-worker threads for the shared queue.
+         */
+        struct queue_counters {
+            std::atomic<std::uint64_t> tasks;
+            std::atomic<std::uint64_t> steals;
+            std::atomic<std::uint64_t> parks;
+            std::atomic<std::uint64_t> idle_ns;
+
+            queue_counters() : tasks(0), steals(0), parks(0), idle_ns(0) { }
+        };
+
+        struct task_queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+            queue_counters counters;
+
+            task_queue() : mutex(), tasks(), counters() { }
+        };
+
+        /**
+         * @brief Identifies the pool and worker index of the calling thread, if it is a worker thread.
+         */
+        struct worker_identity {
+            const thread_pool* pool;
+            std::size_t index;
+        };
+
+        static worker_identity& current_worker() {
+            static thread_local worker_identity identity = {nullptr, 0};
+            return identity;
+        }
+
+        std::vector<std::unique_ptr<task_queue>> m_queues;
+        task_queue m_shared;
+        std::vector<std::thread> m_threads;
+        std::atomic<std::size_t> m_queued;
+        std::mutex m_sleep_mutex;
+        std::condition_variable m_wake;
+        bool m_stop;
+        std::size_t m_sleeping;
+        std::vector<int> m_nodes;
+        std::atomic<std::size_t> m_started;
+        bool m_pinned;
+        std::chrono::microseconds m_spin;
+
+        /**
+         * @brief State shared between the caller of run_chunks() and the workers helping it. Workers may pick up
+         *        their task only after the loop has finished, so the state outlives the call.
+         */
+        struct loop_state {
+            std::size_t chunks;
+            std::atomic<std::size_t> next;
+            std::atomic<std::size_t> done;
+            std::atomic<bool> failed;
+            std::exception_ptr error;
+            std::mutex mutex;
+
+            explicit loop_state(std::size_t _chunks) :
+                    chunks(_chunks), next(0), done(0), failed(false), error(), mutex() {
+            }
+        };
+
+        /**
+         * @brief State of a run_placed() call: the node of every block and which blocks have been claimed.
+         */
+        struct placed_state {
+            std::vector<int> nodes;
+            std::unique_ptr<std::atomic<bool>[]> claimed;
+            std::atomic<std::size_t> done;
+            std::atomic<bool> failed;
+            std::exception_ptr error;
+            std::mutex mutex;
+
+            explicit placed_state(std::vector<int> _nodes) :
+                    nodes(std::move(_nodes)), claimed(new std::atomic<bool>[nodes.size()]), done(0), failed(false),
+                    error(), mutex() {
+                for (std::size_t i = 0; i < nodes.size(); ++i) {
+                    claimed[i] = false;
+                }
+            }
+
+            bool claim(std::size_t _block) { return !claimed[_block].load() && !claimed[_block].exchange(true); }
+        };
+
+        /**
+         * @brief Claims the next block for thread _thread: its own block unless that lives on another node, then
+         *        any block on its node, then any block at all. Returns the number of blocks if none is left.
+         */
+        std::size_t claim_block(placed_state& _state, std::size_t _thread) const {
+            const std::size_t blocks = _state.nodes.size();
+            const int node = numa_node(_thread);
+
+            if (_thread < blocks && (_state.nodes[_thread] < 0 || _state.nodes[_thread] == node)
+                && _state.claim(_thread)) {
+                return _thread;
+            }
+
+            for (std::size_t i = 0; node >= 0 && i < blocks; ++i) {
+                if (_state.nodes[i] == node && _state.claim(i)) {
+                    return i;
+                }
+            }
+
+            for (std::size_t i = 0; i < blocks; ++i) {
+                if (_state.claim(i)) {
+                    return i;
+                }
+            }
+
+            return blocks;
+        }
+
+        template <typename F>
+        void execute_placed(placed_state& _state, F& _f) const {
+            const std::size_t thread = thread_index();
+            std::size_t completed = 0;
+
+            for (std::size_t i = claim_block(_state, thread); i < _state.nodes.size(); i = claim_block(_state, thread)) {
+                if (!_state.failed.load(std::memory_order_relaxed)) {
+                    try {
+                        trace_scope trace(trace_task::block, 0);
+                        _f(i);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(_state.mutex);
+
+                        if (!_state.failed.exchange(true)) {
+                            _state.error = std::current_exception();
+                        }
+                    }
+                }
+
+                ++completed;
+            }
+
+            _state.done += completed;
+        }
+
+        template <typename F>
+        static void execute_chunks(loop_state& _state, F& _f) {
+            std::size_t completed = 0;
+
+            for (std::size_t i = _state.next++; i < _state.chunks; i = _state.next++) {
+                if (!_state.failed.load(std::memory_order_relaxed)) {
+                    try {
+                        trace_scope trace(trace_task::chunk, 0);
+                        _f(i);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(_state.mutex);
+
+                        if (!_state.failed.exchange(true)) {
+                            _state.error = std::current_exception();
+                        }
+                    }
+                }
+
+                ++completed;
+            }
+
+            _state.done += completed;
+        }
+
+        static bool pop_front(task_queue& _queue, std::function<void()>& _task) {
+            std::lock_guard<std::mutex> lock(_queue.mutex);
+
+            if (_queue.tasks.empty()) {
+                return false;
+            }
+
+            _task = std::move(_queue.tasks.front());
+            _queue.tasks.pop_front();
+            return true;
+        }
+
+        static bool pop_back(task_queue& _queue, std::function<void()>& _task) {
+            std::lock_guard<std::mutex> lock(_queue.mutex);
+
+            if (_queue.tasks.empty()) {
+                return false;
+            }
+
+            _task = std::move(_queue.tasks.back());
+            _queue.tasks.pop_back();
+            return true;
+        }
+
+        /**
+         * @brief Takes the next task for the calling thread: the newest task of its own deque if it is a worker of
+         *        this pool, otherwise the oldest task of the shared queue or of another worker's deque.
+         */
+        bool take_task(std::function<void()>& _task) {
+            const worker_identity& self = current_worker();
+            const bool is_worker = self.pool == this;
+            const std::size_t workers = m_queues.size();
+
+            if (m_queued.load() == 0) {
+                return false;
+            }
+
+            queue_counters& counters = is_worker ? m_queues[self.index]->counters : m_shared.counters;
+            bool found = (is_worker && pop_back(*m_queues[self.index], _task)) || pop_front(m_shared, _task);
+
+            for (std::size_t i = 1; !found && i <= workers; ++i) {
+                std::size_t victim = ((is_worker ? self.index : 0) + i) % workers;
+                found = pop_front(*m_queues[victim], _task);
+
+                if (found) {
+                    counters.steals.fetch_add(1, std::memory_order_relaxed);
+                    trace_steal(thread_index(), victim);
+                }
+            }
+
+            if (found) {
+                counters.tasks.fetch_add(1, std::memory_order_relaxed);
+                --m_queued;
+            }
+
+            return found;
+        }
+
+        static thread_pool_options options_for(std::size_t _workers, thread_affinity _affinity) {
+            thread_pool_options options;
+            options.workers = _workers;
+            options.affinity = _affinity;
+            return options;
+        }
+
+        void worker(std::size_t _index) {
+            current_worker() = {this, _index};
+            queue_counters& counters = m_queues[_index]->counters;
+
+            for (;;) {
+                std::function<void()> task;
+
+                if (take_task(task)) {
+                    task();
+                    continue;
+                }
+
+                const auto idle = std::chrono::steady_clock::now();
+                const auto spin_end = idle + m_spin;
+
+                while (m_queued.load() == 0 && std::chrono::steady_clock::now() < spin_end) {
+                    std::this_thread::yield();
+                }
+
+                if (m_queued.load() == 0) {
+                    std::unique_lock<std::mutex> lock(m_sleep_mutex);
+                    counters.parks.fetch_add(1, std::memory_order_relaxed);
+                    ++m_sleeping;
+                    m_wake.wait(lock, [this]() { return m_stop || m_queued.load() != 0; });
+                    --m_sleeping;
+
+                    if (m_stop && m_queued.load() == 0) {
+                        return;
+                    }
+                }
+
+                const auto idle_time = std::chrono::steady_clock::now() - idle;
+                counters.idle_ns.fetch_add(static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(idle_time).count()), std::memory_order_relaxed);
+            }
+        }
+
+    public:
+        /**
+         * @brief Creates a pool with _options.workers worker threads in addition to the threads calling into it,
+         *        placed on the CPUs according to _options.affinity. Pinned workers report their NUMA node before the
+         *        constructor returns.
+         */
+        explicit thread_pool(const thread_pool_options& _options) :
+                m_queues(), m_shared(), m_threads(), m_queued(0), m_sleep_mutex(), m_wake(), m_stop(false),
+                m_sleeping(0), m_nodes(_options.workers, -1), m_started(0), m_pinned(false), m_spin(_options.spin) {
+            const std::size_t _workers = _options.workers;
+            const std::vector<unsigned> cpus =
+                    _options.affinity == thread_affinity::compact ? allowed_cpus() : std::vector<unsigned>();
+
+            m_pinned = !cpus.empty();
+
+            for (std::size_t i = 0; i < _workers; ++i) {
+                m_queues.emplace_back(new task_queue());
+            }
+
+            m_threads.reserve(_workers);
+
+            for (std::size_t i = 0; i < _workers; ++i) {
+                if (!m_pinned) {
+                    m_threads.emplace_back([this, i]() { worker(i); });
+                    continue;
+                }
+
+                const unsigned cpu = cpus[(i + 1) % cpus.size()];
+
+                m_threads.emplace_back([this, i, cpu]() {
+                    pin_current_thread(cpu);
+                    m_nodes[i] = current_numa_node();
+                    m_started.fetch_add(1, std::memory_order_release);
+                    worker(i);
+                });
+            }
+
+            while (m_pinned && m_started.load(std::memory_order_acquire) != _workers) {
+                std::this_thread::yield();
+            }
+        }
+
+        /**
+         * @brief Creates a pool with _workers worker threads placed according to _affinity, the other options keeping
+         *        their defaults.
+         */
+        explicit thread_pool(std::size_t _workers, thread_affinity _affinity = thread_affinity::none) :
+                thread_pool(options_for(_workers, _affinity)) {
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        ~thread_pool() {
+            {
+                std::lock_guard<std::mutex> lock(m_sleep_mutex);
+                m_stop = true;
+            }
+
+            m_wake.notify_all();
+
+            for (std::thread& t : m_threads) {
+                t.join();
+            }
+        }
+
+        /**
+         * @brief Returns the number of threads that execute a loop, including the calling thread.
+         */
+        std::size_t concurrency() const { return m_threads.size() + 1; }
+
+        /**
+         * @brief Returns the index of the calling thread among the worker threads of this pool, or concurrency() - 1
+         *        if it is not one of them.
+         */
+        std::size_t thread_index() const {
+            const worker_identity& self = current_worker();
+            return self.pool == this ? self.index : m_threads.size();
+        }
+
+        /**
+         * @brief Checks whether the workers of this pool are pinned to CPUs.
+         */
+        bool pinned() const { return m_pinned; }
+
+        /**
+         * @brief Returns how long an idle worker spins before it parks.
+         */
+        std::chrono::microseconds spin() const { return m_spin; }
+
+        /**
+         * @brief Returns the counters of all threads of this pool. They are read one after the other while the pool
+         *        may be running, so they are exact only when it is idle.
+         */
+        thread_pool_statistics statistics() const {
+            thread_pool_statistics result = {0, 0, 0, std::chrono::nanoseconds(0)};
+            std::uint64_t idle_ns = 0;
+
+            for (std::size_t i = 0; i <= m_queues.size(); ++i) {
+                const queue_counters& counters = i < m_queues.size() ? m_queues[i]->counters : m_shared.counters;
+                result.tasks += counters.tasks.load(std::memory_order_relaxed);
+                result.steals += counters.steals.load(std::memory_order_relaxed);
+                result.parks += counters.parks.load(std::memory_order_relaxed);
+                idle_ns += counters.idle_ns.load(std::memory_order_relaxed);
+            }
+
+            result.idle = std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(idle_ns));
+            return result;
+        }
+
+        /**
+         * @brief Sets the counters of all threads of this pool to zero.
+         */
+        void reset_statistics() {
+            for (std::size_t i = 0; i <= m_queues.size(); ++i) {
+                queue_counters& counters = i < m_queues.size() ? m_queues[i]->counters : m_shared.counters;
+                counters.tasks = 0;
+                counters.steals = 0;
+                counters.parks = 0;
+                counters.idle_ns = 0;
+            }
+        }
+
+        /**
+         * @brief Returns the NUMA node of the thread with index _thread (see thread_index()), or -1 if it is unknown.
+         *        The node of an unpinned worker is unknown; for the calling thread it is the node it currently runs on.
+         */
+        int numa_node(std::size_t _thread) const {
+            if (_thread < m_nodes.size()) {
+                return m_nodes[_thread];
+            }
+
+            return current_numa_node();
+        }
+
+        /**
+         * @brief Queues _task for execution. Tasks submitted by a worker of this pool go to the back of its own
+         *        deque, where they are executed first by that worker and may be stolen by the others.
+         */
+        void submit(std::function<void()> _task) {
+            const worker_identity& self = current_worker();
+            task_queue& queue = self.pool == this ? *m_queues[self.index] : m_shared;
+
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(std::move(_task));
+            }
+
+            bool sleeping;
+
+            {
+                std::lock_guard<std::mutex> lock(m_sleep_mutex);
+                ++m_queued;
+                sleeping = m_sleeping != 0;
+            }
+
+            //A worker that has not parked yet sees the task before it waits, so only parked workers need a wake-up.
+            if (sleeping) {
+                m_wake.notify_one();
+            }
+        }
+
+        /**
+         * @brief Executes queued tasks on the calling thread until _done() returns true. Yields when there is nothing
+         *        to execute, since the remaining work is then held by other threads.
+         */
+        template <typename Predicate>
+        void run_until(Predicate _done) {
+            while (!_done()) {
+                std::function<void()> task;
+
+                if (take_task(task)) {
+                    task();
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        /**
+         * @brief Calls _f(i) for every i in [0, _chunks) using the calling thread and the worker threads, and returns
+         *        once all calls have completed. If any call throws, no further chunks are started and the first
+         *        exception is rethrown.
+         */
+        template <typename F>
+        void run_chunks(std::size_t _chunks, F _f) {
+            if (_chunks == 0) {
+                return;
+            }
+
+            if (_chunks == 1 || m_threads.empty()) {
+                for (std::size_t i = 0; i < _chunks; ++i) {
+                    _f(i);
+                }
+
+                return;
+            }
+
+            auto state = std::make_shared<loop_state>(_chunks);
+            auto shared_f = std::make_shared<F>(std::move(_f));
+            std::size_t helpers = std::min(_chunks - 1, m_threads.size());
+
+            for (std::size_t i = 0; i < helpers; ++i) {
+                submit([state, shared_f]() { execute_chunks(*state, *shared_f); });
+            }
+
+            execute_chunks(*state, *shared_f);
+            run_until([&state]() { return state->done.load() == state->chunks; });
+
+            if (state->error) {
+                std::rethrow_exception(state->error);
+            }
+        }
+
+        /**
+         * @brief Calls _f(i) for every block i in [0, _nodes.size()) like run_chunks(), but lets the thread with
+         *        index i (see thread_index()) run block i, and lets threads that have finished their own block take
+         *        blocks on their NUMA node before the others. _nodes holds the node of the memory of every block, or
+         *        -1 where it is unknown, in which case a block is assumed to be local to the thread of the same index.
+         */
+        template <typename F>
+        void run_placed(std::vector<int> _nodes, F _f) {
+            const std::size_t blocks = _nodes.size();
+
+            if (blocks <= 1 || m_threads.empty()) {
+                for (std::size_t i = 0; i < blocks; ++i) {
+                    _f(i);
+                }
+
+                return;
+            }
+
+            auto state = std::make_shared<placed_state>(std::move(_nodes));
+            auto shared_f = std::make_shared<F>(std::move(_f));
+
+            for (std::size_t i = 0; i < m_threads.size(); ++i) {
+                submit([this, state, shared_f]() { execute_placed(*state, *shared_f); });
+            }
+
+            execute_placed(*state, *shared_f);
+            run_until([&state, blocks]() { return state->done.load() == blocks; });
+
+            if (state->error) {
+                std::rethrow_exception(state->error);
+            }
+        }
+    };
+
+    struct default_thread_pool_state {
+        std::mutex mutex;
+        thread_pool_options options;
+        bool created;
+
+        default_thread_pool_state() : mutex(), options(), created(false) { }
+    };
+
+    inline default_thread_pool_state& default_thread_pool_config() {
+        static default_thread_pool_state state;
+        return state;
+    }
+
+    /**
+     * @brief Returns the pool used by parallel algorithms that are not given one explicitly, creating it on the first
+     *        call. By default it has one worker thread less than the hardware concurrency, the calling thread making up
+     *        the difference. Calling it at startup keeps the creation of its threads out of the first parallel loop.
+     */
+    inline thread_pool& default_thread_pool() {
+        static thread_pool pool([]() {
+            default_thread_pool_state& state = default_thread_pool_config();
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.created = true;
+            return state.options;
+        }());
+
+        return pool;
+    }
+
+    /**
+     * @brief Sets the options default_thread_pool() creates the pool with. Throws std::logic_error if the pool has
+     *        already been created.
+     */
+    inline void configure_default_thread_pool(const thread_pool_options& _options) {
+        default_thread_pool_state& state = default_thread_pool_config();
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        if (state.created) {
+            throw std::logic_error("configure_default_thread_pool: the default thread pool already exists");
+        }
+
+        state.options = _options;
+    }
+
+    /**
+     * @brief Time the pieces of a loop tuned by a grain_tuner aim to take: long enough to make the cost of handing
+     *        out a piece negligible, short enough to balance the load.
+     */
+    constexpr std::chrono::microseconds tuned_piece_time(50);
+
+    /**
+     * @brief Grain size of a parallel loop learnt from the time its pieces took. The tuner keeps a running estimate
+     *        of the cost of an element, updated after every piece, and proposes the grain giving pieces of about
+     *        tuned_piece_time. A range that takes less than that as a whole is not worth waking other threads for
+     *        and runs on the calling thread.
+     *
+     *        A tuner belongs to one loop, usually one call site, and is passed to the algorithms with
+     *        execution::par.tuned(tuner) or the ITERATOR_BASED_FOR_TUNED macro, which keeps one per call site.
+     */
+    class grain_tuner {
+    private:
+        //Estimated cost of an element in picoseconds, 0 before the first measurement.
+        std::atomic<std::uint64_t> m_element_cost;
+
+        static std::uint64_t target() {
+            return static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(tuned_piece_time).count()) * 1000;
+        }
+
+    public:
+        grain_tuner() : m_element_cost(0) { }
+
+        grain_tuner(const grain_tuner&) = delete;
+        grain_tuner& operator=(const grain_tuner&) = delete;
+
+        /**
+         * @brief Adds the measurement of a piece of _elements elements taking _elapsed, out of a loop over _total
+         *        elements, to the estimate. The pieces of a loop together move the estimate about a quarter of the way
+         *        to their average cost, each in proportion to its size, so that a small piece whose thread happened to
+         *        be preempted hardly changes it.
+         */
+        void record(std::size_t _elements, std::chrono::nanoseconds _elapsed, std::size_t _total = 0) {
+            if (_elements == 0) {
+                return;
+            }
+
+            const double elapsed =
+                    static_cast<double>(std::max<std::chrono::nanoseconds::rep>(0, _elapsed.count())) * 1000;
+            const double elements = static_cast<double>(_elements);
+            const double total = static_cast<double>(std::max(_total, _elements));
+            const double cost = static_cast<double>(m_element_cost.load(std::memory_order_relaxed));
+            const double weight = cost == 0 ? 1 : elements / (elements + 3 * total);
+            const double updated = cost + weight * (elapsed / elements - cost);
+
+            //Concurrent updates may overwrite each other, which only drops a sample.
+            m_element_cost.store(static_cast<std::uint64_t>(std::max(1.0, updated)), std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Checks whether a cost has been measured yet.
+         */
+        bool tuned() const { return m_element_cost.load(std::memory_order_relaxed) != 0; }
+
+        /**
+         * @brief Checks whether _n elements are known to take less than one piece, so that they should run serially.
+         */
+        bool runs_serially(std::size_t _n) const {
+            const std::uint64_t cost = m_element_cost.load(std::memory_order_relaxed);
+            return cost != 0 && cost * _n < target();
+        }
+
+        /**
+         * @brief Returns the grain for _n elements on _concurrency threads: the number of elements taking about
+         *        tuned_piece_time, but giving each thread at least one piece, or before any measurement the default of
+         *        about sixteen pieces per thread.
+         */
+        std::size_t grain(std::size_t _n, std::size_t _concurrency) const {
+            const std::uint64_t cost = m_element_cost.load(std::memory_order_relaxed);
+            const std::size_t per_thread = std::max<std::size_t>(1, _n / _concurrency);
+
+            if (cost == 0) {
+                return std::max<std::size_t>(1, _n / (_concurrency * 16));
+            }
+
+            return static_cast<std::size_t>(std::max<std::uint64_t>(1, std::min<std::uint64_t>(per_thread, target() / cost)));
+        }
+    };
+
+    /**
+     * @brief Flag asking the loops of a parallel policy to stop early. Pass it with execution::par.cancelled_by(token);
+     *        once cancel() has been called, no further pieces of those loops are started, and loop bodies may poll
+     *        cancelled() to stop the piece they are working on. Cancelling does not undo or roll back anything, and
+     *        the loop returns normally once the running pieces have finished.
+     */
+    class cancellation_token {
+    private:
+        std::atomic<bool> m_cancelled;
+
+    public:
+        cancellation_token() : m_cancelled(false) { }
+
+        cancellation_token(const cancellation_token&) = delete;
+        cancellation_token& operator=(const cancellation_token&) = delete;
+
+        void cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+
+        bool cancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Makes the token usable for another loop. Must not be called while a loop is using it.
+         */
+        void reset() { m_cancelled.store(false, std::memory_order_relaxed); }
+    };
+
+    namespace execution
+    {
+
+        /**
+         * @brief Requests sequential execution on the calling thread.
+         */
+        struct sequenced_policy {
+            constexpr sequenced_policy() { }
+        };
+
+        /**
+         * @brief Base of the parallel policies. Holds the pool that executes the algorithm, the default pool if none
+         *        was given.
+         */
+        template <typename Derived>
+        class basic_parallel_policy {
+        private:
+            thread_pool* m_pool;
+            grain_tuner* m_tuner;
+            bool m_local;
+            const cancellation_token* m_token;
+
+        public:
+            constexpr basic_parallel_policy() : m_pool(nullptr), m_tuner(nullptr), m_local(false), m_token(nullptr) { }
+
+            basic_parallel_policy(const basic_parallel_policy&) = default;
+            basic_parallel_policy& operator=(const basic_parallel_policy&) = default;
+
+            /**
+             * @brief Returns a copy of this policy that executes algorithms on _pool.
+             */
+            Derived on(thread_pool& _pool) const {
+                Derived policy = static_cast<const Derived&>(*this);
+                static_cast<basic_parallel_policy&>(policy).m_pool = &_pool;
+                return policy;
+            }
+
+            /**
+             * @brief Returns a copy of this policy whose loops choose their grain size with _tuner, and run serially
+             *        when _tuner has found them too short to be worth splitting. An explicit grain size overrides it.
+             */
+            Derived tuned(grain_tuner& _tuner) const {
+                Derived policy = static_cast<const Derived&>(*this);
+                static_cast<basic_parallel_policy&>(policy).m_tuner = &_tuner;
+                return policy;
+            }
+
+            /**
+             * @brief Returns a copy of this policy whose loops split ranges into one contiguous block per thread of
+             *        the pool, and run every block on a thread of the NUMA node holding its memory where the pool is
+             *        pinned, or else on the thread of the same index. This takes precedence over a grain_tuner.
+             */
+            Derived local() const {
+                Derived policy = static_cast<const Derived&>(*this);
+                static_cast<basic_parallel_policy&>(policy).m_local = true;
+                return policy;
+            }
+
+            /**
+             * @brief Returns a copy of this policy whose loops stop starting pieces once _token is cancelled.
+             */
+            Derived cancelled_by(const cancellation_token& _token) const {
+                Derived policy = static_cast<const Derived&>(*this);
+                static_cast<basic_parallel_policy&>(policy).m_token = &_token;
+                return policy;
+            }
+
+            thread_pool& pool() const { return m_pool ? *m_pool : default_thread_pool(); }
+
+            grain_tuner* tuner() const { return m_tuner; }
+
+            bool prefers_local() const { return m_local; }
+
+            const cancellation_token* token() const { return m_token; }
+
+            /**
+             * @brief Checks whether the token of this policy, if any, has been cancelled.
+             */
+            bool cancelled() const { return m_token && m_token->cancelled(); }
+        };
+
+        /**
+         * @brief Allows the element accesses of an algorithm to be distributed across threads.
+         */
+        struct parallel_policy : basic_parallel_policy<parallel_policy> {
+            constexpr parallel_policy() { }
+        };
+
+        /**
+         * @brief Allows the element accesses of an algorithm to be distributed across threads and interleaved within a
+         *        thread, as with vectorization.
+         */
+        struct parallel_unsequenced_policy : basic_parallel_policy<parallel_unsequenced_policy> {
+            constexpr parallel_unsequenced_policy() { }
+        };
+
+        constexpr sequenced_policy seq;
+        constexpr parallel_policy par;
+        constexpr parallel_unsequenced_policy par_unseq;
+
+    } // namespace execution
+
+//Expands to a copy of the parallel policy _policy tuned by a grain_tuner of its own for every place the macro is
+//written, so that each loop learns its grain size across calls without declaring a tuner:
+//for_each(ITERATOR_BASED_FOR_TUNED(execution::par), (v.begin(), v.end()), f);
+#define ITERATOR_BASED_FOR_TUNED(_policy) \
+    (_policy).tuned([]() -> ::IteratorBasedForImpl::grain_tuner& { \
+        static ::IteratorBasedForImpl::grain_tuner tuner; \
+        return tuner; \
+    }())
+
+    /**
+     * @brief Checks whether T is one of the execution policy types.
+     */
+    template <typename T>
+    struct is_execution_policy : std::false_type { };
+
+    template <>
+    struct is_execution_policy<execution::sequenced_policy> : std::true_type { };
+
+    template <>
+    struct is_execution_policy<execution::parallel_policy> : std::true_type { };
+
+    template <>
+    struct is_execution_policy<execution::parallel_unsequenced_policy> : std::true_type { };
+
+    /**
+     * @brief Checks whether T is one of the parallel execution policy types.
+     */
+    template <typename T>
+    struct is_parallel_policy : std::false_type { };
+
+    template <>
+    struct is_parallel_policy<execution::parallel_policy> : std::true_type { };
+
+    template <>
+    struct is_parallel_policy<execution::parallel_unsequenced_policy> : std::true_type { };
+
+    /**
+     * @brief State shared by the tasks of one parallel_for() call.
+     */
+    template <typename Body>
+    struct parallel_for_state {
+        Body body;
+        std::atomic<std::size_t> pending;
+        std::atomic<bool> failed;
+        std::mutex mutex;
+        std::exception_ptr error;
+        const cancellation_token* token;
+
+        parallel_for_state(Body _body, const cancellation_token* _token) :
+                body(std::move(_body)), pending(1), failed(false), mutex(), error(), token(_token) {
+        }
+
+        parallel_for_state(const parallel_for_state&) = delete;
+        parallel_for_state& operator=(const parallel_for_state&) = delete;
+
+        /**
+         * @brief Checks whether no further pieces should be started, because a piece failed or the loop was cancelled.
+         */
+        bool stopped() const {
+            return failed.load(std::memory_order_relaxed) || (token && token->cancelled());
+        }
+    };
+
+    /**
+     * @brief Splits _range while it is divisible, queueing the upper halves so that idle workers can steal them, and
+     *        then runs the body on what is left. The biggest halves are at the front of the deque where thieves take
+     *        from, so stolen work is split further by the thief instead of being handed out piecemeal.
+     */
+    template <typename Range, typename Body>
+    void parallel_for_split(thread_pool& _pool, const std::shared_ptr<parallel_for_state<Body>>& _state, Range _range) {
+        while (_range.is_divisible() && !_state->stopped()) {
+            Range upper(_range, split());
+            std::shared_ptr<parallel_for_state<Body>> state = _state;
+
+            _state->pending.fetch_add(1);
+            _pool.submit([&_pool, state, upper]() { parallel_for_split(_pool, state, upper); });
+        }
+
+        if (!_state->stopped()) {
+            try {
+                trace_scope trace(trace_task::loop_piece, trace_elements(_range, 0));
+                _state->body(_range);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(_state->mutex);
+
+                if (!_state->failed.exchange(true)) {
+                    _state->error = std::current_exception();
+                }
+            }
+        }
+
+        _state->pending.fetch_sub(1);
+    }
+
+    /**
+     * @brief Calls _body once with the whole of _range on the calling thread.
+     */
+    template <typename Range, typename Body,
+              typename std::enable_if<is_splittable_range<Range>::value, int>::type = 0>
+    void parallel_for(const execution::sequenced_policy&, const Range& _range, Body _body) {
+        _body(_range);
+    }
+
+    /**
+     * @brief Calls _body once with the whole of _range on the calling thread.
+     */
+    template <typename Iterator, typename Sentinel, typename Body>
+    void parallel_for(const execution::sequenced_policy&, const iterator_range<Iterator, Sentinel>& _range, Body _body,
+                      std::size_t = 0) {
+        _body(_range);
+    }
+
+    /**
+     * @brief Calls _body with disjoint pieces of the splittable range _range, such as a blocked_iterator_range, that
+     *        together cover all of it. Pieces are split off with the splitting constructor until they are no longer
+     *        divisible and idle threads steal the largest outstanding pieces, which balances loops whose per-element
+     *        cost varies widely. If _body throws, or the cancellation_token of the policy is cancelled, no further
+     *        pieces are started; the first exception is rethrown.
+     */
+    template <typename Policy, typename Range, typename Body,
+              typename std::enable_if<is_parallel_policy<Policy>::value && is_splittable_range<Range>::value,
+                                      int>::type = 0>
+    void parallel_for(const Policy& _policy, const Range& _range, Body _body) {
+        thread_pool& pool = _policy.pool();
+
+        if (_policy.cancelled()) {
+            return;
+        }
+
+        if (pool.concurrency() == 1 || !_range.is_divisible()) {
+            _body(_range);
+            return;
+        }
+
+        auto state = std::make_shared<parallel_for_state<Body>>(std::move(_body), _policy.token());
+        parallel_for_split(pool, state, _range);
+        pool.run_until([&state]() { return state->pending.load() == 0; });
+
+        if (state->error) {
+            std::rethrow_exception(state->error);
+        }
+    }
+
+    /**
+     * @brief Runs a parallel_for over [_first, _last) with the grain proposed by _tuner, timing every piece to refine
+     *        it, or the whole range on the calling thread if _tuner expects it to take less than one piece.
+     */
+    template <typename Policy, typename Iterator, typename Body>
+    void tuned_parallel_for(const Policy& _policy, grain_tuner& _tuner, Iterator _first, Iterator _last, std::size_t _n,
+                            Body& _body) {
+        using clock = std::chrono::steady_clock;
+
+        auto timed = [&_tuner, &_body, _n](const blocked_iterator_range<Iterator>& _piece) {
+            const clock::time_point start = clock::now();
+            _body(_piece);
+            _tuner.record(_piece.size(), std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start), _n);
+        };
+
+        if (_tuner.runs_serially(_n)) {
+            timed(blocked_iterator_range<Iterator>(_first, _last, _n ? _n : 1));
+            return;
+        }
+
+        parallel_for(_policy, blocked_iterator_range<Iterator>(_first, _last,
+                                                              _tuner.grain(_n, _policy.pool().concurrency())),
+                     timed);
+    }
+
+    template <typename Iterator>
+    int numa_node_of_element(const Iterator& _it, std::true_type) {
+        return numa_node_of(std::addressof(*_it));
+    }
+
+    template <typename Iterator>
+    int numa_node_of_element(const Iterator&, std::false_type) {
+        return -1;
+    }
+
+    /**
+     * @brief Runs a parallel_for over _n elements from _first with a policy preferring locality: the range is cut
+     *        into one block per thread, each run by a thread local to its memory in pieces of at most _grain
+     *        elements, or as one piece if _grain is 0.
+     */
+    template <typename Policy, typename Iterator, typename Body>
+    void local_parallel_for(const Policy& _policy, Iterator _first, std::size_t _n, Body& _body, std::size_t _grain) {
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using has_address = std::is_lvalue_reference<typename std::iterator_traits<Iterator>::reference>;
+
+        thread_pool& pool = _policy.pool();
+        const std::size_t blocks = std::max<std::size_t>(1, std::min(_n, pool.concurrency()));
+        auto block_begin = [_first, _n, blocks](std::size_t _block) {
+            return _first + static_cast<difference_type>(_n * _block / blocks);
+        };
+
+        std::vector<int> nodes(blocks, -1);
+
+        for (std::size_t i = 0; pool.pinned() && i < blocks; ++i) {
+            nodes[i] = numa_node_of_element(block_begin(i), has_address());
+        }
+
+        pool.run_placed(std::move(nodes), [&](std::size_t _block) {
+            const Iterator last = block_begin(_block + 1);
+            Iterator piece = block_begin(_block);
+            const std::size_t grain = _grain ? _grain : std::max<std::size_t>(1, static_cast<std::size_t>(last - piece));
+
+            do {
+                const Iterator next = piece + static_cast<difference_type>(
+                        std::min<std::size_t>(grain, static_cast<std::size_t>(last - piece)));
+
+                if (_policy.cancelled()) {
+                    return;
+                }
+
+                _body(blocked_iterator_range<Iterator>(piece, next, grain));
+                piece = next;
+            } while (piece != last);
+        });
+    }
+
+    /**
+     * @brief Calls _body with disjoint blocked_iterator_range<Iterator> pieces of _range that together cover all of
+     *        it, splitting down to _grain elements (by default a size giving each thread about sixteen pieces, or the
+     *        size chosen by the grain_tuner of the policy). Without either, ranges that are not large, see
+     *        parallel_range_threshold(), are passed whole on the calling thread. Requires a range whose size is
+     *        known in constant time.
+     *        A policy preferring locality cuts the range into one block per thread instead, see
+     *        basic_parallel_policy::local().
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename Body,
+              typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    void parallel_for(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Body _body,
+                      std::size_t _grain = 0) {
+        static_assert(is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "parallel_for requires a random access range whose size is known in constant time");
+
+        std::size_t n = _range.size();
+        Iterator first = _range.begin();
+        Iterator last = first + static_cast<typename std::iterator_traits<Iterator>::difference_type>(n);
+        grain_tuner* tuner = _policy.tuner();
+
+        if (_policy.cancelled()) {
+            return;
+        }
+
+        if (_policy.prefers_local()) {
+            local_parallel_for(_policy, first, n, _body, _grain);
+            return;
+        }
+
+        if (_grain == 0 && tuner) {
+            tuned_parallel_for(_policy, *tuner, first, last, n, _body);
+            return;
+        }
+
+        //Below parallel_range_threshold(), waking the pool would cost more than the loop.
+        if (_grain == 0 && classify_size(n, true) != size_class::large) {
+            _body(blocked_iterator_range<Iterator>(first, last, std::max<std::size_t>(1, n)));
+            return;
+        }
+
+        if (_grain == 0) {
+            _grain = std::max<std::size_t>(1, n / (_policy.pool().concurrency() * 16));
+        }
+
+        parallel_for(_policy, blocked_iterator_range<Iterator>(first, last, _grain), std::move(_body));
+    }
+
+    /**
+     * @brief Split points of a range of forward iterators, such as a range of a std::map or std::set, recorded in a
+     *        single walk over the range so that parallel loops can divide it without walking it again. The range is
+     *        cut into between _pieces and twice as many pieces of about the same number of elements:
+     *
+     *        split_point_index<book::iterator> index((book.lower_bound(low), book.upper_bound(high)), 256);
+     *        for_each(execution::par, index, [](auto& level) { reprice(level); });
+     *
+     *        The index can be reused by further loops as long as none of the iterators it holds is invalidated. For
+     *        node-based containers that only happens when an element at a split point is erased; elements inserted
+     *        meanwhile are visited by the piece they fall into. A _pieces of zero is treated as one.
+     */
+    template <typename Iterator>
+    class split_point_index {
+        static_assert(has_iterator_category<Iterator, std::forward_iterator_tag>::value,
+                      "split_point_index requires forward iterators");
+
+    private:
+        std::vector<Iterator> m_points;
+        std::size_t m_size;
+
+    public:
+        template <typename Sentinel>
+        split_point_index(const iterator_range<Iterator, Sentinel>& _range, std::size_t _pieces) :
+                m_points(),
+                m_size(0) {
+            const std::size_t pieces = _pieces ? _pieces : 1;
+            std::size_t step = 1;
+            Iterator it = _range.begin();
+            const Sentinel end = _range.end();
+
+            m_points.reserve(2 * pieces + 2);
+            m_points.push_back(it);
+
+            //The number of elements is unknown, so every step-th iterator is kept and the step doubles, dropping
+            //every other point, whenever more than twice the pieces were collected.
+            for (; it != end; ++it, ++m_size) {
+                if (m_size != 0 && m_size % step == 0) {
+                    m_points.push_back(it);
+
+                    if (m_points.size() > 2 * pieces + 1) {
+                        for (std::size_t i = 1; 2 * i < m_points.size(); ++i) {
+                            m_points[i] = m_points[2 * i];
+                        }
+
+                        m_points.resize((m_points.size() + 1) / 2);
+                        step *= 2;
+                    }
+                }
+            }
+
+            if (m_size != 0) {
+                m_points.push_back(it);
+            }
+        }
+
+        /**
+         * @brief Returns the boundaries of the pieces: the begin of the range, the begin of every further piece and
+         *        the end of the range.
+         */
+        const std::vector<Iterator>& points() const { return m_points; }
+
+        /**
+         * @brief Returns the number of pieces, 0 for an empty range.
+         */
+        std::size_t pieces() const { return m_points.size() - 1; }
+
+        /**
+         * @brief Returns the number of elements the range held when the index was built.
+         */
+        std::size_t size() const { return m_size; }
+    };
+
+    /**
+     * @brief Splittable range over consecutive pieces of a split_point_index. Loops receive it as an
+     *        iterator_range<Iterator>.
+     */
+    template <typename Iterator>
+    class split_point_range : public iterator_range<Iterator> {
+    private:
+        const std::vector<Iterator>* m_points;
+        std::size_t m_first;
+        std::size_t m_last;
+
+    public:
+        split_point_range(const std::vector<Iterator>& _points, std::size_t _first, std::size_t _last) :
+                iterator_range<Iterator>(_points[_first], _points[_last]),
+                m_points(&_points),
+                m_first(_first),
+                m_last(_last) {
+        }
+
+        /**
+         * @brief Splitting constructor. Takes the upper half of the pieces of _range and leaves the lower half in
+         *        _range.
+         */
+        split_point_range(split_point_range& _range, split) :
+                split_point_range(*_range.m_points, _range.m_first + (_range.m_last - _range.m_first) / 2,
+                                  _range.m_last) {
+            _range = split_point_range(*m_points, _range.m_first, m_first);
+        }
+
+        /**
+         * @brief Checks whether the range spans more than one piece and can therefore be split.
+         */
+        bool is_divisible() const { return m_last - m_first > 1; }
+    };
+
+    /**
+     * @brief Calls _body with the pieces of the range indexed by _index, or with larger runs of consecutive pieces,
+     *        distributing them across the threads of the policy's pool with work stealing like the parallel_for of
+     *        splittable ranges.
+     */
+    template <typename Policy, typename Iterator, typename Body,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    void parallel_for(const Policy& _policy, const split_point_index<Iterator>& _index, Body _body) {
+        parallel_for(_policy, split_point_range<Iterator>(_index.points(), 0, _index.pieces()), std::move(_body));
+    }
+
+    /**
+     * @brief Calls _f on every element of the range indexed by _index, distributing the pieces of the index across
+     *        the threads of the policy's pool. _f must be safe to call concurrently on distinct elements.
+     */
+    template <typename Policy, typename Iterator, typename F,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    void for_each(const Policy& _policy, const split_point_index<Iterator>& _index, F _f) {
+        parallel_for(_policy, _index, [&_f](const iterator_range<Iterator>& _piece) {
+            for (Iterator it = _piece.begin(), end = _piece.end(); it != end; ++it) {
+                _f(*it);
+            }
+        });
+    }
+
+    /**
+     * @brief A bump allocator for the temporary buffers of loop bodies: allocating moves a pointer forward in the
+     *        current block, deallocating does nothing and rewind() gives back everything allocated since a mark at
+     *        once. Blocks are kept for reuse after rewinding, so a loop whose chunks need similar amounts of scratch
+     *        memory stops allocating from the global allocator after its first chunks. From C++17 it is a
+     *        std::pmr::memory_resource, for std::pmr containers; scratch_allocator serves the others. Not thread
+     *        safe: every thread has its own, see this_thread_scratch_arena().
+     */
+    class scratch_arena
+#if ITERATOR_BASED_FOR_HAS_STD_MEMORY_RESOURCE
+            : public std::pmr::memory_resource
+#endif
+    {
+    public:
+        /**
+         * @brief A position in the arena: everything allocated after it was taken is given back by rewind().
+         */
+        struct marker {
+            std::size_t block;
+            std::size_t offset;
+        };
+
+    private:
+        struct block {
+            std::unique_ptr<char[]> data;
+            std::size_t size;
+        };
+
+        std::vector<block> m_blocks;
+        marker m_top;
+        std::size_t m_first_block;
+
+        void* bump(std::size_t _bytes, std::size_t _alignment) {
+            for (;; ++m_top.block, m_top.offset = 0) {
+                if (m_top.block == m_blocks.size()
+                    || (m_top.offset == 0 && m_blocks[m_top.block].size < _bytes + _alignment)) {
+                    const std::size_t size = std::max(_bytes + _alignment,
+                                                      m_blocks.empty() ? m_first_block : 2 * m_blocks.back().size);
+
+                    //An unused block too small for the request would be passed over every time; replace it instead.
+                    if (m_top.block < m_blocks.size()) {
+                        m_blocks[m_top.block] = block{std::unique_ptr<char[]>(new char[size]), size};
+                    } else {
+                        m_blocks.push_back(block{std::unique_ptr<char[]>(new char[size]), size});
+                    }
+                }
+
+                block& current = m_blocks[m_top.block];
+                const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(current.data.get()) + m_top.offset;
+                const std::size_t padding = (_alignment - address % _alignment) % _alignment;
+
+                if (m_top.offset + padding + _bytes <= current.size) {
+                    m_top.offset += padding + _bytes;
+                    return current.data.get() + (m_top.offset - _bytes);
+                }
+            }
+        }
+
+#if ITERATOR_BASED_FOR_HAS_STD_MEMORY_RESOURCE
+        void* do_allocate(std::size_t _bytes, std::size_t _alignment) override {
+            return bump(_bytes, _alignment);
+        }
+
+        void do_deallocate(void*, std::size_t, std::size_t) override {
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& _other) const noexcept override {
+            return this == &_other;
+        }
+#endif
+
+    public:
+        /**
+         * @brief Creates an empty arena whose first block, allocated on first use, holds _first_block bytes. Every
+         *        further block is twice as large as the last one.
+         */
+        explicit scratch_arena(std::size_t _first_block = 64 * 1024) :
+                m_blocks(),
+                m_top{0, 0},
+                m_first_block(std::max<std::size_t>(_first_block, 64)) {
+        }
+
+        scratch_arena(const scratch_arena&) = delete;
+        scratch_arena& operator=(const scratch_arena&) = delete;
+
+#if !ITERATOR_BASED_FOR_HAS_STD_MEMORY_RESOURCE
+        /**
+         * @brief Returns _bytes bytes aligned to _alignment, a power of two, valid until the arena is rewound past
+         *        them.
+         */
+        void* allocate(std::size_t _bytes, std::size_t _alignment = alignof(std::max_align_t)) {
+            return bump(_bytes, _alignment);
+        }
+
+        void deallocate(void*, std::size_t, std::size_t = alignof(std::max_align_t)) {
+        }
+#endif
+
+        /**
+         * @brief Returns the current position, to pass to rewind() later.
+         */
+        marker mark() const { return m_top; }
+
+        /**
+         * @brief Gives back everything allocated since _mark was taken, keeping the blocks for reuse.
+         */
+        void rewind(marker _mark) { m_top = _mark; }
+
+        /**
+         * @brief Gives back everything allocated, keeping the blocks for reuse.
+         */
+        void reset() { m_top = marker{0, 0}; }
+
+        /**
+         * @brief Gives back everything allocated and frees the blocks.
+         */
+        void release() {
+            m_blocks.clear();
+            reset();
+        }
+
+        /**
+         * @brief Returns the number of bytes of the blocks the arena holds.
+         */
+        std::size_t capacity() const {
+            std::size_t bytes = 0;
+
+            for (const block& b : m_blocks) {
+                bytes += b.size;
+            }
+
+            return bytes;
+        }
+    };
+
+    /**
+     * @brief Standard allocator drawing from a scratch_arena, for containers used as temporary buffers without
+     *        std::pmr. Deallocating does nothing; the memory is reclaimed when the arena is rewound.
+     */
+    template <typename T>
+    class scratch_allocator {
+    private:
+        scratch_arena* m_arena;
+
+        template <typename U>
+        friend class scratch_allocator;
+
+    public:
+        using value_type = T;
+
+        explicit scratch_allocator(scratch_arena& _arena) noexcept : m_arena(&_arena) { }
+
+        template <typename U>
+        scratch_allocator(const scratch_allocator<U>& _other) noexcept : m_arena(_other.m_arena) { }
+
+        T* allocate(std::size_t _n) {
+            return static_cast<T*>(m_arena->allocate(_n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T*, std::size_t) noexcept {
+        }
+
+        scratch_arena& arena() const noexcept { return *m_arena; }
+
+        template <typename U>
+        bool operator==(const scratch_allocator<U>& _other) const noexcept { return m_arena == _other.m_arena; }
+
+        template <typename U>
+        bool operator!=(const scratch_allocator<U>& _other) const noexcept { return m_arena != _other.m_arena; }
+    };
+
+    /**
+     * @brief Returns the scratch_arena of the calling thread, which keeps its blocks until the thread exits.
+     */
+    inline scratch_arena& this_thread_scratch_arena() {
+        static thread_local scratch_arena arena;
+        return arena;
+    }
+
+    /**
+     * @brief Rewinds a scratch_arena to where it was on construction when it goes out of scope. Scopes nest, so a
+     *        chunk of a nested loop run on the same thread gives back its scratch memory only.
+     */
+    class scratch_scope {
+    private:
+        scratch_arena& m_arena;
+        scratch_arena::marker m_mark;
+
+    public:
+        explicit scratch_scope(scratch_arena& _arena) : m_arena(_arena), m_mark(_arena.mark()) { }
+
+        scratch_scope(const scratch_scope&) = delete;
+        scratch_scope& operator=(const scratch_scope&) = delete;
+
+        ~scratch_scope() { m_arena.rewind(m_mark); }
+    };
+
+    /**
+     * @brief Checks whether F takes a scratch_arena& after a Reference to an element, in which case for_each() hands
+     *        it the arena of the thread running the chunk.
+     */
+    template <typename F, typename Reference, typename = void>
+    struct takes_scratch_arena : std::false_type {
+    };
+
+    template <typename F, typename Reference>
+    struct takes_scratch_arena<F, Reference, decltype(static_cast<void>(
+            std::declval<F&>()(std::declval<Reference>(), std::declval<scratch_arena&>())))> : std::true_type {
+    };
+
+    template <typename Iterator, typename Sentinel, typename F>
+    void for_each_chunk(const iterator_range<Iterator, Sentinel>& _range, F& _f, std::false_type) {
+        for (Iterator it = _range.begin(), end = _range.end(); it != end; ++it) {
+            _f(*it);
+        }
+    }
+
+    template <typename Iterator, typename Sentinel, typename F>
+    void for_each_chunk(const iterator_range<Iterator, Sentinel>& _range, F& _f, std::true_type) {
+        scratch_arena& arena = this_thread_scratch_arena();
+        scratch_scope scope(arena);
+        const scratch_arena::marker mark = arena.mark();
+
+        for (Iterator it = _range.begin(), end = _range.end(); it != end; ++it) {
+            _f(*it, arena);
+            arena.rewind(mark);
+        }
+    }
+
+    template <typename Iterator, typename F>
+    using takes_scratch_arena_t =
+            typename takes_scratch_arena<F, typename std::iterator_traits<Iterator>::reference>::type;
+
+    /**
+     * @brief Calls _f on every element of _range in order on the calling thread. Like the parallel for_each(), _f may
+     *        take the calling thread's scratch_arena as a second argument, rewound after every element.
+     */
+    template <typename Iterator, typename Sentinel, typename F>
+    void for_each(const execution::sequenced_policy&, const iterator_range<Iterator, Sentinel>& _range, F _f) {
+        for_each_chunk(_range, _f, takes_scratch_arena_t<Iterator, F>());
+    }
+
+    template <typename Policy, typename Iterator, typename Sentinel, typename F>
+    void for_each_chunks(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, F& _f) {
+        parallel_for(_policy, _range, [&_f](const iterator_range<Iterator>& _chunk) {
+            for_each_chunk(_chunk, _f, takes_scratch_arena_t<Iterator, F>());
+        });
+    }
+
+#if ITERATOR_BASED_FOR_HAS_STD_EXECUTION
+    template <typename Policy, typename Iterator, typename Sentinel, typename F>
+    void for_each_standard(const Policy&, const iterator_range<Iterator, Sentinel>& _range, F& _f, std::false_type) {
+        if (classify_size(_range.size(), true) != size_class::large) {
+            for_each_chunk(_range, _f, std::false_type());
+        } else if (std::is_same<Policy, execution::parallel_unsequenced_policy>::value) {
+            std::for_each(std::execution::par_unseq, _range.begin(), _range.end(), _f);
+        } else {
+            std::for_each(std::execution::par, _range.begin(), _range.end(), _f);
+        }
+    }
+
+    //The standard algorithms have no chunks to rewind a scratch arena after, so such loops run on the pool.
+    template <typename Policy, typename Iterator, typename Sentinel, typename F>
+    void for_each_standard(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, F& _f,
+                           std::true_type) {
+        for_each_chunks(_policy, _range, _f);
+    }
+#endif
+
+    template <typename Policy, typename Iterator, typename Sentinel, typename F>
+    void for_each_parallel(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, F& _f,
+                           std::true_type) {
+#if ITERATOR_BASED_FOR_HAS_STD_EXECUTION
+        for_each_standard(_policy, _range, _f, takes_scratch_arena_t<Iterator, F>());
+#else
+        for_each_chunks(_policy, _range, _f);
+#endif
+    }
+
+    template <typename Policy, typename Iterator, typename Sentinel, typename F>
+    void for_each_parallel(const Policy&, const iterator_range<Iterator, Sentinel>& _range, F& _f, std::false_type) {
+        for_each(execution::seq, _range, std::ref(_f));
+    }
+
+    /**
+     * @brief Calls _f on every element of _range, distributing the elements across the threads of the policy's pool.
+     *        Only ranges whose size is known in constant time are split; other ranges are iterated sequentially.
+     *        _f must be safe to call concurrently on distinct elements. Unlike std::for_each, an exception thrown by
+     *        _f is rethrown on the calling thread once all running chunks have finished.
+     *
+     *        A function taking a scratch_arena& after the element is passed the arena of the thread running the
+     *        chunk, which is rewound after every element, so that the temporary buffers of the loop body come from
+     *        memory the thread keeps instead of the global allocator:
+     *
+     *        for_each(execution::par, (rows.begin(), rows.end()), [](row& r, scratch_arena& arena) {
+     *            std::pmr::vector<double> buffer(r.size(), &arena);
+     *            ...
+     *        });
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename F,
+              typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    void for_each(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, F _f) {
+        for_each_parallel(_policy, _range, _f, typename is_sized_sentinel_for<Sentinel, Iterator>::type());
+    }
+
+    /**
+     * @brief Calls _f with every element of the cartesian product _range in nested loops on the calling thread.
+     */
+    template <typename... Ranges, typename F>
+    void for_each(const execution::sequenced_policy&,
+                  const iterator_range<cartesian_product_iterator<Ranges...>>& _range, F _f) {
+        for_each(_range, std::ref(_f));
+    }
+
+    template <typename Policy, typename... Ranges, typename F>
+    void for_each_cartesian(const Policy& _policy, const std::tuple<Ranges...>& _ranges, F& _f, std::true_type) {
+        using outer = typename std::tuple_element<0, std::tuple<Ranges...>>::type;
+        using reference = typename cartesian_product_iterator<Ranges...>::reference;
+
+        using chunk = iterator_range<typename outer::iterator>;
+
+        parallel_for(_policy, std::get<0>(_ranges), [&_ranges, &_f](const chunk& _chunk) {
+            cartesian_for_each<reference>(_chunk, _ranges, _f);
+        });
+    }
+
+    template <typename Policy, typename... Ranges, typename F>
+    void for_each_cartesian(const Policy&, const std::tuple<Ranges...>& _ranges, F& _f, std::false_type) {
+        using reference = typename cartesian_product_iterator<Ranges...>::reference;
+
+        cartesian_for_each<reference>(std::get<0>(_ranges), _ranges, _f);
+    }
+
+    /**
+     * @brief Calls _f with every element of the cartesian product _range, splitting its first range across the
+     *        threads of the policy's pool when its size is known in constant time; every thread runs the nested loops
+     *        over the other ranges for its part of the first. _f must be safe to call concurrently.
+     */
+    template <typename Policy, typename... Ranges, typename F,
+              typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    void for_each(const Policy& _policy,
+                  const iterator_range<cartesian_product_iterator<Ranges...>>& _range, F _f) {
+        using outer = typename std::tuple_element<0, std::tuple<Ranges...>>::type;
+        const cartesian_product_iterator<Ranges...> first = _range.begin();
+
+        for_each_cartesian(_policy, first.ranges(), _f,
+                           typename is_sized_sentinel_for<typename outer::sentinel, typename outer::iterator>::type());
+    }
+
+    /**
+     * @brief Assigns _value to every element of _range from the threads that process the same blocks of it in loops
+     *        run with _policy.local(). Under the first-touch placement of the operating system, memory that has not
+     *        been written yet, such as a freshly allocated array of a trivial type, is thereby placed on the NUMA node
+     *        of the thread that later works on it.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename T,
+              typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    void first_touch(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, const T& _value) {
+        parallel_for(_policy.local(), _range, [&_value](const iterator_range<Iterator>& _block) {
+            std::fill(_block.begin(), _block.end(), _value);
+        });
+    }
+
+    /**
+     * @brief Assumed size of a cache line, used to keep data written by different threads apart.
+     */
+    constexpr std::size_t cache_line_size = 64;
+
+    /**
+     * @brief A value followed by a cache line of padding, so that consecutive values in an array never share a cache
+     *        line regardless of the array's alignment.
+     */
+    template <typename T>
+    struct cache_padded {
+        T value;
+        bool engaged;
+        char padding[cache_line_size];
+
+        explicit cache_padded(const T& _value) : value(_value), engaged(false), padding() { }
+    };
+
+    /**
+     * @brief Waits between two attempts to push to a full or pop from an empty queue: spins briefly and then yields.
+     */
+    inline void queue_back_off(std::size_t& _attempts) {
+        if (++_attempts > 16) {
+            std::this_thread::yield();
+        }
+    }
+
+    template <typename Queue>
+    class queue_pop_iterator;
+
+    /**
+     * @brief The blocking and closing operations of the bounded queues, built on the try_push() and try_pop() of
+     *        Queue. Once a queue is closed pushes fail, and pops drain what is left and then fail too, which ends the
+     *        input range over the queue's elements that begin() and end() delimit:
+     *
+     *        for (auto& message : queue.begin(), queue.end()) { ... }
+     */
+    template <typename Queue, typename T>
+    class queue_operations {
+    private:
+        std::atomic<bool> m_closed;
+
+        Queue& derived() { return static_cast<Queue&>(*this); }
+
+    protected:
+        queue_operations() : m_closed(false) { }
+
+    public:
+        using value_type = T;
+        using iterator = queue_pop_iterator<Queue>;
+
+        queue_operations(const queue_operations&) = delete;
+        queue_operations& operator=(const queue_operations&) = delete;
+
+        /**
+         * @brief Moves _value into the queue, waiting while it is full. Returns false, leaving _value alone, if the
+         *        queue is closed.
+         */
+        bool push(T& _value) {
+            for (std::size_t attempts = 0; !closed(); queue_back_off(attempts)) {
+                if (derived().try_push(_value)) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool push(T&& _value) { return push(_value); }
+
+        /**
+         * @brief Moves the oldest element into _value, waiting while the queue is empty. Returns false once the queue
+         *        is closed and empty.
+         */
+        bool pop(T& _value) {
+            for (std::size_t attempts = 0; !derived().try_pop(_value); queue_back_off(attempts)) {
+                //Elements pushed before the close are visible once the close is.
+                if (m_closed.load(std::memory_order_acquire)) {
+                    return derived().try_pop(_value);
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Ends the queue: pushes fail from now on and pops fail once the elements left have been taken.
+         */
+        void close() { m_closed.store(true, std::memory_order_release); }
+
+        bool closed() const { return m_closed.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Returns an iterator over the elements popped from the queue, which pops the first one. Several
+         *        consumers of a multi-consumer queue may iterate at the same time; each sees a part of the elements.
+         */
+        iterator begin() { return iterator(derived()); }
+        iterator end() { return iterator(); }
+    };
+
+    /**
+     * @brief Input iterator popping the elements of a bounded queue until it is closed and empty. Dereferencing
+     *        yields the element popped last, which may be moved from; copies of an iterator share it. A
+     *        value-initialized iterator is the end iterator.
+     */
+    template <typename Queue>
+    class queue_pop_iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = typename Queue::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = value_type*;
+        using reference = value_type&;
+
+    private:
+        Queue* m_queue;
+        std::shared_ptr<value_type> m_value;
+
+        void next() {
+            if (!m_queue->pop(*m_value)) {
+                m_queue = nullptr;
+                m_value.reset();
+            }
+        }
+
+    public:
+        queue_pop_iterator() : m_queue(nullptr), m_value() { }
+
+        explicit queue_pop_iterator(Queue& _queue) : m_queue(&_queue), m_value(std::make_shared<value_type>()) {
+            next();
+        }
+
+        queue_pop_iterator(const queue_pop_iterator&) = default;
+        queue_pop_iterator& operator=(const queue_pop_iterator&) = default;
+
+        reference operator*() const { return *m_value; }
+        pointer operator->() const { return m_value.get(); }
+
+        queue_pop_iterator& operator++() {
+            next();
+            return *this;
+        }
+
+        bool operator==(const queue_pop_iterator& rhs) const { return m_queue == rhs.m_queue; }
+        bool operator!=(const queue_pop_iterator& rhs) const { return m_queue != rhs.m_queue; }
+    };
+
+    /**
+     * @brief Lock-free queue of at most a fixed number of elements, which any number of threads may push to and pop
+     *        from. Every slot carries a sequence number telling whether it is free for the push or ready for the pop of
+     *        a given turn, so a push or pop claims its slot with a single compare-and-swap on the shared position and
+     *        then waits for nobody. The positions of pushes and pops lie on different cache lines.
+     *
+     *        The blocking push() and pop(), close() and the input range over the elements come from
+     *        queue_operations. T must be default constructible and move assignable.
+     */
+    template <typename T>
+    class bounded_queue : public queue_operations<bounded_queue<T>, T> {
+    private:
+        struct slot {
+            std::atomic<std::size_t> sequence;
+            T value;
+
+            slot() : sequence(0), value() { }
+        };
+
+        std::unique_ptr<slot[]> m_slots;
+        std::size_t m_mask;
+        char m_padding_before[cache_line_size];
+        std::atomic<std::size_t> m_push_position;
+        char m_padding_between[cache_line_size];
+        std::atomic<std::size_t> m_pop_position;
+        char m_padding_after[cache_line_size];
+
+        static std::size_t round_capacity(std::size_t _capacity) {
+            std::size_t capacity = 2;
+
+            while (capacity < _capacity) {
+                capacity *= 2;
+            }
+
+            return capacity;
+        }
+
+    public:
+        /**
+         * @brief Creates a queue holding at least _capacity elements, rounded up to a power of two.
+         */
+        explicit bounded_queue(std::size_t _capacity) :
+                queue_operations<bounded_queue<T>, T>(),
+                m_slots(new slot[round_capacity(_capacity)]),
+                m_mask(round_capacity(_capacity) - 1),
+                m_padding_before(),
+                m_push_position(0),
+                m_padding_between(),
+                m_pop_position(0),
+                m_padding_after() {
+            for (std::size_t i = 0; i <= m_mask; ++i) {
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        bounded_queue(const bounded_queue&) = delete;
+        bounded_queue& operator=(const bounded_queue&) = delete;
+
+        std::size_t capacity() const { return m_mask + 1; }
+
+        /**
+         * @brief Moves _value into the queue and returns true, or returns false, leaving _value alone, if the queue is
+         *        full.
+         */
+        bool try_push(T& _value) {
+            std::size_t position = m_push_position.load(std::memory_order_relaxed);
+
+            for (;;) {
+                slot& target = m_slots[position & m_mask];
+                const std::size_t sequence = target.sequence.load(std::memory_order_acquire);
+                const std::ptrdiff_t lag = static_cast<std::ptrdiff_t>(sequence - position);
+
+                if (lag == 0) {
+                    if (m_push_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        target.value = std::move(_value);
+                        target.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (lag < 0) {
+                    return false;
+                } else {
+                    position = m_push_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * @brief Moves the oldest element into _value and returns true, or returns false if the queue is empty.
+         */
+        bool try_pop(T& _value) {
+            std::size_t position = m_pop_position.load(std::memory_order_relaxed);
+
+            for (;;) {
+                slot& source = m_slots[position & m_mask];
+                const std::size_t sequence = source.sequence.load(std::memory_order_acquire);
+                const std::ptrdiff_t lag = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+
+                if (lag == 0) {
+                    if (m_pop_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        _value = std::move(source.value);
+                        source.sequence.store(position + m_mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (lag < 0) {
+                    return false;
+                } else {
+                    position = m_pop_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * @brief Moves elements from _values, at most _n of them, into the queue while it has room and returns how
+         *        many it moved. With several producers the batch may interleave with their elements.
+         */
+        std::size_t try_push(T* _values, std::size_t _n) {
+            std::size_t pushed = 0;
+
+            while (pushed < _n && try_push(_values[pushed])) {
+                ++pushed;
+            }
+
+            return pushed;
+        }
+
+        /**
+         * @brief Moves at most _n of the oldest elements to _values and returns how many it moved.
+         */
+        std::size_t try_pop(T* _values, std::size_t _n) {
+            std::size_t popped = 0;
+
+            while (popped < _n && try_pop(_values[popped])) {
+                ++popped;
+            }
+
+            return popped;
+        }
+    };
+
+    /**
+     * @brief Lock-free queue of at most a fixed number of elements between one producing and one consuming thread.
+     *        Each side owns a position on a cache line of its own and keeps a copy of the other side's, which it
+     *        reloads only when the copy says the queue is full or empty, so the two threads touch shared cache lines
+     *        about once per lap of the ring instead of once per element. A batch push or pop publishes all its
+     *        elements with a single store.
+     *
+     *        The blocking push() and pop(), close() and the input range over the elements come from
+     *        queue_operations. T must be default constructible and move assignable.
+     */
+    template <typename T>
+    class spsc_queue : public queue_operations<spsc_queue<T>, T> {
+    private:
+        std::unique_ptr<T[]> m_values;
+        std::size_t m_mask;
+        char m_padding_before[cache_line_size];
+        std::atomic<std::size_t> m_push_position;
+        std::size_t m_cached_pop_position;
+        char m_padding_between[cache_line_size];
+        std::atomic<std::size_t> m_pop_position;
+        std::size_t m_cached_push_position;
+        char m_padding_after[cache_line_size];
+
+        static std::size_t round_capacity(std::size_t _capacity) {
+            std::size_t capacity = 2;
+
+            while (capacity < _capacity) {
+                capacity *= 2;
+            }
+
+            return capacity;
+        }
+
+    public:
+        /**
+         * @brief Creates a queue holding at least _capacity elements, rounded up to a power of two.
+         */
+        explicit spsc_queue(std::size_t _capacity) :
+                queue_operations<spsc_queue<T>, T>(),
+                m_values(new T[round_capacity(_capacity)]()),
+                m_mask(round_capacity(_capacity) - 1),
+                m_padding_before(),
+                m_push_position(0),
+                m_cached_pop_position(0),
+                m_padding_between(),
+                m_pop_position(0),
+                m_cached_push_position(0),
+                m_padding_after() {
+        }
+
+        std::size_t capacity() const { return m_mask + 1; }
+
+        /**
+         * @brief Moves at most _n elements from _values into the queue and returns how many it moved. Only the
+         *        producing thread may push.
+         */
+        std::size_t try_push(T* _values, std::size_t _n) {
+            const std::size_t position = m_push_position.load(std::memory_order_relaxed);
+
+            if (capacity() - (position - m_cached_pop_position) < _n) {
+                m_cached_pop_position = m_pop_position.load(std::memory_order_acquire);
+            }
+
+            const std::size_t pushed = std::min(_n, capacity() - (position - m_cached_pop_position));
+
+            for (std::size_t i = 0; i < pushed; ++i) {
+                m_values[(position + i) & m_mask] = std::move(_values[i]);
+            }
+
+            if (pushed != 0) {
+                m_push_position.store(position + pushed, std::memory_order_release);
+            }
+
+            return pushed;
+        }
+
+        /**
+         * @brief Moves _value into the queue and returns true, or returns false, leaving _value alone, if the queue is
+         *        full.
+         */
+        bool try_push(T& _value) { return try_push(&_value, 1) == 1; }
+
+        /**
+         * @brief Moves at most _n of the oldest elements to _values and returns how many it moved. Only the consuming
+         *        thread may pop.
+         */
+        std::size_t try_pop(T* _values, std::size_t _n) {
+            const std::size_t position = m_pop_position.load(std::memory_order_relaxed);
+
+            if (m_cached_push_position - position < _n) {
+                m_cached_push_position = m_push_position.load(std::memory_order_acquire);
+            }
+
+            const std::size_t popped = std::min(_n, m_cached_push_position - position);
+
+            for (std::size_t i = 0; i < popped; ++i) {
+                _values[i] = std::move(m_values[(position + i) & m_mask]);
+            }
+
+            if (popped != 0) {
+                m_pop_position.store(position + popped, std::memory_order_release);
+            }
+
+            return popped;
+        }
+
+        /**
+         * @brief Moves the oldest element into _value and returns true, or returns false if the queue is empty.
+         */
+        bool try_pop(T& _value) { return try_pop(&_value, 1) == 1; }
+    };
+
+    /**
+     * @brief Number of reader counters of an epoch_domain. Readers on different threads mostly increment different
+     *        counters, each on a cache line of its own, so that entering a read section does not bounce one line
+     *        between all the reading cores.
+     */
+    constexpr std::size_t epoch_reader_stripes = 16;
+
+    /**
+     * @brief Epoch-based reclamation for data read without locks. A reader enters a read section by incrementing the
+     *        counter of the current epoch's parity on its stripe, checks that the epoch did not move meanwhile and
+     *        leaves by decrementing the counter again. The writer advances the epoch only once no reader is left in
+     *        the parity the next epoch uses, so an object unlinked during epoch e can no longer be reached by any
+     *        reader once the epoch reaches e + 2. Only one thread at a time may call try_advance().
+     */
+    class epoch_domain {
+    private:
+        struct stripe {
+            std::atomic<std::size_t> readers[2];
+            char padding[cache_line_size];
+        };
+
+        std::atomic<std::uint64_t> m_epoch;
+        std::unique_ptr<stripe[]> m_stripes;
+
+        static std::size_t stripe_index() {
+            static std::atomic<std::size_t> next(0);
+            thread_local const std::size_t index = next.fetch_add(1, std::memory_order_relaxed) % epoch_reader_stripes;
+            return index;
+        }
+
+    public:
+        epoch_domain() : m_epoch(0), m_stripes(new stripe[epoch_reader_stripes]()) { }
+
+        epoch_domain(const epoch_domain&) = delete;
+        epoch_domain& operator=(const epoch_domain&) = delete;
+
+        std::uint64_t epoch() const { return m_epoch.load(std::memory_order_seq_cst); }
+
+        /**
+         * @brief Enters a read section and returns the counter to decrement when leaving it.
+         */
+        std::atomic<std::size_t>& enter() {
+            stripe& own = m_stripes[stripe_index()];
+
+            for (;;) {
+                const std::uint64_t epoch = m_epoch.load(std::memory_order_seq_cst);
+                std::atomic<std::size_t>& readers = own.readers[epoch & 1];
+                readers.fetch_add(1, std::memory_order_seq_cst);
+
+                //A reader that saw the epoch before the last advance may count in the parity being drained.
+                if (m_epoch.load(std::memory_order_seq_cst) == epoch) {
+                    return readers;
+                }
+
+                readers.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        static void leave(std::atomic<std::size_t>& _readers) { _readers.fetch_sub(1, std::memory_order_release); }
+
+        /**
+         * @brief Advances the epoch and returns true if no reader counts in the parity of the next epoch, or returns
+         *        false.
+         */
+        bool try_advance() {
+            const std::uint64_t epoch = m_epoch.load(std::memory_order_relaxed);
+
+            for (std::size_t i = 0; i < epoch_reader_stripes; ++i) {
+                if (m_stripes[i].readers[(epoch + 1) & 1].load(std::memory_order_seq_cst) != 0) {
+                    return false;
+                }
+            }
+
+            m_epoch.store(epoch + 1, std::memory_order_seq_cst);
+            return true;
+        }
+    };
+
+    /**
+     * @brief A read section of an epoch_domain, left when the guard is destroyed.
+     */
+    class epoch_guard {
+    private:
+        std::atomic<std::size_t>* m_readers;
+
+    public:
+        explicit epoch_guard(epoch_domain& _domain) : m_readers(&_domain.enter()) { }
+
+        epoch_guard(epoch_guard&& _other) noexcept : m_readers(_other.m_readers) { _other.m_readers = nullptr; }
+
+        epoch_guard(const epoch_guard&) = delete;
+        epoch_guard& operator=(const epoch_guard&) = delete;
+        epoch_guard& operator=(epoch_guard&&) = delete;
+
+        ~epoch_guard() {
+            if (m_readers) {
+                epoch_domain::leave(*m_readers);
+            }
+        }
+    };
+
+    /**
+     * @brief A consistent version of the container of an rcu_container, iterated like a range of its const
+     *        iterators. The version stays alive as long as the snapshot does, whatever writers publish meanwhile, so
+     *        keep snapshots short-lived: a snapshot held forever keeps every later version from being reclaimed.
+     */
+    template <typename Container>
+    class rcu_snapshot : public iterator_range<typename Container::const_iterator> {
+    private:
+        epoch_guard m_guard;
+        const Container* m_container;
+
+    public:
+        rcu_snapshot(epoch_guard&& _guard, const Container& _container) :
+                iterator_range<typename Container::const_iterator>(_container.begin(), _container.end()),
+                m_guard(std::move(_guard)),
+                m_container(&_container) {
+        }
+
+        rcu_snapshot(rcu_snapshot&&) = default;
+        rcu_snapshot(const rcu_snapshot&) = delete;
+        rcu_snapshot& operator=(const rcu_snapshot&) = delete;
+
+        const Container& operator*() const { return *m_container; }
+        const Container* operator->() const { return m_container; }
+    };
+
+    /**
+     * @brief A container read by any number of threads without locks while writers occasionally replace it, in the
+     *        manner of read-copy-update. snapshot() enters a read section of an epoch_domain and returns the current
+     *        version, which readers iterate like any range:
+     *
+     *        rcu_container<std::vector<route>> routes;
+     *
+     *        for (const route& r : routes.snapshot()) { ... }
+     *
+     *        store() and update() publish a new version with one atomic exchange and retire the previous one, which
+     *        is destroyed once the epoch has advanced twice. Every publication and reclaim() try to advance the epoch,
+     *        so readers that only hold their snapshots for a loop never delay the writers. Writers are serialized by a
+     *        mutex, and update() copies the current version, so writes should be rare compared to reads. No snapshot
+     *        may outlive the container.
+     */
+    template <typename Container>
+    class rcu_container {
+    private:
+        struct retired {
+            std::uint64_t epoch;
+            std::unique_ptr<const Container> version;
+        };
+
+        mutable epoch_domain m_domain;
+        std::atomic<const Container*> m_current;
+        std::mutex m_writer;
+        std::vector<retired> m_retired;
+
+        void publish(std::unique_ptr<const Container> _next) {
+            m_retired.reserve(m_retired.size() + 1);
+            std::unique_ptr<const Container> previous(m_current.exchange(_next.release(), std::memory_order_seq_cst));
+            m_retired.push_back(retired{m_domain.epoch(), std::move(previous)});
+            reclaim_locked();
+        }
+
+        std::size_t reclaim_locked() {
+            //Two advances suffice to free everything retired so far when no reader lingers.
+            for (int i = 0; i < 2 && !m_retired.empty() && m_domain.try_advance(); ++i) {
+            }
+
+            const std::uint64_t epoch = m_domain.epoch();
+            auto reclaimable = std::remove_if(m_retired.begin(), m_retired.end(), [epoch](const retired& _retired) {
+                return _retired.epoch + 2 <= epoch;
+            });
+
+            m_retired.erase(reclaimable, m_retired.end());
+            return m_retired.size();
+        }
+
+    public:
+        explicit rcu_container(Container _initial = Container()) :
+                m_domain(), m_current(new Container(std::move(_initial))), m_writer(), m_retired() {
+        }
+
+        rcu_container(const rcu_container&) = delete;
+        rcu_container& operator=(const rcu_container&) = delete;
+
+        ~rcu_container() { delete m_current.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Returns the current version. Never blocks; safe to call from any number of threads at once.
+         */
+        rcu_snapshot<Container> snapshot() const {
+            epoch_guard guard(m_domain);
+            return rcu_snapshot<Container>(std::move(guard), *m_current.load(std::memory_order_seq_cst));
+        }
+
+        /**
+         * @brief Publishes _next as the current version.
+         */
+        void store(Container _next) {
+            std::unique_ptr<const Container> next(new Container(std::move(_next)));
+            std::lock_guard<std::mutex> lock(m_writer);
+            publish(std::move(next));
+        }
+
+        /**
+         * @brief Calls _f with a copy of the current version and publishes the copy. Nothing is published if _f
+         *        throws.
+         */
+        template <typename F>
+        void update(F&& _f) {
+            std::lock_guard<std::mutex> lock(m_writer);
+            std::unique_ptr<Container> next(new Container(*m_current.load(std::memory_order_relaxed)));
+            _f(*next);
+            publish(std::move(next));
+        }
+
+        /**
+         * @brief Destroys the retired versions no reader can reach any more and returns how many are left, for a
+         *        writer to call after its last publication once the readers have moved on.
+         */
+        std::size_t reclaim() {
+            std::lock_guard<std::mutex> lock(m_writer);
+            return reclaim_locked();
+        }
+    };
+
+    /**
+     * @brief Time an adaptive consumer of a shared_cursor aims to spend on each chunk: long enough for the claim to
+     *        cost nothing in comparison, short enough to balance the load at the end of the range.
+     */
+    constexpr std::chrono::microseconds shared_cursor_chunk_time(50);
+
+    /**
+     * @brief The position of a shared_cursor in a sized random access range, an index advanced with fetch_add.
+     */
+    template <typename Iterator, typename Sentinel, bool = is_sized_sentinel_for<Sentinel, Iterator>::value>
+    class shared_cursor_position {
+    private:
+        Iterator m_first;
+        std::size_t m_size;
+        char m_padding[cache_line_size];
+        std::atomic<std::size_t> m_next;
+
+    public:
+        explicit shared_cursor_position(const iterator_range<Iterator, Sentinel>& _range) :
+                m_first(_range.begin()), m_size(_range.size()), m_padding(), m_next(0) {
+        }
+
+        std::size_t claim(std::size_t _n, iterator_range<Iterator>& _chunk) {
+            //Claims past the end still advance the index, so check first to keep it from growing further.
+            if (m_next.load(std::memory_order_relaxed) >= m_size) {
+                return 0;
+            }
+
+            const std::size_t start = m_next.fetch_add(_n, std::memory_order_relaxed);
+
+            if (start >= m_size) {
+                return 0;
+            }
+
+            using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+            const std::size_t count = std::min(_n, m_size - start);
+            const Iterator first = m_first + static_cast<difference_type>(start);
+            _chunk = iterator_range<Iterator>(first, first + static_cast<difference_type>(count));
+            return count;
+        }
+
+        std::size_t remaining() const {
+            const std::size_t next = m_next.load(std::memory_order_relaxed);
+            return next < m_size ? m_size - next : 0;
+        }
+    };
+
+    /**
+     * @brief The position of a shared_cursor in any other range, an iterator advanced under a mutex.
+     */
+    template <typename Iterator, typename Sentinel>
+    class shared_cursor_position<Iterator, Sentinel, false> {
+    private:
+        std::mutex m_mutex;
+        Iterator m_current;
+        Sentinel m_end;
+
+    public:
+        explicit shared_cursor_position(const iterator_range<Iterator, Sentinel>& _range) :
+                m_mutex(), m_current(_range.begin()), m_end(_range.end()) {
+        }
+
+        std::size_t claim(std::size_t _n, iterator_range<Iterator>& _chunk) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const Iterator first = m_current;
+            std::size_t count = 0;
+
+            for (; count < _n && m_current != m_end; ++count) {
+                ++m_current;
+            }
+
+            _chunk = iterator_range<Iterator>(first, m_current);
+            return count;
+        }
+
+        std::size_t remaining() const { return ~std::size_t(0); }
+    };
+
+    /**
+     * @brief The position in a range shared by several threads, which claim consecutive chunks of it until it is
+     *        exhausted, the simplest form of dynamic load balancing. In a sized random access range a claim is one
+     *        fetch_add on an index; in other ranges the claiming thread advances a shared iterator under a mutex.
+     *
+     *        claim() takes chunks of a given size. Each thread may instead pull through its own consumer, which
+     *        sizes the chunks it claims after the time the previous one took, so that a chunk takes about
+     *        shared_cursor_chunk_time whatever the cost of an element, and near the end of a sized range takes
+     *        smaller chunks so that the threads finish together:
+     *
+     *        shared_cursor<std::vector<job>::iterator> cursor((jobs.begin(), jobs.end()));
+     *
+     *        pool.run_chunks(pool.concurrency(), [&cursor](std::size_t) {
+     *            auto consumer = cursor.make_consumer();
+     *            iterator_range<std::vector<job>::iterator> chunk = cursor.empty_chunk();
+     *
+     *            while (consumer.next(chunk)) {
+     *                for (job& j : chunk) { run(j); }
+     *            }
+     *        });
+     */
+    template <typename Iterator, typename Sentinel = Iterator>
+    class shared_cursor {
+    public:
+        using chunk_type = iterator_range<Iterator>;
+
+        /**
+         * @brief Claims chunks of the cursor for one thread, adapting their size to the cost of the elements.
+         */
+        class consumer {
+        private:
+            using clock = std::chrono::steady_clock;
+
+            shared_cursor* m_cursor;
+            std::size_t m_chunk;
+            std::size_t m_claimed;
+            clock::time_point m_claim_time;
+
+            void adapt(clock::time_point _now) {
+                if (m_claimed == 0) {
+                    return;
+                }
+
+                const auto elapsed = std::max<std::int64_t>(
+                        1, std::chrono::duration_cast<std::chrono::nanoseconds>(_now - m_claim_time).count());
+                const auto target = std::chrono::duration_cast<std::chrono::nanoseconds>(shared_cursor_chunk_time).count();
+                const double fitting = static_cast<double>(m_claimed) * static_cast<double>(target)
+                                       / static_cast<double>(elapsed);
+
+                //Grow at most twofold per claim, so that one fast chunk does not lead to a huge one.
+                m_chunk = fitting >= static_cast<double>(2 * m_chunk) ? 2 * m_chunk
+                                                                      : std::max<std::size_t>(1, static_cast<std::size_t>(fitting));
+            }
+
+        public:
+            explicit consumer(shared_cursor& _cursor) :
+                    m_cursor(&_cursor), m_chunk(1), m_claimed(0), m_claim_time() {
+                m_cursor->m_consumers.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            consumer(const consumer&) = default;
+            consumer& operator=(const consumer&) = default;
+
+            /**
+             * @brief Claims the next chunk into _chunk, or returns false if the range is exhausted. The time until
+             *        the following call is taken as the time the chunk took.
+             */
+            bool next(chunk_type& _chunk) {
+                const clock::time_point now = clock::now();
+                adapt(now);
+
+                const std::size_t share = m_cursor->m_position.remaining()
+                                          / (2 * m_cursor->m_consumers.load(std::memory_order_relaxed));
+                m_claimed = m_cursor->claim(std::max<std::size_t>(1, std::min(m_chunk, share)), _chunk);
+                m_claim_time = now;
+                return m_claimed != 0;
+            }
+
+            /**
+             * @brief Returns the number of elements the consumer claims next, before adapting to the last chunk.
+             */
+            std::size_t chunk_size() const { return m_chunk; }
+        };
+
+    private:
+        shared_cursor_position<Iterator, Sentinel> m_position;
+        std::atomic<std::size_t> m_consumers;
+        Iterator m_first;
+
+    public:
+        explicit shared_cursor(const iterator_range<Iterator, Sentinel>& _range) :
+                m_position(_range), m_consumers(0), m_first(_range.begin()) {
+        }
+
+        shared_cursor(const shared_cursor&) = delete;
+        shared_cursor& operator=(const shared_cursor&) = delete;
+
+        /**
+         * @brief Claims the next at most _n elements into _chunk and returns their number, 0 if the range is
+         *        exhausted. Safe to call from any number of threads at once.
+         */
+        std::size_t claim(std::size_t _n, chunk_type& _chunk) { return m_position.claim(_n, _chunk); }
+
+        /**
+         * @brief Returns a consumer for the calling thread. Every consumer counts as a thread sharing the range when
+         *        the chunk sizes near the end are chosen.
+         */
+        consumer make_consumer() { return consumer(*this); }
+
+        /**
+         * @brief Returns an empty chunk, to declare the variable a consumer claims into.
+         */
+        chunk_type empty_chunk() const { return chunk_type(m_first, m_first); }
+    };
+
+    /**
+     * @brief One partial result per thread of a pool, combined with _op when the loop has finished. Every worker and
+     *        the thread that started the loop accumulate into their own padded slot without synchronization; any
+     *        other thread helping to run the loop's tasks shares a final slot guarded by a mutex.
+     */
+    template <typename T, typename BinaryOp>
+    class per_thread_accumulator {
+    private:
+        const thread_pool& m_pool;
+        std::thread::id m_owner;
+        BinaryOp m_op;
+        std::vector<cache_padded<T>> m_slots;
+        std::mutex m_shared_mutex;
+
+        static void combine(cache_padded<T>& _slot, BinaryOp& _op, T&& _value) {
+            if (_slot.engaged) {
+                _slot.value = _op(std::move(_slot.value), std::move(_value));
+            } else {
+                _slot.value = std::move(_value);
+                _slot.engaged = true;
+            }
+        }
+
+    public:
+        per_thread_accumulator(const thread_pool& _pool, const T& _init, BinaryOp _op) :
+                m_pool(_pool),
+                m_owner(std::this_thread::get_id()),
+                m_op(std::move(_op)),
+                m_slots(_pool.concurrency() + 1, cache_padded<T>(_init)),
+                m_shared_mutex() {
+        }
+
+        /**
+         * @brief Adds the partial result _value to the slot of the calling thread.
+         */
+        void add(T _value) {
+            std::size_t index = m_pool.thread_index();
+
+            if (index + 1 < m_pool.concurrency() || std::this_thread::get_id() == m_owner) {
+                combine(m_slots[index], m_op, std::move(_value));
+            } else {
+                std::lock_guard<std::mutex> lock(m_shared_mutex);
+                combine(m_slots.back(), m_op, std::move(_value));
+            }
+        }
+
+        /**
+         * @brief Calls _f with the partial result of the calling thread, to accumulate into it in place.
+         */
+        template <typename F>
+        void update(F&& _f) {
+            std::size_t index = m_pool.thread_index();
+
+            if (index + 1 < m_pool.concurrency() || std::this_thread::get_id() == m_owner) {
+                _f(m_slots[index].value);
+                m_slots[index].engaged = true;
+            } else {
+                std::lock_guard<std::mutex> lock(m_shared_mutex);
+                _f(m_slots.back().value);
+                m_slots.back().engaged = true;
+            }
+        }
+
+        /**
+         * @brief Combines _init with the partial results in slot order.
+         */
+        T result(T _init) {
+            for (cache_padded<T>& slot : m_slots) {
+                if (slot.engaged) {
+                    _init = m_op(std::move(_init), std::move(slot.value));
+                }
+            }
+
+            return _init;
+        }
+    };
+
+    template <typename Iterator, typename Sentinel, typename T, typename BinaryOp, typename UnaryOp>
+    T transform_reduce_sequential(Iterator _first, const Sentinel& _last, T _init, BinaryOp& _reduce,
+                                  UnaryOp& _transform) {
+        for (; _first != _last; ++_first) {
+            _init = _reduce(std::move(_init), _transform(*_first));
+        }
+
+        return _init;
+    }
+
+    template <typename Policy, typename Iterator, typename Sentinel, typename T, typename BinaryOp, typename UnaryOp>
+    T transform_reduce_impl(const Policy&, const iterator_range<Iterator, Sentinel>& _range, T _init,
+                            BinaryOp& _reduce, UnaryOp& _transform, std::false_type) {
+        return transform_reduce_sequential(_range.begin(), _range.end(), std::move(_init), _reduce, _transform);
+    }
+
+    template <typename Policy, typename Iterator, typename Sentinel, typename T, typename BinaryOp, typename UnaryOp>
+    T transform_reduce_impl(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, T _init,
+                            BinaryOp& _reduce, UnaryOp& _transform, std::true_type) {
+#if ITERATOR_BASED_FOR_HAS_STD_EXECUTION
+        (void)_policy;
+
+        if (classify_size(_range.size(), true) != size_class::large) {
+            return transform_reduce_sequential(_range.begin(), _range.end(), std::move(_init), _reduce, _transform);
+        }
+
+        if (std::is_same<Policy, execution::parallel_unsequenced_policy>::value) {
+            return std::transform_reduce(std::execution::par_unseq, _range.begin(), _range.end(), std::move(_init),
+                                         _reduce, _transform);
+        }
+
+        return std::transform_reduce(std::execution::par, _range.begin(), _range.end(), std::move(_init), _reduce,
+                                     _transform);
+#else
+        per_thread_accumulator<T, BinaryOp> partials(_policy.pool(), _init, _reduce);
+
+        parallel_for(_policy, _range, [&](const iterator_range<Iterator>& _chunk) {
+            Iterator first = _chunk.begin();
+            Iterator last = _chunk.end();
+            T local = _transform(*first);
+
+            partials.add(transform_reduce_sequential(++first, last, std::move(local), _reduce, _transform));
+        });
+
+        return partials.result(std::move(_init));
+#endif
+    }
+
+    /**
+     * @brief Returns _init combined with _transform(x) for every element x of _range using _reduce. With a parallel
+     *        policy, ranges whose size is known in constant time are split across the threads of the policy's pool;
+     *        every thread accumulates into its own cache-line padded partial result and the partial results are
+     *        combined at the end, so _reduce must be associative and commutative. Other ranges are reduced in order
+     *        on the calling thread.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename T, typename BinaryOp, typename UnaryOp,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    T transform_reduce(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, T _init,
+                       BinaryOp _reduce, UnaryOp _transform) {
+        if (_range.empty()) {
+            return _init;
+        }
+
+        return transform_reduce_impl(_policy, _range, std::move(_init), _reduce, _transform,
+                                     std::integral_constant<bool, is_parallel_policy<Policy>::value
+                                         && is_sized_sentinel_for<Sentinel, Iterator>::value>());
+    }
+
+    /**
+     * @brief Returns _init combined with every element of _range using _op, which must be associative and
+     *        commutative. See transform_reduce() for how the work is distributed.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename T, typename BinaryOp = std::plus<T>,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    T reduce(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, T _init,
+             BinaryOp _op = BinaryOp()) {
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+        return transform_reduce(_policy, _range, std::move(_init), std::move(_op),
+                                [](reference _x) -> reference { return static_cast<reference>(_x); });
+    }
+
+    /**
+     * @brief Returns the sum of the elements of _range, starting from a value-initialized value_type.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    typename std::iterator_traits<Iterator>::value_type reduce(const Policy& _policy,
+                                                               const iterator_range<Iterator, Sentinel>& _range) {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        return reduce(_policy, _range, value_type());
+    }
+
+    /**
+     * @brief Returns the number of elements of _range for which _pred returns true. See transform_reduce() for how
+     *        the work is distributed.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename Predicate,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    typename std::iterator_traits<Iterator>::difference_type count_if(
+            const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Predicate _pred) {
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+        return transform_reduce(_policy, _range, difference_type(0), std::plus<difference_type>(),
+                                [&_pred](reference _x) -> difference_type { return _pred(_x) ? 1 : 0; });
+    }
+
+    /**
+     * @brief Hash table of aggregates by key with open addressing. The entries lie contiguously in insertion order;
+     *        a power-of-two array of 8-byte slots, filled to at most three quarters, holds a 32-bit fragment of each
+     *        key's hash next to the position of its entry and is probed linearly, so a lookup mostly touches one cache
+     *        line of slots and compares keys only when the fragments agree. Nothing is allocated per entry.
+     */
+    template <typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class flat_aggregate_table {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<Key, T>;
+        using size_type = std::size_t;
+        using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    private:
+        struct slot {
+            std::uint32_t fragment;
+            //Position of the entry plus one, zero for a free slot.
+            std::uint32_t entry;
+        };
+
+        std::vector<value_type> m_entries;
+        std::vector<slot> m_slots;
+        unsigned m_shift;
+        Hash m_hash;
+        KeyEqual m_equal;
+
+        std::uint64_t scramble(const Key& _key) const {
+            //Fibonacci hashing spreads the identity hashes of integers over the high bits probing starts from.
+            return static_cast<std::uint64_t>(m_hash(_key)) * UINT64_C(0x9E3779B97F4A7C15);
+        }
+
+        std::size_t probe(const Key& _key, std::uint64_t _hash) const {
+            const std::size_t mask = m_slots.size() - 1;
+            const std::uint32_t fragment = static_cast<std::uint32_t>(_hash);
+            std::size_t i = static_cast<std::size_t>(_hash >> m_shift);
+
+            while (m_slots[i].entry != 0
+                   && (m_slots[i].fragment != fragment || !m_equal(m_entries[m_slots[i].entry - 1].first, _key))) {
+                i = (i + 1) & mask;
+            }
+
+            return i;
+        }
+
+        void rehash(std::size_t _slots) {
+            unsigned bits = 3;
+
+            while ((std::size_t(1) << bits) < _slots) {
+                ++bits;
+            }
+
+            m_slots.assign(std::size_t(1) << bits, slot{0, 0});
+            m_shift = 64 - bits;
+
+            const std::size_t mask = m_slots.size() - 1;
+
+            for (std::size_t e = 0; e < m_entries.size(); ++e) {
+                const std::uint64_t hash = scramble(m_entries[e].first);
+                std::size_t i = static_cast<std::size_t>(hash >> m_shift);
+
+                while (m_slots[i].entry != 0) {
+                    i = (i + 1) & mask;
+                }
+
+                m_slots[i] = slot{static_cast<std::uint32_t>(hash), static_cast<std::uint32_t>(e + 1)};
+            }
+        }
+
+        static std::size_t slots_for(std::size_t _entries) { return _entries + _entries / 3 + 1; }
+
+        template <typename K, typename V>
+        std::pair<value_type*, bool> try_emplace(K&& _key, V&& _value) {
+            if (slots_for(m_entries.size() + 1) > m_slots.size()) {
+                rehash(2 * m_slots.size());
+            }
+
+            const std::uint64_t hash = scramble(_key);
+            const std::size_t i = probe(_key, hash);
+
+            if (m_slots[i].entry != 0) {
+                return std::make_pair(&m_entries[m_slots[i].entry - 1], false);
+            }
+
+            if (m_entries.size() >= UINT32_MAX - 1) {
+                throw std::length_error("flat_aggregate_table: too many keys");
+            }
+
+            m_entries.emplace_back(std::forward<K>(_key), std::forward<V>(_value));
+            m_slots[i] = slot{static_cast<std::uint32_t>(hash), static_cast<std::uint32_t>(m_entries.size())};
+
+            return std::make_pair(&m_entries.back(), true);
+        }
+
+    public:
+        /**
+         * @brief Creates a table with room for _expected keys before it has to grow.
+         */
+        explicit flat_aggregate_table(size_type _expected = 0, const Hash& _hash = Hash(),
+                                      const KeyEqual& _equal = KeyEqual()) :
+                m_entries(),
+                m_slots(),
+                m_shift(0),
+                m_hash(_hash),
+                m_equal(_equal) {
+            reserve(_expected);
+        }
+
+        /**
+         * @brief Makes room for _expected keys.
+         */
+        void reserve(size_type _expected) {
+            m_entries.reserve(_expected);
+
+            if (m_slots.empty() || slots_for(_expected) > m_slots.size()) {
+                rehash(slots_for(_expected));
+            }
+        }
+
+        /**
+         * @brief Returns the aggregate of _key, inserting a copy of _init for it first if the key is new.
+         */
+        T& find_or_insert(const Key& _key, const T& _init) { return try_emplace(_key, _init).first->second; }
+
+        /**
+         * @brief Returns the entry of _key, or end() if the table does not contain it.
+         */
+        const_iterator find(const Key& _key) const {
+            const std::size_t i = probe(_key, scramble(_key));
+
+            return m_slots[i].entry != 0 ? m_entries.begin() + static_cast<std::ptrdiff_t>(m_slots[i].entry - 1)
+                                         : m_entries.end();
+        }
+
+        /**
+         * @brief Moves the entries of _other into this table; the aggregates of keys both tables contain are combined
+         *        as _merge(mine, theirs).
+         */
+        template <typename BinaryOp>
+        void merge(flat_aggregate_table&& _other, BinaryOp& _merge) {
+            reserve(m_entries.size() + _other.m_entries.size() / 2);
+
+            for (value_type& entry : _other.m_entries) {
+                std::pair<value_type*, bool> inserted = try_emplace(std::move(entry.first), std::move(entry.second));
+
+                if (!inserted.second) {
+                    inserted.first->second = _merge(std::move(inserted.first->second), std::move(entry.second));
+                }
+            }
+
+            _other.m_entries.clear();
+            _other.rehash(0);
+        }
+
+        size_type size() const { return m_entries.size(); }
+
+        bool empty() const { return m_entries.empty(); }
+
+        /**
+         * @brief Returns the number of slots, which is a power of two.
+         */
+        size_type slot_count() const { return m_slots.size(); }
+
+        /**
+         * @brief The entries in the order their keys were first inserted.
+         */
+        const_iterator begin() const { return m_entries.begin(); }
+
+        const_iterator end() const { return m_entries.end(); }
+    };
+
+    /**
+     * @brief Most keys a table of aggregates reserves room for from the size of the range. The number of distinct
+     *        keys is usually far below the number of elements, so larger tables grow as keys arrive instead.
+     */
+    constexpr std::size_t aggregate_reserve_limit = std::size_t(1) << 16;
+
+    template <typename Iterator, typename KeyFunction>
+    using aggregate_key_t = typename std::decay<
+        decltype(std::declval<KeyFunction&>()(*std::declval<Iterator&>()))>::type;
+
+    template <typename Iterator, typename Sentinel>
+    std::size_t aggregate_size_estimate(const iterator_range<Iterator, Sentinel>& _range, std::true_type) {
+        return std::min(_range.size(), aggregate_reserve_limit);
+    }
+
+    template <typename Iterator, typename Sentinel>
+    std::size_t aggregate_size_estimate(const iterator_range<Iterator, Sentinel>&, std::false_type) {
+        return 0;
+    }
+
+    template <typename Table, typename Iterator, typename Sentinel, typename KeyFunction, typename T, typename BinaryOp>
+    void aggregate_into(Table& _table, Iterator _first, const Sentinel& _last, KeyFunction& _key, const T& _init,
+                        BinaryOp& _op) {
+        for (; _first != _last; ++_first) {
+            typename std::iterator_traits<Iterator>::reference x = *_first;
+            T& aggregate = _table.find_or_insert(_key(x), _init);
+
+            aggregate = _op(std::move(aggregate), x);
+        }
+    }
+
+    /**
+     * @brief Groups the elements x of _range by _key(x) and folds every group into _init as reduce() does, with
+     *        _op(aggregate, x). Returns the table of aggregates in the order the keys first occur. A range whose size
+     *        is known in constant time presizes the table.
+     */
+    template <typename Iterator, typename Sentinel, typename KeyFunction, typename T, typename BinaryOp>
+    flat_aggregate_table<aggregate_key_t<Iterator, KeyFunction>, T> aggregate_by_key(
+            const iterator_range<Iterator, Sentinel>& _range, KeyFunction _key, T _init, BinaryOp _op) {
+        flat_aggregate_table<aggregate_key_t<Iterator, KeyFunction>, T> table(
+            aggregate_size_estimate(_range, is_sized_sentinel_for<Sentinel, Iterator>()));
+
+        aggregate_into(table, _range.begin(), _range.end(), _key, _init, _op);
+
+        return table;
+    }
+
+    template <typename BinaryOp>
+    struct merge_aggregate_tables {
+        BinaryOp merge;
+
+        template <typename Table>
+        Table operator()(Table&& _left, Table&& _right) {
+            if (_left.size() < _right.size()) {
+                _right.merge(std::move(_left), merge);
+                return std::move(_right);
+            }
+
+            _left.merge(std::move(_right), merge);
+            return std::move(_left);
+        }
+    };
+
+    template <typename Policy, typename Iterator, typename Sentinel, typename KeyFunction, typename T,
+              typename BinaryOp, typename MergeOp>
+    flat_aggregate_table<aggregate_key_t<Iterator, KeyFunction>, T> aggregate_by_key_impl(
+            const Policy&, const iterator_range<Iterator, Sentinel>& _range, KeyFunction& _key, const T& _init,
+            BinaryOp& _op, MergeOp&, std::false_type) {
+        return aggregate_by_key(_range, _key, _init, _op);
+    }
+
+    template <typename Policy, typename Iterator, typename Sentinel, typename KeyFunction, typename T,
+              typename BinaryOp, typename MergeOp>
+    flat_aggregate_table<aggregate_key_t<Iterator, KeyFunction>, T> aggregate_by_key_impl(
+            const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, KeyFunction& _key, const T& _init,
+            BinaryOp& _op, MergeOp& _merge, std::true_type) {
+        using table_type = flat_aggregate_table<aggregate_key_t<Iterator, KeyFunction>, T>;
+
+        const std::size_t threads = _policy.pool().concurrency();
+        per_thread_accumulator<table_type, merge_aggregate_tables<MergeOp>> partials(
+            _policy.pool(), table_type(std::min(_range.size() / threads, aggregate_reserve_limit)),
+            merge_aggregate_tables<MergeOp>{_merge});
+
+        parallel_for(_policy, _range, [&](const iterator_range<Iterator>& _chunk) {
+            partials.update([&](table_type& _table) {
+                aggregate_into(_table, _chunk.begin(), _chunk.end(), _key, _init, _op);
+            });
+        });
+
+        return partials.result(table_type());
+    }
+
+    /**
+     * @brief Groups the elements of _range by key as the sequential aggregate_by_key() does. With a parallel policy,
+     *        ranges whose size is known in constant time are split across the threads of the policy's pool; every
+     *        thread aggregates into a table of its own and the tables are merged at the end, combining the aggregates
+     *        of a key found by several threads with _merge(aggregate, aggregate). _op and _merge must together be
+     *        associative and commutative, and the order of the keys in the result is unspecified. Other ranges are
+     *        aggregated in order on the calling thread.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename KeyFunction, typename T,
+              typename BinaryOp, typename MergeOp,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    flat_aggregate_table<aggregate_key_t<Iterator, KeyFunction>, T> aggregate_by_key(
+            const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, KeyFunction _key, T _init,
+            BinaryOp _op, MergeOp _merge) {
+        return aggregate_by_key_impl(_policy, _range, _key, _init, _op, _merge,
+                                     std::integral_constant<bool, is_parallel_policy<Policy>::value
+                                         && is_sized_sentinel_for<Sentinel, Iterator>::value>());
+    }
+
+    /**
+     * @brief Number of elements a piece of a parallel search scans between checks whether it can stop.
+     */
+    constexpr std::size_t search_check_interval = 1024;
+
+    template <typename Policy, typename Iterator, typename Sentinel, typename Predicate>
+    Iterator find_if_impl(const Policy&, const iterator_range<Iterator, Sentinel>& _range, Predicate& _pred,
+                          std::false_type) {
+        Iterator it = _range.begin();
+        const Sentinel last = _range.end();
+
+        while (it != last && !_pred(*it)) {
+            ++it;
+        }
+
+        return it;
+    }
+
+    template <typename Policy, typename Iterator, typename Sentinel, typename Predicate>
+    Iterator find_if_impl(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Predicate& _pred,
+                          std::true_type) {
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+
+        const Iterator first = _range.begin();
+        const std::size_t n = _range.size();
+
+#if ITERATOR_BASED_FOR_HAS_STD_EXECUTION
+        (void)_policy;
+        (void)n;
+
+        if (std::is_same<Policy, execution::parallel_unsequenced_policy>::value) {
+            return std::find_if(std::execution::par_unseq, first, first + static_cast<difference_type>(n), _pred);
+        }
+
+        return std::find_if(std::execution::par, first, first + static_cast<difference_type>(n), _pred);
+#else
+        //Position of the leftmost match found so far. A piece stops once a match lies to the left of where it is,
+        //so everything to the left of the result is scanned and hardly anything to the right of it.
+        std::atomic<std::size_t> found(n);
+
+        parallel_for(_policy, _range, [&](const iterator_range<Iterator>& _piece) {
+            Iterator it = _piece.begin();
+            std::size_t position = static_cast<std::size_t>(it - first);
+            const std::size_t end = position + _piece.size();
+
+            while (position < end && position < found.load(std::memory_order_relaxed)) {
+                const std::size_t stop = std::min(end, position + search_check_interval);
+
+                for (; position != stop; ++position, ++it) {
+                    if (_pred(*it)) {
+                        std::size_t leftmost = found.load(std::memory_order_relaxed);
+
+                        while (position < leftmost && !found.compare_exchange_weak(leftmost, position)) { }
+
+                        return;
+                    }
+                }
+            }
+        });
+
+        return first + static_cast<difference_type>(found.load());
+#endif
+    }
+
+    /**
+     * @brief Returns an iterator to the first element of _range for which _pred returns true, or the end of _range
+     *        if there is none. With a parallel policy, ranges whose size is known in constant time are searched by
+     *        all threads of the policy's pool, and every piece of the range stops as soon as a match to the left of
+     *        it has been found, so the elements after the first match are mostly left alone.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename Predicate,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    Iterator find_if(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Predicate _pred) {
+        return find_if_impl(_policy, _range, _pred,
+                            std::integral_constant<bool, is_parallel_policy<Policy>::value
+                                && is_sized_sentinel_for<Sentinel, Iterator>::value>());
+    }
+
+    /**
+     * @brief Returns an iterator to the first element of _range equal to _value. See find_if().
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename T,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    Iterator find(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, const T& _value) {
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+        return find_if(_policy, _range, [&_value](reference _x) { return _x == _value; });
+    }
+
+    template <typename Policy, typename Iterator, typename Sentinel, typename Predicate>
+    bool any_of_impl(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Predicate& _pred,
+                     std::false_type) {
+        return find_if_impl(_policy, _range, _pred, std::false_type()) != _range.end();
+    }
+
+    template <typename Policy, typename Iterator, typename Sentinel, typename Predicate>
+    bool any_of_impl(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Predicate& _pred,
+                     std::true_type) {
+#if ITERATOR_BASED_FOR_HAS_STD_EXECUTION
+        (void)_policy;
+
+        if (std::is_same<Policy, execution::parallel_unsequenced_policy>::value) {
+            return std::any_of(std::execution::par_unseq, _range.begin(), _range.end(), _pred);
+        }
+
+        return std::any_of(std::execution::par, _range.begin(), _range.end(), _pred);
+#else
+        //Any match answers the question, so the first one cancels the whole loop.
+        cancellation_token found;
+
+        parallel_for(_policy.cancelled_by(found), _range, [&](const iterator_range<Iterator>& _piece) {
+            Iterator it = _piece.begin();
+            const Iterator end = _piece.end();
+
+            while (it != end && !found.cancelled()) {
+                const Iterator stop = it + static_cast<typename std::iterator_traits<Iterator>::difference_type>(
+                        std::min<std::size_t>(search_check_interval, static_cast<std::size_t>(end - it)));
+
+                for (; it != stop; ++it) {
+                    if (_pred(*it)) {
+                        found.cancel();
+                        return;
+                    }
+                }
+            }
+        });
+
+        return found.cancelled();
+#endif
+    }
+
+    /**
+     * @brief Checks whether _pred returns true for some element of _range. With a parallel policy, ranges whose size
+     *        is known in constant time are searched by all threads of the policy's pool, which all stop once any of
+     *        them has found a match. The search cancels itself through a cancellation_token of its own, replacing
+     *        any token of the policy.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename Predicate,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    bool any_of(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Predicate _pred) {
+        return any_of_impl(_policy, _range, _pred,
+                           std::integral_constant<bool, is_parallel_policy<Policy>::value
+                               && is_sized_sentinel_for<Sentinel, Iterator>::value>());
+    }
+
+    /**
+     * @brief Checks whether _pred returns false for every element of _range. See any_of().
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename Predicate,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    bool none_of(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Predicate _pred) {
+        return !any_of(_policy, _range, std::move(_pred));
+    }
+
+    /**
+     * @brief Checks whether _pred returns true for every element of _range, stopping at the first counterexample.
+     *        See any_of().
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename Predicate,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    bool all_of(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Predicate _pred) {
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+        return !any_of(_policy, _range, [&_pred](reference _x) { return !_pred(_x); });
+    }
+
+    /**
+     * @brief Combines _value into _acc with _op, or stores it if _acc does not hold a value yet.
+     */
+    template <typename T, typename BinaryOp, typename U>
+    void fold_into(cache_padded<T>& _acc, BinaryOp& _op, U&& _value) {
+        if (_acc.engaged) {
+            _acc.value = _op(std::move(_acc.value), std::forward<U>(_value));
+        } else {
+            _acc.value = std::forward<U>(_value);
+            _acc.engaged = true;
+        }
+    }
+
+    /**
+     * @brief Checks whether folding Iterator's elements into a T with BinaryOp is a plain arithmetic sum over
+     *        contiguous memory, which fold_block() computes with independent accumulators the compiler can vectorize.
+     */
+    template <typename Iterator, typename T, typename BinaryOp>
+    struct is_contiguous_arithmetic_sum : std::integral_constant<bool,
+            is_contiguous_iterator<Iterator>::value
+            && std::is_arithmetic<T>::value
+            && std::is_same<typename std::iterator_traits<Iterator>::value_type, T>::value
+            && (std::is_same<BinaryOp, std::plus<T>>::value || std::is_same<BinaryOp, std::plus<>>::value)> {
+    };
+
+    template <typename Iterator, typename T, typename BinaryOp>
+    void fold_block(Iterator _first, const Iterator& _last, cache_padded<T>& _acc, BinaryOp& _op, std::false_type) {
+        for (; _first != _last; ++_first) {
+            fold_into(_acc, _op, *_first);
+        }
+    }
+
+    template <typename Iterator, typename T, typename BinaryOp>
+    void fold_block(Iterator _first, const Iterator& _last, cache_padded<T>& _acc, BinaryOp& _op, std::true_type) {
+        const T* p = IteratorBasedForImpl::to_address(_first);
+        const std::size_t n = static_cast<std::size_t>(_last - _first);
+        T sums[4] = {T(0), T(0), T(0), T(0)};
+        std::size_t i = 0;
+
+        for (; i + 4 <= n; i += 4) {
+            sums[0] += p[i];
+            sums[1] += p[i + 1];
+            sums[2] += p[i + 2];
+            sums[3] += p[i + 3];
+        }
+
+        for (; i < n; ++i) {
+            sums[0] += p[i];
+        }
+
+        fold_into(_acc, _op, (sums[0] + sums[1]) + (sums[2] + sums[3]));
+    }
+
+    /**
+     * @brief Checks whether scanning [Iterator, Sentinel) into OutputIterator with BinaryOp is an integer sum from
+     *        contiguous memory into contiguous memory, which scan_block() computes with simd::prefix_sum().
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename T, typename BinaryOp>
+    struct is_contiguous_integral_scan : std::integral_constant<bool,
+            is_contiguous_arithmetic_sum<Iterator, T, BinaryOp>::value
+            && simd::is_scan_element<T>::value
+            && std::is_same<Sentinel, Iterator>::value
+            && is_contiguous_iterator<OutputIterator>::value
+            && std::is_same<typename std::iterator_traits<OutputIterator>::reference, T&>::value> {
+    };
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename T, typename BinaryOp>
+    OutputIterator scan_block(Iterator _first, const Sentinel& _last, OutputIterator _out, cache_padded<T> _acc,
+                              BinaryOp& _op, bool _inclusive, std::false_type) {
+        if (!_acc.engaged) {
+            if (!(_first != _last)) {
+                return _out;
+            }
+
+            fold_into(_acc, _op, *_first);
+            *_out = _acc.value;
+            ++_first;
+            ++_out;
+        }
+
+        T acc = std::move(_acc.value);
+
+        //The increments are separate statements since the comma operator is overloaded for iterators.
+        if (_inclusive) {
+            for (; _first != _last; ++_first) {
+                acc = _op(std::move(acc), *_first);
+                *_out = acc;
+                ++_out;
+            }
+        } else {
+            for (; _first != _last; ++_first) {
+                T next = _op(acc, *_first);
+                *_out = std::move(acc);
+                acc = std::move(next);
+                ++_out;
+            }
+        }
+
+        return _out;
+    }
+
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename T, typename BinaryOp>
+    OutputIterator scan_block(Iterator _first, const Sentinel& _last, OutputIterator _out, cache_padded<T> _acc,
+                              BinaryOp& _op, bool _inclusive, std::true_type) {
+        //An empty _acc writes the first element before an exclusive scan of the others, which no carry reproduces.
+        if (!_acc.engaged && !_inclusive) {
+            return scan_block(_first, _last, std::move(_out), std::move(_acc), _op, _inclusive, std::false_type());
+        }
+
+        const std::size_t n = static_cast<std::size_t>(_last - _first);
+        simd::prefix_sum(IteratorBasedForImpl::to_address(_first), n, _acc.engaged ? _acc.value : T(0), _inclusive,
+                         IteratorBasedForImpl::to_address(_out));
+
+        return _out + static_cast<typename std::iterator_traits<OutputIterator>::difference_type>(n);
+    }
+
+    /**
+     * @brief Folds the elements of [_first, _last) into _acc with _op, writing the running result to _out after each
+     *        element if _inclusive is set and before it otherwise. An empty _acc starts with the first element.
+     *        Integer sums between contiguous ranges are scanned a vector at a time.
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename T, typename BinaryOp>
+    OutputIterator scan_block(Iterator _first, const Sentinel& _last, OutputIterator _out, cache_padded<T> _acc,
+                              BinaryOp& _op, bool _inclusive) {
+        return scan_block(std::move(_first), _last, std::move(_out), std::move(_acc), _op, _inclusive,
+                          typename is_contiguous_integral_scan<Iterator, Sentinel, OutputIterator, T, BinaryOp>::type());
+    }
+
+    template <typename Policy, typename Iterator, typename Sentinel, typename OutputIterator, typename T,
+              typename BinaryOp>
+    OutputIterator scan_impl(const Policy&, const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out,
+                             const cache_padded<T>& _init, BinaryOp& _op, bool _inclusive, std::false_type) {
+        return scan_block(_range.begin(), _range.end(), std::move(_out), _init, _op, _inclusive);
+    }
+
+    /**
+     * @brief Minimum number of elements per block of a parallel scan, below which the second pass over the data does
+     *        not pay off.
+     */
+    constexpr std::size_t scan_min_block = 4096;
+
+    /**
+     * @brief Two-pass parallel scan. The range is divided into about four blocks per thread; the first pass folds
+     *        every block but the last in parallel, the block totals are then scanned sequentially to get the value
+     *        each block starts from, and the second pass scans all blocks in parallel from those values.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename OutputIterator, typename T,
+              typename BinaryOp>
+    OutputIterator scan_impl(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                             OutputIterator _out, const cache_padded<T>& _init, BinaryOp& _op, bool _inclusive,
+                             std::true_type) {
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using out_difference_type = typename std::iterator_traits<OutputIterator>::difference_type;
+
+        thread_pool& pool = _policy.pool();
+        const std::size_t n = _range.size();
+        const std::size_t blocks = std::min(pool.concurrency() * 4, n / scan_min_block);
+
+        if (pool.concurrency() == 1 || blocks < 2) {
+            return scan_block(_range.begin(), _range.end(), std::move(_out), _init, _op, _inclusive);
+        }
+
+        const Iterator first = _range.begin();
+        auto bound = [n, blocks](std::size_t _block) { return n / blocks * _block + std::min(_block, n % blocks); };
+        auto at = [&first](std::size_t _index) { return first + static_cast<difference_type>(_index); };
+
+        std::vector<cache_padded<T>> carries(blocks, _init);
+
+        pool.run_chunks(blocks - 1, [&](std::size_t _block) {
+            cache_padded<T>& total = carries[_block + 1];
+            total.engaged = false;
+            fold_block(at(bound(_block)), at(bound(_block + 1)), total, _op,
+                       typename is_contiguous_arithmetic_sum<Iterator, T, BinaryOp>::type());
+        });
+
+        for (std::size_t block = 1; block < blocks; ++block) {
+            cache_padded<T> carry = carries[block - 1];
+            fold_into(carry, _op, std::move(carries[block].value));
+            carries[block] = std::move(carry);
+        }
+
+        pool.run_chunks(blocks, [&](std::size_t _block) {
+            scan_block(at(bound(_block)), at(bound(_block + 1)),
+                       _out + static_cast<out_difference_type>(bound(_block)), carries[_block], _op, _inclusive);
+        });
+
+        return _out + static_cast<out_difference_type>(n);
+    }
+
+    template <typename Policy, typename Iterator, typename Sentinel, typename OutputIterator>
+    struct is_parallel_scan : std::integral_constant<bool,
+            is_parallel_policy<Policy>::value
+            && is_sized_sentinel_for<Sentinel, Iterator>::value
+            && is_random_access_iterator<OutputIterator>::value> {
+    };
+
+    /**
+     * @brief Writes to _out the result of combining _init with the first i elements of _range using _op, for every
+     *        i from 1 to the size of the range, and returns the end of the output. With a parallel policy, ranges
+     *        whose size is known in constant time are scanned with two parallel passes if _out is a random access
+     *        iterator, so _op must be associative; otherwise the range is scanned in order on the calling thread.
+     *        _out may equal _range.begin().
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename OutputIterator, typename BinaryOp,
+              typename T, typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    OutputIterator inclusive_scan(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                                  OutputIterator _out, BinaryOp _op, T _init) {
+        cache_padded<T> init(_init);
+        init.engaged = true;
+
+        return scan_impl(_policy, _range, std::move(_out), init, _op, true,
+                         typename is_parallel_scan<Policy, Iterator, Sentinel, OutputIterator>::type());
+    }
+
+    /**
+     * @brief Like inclusive_scan(_policy, _range, _out, _op, _init), starting from the first element of the range.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename OutputIterator,
+              typename BinaryOp = std::plus<>,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    OutputIterator inclusive_scan(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                                  OutputIterator _out, BinaryOp _op = BinaryOp()) {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        if (_range.empty()) {
+            return _out;
+        }
+
+        Iterator first = _range.begin();
+        cache_padded<value_type> init(*first);
+
+        return scan_impl(_policy, _range, std::move(_out), init, _op, true,
+                         typename is_parallel_scan<Policy, Iterator, Sentinel, OutputIterator>::type());
+    }
+
+    /**
+     * @brief Writes to _out the result of combining _init with the first i elements of _range using _op, for every
+     *        i from 0 to the size of the range minus one, and returns the end of the output. The work is distributed
+     *        as by inclusive_scan().
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename OutputIterator, typename T,
+              typename BinaryOp = std::plus<>,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    OutputIterator exclusive_scan(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                                  OutputIterator _out, T _init, BinaryOp _op = BinaryOp()) {
+        cache_padded<T> init(_init);
+        init.engaged = true;
+
+        return scan_impl(_policy, _range, std::move(_out), init, _op, false,
+                         typename is_parallel_scan<Policy, Iterator, Sentinel, OutputIterator>::type());
+    }
+
+    /**
+     * @brief Smallest number of elements the sorting algorithms give a thread to work on.
+     */
+    constexpr std::size_t parallel_sort_min_block = 1u << 14;
+
+    /**
+     * @brief Number of elements from which sort() uses a radix sort for keys that allow it.
+     */
+    constexpr std::size_t radix_sort_min_size = 1u << 10;
+
+    /**
+     * @brief Number of elements below which nth_element() finishes the selection sequentially.
+     */
+    constexpr std::size_t parallel_select_min_size = 1u << 16;
+
+    /**
+     * @brief Runs _f(i) for every i in [0, _blocks) on _pool, or in order on the calling thread if _pool is null.
+     */
+    template <typename F>
+    void run_blocks(thread_pool* _pool, std::size_t _blocks, F _f) {
+        if (_pool) {
+            _pool->run_chunks(_blocks, std::move(_f));
+            return;
+        }
+
+        for (std::size_t i = 0; i < _blocks; ++i) {
+            _f(i);
+        }
+    }
+
+    /**
+     * @brief Returns the start of block _block of _n elements divided into _blocks blocks of as equal sizes as
+     *        possible.
+     */
+    inline std::size_t block_bound(std::size_t _n, std::size_t _blocks, std::size_t _block) {
+        return _n / _blocks * _block + std::min(_block, _n % _blocks);
+    }
+
+    /**
+     * @brief Returns the number of blocks _n elements are divided into for the threads of _pool, one per thread but
+     *        none smaller than parallel_sort_min_block, or a single block if _pool is null.
+     */
+    inline std::size_t sort_blocks(thread_pool* _pool, std::size_t _n) {
+        return _pool ? std::max<std::size_t>(1, std::min(_pool->concurrency(), _n / parallel_sort_min_block)) : 1;
+    }
+
+    /**
+     * @brief Moves the _n elements starting at _source to _destination grouped by the bucket from 0 to _buckets - 1
+     *        that _classify assigns them, in ascending order of buckets and in their original order within a bucket.
+     *        The elements are divided into _blocks blocks whose buckets are counted, and then moved, in parallel.
+     *        Stores the size of every bucket in _sizes. Moves nothing and returns false if all elements fall into one
+     *        bucket.
+     */
+    template <typename Source, typename Destination, typename Classify>
+    bool distribute(thread_pool* _pool, std::size_t _blocks, Source _source, Destination _destination, std::size_t _n,
+                    std::size_t _buckets, Classify _classify, std::size_t* _sizes) {
+        using difference_type = typename std::iterator_traits<Source>::difference_type;
+        using destination_difference_type = typename std::iterator_traits<Destination>::difference_type;
+
+        auto block_begin = [&](std::size_t _block) {
+            return _source + static_cast<difference_type>(block_bound(_n, _blocks, _block));
+        };
+
+        //offsets[block * _buckets + bucket] is first the size of the bucket within the block, then the position its
+        //first element moves to.
+        std::vector<std::size_t> offsets(_blocks * _buckets);
+
+        run_blocks(_pool, _blocks, [&](std::size_t _block) {
+            std::vector<std::size_t> counts(_buckets);
+
+            for (Source it = block_begin(_block), end = block_begin(_block + 1); it != end; ++it) {
+                ++counts[_classify(*it)];
+            }
+
+            std::copy(counts.begin(), counts.end(), offsets.begin() + static_cast<std::ptrdiff_t>(_block * _buckets));
+        });
+
+        std::size_t position = 0;
+        bool single_bucket = false;
+
+        for (std::size_t bucket = 0; bucket < _buckets; ++bucket) {
+            const std::size_t first = position;
+
+            for (std::size_t block = 0; block < _blocks; ++block) {
+                const std::size_t count = offsets[block * _buckets + bucket];
+                offsets[block * _buckets + bucket] = position;
+                position += count;
+            }
+
+            _sizes[bucket] = position - first;
+            single_bucket = single_bucket || _sizes[bucket] == _n;
+        }
+
+        if (single_bucket) {
+            return false;
+        }
+
+        run_blocks(_pool, _blocks, [&](std::size_t _block) {
+            std::vector<std::size_t> next(offsets.begin() + static_cast<std::ptrdiff_t>(_block * _buckets),
+                                          offsets.begin() + static_cast<std::ptrdiff_t>((_block + 1) * _buckets));
+
+            for (Source it = block_begin(_block), end = block_begin(_block + 1); it != end; ++it) {
+                std::size_t& target = next[_classify(*it)];
+                _destination[static_cast<destination_difference_type>(target++)] = std::move(*it);
+            }
+        });
+
+        return true;
+    }
+
+    /**
+     * @brief Moves the _n elements starting at _source to _destination in parallel.
+     */
+    template <typename Source, typename Destination>
+    void move_blocks(thread_pool* _pool, std::size_t _blocks, Source _source, Destination _destination,
+                     std::size_t _n) {
+        using difference_type = typename std::iterator_traits<Source>::difference_type;
+        using destination_difference_type = typename std::iterator_traits<Destination>::difference_type;
+
+        run_blocks(_pool, _blocks, [&](std::size_t _block) {
+            const std::size_t first = block_bound(_n, _blocks, _block);
+            const std::size_t last = block_bound(_n, _blocks, _block + 1);
+            std::move(_source + static_cast<difference_type>(first), _source + static_cast<difference_type>(last),
+                      _destination + static_cast<destination_difference_type>(first));
+        });
+    }
+
+    /**
+     * @brief Maps the arithmetic type T to an unsigned key type whose order as an unsigned integer is the order of T,
+     *        which is what a radix sort sorts by.
+     */
+    template <typename T, typename = void>
+    struct radix_traits { };
+
+    template <typename T>
+    struct radix_traits<T, typename std::enable_if<std::is_unsigned<T>::value
+                                                   && !std::is_same<T, bool>::value>::type> {
+        using key_type = T;
+
+        static key_type key(T _value) { return _value; }
+    };
+
+    template <typename T>
+    struct radix_traits<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type> {
+        using key_type = typename std::make_unsigned<T>::type;
+
+        static key_type key(T _value) {
+            return static_cast<key_type>(static_cast<key_type>(_value) ^ (key_type(1) << (sizeof(T) * CHAR_BIT - 1)));
+        }
+    };
+
+    template <typename T, typename Bits>
+    struct floating_point_radix_traits {
+        using key_type = Bits;
+
+        //Flipping the sign bit of positive numbers and all bits of negative ones orders them as unsigned integers.
+        static key_type key(T _value) {
+            Bits bits;
+            std::memcpy(&bits, &_value, sizeof(bits));
+            const Bits sign = Bits(1) << (sizeof(Bits) * CHAR_BIT - 1);
+            return bits ^ (static_cast<Bits>(Bits(0) - (bits >> (sizeof(Bits) * CHAR_BIT - 1))) | sign);
+        }
+    };
+
+    template <>
+    struct radix_traits<float> : floating_point_radix_traits<float, std::uint32_t> { };
+
+    template <>
+    struct radix_traits<double> : floating_point_radix_traits<double, std::uint64_t> { };
+
+    template <typename T, typename = void>
+    struct has_radix_key : std::false_type { };
+
+    template <typename T>
+    struct has_radix_key<T, typename std::enable_if<sizeof(typename radix_traits<T>::key_type) == sizeof(T)>::type>
+            : std::true_type {
+    };
+
+    /**
+     * @brief Checks whether ranges of Iterator sorted with Compare can be radix sorted: contiguous ranges of integers
+     *        or floating-point numbers compared with std::less.
+     */
+    template <typename Iterator, typename Compare>
+    struct is_radix_sortable : std::integral_constant<bool,
+            is_contiguous_iterator<Iterator>::value
+            && has_radix_key<typename std::iterator_traits<Iterator>::value_type>::value
+            && (std::is_same<Compare, std::less<>>::value
+                || std::is_same<Compare, std::less<typename std::iterator_traits<Iterator>::value_type>>::value)> {
+    };
+
+    /**
+     * @brief Sorts the _n elements at _data with a least significant digit first radix sort over bytes of the key,
+     *        moving the elements between _data and a buffer once per byte. Bytes that are equal in all keys are
+     *        skipped. The sort is stable with respect to the keys.
+     *
+     *        With several blocks, every pass counts the bytes of each block in the order the previous pass left the
+     *        elements in. A single block has the same counts in any order, so the bytes of all passes are counted in
+     *        one read of the elements up front.
+     */
+    template <typename T>
+    void radix_sort(thread_pool* _pool, T* _data, std::size_t _n) {
+        using traits = radix_traits<T>;
+
+        const std::size_t blocks = sort_blocks(_pool, _n);
+        std::unique_ptr<T[]> buffer(new T[_n]);
+        T* source = _data;
+        T* destination = buffer.get();
+
+        if (blocks == 1) {
+            std::vector<std::size_t> counts(sizeof(T) * 256);
+
+            for (std::size_t i = 0; i < _n; ++i) {
+                const typename traits::key_type key = traits::key(_data[i]);
+
+                for (std::size_t byte = 0; byte < sizeof(T); ++byte) {
+                    ++counts[byte * 256 + ((key >> (8 * byte)) & 0xff)];
+                }
+            }
+
+            for (std::size_t byte = 0; byte < sizeof(T); ++byte) {
+                std::size_t* next = counts.data() + byte * 256;
+
+                if (std::find(next, next + 256, _n) != next + 256) {
+                    continue;
+                }
+
+                for (std::size_t digit = 0, position = 0; digit < 256; ++digit) {
+                    position += std::exchange(next[digit], position);
+                }
+
+                for (std::size_t i = 0; i < _n; ++i) {
+                    destination[next[(traits::key(source[i]) >> (8 * byte)) & 0xff]++] = source[i];
+                }
+
+                std::swap(source, destination);
+            }
+        } else {
+            std::size_t sizes[256];
+
+            for (unsigned shift = 0; shift < sizeof(T) * CHAR_BIT; shift += 8) {
+                auto digit = [shift](const T& _value) {
+                    return static_cast<std::size_t>((traits::key(_value) >> shift) & 0xff);
+                };
+
+                if (distribute(_pool, blocks, source, destination, _n, 256, digit, sizes)) {
+                    std::swap(source, destination);
+                }
+            }
+        }
+
+        if (source != _data) {
+            move_blocks(_pool, blocks, source, _data, _n);
+        }
+    }
+
+    /**
+     * @brief Merges the sorted runs of _run_blocks blocks each in the _n elements starting at _source pairwise into
+     *        _destination, where _blocks blocks divide the elements. Every merge is split into pieces of about equal
+     *        output size at the positions where the merge path crosses them, so that the final merges also keep every
+     *        thread busy.
+     */
+    template <typename Source, typename Destination, typename Compare>
+    void merge_round(thread_pool& _pool, std::size_t _blocks, std::size_t _run_blocks, Source _source,
+                     Destination _destination, std::size_t _n, Compare& _compare) {
+        using difference_type = typename std::iterator_traits<Source>::difference_type;
+        using destination_difference_type = typename std::iterator_traits<Destination>::difference_type;
+
+        const std::size_t pairs = (_blocks + 2 * _run_blocks - 1) / (2 * _run_blocks);
+        const std::size_t pieces = std::max<std::size_t>(1, 2 * _pool.concurrency() / pairs);
+        auto at = [&_source](std::size_t _index) { return _source + static_cast<difference_type>(_index); };
+
+        _pool.run_chunks(pairs * pieces, [&](std::size_t _task) {
+            const std::size_t pair = _task / pieces;
+            const std::size_t piece = _task % pieces;
+            const std::size_t left = block_bound(_n, _blocks, std::min(_blocks, 2 * pair * _run_blocks));
+            const std::size_t middle = block_bound(_n, _blocks, std::min(_blocks, (2 * pair + 1) * _run_blocks));
+            const std::size_t right = block_bound(_n, _blocks, std::min(_blocks, (2 * pair + 2) * _run_blocks));
+            const std::size_t left_size = middle - left;
+            const std::size_t right_size = right - middle;
+
+            //Returns how many elements of the left run are among the first _k elements of the merge, which takes
+            //the element of the left run first among equivalent ones.
+            auto split = [&](std::size_t _k) {
+                std::size_t low = _k > right_size ? _k - right_size : 0;
+                std::size_t high = std::min(_k, left_size);
+
+                while (low < high) {
+                    const std::size_t i = low + (high - low) / 2;
+
+                    if (_compare(*at(middle + _k - i - 1), *at(left + i))) {
+                        high = i;
+                    } else {
+                        low = i + 1;
+                    }
+                }
+
+                return low;
+            };
+
+            const std::size_t first = (left_size + right_size) * piece / pieces;
+            const std::size_t last = (left_size + right_size) * (piece + 1) / pieces;
+            const std::size_t first_left = split(first);
+            const std::size_t last_left = split(last);
+
+            std::merge(std::make_move_iterator(at(left + first_left)), std::make_move_iterator(at(left + last_left)),
+                       std::make_move_iterator(at(middle + first - first_left)),
+                       std::make_move_iterator(at(middle + last - last_left)),
+                       _destination + static_cast<destination_difference_type>(left + first), std::ref(_compare));
+        });
+    }
+
+    /**
+     * @brief Sorts the _n elements starting at _first by sorting one block per thread in parallel and then merging
+     *        the sorted blocks pairwise, alternating between the range and a buffer. Stable if _stable is true.
+     */
+    template <typename Iterator, typename Compare>
+    void merge_sort(thread_pool& _pool, Iterator _first, std::size_t _n, Compare& _compare, bool _stable) {
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        std::size_t blocks = 1;
+
+        while (blocks < _pool.concurrency() && 2 * blocks * parallel_sort_min_block <= _n) {
+            blocks *= 2;
+        }
+
+        auto at = [&_first](std::size_t _index) { return _first + static_cast<difference_type>(_index); };
+
+        _pool.run_chunks(blocks, [&](std::size_t _block) {
+            if (_stable) {
+                std::stable_sort(at(block_bound(_n, blocks, _block)), at(block_bound(_n, blocks, _block + 1)),
+                                 std::ref(_compare));
+            } else {
+                std::sort(at(block_bound(_n, blocks, _block)), at(block_bound(_n, blocks, _block + 1)),
+                          std::ref(_compare));
+            }
+        });
+
+        if (blocks == 1) {
+            return;
+        }
+
+        std::unique_ptr<value_type[]> buffer(new value_type[_n]);
+        bool in_buffer = false;
+
+        for (std::size_t run_blocks = 1; run_blocks < blocks; run_blocks *= 2, in_buffer = !in_buffer) {
+            if (in_buffer) {
+                merge_round(_pool, blocks, run_blocks, buffer.get(), _first, _n, _compare);
+            } else {
+                merge_round(_pool, blocks, run_blocks, _first, buffer.get(), _n, _compare);
+            }
+        }
+
+        if (in_buffer) {
+            move_blocks(&_pool, blocks, buffer.get(), _first, _n);
+        }
+    }
+
+    template <typename Iterator, typename Compare>
+    void comparison_sort(thread_pool*, Iterator _first, std::size_t _n, Compare& _compare, bool _stable,
+                         std::false_type) {
+        Iterator last = _first + static_cast<typename std::iterator_traits<Iterator>::difference_type>(_n);
+
+        if (_stable) {
+            std::stable_sort(_first, last, std::ref(_compare));
+        } else {
+            std::sort(_first, last, std::ref(_compare));
+        }
+    }
+
+    template <typename Iterator, typename Compare>
+    void comparison_sort(thread_pool* _pool, Iterator _first, std::size_t _n, Compare& _compare, bool _stable,
+                         std::true_type) {
+        if (_pool && _pool->concurrency() > 1 && _n >= 2 * parallel_sort_min_block) {
+#if ITERATOR_BASED_FOR_HAS_STD_EXECUTION
+            Iterator last = _first + static_cast<typename std::iterator_traits<Iterator>::difference_type>(_n);
+
+            if (_stable) {
+                std::stable_sort(std::execution::par, _first, last, std::ref(_compare));
+            } else {
+                std::sort(std::execution::par, _first, last, std::ref(_compare));
+            }
+#else
+            merge_sort(*_pool, _first, _n, _compare, _stable);
+#endif
+            return;
+        }
+
+        comparison_sort(nullptr, _first, _n, _compare, _stable, std::false_type());
+    }
+
+    /**
+     * @brief Checks whether the elements of ranges of Iterator can be sorted in parallel, which moves them through a
+     *        buffer of default constructed elements.
+     */
+    template <typename Iterator>
+    struct is_parallel_sortable : std::integral_constant<bool,
+            std::is_default_constructible<typename std::iterator_traits<Iterator>::value_type>::value
+            && std::is_move_assignable<typename std::iterator_traits<Iterator>::value_type>::value> {
+    };
+
+    template <typename Iterator, typename Compare>
+    void sort_impl(thread_pool* _pool, Iterator _first, std::size_t _n, Compare& _compare, bool _stable,
+                   std::false_type) {
+        comparison_sort(_pool, _first, _n, _compare, _stable, typename is_parallel_sortable<Iterator>::type());
+    }
+
+    template <typename Iterator, typename Compare>
+    void sort_impl(thread_pool* _pool, Iterator _first, std::size_t _n, Compare& _compare, bool _stable,
+                   std::true_type) {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        //A radix sort orders -0.0 before 0.0, which compare equal, so it is stable for integers only.
+        if (_n >= radix_sort_min_size && (!_stable || std::is_integral<value_type>::value)) {
+            radix_sort(_pool, IteratorBasedForImpl::to_address(_first), _n);
+            return;
+        }
+
+        sort_impl(_pool, _first, _n, _compare, _stable, std::false_type());
+    }
+
+    template <typename Iterator, typename Sentinel, typename Compare>
+    void sort_range(thread_pool* _pool, const iterator_range<Iterator, Sentinel>& _range, Compare& _compare,
+                    bool _stable) {
+        static_assert(is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "sorting requires a random access range whose size is known in constant time");
+
+        sort_impl(_pool, _range.begin(), _range.size(), _compare, _stable,
+                  typename is_radix_sortable<Iterator, Compare>::type());
+    }
+
+    /**
+     * @brief Sorts the random access range _range with respect to _compare on the calling thread. Contiguous ranges
+     *        of integers or floating-point numbers compared with std::less are radix sorted, which takes linear time;
+     *        other ranges are sorted with std::sort.
+     */
+    template <typename Iterator, typename Sentinel, typename Compare = std::less<>>
+    void sort(const execution::sequenced_policy&, const iterator_range<Iterator, Sentinel>& _range,
+              Compare _compare = Compare()) {
+        sort_range(nullptr, _range, _compare, false);
+    }
+
+    /**
+     * @brief Sorts the random access range _range with respect to _compare on the threads of the policy's pool.
+     *        Contiguous ranges of integers or floating-point numbers compared with std::less are radix sorted with
+     *        parallel passes. Other ranges are divided into a block per thread, the blocks are sorted in parallel and
+     *        then merged pairwise, every merge being split across the threads as well. _compare must be safe to call
+     *        concurrently.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename Compare = std::less<>,
+              typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    void sort(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Compare _compare = Compare()) {
+        sort_range(&_policy.pool(), _range, _compare, false);
+    }
+
+    /**
+     * @brief Like sort(seq, _range, _compare), keeping equivalent elements in their original order. Only integers
+     *        are radix sorted.
+     */
+    template <typename Iterator, typename Sentinel, typename Compare = std::less<>>
+    void stable_sort(const execution::sequenced_policy&, const iterator_range<Iterator, Sentinel>& _range,
+                     Compare _compare = Compare()) {
+        sort_range(nullptr, _range, _compare, true);
+    }
+
+    /**
+     * @brief Like sort(_policy, _range, _compare), keeping equivalent elements in their original order. Only
+     *        integers are radix sorted.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename Compare = std::less<>,
+              typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    void stable_sort(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                     Compare _compare = Compare()) {
+        sort_range(&_policy.pool(), _range, _compare, true);
+    }
+
+    /**
+     * @brief Reorders the _n elements starting at _first so that the element at _nth is the one a sort would put
+     *        there. While the range is large, a sorted sample of it gives two bounds that the element at _nth most
+     *        likely lies between, the elements are partitioned in parallel into those below, between and above the
+     *        bounds, and the selection continues in the part holding _nth, a small fraction of the range.
+     */
+    template <typename Iterator, typename Compare>
+    void select_impl(thread_pool& _pool, Iterator _first, std::size_t _n, std::size_t _nth, Compare& _compare,
+                     std::true_type) {
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        const std::size_t samples = 1024;
+        const std::size_t spread = 32;
+        std::unique_ptr<value_type[]> buffer;
+
+        while (_pool.concurrency() > 1 && _n >= parallel_select_min_size) {
+            std::vector<value_type> sample;
+            sample.reserve(samples);
+
+            for (std::size_t i = 0; i < samples; ++i) {
+                sample.push_back(_first[static_cast<difference_type>(i * _n / samples)]);
+            }
+
+            std::sort(sample.begin(), sample.end(), std::ref(_compare));
+
+            const std::size_t rank = _nth * samples / _n;
+            const value_type& low = sample[rank > spread ? rank - spread : 0];
+            const value_type& high = sample[std::min(rank + spread, samples - 1)];
+            const std::size_t blocks = sort_blocks(&_pool, _n);
+            std::size_t sizes[3];
+
+            auto part = [&](const value_type& _value) -> std::size_t {
+                return _compare(_value, low) ? 0 : _compare(high, _value) ? 2 : 1;
+            };
+
+            if (!buffer) {
+                buffer.reset(new value_type[_n]);
+            }
+
+            //The bounds are elements of the range, so everything falling between them means there is no progress.
+            if (!distribute(&_pool, blocks, _first, buffer.get(), _n, 3, part, sizes)) {
+                break;
+            }
+
+            move_blocks(&_pool, blocks, buffer.get(), _first, _n);
+
+            if (_nth < sizes[0]) {
+                _n = sizes[0];
+            } else if (_nth < sizes[0] + sizes[1]) {
+                if (!_compare(low, high)) {
+                    return;
+                }
+
+                _first += static_cast<difference_type>(sizes[0]);
+                _nth -= sizes[0];
+                _n = sizes[1];
+            } else {
+                _first += static_cast<difference_type>(sizes[0] + sizes[1]);
+                _nth -= sizes[0] + sizes[1];
+                _n = sizes[2];
+            }
+        }
+
+        select_impl(_pool, _first, _n, _nth, _compare, std::false_type());
+    }
+
+    template <typename Iterator, typename Compare>
+    void select_impl(thread_pool&, Iterator _first, std::size_t _n, std::size_t _nth, Compare& _compare,
+                     std::false_type) {
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+
+        std::nth_element(_first, _first + static_cast<difference_type>(_nth), _first + static_cast<difference_type>(_n),
+                         std::ref(_compare));
+    }
+
+    /**
+     * @brief Reorders the random access range _range so that _nth holds the element a sort with respect to _compare
+     *        would put there, no element before it is greater and no element after it is less, like
+     *        std::nth_element on the calling thread.
+     */
+    template <typename Iterator, typename Sentinel, typename Compare = std::less<>>
+    void nth_element(const execution::sequenced_policy&, const iterator_range<Iterator, Sentinel>& _range,
+                     Iterator _nth, Compare _compare = Compare()) {
+        static_assert(is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "nth_element requires a random access range whose size is known in constant time");
+
+        std::nth_element(_range.begin(), _nth, _range.begin() + static_cast<std::ptrdiff_t>(_range.size()),
+                         std::ref(_compare));
+    }
+
+    /**
+     * @brief Like nth_element(seq, _range, _nth, _compare), partitioning large ranges on the threads of the
+     *        policy's pool around bounds taken from a sample of the range until the part holding _nth is small.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename Compare = std::less<>,
+              typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    void nth_element(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Iterator _nth,
+                     Compare _compare = Compare()) {
+        static_assert(is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "nth_element requires a random access range whose size is known in constant time");
+
+        const std::size_t nth = static_cast<std::size_t>(_nth - _range.begin());
+
+        if (nth < _range.size()) {
+            select_impl(_policy.pool(), _range.begin(), _range.size(), nth, _compare,
+                        typename is_parallel_sortable<Iterator>::type());
+        }
+    }
+
+    /**
+     * @brief Sorts the elements of the random access range _range that a sort with respect to _compare would put
+     *        before _middle into [_range.begin(), _middle), leaving the others after it in unspecified order, by
+     *        selecting them with nth_element() and sorting them with sort() under the same policy.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename Compare = std::less<>,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    void partial_sort(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Iterator _middle,
+                      Compare _compare = Compare()) {
+        IteratorBasedForImpl::nth_element(_policy, _range, _middle, _compare);
+        IteratorBasedForImpl::sort(_policy, iterator_range<Iterator>(_range.begin(), _middle), _compare);
+    }
+
+    /**
+     * @brief Minimum number of elements per block of a parallel top_k(), and of elements per selected one, below
+     *        which selecting a block's best elements on its own thread does not pay for selecting among them again.
+     */
+    constexpr std::size_t top_k_min_block = 1u << 16;
+    constexpr std::size_t top_k_min_ratio = 16;
+
+    /**
+     * @brief Like top_k(_range, _k, _out, _compare) on the calling thread.
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename Compare = std::greater<>>
+    OutputIterator top_k(const execution::sequenced_policy&, const iterator_range<Iterator, Sentinel>& _range,
+                         std::size_t _k, OutputIterator _out, Compare _compare = Compare()) {
+        return IteratorBasedForImpl::top_k(_range, _k, std::move(_out), std::move(_compare));
+    }
+
+    /**
+     * @brief Like top_k(_range, _k, _out, _compare), selecting the best _k elements of a block per thread and then
+     *        the best _k among those, which with a contiguous range of kernel elements runs the vector kernels as
+     *        well. _compare must be safe to call concurrently.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename OutputIterator,
+              typename Compare = std::greater<>,
+              typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    OutputIterator top_k(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, std::size_t _k,
+                         OutputIterator _out, Compare _compare = Compare()) {
+        static_assert(is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "top_k requires a random access range whose size is known in constant time");
+
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        thread_pool& pool = _policy.pool();
+        const std::size_t n = _range.size();
+        const std::size_t block = std::max(top_k_min_block, _k < n / top_k_min_ratio ? _k * top_k_min_ratio : n);
+        const std::size_t blocks = std::max<std::size_t>(1, std::min(pool.concurrency(), n / block));
+
+        if (blocks < 2) {
+            return IteratorBasedForImpl::top_k(_range, _k, std::move(_out), std::move(_compare));
+        }
+
+        const Iterator first = _range.begin();
+        auto at = [&first, n, blocks](std::size_t _block) {
+            return first + static_cast<difference_type>(block_bound(n, blocks, _block));
+        };
+
+        std::vector<std::vector<value_type>> best(blocks);
+
+        pool.run_chunks(blocks, [&](std::size_t _block) {
+            best[_block].reserve(_k);
+            IteratorBasedForImpl::top_k(make_iterator_range(at(_block), at(_block + 1)), _k,
+                                        std::back_inserter(best[_block]), _compare);
+        });
+
+        for (std::size_t b = 1; b < blocks; ++b) {
+            std::move(best[b].begin(), best[b].end(), std::back_inserter(best[0]));
+        }
+
+        return IteratorBasedForImpl::top_k(make_iterator_range(best[0].begin(), best[0].end()), _k, std::move(_out),
+                                           std::move(_compare));
+    }
+
+    /**
+     * @brief Minimum number of elements per block of a parallel copy_if() or remove_if(), below which counting and
+     *        copying a block on its own thread does not pay off.
+     */
+    constexpr std::size_t compact_min_block = 1u << 15;
+
+    /**
+     * @brief Returns the number of blocks copy_if() and remove_if() divide _n elements into for the threads of _pool,
+     *        about four per thread but none smaller than compact_min_block.
+     */
+    inline std::size_t compact_blocks(thread_pool& _pool, std::size_t _n) {
+        return _pool.concurrency() == 1 ? 1 : std::max<std::size_t>(1, std::min(_pool.concurrency() * 4,
+                                                                                 _n / compact_min_block));
+    }
+
+    template <typename Iterator, typename Sentinel>
+    struct is_parallel_compactable : std::integral_constant<bool, is_sized_sentinel_for<Sentinel, Iterator>::value> {
+    };
+
+    template <typename Policy, typename Iterator, typename Sentinel, typename OutputIterator, typename Predicate>
+    OutputIterator copy_if_impl(const Policy&, const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out,
+                                Predicate& _pred, std::false_type) {
+        return IteratorBasedForImpl::copy_if(_range, std::move(_out), std::ref(_pred));
+    }
+
+    /**
+     * @brief Parallel stream compaction. The range is divided into blocks whose elements satisfying _pred are counted
+     *        in parallel, the counts are scanned sequentially to get the position every block's elements go to, and
+     *        the blocks are then copied to those positions in parallel, evaluating _pred once more.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename OutputIterator, typename Predicate>
+    OutputIterator copy_if_impl(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                                OutputIterator _out, Predicate& _pred, std::true_type) {
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+        using out_difference_type = typename std::iterator_traits<OutputIterator>::difference_type;
+
+        thread_pool& pool = _policy.pool();
+        const std::size_t n = _range.size();
+        const std::size_t blocks = compact_blocks(pool, n);
+
+        if (blocks < 2) {
+            return IteratorBasedForImpl::copy_if(_range, std::move(_out), std::ref(_pred));
+        }
+
+        const Iterator first = _range.begin();
+        auto at = [&first, n, blocks](std::size_t _block) {
+            return first + static_cast<difference_type>(block_bound(n, blocks, _block));
+        };
+
+        std::vector<std::size_t> offsets(blocks + 1);
+
+        pool.run_chunks(blocks, [&](std::size_t _block) {
+            std::size_t count = 0;
+
+            for (Iterator it = at(_block), end = at(_block + 1); it != end; ++it) {
+                count += _pred(*it) ? 1 : 0;
+            }
+
+            offsets[_block + 1] = count;
+        });
+
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        pool.run_chunks(blocks, [&](std::size_t _block) {
+            IteratorBasedForImpl::copy_if(make_iterator_range(at(_block), at(_block + 1)),
+                                          _out + static_cast<out_difference_type>(offsets[_block]), std::ref(_pred));
+        });
+
+        return _out + static_cast<out_difference_type>(offsets[blocks]);
+    }
+
+    /**
+     * @brief Copies the elements of _range that satisfy _pred to _out, in order, on the calling thread, like
+     *        copy_if(_range, _out, _pred).
+     */
+    template <typename Iterator, typename Sentinel, typename OutputIterator, typename Predicate>
+    OutputIterator copy_if(const execution::sequenced_policy&, const iterator_range<Iterator, Sentinel>& _range,
+                           OutputIterator _out, Predicate _pred) {
+        return IteratorBasedForImpl::copy_if(_range, std::move(_out), std::move(_pred));
+    }
+
+    /**
+     * @brief Copies the elements of _range that satisfy _pred to _out, in order, and returns the end of the output.
+     *        Ranges whose size is known in constant time are counted and then copied in parallel blocks if _out is a
+     *        random access iterator, every block with the SIMD compaction of copy_if(_range, _out, _pred), so _pred
+     *        is called twice for every element and must be safe to call concurrently.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename OutputIterator, typename Predicate,
+              typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    OutputIterator copy_if(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                           OutputIterator _out, Predicate _pred) {
+        return copy_if_impl(_policy, _range, std::move(_out), _pred, std::integral_constant<bool,
+                            is_parallel_compactable<Iterator, Sentinel>::value
+                            && is_random_access_iterator<OutputIterator>::value>());
+    }
+
+    /**
+     * @brief Like remove_if(_range, _pred) on the calling thread.
+     */
+    template <typename Iterator, typename Sentinel, typename Predicate>
+    Iterator remove_if(const execution::sequenced_policy&, const iterator_range<Iterator, Sentinel>& _range,
+                       Predicate _pred) {
+        return IteratorBasedForImpl::remove_if(_range, std::move(_pred));
+    }
+
+    /**
+     * @brief Moves the elements of _range that do not satisfy _pred to its front, in order, and returns the end of
+     *        those elements. Ranges whose size is known in constant time are divided into blocks that are compacted
+     *        in place in parallel, after which the kept elements of every block are moved down behind those of the
+     *        previous one on the calling thread, which costs little when most elements are removed. _pred must be
+     *        safe to call concurrently.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename Predicate,
+              typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    Iterator remove_if(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Predicate _pred) {
+        static_assert(is_parallel_compactable<Iterator, Sentinel>::value,
+                      "remove_if requires a random access range whose size is known in constant time");
+
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+
+        thread_pool& pool = _policy.pool();
+        const std::size_t n = _range.size();
+        const std::size_t blocks = compact_blocks(pool, n);
+        const Iterator first = _range.begin();
+
+        if (blocks < 2) {
+            return IteratorBasedForImpl::remove_if(_range, std::ref(_pred));
+        }
+
+        auto at = [&first, n, blocks](std::size_t _block) {
+            return first + static_cast<difference_type>(block_bound(n, blocks, _block));
+        };
+
+        std::vector<Iterator> ends(blocks);
+
+        pool.run_chunks(blocks, [&](std::size_t _block) {
+            ends[_block] = IteratorBasedForImpl::remove_if(make_iterator_range(at(_block), at(_block + 1)),
+                                                           std::ref(_pred));
+        });
+
+        Iterator out = ends[0];
+
+        for (std::size_t block = 1; block < blocks; ++block) {
+            out = std::move(at(block), ends[block], out);
+        }
+
+        return out;
+    }
+
+    /**
+     * @brief Reorders _range so that the elements satisfying _pred precede the others and returns the end of the
+     *        former, like std::partition on the calling thread.
+     */
+    template <typename Iterator, typename Sentinel, typename Predicate>
+    Iterator partition(const execution::sequenced_policy&, const iterator_range<Iterator, Sentinel>& _range,
+                       Predicate _pred) {
+        static_assert(is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "partition requires a random access range whose size is known in constant time");
+
+        return std::partition(_range.begin(), _range.begin() + static_cast<std::ptrdiff_t>(_range.size()),
+                              std::ref(_pred));
+    }
+
+    template <typename Iterator, typename Predicate>
+    Iterator partition_impl(thread_pool& _pool, Iterator _first, std::size_t _n, Predicate& _pred, std::true_type) {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        const std::size_t blocks = sort_blocks(&_pool, _n);
+
+        if (blocks < 2) {
+            return partition_impl(_pool, _first, _n, _pred, std::false_type());
+        }
+
+        std::unique_ptr<value_type[]> buffer(new value_type[_n]);
+        std::size_t sizes[2];
+
+        auto part = [&_pred](const value_type& _value) -> std::size_t { return _pred(_value) ? 0 : 1; };
+
+        if (distribute(&_pool, blocks, _first, buffer.get(), _n, 2, part, sizes)) {
+            move_blocks(&_pool, blocks, buffer.get(), _first, _n);
+        }
+
+        return _first + static_cast<typename std::iterator_traits<Iterator>::difference_type>(sizes[0]);
+    }
+
+    template <typename Iterator, typename Predicate>
+    Iterator partition_impl(thread_pool&, Iterator _first, std::size_t _n, Predicate& _pred, std::false_type) {
+        return std::stable_partition(_first, _first + static_cast<std::ptrdiff_t>(_n), std::ref(_pred));
+    }
+
+    /**
+     * @brief Like partition(seq, _range, _pred), keeping the elements of both parts in their original order. Large
+     *        ranges are divided into a block per thread whose elements satisfying _pred are counted in parallel, the
+     *        counts give every block the positions its elements of both parts go to, and the blocks are moved to
+     *        those positions in a buffer and back in parallel. _pred must be safe to call concurrently.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename Predicate,
+              typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    Iterator partition(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Predicate _pred) {
+        static_assert(is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "partition requires a random access range whose size is known in constant time");
+
+        return partition_impl(_policy.pool(), _range.begin(), _range.size(), _pred,
+                              typename is_parallel_sortable<Iterator>::type());
+    }
+
+    /**
+     * @brief Minimum number of elements per block of a parallel histogram(), below which counting a block on its own
+     *        thread does not pay for merging its table.
+     */
+    constexpr std::size_t histogram_min_block = 1u << 16;
+
+    /**
+     * @brief Like histogram(_range, _bins, _key) on the calling thread.
+     */
+    template <typename Iterator, typename Sentinel, typename KeyFn = element_key>
+    std::vector<std::size_t> histogram(const execution::sequenced_policy&,
+                                       const iterator_range<Iterator, Sentinel>& _range, std::size_t _bins,
+                                       KeyFn _key = KeyFn()) {
+        return IteratorBasedForImpl::histogram(_range, _bins, std::move(_key));
+    }
+
+    /**
+     * @brief Like histogram(_range, _bins, _key), counting ranges whose size is known in constant time in a block per
+     *        thread, each into its own table. The tables are then added up in parallel, every thread summing a slice
+     *        of the bins. _key must be safe to call concurrently.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename KeyFn = element_key,
+              typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    std::vector<std::size_t> histogram(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                                       std::size_t _bins, KeyFn _key = KeyFn()) {
+        static_assert(is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "histogram requires a random access range whose size is known in constant time");
+
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+
+        thread_pool& pool = _policy.pool();
+        const std::size_t n = _range.size();
+        const std::size_t blocks = std::max<std::size_t>(1, std::min(pool.concurrency(), n / histogram_min_block));
+
+        if (blocks < 2) {
+            return IteratorBasedForImpl::histogram(_range, _bins, std::move(_key));
+        }
+
+        const Iterator first = _range.begin();
+        auto at = [&first, n, blocks](std::size_t _block) {
+            return first + static_cast<difference_type>(block_bound(n, blocks, _block));
+        };
+
+        std::vector<std::vector<std::size_t>> tables(blocks);
+
+        pool.run_chunks(blocks, [&](std::size_t _block) {
+            tables[_block].resize(_bins);
+            histogram_into(make_iterator_range(at(_block), at(_block + 1)), _bins, _key, tables[_block].data());
+        });
+
+        pool.run_chunks(blocks, [&](std::size_t _slice) {
+            const std::size_t first_bin = block_bound(_bins, blocks, _slice);
+            const std::size_t last_bin = block_bound(_bins, blocks, _slice + 1);
+
+            for (std::size_t block = 1; block < blocks; ++block) {
+                for (std::size_t bin = first_bin; bin < last_bin; ++bin) {
+                    tables[0][bin] += tables[block][bin];
+                }
+            }
+        });
+
+        return std::move(tables[0]);
+    }
+
+    /**
+     * @brief Minimum number of keys per block of a parallel sketch, below which building a block's sketch on its own
+     *        thread does not pay for merging it.
+     */
+    constexpr std::size_t sketch_min_block = 1u << 16;
+
+    template <typename Iterator, typename Sentinel, typename Sketch>
+    Sketch build_sketch(const execution::sequenced_policy&, const iterator_range<Iterator, Sentinel>& _range,
+                        Sketch _sketch) {
+        sketch_into(_range, _sketch);
+        return _sketch;
+    }
+
+    /**
+     * @brief Builds a sketch like _empty of every block of _range on its own thread and merges them.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename Sketch,
+              typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    Sketch build_sketch(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, Sketch _empty) {
+        static_assert(is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "parallel sketches require a random access range whose size is known in constant time");
+
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+
+        thread_pool& pool = _policy.pool();
+        const std::size_t n = _range.size();
+        const std::size_t blocks = std::max<std::size_t>(1, std::min(pool.concurrency(), n / sketch_min_block));
+
+        if (blocks < 2) {
+            sketch_into(_range, _empty);
+            return _empty;
+        }
+
+        const Iterator first = _range.begin();
+        auto at = [&first, n, blocks](std::size_t _block) {
+            return first + static_cast<difference_type>(block_bound(n, blocks, _block));
+        };
+
+        std::vector<Sketch> sketches(blocks, _empty);
+
+        pool.run_chunks(blocks, [&](std::size_t _block) {
+            sketch_into(make_iterator_range(at(_block), at(_block + 1)), sketches[_block]);
+        });
+
+        for (std::size_t block = 1; block < blocks; ++block) {
+            sketches[0].merge(sketches[block]);
+        }
+
+        return std::move(sketches[0]);
+    }
+
+    /**
+     * @brief Like build_bloom(_range, _bits, _hashes). With a parallel policy, every thread builds a filter of a block
+     *        of _range, which must know its size in constant time, and the filters are merged.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    bloom_filter build_bloom(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range, std::size_t _bits,
+                             unsigned _hashes) {
+        return build_sketch(_policy, _range, bloom_filter(_bits, _hashes));
+    }
+
+    /**
+     * @brief Like hyperloglog(_range, _precision), built as build_bloom() with a policy is.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    hyperloglog_sketch hyperloglog(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                                   unsigned _precision = 14) {
+        return build_sketch(_policy, _range, hyperloglog_sketch(_precision));
+    }
+
+    /**
+     * @brief Like count_min(_range, _width, _depth), built as build_bloom() with a policy is.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel,
+              typename std::enable_if<is_execution_policy<Policy>::value, int>::type = 0>
+    count_min_sketch count_min(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                               std::size_t _width = 2048, unsigned _depth = 4) {
+        return build_sketch(_policy, _range, count_min_sketch(_width, _depth));
+    }
+
+    /**
+     * @brief Minimum number of elements per block of a parallel generate_random(), below which filling a block on its
+     *        own thread does not pay for starting it.
+     */
+    constexpr std::size_t random_min_block = 1u << 16;
+
+    /**
+     * @brief Like generate_random(_range, _distribution, _seed) on the calling thread.
+     */
+    template <typename Iterator, typename Sentinel, typename Distribution>
+    void generate_random(const execution::sequenced_policy&, const iterator_range<Iterator, Sentinel>& _range,
+                         const Distribution& _distribution, std::uint64_t _seed) {
+        IteratorBasedForImpl::generate_random(_range, _distribution, _seed);
+    }
+
+    /**
+     * @brief Like generate_random(_range, _distribution, _seed), filling a block of _range per thread. Since every
+     *        element depends on its index only, the result is the same for any number of threads.
+     */
+    template <typename Policy, typename Iterator, typename Sentinel, typename Distribution,
+              typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    void generate_random(const Policy& _policy, const iterator_range<Iterator, Sentinel>& _range,
+                         const Distribution& _distribution, std::uint64_t _seed) {
+        static_assert(is_contiguous_iterator<Iterator>::value && is_sized_sentinel_for<Sentinel, Iterator>::value,
+                      "generate_random requires a contiguous range whose size is known in constant time");
+
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+
+        thread_pool& pool = _policy.pool();
+        const std::size_t n = _range.size();
+        const std::size_t blocks = std::max<std::size_t>(1, std::min(pool.concurrency(), n / random_min_block));
+
+        if (blocks < 2) {
+            IteratorBasedForImpl::generate_random(_range, _distribution, _seed);
+            return;
+        }
+
+        //Blocks start at multiples of random_alignment, as generate_random_at() requires.
+        const Iterator first = _range.begin();
+        auto bound = [n, blocks](std::size_t _block) {
+            return _block == blocks ? n : block_bound(n, blocks, _block) / random_alignment * random_alignment;
+        };
+
+        pool.run_chunks(blocks, [&](std::size_t _block) {
+            generate_random_at(make_iterator_range(first + static_cast<difference_type>(bound(_block)),
+                                                   first + static_cast<difference_type>(bound(_block + 1))),
+                               _distribution, _seed, bound(_block));
+        });
+    }
+
+} // namespace IteratorBasedForImpl
+
+#endif // IteratorBasedForParallel_H
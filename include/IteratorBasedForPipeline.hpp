@@ -0,0 +1,493 @@
+#ifndef IteratorBasedForPipeline_H
+#define IteratorBasedForPipeline_H
+
+#include <IteratorBasedForParallel.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace IteratorBasedForImpl
+{
+
+    /**
+     * @brief Default number of elements moved between the stages of a pipeline at once.
+     */
+    constexpr std::size_t pipeline_batch_size = 256;
+
+    /**
+     * @brief Default number of batches a queue between two stages of a pipeline holds before the producing stage
+     *        waits for the consuming one.
+     */
+    constexpr std::size_t pipeline_queue_batches = 8;
+
+    /**
+     * @brief Consecutive elements of the source of a pipeline, in the form one stage has produced them. The sequence
+     *        number is the position of the batch in the source, which restores the order after a parallel stage.
+     */
+    template <typename T>
+    struct pipeline_batch {
+        std::size_t sequence;
+        std::vector<T> values;
+
+        pipeline_batch() : sequence(0), values() { }
+    };
+
+    /**
+     * @brief Waits between two attempts to push to or pop from a pipeline channel: spins briefly and then yields,
+     *        since the other side usually catches up within a batch.
+     */
+    inline void pipeline_back_off(std::size_t& _attempts) {
+        if (++_attempts > 16) {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Bounded queue of batches between two stages of a pipeline. A push waits while the queue is full, which
+     *        holds back the producing stage, and a pop waits while it is empty, until every producing thread has
+     *        closed the channel. Both give up once the run has failed.
+     */
+    template <typename T>
+    class pipeline_channel {
+    private:
+        bounded_queue<pipeline_batch<T>> m_queue;
+        std::atomic<std::size_t> m_producers;
+        const std::atomic<bool>& m_failed;
+
+    public:
+        pipeline_channel(std::size_t _capacity, std::size_t _producers, const std::atomic<bool>& _failed) :
+                m_queue(_capacity), m_producers(_producers), m_failed(_failed) {
+        }
+
+        /**
+         * @brief Moves _batch into the queue, or returns false if the run failed before there was room.
+         */
+        bool push(pipeline_batch<T>& _batch) {
+            for (std::size_t attempts = 0; !m_queue.try_push(_batch); pipeline_back_off(attempts)) {
+                if (m_failed.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Moves the next batch into _batch, or returns false if the producers are done or the run failed.
+         */
+        bool pop(pipeline_batch<T>& _batch) {
+            for (std::size_t attempts = 0; !m_queue.try_pop(_batch); pipeline_back_off(attempts)) {
+                if (m_failed.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+
+                //Batches pushed before the last close are visible once the close is.
+                if (m_producers.load(std::memory_order_acquire) == 0) {
+                    return m_queue.try_pop(_batch);
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Called by each producing thread after its last push.
+         */
+        void close() { m_producers.fetch_sub(1, std::memory_order_release); }
+    };
+
+    /**
+     * @brief The threads and channels of one execution of a pipeline, and the first exception thrown by a stage.
+     *        After a failure every stage stops at its next push or pop.
+     *
+     *        The source may only start a batch that lies less than a window of batches ahead of the sink, the number
+     *        the queues and threads of the pipeline hold at once. Batches then never wait for an earlier one that has
+     *        not been read yet, so the batches held back for reordering are bounded too.
+     */
+    class pipeline_run {
+    private:
+        std::vector<std::shared_ptr<void>> m_channels;
+        std::vector<std::thread> m_threads;
+        std::atomic<bool> m_failed;
+        std::mutex m_mutex;
+        std::exception_ptr m_error;
+        std::size_t m_capacity;
+        std::size_t m_window;
+        std::atomic<std::size_t> m_delivered;
+
+    public:
+        pipeline_run(std::size_t _capacity, std::size_t _window) :
+                m_channels(),
+                m_threads(),
+                m_failed(false),
+                m_mutex(),
+                m_error(),
+                m_capacity(_capacity),
+                m_window(_window),
+                m_delivered(0) {
+        }
+
+        pipeline_run(const pipeline_run&) = delete;
+        pipeline_run& operator=(const pipeline_run&) = delete;
+
+        ~pipeline_run() {
+            if (!m_threads.empty()) {
+                m_failed.store(true);
+                join();
+            }
+        }
+
+        /**
+         * @brief Records the exception being handled, unless an earlier one was, and stops the run.
+         */
+        void fail() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (!m_failed.exchange(true)) {
+                m_error = std::current_exception();
+            }
+        }
+
+        /**
+         * @brief Waits until the batch _sequence may enter the pipeline. Returns false if the run failed first.
+         */
+        bool admit(std::size_t _sequence) {
+            for (std::size_t attempts = 0; _sequence >= m_delivered.load(std::memory_order_acquire) + m_window;
+                 pipeline_back_off(attempts)) {
+                if (m_failed.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Called by the sink after each batch.
+         */
+        void delivered() { m_delivered.fetch_add(1, std::memory_order_release); }
+
+        /**
+         * @brief Creates a channel fed by _producers threads, which lives as long as the run.
+         */
+        template <typename T>
+        pipeline_channel<T>& make_channel(std::size_t _producers) {
+            auto channel = std::make_shared<pipeline_channel<T>>(m_capacity, _producers, m_failed);
+            m_channels.push_back(channel);
+            return *channel;
+        }
+
+        /**
+         * @brief Runs _f on a new thread of the run. An exception thrown by _f fails the run.
+         */
+        template <typename F>
+        void spawn(F _f) {
+            m_threads.emplace_back([this, _f]() mutable {
+                try {
+                    _f();
+                } catch (...) {
+                    fail();
+                }
+            });
+        }
+
+        void join() {
+            for (std::thread& thread : m_threads) {
+                thread.join();
+            }
+
+            m_threads.clear();
+        }
+
+        /**
+         * @brief Rethrows the exception that failed the run, if any.
+         */
+        void rethrow() const {
+            if (m_error) {
+                std::rethrow_exception(m_error);
+            }
+        }
+    };
+
+    /**
+     * @brief Passes the batches received by a serial consumer to _f in the order of their sequence numbers, holding
+     *        back those that overtook an earlier one in a parallel stage.
+     */
+    template <typename T>
+    class pipeline_reorder {
+    private:
+        std::map<std::size_t, pipeline_batch<T>> m_pending;
+        std::size_t m_next;
+
+    public:
+        pipeline_reorder() : m_pending(), m_next(0) { }
+
+        template <typename F>
+        void accept(pipeline_batch<T>& _batch, F& _f) {
+            if (_batch.sequence != m_next) {
+                const std::size_t sequence = _batch.sequence;
+                m_pending.emplace(sequence, std::move(_batch));
+                return;
+            }
+
+            _f(_batch);
+            ++m_next;
+
+            for (auto it = m_pending.find(m_next); it != m_pending.end(); it = m_pending.find(m_next)) {
+                _f(it->second);
+                m_pending.erase(it);
+                ++m_next;
+            }
+        }
+    };
+
+    /**
+     * @brief Base of the stages of a pipeline under construction, which operator| accepts on its left.
+     */
+    struct pipeline_node {
+    };
+
+    /**
+     * @brief First stage of a pipeline, which reads a range on its own thread and cuts it into batches.
+     */
+    template <typename Iterator, typename Sentinel>
+    class pipeline_source : public pipeline_node {
+    public:
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+    private:
+        iterator_range<Iterator, Sentinel> m_range;
+        std::size_t m_batch_size;
+        std::size_t m_capacity;
+
+    public:
+        pipeline_source(const iterator_range<Iterator, Sentinel>& _range, std::size_t _batch_size,
+                        std::size_t _capacity) :
+                m_range(_range), m_batch_size(_batch_size ? _batch_size : 1), m_capacity(_capacity) {
+        }
+
+        std::size_t threads() const { return 1; }
+        std::size_t capacity() const { return m_capacity; }
+
+        /**
+         * @brief Returns the number of batches this part of the pipeline holds at most.
+         */
+        std::size_t in_flight() const { return 1; }
+
+        void launch(pipeline_run& _run, pipeline_channel<value_type>& _out) {
+            _run.spawn([this, &_run, &_out]() {
+                Iterator it = m_range.begin();
+                const Sentinel end = m_range.end();
+                pipeline_batch<value_type> batch;
+                bool open = true;
+
+                for (std::size_t sequence = 0; open && it != end && _run.admit(sequence); ++sequence) {
+                    batch.sequence = sequence;
+                    batch.values.clear();
+                    batch.values.reserve(m_batch_size);
+
+                    for (; batch.values.size() < m_batch_size && it != end; ++it) {
+                        batch.values.push_back(*it);
+                    }
+
+                    open = _out.push(batch);
+                }
+
+                _out.close();
+            });
+        }
+    };
+
+    /**
+     * @brief Stage of a pipeline applying a function to every element produced by Upstream, on one thread, which
+     *        sees the elements in their order in the source, or on several threads, which process different batches
+     *        at the same time and call the function concurrently.
+     */
+    template <typename Upstream, typename F>
+    class pipeline_stage : public pipeline_node {
+    public:
+        using input_type = typename Upstream::value_type;
+        using value_type = typename std::decay<decltype(std::declval<F&>()(std::declval<input_type&&>()))>::type;
+
+    private:
+        Upstream m_upstream;
+        F m_function;
+        std::size_t m_threads;
+
+        void apply(pipeline_batch<input_type>& _in, pipeline_batch<value_type>& _out) {
+            trace_scope trace(trace_task::pipeline_batch, _in.values.size());
+            _out.sequence = _in.sequence;
+            _out.values.clear();
+            _out.values.reserve(_in.values.size());
+
+            for (input_type& value : _in.values) {
+                _out.values.push_back(m_function(std::move(value)));
+            }
+        }
+
+    public:
+        pipeline_stage(Upstream _upstream, F _function, std::size_t _threads) :
+                m_upstream(std::move(_upstream)), m_function(std::move(_function)), m_threads(_threads) {
+        }
+
+        std::size_t threads() const { return m_threads; }
+        std::size_t capacity() const { return m_upstream.capacity(); }
+        std::size_t in_flight() const { return m_upstream.in_flight() + capacity() + m_threads; }
+
+        void launch(pipeline_run& _run, pipeline_channel<value_type>& _out) {
+            pipeline_channel<input_type>& in = _run.make_channel<input_type>(m_upstream.threads());
+            m_upstream.launch(_run, in);
+
+            if (m_threads == 1) {
+                _run.spawn([this, &in, &_out]() {
+                    pipeline_reorder<input_type> order;
+                    pipeline_batch<input_type> batch;
+                    pipeline_batch<value_type> result;
+                    bool open = true;
+
+                    auto process = [this, &result, &open, &_out](pipeline_batch<input_type>& _next) {
+                        apply(_next, result);
+                        open = open && _out.push(result);
+                    };
+
+                    while (open && in.pop(batch)) {
+                        order.accept(batch, process);
+                    }
+
+                    _out.close();
+                });
+
+                return;
+            }
+
+            for (std::size_t i = 0; i < m_threads; ++i) {
+                _run.spawn([this, &in, &_out]() {
+                    pipeline_batch<input_type> batch;
+                    pipeline_batch<value_type> result;
+
+                    while (in.pop(batch)) {
+                        apply(batch, result);
+
+                        if (!_out.push(result)) {
+                            break;
+                        }
+                    }
+
+                    _out.close();
+                });
+            }
+        }
+    };
+
+    template <typename F>
+    struct pipeline_stage_spec {
+        F function;
+        std::size_t threads;
+    };
+
+    template <typename H>
+    struct pipeline_sink_spec {
+        H function;
+    };
+
+    /**
+     * @brief Returns a pipeline reading _range, to be continued with stages and ended with a sink:
+     *
+     *        pipeline((lines.begin(), lines.end()))
+     *                | stage(parse)
+     *                | stage(enrich, execution::par)
+     *                | sink([&out](record r) { out.write(r); });
+     *
+     *        Every stage runs on threads of its own, connected to the next stage by a bounded_queue of batches of
+     *        _batch_size elements holding at most _queue_batches batches, so a slow stage holds back the ones before
+     *        it and the memory in use stays bounded whatever the size of the range. The sink runs on the calling
+     *        thread, which returns once the whole range has passed through the pipeline.
+     */
+    template <typename Iterator, typename Sentinel>
+    pipeline_source<Iterator, Sentinel> pipeline(const iterator_range<Iterator, Sentinel>& _range,
+                                                 std::size_t _batch_size = pipeline_batch_size,
+                                                 std::size_t _queue_batches = pipeline_queue_batches) {
+        return pipeline_source<Iterator, Sentinel>(_range, _batch_size, _queue_batches);
+    }
+
+    /**
+     * @brief A pipeline stage calling _function on one thread in the order of the source.
+     */
+    template <typename F>
+    pipeline_stage_spec<F> stage(F _function, execution::sequenced_policy = execution::seq) {
+        return pipeline_stage_spec<F>{std::move(_function), 1};
+    }
+
+    /**
+     * @brief A pipeline stage calling _function concurrently on _threads threads, by default as many as the pool of
+     *        _policy has. The threads are dedicated to the stage rather than taken from the pool, since a stage
+     *        waits for the stages around it. The order of the source is restored by the next serial stage or sink.
+     */
+    template <typename F, typename Policy, typename std::enable_if<is_parallel_policy<Policy>::value, int>::type = 0>
+    pipeline_stage_spec<F> stage(F _function, const Policy& _policy, std::size_t _threads = 0) {
+        return pipeline_stage_spec<F>{std::move(_function), _threads ? _threads : _policy.pool().concurrency()};
+    }
+
+    /**
+     * @brief The end of a pipeline, calling _function on the calling thread with every element in the order of the
+     *        source.
+     */
+    template <typename H>
+    pipeline_sink_spec<H> sink(H _function) {
+        return pipeline_sink_spec<H>{std::move(_function)};
+    }
+
+    template <typename Upstream, typename F,
+              typename std::enable_if<std::is_base_of<pipeline_node, Upstream>::value, int>::type = 0>
+    pipeline_stage<Upstream, F> operator|(Upstream _upstream, pipeline_stage_spec<F> _stage) {
+        return pipeline_stage<Upstream, F>(std::move(_upstream), std::move(_stage.function), _stage.threads);
+    }
+
+    /**
+     * @brief Runs the pipeline _upstream into _sink and returns when every element has reached the sink. If a stage
+     *        or the sink throws, the pipeline stops and the first exception is rethrown.
+     */
+    template <typename Upstream, typename H,
+              typename std::enable_if<std::is_base_of<pipeline_node, Upstream>::value, int>::type = 0>
+    void operator|(Upstream _upstream, pipeline_sink_spec<H> _sink) {
+        using value_type = typename Upstream::value_type;
+
+        pipeline_run run(_upstream.capacity(), _upstream.in_flight() + _upstream.capacity());
+        pipeline_channel<value_type>& in = run.make_channel<value_type>(_upstream.threads());
+        _upstream.launch(run, in);
+
+        try {
+            pipeline_reorder<value_type> order;
+            pipeline_batch<value_type> batch;
+
+            auto consume = [&_sink, &run](pipeline_batch<value_type>& _next) {
+                for (value_type& value : _next.values) {
+                    _sink.function(std::move(value));
+                }
+
+                run.delivered();
+            };
+
+            while (in.pop(batch)) {
+                order.accept(batch, consume);
+            }
+        } catch (...) {
+            run.fail();
+        }
+
+        run.join();
+        run.rethrow();
+    }
+
+} // namespace IteratorBasedForImpl
+
+#endif // IteratorBasedForPipeline_H
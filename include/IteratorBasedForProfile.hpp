@@ -0,0 +1,429 @@
+//Included ahead of the guard: in profiling builds IteratorBasedFor.hpp includes this header at its end, which has to
+//see the complete core header whichever of the two is included first.
+#include <IteratorBasedFor.hpp>
+
+#ifndef IteratorBasedForProfile_H
+#define IteratorBasedForProfile_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace IteratorBasedForImpl
+{
+
+    /**
+     * @brief Number of buckets of a loop latency histogram. Bucket b counts loops that took from 2^b up to 2^(b+1)
+     *        nanoseconds, bucket 0 also the shorter ones and the last bucket also the longer ones.
+     */
+    constexpr std::size_t loop_histogram_buckets = 40;
+
+    /**
+     * @brief Number of distinct loops every thread records. Loops beyond that are counted in dropped_loop_samples().
+     */
+    constexpr std::size_t loop_profile_sites = 256;
+
+    /**
+     * @brief Number of size classes algorithms sort ranges into before running them, see size_class in
+     *        IteratorBasedForAlgorithm.hpp. Every thread counts how many ranges it dispatched in each.
+     */
+    constexpr std::size_t loop_size_classes = 3;
+
+    /**
+     * @brief Histogram of one loop on one thread. Only the owning thread writes it, with plain relaxed loads and
+     *        stores, so recording involves no locked instructions and exporting reads a consistent enough picture.
+     */
+    struct loop_site_record {
+        std::atomic<const void*> site;
+        std::atomic<std::uint64_t> calls;
+        std::atomic<std::uint64_t> sized_calls;
+        std::atomic<std::uint64_t> trips;
+        std::atomic<std::uint64_t> nanoseconds;
+        std::array<std::atomic<std::uint64_t>, loop_histogram_buckets> buckets;
+
+        loop_site_record() : site(nullptr), calls(0), sized_calls(0), trips(0), nanoseconds(0), buckets() {
+            for (std::atomic<std::uint64_t>& bucket : buckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    inline void add_relaxed(std::atomic<std::uint64_t>& _counter, std::uint64_t _value) {
+        _counter.store(_counter.load(std::memory_order_relaxed) + _value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the histogram bucket of a loop that took _nanoseconds.
+     */
+    inline std::size_t loop_histogram_bucket(std::uint64_t _nanoseconds) {
+        std::size_t bucket = 0;
+
+        while (_nanoseconds > 1 && bucket + 1 < loop_histogram_buckets) {
+            _nanoseconds >>= 1;
+            ++bucket;
+        }
+
+        return bucket;
+    }
+
+    /**
+     * @brief The loop histograms of one thread, an open addressing table keyed by the address of the loop.
+     */
+    class loop_profile_table {
+    private:
+        std::array<loop_site_record, loop_profile_sites> m_records;
+        std::atomic<std::uint64_t> m_dropped;
+        std::array<std::atomic<std::uint64_t>, loop_size_classes> m_size_classes;
+
+    public:
+        loop_profile_table() : m_records(), m_dropped(0), m_size_classes() {
+            for (std::atomic<std::uint64_t>& count : m_size_classes) {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        void record(const void* _site, std::uint64_t _nanoseconds, bool _sized, std::uint64_t _trips) {
+            const std::size_t hash = std::hash<const void*>()(_site);
+
+            for (std::size_t i = 0; i < loop_profile_sites; ++i) {
+                loop_site_record& record = m_records[(hash + i) % loop_profile_sites];
+                const void* site = record.site.load(std::memory_order_relaxed);
+
+                if (site == nullptr) {
+                    record.site.store(_site, std::memory_order_release);
+                } else if (site != _site) {
+                    continue;
+                }
+
+                add_relaxed(record.calls, 1);
+                add_relaxed(record.nanoseconds, _nanoseconds);
+                add_relaxed(record.buckets[loop_histogram_bucket(_nanoseconds)], 1);
+
+                if (_sized) {
+                    add_relaxed(record.sized_calls, 1);
+                    add_relaxed(record.trips, _trips);
+                }
+
+                return;
+            }
+
+            add_relaxed(m_dropped, 1);
+        }
+
+        void record_size_class(std::size_t _class) {
+            add_relaxed(m_size_classes[_class], 1);
+        }
+
+        const std::array<loop_site_record, loop_profile_sites>& records() const { return m_records; }
+
+        std::uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+        std::uint64_t size_class_calls(std::size_t _class) const {
+            return m_size_classes[_class].load(std::memory_order_relaxed);
+        }
+
+        void clear() {
+            for (loop_site_record& record : m_records) {
+                record.calls.store(0, std::memory_order_relaxed);
+                record.sized_calls.store(0, std::memory_order_relaxed);
+                record.trips.store(0, std::memory_order_relaxed);
+                record.nanoseconds.store(0, std::memory_order_relaxed);
+
+                for (std::atomic<std::uint64_t>& bucket : record.buckets) {
+                    bucket.store(0, std::memory_order_relaxed);
+                }
+            }
+
+            m_dropped.store(0, std::memory_order_relaxed);
+
+            for (std::atomic<std::uint64_t>& count : m_size_classes) {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    /**
+     * @brief The tables of all threads that have recorded a loop. Tables outlive their threads so that the loops of
+     *        finished threads are still exported.
+     */
+    struct loop_profile_registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<loop_profile_table>> tables;
+
+        loop_profile_registry() : mutex(), tables() { }
+    };
+
+    inline loop_profile_registry& global_loop_profile_registry() {
+        static loop_profile_registry registry;
+        return registry;
+    }
+
+    /**
+     * @brief Returns the table of the calling thread, registering it on first use.
+     */
+    inline loop_profile_table& this_thread_loop_profile() {
+        static thread_local loop_profile_table* table = []() {
+            loop_profile_registry& registry = global_loop_profile_registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+
+            registry.tables.emplace_back(new loop_profile_table());
+            return registry.tables.back().get();
+        }();
+
+        return *table;
+    }
+
+    /**
+     * @brief Measures one loop: from its construction to its destruction, which for a range-based for statement over
+     *        a temporary range is the whole loop. Copies are not armed, so a range that is passed on is recorded once.
+     */
+    class loop_probe {
+    private:
+        using clock = std::chrono::steady_clock;
+
+        const void* m_site;
+        std::uint64_t m_trips;
+        bool m_sized;
+        bool m_armed;
+        clock::time_point m_start;
+
+    public:
+        loop_probe(const void* _site, bool _sized, std::uint64_t _trips) :
+                m_site(_site), m_trips(_trips), m_sized(_sized), m_armed(true), m_start(clock::now()) {
+        }
+
+        loop_probe(const loop_probe& _other) noexcept :
+                m_site(_other.m_site), m_trips(_other.m_trips), m_sized(_other.m_sized), m_armed(false),
+                m_start(_other.m_start) {
+        }
+
+        loop_probe(loop_probe&& _other) noexcept :
+                m_site(_other.m_site), m_trips(_other.m_trips), m_sized(_other.m_sized), m_armed(_other.m_armed),
+                m_start(_other.m_start) {
+            _other.m_armed = false;
+        }
+
+        loop_probe& operator=(const loop_probe&) = delete;
+
+        ~loop_probe() {
+            if (m_armed) {
+                const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - m_start);
+                this_thread_loop_profile().record(m_site, static_cast<std::uint64_t>(std::max<std::int64_t>(
+                        0, static_cast<std::int64_t>(elapsed.count()))), m_sized, m_trips);
+            }
+        }
+    };
+
+    inline loop_probe make_loop_probe(const void* _site, std::false_type, std::size_t) {
+        return loop_probe(_site, false, 0);
+    }
+
+    inline loop_probe make_loop_probe(const void* _site, std::true_type, std::size_t _size) {
+        return loop_probe(_site, true, _size);
+    }
+
+    template <typename Iterator, typename Sentinel>
+    std::size_t loop_trip_count(const iterator_range<Iterator, Sentinel>& _range, std::true_type) {
+        return _range.size();
+    }
+
+    template <typename Iterator, typename Sentinel>
+    std::size_t loop_trip_count(const iterator_range<Iterator, Sentinel>&, std::false_type) {
+        return 0;
+    }
+
+    /**
+     * @brief An iterator_range that records the time from its construction to its destruction as one call of the loop
+     *        at _site, together with its size if that is known in constant time. In profiling builds the comma
+     *        operator returns these; it converts to the plain iterator_range, which is how it is passed on.
+     */
+    template <typename Iterator, typename Sentinel>
+    class profiled_iterator_range : public iterator_range<Iterator, Sentinel> {
+    private:
+        loop_probe m_probe;
+
+    public:
+        profiled_iterator_range(iterator_range<Iterator, Sentinel> _range, const void* _site) :
+                iterator_range<Iterator, Sentinel>(std::move(_range)),
+                m_probe(make_loop_probe(_site, is_sized_sentinel_for<Sentinel, Iterator>(),
+                                        loop_trip_count(*this, is_sized_sentinel_for<Sentinel, Iterator>()))) {
+        }
+    };
+
+    /**
+     * @brief Returns _range wrapped so that the loop iterating it is recorded in loop_profile(), in any build. Loops
+     *        are told apart by the address profiled() returns to.
+     */
+    template <typename Iterator, typename Sentinel>
+    ITERATOR_BASED_FOR_NOINLINE profiled_iterator_range<Iterator, Sentinel> profiled(
+            iterator_range<Iterator, Sentinel> _range) {
+        return profiled_iterator_range<Iterator, Sentinel>(std::move(_range), ITERATOR_BASED_FOR_RETURN_ADDRESS());
+    }
+
+    /**
+     * @brief Latency distribution of one loop, merged over all threads.
+     */
+    struct loop_statistics {
+        //Address inside the function containing the loop, which a symbolizer such as addr2line turns into a source
+        //location.
+        const void* site;
+        std::uint64_t calls;
+        //Number of calls over ranges whose size is known, and the total number of elements of those ranges.
+        std::uint64_t sized_calls;
+        std::uint64_t trips;
+        std::uint64_t nanoseconds;
+        std::array<std::uint64_t, loop_histogram_buckets> buckets;
+
+        /**
+         * @brief Returns an upper bound on the duration of the loops in nanoseconds below which a share _q of them
+         *        lies, the upper end of the histogram bucket reaching that share.
+         */
+        std::uint64_t percentile(double _q) const {
+            const double wanted = _q * static_cast<double>(calls);
+            std::uint64_t seen = 0;
+
+            for (std::size_t b = 0; b < loop_histogram_buckets; ++b) {
+                seen += buckets[b];
+
+                if (static_cast<double>(seen) >= wanted && seen != 0) {
+                    return std::uint64_t(1) << (b + 1);
+                }
+            }
+
+            return std::uint64_t(1) << loop_histogram_buckets;
+        }
+    };
+
+    /**
+     * @brief Returns the statistics of every loop recorded so far, merged over all threads and sorted by the total
+     *        time spent in them, longest first. May be called while loops are running.
+     */
+    inline std::vector<loop_statistics> loop_profile() {
+        std::map<const void*, loop_statistics> merged;
+        loop_profile_registry& registry = global_loop_profile_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        for (const std::unique_ptr<loop_profile_table>& table : registry.tables) {
+            for (const loop_site_record& record : table->records()) {
+                const void* site = record.site.load(std::memory_order_acquire);
+
+                if (site == nullptr || record.calls.load(std::memory_order_relaxed) == 0) {
+                    continue;
+                }
+
+                auto inserted = merged.emplace(site, loop_statistics{site, 0, 0, 0, 0, {}});
+                loop_statistics& statistics = inserted.first->second;
+
+                statistics.calls += record.calls.load(std::memory_order_relaxed);
+                statistics.sized_calls += record.sized_calls.load(std::memory_order_relaxed);
+                statistics.trips += record.trips.load(std::memory_order_relaxed);
+                statistics.nanoseconds += record.nanoseconds.load(std::memory_order_relaxed);
+
+                for (std::size_t b = 0; b < loop_histogram_buckets; ++b) {
+                    statistics.buckets[b] += record.buckets[b].load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        //Sorts positions rather than the statistics themselves, which the swap detection of the core header would
+        //make ambiguous to swap.
+        std::vector<loop_statistics> unordered;
+        unordered.reserve(merged.size());
+
+        for (auto& entry : merged) {
+            unordered.push_back(entry.second);
+        }
+
+        std::vector<std::size_t> order(unordered.size());
+
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+
+        std::sort(order.begin(), order.end(), [&unordered](std::size_t _a, std::size_t _b) {
+            return unordered[_a].nanoseconds > unordered[_b].nanoseconds;
+        });
+
+        std::vector<loop_statistics> result;
+        result.reserve(order.size());
+
+        for (std::size_t i : order) {
+            result.push_back(unordered[i]);
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Returns the number of loops that were not recorded because their thread's table was full.
+     */
+    inline std::uint64_t dropped_loop_samples() {
+        loop_profile_registry& registry = global_loop_profile_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        std::uint64_t dropped = 0;
+
+        for (const std::unique_ptr<loop_profile_table>& table : registry.tables) {
+            dropped += table->dropped();
+        }
+
+        return dropped;
+    }
+
+    /**
+     * @brief Returns the number of ranges dispatched in each size class so far, summed over all threads.
+     */
+    inline std::array<std::uint64_t, loop_size_classes> size_class_calls() {
+        loop_profile_registry& registry = global_loop_profile_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        std::array<std::uint64_t, loop_size_classes> calls = {};
+
+        for (const std::unique_ptr<loop_profile_table>& table : registry.tables) {
+            for (std::size_t c = 0; c < loop_size_classes; ++c) {
+                calls[c] += table->size_class_calls(c);
+            }
+        }
+
+        return calls;
+    }
+
+    /**
+     * @brief Clears the statistics of all loops and the size class counts, keeping the loops known. Meant to be
+     *        called while no profiled loops finish; a loop finishing concurrently may keep part of its counts.
+     */
+    inline void reset_loop_profile() {
+        loop_profile_registry& registry = global_loop_profile_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        for (const std::unique_ptr<loop_profile_table>& table : registry.tables) {
+            table->clear();
+        }
+    }
+
+    /**
+     * @brief Writes loop_profile() to _out as tab-separated lines of site, calls, mean trip count, total, median,
+     *        99th percentile and maximum nanoseconds, preceded by a header line.
+     */
+    inline void write_loop_profile(std::ostream& _out) {
+        _out << "site\tcalls\tmean_trips\ttotal_ns\tp50_ns\tp99_ns\tmax_ns\n";
+
+        for (const loop_statistics& statistics : loop_profile()) {
+            _out << statistics.site << '\t' << statistics.calls << '\t'
+                 << (statistics.sized_calls ? statistics.trips / statistics.sized_calls : 0) << '\t'
+                 << statistics.nanoseconds << '\t' << statistics.percentile(0.5) << '\t'
+                 << statistics.percentile(0.99) << '\t' << statistics.percentile(1.0) << '\n';
+        }
+    }
+
+} // namespace IteratorBasedForImpl
+
+#endif // IteratorBasedForProfile_H
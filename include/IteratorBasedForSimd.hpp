@@ -0,0 +1,2709 @@
+#ifndef IteratorBasedForSimd_H
+#define IteratorBasedForSimd_H
+
+#include <IteratorBasedFor.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+//The vector kernels use the GCC vector extensions, which GCC 9 and Clang 10 onwards support together with
+//__builtin_convertvector. Other compilers get the scalar kernels only. Define ITERATOR_BASED_FOR_NO_SIMD to force that.
+#if !defined(ITERATOR_BASED_FOR_NO_SIMD) && \
+    ((defined(__clang__) && __clang_major__ >= 10) || (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 9))
+#define ITERATOR_BASED_FOR_HAS_SIMD 1
+#else
+#define ITERATOR_BASED_FOR_HAS_SIMD 0
+#endif
+
+#if ITERATOR_BASED_FOR_HAS_SIMD && (defined(__x86_64__) || defined(__i386__))
+#define ITERATOR_BASED_FOR_SIMD_X86 1
+#else
+#define ITERATOR_BASED_FOR_SIMD_X86 0
+#endif
+
+#if ITERATOR_BASED_FOR_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+#if ITERATOR_BASED_FOR_HAS_SIMD && (defined(__ARM_NEON) || defined(__aarch64__))
+#define ITERATOR_BASED_FOR_SIMD_NEON 1
+#else
+#define ITERATOR_BASED_FOR_SIMD_NEON 0
+#endif
+
+//Opens and closes a region whose functions, including function templates instantiated later, are compiled for the
+//given instruction set regardless of the options the translation unit is compiled with.
+#if defined(__clang__)
+#define ITERATOR_BASED_FOR_SIMD_TARGET_PUSH(target) \
+    _Pragma(target)
+#define ITERATOR_BASED_FOR_SIMD_TARGET_POP \
+    _Pragma("clang attribute pop")
+#define ITERATOR_BASED_FOR_SIMD_SSE2 "clang attribute push (__attribute__((target(\"sse2\"))), apply_to = function)"
+#define ITERATOR_BASED_FOR_SIMD_SSE42 "clang attribute push (__attribute__((target(\"sse4.2\"))), apply_to = function)"
+#define ITERATOR_BASED_FOR_SIMD_AVX2 "clang attribute push (__attribute__((target(\"avx2\"))), apply_to = function)"
+#define ITERATOR_BASED_FOR_SIMD_AVX512 \
+    "clang attribute push (__attribute__((target(\"avx512f,avx512bw\"))), apply_to = function)"
+#else
+#define ITERATOR_BASED_FOR_SIMD_TARGET_PUSH(target) \
+    _Pragma("GCC push_options") \
+    _Pragma(target)
+#define ITERATOR_BASED_FOR_SIMD_TARGET_POP \
+    _Pragma("GCC pop_options")
+#define ITERATOR_BASED_FOR_SIMD_SSE2 "GCC target(\"sse2\")"
+#define ITERATOR_BASED_FOR_SIMD_SSE42 "GCC target(\"sse4.2\")"
+#define ITERATOR_BASED_FOR_SIMD_AVX2 "GCC target(\"avx2\")"
+#define ITERATOR_BASED_FOR_SIMD_AVX512 "GCC target(\"avx512f,avx512bw\")"
+#endif
+
+namespace IteratorBasedForImpl
+{
+
+    namespace simd
+    {
+
+        /**
+         * @brief The instruction sets the kernels are compiled for. Which of them the processor supports is detected
+         *        at run time, and the widest one is used unless another is selected with select_instruction_set().
+         */
+        enum class instruction_set {
+            scalar,
+            sse2,
+            avx2,
+            avx512,
+            neon
+        };
+
+        /**
+         * @brief Returns the name of _set.
+         */
+        inline const char* name(instruction_set _set) {
+            switch (_set) {
+                case instruction_set::sse2: return "sse2";
+                case instruction_set::avx2: return "avx2";
+                case instruction_set::avx512: return "avx512";
+                case instruction_set::neon: return "neon";
+                default: return "scalar";
+            }
+        }
+
+        /**
+         * @brief Checks whether kernels for _set were compiled in and the processor executing them supports it.
+         */
+        inline bool is_supported(instruction_set _set) {
+            switch (_set) {
+                case instruction_set::scalar:
+                    return true;
+#if ITERATOR_BASED_FOR_SIMD_X86
+                case instruction_set::sse2:
+                    return __builtin_cpu_supports("sse2");
+                case instruction_set::avx2:
+                    return __builtin_cpu_supports("avx2");
+                case instruction_set::avx512:
+                    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+#if ITERATOR_BASED_FOR_SIMD_NEON
+                case instruction_set::neon:
+                    return true;
+#endif
+                default:
+                    return false;
+            }
+        }
+
+        /**
+         * @brief Returns the widest instruction set that is supported.
+         */
+        inline instruction_set best_instruction_set() {
+            const instruction_set preferred[] = {
+                instruction_set::avx512, instruction_set::avx2, instruction_set::sse2, instruction_set::neon
+            };
+
+            for (instruction_set set : preferred) {
+                if (is_supported(set)) {
+                    return set;
+                }
+            }
+
+            return instruction_set::scalar;
+        }
+
+        inline std::atomic<instruction_set>& current_instruction_set() {
+            static std::atomic<instruction_set> set(best_instruction_set());
+            return set;
+        }
+
+        /**
+         * @brief Returns the instruction set the kernels currently dispatch to.
+         */
+        inline instruction_set active_instruction_set() {
+            return current_instruction_set().load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Makes the kernels dispatch to _set, for instance to compare instruction sets in tests and benchmarks.
+         *        Returns false and leaves the selection unchanged if _set is not supported.
+         */
+        inline bool select_instruction_set(instruction_set _set) {
+            if (!is_supported(_set)) {
+                return false;
+            }
+
+            current_instruction_set().store(_set, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * @brief Checks whether T is one of the element types the kernels are provided for.
+         */
+        template <typename T>
+        struct is_element : disjunction<std::is_same<T, float>, std::is_same<T, double>,
+                                        std::is_same<T, std::int32_t>, std::is_same<T, std::uint8_t>> {
+        };
+
+        /**
+         * @brief The type sum() returns for elements of type T, wide enough for integer sums not to overflow in
+         *        practice.
+         */
+        template <typename T>
+        struct sum_type {
+            typedef T type;
+        };
+
+        template <>
+        struct sum_type<std::int32_t> {
+            typedef std::int64_t type;
+        };
+
+        template <>
+        struct sum_type<std::uint8_t> {
+            typedef std::uint64_t type;
+        };
+
+        /**
+         * @brief Checks whether F updates an element of type T in place when called with a reference to it, as
+         *        opposed to returning the transformed value.
+         */
+        template <typename T, typename F, typename = void>
+        struct is_element_update : std::false_type { };
+
+        template <typename T, typename F>
+        struct is_element_update<T, F, typename std::enable_if<std::is_void<
+                decltype(std::declval<F&>()(std::declval<T&>()))>::value>::type> : std::true_type {
+        };
+
+        /**
+         * @brief Maximum number of needles find_any() compares against in vector registers. Larger sets are looked
+         *        up in a table one byte at a time.
+         */
+        constexpr std::size_t find_any_vector_needles = 16;
+
+        /**
+         * @brief Checks whether T is one of the element types the set operation kernels are provided for.
+         */
+        template <typename T>
+        struct is_set_element : disjunction<std::is_same<T, std::uint32_t>, std::is_same<T, std::uint64_t>> { };
+
+        /**
+         * @brief Checks whether T is one of the element types prefix_sum() is provided for. Floating-point sums are
+         *        left out, since scanning them in registers would add them in a different order than a serial scan.
+         */
+        template <typename T>
+        struct is_scan_element : disjunction<std::is_same<T, std::int32_t>, std::is_same<T, std::uint32_t>,
+                                             std::is_same<T, std::int64_t>, std::is_same<T, std::uint64_t>> {
+        };
+
+        /**
+         * @brief Checks whether T is one of the element types gather() and scatter() are provided for, and Index one
+         *        of their index types.
+         */
+        template <typename T, typename Index>
+        struct is_gather_element : std::integral_constant<bool,
+                disjunction<std::is_same<T, float>, std::is_same<T, double>, std::is_same<T, std::int32_t>>::value
+                && disjunction<std::is_same<Index, std::int32_t>, std::is_same<Index, std::uint32_t>>::value> {
+        };
+
+        /**
+         * @brief Size in bytes of the indexed array from which gather() and scatter() prefetch the elements they will
+         *        access gather_prefetch_distance indices later, since the array no longer fits the caches.
+         */
+        constexpr std::size_t gather_prefetch_bytes = std::size_t(1) << 20;
+
+        /**
+         * @brief Number of indices between an element gather() and scatter() prefetch and the one they access.
+         */
+        constexpr std::size_t gather_prefetch_distance = 32;
+
+        /**
+         * @brief Smallest stride from which deinterleave() loads the elements with the gather instructions of AVX2 or
+         *        AVX-512, where available, rather than the scalar loop. Smaller strides are de-interleaved by
+         *        shuffling whole vectors.
+         */
+        constexpr std::size_t deinterleave_gather_stride = 5;
+
+        /**
+         * @brief Checks whether deinterleave() gathers the elements with a stride of _stride, whose offsets within
+         *        a vector must fit the signed 32-bit lanes of the gather instructions.
+         */
+        inline bool is_gather_stride(std::size_t _stride) {
+            return _stride >= deinterleave_gather_stride
+                   && _stride <= static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()) / 16;
+        }
+
+        /**
+         * @brief What utf8_to_utf16() returns for input that is not valid UTF-8.
+         */
+        constexpr std::size_t utf8_invalid = std::size_t(-1);
+
+        /**
+         * @brief Size ratio from which the set operations search the elements of the smaller input in the larger one
+         *        by galloping instead of merging both.
+         */
+        constexpr std::size_t set_gallop_ratio = 32;
+
+        /**
+         * @brief Size in bytes up to which transpose() transposes a block of a matrix directly rather than splitting
+         *        it further, so that the block and its transpose stay in the first level cache.
+         */
+        constexpr std::size_t transpose_block_bytes = 8192;
+
+        /**
+         * @brief Transposes the _rows x _columns matrix at _in, whose rows are _in_stride elements apart, to the one
+         *        at _out, whose rows are _out_stride elements apart. The larger dimension is halved until the block
+         *        is at most transpose_block_bytes, then _block transposes it, so every level of the cache and TLB
+         *        holds the rows of the blocks it operates on without the recursion knowing their sizes. The halves
+         *        are kept multiples of 16 rows or columns, the largest tile the kernels transpose in registers.
+         */
+        template <typename T>
+        void transpose_recursive(const T* _in, std::size_t _in_stride, T* _out, std::size_t _out_stride,
+                                 std::size_t _rows, std::size_t _columns,
+                                 void (*_block)(const T*, std::size_t, T*, std::size_t, std::size_t, std::size_t)) {
+            if (_rows * _columns * sizeof(T) <= transpose_block_bytes || (_rows <= 16 && _columns <= 16)) {
+                return _block(_in, _in_stride, _out, _out_stride, _rows, _columns);
+            }
+
+            const std::size_t larger = std::max(_rows, _columns);
+            const std::size_t half = (larger / 2 + 15) & ~std::size_t(15);
+
+            if (_rows >= _columns) {
+                transpose_recursive(_in, _in_stride, _out, _out_stride, half, _columns, _block);
+                transpose_recursive(_in + half * _in_stride, _in_stride, _out + half, _out_stride, _rows - half,
+                                    _columns, _block);
+            } else {
+                transpose_recursive(_in, _in_stride, _out, _out_stride, _rows, half, _block);
+                transpose_recursive(_in + half, _in_stride, _out + half * _out_stride, _out_stride, _rows,
+                                    _columns - half, _block);
+            }
+        }
+
+        namespace scalar_kernels
+        {
+
+            template <typename T>
+            void fill(T* _p, std::size_t _n, T _value) {
+                for (std::size_t i = 0; i < _n; ++i) {
+                    _p[i] = _value;
+                }
+            }
+
+            template <typename T, typename U, typename F>
+            void transform(const T* _in, U* _out, std::size_t _n, F& _f, std::true_type) {
+                for (std::size_t i = 0; i < _n; ++i) {
+                    U x = _in[i];
+                    _f(x);
+                    _out[i] = x;
+                }
+            }
+
+            template <typename T, typename U, typename F>
+            void transform(const T* _in, U* _out, std::size_t _n, F& _f, std::false_type) {
+                for (std::size_t i = 0; i < _n; ++i) {
+                    _out[i] = _f(_in[i]);
+                }
+            }
+
+            template <typename T, typename U, typename F>
+            void transform(const T* _in, U* _out, std::size_t _n, F& _f) {
+                transform(_in, _out, _n, _f, typename is_element_update<U, F>::type());
+            }
+
+            template <typename T, typename E>
+            void evaluate(T* _out, std::size_t _n, const E& _expression) {
+                for (std::size_t i = 0; i < _n; ++i) {
+                    T x;
+                    _expression.evaluate(x, i);
+                    _out[i] = x;
+                }
+            }
+
+            /**
+             * @brief Prefetches the elements of _base at the indices in [_first, _last) of _indices, for reading or,
+             *        if _write is true, for writing.
+             */
+            template <typename T, typename Index>
+            void prefetch_indexed(const T* _base, const Index* _indices, std::size_t _first, std::size_t _last,
+                                  bool _write) {
+                for (std::size_t i = _first; i < _last; ++i) {
+                    if (_write) {
+                        prefetch_for_write(const_cast<T*>(_base) + _indices[i]);
+                    } else {
+                        prefetch(_base + _indices[i]);
+                    }
+                }
+            }
+
+            template <typename T, typename Index>
+            void gather(const T* _values, const Index* _indices, std::size_t _n, T* _out, bool _prefetch) {
+                for (std::size_t i = 0; i < _n; ++i) {
+                    if (_prefetch && i + gather_prefetch_distance < _n) {
+                        prefetch(_values + _indices[i + gather_prefetch_distance]);
+                    }
+
+                    _out[i] = _values[_indices[i]];
+                }
+            }
+
+            template <typename T, typename Index>
+            void scatter(const T* _values, const Index* _indices, std::size_t _n, T* _out, bool _prefetch) {
+                for (std::size_t i = 0; i < _n; ++i) {
+                    if (_prefetch && i + gather_prefetch_distance < _n) {
+                        prefetch_for_write(_out + _indices[i + gather_prefetch_distance]);
+                    }
+
+                    _out[_indices[i]] = _values[i];
+                }
+            }
+
+            template <typename T>
+            void deinterleave(const T* _in, std::size_t _stride, std::size_t _n, T* _out) {
+                for (std::size_t i = 0; i < _n; ++i) {
+                    _out[i] = _in[i * _stride];
+                }
+            }
+
+            template <typename T>
+            void transpose_block(const T* _in, std::size_t _in_stride, T* _out, std::size_t _out_stride,
+                                 std::size_t _rows, std::size_t _columns) {
+                for (std::size_t r = 0; r < _rows; ++r) {
+                    for (std::size_t c = 0; c < _columns; ++c) {
+                        _out[c * _out_stride + r] = _in[r * _in_stride + c];
+                    }
+                }
+            }
+
+            template <typename T>
+            void transpose(const T* _in, std::size_t _rows, std::size_t _columns, T* _out) {
+                transpose_recursive(_in, _columns, _out, _rows, _rows, _columns, &transpose_block<T>);
+            }
+
+            template <typename T>
+            T prefix_sum(const T* _in, std::size_t _n, T _carry, bool _inclusive, T* _out) {
+                for (std::size_t i = 0; i < _n; ++i) {
+                    const T x = _in[i];
+                    _out[i] = _inclusive ? _carry + x : _carry;
+                    _carry += x;
+                }
+
+                return _carry;
+            }
+
+            template <typename T>
+            std::size_t compress(const T* _in, const std::uint8_t* _keep, std::size_t _n, T* _out) {
+                std::size_t kept = 0;
+
+                for (std::size_t i = 0; i < _n; ++i) {
+                    if (_keep[i]) {
+                        _out[kept++] = _in[i];
+                    }
+                }
+
+                return kept;
+            }
+
+            template <typename T>
+            std::size_t select_beyond(const T* _p, std::size_t _n, T _bound, bool _greater, T* _out, std::size_t _room,
+                                      std::size_t& _written) {
+                std::size_t i = 0;
+
+                for (; i < _n && _written < _room; ++i) {
+                    _out[_written] = _p[i];
+                    _written += _greater ? _p[i] > _bound : _p[i] < _bound;
+                }
+
+                return i;
+            }
+
+            template <typename T>
+            typename sum_type<T>::type sum(const T* _p, std::size_t _n) {
+                typename sum_type<T>::type result = 0;
+
+                for (std::size_t i = 0; i < _n; ++i) {
+                    result += _p[i];
+                }
+
+                return result;
+            }
+
+            template <typename T>
+            std::pair<T, T> min_max(const T* _p, std::size_t _n) {
+                T low = _p[0];
+                T high = _p[0];
+
+                for (std::size_t i = 1; i < _n; ++i) {
+                    low = _p[i] < low ? _p[i] : low;
+                    high = _p[i] > high ? _p[i] : high;
+                }
+
+                return std::make_pair(low, high);
+            }
+
+            template <typename T>
+            std::size_t find(const T* _p, std::size_t _n, T _value) {
+                for (std::size_t i = 0; i < _n; ++i) {
+                    if (_p[i] == _value) {
+                        return i;
+                    }
+                }
+
+                return _n;
+            }
+
+            template <typename T>
+            std::size_t find_not(const T* _p, std::size_t _n, T _value) {
+                for (std::size_t i = 0; i < _n; ++i) {
+                    if (_p[i] != _value) {
+                        return i;
+                    }
+                }
+
+                return _n;
+            }
+
+            template <typename T>
+            std::size_t count(const T* _p, std::size_t _n, T _value) {
+                std::size_t result = 0;
+
+                for (std::size_t i = 0; i < _n; ++i) {
+                    result += _p[i] == _value;
+                }
+
+                return result;
+            }
+
+            inline std::size_t find_any(const std::uint8_t* _p, std::size_t _n, const std::uint8_t* _needles,
+                                        std::size_t _needle_count) {
+                bool table[256] = {};
+
+                for (std::size_t j = 0; j < _needle_count; ++j) {
+                    table[_needles[j]] = true;
+                }
+
+                for (std::size_t i = 0; i < _n; ++i) {
+                    if (table[_p[i]]) {
+                        return i;
+                    }
+                }
+
+                return _n;
+            }
+
+            /**
+             * @brief Returns the index of the first of the _n sorted elements at _p that is not less than _value, found by
+             *        doubling the step from the start and then searching the last step in halves, so that the cost
+             *        grows with the logarithm of the distance rather than of _n.
+             */
+            template <typename T>
+            std::size_t gallop(const T* _p, std::size_t _n, T _value) {
+                std::size_t low = 0;
+                std::size_t step = 1;
+
+                while (low + step < _n && _p[low + step] < _value) {
+                    low += step;
+                    step *= 2;
+                }
+
+                if (_n == 0 || !(_p[low] < _value)) {
+                    return low;
+                }
+
+                return static_cast<std::size_t>(std::lower_bound(_p + low + 1, _p + std::min(_n, low + step), _value) - _p);
+            }
+
+            template <typename T>
+            std::size_t copy_elements(const T* _p, std::size_t _n, T* _out) {
+                if (_n != 0) {
+                    std::memcpy(_out, _p, _n * sizeof(T));
+                }
+
+                return _n;
+            }
+
+            template <typename T>
+            std::size_t set_intersection(const T* _a, std::size_t _na, const T* _b, std::size_t _nb, T* _out) {
+                std::size_t i = 0;
+                std::size_t j = 0;
+                std::size_t k = 0;
+
+                while (i < _na && j < _nb) {
+                    const T x = _a[i];
+                    const T y = _b[j];
+                    _out[k] = x;
+                    k += x == y;
+                    i += x <= y;
+                    j += y <= x;
+                }
+
+                return k;
+            }
+
+            template <typename T>
+            std::size_t set_difference(const T* _a, std::size_t _na, const T* _b, std::size_t _nb, T* _out) {
+                std::size_t i = 0;
+                std::size_t j = 0;
+                std::size_t k = 0;
+
+                while (i < _na && j < _nb) {
+                    const T x = _a[i];
+                    const T y = _b[j];
+                    _out[k] = x;
+                    k += x < y;
+                    i += x <= y;
+                    j += y <= x;
+                }
+
+                return k + copy_elements(_a + i, _na - i, _out + k);
+            }
+
+            template <typename T>
+            std::size_t set_union(const T* _a, std::size_t _na, const T* _b, std::size_t _nb, T* _out) {
+                std::size_t i = 0;
+                std::size_t j = 0;
+                std::size_t k = 0;
+
+                while (i < _na && j < _nb) {
+                    const T x = _a[i];
+                    const T y = _b[j];
+                    _out[k++] = x <= y ? x : y;
+                    i += x <= y;
+                    j += y <= x;
+                }
+
+                k += copy_elements(_a + i, _na - i, _out + k);
+                return k + copy_elements(_b + j, _nb - j, _out + k);
+            }
+
+            /**
+             * @brief Intersection of the _na elements at _a with the much larger input _b.
+             */
+            template <typename T>
+            std::size_t set_intersection_galloping(const T* _a, std::size_t _na, const T* _b, std::size_t _nb,
+                                                   T* _out) {
+                std::size_t j = 0;
+                std::size_t k = 0;
+
+                for (std::size_t i = 0; i < _na && j < _nb; ++i) {
+                    j += gallop(_b + j, _nb - j, _a[i]);
+
+                    if (j < _nb && _b[j] == _a[i]) {
+                        _out[k++] = _a[i];
+                        ++j;
+                    }
+                }
+
+                return k;
+            }
+
+            /**
+             * @brief Difference of the _na elements at _a and the much larger input _b.
+             */
+            template <typename T>
+            std::size_t set_difference_galloping(const T* _a, std::size_t _na, const T* _b, std::size_t _nb,
+                                                 T* _out) {
+                std::size_t i = 0;
+                std::size_t j = 0;
+                std::size_t k = 0;
+
+                for (; i < _na && j < _nb; ++i) {
+                    j += gallop(_b + j, _nb - j, _a[i]);
+
+                    if (j < _nb && _b[j] == _a[i]) {
+                        ++j;
+                    } else {
+                        _out[k++] = _a[i];
+                    }
+                }
+
+                return k + copy_elements(_a + i, _na - i, _out + k);
+            }
+
+            /**
+             * @brief Copies the elements of the much larger input _large to _out, except for those equal to one of the
+             *        _nsmall elements at _small, which are copied as well if _keep_small is true. The runs of _large
+             *        between two elements of _small are copied as blocks. This computes the difference _large - _small
+             *        or the union of both.
+             */
+            template <typename T>
+            std::size_t merge_galloping(const T* _large, std::size_t _nlarge, const T* _small, std::size_t _nsmall,
+                                        T* _out, bool _keep_small) {
+                std::size_t i = 0;
+                std::size_t k = 0;
+
+                for (std::size_t j = 0; j < _nsmall; ++j) {
+                    const std::size_t run = gallop(_large + i, _nlarge - i, _small[j]);
+                    k += copy_elements(_large + i, run, _out + k);
+                    i += run;
+                    i += i < _nlarge && _large[i] == _small[j];
+
+                    if (_keep_small) {
+                        _out[k++] = _small[j];
+                    }
+                }
+
+                return k + copy_elements(_large + i, _nlarge - i, _out + k);
+            }
+
+            /**
+             * @brief Returns the length of the valid UTF-8 sequence that starts _p, which is followed by _n - 1 more
+             *        bytes, or 0 if it is invalid: a stray continuation byte, an overlong encoding, a surrogate, a code
+             *        point above U+10FFFF or a truncated sequence.
+             */
+            inline std::size_t utf8_sequence_length(const std::uint8_t* _p, std::size_t _n) {
+                const std::uint8_t lead = _p[0];
+                std::uint8_t low = 0x80;
+                std::uint8_t high = 0xBF;
+                std::size_t length;
+
+                if (lead < 0x80) {
+                    return 1;
+                } else if (lead < 0xC2) {
+                    return 0;
+                } else if (lead < 0xE0) {
+                    length = 2;
+                } else if (lead < 0xF0) {
+                    length = 3;
+                    low = lead == 0xE0 ? 0xA0 : 0x80;
+                    high = lead == 0xED ? 0x9F : 0xBF;
+                } else if (lead < 0xF5) {
+                    length = 4;
+                    low = lead == 0xF0 ? 0x90 : 0x80;
+                    high = lead == 0xF4 ? 0x8F : 0xBF;
+                } else {
+                    return 0;
+                }
+
+                if (_n < length || _p[1] < low || _p[1] > high) {
+                    return 0;
+                }
+
+                for (std::size_t k = 2; k < length; ++k) {
+                    if ((_p[k] & 0xC0) != 0x80) {
+                        return 0;
+                    }
+                }
+
+                return length;
+            }
+
+            inline bool is_ascii_word(const std::uint8_t* _p) {
+                std::uint64_t word;
+                std::memcpy(&word, _p, sizeof(word));
+                return (word & 0x8080808080808080u) == 0;
+            }
+
+            /**
+             * @brief Checks the UTF-8 sequences starting at _i, of the _n bytes at _p, up to the first one that ends at
+             *        or after _stop, and advances _i past it. Returns false if one of them is invalid.
+             */
+            inline bool validate_utf8_until(const std::uint8_t* _p, std::size_t& _i, std::size_t _stop,
+                                            std::size_t _n) {
+                while (_i < _stop) {
+                    const std::size_t length = utf8_sequence_length(_p + _i, _n - _i);
+
+                    if (length == 0) {
+                        return false;
+                    }
+
+                    _i += length;
+                }
+
+                return true;
+            }
+
+            /**
+             * @brief Writes the UTF-16 code units of the valid UTF-8 sequence whose _available bytes, four or fewer,
+             *        start at _p to _out and advances _out past them. The sequence is decoded without branching on its
+             *        length, and the second unit of a surrogate pair is stored whether it is needed or not when four
+             *        bytes are available, which leaves room for it.
+             */
+            inline void utf8_to_utf16_sequence(const std::uint8_t* _p, std::size_t _available, char16_t*& _out) {
+                static const std::uint8_t lengths[16] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 3, 4};
+                static const std::uint8_t lead_masks[5] = {0, 0x7F, 0x1F, 0x0F, 0x07};
+                std::uint8_t bytes[4] = {};
+
+                if (_available >= 4) {
+                    std::memcpy(bytes, _p, 4);
+                } else {
+                    std::copy(_p, _p + _available, bytes);
+                }
+
+                const std::size_t length = lengths[bytes[0] >> 4];
+                const std::uint32_t code_point = (std::uint32_t(bytes[0] & lead_masks[length]) << 18
+                                                  | std::uint32_t(bytes[1] & 0x3F) << 12
+                                                  | std::uint32_t(bytes[2] & 0x3F) << 6
+                                                  | (bytes[3] & 0x3F)) >> (6 * (4 - length));
+                const bool pair = code_point >= 0x10000;
+                const std::uint32_t offset = code_point - 0x10000;
+
+                _out[0] = static_cast<char16_t>(pair ? 0xD800 + (offset >> 10) : code_point);
+
+                if (_available >= 4) {
+                    _out[1] = static_cast<char16_t>(0xDC00 + (offset & 0x3FF));
+                }
+
+                _out += 1 + pair;
+            }
+
+            /**
+             * @brief Writes the UTF-16 code units of the sequences that start in the 8 bytes at _i, of the _n bytes of
+             *        valid UTF-8 at _p, to _out and advances it past them. The sequences are found from the mask of
+             *        the bytes that are not continuation bytes, so that finding the next one does not wait for the
+             *        length of the previous one.
+             */
+            inline void utf8_to_utf16_word(const std::uint8_t* _p, std::size_t _i, std::size_t _n, char16_t*& _out) {
+                std::uint64_t word;
+                std::memcpy(&word, _p + _i, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+                word = __builtin_bswap64(word);
+#endif
+
+                if ((word & 0x8080808080808080u) == 0) {
+                    for (std::size_t k = 0; k < 8; ++k) {
+                        _out[k] = _p[_i + k];
+                    }
+
+                    _out += 8;
+                    return;
+                }
+
+                for (std::uint64_t leads = ~(word & ~(word << 1)) & 0x8080808080808080u; leads != 0;
+                     leads &= leads - 1) {
+                    const std::size_t at = _i + static_cast<std::size_t>(__builtin_ctzll(leads)) / 8;
+                    utf8_to_utf16_sequence(_p + at, std::min<std::size_t>(4, _n - at), _out);
+                }
+            }
+
+            inline bool validate_utf8(const std::uint8_t* _p, std::size_t _n) {
+                std::size_t i = 0;
+
+                while (i < _n) {
+                    if (i + 8 <= _n && is_ascii_word(_p + i)) {
+                        i += 8;
+                    } else if (!validate_utf8_until(_p, i, std::min(i + 8, _n), _n)) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            inline std::size_t utf8_to_utf16_valid(const std::uint8_t* _p, std::size_t _n, char16_t* _out) {
+                char16_t* const first = _out;
+                std::size_t i = 0;
+
+                for (; i + 8 <= _n; i += 8) {
+                    utf8_to_utf16_word(_p, i, _n, _out);
+                }
+
+                //Skips the continuation bytes of a sequence started by the last word.
+                while (i < _n && (_p[i] & 0xC0) == 0x80) {
+                    ++i;
+                }
+
+                for (; i < _n; i += utf8_sequence_length(_p + i, _n - i)) {
+                    utf8_to_utf16_sequence(_p + i, std::min<std::size_t>(4, _n - i), _out);
+                }
+
+                return static_cast<std::size_t>(_out - first);
+            }
+
+            inline std::size_t utf8_to_utf16(const std::uint8_t* _p, std::size_t _n, char16_t* _out) {
+                return validate_utf8(_p, _n) ? utf8_to_utf16_valid(_p, _n, _out) : utf8_invalid;
+            }
+
+            template <std::size_t Width>
+            void byteswap(const std::uint8_t* _in, std::size_t _n, std::uint8_t* _out,
+                          std::integral_constant<std::size_t, Width>) {
+                for (std::size_t i = 0; i < _n; ++i) {
+                    std::uint8_t word[Width];
+                    std::memcpy(word, _in + i * Width, Width);
+                    std::reverse(word, word + Width);
+                    std::memcpy(_out + i * Width, word, Width);
+                }
+            }
+
+            inline void byteswap(const std::uint8_t* _in, std::size_t _width, std::size_t _n, std::uint8_t* _out) {
+                switch (_width) {
+                    case 2: return byteswap(_in, _n, _out, std::integral_constant<std::size_t, 2>());
+                    case 4: return byteswap(_in, _n, _out, std::integral_constant<std::size_t, 4>());
+                    case 8: return byteswap(_in, _n, _out, std::integral_constant<std::size_t, 8>());
+                    default:
+                        if (_width * _n != 0) {
+                            std::memmove(_out, _in, _width * _n);
+                        }
+                        return;
+                }
+            }
+
+            /**
+             * @brief Mixes _key so that every bit of the result depends on every bit of _key, with the finalizer of
+             *        MurmurHash3.
+             */
+            inline std::uint64_t mix64(std::uint64_t _key) {
+                _key ^= _key >> 33;
+                _key *= UINT64_C(0xFF51AFD7ED558CCD);
+                _key ^= _key >> 33;
+                _key *= UINT64_C(0xC4CEB9FE1A85EC53);
+                return _key ^ (_key >> 33);
+            }
+
+            inline void hash64(const std::uint64_t* _keys, std::size_t _n, std::uint64_t* _out) {
+                for (std::size_t i = 0; i < _n; ++i) {
+                    _out[i] = mix64(_keys[i]);
+                }
+            }
+
+            constexpr std::uint32_t philox_multiplier0 = 0xD2511F53u;
+            constexpr std::uint32_t philox_multiplier1 = 0xCD9E8D57u;
+            constexpr std::uint32_t philox_weyl0 = 0x9E3779B9u;
+            constexpr std::uint32_t philox_weyl1 = 0xBB67AE85u;
+            constexpr int philox_rounds = 10;
+
+            /**
+             * @brief Encrypts the 128-bit counter _counter with the 64-bit key _key by the ten rounds of Philox4x32,
+             *        the counter-based generator of Salmon et al., Parallel Random Numbers: As Easy as 1, 2, 3.
+             */
+            inline void philox4x32(const std::uint32_t* _counter, const std::uint32_t* _key, std::uint32_t* _out) {
+                std::uint32_t x0 = _counter[0], x1 = _counter[1], x2 = _counter[2], x3 = _counter[3];
+                std::uint32_t k0 = _key[0], k1 = _key[1];
+
+                for (int round = 0; round < philox_rounds; ++round) {
+                    const std::uint64_t p0 = static_cast<std::uint64_t>(philox_multiplier0) * x0;
+                    const std::uint64_t p1 = static_cast<std::uint64_t>(philox_multiplier1) * x2;
+                    x0 = static_cast<std::uint32_t>(p1 >> 32) ^ x1 ^ k0;
+                    x1 = static_cast<std::uint32_t>(p1);
+                    x2 = static_cast<std::uint32_t>(p0 >> 32) ^ x3 ^ k1;
+                    x3 = static_cast<std::uint32_t>(p0);
+                    k0 += philox_weyl0;
+                    k1 += philox_weyl1;
+                }
+
+                _out[0] = x0;
+                _out[1] = x1;
+                _out[2] = x2;
+                _out[3] = x3;
+            }
+
+            inline void philox4x32(std::uint64_t _key, std::uint64_t _stream, std::uint64_t _block, std::size_t _n,
+                                   std::uint32_t* _out) {
+                const std::uint32_t key[2] = {static_cast<std::uint32_t>(_key), static_cast<std::uint32_t>(_key >> 32)};
+
+                for (std::size_t i = 0; i < _n; ++i) {
+                    const std::uint64_t block = _block + i;
+                    const std::uint32_t counter[4] = {
+                        static_cast<std::uint32_t>(block), static_cast<std::uint32_t>(block >> 32),
+                        static_cast<std::uint32_t>(_stream), static_cast<std::uint32_t>(_stream >> 32)
+                    };
+                    philox4x32(counter, key, _out + 4 * i);
+                }
+            }
+        } // namespace scalar_kernels
+
+#if ITERATOR_BASED_FOR_SIMD_X86
+        ITERATOR_BASED_FOR_SIMD_TARGET_PUSH(ITERATOR_BASED_FOR_SIMD_SSE2)
+        namespace sse2_kernels
+        {
+            constexpr std::size_t vector_bytes = 16;
+
+            typedef std::uint64_t wide_lanes __attribute__((vector_size(vector_bytes)));
+
+            /**
+             * @brief Returns the exact 64-bit products of the low 32 bits of the lanes of _a and _b, with pmuludq.
+             */
+            inline wide_lanes multiply_low32(wide_lanes _a, wide_lanes _b) {
+                return reinterpret_cast<wide_lanes>(_mm_mul_epu32(reinterpret_cast<__m128i>(_a),
+                                                                  reinterpret_cast<__m128i>(_b)));
+            }
+
+#include <IteratorBasedForSimdKernels.inc>
+        } // namespace sse2_kernels
+        ITERATOR_BASED_FOR_SIMD_TARGET_POP
+
+        ITERATOR_BASED_FOR_SIMD_TARGET_PUSH(ITERATOR_BASED_FOR_SIMD_AVX2)
+        namespace avx2_kernels
+        {
+            constexpr std::size_t vector_bytes = 32;
+
+            typedef std::uint64_t wide_lanes __attribute__((vector_size(vector_bytes)));
+
+            /**
+             * @brief Returns the exact 64-bit products of the low 32 bits of the lanes of _a and _b, with vpmuludq.
+             */
+            inline wide_lanes multiply_low32(wide_lanes _a, wide_lanes _b) {
+                return reinterpret_cast<wide_lanes>(_mm256_mul_epu32(reinterpret_cast<__m256i>(_a),
+                                                                           reinterpret_cast<__m256i>(_b)));
+            }
+
+#include <IteratorBasedForSimdKernels.inc>
+
+            /**
+             * @brief Returns the mask selecting every lane of the masked double gathers.
+             */
+            inline __m256d all_lanes_pd() {
+                return _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+            }
+
+            template <typename Index>
+            void gather(const float* _values, const Index* _indices, std::size_t _n, float* _out, bool _prefetch) {
+                std::size_t i = 0;
+
+                for (; i + 8 <= _n; i += 8) {
+                    if (_prefetch) {
+                        scalar_kernels::prefetch_indexed(_values, _indices, std::min(_n, i + gather_prefetch_distance),
+                                                         std::min(_n, i + gather_prefetch_distance + 8), false);
+                    }
+
+                    const __m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_indices + i));
+                    _mm256_storeu_ps(_out + i, _mm256_i32gather_ps(_values, indices, 4));
+                }
+
+                scalar_kernels::gather(_values, _indices + i, _n - i, _out + i, false);
+            }
+
+            template <typename Index>
+            void gather(const std::int32_t* _values, const Index* _indices, std::size_t _n, std::int32_t* _out,
+                        bool _prefetch) {
+                std::size_t i = 0;
+
+                for (; i + 8 <= _n; i += 8) {
+                    if (_prefetch) {
+                        scalar_kernels::prefetch_indexed(_values, _indices, std::min(_n, i + gather_prefetch_distance),
+                                                         std::min(_n, i + gather_prefetch_distance + 8), false);
+                    }
+
+                    const __m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_indices + i));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(_out + i),
+                                        _mm256_i32gather_epi32(reinterpret_cast<const int*>(_values), indices, 4));
+                }
+
+                scalar_kernels::gather(_values, _indices + i, _n - i, _out + i, false);
+            }
+
+            template <typename Index>
+            void gather(const double* _values, const Index* _indices, std::size_t _n, double* _out, bool _prefetch) {
+                std::size_t i = 0;
+
+                for (; i + 4 <= _n; i += 4) {
+                    if (_prefetch) {
+                        scalar_kernels::prefetch_indexed(_values, _indices, std::min(_n, i + gather_prefetch_distance),
+                                                         std::min(_n, i + gather_prefetch_distance + 4), false);
+                    }
+
+                    //The masked form, as the unmasked one trips -Wmaybe-uninitialized in the headers of GCC 12.
+                    const __m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_indices + i));
+                    _mm256_storeu_pd(_out + i, _mm256_mask_i32gather_pd(_mm256_setzero_pd(), _values, indices,
+                                                                        all_lanes_pd(), 8));
+                }
+
+                scalar_kernels::gather(_values, _indices + i, _n - i, _out + i, false);
+            }
+
+            inline void deinterleave(const float* _in, std::size_t _stride, std::size_t _n, float* _out) {
+                if (!is_gather_stride(_stride)) {
+                    return deinterleave<float>(_in, _stride, _n, _out);
+                }
+
+                const __m256i indices = _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(_stride)),
+                                                          _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+                std::size_t i = 0;
+
+                for (; i + 8 <= _n; i += 8) {
+                    _mm256_storeu_ps(_out + i, _mm256_i32gather_ps(_in + i * _stride, indices, 4));
+                }
+
+                scalar_kernels::deinterleave(_in + i * _stride, _stride, _n - i, _out + i);
+            }
+
+            inline void deinterleave(const std::int32_t* _in, std::size_t _stride, std::size_t _n,
+                                     std::int32_t* _out) {
+                if (!is_gather_stride(_stride)) {
+                    return deinterleave<std::int32_t>(_in, _stride, _n, _out);
+                }
+
+                const __m256i indices = _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(_stride)),
+                                                          _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+                std::size_t i = 0;
+
+                for (; i + 8 <= _n; i += 8) {
+                    const int* in = reinterpret_cast<const int*>(_in + i * _stride);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(_out + i), _mm256_i32gather_epi32(in, indices, 4));
+                }
+
+                scalar_kernels::deinterleave(_in + i * _stride, _stride, _n - i, _out + i);
+            }
+
+            inline void deinterleave(const double* _in, std::size_t _stride, std::size_t _n, double* _out) {
+                if (!is_gather_stride(_stride)) {
+                    return deinterleave<double>(_in, _stride, _n, _out);
+                }
+
+                const __m128i indices = _mm_mullo_epi32(_mm_set1_epi32(static_cast<int>(_stride)),
+                                                          _mm_setr_epi32(0, 1, 2, 3));
+                std::size_t i = 0;
+
+                for (; i + 4 <= _n; i += 4) {
+                    //The masked form, as the unmasked one trips -Wmaybe-uninitialized in the headers of GCC 12.
+                    _mm256_storeu_pd(_out + i, _mm256_mask_i32gather_pd(_mm256_setzero_pd(), _in + i * _stride, indices,
+                                                                        all_lanes_pd(), 8));
+                }
+
+                scalar_kernels::deinterleave(_in + i * _stride, _stride, _n - i, _out + i);
+            }
+
+            /**
+             * @brief Lane permutations moving the lanes of a vector of eight 32-bit lanes selected by the bits of the
+             *        index to its front, in order; nibble j of an entry is the lane that moves to lane j.
+             */
+            struct compress_table {
+                std::uint32_t permutations[256];
+
+                compress_table() : permutations() {
+                    for (unsigned mask = 0; mask < 256; ++mask) {
+                        unsigned front = 0;
+
+                        for (unsigned lane = 0; lane < 8; ++lane) {
+                            if (mask & (1u << lane)) {
+                                permutations[mask] |= lane << (4 * front++);
+                            }
+                        }
+                    }
+                }
+            };
+
+            inline __m256i compress_permutation(unsigned _mask) {
+                static const compress_table table;
+
+                const __m256i nibbles = _mm256_set1_epi32(static_cast<int>(table.permutations[_mask]));
+                return _mm256_and_si256(_mm256_srlv_epi32(nibbles, _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28)),
+                                        _mm256_set1_epi32(7));
+            }
+
+            //The mask of the first _count 32-bit lanes, and the mask and the number of the flags set among eight.
+            inline __m256i first_lanes(int _count) {
+                return _mm256_cmpgt_epi32(_mm256_set1_epi32(_count), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            }
+
+            inline unsigned keep_mask(__m128i _flags) {
+                return ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_flags, _mm_setzero_si128()))) & 0xffu;
+            }
+
+            inline int keep_count(__m128i _flags) {
+                return _mm_cvtsi128_si32(_mm_sad_epu8(_flags, _mm_setzero_si128()));
+            }
+
+            inline std::size_t compress(const float* _in, const std::uint8_t* _keep, std::size_t _n, float* _out) {
+                std::size_t i = 0;
+                std::size_t kept = 0;
+
+                for (; i + 8 <= _n; i += 8) {
+                    const __m128i flags = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(_keep + i));
+                    const int count = keep_count(flags);
+                    const __m256 front = _mm256_permutevar8x32_ps(_mm256_loadu_ps(_in + i),
+                                                                  compress_permutation(keep_mask(flags)));
+
+                    _mm256_maskstore_ps(_out + kept, first_lanes(count), front);
+                    kept += static_cast<std::size_t>(count);
+                }
+
+                return kept + scalar_kernels::compress(_in + i, _keep + i, _n - i, _out + kept);
+            }
+
+            inline std::size_t compress(const std::int32_t* _in, const std::uint8_t* _keep, std::size_t _n,
+                                        std::int32_t* _out) {
+                std::size_t i = 0;
+                std::size_t kept = 0;
+
+                for (; i + 8 <= _n; i += 8) {
+                    const __m128i flags = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(_keep + i));
+                    const int count = keep_count(flags);
+                    const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_in + i));
+                    const __m256i front = _mm256_permutevar8x32_epi32(in, compress_permutation(keep_mask(flags)));
+
+                    _mm256_maskstore_epi32(reinterpret_cast<int*>(_out + kept), first_lanes(count), front);
+                    kept += static_cast<std::size_t>(count);
+                }
+
+                return kept + scalar_kernels::compress(_in + i, _keep + i, _n - i, _out + kept);
+            }
+
+            inline std::size_t compress(const double* _in, const std::uint8_t* _keep, std::size_t _n, double* _out) {
+                std::size_t i = 0;
+                std::size_t kept = 0;
+
+                for (; i + 4 <= _n; i += 4) {
+                    std::int32_t four;
+                    std::memcpy(&four, _keep + i, sizeof(four));
+
+                    //Every element is a pair of 32-bit lanes that move together.
+                    const __m128i flags = _mm_cvtsi32_si128(four);
+                    const unsigned mask = keep_mask(flags);
+                    const unsigned pairs = (mask & 1u) * 3u | (mask & 2u) * 6u | (mask & 4u) * 12u | (mask & 8u) * 24u;
+                    const int count = keep_count(flags);
+                    const __m256i in = _mm256_castpd_si256(_mm256_loadu_pd(_in + i));
+                    const __m256i front = _mm256_permutevar8x32_epi32(in, compress_permutation(pairs));
+
+                    _mm256_maskstore_pd(_out + kept, first_lanes(2 * count), _mm256_castsi256_pd(front));
+                    kept += static_cast<std::size_t>(count);
+                }
+
+                return kept + scalar_kernels::compress(_in + i, _keep + i, _n - i, _out + kept);
+            }
+
+            //The bytes of _previous and _input shifted by N bytes towards the end, the last N of _previous first.
+            template <int N>
+            __m256i previous_bytes(__m256i _input, __m256i _previous) {
+                return _mm256_alignr_epi8(_input, _mm256_permute2x128_si256(_previous, _input, 0x21), 16 - N);
+            }
+
+            inline __m256i nibble_lookup(const std::uint8_t* _table, __m256i _nibbles) {
+                const __m128i table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_table));
+                return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(table), _nibbles);
+            }
+
+            /**
+             * @brief Returns a vector that is nonzero where the bytes of _input, preceded by those of _previous, are
+             *        not valid UTF-8, as computed by the lookup algorithm of Keiser and Lemire, "Validating UTF-8 In
+             *        Less Than One Instruction Per Byte" (the validator of simdjson). Three tables indexed by the high
+             *        and low nibbles of every byte and the high nibble of the next one flag the invalid pairs, and the
+             *        third and fourth bytes of long sequences are checked to be continuation bytes separately.
+             */
+            inline __m256i utf8_errors(__m256i _input, __m256i _previous) {
+                constexpr std::uint8_t too_short = 1 << 0;
+                constexpr std::uint8_t too_long = 1 << 1;
+                constexpr std::uint8_t overlong_3 = 1 << 2;
+                constexpr std::uint8_t too_large = 1 << 3;
+                constexpr std::uint8_t surrogate = 1 << 4;
+                constexpr std::uint8_t overlong_2 = 1 << 5;
+                constexpr std::uint8_t too_large_1000 = 1 << 6;
+                constexpr std::uint8_t overlong_4 = 1 << 6;
+                constexpr std::uint8_t two_conts = 1 << 7;
+                constexpr std::uint8_t carry = too_short | too_long | two_conts;
+                constexpr std::uint8_t large = carry | too_large | too_large_1000;
+
+                static const std::uint8_t first_high[16] = {
+                    too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+                    two_conts, two_conts, two_conts, two_conts,
+                    too_short | overlong_2, too_short, too_short | overlong_3 | surrogate,
+                    too_short | too_large | too_large_1000 | overlong_4
+                };
+                static const std::uint8_t first_low[16] = {
+                    carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry, carry, carry | too_large,
+                    large, large, large, large, large, large, large, large, large | surrogate, large, large
+                };
+                static const std::uint8_t second_high[16] = {
+                    too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+                    too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+                    too_long | overlong_2 | two_conts | overlong_3 | too_large,
+                    too_long | overlong_2 | two_conts | surrogate | too_large,
+                    too_long | overlong_2 | two_conts | surrogate | too_large,
+                    too_short, too_short, too_short, too_short
+                };
+
+                const __m256i nibble = _mm256_set1_epi8(0x0F);
+                const __m256i first = previous_bytes<1>(_input, _previous);
+                const __m256i pairs = _mm256_and_si256(
+                    _mm256_and_si256(nibble_lookup(first_high, _mm256_and_si256(_mm256_srli_epi16(first, 4), nibble)),
+                                     nibble_lookup(first_low, _mm256_and_si256(first, nibble))),
+                    nibble_lookup(second_high, _mm256_and_si256(_mm256_srli_epi16(_input, 4), nibble)));
+
+                //At least 0x80 where the byte two before starts a sequence of three or more or the byte three
+                //before one of four: such bytes must be continuations, which the pair tables report as two_conts.
+                const __m256i third = _mm256_subs_epu8(previous_bytes<2>(_input, _previous), _mm256_set1_epi8(0x60));
+                const __m256i fourth = _mm256_subs_epu8(previous_bytes<3>(_input, _previous), _mm256_set1_epi8(0x70));
+                const __m256i continued = _mm256_and_si256(_mm256_or_si256(third, fourth),
+                                                           _mm256_set1_epi8(static_cast<char>(0x80)));
+
+                return _mm256_xor_si256(continued, pairs);
+            }
+
+            //Nonzero if a sequence starting in the last three bytes of _input continues past them.
+            inline __m256i utf8_incomplete(__m256i _input) {
+                const __m256i limits = _mm256_setr_epi8(
+                    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, static_cast<char>(0xF0 - 1),
+                    static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+                return _mm256_subs_epu8(_input, limits);
+            }
+
+            inline bool validate_utf8(const std::uint8_t* _p, std::size_t _n) {
+                __m256i errors = _mm256_setzero_si256();
+                __m256i previous = _mm256_setzero_si256();
+                __m256i incomplete = _mm256_setzero_si256();
+                std::size_t i = 0;
+
+                for (; i + 32 <= _n; i += 32) {
+                    const __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_p + i));
+
+                    if (_mm256_movemask_epi8(input) == 0) {
+                        errors = _mm256_or_si256(errors, incomplete);
+                        incomplete = _mm256_setzero_si256();
+                    } else {
+                        errors = _mm256_or_si256(errors, utf8_errors(input, previous));
+                        incomplete = utf8_incomplete(input);
+                    }
+
+                    previous = input;
+                }
+
+                //The rest is padded with at least one byte of zeros, which ends a sequence left open too early.
+                std::uint8_t rest[32] = {};
+                if (i < _n) {
+                    std::memcpy(rest, _p + i, _n - i);
+                }
+                errors = _mm256_or_si256(errors, utf8_errors(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rest)),
+                                                             previous));
+
+                return _mm256_testz_si256(errors, errors);
+            }
+
+            /**
+             * @brief Decodes 8 bytes at a time as if every one of them started a sequence, in the 32-bit lanes of a
+             *        vector, and keeps the lanes of the bytes that do with the permutations of compress(). Words
+             *        holding the lead byte of a four-byte sequence, which needs a surrogate pair, are decoded one
+             *        sequence at a time instead.
+             */
+            inline std::size_t utf8_to_utf16_valid(const std::uint8_t* _p, std::size_t _n, char16_t* _out) {
+                char16_t* const first = _out;
+                std::size_t i = 0;
+
+                while (i + 16 <= _n) {
+                    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_p + i));
+
+                    if (_mm_movemask_epi8(bytes) == 0) {
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_out), _mm256_cvtepu8_epi16(bytes));
+                        _out += 16;
+                        i += 16;
+                        continue;
+                    }
+
+                    const __m256i lead = _mm256_cvtepu8_epi32(bytes);
+                    const __m256i continued = _mm256_cmpeq_epi32(_mm256_and_si256(lead, _mm256_set1_epi32(0xC0)),
+                                                                 _mm256_set1_epi32(0x80));
+                    const unsigned keep = ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(continued)))
+                                          & 0xFFu;
+
+                    if (_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(lead, _mm256_set1_epi32(0xEF))))
+                        & keep) {
+                        scalar_kernels::utf8_to_utf16_word(_p, i, _n, _out);
+                        i += 8;
+                        continue;
+                    }
+
+                    const __m256i low = _mm256_set1_epi32(0x3F);
+                    const __m256i second = _mm256_and_si256(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 1)), low);
+                    const __m256i third = _mm256_and_si256(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 2)), low);
+                    const __m256i fourth = _mm256_and_si256(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 3)), low);
+
+                    //The bits a lead byte contributes: 7 for ASCII, 5 for two bytes and 4 for three, whose fifth
+                    //bit is zero. Sequences of more bytes are shifted right by 6 bits less per byte.
+                    const __m256i two = _mm256_cmpgt_epi32(lead, _mm256_set1_epi32(0xBF));
+                    const __m256i three = _mm256_cmpgt_epi32(lead, _mm256_set1_epi32(0xDF));
+                    const __m256i lead_bits = _mm256_and_si256(lead, _mm256_blendv_epi8(_mm256_set1_epi32(0x7F),
+                                                                                        _mm256_set1_epi32(0x1F), two));
+                    const __m256i shift = _mm256_blendv_epi8(_mm256_set1_epi32(18),
+                                                             _mm256_blendv_epi8(_mm256_set1_epi32(12),
+                                                                                _mm256_set1_epi32(6), three), two);
+                    const __m256i high = _mm256_or_si256(_mm256_slli_epi32(lead_bits, 18),
+                                                         _mm256_slli_epi32(second, 12));
+                    const __m256i code_points = _mm256_srlv_epi32(
+                        _mm256_or_si256(high, _mm256_or_si256(_mm256_slli_epi32(third, 6), fourth)), shift);
+
+                    const __m256i front = _mm256_permutevar8x32_epi32(code_points, compress_permutation(keep));
+                    const __m256i units = _mm256_permute4x64_epi64(_mm256_packus_epi32(front, front), 0x08);
+
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(_out), _mm256_castsi256_si128(units));
+                    _out += __builtin_popcount(keep);
+                    i += 8;
+                }
+
+                return static_cast<std::size_t>(_out - first) + scalar_kernels::utf8_to_utf16_valid(_p + i, _n - i,
+                                                                                                      _out);
+            }
+
+            inline std::size_t utf8_to_utf16(const std::uint8_t* _p, std::size_t _n, char16_t* _out) {
+                return validate_utf8(_p, _n) ? utf8_to_utf16_valid(_p, _n, _out) : utf8_invalid;
+            }
+        } // namespace avx2_kernels
+        ITERATOR_BASED_FOR_SIMD_TARGET_POP
+
+        ITERATOR_BASED_FOR_SIMD_TARGET_PUSH(ITERATOR_BASED_FOR_SIMD_AVX512)
+        namespace avx512_kernels
+        {
+            constexpr std::size_t vector_bytes = 64;
+
+            typedef std::uint64_t wide_lanes __attribute__((vector_size(vector_bytes)));
+
+            /**
+             * @brief Returns the exact 64-bit products of the low 32 bits of the lanes of _a and _b, with vpmuludq.
+             *        The zero-masked form keeps GCC from warning about the undefined pass-through of the unmasked one.
+             */
+            inline wide_lanes multiply_low32(wide_lanes _a, wide_lanes _b) {
+                return reinterpret_cast<wide_lanes>(_mm512_maskz_mul_epu32(static_cast<__mmask8>(0xFF),
+                                                                           reinterpret_cast<__m512i>(_a),
+                                                                           reinterpret_cast<__m512i>(_b)));
+            }
+
+#include <IteratorBasedForSimdKernels.inc>
+
+            template <typename Index>
+            void gather(const float* _values, const Index* _indices, std::size_t _n, float* _out, bool _prefetch) {
+                std::size_t i = 0;
+
+                for (; i + 16 <= _n; i += 16) {
+                    if (_prefetch) {
+                        scalar_kernels::prefetch_indexed(_values, _indices, std::min(_n, i + gather_prefetch_distance),
+                                                         std::min(_n, i + gather_prefetch_distance + 16), false);
+                    }
+
+                    const __m512i indices = _mm512_loadu_si512(_indices + i);
+                    //The masked form, as the unmasked one trips -Wmaybe-uninitialized in the headers of GCC 12.
+                    _mm512_storeu_ps(_out + i, _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xffff, indices,
+                                                                        _values, 4));
+                }
+
+                scalar_kernels::gather(_values, _indices + i, _n - i, _out + i, false);
+            }
+
+            template <typename Index>
+            void gather(const std::int32_t* _values, const Index* _indices, std::size_t _n, std::int32_t* _out,
+                        bool _prefetch) {
+                std::size_t i = 0;
+
+                for (; i + 16 <= _n; i += 16) {
+                    if (_prefetch) {
+                        scalar_kernels::prefetch_indexed(_values, _indices, std::min(_n, i + gather_prefetch_distance),
+                                                         std::min(_n, i + gather_prefetch_distance + 16), false);
+                    }
+
+                    const __m512i indices = _mm512_loadu_si512(_indices + i);
+                    _mm512_storeu_si512(_out + i, _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xffff, indices,
+                                                                              _values, 4));
+                }
+
+                scalar_kernels::gather(_values, _indices + i, _n - i, _out + i, false);
+            }
+
+            template <typename Index>
+            void gather(const double* _values, const Index* _indices, std::size_t _n, double* _out, bool _prefetch) {
+                std::size_t i = 0;
+
+                for (; i + 8 <= _n; i += 8) {
+                    if (_prefetch) {
+                        scalar_kernels::prefetch_indexed(_values, _indices, std::min(_n, i + gather_prefetch_distance),
+                                                         std::min(_n, i + gather_prefetch_distance + 8), false);
+                    }
+
+                    const __m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_indices + i));
+                    _mm512_storeu_pd(_out + i, _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xff, indices,
+                                                                        _values, 8));
+                }
+
+                scalar_kernels::gather(_values, _indices + i, _n - i, _out + i, false);
+            }
+
+            //Scatters of one vector write overlapping lanes from the lowest to the highest, so the last of several
+            //equal indices wins, as in a sequential loop.
+            template <typename Index>
+            void scatter(const float* _values, const Index* _indices, std::size_t _n, float* _out, bool _prefetch) {
+                std::size_t i = 0;
+
+                for (; i + 16 <= _n; i += 16) {
+                    if (_prefetch) {
+                        scalar_kernels::prefetch_indexed(_out, _indices, std::min(_n, i + gather_prefetch_distance),
+                                                         std::min(_n, i + gather_prefetch_distance + 16), true);
+                    }
+
+                    const __m512i indices = _mm512_loadu_si512(_indices + i);
+                    _mm512_i32scatter_ps(_out, indices, _mm512_loadu_ps(_values + i), 4);
+                }
+
+                scalar_kernels::scatter(_values + i, _indices + i, _n - i, _out, false);
+            }
+
+            template <typename Index>
+            void scatter(const std::int32_t* _values, const Index* _indices, std::size_t _n, std::int32_t* _out,
+                         bool _prefetch) {
+                std::size_t i = 0;
+
+                for (; i + 16 <= _n; i += 16) {
+                    if (_prefetch) {
+                        scalar_kernels::prefetch_indexed(_out, _indices, std::min(_n, i + gather_prefetch_distance),
+                                                         std::min(_n, i + gather_prefetch_distance + 16), true);
+                    }
+
+                    const __m512i indices = _mm512_loadu_si512(_indices + i);
+                    _mm512_i32scatter_epi32(_out, indices, _mm512_loadu_si512(_values + i), 4);
+                }
+
+                scalar_kernels::scatter(_values + i, _indices + i, _n - i, _out, false);
+            }
+
+            template <typename Index>
+            void scatter(const double* _values, const Index* _indices, std::size_t _n, double* _out, bool _prefetch) {
+                std::size_t i = 0;
+
+                for (; i + 8 <= _n; i += 8) {
+                    if (_prefetch) {
+                        scalar_kernels::prefetch_indexed(_out, _indices, std::min(_n, i + gather_prefetch_distance),
+                                                         std::min(_n, i + gather_prefetch_distance + 8), true);
+                    }
+
+                    const __m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_indices + i));
+                    _mm512_i32scatter_pd(_out, indices, _mm512_loadu_pd(_values + i), 8);
+                }
+
+                scalar_kernels::scatter(_values + i, _indices + i, _n - i, _out, false);
+            }
+
+            inline void deinterleave(const float* _in, std::size_t _stride, std::size_t _n, float* _out) {
+                if (!is_gather_stride(_stride)) {
+                    return deinterleave<float>(_in, _stride, _n, _out);
+                }
+
+                const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+                const __m512i indices = _mm512_mullo_epi32(_mm512_set1_epi32(static_cast<int>(_stride)), lanes);
+                std::size_t i = 0;
+
+                for (; i + 16 <= _n; i += 16) {
+                    //The masked form, as the unmasked one trips -Wmaybe-uninitialized in the headers of GCC 12.
+                    _mm512_storeu_ps(_out + i, _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xffff, indices,
+                                                                        _in + i * _stride, 4));
+                }
+
+                scalar_kernels::deinterleave(_in + i * _stride, _stride, _n - i, _out + i);
+            }
+
+            inline void deinterleave(const std::int32_t* _in, std::size_t _stride, std::size_t _n,
+                                     std::int32_t* _out) {
+                if (!is_gather_stride(_stride)) {
+                    return deinterleave<std::int32_t>(_in, _stride, _n, _out);
+                }
+
+                const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+                const __m512i indices = _mm512_mullo_epi32(_mm512_set1_epi32(static_cast<int>(_stride)), lanes);
+                std::size_t i = 0;
+
+                for (; i + 16 <= _n; i += 16) {
+                    _mm512_storeu_si512(_out + i, _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xffff, indices,
+                                                                              _in + i * _stride, 4));
+                }
+
+                scalar_kernels::deinterleave(_in + i * _stride, _stride, _n - i, _out + i);
+            }
+
+            inline void deinterleave(const double* _in, std::size_t _stride, std::size_t _n, double* _out) {
+                if (!is_gather_stride(_stride)) {
+                    return deinterleave<double>(_in, _stride, _n, _out);
+                }
+
+                const __m256i indices = _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(_stride)),
+                                                          _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+                std::size_t i = 0;
+
+                for (; i + 8 <= _n; i += 8) {
+                    _mm512_storeu_pd(_out + i, _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xff, indices,
+                                                                        _in + i * _stride, 8));
+                }
+
+                scalar_kernels::deinterleave(_in + i * _stride, _stride, _n - i, _out + i);
+            }
+
+            //The number of the flags set among the first eight or sixteen.
+            inline unsigned keep_count(__m128i _flags) {
+                const __m128i sums = _mm_sad_epu8(_flags, _mm_setzero_si128());
+                return static_cast<unsigned>(_mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4));
+            }
+
+            inline std::size_t compress(const float* _in, const std::uint8_t* _keep, std::size_t _n, float* _out) {
+                std::size_t i = 0;
+                std::size_t kept = 0;
+
+                for (; i + 16 <= _n; i += 16) {
+                    const __m128i flags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_keep + i));
+                    //Zero-masked, as the unmasked form makes GCC warn about its undefined pass-through.
+                    const __m512i wide = _mm512_maskz_cvtepu8_epi32(static_cast<__mmask16>(0xFFFF), flags);
+                    const unsigned count = keep_count(flags);
+                    const __m512 front = _mm512_maskz_compress_ps(_mm512_test_epi32_mask(wide, wide),
+                                                                  _mm512_loadu_ps(_in + i));
+
+                    _mm512_mask_storeu_ps(_out + kept, static_cast<__mmask16>((1u << count) - 1), front);
+                    kept += count;
+                }
+
+                return kept + scalar_kernels::compress(_in + i, _keep + i, _n - i, _out + kept);
+            }
+
+            inline std::size_t compress(const std::int32_t* _in, const std::uint8_t* _keep, std::size_t _n,
+                                        std::int32_t* _out) {
+                std::size_t i = 0;
+                std::size_t kept = 0;
+
+                for (; i + 16 <= _n; i += 16) {
+                    const __m128i flags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_keep + i));
+                    const __m512i wide = _mm512_maskz_cvtepu8_epi32(static_cast<__mmask16>(0xFFFF), flags);
+                    const unsigned count = keep_count(flags);
+                    const __m512i front = _mm512_maskz_compress_epi32(_mm512_test_epi32_mask(wide, wide),
+                                                                      _mm512_loadu_si512(_in + i));
+
+                    _mm512_mask_storeu_epi32(_out + kept, static_cast<__mmask16>((1u << count) - 1), front);
+                    kept += count;
+                }
+
+                return kept + scalar_kernels::compress(_in + i, _keep + i, _n - i, _out + kept);
+            }
+
+            inline std::size_t compress(const double* _in, const std::uint8_t* _keep, std::size_t _n, double* _out) {
+                std::size_t i = 0;
+                std::size_t kept = 0;
+
+                for (; i + 8 <= _n; i += 8) {
+                    const __m128i flags = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(_keep + i));
+                    const __m512i wide = _mm512_maskz_cvtepu8_epi64(static_cast<__mmask8>(0xFF), flags);
+                    const unsigned count = keep_count(flags);
+                    const __m512d front = _mm512_maskz_compress_pd(_mm512_test_epi64_mask(wide, wide),
+                                                                   _mm512_loadu_pd(_in + i));
+
+                    _mm512_mask_storeu_pd(_out + kept, static_cast<__mmask8>((1u << count) - 1), front);
+                    kept += count;
+                }
+
+                return kept + scalar_kernels::compress(_in + i, _keep + i, _n - i, _out + kept);
+            }
+
+            //AVX-512 validates and transcodes UTF-8 with the vectors of AVX2, the shuffles of the wider vectors being
+            //limited to their 128-bit lanes in the same way.
+            inline bool validate_utf8(const std::uint8_t* _p, std::size_t _n) {
+                return avx2_kernels::validate_utf8(_p, _n);
+            }
+
+            inline std::size_t utf8_to_utf16(const std::uint8_t* _p, std::size_t _n, char16_t* _out) {
+                return avx2_kernels::utf8_to_utf16(_p, _n, _out);
+            }
+        } // namespace avx512_kernels
+        ITERATOR_BASED_FOR_SIMD_TARGET_POP
+
+#define ITERATOR_BASED_FOR_SIMD_X86_CASES(call) \
+            case instruction_set::sse2: return sse2_kernels::call; \
+            case instruction_set::avx2: return avx2_kernels::call; \
+            case instruction_set::avx512: return avx512_kernels::call;
+#else
+#define ITERATOR_BASED_FOR_SIMD_X86_CASES(call)
+#endif
+
+#if ITERATOR_BASED_FOR_SIMD_NEON
+        namespace neon_kernels
+        {
+            constexpr std::size_t vector_bytes = 16;
+
+            typedef std::uint64_t wide_lanes __attribute__((vector_size(vector_bytes)));
+
+            /**
+             * @brief Returns the exact 64-bit products of the low 32 bits of the lanes of _a and _b, which the
+             *        compiler makes one widening multiplication.
+             */
+            inline wide_lanes multiply_low32(wide_lanes _a, wide_lanes _b) {
+                return (_a & UINT64_C(0xFFFFFFFF)) * (_b & UINT64_C(0xFFFFFFFF));
+            }
+
+#include <IteratorBasedForSimdKernels.inc>
+        } // namespace neon_kernels
+
+#define ITERATOR_BASED_FOR_SIMD_NEON_CASES(call) \
+            case instruction_set::neon: return neon_kernels::call;
+#else
+#define ITERATOR_BASED_FOR_SIMD_NEON_CASES(call)
+#endif
+
+//Calls the kernel call of the active instruction set.
+#define ITERATOR_BASED_FOR_SIMD_DISPATCH(call) \
+        switch (active_instruction_set()) { \
+            ITERATOR_BASED_FOR_SIMD_X86_CASES(call) \
+            ITERATOR_BASED_FOR_SIMD_NEON_CASES(call) \
+            default: return scalar_kernels::call; \
+        }
+
+        /**
+         * @brief The element type of the contiguous iterator Iterator, const for constant iterators.
+         */
+        template <typename Iterator>
+        using element_t = typename std::remove_reference<typename std::iterator_traits<Iterator>::reference>::type;
+
+        template <typename Iterator, typename Sentinel>
+        struct is_kernel_range : std::integral_constant<bool,
+                is_contiguous_iterator<Iterator>::value
+                && is_sized_sentinel_for<Sentinel, Iterator>::value
+                && is_element<typename std::remove_const<element_t<Iterator>>::type>::value> {
+        };
+
+        /**
+         * @brief Assigns _value to every element of _range.
+         */
+        template <typename Iterator, typename Sentinel,
+                  typename std::enable_if<is_kernel_range<Iterator, Sentinel>::value, int>::type = 0>
+        void fill(const iterator_range<Iterator, Sentinel>& _range, element_t<Iterator> _value) {
+            element_t<Iterator>* p = IteratorBasedForImpl::to_address(_range.begin());
+            const std::size_t n = _range.size();
+
+            ITERATOR_BASED_FOR_SIMD_DISPATCH(fill(p, n, _value))
+        }
+
+        /**
+         * @brief Writes _f applied to every element of _range to the contiguous output starting at _out and returns
+         *        the end of the output. _f is called either as _out[i] = _f(x) for each element, or, if the output
+         *        has the element type of the range and _f accepts a vector of elements by reference and returns
+         *        void, as _f(x) on vectors of elements which it updates in place. A generic lambda using only
+         *        arithmetic operators, such as [](auto& x) { x = x * 2 + 1; }, is executed on whole vectors that way.
+         */
+        template <typename Iterator, typename Sentinel, typename OutputIterator, typename F,
+                  typename std::enable_if<is_kernel_range<Iterator, Sentinel>::value
+                                          && is_contiguous_iterator<OutputIterator>::value, int>::type = 0>
+        OutputIterator transform(const iterator_range<Iterator, Sentinel>& _range, OutputIterator _out, F _f) {
+            const typename std::remove_const<element_t<Iterator>>::type* in =
+                    IteratorBasedForImpl::to_address(_range.begin());
+            element_t<OutputIterator>* out = IteratorBasedForImpl::to_address(_out);
+            const std::size_t n = _range.size();
+
+            [&]() { ITERATOR_BASED_FOR_SIMD_DISPATCH(transform(in, out, n, _f)) }();
+            return _out + static_cast<typename std::iterator_traits<OutputIterator>::difference_type>(n);
+        }
+
+        /**
+         * @brief Returns the sum of the elements of _range. Floating-point elements are added in an unspecified
+         *        order, so the result may differ from a sequential sum by rounding.
+         */
+        template <typename Iterator, typename Sentinel,
+                  typename std::enable_if<is_kernel_range<Iterator, Sentinel>::value, int>::type = 0>
+        typename sum_type<typename std::remove_const<element_t<Iterator>>::type>::type sum(
+                const iterator_range<Iterator, Sentinel>& _range) {
+            const typename std::remove_const<element_t<Iterator>>::type* p =
+                    IteratorBasedForImpl::to_address(_range.begin());
+            const std::size_t n = _range.size();
+
+            ITERATOR_BASED_FOR_SIMD_DISPATCH(sum(p, n))
+        }
+
+        /**
+         * @brief Returns the smallest and the largest element of the non-empty range _range. The result is
+         *        unspecified if floating-point elements include NaN.
+         */
+        template <typename Iterator, typename Sentinel,
+                  typename std::enable_if<is_kernel_range<Iterator, Sentinel>::value, int>::type = 0>
+        std::pair<typename std::remove_const<element_t<Iterator>>::type,
+                  typename std::remove_const<element_t<Iterator>>::type> min_max(
+                const iterator_range<Iterator, Sentinel>& _range) {
+            const typename std::remove_const<element_t<Iterator>>::type* p =
+                    IteratorBasedForImpl::to_address(_range.begin());
+            const std::size_t n = _range.size();
+
+            ITERATOR_BASED_FOR_SIMD_DISPATCH(min_max(p, n))
+        }
+
+        /**
+         * @brief Returns an iterator to the first element of _range equal to _value, or the end of the range if
+         *        there is none.
+         */
+        template <typename Iterator, typename Sentinel,
+                  typename std::enable_if<is_kernel_range<Iterator, Sentinel>::value, int>::type = 0>
+        Iterator find(const iterator_range<Iterator, Sentinel>& _range,
+                      typename std::remove_const<element_t<Iterator>>::type _value) {
+            const typename std::remove_const<element_t<Iterator>>::type* p =
+                    IteratorBasedForImpl::to_address(_range.begin());
+            const std::size_t n = _range.size();
+            const std::size_t index = [&]() -> std::size_t { ITERATOR_BASED_FOR_SIMD_DISPATCH(find(p, n, _value)) }();
+
+            return _range.begin() + static_cast<typename std::iterator_traits<Iterator>::difference_type>(index);
+        }
+
+        /**
+         * @brief Returns an iterator to the first element of _range not equal to _value, or the end of the range if
+         *        there is none, so that a run of equal elements is skipped a vector at a time.
+         */
+        template <typename Iterator, typename Sentinel,
+                  typename std::enable_if<is_kernel_range<Iterator, Sentinel>::value, int>::type = 0>
+        Iterator find_not(const iterator_range<Iterator, Sentinel>& _range,
+                          typename std::remove_const<element_t<Iterator>>::type _value) {
+            const typename std::remove_const<element_t<Iterator>>::type* p =
+                    IteratorBasedForImpl::to_address(_range.begin());
+            const std::size_t n = _range.size();
+            const std::size_t index = [&]() -> std::size_t {
+                ITERATOR_BASED_FOR_SIMD_DISPATCH(find_not(p, n, _value))
+            }();
+
+            return _range.begin() + static_cast<typename std::iterator_traits<Iterator>::difference_type>(index);
+        }
+
+        /**
+         * @brief Returns the number of elements of _range equal to _value.
+         */
+        template <typename Iterator, typename Sentinel,
+                  typename std::enable_if<is_kernel_range<Iterator, Sentinel>::value, int>::type = 0>
+        std::size_t count(const iterator_range<Iterator, Sentinel>& _range,
+                          typename std::remove_const<element_t<Iterator>>::type _value) {
+            const typename std::remove_const<element_t<Iterator>>::type* p =
+                    IteratorBasedForImpl::to_address(_range.begin());
+            const std::size_t n = _range.size();
+
+            ITERATOR_BASED_FOR_SIMD_DISPATCH(count(p, n, _value))
+        }
+
+        template <typename Iterator1, typename Sentinel1, typename Iterator2, typename Sentinel2,
+                  typename OutputIterator>
+        struct is_set_kernel_range : std::integral_constant<bool,
+                is_contiguous_iterator<Iterator1>::value && is_sized_sentinel_for<Sentinel1, Iterator1>::value
+                && is_contiguous_iterator<Iterator2>::value && is_sized_sentinel_for<Sentinel2, Iterator2>::value
+                && is_contiguous_iterator<OutputIterator>::value
+                && is_set_element<typename std::remove_const<element_t<Iterator1>>::type>::value
+                && std::is_same<typename std::remove_const<element_t<Iterator1>>::type,
+                                typename std::remove_const<element_t<Iterator2>>::type>::value
+                && std::is_same<typename std::remove_const<element_t<Iterator1>>::type,
+                                element_t<OutputIterator>>::value> {
+        };
+
+        /**
+         * @brief Writes the elements present in both _a and _b to the contiguous output starting at _out, in ascending
+         *        order, and returns the end of the output, which needs room for the smaller of the inputs.
+         *
+         *        The inputs are strictly increasing, as posting lists are. Inputs of similar sizes are compared a
+         *        vector of elements against another at a time. When one of them is more than set_gallop_ratio times
+         *        larger, each element of the smaller one is searched in it by galloping, which skips the runs of the
+         *        larger input that cannot match.
+         */
+        template <typename Iterator1, typename Sentinel1, typename Iterator2, typename Sentinel2,
+                  typename OutputIterator,
+                  typename std::enable_if<is_set_kernel_range<Iterator1, Sentinel1, Iterator2, Sentinel2,
+                                                              OutputIterator>::value, int>::type = 0>
+        OutputIterator set_intersection(const iterator_range<Iterator1, Sentinel1>& _a,
+                                        const iterator_range<Iterator2, Sentinel2>& _b, OutputIterator _out) {
+            const element_t<OutputIterator>* a = IteratorBasedForImpl::to_address(_a.begin());
+            const element_t<OutputIterator>* b = IteratorBasedForImpl::to_address(_b.begin());
+            element_t<OutputIterator>* out = IteratorBasedForImpl::to_address(_out);
+            std::size_t na = _a.size();
+            std::size_t nb = _b.size();
+
+            if (na > nb) {
+                std::swap(a, b);
+                std::swap(na, nb);
+            }
+
+            const std::size_t n = [&]() -> std::size_t {
+                if (nb / set_gallop_ratio > na) {
+                    return scalar_kernels::set_intersection_galloping(a, na, b, nb, out);
+                }
+
+                ITERATOR_BASED_FOR_SIMD_DISPATCH(set_intersection(a, na, b, nb, out))
+            }();
+
+            return _out + static_cast<typename std::iterator_traits<OutputIterator>::difference_type>(n);
+        }
+
+        /**
+         * @brief Writes the elements of _a that are not in _b to the contiguous output starting at _out, in ascending
+         *        order, and returns the end of the output, which needs room for _a. Like set_intersection(), it
+         *        takes strictly increasing inputs and compares vectors of elements or gallops depending on their
+         *        sizes. Where _b is the much smaller input, the runs of _a between its elements are copied as blocks.
+         */
+        template <typename Iterator1, typename Sentinel1, typename Iterator2, typename Sentinel2,
+                  typename OutputIterator,
+                  typename std::enable_if<is_set_kernel_range<Iterator1, Sentinel1, Iterator2, Sentinel2,
+                                                              OutputIterator>::value, int>::type = 0>
+        OutputIterator set_difference(const iterator_range<Iterator1, Sentinel1>& _a,
+                                      const iterator_range<Iterator2, Sentinel2>& _b, OutputIterator _out) {
+            const element_t<OutputIterator>* a = IteratorBasedForImpl::to_address(_a.begin());
+            const element_t<OutputIterator>* b = IteratorBasedForImpl::to_address(_b.begin());
+            element_t<OutputIterator>* out = IteratorBasedForImpl::to_address(_out);
+            const std::size_t na = _a.size();
+            const std::size_t nb = _b.size();
+
+            const std::size_t n = [&]() -> std::size_t {
+                if (nb / set_gallop_ratio > na) {
+                    return scalar_kernels::set_difference_galloping(a, na, b, nb, out);
+                }
+
+                if (na / set_gallop_ratio > nb) {
+                    return scalar_kernels::merge_galloping(a, na, b, nb, out, false);
+                }
+
+                ITERATOR_BASED_FOR_SIMD_DISPATCH(set_difference(a, na, b, nb, out))
+            }();
+
+            return _out + static_cast<typename std::iterator_traits<OutputIterator>::difference_type>(n);
+        }
+
+        /**
+         * @brief Writes the elements present in _a or _b, once each, to the contiguous output starting at _out, in
+         *        ascending order, and returns the end of the output, which needs room for both inputs. The inputs
+         *        are strictly increasing. Inputs of similar sizes are merged without branches; otherwise the runs of
+         *        the larger input between two elements of the smaller one are copied as blocks.
+         */
+        template <typename Iterator1, typename Sentinel1, typename Iterator2, typename Sentinel2,
+                  typename OutputIterator,
+                  typename std::enable_if<is_set_kernel_range<Iterator1, Sentinel1, Iterator2, Sentinel2,
+                                                              OutputIterator>::value, int>::type = 0>
+        OutputIterator set_union(const iterator_range<Iterator1, Sentinel1>& _a,
+                                 const iterator_range<Iterator2, Sentinel2>& _b, OutputIterator _out) {
+            const element_t<OutputIterator>* a = IteratorBasedForImpl::to_address(_a.begin());
+            const element_t<OutputIterator>* b = IteratorBasedForImpl::to_address(_b.begin());
+            element_t<OutputIterator>* out = IteratorBasedForImpl::to_address(_out);
+            std::size_t na = _a.size();
+            std::size_t nb = _b.size();
+
+            if (na > nb) {
+                std::swap(a, b);
+                std::swap(na, nb);
+            }
+
+            const std::size_t n = nb / set_gallop_ratio > na ? scalar_kernels::merge_galloping(b, nb, a, na, out, true)
+                                                             : scalar_kernels::set_union(a, na, b, nb, out);
+
+            return _out + static_cast<typename std::iterator_traits<OutputIterator>::difference_type>(n);
+        }
+
+        /**
+         * @brief Returns the index of the first of the _n bytes at _p that equals any of the _needle_count bytes at
+         *        _needles, or _n if there is none.
+         */
+        inline std::size_t find_any(const std::uint8_t* _p, std::size_t _n, const std::uint8_t* _needles,
+                                    std::size_t _needle_count) {
+            if (_needle_count > find_any_vector_needles) {
+                return scalar_kernels::find_any(_p, _n, _needles, _needle_count);
+            }
+
+            ITERATOR_BASED_FOR_SIMD_DISPATCH(find_any(_p, _n, _needles, _needle_count))
+        }
+
+        /**
+         * @brief Checks whether the _n bytes at _p are valid UTF-8.
+         */
+        inline bool validate_utf8(const std::uint8_t* _p, std::size_t _n) {
+            ITERATOR_BASED_FOR_SIMD_DISPATCH(validate_utf8(_p, _n))
+        }
+
+        /**
+         * @brief Writes the UTF-16 code units of the _n bytes of UTF-8 at _p to _out, which has room for _n of them,
+         *        and returns their number, or utf8_invalid if the bytes are not valid UTF-8.
+         */
+        inline std::size_t utf8_to_utf16(const std::uint8_t* _p, std::size_t _n, char16_t* _out) {
+            ITERATOR_BASED_FOR_SIMD_DISPATCH(utf8_to_utf16(_p, _n, _out))
+        }
+
+        /**
+         * @brief Reverses the order of the bytes of each of the _n words of _width bytes at _in, writing them to
+         *        _out, which may be _in. Widths of 2, 4 and 8 bytes swap whole vectors with a byte shuffle, pshufb on
+         *        x86 and rev on ARM; words of other widths are copied unchanged.
+         */
+        inline void byteswap(const std::uint8_t* _in, std::size_t _width, std::size_t _n, std::uint8_t* _out) {
+            ITERATOR_BASED_FOR_SIMD_DISPATCH(byteswap(_in, _width, _n, _out))
+        }
+
+        /**
+         * @brief Writes the scalar_kernels::mix64() hash of each of the _n keys at _keys to _out, a vector of keys at
+         *        a time. Instruction sets without a 64-bit vector multiplication, AVX2 and AVX-512F among them, make
+         *        it of three 32-bit ones.
+         */
+        inline void hash64(const std::uint64_t* _keys, std::size_t _n, std::uint64_t* _out) {
+            ITERATOR_BASED_FOR_SIMD_DISPATCH(hash64(_keys, _n, _out))
+        }
+
+        /**
+         * @brief Writes the four words of Philox4x32 of each of the _n counters _block, _block + 1, ... to _out, which
+         *        has room for 4 * _n words, under the key _key. The counters hold the block in their low and _stream
+         *        in their high 64 bits. Encrypts a vector of counters at a time, one 32-bit word per 64-bit lane.
+         */
+        inline void philox4x32(std::uint64_t _key, std::uint64_t _stream, std::uint64_t _block, std::size_t _n,
+                               std::uint32_t* _out) {
+            ITERATOR_BASED_FOR_SIMD_DISPATCH(philox4x32(_key, _stream, _block, _n, _out))
+        }
+
+        /**
+         * @brief Writes the running sums of the _n integers at _in, starting from _carry, to _out, which may be _in,
+         *        and returns _carry plus all of them. Each sum includes the integer at its position if _inclusive is
+         *        set and stops before it otherwise. A vector is scanned in registers by log2(lanes) additions of itself
+         *        shifted up by 1, 2, 4... lanes, so only the addition of the carry links one vector to the next.
+         */
+        template <typename T, typename std::enable_if<is_scan_element<T>::value, int>::type = 0>
+        T prefix_sum(const T* _in, std::size_t _n, T _carry, bool _inclusive, T* _out) {
+            ITERATOR_BASED_FOR_SIMD_DISPATCH(prefix_sum(_in, _n, _carry, _inclusive, _out))
+        }
+
+        /**
+         * @brief Checks whether the non-temporal stores of stream_copy() bypass the cache on this platform. Where they
+         *        do not, stream_copy() is a plain memcpy.
+         */
+        inline constexpr bool has_streaming_stores() {
+            return ITERATOR_BASED_FOR_SIMD_X86 != 0;
+        }
+
+#if ITERATOR_BASED_FOR_SIMD_X86
+        ITERATOR_BASED_FOR_SIMD_TARGET_PUSH(ITERATOR_BASED_FOR_SIMD_SSE2)
+
+        /**
+         * @brief Copies _bytes bytes from _source to the non-overlapping _destination with non-temporal stores, which
+         *        write to memory without first reading the destination into the cache and without evicting the data
+         *        the cache holds. Ends with a store fence, so the copy is visible to other threads like a memcpy.
+         */
+        inline void stream_copy(void* _destination, const void* _source, std::size_t _bytes) {
+            unsigned char* out = static_cast<unsigned char*>(_destination);
+            const unsigned char* in = static_cast<const unsigned char*>(_source);
+            const std::size_t head = (16 - reinterpret_cast<std::uintptr_t>(out) % 16) % 16;
+
+            if (_bytes < head + 16) {
+                std::memcpy(out, in, _bytes);
+                return;
+            }
+
+            std::memcpy(out, in, head);
+            out += head;
+            in += head;
+            _bytes -= head;
+
+            for (; _bytes >= 64; _bytes -= 64, out += 64, in += 64) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16));
+                __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 32));
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 48));
+                _mm_stream_si128(reinterpret_cast<__m128i*>(out), a);
+                _mm_stream_si128(reinterpret_cast<__m128i*>(out + 16), b);
+                _mm_stream_si128(reinterpret_cast<__m128i*>(out + 32), c);
+                _mm_stream_si128(reinterpret_cast<__m128i*>(out + 48), d);
+            }
+
+            for (; _bytes >= 16; _bytes -= 16, out += 16, in += 16) {
+                _mm_stream_si128(reinterpret_cast<__m128i*>(out),
+                                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+            }
+
+            _mm_sfence();
+            std::memcpy(out, in, _bytes);
+        }
+
+        ITERATOR_BASED_FOR_SIMD_TARGET_POP
+#else
+        inline void stream_copy(void* _destination, const void* _source, std::size_t _bytes) {
+            std::memcpy(_destination, _source, _bytes);
+        }
+#endif
+
+        template <typename ValueIterator, typename ValueSentinel, typename IndexIterator, typename IndexSentinel>
+        struct is_gather_kernel_range : std::integral_constant<bool,
+                is_contiguous_iterator<ValueIterator>::value
+                && is_sized_sentinel_for<ValueSentinel, ValueIterator>::value
+                && is_contiguous_iterator<IndexIterator>::value
+                && is_sized_sentinel_for<IndexSentinel, IndexIterator>::value
+                && is_gather_element<typename std::remove_const<element_t<ValueIterator>>::type,
+                                     typename std::remove_const<element_t<IndexIterator>>::type>::value> {
+        };
+
+        /**
+         * @brief Checks whether the indices of an array of _size elements fit the signed 32-bit lanes of the gather
+         *        and scatter instructions, which holds for unsigned indices only if the array is small enough.
+         */
+        inline bool fits_gather_lanes(std::size_t _size) {
+            return _size <= static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max());
+        }
+
+        /**
+         * @brief Writes _values[_indices[i]] to _out[i] for every index of _indices and returns the end of the
+         *        contiguous output. The elements are loaded with the gather instructions of AVX2 or AVX-512 where
+         *        available, and when _values is larger than gather_prefetch_bytes the elements needed a few vectors
+         *        later are prefetched as well. Every index must be smaller than the size of _values.
+         */
+        template <typename ValueIterator, typename ValueSentinel, typename IndexIterator, typename IndexSentinel,
+                  typename OutputIterator,
+                  typename std::enable_if<is_gather_kernel_range<ValueIterator, ValueSentinel, IndexIterator,
+                                                                 IndexSentinel>::value
+                                          && is_contiguous_iterator<OutputIterator>::value
+                                          && std::is_same<typename std::remove_const<element_t<ValueIterator>>::type,
+                                                          element_t<OutputIterator>>::value, int>::type = 0>
+        OutputIterator gather(const iterator_range<ValueIterator, ValueSentinel>& _values,
+                              const iterator_range<IndexIterator, IndexSentinel>& _indices, OutputIterator _out) {
+            const element_t<OutputIterator>* values = IteratorBasedForImpl::to_address(_values.begin());
+            const typename std::remove_const<element_t<IndexIterator>>::type* indices =
+                    IteratorBasedForImpl::to_address(_indices.begin());
+            element_t<OutputIterator>* out = IteratorBasedForImpl::to_address(_out);
+            const std::size_t n = _indices.size();
+            const bool prefetch = _values.size() * sizeof(*values) > gather_prefetch_bytes;
+
+            [&]() {
+                if (!fits_gather_lanes(_values.size())) {
+                    return scalar_kernels::gather(values, indices, n, out, prefetch);
+                }
+
+                ITERATOR_BASED_FOR_SIMD_DISPATCH(gather(values, indices, n, out, prefetch))
+            }();
+
+            return _out + static_cast<typename std::iterator_traits<OutputIterator>::difference_type>(n);
+        }
+
+        /**
+         * @brief Writes _values[i] to _out[_indices[i]] for every element of _values, so that of several equal
+         *        indices the last one wins. Uses the scatter instructions of AVX-512 where available and prefetches
+         *        the destinations when _out is larger than gather_prefetch_bytes. Throws std::invalid_argument if
+         *        _values and _indices differ in size; every index must be smaller than the size of _out.
+         */
+        template <typename ValueIterator, typename ValueSentinel, typename IndexIterator, typename IndexSentinel,
+                  typename OutputIterator, typename OutputSentinel,
+                  typename std::enable_if<is_gather_kernel_range<ValueIterator, ValueSentinel, IndexIterator,
+                                                                 IndexSentinel>::value
+                                          && is_kernel_range<OutputIterator, OutputSentinel>::value
+                                          && std::is_same<typename std::remove_const<element_t<ValueIterator>>::type,
+                                                          element_t<OutputIterator>>::value, int>::type = 0>
+        void scatter(const iterator_range<ValueIterator, ValueSentinel>& _values,
+                     const iterator_range<IndexIterator, IndexSentinel>& _indices,
+                     const iterator_range<OutputIterator, OutputSentinel>& _out) {
+            const element_t<OutputIterator>* values = IteratorBasedForImpl::to_address(_values.begin());
+            const typename std::remove_const<element_t<IndexIterator>>::type* indices =
+                    IteratorBasedForImpl::to_address(_indices.begin());
+            element_t<OutputIterator>* out = IteratorBasedForImpl::to_address(_out.begin());
+            const std::size_t n = _values.size();
+            const bool prefetch = _out.size() * sizeof(*out) > gather_prefetch_bytes;
+
+            if (_indices.size() != n) {
+                throw std::invalid_argument("simd::scatter: the values and the indices differ in size");
+            }
+
+            if (!fits_gather_lanes(_out.size())) {
+                return scalar_kernels::scatter(values, indices, n, out, prefetch);
+            }
+
+            ITERATOR_BASED_FOR_SIMD_DISPATCH(scatter(values, indices, n, out, prefetch))
+        }
+
+        /**
+         * @brief Writes every _stride-th element of _range, starting with its first one, to the contiguous output and
+         *        returns its end, such as one channel of interleaved RGB pixels or IQ samples. Strides of 2, 3 and 4
+         *        are de-interleaved a vector at a time by shuffling the vectors that hold the elements, and from
+         *        deinterleave_gather_stride on the elements are loaded with the gather instructions of AVX2 or
+         *        AVX-512, where available. A _stride of zero is treated as one.
+         */
+        template <typename Iterator, typename Sentinel, typename OutputIterator,
+                  typename std::enable_if<is_kernel_range<Iterator, Sentinel>::value
+                                          && is_contiguous_iterator<OutputIterator>::value
+                                          && std::is_same<typename std::remove_const<element_t<Iterator>>::type,
+                                                          element_t<OutputIterator>>::value, int>::type = 0>
+        OutputIterator deinterleave(const iterator_range<Iterator, Sentinel>& _range, std::size_t _stride,
+                                    OutputIterator _out) {
+            const element_t<OutputIterator>* in = IteratorBasedForImpl::to_address(_range.begin());
+            element_t<OutputIterator>* out = IteratorBasedForImpl::to_address(_out);
+            const std::size_t stride = _stride ? _stride : 1;
+            const std::size_t n = (_range.size() + stride - 1) / stride;
+
+            [&]() {
+                if (stride == 1) {
+                    return static_cast<void>(std::copy(in, in + n, out));
+                }
+
+                ITERATOR_BASED_FOR_SIMD_DISPATCH(deinterleave(in, stride, n, out))
+            }();
+
+            return _out + static_cast<typename std::iterator_traits<OutputIterator>::difference_type>(n);
+        }
+
+        /**
+         * @brief Writes the transpose of the row-major _rows x _columns matrix _range to the row-major
+         *        _columns x _rows matrix at the contiguous output, such as samples stored by row to the columns a
+         *        model reads, and returns the end of the output. The matrix is split recursively into blocks that
+         *        fit the first level cache, and those into tiles of as many rows as a vector has lanes, up to 16,
+         *        which are transposed in registers. The output must not overlap the range. Throws
+         *        std::invalid_argument if the range does not hold _rows * _columns elements.
+         */
+        template <typename Iterator, typename Sentinel, typename OutputIterator,
+                  typename std::enable_if<is_kernel_range<Iterator, Sentinel>::value
+                                          && is_contiguous_iterator<OutputIterator>::value
+                                          && std::is_same<typename std::remove_const<element_t<Iterator>>::type,
+                                                          element_t<OutputIterator>>::value, int>::type = 0>
+        OutputIterator transpose(const iterator_range<Iterator, Sentinel>& _range, std::size_t _rows,
+                                 std::size_t _columns, OutputIterator _out) {
+            const element_t<OutputIterator>* in = IteratorBasedForImpl::to_address(_range.begin());
+            element_t<OutputIterator>* out = IteratorBasedForImpl::to_address(_out);
+            const std::size_t n = _range.size();
+
+            if (_columns != 0 ? n / _columns != _rows || n % _columns != 0 : n != 0) {
+                throw std::invalid_argument("simd::transpose: the range does not hold rows * columns elements");
+            }
+
+            [&]() {
+                if (n != 0) {
+                    ITERATOR_BASED_FOR_SIMD_DISPATCH(transpose(in, _rows, _columns, out))
+                }
+            }();
+
+            return _out + static_cast<typename std::iterator_traits<OutputIterator>::difference_type>(n);
+        }
+
+        /**
+         * @brief Checks whether compress() moves the kept elements a vector at a time with the active instruction set,
+         *        which AVX2 and AVX-512 do. Otherwise it copies them one at a time.
+         */
+        inline bool has_vector_compress() {
+            const instruction_set active = active_instruction_set();
+            return active == instruction_set::avx2 || active == instruction_set::avx512;
+        }
+
+        /**
+         * @brief Writes the elements of _range whose flag in _keep is set to the contiguous output, in order, and
+         *        returns the end of the output. _keep holds a 0 or a 1 for every element of the range. AVX2 moves the
+         *        kept elements of a vector to its front with a permutation looked up by their flags, and AVX-512 with
+         *        its compress instructions; both store only the kept lanes. The output may begin at or before the
+         *        range, as when a range is compacted in place, but must not otherwise overlap it.
+         */
+        template <typename Iterator, typename Sentinel, typename OutputIterator,
+                  typename std::enable_if<is_kernel_range<Iterator, Sentinel>::value
+                                          && is_contiguous_iterator<OutputIterator>::value
+                                          && std::is_same<typename std::remove_const<element_t<Iterator>>::type,
+                                                          element_t<OutputIterator>>::value, int>::type = 0>
+        OutputIterator compress(const iterator_range<Iterator, Sentinel>& _range, const std::uint8_t* _keep,
+                                OutputIterator _out) {
+            const element_t<OutputIterator>* in = IteratorBasedForImpl::to_address(_range.begin());
+            element_t<OutputIterator>* out = IteratorBasedForImpl::to_address(_out);
+            const std::size_t n = _range.size();
+
+            const std::size_t kept = [&]() -> std::size_t {
+                ITERATOR_BASED_FOR_SIMD_DISPATCH(compress(in, _keep, n, out))
+            }();
+
+            return _out + static_cast<typename std::iterator_traits<OutputIterator>::difference_type>(kept);
+        }
+
+        /**
+         * @brief Appends the elements of _range greater than _bound, or less than it if _greater is false, to the
+         *        _written elements at _out, stopping when the output might exceed _room elements, and returns the
+         *        number of elements of the range consumed. Vectors without such elements, most of them once the bound
+         *        is tight, cost a comparison each; the others are compressed into the output, which therefore needs
+         *        room for a whole vector, so fewer elements than _room may be written before it stops.
+         */
+        template <typename Iterator, typename Sentinel,
+                  typename std::enable_if<is_kernel_range<Iterator, Sentinel>::value, int>::type = 0>
+        std::size_t select_beyond(const iterator_range<Iterator, Sentinel>& _range,
+                                  typename std::remove_const<element_t<Iterator>>::type _bound, bool _greater,
+                                  typename std::remove_const<element_t<Iterator>>::type* _out, std::size_t _room,
+                                  std::size_t& _written) {
+            const typename std::remove_const<element_t<Iterator>>::type* p =
+                    IteratorBasedForImpl::to_address(_range.begin());
+            const std::size_t n = _range.size();
+
+            ITERATOR_BASED_FOR_SIMD_DISPATCH(select_beyond(p, n, _bound, _greater, _out, _room, _written))
+        }
+
+        /**
+         * @brief Base of the nodes of element-wise expressions over contiguous ranges. Every node evaluates the
+         *        elements at an index either one at a time or a whole vector at a time, so assign() computes an
+         *        expression such as r1 * 2.0f + r2 in a single pass without temporaries.
+         */
+        struct expression_node { };
+
+        /**
+         * @brief Leaf of an expression that reads the elements of a contiguous range.
+         */
+        template <typename T>
+        class range_operand : public expression_node {
+        private:
+            const T* m_data;
+            std::size_t m_size;
+
+        public:
+            using element_type = T;
+            static constexpr bool has_size = true;
+
+            range_operand(const T* _data, std::size_t _size) : expression_node(), m_data(_data), m_size(_size) { }
+
+            std::size_t size() const { return m_size; }
+
+            template <typename V>
+            void evaluate(V& _out, std::size_t _i) const { std::memcpy(&_out, m_data + _i, sizeof(V)); }
+        };
+
+        /**
+         * @brief Leaf of an expression that broadcasts a scalar to every element.
+         */
+        template <typename T>
+        class scalar_operand : public expression_node {
+        private:
+            T m_value;
+
+        public:
+            using element_type = T;
+            static constexpr bool has_size = false;
+
+            explicit scalar_operand(T _value) : expression_node(), m_value(_value) { }
+
+            std::size_t size() const { return 0; }
+
+            template <typename V>
+            void evaluate(V& _out, std::size_t) const { _out = V{} + m_value; }
+        };
+
+        /**
+         * @brief Node applying Operation to the elements of two operands, at least one of which is not a scalar.
+         *        Throws std::invalid_argument if both have a size and the sizes differ.
+         */
+        template <typename Operation, typename Lhs, typename Rhs>
+        class binary_expression : public expression_node {
+        private:
+            Lhs m_lhs;
+            Rhs m_rhs;
+            std::size_t m_size;
+
+        public:
+            using element_type = typename Lhs::element_type;
+            static constexpr bool has_size = Lhs::has_size || Rhs::has_size;
+
+            binary_expression(Lhs _lhs, Rhs _rhs) :
+                    expression_node(),
+                    m_lhs(std::move(_lhs)),
+                    m_rhs(std::move(_rhs)),
+                    m_size(Lhs::has_size ? m_lhs.size() : m_rhs.size()) {
+                if (Lhs::has_size && Rhs::has_size && m_lhs.size() != m_rhs.size()) {
+                    throw std::invalid_argument("simd: the operands of an expression differ in size");
+                }
+            }
+
+            std::size_t size() const { return m_size; }
+
+            template <typename V>
+            void evaluate(V& _out, std::size_t _i) const {
+                V rhs;
+                m_lhs.evaluate(_out, _i);
+                m_rhs.evaluate(rhs, _i);
+                Operation::apply(_out, rhs);
+            }
+        };
+
+        /**
+         * @brief Node negating the elements of its operand.
+         */
+        template <typename Operand>
+        class negate_expression : public expression_node {
+        private:
+            Operand m_operand;
+
+        public:
+            using element_type = typename Operand::element_type;
+            static constexpr bool has_size = Operand::has_size;
+
+            explicit negate_expression(Operand _operand) : expression_node(), m_operand(std::move(_operand)) { }
+
+            std::size_t size() const { return m_operand.size(); }
+
+            template <typename V>
+            void evaluate(V& _out, std::size_t _i) const {
+                m_operand.evaluate(_out, _i);
+                _out = -_out;
+            }
+        };
+
+        struct add_operation {
+            template <typename V>
+            static void apply(V& _lhs, const V& _rhs) { _lhs = _lhs + _rhs; }
+        };
+
+        struct subtract_operation {
+            template <typename V>
+            static void apply(V& _lhs, const V& _rhs) { _lhs = _lhs - _rhs; }
+        };
+
+        struct multiply_operation {
+            template <typename V>
+            static void apply(V& _lhs, const V& _rhs) { _lhs = _lhs * _rhs; }
+        };
+
+        struct divide_operation {
+            template <typename V>
+            static void apply(V& _lhs, const V& _rhs) { _lhs = _lhs / _rhs; }
+        };
+
+        /**
+         * @brief Describes how an operand of an arithmetic operator enters an expression: expression nodes as they
+         *        are, contiguous ranges of kernel element types as range_operand leaves and arithmetic values as
+         *        scalar_operand leaves of the element type of the other operand. Other types are not operands, which
+         *        keeps the operators out of overload resolution for them.
+         */
+        template <typename X, typename = void>
+        struct expression_operand {
+            static constexpr bool is_operand = false;
+            static constexpr bool is_scalar = false;
+        };
+
+        template <typename X>
+        struct expression_operand<X, typename std::enable_if<std::is_base_of<expression_node, X>::value>::type> {
+            static constexpr bool is_operand = true;
+            static constexpr bool is_scalar = false;
+            using element_type = typename X::element_type;
+
+            template <typename T>
+            using type = X;
+
+            template <typename T>
+            static const X& make(const X& _x) { return _x; }
+        };
+
+        template <typename Iterator, typename Sentinel>
+        struct expression_operand<iterator_range<Iterator, Sentinel>, typename std::enable_if<
+                is_kernel_range<Iterator, Sentinel>::value>::type> {
+            static constexpr bool is_operand = true;
+            static constexpr bool is_scalar = false;
+            using element_type = typename std::remove_const<element_t<Iterator>>::type;
+
+            template <typename T>
+            using type = range_operand<element_type>;
+
+            template <typename T>
+            static range_operand<element_type> make(const iterator_range<Iterator, Sentinel>& _range) {
+                return range_operand<element_type>(IteratorBasedForImpl::to_address(_range.begin()), _range.size());
+            }
+        };
+
+        template <typename X>
+        struct expression_operand<X, typename std::enable_if<std::is_arithmetic<X>::value>::type> {
+            static constexpr bool is_operand = true;
+            static constexpr bool is_scalar = true;
+
+            template <typename T>
+            using type = scalar_operand<T>;
+
+            template <typename T>
+            static scalar_operand<T> make(X _x) { return scalar_operand<T>(static_cast<T>(_x)); }
+        };
+
+        /**
+         * @brief The element type of an expression combining operands of types L and R. Not defined unless both are
+         *        operands, at most one is a scalar and any two non-scalar operands have the same element type.
+         */
+        template <typename L, typename R, typename = void>
+        struct expression_element { };
+
+        template <typename L, typename R>
+        struct expression_element<L, R, typename std::enable_if<
+                expression_operand<L>::is_operand && !expression_operand<L>::is_scalar
+                && expression_operand<R>::is_operand && expression_operand<R>::is_scalar>::type> {
+            using type = typename expression_operand<L>::element_type;
+        };
+
+        template <typename L, typename R>
+        struct expression_element<L, R, typename std::enable_if<
+                expression_operand<L>::is_operand && expression_operand<L>::is_scalar
+                && expression_operand<R>::is_operand && !expression_operand<R>::is_scalar>::type> {
+            using type = typename expression_operand<R>::element_type;
+        };
+
+        template <typename L, typename R>
+        struct expression_element<L, R, typename std::enable_if<
+                expression_operand<L>::is_operand && !expression_operand<L>::is_scalar
+                && expression_operand<R>::is_operand && !expression_operand<R>::is_scalar
+                && std::is_same<typename expression_operand<L>::element_type,
+                                typename expression_operand<R>::element_type>::value>::type> {
+            using type = typename expression_operand<L>::element_type;
+        };
+
+        template <typename Operation, typename L, typename R>
+        using binary_expression_t = binary_expression<Operation,
+                typename expression_operand<L>::template type<typename expression_element<L, R>::type>,
+                typename expression_operand<R>::template type<typename expression_element<L, R>::type>>;
+
+        template <typename Operation, typename L, typename R>
+        binary_expression_t<Operation, L, R> make_binary_expression(const L& _lhs, const R& _rhs) {
+            using element_type = typename expression_element<L, R>::type;
+
+            return binary_expression_t<Operation, L, R>(
+                    expression_operand<L>::template make<element_type>(_lhs),
+                    expression_operand<R>::template make<element_type>(_rhs));
+        }
+
+        template <typename L, typename R>
+        binary_expression_t<add_operation, L, R> operator+(const L& _lhs, const R& _rhs) {
+            return make_binary_expression<add_operation>(_lhs, _rhs);
+        }
+
+        template <typename L, typename R>
+        binary_expression_t<subtract_operation, L, R> operator-(const L& _lhs, const R& _rhs) {
+            return make_binary_expression<subtract_operation>(_lhs, _rhs);
+        }
+
+        template <typename L, typename R>
+        binary_expression_t<multiply_operation, L, R> operator*(const L& _lhs, const R& _rhs) {
+            return make_binary_expression<multiply_operation>(_lhs, _rhs);
+        }
+
+        template <typename L, typename R>
+        binary_expression_t<divide_operation, L, R> operator/(const L& _lhs, const R& _rhs) {
+            return make_binary_expression<divide_operation>(_lhs, _rhs);
+        }
+
+        template <typename X, typename std::enable_if<expression_operand<X>::is_operand
+                                                      && !expression_operand<X>::is_scalar, int>::type = 0>
+        negate_expression<typename expression_operand<X>::template type<typename expression_operand<X>::element_type>>
+        operator-(const X& _operand) {
+            using element_type = typename expression_operand<X>::element_type;
+
+            return negate_expression<typename expression_operand<X>::template type<element_type>>(
+                    expression_operand<X>::template make<element_type>(_operand));
+        }
+
+        /**
+         * @brief Evaluates the element-wise expression _expression into the contiguous range _out in a single pass,
+         *        a vector of elements at a time, without materializing any intermediate result:
+         *
+         *        auto left = (l.begin(), l.end());
+         *        auto right = (r.begin(), r.end());
+         *        simd::assign((out.begin(), out.end()), left * 0.5f + right);
+         *
+         *        Expressions combine contiguous ranges of one kernel element type and scalars with +, -, * and / and
+         *        unary -. The output may be one of the input ranges, but must not overlap one at another position.
+         *        Throws std::invalid_argument if the expression has a different size than _out.
+         */
+        template <typename Iterator, typename Sentinel, typename Expression,
+                  typename std::enable_if<is_kernel_range<Iterator, Sentinel>::value
+                                          && std::is_base_of<expression_node, Expression>::value
+                                          && std::is_same<element_t<Iterator>,
+                                                          typename Expression::element_type>::value, int>::type = 0>
+        void assign(const iterator_range<Iterator, Sentinel>& _out, const Expression& _expression) {
+            element_t<Iterator>* p = IteratorBasedForImpl::to_address(_out.begin());
+            const std::size_t n = _out.size();
+
+            if (Expression::has_size && _expression.size() != n) {
+                throw std::invalid_argument("simd::assign: the expression and the output differ in size");
+            }
+
+            ITERATOR_BASED_FOR_SIMD_DISPATCH(evaluate(p, n, _expression))
+        }
+
+        /**
+         * @brief Reflected polynomial of CRC-32C (Castagnoli), the checksum the crc32 instruction of SSE4.2 and the
+         *        crc32c instructions of ARMv8 compute.
+         */
+        constexpr std::uint32_t crc32c_polynomial = 0x82F63B78u;
+
+        /**
+         * @brief Number of bytes of each of the three streams crc32c() checksums at once with the crc32
+         *        instructions, which complete one per cycle but take three cycles each, so a single dependent stream
+         *        leaves two thirds of the unit idle.
+         */
+        constexpr std::size_t crc32c_stream_bytes = 1024;
+
+        //Slice-by-8 tables of the software CRC-32C: table[k][b] is the register after byte b followed by k zero bytes.
+        struct crc32c_tables {
+            std::uint32_t table[8][256];
+
+            crc32c_tables() : table() {
+                for (std::uint32_t byte = 0; byte < 256; ++byte) {
+                    std::uint32_t crc = byte;
+
+                    for (int bit = 0; bit < 8; ++bit) {
+                        crc = (crc >> 1) ^ (crc32c_polynomial & (0u - (crc & 1u)));
+                    }
+
+                    table[0][byte] = crc;
+                }
+
+                for (std::size_t k = 1; k < 8; ++k) {
+                    for (std::size_t byte = 0; byte < 256; ++byte) {
+                        table[k][byte] = (table[k - 1][byte] >> 8) ^ table[0][table[k - 1][byte] & 0xff];
+                    }
+                }
+            }
+
+            static const crc32c_tables& instance() {
+                static const crc32c_tables tables;
+                return tables;
+            }
+        };
+
+        inline std::uint32_t crc32c_software(std::uint32_t _crc, const std::uint8_t* _data, std::size_t _n) {
+            const auto& table = crc32c_tables::instance().table;
+
+            for (; _n >= 8; _n -= 8, _data += 8) {
+                const std::uint32_t low = _crc ^ (std::uint32_t(_data[0]) | std::uint32_t(_data[1]) << 8
+                                                  | std::uint32_t(_data[2]) << 16 | std::uint32_t(_data[3]) << 24);
+
+                _crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^ table[5][(low >> 16) & 0xff]
+                       ^ table[4][low >> 24] ^ table[3][_data[4]] ^ table[2][_data[5]] ^ table[1][_data[6]]
+                       ^ table[0][_data[7]];
+            }
+
+            for (; _n != 0; --_n, ++_data) {
+                _crc = (_crc >> 8) ^ table[0][(_crc ^ *_data) & 0xff];
+            }
+
+            return _crc;
+        }
+
+        /**
+         * @brief Advances a CRC-32C register over a fixed number of zero bytes with four table lookups, which is how
+         *        the registers of streams checksummed side by side are combined: the register of a stream followed by
+         *        another is the first one advanced over the length of the second, exclusive-ored with the second one
+         *        started from zero.
+         */
+        struct crc32c_shift {
+            std::uint32_t table[4][256];
+
+            explicit crc32c_shift(std::size_t _bytes) : table() {
+                const std::uint8_t zeros[64] = {};
+                std::uint32_t images[32] = {};
+
+                for (std::size_t bit = 0; bit < 32; ++bit) {
+                    images[bit] = std::uint32_t(1) << bit;
+
+                    for (std::size_t left = _bytes; left != 0; left -= std::min(left, sizeof(zeros))) {
+                        images[bit] = crc32c_software(images[bit], zeros, std::min(left, sizeof(zeros)));
+                    }
+                }
+
+                for (std::size_t k = 0; k < 4; ++k) {
+                    for (std::size_t byte = 0; byte < 256; ++byte) {
+                        for (std::size_t bit = 0; bit < 8; ++bit) {
+                            table[k][byte] ^= (byte >> bit & 1) ? images[8 * k + bit] : 0;
+                        }
+                    }
+                }
+            }
+
+            std::uint32_t operator()(std::uint32_t _crc) const {
+                return table[0][_crc & 0xff] ^ table[1][(_crc >> 8) & 0xff] ^ table[2][(_crc >> 16) & 0xff]
+                       ^ table[3][_crc >> 24];
+            }
+        };
+
+        inline std::uint64_t load_word(const std::uint8_t* _data) {
+            std::uint64_t word;
+            std::memcpy(&word, _data, sizeof(word));
+            return word;
+        }
+
+#if ITERATOR_BASED_FOR_SIMD_X86 && defined(__x86_64__)
+#define ITERATOR_BASED_FOR_CRC32C_INSTRUCTIONS 1
+        ITERATOR_BASED_FOR_SIMD_TARGET_PUSH(ITERATOR_BASED_FOR_SIMD_SSE42)
+        inline std::uint32_t crc32c_instruction(std::uint32_t _crc, std::uint64_t _word) {
+            return static_cast<std::uint32_t>(_mm_crc32_u64(_crc, _word));
+        }
+
+        inline std::uint32_t crc32c_instruction(std::uint32_t _crc, std::uint8_t _byte) {
+            return _mm_crc32_u8(_crc, _byte);
+        }
+#elif defined(__ARM_FEATURE_CRC32)
+#define ITERATOR_BASED_FOR_CRC32C_INSTRUCTIONS 1
+        inline std::uint32_t crc32c_instruction(std::uint32_t _crc, std::uint64_t _word) {
+            return __crc32cd(_crc, _word);
+        }
+
+        inline std::uint32_t crc32c_instruction(std::uint32_t _crc, std::uint8_t _byte) {
+            return __crc32cb(_crc, _byte);
+        }
+#else
+#define ITERATOR_BASED_FOR_CRC32C_INSTRUCTIONS 0
+#endif
+
+#if ITERATOR_BASED_FOR_CRC32C_INSTRUCTIONS
+        inline std::uint32_t crc32c_hardware(std::uint32_t _crc, const std::uint8_t* _data, std::size_t _n) {
+            if (_n >= 3 * crc32c_stream_bytes) {
+                static const crc32c_shift shift_one(crc32c_stream_bytes);
+                static const crc32c_shift shift_two(2 * crc32c_stream_bytes);
+
+                for (; _n >= 3 * crc32c_stream_bytes; _n -= 3 * crc32c_stream_bytes, _data += 3 * crc32c_stream_bytes) {
+                    std::uint32_t first = _crc;
+                    std::uint32_t second = 0;
+                    std::uint32_t third = 0;
+
+                    for (std::size_t i = 0; i < crc32c_stream_bytes; i += 8) {
+                        first = crc32c_instruction(first, load_word(_data + i));
+                        second = crc32c_instruction(second, load_word(_data + crc32c_stream_bytes + i));
+                        third = crc32c_instruction(third, load_word(_data + 2 * crc32c_stream_bytes + i));
+                    }
+
+                    _crc = shift_two(first) ^ shift_one(second) ^ third;
+                }
+            }
+
+            for (; _n >= 8; _n -= 8, _data += 8) {
+                _crc = crc32c_instruction(_crc, load_word(_data));
+            }
+
+            for (; _n != 0; --_n, ++_data) {
+                _crc = crc32c_instruction(_crc, *_data);
+            }
+
+            return _crc;
+        }
+#endif
+
+#if ITERATOR_BASED_FOR_SIMD_X86 && defined(__x86_64__)
+        ITERATOR_BASED_FOR_SIMD_TARGET_POP
+#endif
+
+        /**
+         * @brief Checks whether crc32c() uses the CRC-32C instructions of the processor, which requires SSE4.2 on
+         *        x86-64 or a build for ARMv8 with the CRC extension, and an instruction set other than scalar to be
+         *        active.
+         */
+        inline bool has_crc32c_instructions() {
+#if ITERATOR_BASED_FOR_SIMD_X86 && defined(__x86_64__)
+            static const bool supported = __builtin_cpu_supports("sse4.2");
+            return supported && simd::active_instruction_set() != simd::instruction_set::scalar;
+#elif ITERATOR_BASED_FOR_CRC32C_INSTRUCTIONS
+            return simd::active_instruction_set() != simd::instruction_set::scalar;
+#else
+            return false;
+#endif
+        }
+
+        inline std::uint32_t crc32c_update(std::uint32_t _crc, const std::uint8_t* _data, std::size_t _n) {
+#if ITERATOR_BASED_FOR_CRC32C_INSTRUCTIONS
+            if (has_crc32c_instructions()) {
+                return crc32c_hardware(_crc, _data, _n);
+            }
+#endif
+            return crc32c_software(_crc, _data, _n);
+        }
+
+#undef ITERATOR_BASED_FOR_SIMD_DISPATCH
+#undef ITERATOR_BASED_FOR_SIMD_X86_CASES
+#undef ITERATOR_BASED_FOR_SIMD_NEON_CASES
+#undef ITERATOR_BASED_FOR_CRC32C_INSTRUCTIONS
+
+    } // namespace simd
+
+    //Makes the expression operators of simd visible to argument-dependent lookup on iterator_range operands, so
+    //expressions may start with a range, as in r1 * 2.0f + r2.
+    using simd::operator+;
+    using simd::operator-;
+    using simd::operator*;
+    using simd::operator/;
+
+} // namespace IteratorBasedForImpl
+
+#undef ITERATOR_BASED_FOR_SIMD_TARGET_PUSH
+#undef ITERATOR_BASED_FOR_SIMD_TARGET_POP
+#undef ITERATOR_BASED_FOR_SIMD_SSE2
+#undef ITERATOR_BASED_FOR_SIMD_SSE42
+#undef ITERATOR_BASED_FOR_SIMD_AVX2
+#undef ITERATOR_BASED_FOR_SIMD_AVX512
+
+#endif // IteratorBasedForSimd_H
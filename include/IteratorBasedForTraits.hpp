@@ -0,0 +1,472 @@
+#ifndef IteratorBasedForTraits_H
+#define IteratorBasedForTraits_H
+
+//The type traits behind the comma overload, for code that only needs to tell iterators and sentinels apart without
+//declaring ranges. IteratorBasedFor.hpp adds iterator_range and the overload itself; neither includes <memory>.
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+//When compiled as C++20, the comma overload is constrained with concepts instead of SFINAE. Define
+//ITERATOR_BASED_FOR_NO_CONCEPTS to keep using the SFINAE constraint.
+#if !defined(ITERATOR_BASED_FOR_NO_CONCEPTS) && defined(__cpp_concepts) && __cpp_concepts >= 201907L \
+    && defined(__has_include)
+#if __has_include(<concepts>)
+#include <concepts>
+#if defined(__cpp_lib_concepts) && __cpp_lib_concepts >= 202002L
+#define ITERATOR_BASED_FOR_HAS_CONCEPTS 1
+#endif
+#endif
+#endif
+
+#ifndef ITERATOR_BASED_FOR_HAS_CONCEPTS
+#define ITERATOR_BASED_FOR_HAS_CONCEPTS 0
+#endif
+
+namespace IteratorBasedForImpl
+{
+
+    struct tag {};
+
+    /**
+     * @brief Logical conjunction of the type traits B... that stops instantiating the remaining traits as soon as one of
+     *        them has a 'value' equal to false.
+     */
+    template <typename... B>
+    struct conjunction : std::true_type { };
+
+    template <typename B>
+    struct conjunction<B> : B { };
+
+    template <typename B, typename... Bn>
+    struct conjunction<B, Bn...> : std::conditional<bool(B::value), conjunction<Bn...>, B>::type { };
+
+    /**
+     * @brief Logical disjunction of the type traits B... that stops instantiating the remaining traits as soon as one of
+     *        them has a 'value' equal to true.
+     */
+    template <typename... B>
+    struct disjunction : std::false_type { };
+
+    template <typename B>
+    struct disjunction<B> : B { };
+
+    template <typename B, typename... Bn>
+    struct disjunction<B, Bn...> : std::conditional<bool(B::value), B, disjunction<Bn...>>::type { };
+
+    template<typename T>
+    tag swap(T&, T&);
+
+    template <typename T, typename U>
+    struct swap_call_matches_std_swap_impl {
+        //The dummy swap above has the same signature as std::swap, so if argument-dependent lookup also finds
+        //std::swap the call is ambiguous and substitution fails. Either way, only a more specialized swap found via
+        //argument-dependent lookup can make the call resolve to something other than the dummy.
+        template <typename V, typename W>
+        static constexpr auto check(int) -> typename std::integral_constant<bool, std::is_same<
+            decltype(swap(std::declval<V&>(), std::declval<W&>())),
+            tag>::value>::type;
+
+        template <typename, typename>
+        static constexpr std::true_type check(...);
+
+        using type = std::integral_constant<bool,
+            std::is_same<typename std::remove_reference<T>::type, typename std::remove_reference<U>::type>::value
+            && decltype(check<T, U>(0))::value>;
+    };
+
+    template <typename T, typename U>
+    struct swap_call_matches_std_swap : swap_call_matches_std_swap_impl<T, U>::type { };
+
+    template <typename T, typename U>
+    struct std_swap_call_is_valid : std::integral_constant<bool,
+            swap_call_matches_std_swap<T, U>::value
+            && std::is_move_assignable<T>::value
+            && std::is_move_assignable<U>::value
+            && std::is_move_constructible<T>::value
+            && std::is_move_constructible<U>::value> {
+    };
+
+    namespace swap_call_is_valid_detail
+    {
+        using std::swap;
+
+        template <typename T, typename U>
+        struct swap_call_is_valid_impl {
+            //Uses comma operator to return std::true_type() if template substitution succeeds.
+            //Comma operator will always return std::true_type(), but template substitution may fail if left operand
+            //is malformed.
+            template <typename V, typename W>
+            static constexpr auto check(int) -> decltype(swap(std::declval<V&>(), std::declval<W&>()), std::true_type());
+
+            template <typename, typename>
+            static constexpr std::false_type check(...);
+
+            using type = decltype(check<T, U>(0));
+        };
+    } // namespace swap_call_is_valid_detail
+
+    template <typename T, typename U>
+    struct swap_call_is_valid : swap_call_is_valid_detail::swap_call_is_valid_impl<T, U>::type { };
+
+    template <typename T, typename U>
+    struct is_swappable : std::integral_constant<bool, disjunction<
+            conjunction<swap_call_matches_std_swap<T, U>, std_swap_call_is_valid<T, U>>,
+            swap_call_is_valid<T, U>>::value> {
+    };
+
+    /**
+     * @brief Checks whether T defines a pre-increment operator that returns a reference to T. Provides the member
+     *        constant 'value' which is equal to true if T passes the check. Otherwise 'value' is equal to false.
+     */
+    template <typename T>
+    struct has_iterator_pre_increment_impl {
+        template <typename U>
+        static constexpr auto check(int) -> typename std::is_same<decltype(++std::declval<U>()), U&>::type;
+
+        template <typename>
+        static constexpr std::false_type check(...);
+
+        typedef decltype(check<T>(0)) type;
+    };
+
+    template <typename T>
+    struct has_iterator_pre_increment : has_iterator_pre_increment_impl<T>::type { };
+
+    /**
+     * @brief Checks whether std::iterator_traits<T> declares an iterator category derived from input_iterator_tag,
+     *        which is how proxy iterators such as std::vector<bool>::iterator and std::istreambuf_iterator declare
+     *        themselves iterators even though their indirection operators return values.
+     */
+    template <typename T>
+    struct has_input_iterator_category_impl {
+        template <typename U>
+        static constexpr auto check(int) -> typename std::is_base_of<std::input_iterator_tag,
+            typename std::iterator_traits<U>::iterator_category>::type;
+
+        template <typename>
+        static constexpr std::false_type check(...);
+
+        typedef decltype(check<T>(0)) type;
+    };
+
+    /**
+     * @brief Checks whether T defines an indirection operator. It must return a reference, or, for types whose
+     *        std::iterator_traits declare an input iterator category, any non-void proxy object. Provides the member
+     *        constant 'value' which is equal to true if T passes the check. Otherwise 'value' is equal to false.
+     */
+    template <typename T>
+    struct has_iterator_indirection_impl {
+        template <typename U, typename R = decltype(*std::declval<U>())>
+        static constexpr auto check(int) -> typename std::integral_constant<bool, std::is_reference<R>::value
+            || (!std::is_void<R>::value && has_input_iterator_category_impl<U>::type::value)>::type;
+
+        template <typename>
+        static constexpr std::false_type check(...);
+
+        typedef decltype(check<T>(0)) type;
+    };
+
+    template <typename T>
+    struct has_iterator_indirection : has_iterator_indirection_impl<T>::type {};
+
+    /**
+     * @brief Checks T against the move, destruction and swap requirements of an iterator. These are by far the most
+     *        expensive probes to instantiate. Copyability is not required so that move-only iterators, such as ones
+     *        owning a stream buffer, can be used as well.
+     */
+    template <typename T>
+    struct satisfies_iterator_value_requirements : conjunction<
+            std::is_destructible<T>,
+            std::is_move_constructible<T>,
+            std::is_move_assignable<T>,
+            is_swappable<T, T>> {
+    };
+
+    /**
+     * @brief Checks T against every iterator requirement without any shortcuts. is_iterator always agrees with this
+     *        trait but avoids instantiating most of it for common types.
+     */
+    template <typename T>
+    struct satisfies_iterator_requirements : std::integral_constant<bool, conjunction<
+            std::integral_constant<bool, !std::is_reference<T>::value>,
+            has_iterator_pre_increment<T>,
+            has_iterator_indirection<T>,
+            satisfies_iterator_value_requirements<T>>::value> {
+    };
+
+    /**
+     * @brief Checks whether std::iterator_traits<T> is well-formed and describes at least a forward iterator whose
+     *        reference type is a real reference, as every standard container iterator does. Such a type is required
+     *        to be copyable and swappable, so is_iterator only verifies its operators and the copy, move and
+     *        destruction intrinsics, which types declaring the traits without meeting them would fail.
+     */
+    template <typename T>
+    struct has_forward_iterator_traits_impl {
+        template <typename U>
+        static constexpr auto check(int) -> typename std::integral_constant<bool,
+            std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<U>::iterator_category>::value
+            && std::is_reference<typename std::iterator_traits<U>::reference>::value>::type;
+
+        template <typename>
+        static constexpr std::false_type check(...);
+
+        typedef decltype(check<T>(0)) type;
+    };
+
+    template <typename T>
+    struct has_forward_iterator_traits : std::integral_constant<bool,
+            std::is_class<T>::value && has_forward_iterator_traits_impl<T>::type::value
+            && std::is_copy_constructible<T>::value && std::is_move_constructible<T>::value
+            && std::is_move_assignable<T>::value && std::is_destructible<T>::value> {
+    };
+
+    /**
+     * @brief Checks whether T is an iterator type. The operator probes come first so that non-iterators, which is what
+     *        most comma expressions on class types involve, are rejected before anything else is instantiated.
+     *        Types described by std::iterator_traits as forward iterators then skip the value requirements.
+     */
+    template <typename T>
+    struct is_iterator : std::integral_constant<bool, conjunction<
+            std::integral_constant<bool, !std::is_reference<T>::value>,
+            has_iterator_pre_increment<T>,
+            has_iterator_indirection<T>,
+            disjunction<has_forward_iterator_traits<T>, satisfies_iterator_value_requirements<T>>>::value> {
+    };
+
+    /**
+     * @brief Pointers are rejected by has_iterator_pre_increment since a prvalue pointer cannot be incremented, so
+     *        there is no need to probe them.
+     */
+    template <typename T>
+    struct is_iterator<T*> : std::false_type { };
+
+    /**
+     * @brief Checks whether T can be the left operand of the comma overload: an iterator, or a pointer to an object.
+     *        Two pointers are always combined by the built-in comma operator, but a pointer followed by a sentinel or
+     *        a count of class type reaches the overload, as in (p, null_sentinel()) or (p, counted(n)).
+     */
+    template <typename T>
+    struct is_comma_left_operand : std::integral_constant<bool, is_iterator<T>::value
+            || (std::is_pointer<T>::value && std::is_object<typename std::remove_pointer<T>::type>::value)> {
+    };
+
+#if ITERATOR_BASED_FOR_HAS_CONCEPTS
+    /**
+     * @brief Concept equivalent of is_iterator used to constrain the comma overload in C++20. Like
+     *        std::input_or_output_iterator it requires a pre-increment returning T&, but it does not require a
+     *        difference type and additionally requires indirection to yield a real reference, or a proxy for types
+     *        declaring an input iterator category.
+     */
+    template <typename T>
+    concept comma_iterator = !std::is_reference_v<T> && !std::is_pointer_v<T>
+            && requires(T& t) {
+                { ++t } -> std::same_as<T&>;
+                *t;
+            }
+            && (std::is_reference_v<decltype(*std::declval<T&>())>
+                || (!std::is_void_v<decltype(*std::declval<T&>())>
+                    && has_input_iterator_category_impl<T>::type::value))
+            && std::movable<T>
+            && std::swappable<T>;
+
+    /**
+     * @brief Concept equivalent of is_comma_left_operand used to constrain the comma overload in C++20.
+     */
+    template <typename T>
+    concept comma_left_operand = comma_iterator<T>
+            || (std::is_pointer_v<T> && std::is_object_v<std::remove_pointer_t<T>>);
+#endif
+
+    /**
+     * @brief Checks whether an iterator of type I can be compared for inequality with an object of type S, which is all
+     *        a range-based for statement requires of its end. Provides the member constant 'value' which is equal to
+     *        true if S passes the check. Otherwise 'value' is equal to false.
+     */
+    template <typename S, typename I>
+    struct has_sentinel_inequality_impl {
+        template <typename T, typename U>
+        static constexpr auto check(int) -> typename std::is_convertible<
+            decltype(std::declval<const U&>() != std::declval<const T&>()),
+            bool>::type;
+
+        template <typename, typename>
+        static constexpr std::false_type check(...);
+
+        typedef decltype(check<S, I>(0)) type;
+    };
+
+    template <typename S, typename I>
+    struct has_sentinel_inequality : has_sentinel_inequality_impl<S, I>::type { };
+
+    /**
+     * @brief Checks whether S can be used as the end of a range starting at an iterator of type I. Either S is I itself,
+     *        or S is a destructible, move constructible type that iterators of type I can be compared against.
+     */
+    template <typename S, typename I>
+    struct is_sentinel_for : std::integral_constant<bool, disjunction<
+            std::is_same<S, I>,
+            conjunction<
+                std::integral_constant<bool, !std::is_reference<S>::value>,
+                std::is_destructible<S>,
+                std::is_move_constructible<S>,
+                has_sentinel_inequality<S, I>>>::value> {
+    };
+
+#if ITERATOR_BASED_FOR_HAS_CONCEPTS
+    /**
+     * @brief Concept equivalent of is_sentinel_for used to constrain the comma overload in C++20.
+     */
+    template <typename S, typename I>
+    concept comma_sentinel_for = std::same_as<S, I>
+            || (!std::is_reference_v<S>
+                && std::destructible<S>
+                && std::move_constructible<S>
+                && requires(const I& i, const S& s) {
+                    { i != s } -> std::convertible_to<bool>;
+                });
+#endif
+
+    /**
+     * @brief An end marker for ranges over null-terminated sequences such as C strings. An iterator compares equal to
+     *        it when it points to a value-initialized element, so the sequence is scanned in a single pass instead of
+     *        computing its length first.
+     */
+    struct null_sentinel {
+        template <typename Iterator>
+        friend auto operator==(const Iterator& it, null_sentinel) -> decltype(*it == *it, bool()) {
+            using value_type = typename std::decay<decltype(*it)>::type;
+            return *it == value_type();
+        }
+
+        template <typename Iterator>
+        friend auto operator!=(const Iterator& it, null_sentinel) -> decltype(*it == *it, bool()) {
+            return !(it == null_sentinel());
+        }
+
+        friend bool operator==(null_sentinel, null_sentinel) { return true; }
+        friend bool operator!=(null_sentinel, null_sentinel) { return false; }
+    };
+
+    /**
+     * @brief Checks whether std::iterator_traits<T> is well-formed and its iterator category derives from Tag.
+     */
+    template <typename T, typename Tag>
+    struct has_iterator_category_impl {
+        template <typename U>
+        static constexpr auto check(int) -> typename std::is_base_of<Tag,
+            typename std::iterator_traits<U>::iterator_category>::type;
+
+        template <typename>
+        static constexpr std::false_type check(...);
+
+        typedef decltype(check<T>(0)) type;
+    };
+
+    template <typename T, typename Tag>
+    struct has_iterator_category : has_iterator_category_impl<T, Tag>::type { };
+
+    template <typename T>
+    struct is_bidirectional_iterator : has_iterator_category<T, std::bidirectional_iterator_tag> { };
+
+    template <typename T>
+    struct is_random_access_iterator : has_iterator_category<T, std::random_access_iterator_tag> { };
+
+    /**
+     * @brief Checks whether the elements an iterator of type T refers to are stored contiguously in memory. Pointers
+     *        and the vector and string iterators of libstdc++ and libc++ are recognized; in C++20 any type modelling
+     *        std::contiguous_iterator is. Other iterator types may opt in by specializing this trait.
+     */
+    template <typename T>
+    struct is_contiguous_iterator : std::integral_constant<bool,
+#if ITERATOR_BASED_FOR_HAS_CONCEPTS
+            std::contiguous_iterator<T>
+#else
+            false
+#endif
+            > {
+    };
+
+    template <typename T>
+    struct is_contiguous_iterator<T*> : std::true_type { };
+
+#if defined(__GLIBCXX__)
+    template <typename T, typename Container>
+    struct is_contiguous_iterator<__gnu_cxx::__normal_iterator<T*, Container>> : std::true_type { };
+#endif
+
+#if defined(_LIBCPP_VERSION)
+    template <typename T>
+    struct is_contiguous_iterator<std::__wrap_iter<T*>> : std::true_type { };
+#endif
+
+    /**
+     * @brief Checks whether the distance from an iterator of type I to an end of type S can be computed in constant
+     *        time with S - I, as for random access iterators.
+     */
+    template <typename S, typename I>
+    struct is_sized_sentinel_for_impl {
+        template <typename T, typename U>
+        static constexpr auto check(int) -> typename std::is_convertible<
+            decltype(std::declval<const T&>() - std::declval<const U&>()),
+            typename std::iterator_traits<U>::difference_type>::type;
+
+        template <typename, typename>
+        static constexpr std::false_type check(...);
+
+        typedef decltype(check<S, I>(0)) type;
+    };
+
+    template <typename S, typename I>
+    struct is_sized_sentinel_for : std::integral_constant<bool,
+            is_random_access_iterator<I>::value && is_sized_sentinel_for_impl<S, I>::type::value> {
+    };
+
+    /**
+     * @brief Returns the address of _value even if its type overloads the address-of operator, like std::addressof
+     *        but without including <memory>.
+     */
+    template <typename T>
+    constexpr T* addressof(T& _value) noexcept {
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+        return __builtin_addressof(_value);
+#else
+        return reinterpret_cast<T*>(&const_cast<char&>(reinterpret_cast<const volatile char&>(_value)));
+#endif
+    }
+
+    template <typename T>
+    const T* addressof(const T&&) = delete;
+
+    /**
+     * @brief Obtains the address an iterator refers to without dereferencing it, so that it can also be used on an end
+     *        iterator. Uses operator-> where the iterator provides one, and the address of *it otherwise.
+     */
+    template <typename T>
+    constexpr T* to_address(T* p) noexcept {
+        return p;
+    }
+
+    template <typename Iterator>
+    auto to_address_impl(const Iterator& it, int) noexcept(noexcept(IteratorBasedForImpl::to_address(it.operator->())))
+            -> decltype(IteratorBasedForImpl::to_address(it.operator->())) {
+        return IteratorBasedForImpl::to_address(it.operator->());
+    }
+
+    template <typename Iterator>
+    auto to_address_impl(const Iterator& it, long) noexcept(noexcept(*it))
+            -> decltype(IteratorBasedForImpl::addressof(*it)) {
+        return IteratorBasedForImpl::addressof(*it);
+    }
+
+    template <typename Iterator>
+    auto to_address(const Iterator& it) noexcept(noexcept(IteratorBasedForImpl::to_address_impl(it, 0)))
+            -> decltype(IteratorBasedForImpl::to_address_impl(it, 0)) {
+        return IteratorBasedForImpl::to_address_impl(it, 0);
+    }
+
+} // namespace IteratorBasedForImpl
+
+#endif // IteratorBasedForTraits_H
@@ -0,0 +1,67 @@
+//Module interface unit of the core library, exporting everything IteratorBasedFor.hpp declares: the traits,
+//iterator_range, the small ranges and the comma overload. A translation unit importing it loads the binary module
+//interface built once instead of parsing the header and the standard headers it needs.
+//
+//The declarations are exported from a language linkage block, so they stay attached to the global module and are the
+//same entities as those of the header in translation units that include it. The standard headers are included in the
+//global module fragment first, so the header's own includes of them are empty inside the block. Configuration macros
+//such as ITERATOR_BASED_FOR_NO_CONCEPTS take effect when the module is built.
+module;
+
+#if defined(ITERATOR_BASED_FOR_PROFILE)
+#error "profiling builds include IteratorBasedFor.hpp instead of importing the module"
+#endif
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#if defined(__has_include)
+#if __has_include(<concepts>)
+#include <concepts>
+#endif
+#if __has_include(<span>)
+#include <span>
+#endif
+#if __has_include(<ranges>)
+#include <ranges>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//The std::ranges specializations cannot be exported, so the header leaves them to the block after the export block,
+//which keeps them reachable in every translation unit importing the module.
+#define ITERATOR_BASED_FOR_MODULE_INTERFACE
+
+export module iterator_based_for;
+
+export extern "C++" {
+#include <IteratorBasedFor.hpp>
+}
+
+#if ITERATOR_BASED_FOR_HAS_STD_RANGES
+extern "C++" {
+namespace std
+{
+namespace ranges
+{
+    template <typename Iterator, typename Sentinel>
+    inline constexpr bool enable_view<IteratorBasedForImpl::iterator_range<Iterator, Sentinel>> = true;
+
+    template <typename Iterator, typename Sentinel>
+    inline constexpr bool enable_borrowed_range<IteratorBasedForImpl::iterator_range<Iterator, Sentinel>> = true;
+
+    template <typename Iterator>
+    inline constexpr bool enable_view<IteratorBasedForImpl::blocked_iterator_range<Iterator>> = true;
+
+    template <typename Iterator>
+    inline constexpr bool enable_borrowed_range<IteratorBasedForImpl::blocked_iterator_range<Iterator>> = true;
+} // namespace ranges
+} // namespace std
+}
+#endif
@@ -0,0 +1,833 @@
+#include <gtest/gtest.h>
+#include <IteratorBasedForAdaptors.hpp>
+#include "IteratorBasedForTestAllocator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__has_include) && __cplusplus >= 201703L
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define ITERATOR_BASED_FOR_TEST_PMR 1
+#endif
+#endif
+
+using namespace IteratorBasedForImpl;
+using IteratorBasedForTest::counting_allocator;
+
+TEST(IteratorBasedForAdaptorsTest, BlockedRandomAccess)
+{
+    std::vector<int> v(10);
+    std::iota(v.begin(), v.end(), 0);
+    std::vector<iterator_range<std::vector<int>::iterator>> blocks;
+
+    for (auto block : blocked((v.begin(), v.end()), 4)) {
+        blocks.push_back(block);
+    }
+
+    ASSERT_EQ(3u, blocks.size());
+    EXPECT_EQ(make_iterator_range(v.begin(), v.begin() + 4), blocks[0]);
+    EXPECT_EQ(make_iterator_range(v.begin() + 4, v.begin() + 8), blocks[1]);
+    EXPECT_EQ(make_iterator_range(v.begin() + 8, v.end()), blocks[2]);
+    EXPECT_EQ(2u, blocks[2].size());
+
+    EXPECT_TRUE(blocked((v.begin(), v.begin()), 4).empty());
+    EXPECT_EQ(10, std::distance(blocked((v.begin(), v.end()), 0).begin(), blocked((v.begin(), v.end()), 0).end()));
+    EXPECT_EQ(1, std::distance(blocked((v.begin(), v.end()), 100).begin(), blocked((v.begin(), v.end()), 100).end()));
+}
+
+TEST(IteratorBasedForAdaptorsTest, BlockedFusedPasses)
+{
+    std::vector<double> v(1000);
+    std::iota(v.begin(), v.end(), 0.0);
+
+    for (auto tile : blocked((v.begin(), v.end()), 64)) {
+        for (double& x : tile) {
+            x -= 500.0;
+        }
+
+        for (double& x : tile) {
+            x *= 2.0;
+        }
+
+        for (double& x : tile) {
+            x = std::max(-100.0, std::min(100.0, x));
+        }
+    }
+
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        EXPECT_EQ(std::max(-100.0, std::min(100.0, (static_cast<double>(i) - 500.0) * 2.0)), v[i]);
+    }
+}
+
+TEST(IteratorBasedForAdaptorsTest, BlockedForwardAndSentinel)
+{
+    std::list<int> l({1, 2, 3, 4, 5});
+    std::vector<int> sums;
+
+    for (auto block : blocked((l.begin(), l.end()), 2)) {
+        sums.push_back(std::accumulate(block.begin(), block.end(), 0));
+    }
+
+    EXPECT_EQ(std::vector<int>({3, 7, 5}), sums);
+
+    std::vector<char> s({'a', 'b', 'c', 'd', 'e', '\0'});
+    std::vector<std::size_t> sizes;
+
+    for (auto block : blocked((s.begin(), null_sentinel()), 3)) {
+        sizes.push_back(block.size());
+    }
+
+    EXPECT_EQ(std::vector<std::size_t>({3, 2}), sizes);
+}
+
+TEST(IteratorBasedForAdaptorsTest, BatchedContiguous)
+{
+    std::string text("hello, batched world");
+    std::string copy;
+    std::vector<std::size_t> sizes;
+
+    for (span<char> bytes : batched((text.begin(), text.end()), 8)) {
+        copy.append(bytes.data(), bytes.size());
+        sizes.push_back(bytes.size());
+    }
+
+    EXPECT_EQ(text, copy);
+    EXPECT_EQ(std::vector<std::size_t>({8, 8, 4}), sizes);
+
+    const std::vector<int> v({1, 2, 3, 4, 5, 6, 7});
+    const int* expected = v.data() + 1;
+    std::vector<int> sums;
+
+    for (span<const int> batch : batched((v.begin() + 1, v.end()), 4)) {
+        EXPECT_EQ(expected, batch.data());
+        expected += batch.size();
+        sums.push_back(std::accumulate(batch.begin(), batch.end(), 0));
+    }
+
+    EXPECT_EQ(std::vector<int>({2 + 3 + 4 + 5, 6 + 7}), sums);
+    EXPECT_TRUE(batched((v.begin(), v.begin()), 3).empty());
+
+    span<int> s;
+    span<const int> cs = s;
+    EXPECT_TRUE(cs.empty());
+}
+
+TEST(IteratorBasedForAdaptorsTest, PrefetchedVisitsEveryElement)
+{
+    std::list<int> l({1, 2, 3, 4, 5});
+
+    for (std::size_t distance : {0u, 1u, 3u, 5u, 100u}) {
+        std::vector<int> seen;
+
+        for (int x : prefetched((l.begin(), l.end()), distance)) {
+            seen.push_back(x);
+        }
+
+        EXPECT_EQ(std::vector<int>({1, 2, 3, 4, 5}), seen);
+    }
+
+    std::map<int, std::string> m({{1, "a"}, {2, "b"}, {3, "c"}});
+    std::string joined;
+
+    for (auto& entry : prefetched((m.begin(), m.end()), 2)) {
+        entry.second += "!";
+        joined += entry.second;
+    }
+
+    EXPECT_EQ("a!b!c!", joined);
+
+    std::list<int> empty;
+    auto r = prefetched((empty.begin(), empty.end()), 4);
+    EXPECT_FALSE(r.begin() != r.end());
+
+    std::vector<char> s({'a', 'b', 'c', '\0'});
+    std::string chars;
+
+    for (char c : prefetched((s.begin(), null_sentinel()), 2)) {
+        chars += c;
+    }
+
+    EXPECT_EQ("abc", chars);
+}
+
+TEST(IteratorBasedForAdaptorsTest, InterleavedForEach)
+{
+    std::vector<std::list<int>> chains(20);
+
+    for (std::size_t i = 0; i < chains.size(); ++i) {
+        for (std::size_t j = 0; j < i % 7; ++j) {
+            chains[i].push_back(static_cast<int>(i * 100 + j));
+        }
+    }
+
+    std::vector<iterator_range<std::list<int>::iterator>> ranges;
+
+    for (std::list<int>& chain : chains) {
+        ranges.push_back((chain.begin(), chain.end()));
+    }
+
+    for (std::size_t width : {0u, 1u, 3u, 8u, 50u}) {
+        std::vector<std::vector<int>> seen(chains.size());
+        interleaved_for_each(ranges, [&seen](std::size_t i, int& x) { seen[i].push_back(x++); }, width);
+
+        for (std::size_t i = 0; i < chains.size(); ++i) {
+            std::vector<int> incremented(chains[i].begin(), chains[i].end());
+
+            for (std::size_t j = 0; j < seen[i].size(); ++j) {
+                ++seen[i][j];
+            }
+
+            EXPECT_EQ(incremented, seen[i]) << width;
+        }
+    }
+
+    //Stops every range at its first even element, as a probe stops at its match.
+    std::vector<int> first_even(chains.size(), -1);
+    interleaved_for_each(ranges, [&first_even](std::size_t i, int x) {
+        if (x % 2 == 0) {
+            first_even[i] = x;
+            return false;
+        }
+
+        return true;
+    }, 4);
+
+    for (std::size_t i = 0; i < chains.size(); ++i) {
+        auto expected = std::find_if(chains[i].begin(), chains[i].end(), [](int x) { return x % 2 == 0; });
+        EXPECT_EQ(expected == chains[i].end() ? -1 : *expected, first_even[i]);
+    }
+
+    std::unordered_map<int, int> table;
+
+    for (int k = 0; k < 1000; ++k) {
+        table.emplace(k * 7, k);
+    }
+
+    const std::vector<int> probes = {0, 7, 8, 6993, 7000};
+    std::vector<iterator_range<std::unordered_map<int, int>::const_local_iterator>> buckets;
+
+    for (int probe : probes) {
+        buckets.push_back((table.cbegin(table.bucket(probe)), table.cend(table.bucket(probe))));
+    }
+
+    std::vector<int> found(probes.size(), -1);
+    interleaved_for_each(buckets, [&](std::size_t i, const std::pair<const int, int>& entry) {
+        return entry.first == probes[i] ? (found[i] = entry.second, false) : true;
+    });
+
+    EXPECT_EQ(std::vector<int>({0, 1, -1, 999, -1}), found);
+
+    std::vector<iterator_range<std::list<int>::iterator>> none;
+    interleaved_for_each(none, [](std::size_t, int) { ADD_FAILURE(); });
+}
+
+TEST(IteratorBasedForAdaptorsTest, TransformAndFilterViews)
+{
+    std::vector<int> v(10);
+    std::iota(v.begin(), v.end(), 1);
+
+    auto tens = transform((v.begin(), v.end()), [](int x) { return x * 10; });
+    EXPECT_EQ(10u, tens.size());
+    EXPECT_EQ(30, tens.begin()[2]);
+    EXPECT_EQ(100, *(tens.end() - 1));
+    EXPECT_TRUE(is_random_access_iterator<decltype(tens.begin())>::value);
+
+    //A chain of adaptors is a single iterator over the original range.
+    auto chain = transform(filter(tens, [](int x) { return x % 20 == 0; }), [](int x) { return x + 1; });
+    EXPECT_TRUE((std::is_same<std::vector<int>::iterator, std::decay<decltype(chain.begin().base())>::type>::value));
+    EXPECT_FALSE(is_random_access_iterator<decltype(chain.begin())>::value);
+    EXPECT_EQ((std::vector<int>{21, 41, 61, 81, 101}), std::vector<int>(chain.begin(), chain.end()));
+
+    //The stage in front of a filter is computed again when the element is dereferenced.
+    int calls = 0;
+    auto counted = filter(transform((v.begin(), v.end()), [&calls](int x) { ++calls; return x; }),
+                          [](int x) { return x > 5; });
+    EXPECT_EQ(40, std::accumulate(counted.begin(), counted.end(), 0));
+    EXPECT_EQ(15, calls);
+
+    std::list<std::string> words = {"a", "bb", "", "ccc"};
+    std::vector<std::size_t> lengths;
+
+    for (std::size_t n : transform(filter((words.begin(), words.end()), [](const std::string& w) { return !w.empty(); }),
+                                   [](const std::string& w) { return w.size(); })) {
+        lengths.push_back(n);
+    }
+
+    EXPECT_EQ((std::vector<std::size_t>{1, 2, 3}), lengths);
+
+    //Elements can be modified through a filter, and views over sentinel ranges end at the sentinel.
+    for (int& x : filter((v.begin(), v.end()), [](int x) { return x % 2 == 0; })) {
+        x = 0;
+    }
+
+    EXPECT_EQ(0, std::count(v.begin(), v.end(), 0) - 5);
+
+    const char* text = "a1b2c3";
+    std::string digits;
+
+    for (char c : filter((text, null_sentinel()), [](char c) { return c >= '0' && c <= '9'; })) {
+        digits += c;
+    }
+
+    EXPECT_EQ("123", digits);
+    EXPECT_TRUE(filter((v.begin(), v.end()), [](int) { return false; }).empty());
+}
+
+TEST(IteratorBasedForAdaptorsTest, Zip)
+{
+    std::vector<float> x = {1, 2, 3, 4};
+    std::vector<float> v = {10, 20, 30, 40, 50};
+    std::list<int> ids = {7, 8, 9, 10};
+
+    auto zipped = zip((x.begin(), x.end()), (v.cbegin(), v.cend()));
+    EXPECT_EQ(4u, zipped.size());
+    EXPECT_TRUE(is_random_access_iterator<decltype(zipped.begin())>::value);
+
+    for (auto element : zipped) {
+        std::get<0>(element) += std::get<1>(element);
+    }
+
+    EXPECT_EQ((std::vector<float>{11, 22, 33, 44}), x);
+    EXPECT_EQ(33.0f, std::get<0>(zipped.begin()[2]));
+
+    //With a list the zipped range is bidirectional and ends with the first range.
+    std::vector<int> seen;
+
+    for (auto element : zip((ids.begin(), ids.end()), (x.begin(), x.end()))) {
+        seen.push_back(std::get<0>(element) + static_cast<int>(std::get<1>(element)));
+    }
+
+    EXPECT_EQ((std::vector<int>{18, 30, 42, 54}), seen);
+    EXPECT_FALSE(is_random_access_iterator<decltype(zip((ids.begin(), ids.end()), (x.begin(), x.end())).begin())>::value);
+
+    std::vector<int> empty;
+    EXPECT_TRUE(zip((x.begin(), x.end()), (empty.begin(), empty.end())).empty());
+
+#if __cplusplus >= 201703L
+    for (auto [a, b] : zip((x.begin(), x.end()), (v.begin(), v.end()))) {
+        b = a;
+    }
+
+    EXPECT_EQ((std::vector<float>{11, 22, 33, 44, 50}), v);
+#endif
+}
+
+TEST(IteratorBasedForAdaptorsTest, Enumerate)
+{
+    std::vector<int> v = {5, 6, 7};
+
+    for (auto element : enumerate((v.begin(), v.end()))) {
+        element.second += static_cast<int>(element.first);
+    }
+
+    EXPECT_EQ((std::vector<int>{5, 7, 9}), v);
+
+    auto numbered = enumerate<std::uint32_t>((v.cbegin(), v.cend()), 1u);
+    EXPECT_EQ(3u, numbered.size());
+    EXPECT_TRUE(is_random_access_iterator<decltype(numbered.begin())>::value);
+    EXPECT_EQ(3u, (*(numbered.end() - 1)).first);
+    EXPECT_EQ(7, numbered.begin()[1].second);
+    EXPECT_TRUE((std::is_same<std::uint32_t, decltype((*numbered.begin()).first)>::value));
+
+    std::list<std::string> names = {"a", "b"};
+    std::string joined;
+
+    for (auto element : enumerate((names.begin(), names.end()))) {
+        joined += std::to_string(element.first) + element.second;
+    }
+
+    EXPECT_EQ("0a1b", joined);
+
+    const char* text = "xyz";
+    std::size_t last_index = 0;
+
+    for (auto element : enumerate((text, null_sentinel()))) {
+        last_index = element.first;
+        EXPECT_EQ(text[element.first], element.second);
+    }
+
+    EXPECT_EQ(2u, last_index);
+
+#if __cplusplus >= 201703L
+    for (auto [i, x] : enumerate((v.begin(), v.end()))) {
+        x = static_cast<int>(i);
+    }
+
+    EXPECT_EQ((std::vector<int>{0, 1, 2}), v);
+#endif
+}
+
+TEST(IteratorBasedForAdaptorsTest, SlidingWindows)
+{
+    std::vector<int> v = {1, 2, 3, 4, 5};
+    std::vector<int> sums;
+
+    for (auto window : sliding((v.begin(), v.end()), 3)) {
+        EXPECT_EQ(3u, window.size());
+        sums.push_back(std::accumulate(window.begin(), window.end(), 0));
+    }
+
+    EXPECT_EQ((std::vector<int>{6, 9, 12}), sums);
+    EXPECT_EQ(1, std::distance(sliding((v.begin(), v.end()), 5).begin(), sliding((v.begin(), v.end()), 5).end()));
+    EXPECT_TRUE(sliding((v.begin(), v.end()), 6).empty());
+    EXPECT_TRUE(sliding((v.begin(), v.end()), 0).empty());
+
+    std::list<char> letters = {'a', 'b', 'c'};
+    std::vector<std::string> pairs;
+
+    for (auto window : sliding((letters.begin(), letters.end()), 2)) {
+        pairs.push_back(std::string(window.begin(), window.end()));
+    }
+
+    EXPECT_EQ((std::vector<std::string>{"ab", "bc"}), pairs);
+
+    //The incremental form yields the same rolling sums in constant time per element.
+    std::vector<int> rolling;
+    int sum = 0;
+    std::size_t seen = 0;
+
+    sliding_for_each((v.cbegin(), v.cend()), 3, [&](int in, const int* out) {
+        sum += in - (out ? *out : 0);
+
+        if (++seen >= 3) {
+            rolling.push_back(sum);
+        }
+    });
+
+    EXPECT_EQ(sums, rolling);
+
+    std::size_t nulls = 0;
+    sliding_for_each((v.begin(), v.end()), 10, [&nulls](int&, int* out) { nulls += out == nullptr; });
+    EXPECT_EQ(5u, nulls);
+}
+
+TEST(IteratorBasedForAdaptorsTest, GroupAdjacent)
+{
+    std::vector<std::pair<char, int>> trades = {{'a', 1}, {'a', 2}, {'b', 3}, {'c', 4}, {'c', 5}, {'c', 6}};
+    std::vector<std::pair<char, int>> totals;
+
+    for (auto run : group_adjacent((trades.cbegin(), trades.cend()),
+                                   [](const std::pair<char, int>& t) { return t.first; })) {
+        int volume = 0;
+
+        for (const auto& t : run) {
+            volume += t.second;
+        }
+
+        totals.emplace_back(run.begin()->first, volume);
+    }
+
+    EXPECT_EQ((std::vector<std::pair<char, int>>{{'a', 3}, {'b', 3}, {'c', 15}}), totals);
+
+    //A binary predicate compares neighbours, here grouping increasing runs.
+    std::list<int> values = {1, 2, 3, 2, 5, 1};
+    std::vector<std::size_t> lengths;
+
+    for (auto run : group_adjacent((values.begin(), values.end()), [](int a, int b) { return a < b; })) {
+        lengths.push_back(static_cast<std::size_t>(std::distance(run.begin(), run.end())));
+    }
+
+    EXPECT_EQ((std::vector<std::size_t>{3, 2, 1}), lengths);
+
+    std::vector<int> empty;
+    EXPECT_TRUE(group_adjacent((empty.begin(), empty.end()), [](int x) { return x; }).empty());
+
+    const char* text = "aabccc";
+    std::vector<std::string> runs;
+
+    for (auto run : group_adjacent(ptr_range(text, 6), [](char a, char b) { return a == b; })) {
+        runs.emplace_back(run.begin(), run.end());
+    }
+
+    EXPECT_EQ((std::vector<std::string>{"aa", "b", "ccc"}), runs);
+}
+
+TEST(IteratorBasedForAdaptorsTest, Merge)
+{
+    std::vector<int> a = {1, 4, 7, 10};
+    std::vector<int> b = {2, 5, 8};
+    std::vector<int> c;
+    std::vector<int> d = {0, 3, 6, 9, 11, 12};
+
+    auto merged = merge((a.cbegin(), a.cend()), (b.cbegin(), b.cend()), (c.cbegin(), c.cend()), (d.cbegin(), d.cend()));
+    EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}),
+              std::vector<int>(merged.begin(), merged.end()));
+
+    //Many runs, with a custom comparison on a non-arithmetic element, stay stable.
+    std::vector<std::vector<std::pair<int, int>>> runs(37);
+
+    for (int run = 0; run < 37; ++run) {
+        for (int i = 0; i < 50; ++i) {
+            runs[run].emplace_back((i * 7 + run) % 100 / 10 + i / 10 * 10, run);
+        }
+
+        std::sort(runs[run].begin(), runs[run].end());
+    }
+
+    std::vector<iterator_range<std::vector<std::pair<int, int>>::const_iterator>> ranges;
+
+    for (const auto& run : runs) {
+        ranges.push_back((run.cbegin(), run.cend()));
+    }
+
+    auto by_key = [](const std::pair<int, int>& x, const std::pair<int, int>& y) { return x.first < y.first; };
+    std::vector<std::pair<int, int>> out;
+
+    for (const auto& x : merge(ranges, by_key)) {
+        out.push_back(x);
+    }
+
+    std::vector<std::pair<int, int>> expected;
+
+    for (const auto& run : runs) {
+        expected.insert(expected.end(), run.begin(), run.end());
+    }
+
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+    EXPECT_EQ(expected, out);
+
+    std::vector<std::vector<double>> none;
+    EXPECT_TRUE(merge(none).empty());
+
+    std::vector<double> single = {1.5, 2.5};
+    std::vector<std::vector<double>> one = {single};
+    EXPECT_EQ(single, std::vector<double>(merge(one).begin(), merge(one).end()));
+}
+
+TEST(IteratorBasedForAdaptorsTest, MergeWithAllocator)
+{
+    std::vector<int> a = {1, 3, 5};
+    std::vector<int> b = {2, 4};
+    std::vector<iterator_range<std::vector<int>::const_iterator>> runs = {(a.cbegin(), a.cend()), (b.cbegin(), b.cend())};
+    std::size_t allocations = 0;
+
+    {
+        auto merged = merge(std::allocator_arg, counting_allocator<char>(&allocations), runs);
+        EXPECT_LT(0u, allocations);
+        EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5}), std::vector<int>(merged.begin(), merged.end()));
+    }
+
+    EXPECT_EQ(0u, allocations);
+}
+
+#ifdef ITERATOR_BASED_FOR_TEST_PMR
+TEST(IteratorBasedForAdaptorsTest, MergeFromArena)
+{
+    std::vector<double> a = {0.5, 2.5};
+    std::vector<double> b = {1.5};
+    std::vector<std::vector<double>> runs = {a, b};
+
+    //An arena without upstream memory fails any allocation that does not come from it.
+    alignas(std::max_align_t) unsigned char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    auto merged = merge(std::allocator_arg, std::pmr::polymorphic_allocator<char>(&arena), runs);
+    EXPECT_EQ((std::vector<double>{0.5, 1.5, 2.5}), std::vector<double>(merged.begin(), merged.end()));
+}
+#endif
+
+TEST(IteratorBasedForAdaptorsTest, Cached)
+{
+    std::vector<int> v = {3, 1, 4, 1, 5};
+    int calls = 0;
+    auto decoded = cached(transform((v.cbegin(), v.cend()), [&calls](int x) {
+        ++calls;
+        return std::to_string(x);
+    }));
+
+    //A partial pass evaluates only the elements it reaches.
+    EXPECT_EQ("3", *decoded.begin());
+    EXPECT_EQ(1, calls);
+
+    EXPECT_EQ((std::vector<std::string>{"3", "1", "4", "1", "5"}),
+              std::vector<std::string>(decoded.begin(), decoded.end()));
+    EXPECT_EQ("5", *std::max_element(decoded.begin(), decoded.end()));
+    EXPECT_EQ(5, std::distance(decoded.begin(), decoded.end()));
+    EXPECT_EQ(5, calls);
+
+    //References stay valid while later elements are evaluated.
+    std::size_t allocations = 0;
+
+    {
+        std::vector<int> many(1000);
+        std::iota(many.begin(), many.end(), 0);
+        auto squares = cached(std::allocator_arg, counting_allocator<char>(&allocations),
+                              transform((many.cbegin(), many.cend()), [](int x) { return x * x; }));
+        const int& first = *squares.begin();
+        EXPECT_EQ(998001, *std::next(squares.begin(), 999));
+        EXPECT_EQ(0, first);
+        EXPECT_LT(0u, allocations);
+        EXPECT_TRUE(std::next(squares.begin(), 1000) == squares.end());
+        EXPECT_FALSE(std::next(squares.begin(), 999) == squares.end());
+    }
+
+    EXPECT_EQ(0u, allocations);
+
+    std::vector<int> empty;
+    EXPECT_TRUE(cached((empty.cbegin(), empty.cend())).empty());
+}
+
+TEST(IteratorBasedForAdaptorsTest, Instrumented)
+{
+    std::list<int> l = {1, 2, 3, 4, 5};
+    iteration_counters counters;
+    auto range = instrumented((l.cbegin(), l.cend()), counters);
+
+    int sum = 0;
+    for (int x : range) {
+        sum += x;
+    }
+
+    EXPECT_EQ(15, sum);
+#if !defined(ITERATOR_BASED_FOR_NO_INSTRUMENTATION)
+    EXPECT_EQ(5u, counters.increments);
+    EXPECT_EQ(5u, counters.dereferences);
+    EXPECT_EQ(6u, counters.comparisons);
+    EXPECT_EQ(1u, counters.passes);
+    EXPECT_EQ(0u, counters.cycles);
+
+    //Counting the elements first is a second pass over a forward range.
+    counters.reset();
+    std::vector<int> copy(range.begin(), range.end());
+    EXPECT_EQ(2u, counters.passes);
+    EXPECT_EQ(10u, counters.increments);
+
+    //Random access ranges are measured instead.
+    std::vector<int> v = {5, 3, 1, 4, 2};
+    iteration_counters timed(true);
+    auto random = instrumented((v.begin(), v.end()), timed);
+
+    EXPECT_EQ(5, random.end() - random.begin());
+    EXPECT_EQ(1u, timed.advances);
+    EXPECT_EQ(0u, timed.passes);
+
+    std::sort(random.begin(), random.end());
+    EXPECT_TRUE(std::is_sorted(v.begin(), v.end()));
+    EXPECT_LT(0u, timed.comparisons + timed.advances);
+
+    timed.reset();
+    EXPECT_TRUE(timed.track_cycles);
+    EXPECT_EQ(15, std::accumulate(random.begin(), random.end(), 0));
+    EXPECT_EQ(1u, timed.passes);
+    EXPECT_LT(0u, timed.cycles);
+
+    //Ends that are not iterators are wrapped as sentinels.
+    const char text[] = "abc";
+    iteration_counters until_nul;
+    auto letters = instrumented(iterator_range<const char*, null_sentinel>(text, null_sentinel()), until_nul);
+    std::size_t count = 0;
+
+    for (auto it = letters.begin(); it != letters.end(); ++it) {
+        ++count;
+    }
+
+    EXPECT_EQ(3u, count);
+    EXPECT_EQ(1u, until_nul.passes);
+    EXPECT_EQ(4u, until_nul.comparisons);
+#endif
+}
+
+TEST(IteratorBasedForAdaptorsTest, CheckedIsFreeWithoutCheckedMode)
+{
+    //Without ITERATOR_BASED_FOR_CHECKED, checked() returns the range itself and generation counters take no space
+    //beyond that of an empty member.
+    std::vector<int> v = {1, 2, 3};
+    generation_counter generation;
+    auto range = checked((v.begin(), v.end()), generation);
+
+    static_assert(std::is_same<decltype(range), iterator_range<std::vector<int>::iterator>>::value,
+                  "checked() must not wrap the iterators without ITERATOR_BASED_FOR_CHECKED");
+    static_assert(std::is_empty<generation_counter>::value, "generation_counter must be empty");
+
+    generation.invalidate();
+    EXPECT_EQ(6, std::accumulate(range.begin(), range.end(), 0));
+}
+
+TEST(IteratorBasedForAdaptorsTest, OffsetRanges)
+{
+    using const_iterator = std::vector<int>::const_iterator;
+
+    static_assert(sizeof(offset_range<const_iterator>) == 8, "two 32-bit offsets");
+    static_assert(sizeof(offset_range<const_iterator, std::uint16_t>) == 4, "two 16-bit offsets");
+
+    std::vector<int> postings(100);
+    std::iota(postings.begin(), postings.end(), 0);
+    const std::vector<int>& constant_postings = postings;
+
+    std::vector<offset_range<const_iterator>> index;
+    index.push_back(make_offset_range(constant_postings.begin(),
+                                      (constant_postings.begin() + 10, constant_postings.begin() + 15)));
+    index.push_back(make_offset_range(constant_postings.begin(),
+                                      (constant_postings.end(), constant_postings.end())));
+
+    EXPECT_EQ(10u, index[0].first_offset());
+    EXPECT_EQ(5u, index[0].size());
+    EXPECT_TRUE(index[1].empty());
+
+    int sum = 0;
+
+    for (int doc : postings.begin(), index[0]) {
+        sum += doc;
+    }
+
+    EXPECT_EQ(60, sum);
+    EXPECT_EQ(14, index[0].at(constant_postings.begin()).back());
+    EXPECT_TRUE((constant_postings.begin(), index[1]).empty());
+    EXPECT_TRUE(index[0] == offset_range<const_iterator>(10, 15));
+
+    int buffer[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    auto tail = make_offset_range<std::uint8_t>(&buffer[0], ptr_range(buffer).drop(6));
+    auto resolved = (&buffer[0], tail);
+    EXPECT_EQ(15, std::accumulate(resolved.begin(), resolved.end(), 0));
+
+    std::vector<int> large(300);
+    EXPECT_THROW(make_offset_range<std::uint8_t>(large.begin(), (large.begin(), large.end())), std::out_of_range);
+    EXPECT_THROW(make_offset_range(large.begin() + 1, (large.begin(), large.end())), std::out_of_range);
+}
+
+TEST(IteratorBasedForAdaptorsTest, Stride)
+{
+    std::vector<int> v(10);
+    std::iota(v.begin(), v.end(), 0);
+    std::vector<int> every_third;
+
+    for (int x : stride((v.begin(), v.end()), 3)) {
+        every_third.push_back(x);
+    }
+
+    EXPECT_EQ(std::vector<int>({0, 3, 6, 9}), every_third);
+
+    std::list<int> l(v.begin(), v.end());
+    auto odd = stride((std::next(l.begin()), l.end()), 2);
+    EXPECT_EQ(std::vector<int>({1, 3, 5, 7, 9}), std::vector<int>(odd.begin(), odd.end()));
+    EXPECT_EQ(10, std::distance(stride((l.begin(), l.end()), 0).begin(), stride((l.begin(), l.end()), 0).end()));
+
+    std::istringstream input("1 2 3 4 5 6 7");
+    auto stream = stride((std::istream_iterator<int>(input), std::istream_iterator<int>()), 4);
+    EXPECT_EQ(std::vector<int>({1, 5}), std::vector<int>(stream.begin(), stream.end()));
+    EXPECT_TRUE(stride((v.end(), v.end()), 2).empty());
+}
+
+TEST(IteratorBasedForAdaptorsTest, Grid)
+{
+    std::vector<int> v(20);
+    std::iota(v.begin(), v.end(), 0);
+
+    auto rows = grid((v.begin(), v.begin() + 15), {3, 5});
+    EXPECT_EQ(15, std::distance(rows.begin(), rows.end()));
+    EXPECT_EQ(std::vector<int>(v.begin(), v.begin() + 15), std::vector<int>(rows.begin(), rows.end()));
+
+    auto tiles = grid<traversal::tiled<2>>((v.begin(), v.end()), {3, 5});
+    EXPECT_EQ(std::vector<int>({0, 1, 5, 6, 2, 3, 7, 8, 4, 9, 10, 11, 12, 13, 14}),
+              std::vector<int>(tiles.begin(), tiles.end()));
+
+    auto z = grid<traversal::morton>((v.begin(), v.end()), {4, 4});
+    EXPECT_EQ(std::vector<int>({0, 1, 4, 5, 2, 3, 6, 7, 8, 9, 12, 13, 10, 11, 14, 15}),
+              std::vector<int>(z.begin(), z.end()));
+
+    for (auto it = z.begin(); it != z.end(); ++it) {
+        EXPECT_EQ(static_cast<int>(it.coordinates()[0] * 4 + it.coordinates()[1]), *it);
+    }
+
+    //Extents other than powers of two skip the coordinates outside of them.
+    std::vector<int> visited;
+
+    for (int x : grid<traversal::morton>((v.begin(), v.end()), {3, 5})) {
+        visited.push_back(x);
+    }
+
+    EXPECT_EQ(std::vector<int>({0, 1, 5, 6, 2, 3, 7, 8, 10, 11, 12, 13, 4, 9, 14}), visited);
+
+    //A 2 x 3 x 4 block inside a 4 x 6 x 8 volume, visited in every order.
+    std::vector<int> volume(4 * 6 * 8);
+    std::iota(volume.begin(), volume.end(), 0);
+    auto block = (volume.cbegin() + 48 + 2 * 8 + 3, volume.cend());
+    std::vector<int> expected;
+
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            for (int k = 0; k < 4; ++k) {
+                expected.push_back(51 + 16 + i * 48 + j * 8 + k);
+            }
+        }
+    }
+
+    auto sorted = [](auto _range) {
+        std::vector<int> elements(_range.begin(), _range.end());
+        std::sort(elements.begin(), elements.end());
+        return elements;
+    };
+
+    EXPECT_EQ(expected, sorted(grid(block, {2, 3, 4}, {48, 8, 1})));
+    EXPECT_EQ(expected, sorted(grid<traversal::tiled<3>>(block, {2, 3, 4}, {48, 8, 1})));
+    EXPECT_EQ(expected, sorted(grid<traversal::morton>(block, {2, 3, 4}, {48, 8, 1})));
+
+    //A five-point stencil over the interior of a 5 x 5 image.
+    std::vector<int> image(25);
+    std::iota(image.begin(), image.end(), 0);
+    auto interior = grid<traversal::morton>((image.begin() + 6, image.end()), {3, 3}, {5, 1});
+    int checksum = 0;
+
+    for (auto it = interior.begin(); it != interior.end(); ++it) {
+        const int sum = it.neighbor({{-1, 0}}) + it.neighbor({{1, 0}}) + it.neighbor({{0, -1}}) + it.neighbor({{0, 1}});
+        EXPECT_EQ(4 * *it, sum);
+        checksum += *it;
+    }
+
+    EXPECT_EQ(9 * 12, checksum);
+
+    EXPECT_THROW(grid((v.begin(), v.end()), {3, 7}), std::out_of_range);
+    EXPECT_THROW(grid((v.begin(), v.end()), {2, 2}, {-1, 1}), std::out_of_range);
+    EXPECT_TRUE(grid<traversal::morton>((v.begin(), v.begin()), {0, 3}).empty());
+    EXPECT_EQ(1, std::distance(grid<traversal::tiled<4>>((v.begin(), v.end()), {1}).begin(),
+                               grid<traversal::tiled<4>>((v.begin(), v.end()), {1}).end()));
+}
+
+TEST(IteratorBasedForAdaptorsTest, Sample)
+{
+    std::mt19937 rng(42);
+    std::vector<int> v(20);
+    std::iota(v.begin(), v.end(), 0);
+
+    EXPECT_EQ(v, sample((v.begin(), v.end()), 25, rng));
+    EXPECT_TRUE(sample((v.begin(), v.end()), 0, rng).empty());
+
+    //Every element is picked with probability k / n.
+    std::vector<int> picks(v.size());
+
+    for (int trial = 0; trial < 20000; ++trial) {
+        std::vector<int> chosen = sample((v.begin(), v.end()), 5, rng);
+        ASSERT_EQ(5u, chosen.size());
+        std::sort(chosen.begin(), chosen.end());
+        EXPECT_TRUE(std::adjacent_find(chosen.begin(), chosen.end()) == chosen.end());
+
+        for (int x : chosen) {
+            ++picks[static_cast<std::size_t>(x)];
+        }
+    }
+
+    for (int count : picks) {
+        EXPECT_NEAR(5000, count, 300);
+    }
+
+    std::istringstream input("10 20 30 40 50 60 70 80 90");
+    std::vector<int> telemetry = sample((std::istream_iterator<int>(input), std::istream_iterator<int>()), 3, rng);
+    EXPECT_EQ(3u, telemetry.size());
+    EXPECT_TRUE(input.eof());
+
+    std::vector<int> large(1000000);
+    std::iota(large.begin(), large.end(), 0);
+    std::vector<int> few = sample((large.begin(), large.end()), 10, rng);
+    EXPECT_EQ(10u, few.size());
+}
@@ -0,0 +1,1435 @@
+#include <gtest/gtest.h>
+#include <IteratorBasedForAlgorithm.hpp>
+#include "IteratorBasedForTestAllocator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+using IteratorBasedForTest::counting_allocator;
+
+TEST(IteratorBasedForAlgorithmTest, IsContiguousByteRange)
+{
+    EXPECT_TRUE((is_contiguous_byte_range<std::string::iterator, std::string::iterator>::value));
+    EXPECT_TRUE((is_contiguous_byte_range<std::vector<unsigned char>::const_iterator,
+                                          std::vector<unsigned char>::const_iterator>::value));
+    EXPECT_TRUE((is_contiguous_byte_range<const signed char*, const signed char*>::value));
+    EXPECT_FALSE((is_contiguous_byte_range<std::vector<int>::iterator, std::vector<int>::iterator>::value));
+    EXPECT_FALSE((is_contiguous_byte_range<std::list<char>::iterator, std::list<char>::iterator>::value));
+    EXPECT_FALSE((is_contiguous_byte_range<std::string::iterator, null_sentinel>::value));
+}
+
+TEST(IteratorBasedForAlgorithmTest, FindAndCountBytes)
+{
+    std::string line("2024-01-01 12:00:00,INFO,parser,message with, commas");
+    auto range = (line.begin(), line.end());
+
+    EXPECT_EQ(line.begin() + 19, find(range, ','));
+    EXPECT_EQ(line.end(), find(range, '#'));
+    EXPECT_EQ(line.begin() + 4, find(range, '-'));
+    EXPECT_EQ(line.begin() + 10, find((line.begin() + 5, line.end()), ' '));
+    EXPECT_EQ(line.begin() + 3, find((line.begin() + 3, line.begin() + 3), ','));
+    EXPECT_EQ(4u, count(range, ','));
+    EXPECT_EQ(0u, count(range, '#'));
+
+    std::string delimiters(",: ");
+    EXPECT_EQ(line.begin() + 10, find_first_of(range, (delimiters.begin(), delimiters.end())));
+    EXPECT_EQ(line.begin() + 19, find_first_of(range, (delimiters.begin(), delimiters.begin() + 1)));
+    EXPECT_EQ(line.end(), find_first_of(range, (delimiters.begin(), delimiters.begin())));
+
+    std::string many("#$%&'()*+;<=>?@[]^_`{|}~,");
+    EXPECT_EQ(line.begin() + 19, find_first_of(range, (many.begin(), many.end())));
+
+    std::vector<unsigned char> bytes(5000, 0xff);
+    bytes[4321] = 0;
+    EXPECT_EQ(bytes.begin() + 4321, find((bytes.begin(), bytes.end()), 0));
+    EXPECT_EQ(4999u, count((bytes.cbegin(), bytes.cend()), 0xff));
+
+#if defined(__cpp_lib_byte)
+    std::vector<std::byte> raw(100, std::byte{1});
+    raw[50] = std::byte{2};
+    EXPECT_EQ(raw.begin() + 50, find((raw.begin(), raw.end()), std::byte{2}));
+    EXPECT_EQ(99u, count((raw.begin(), raw.end()), std::byte{1}));
+#endif
+}
+
+TEST(IteratorBasedForAlgorithmTest, GenericFallbacks)
+{
+    std::list<int> l({3, 1, 4, 1, 5, 9, 2, 6});
+    auto range = (l.begin(), l.end());
+    std::vector<int> needles({9, 5});
+
+    EXPECT_EQ(std::find(l.begin(), l.end(), 4), find(range, 4));
+    EXPECT_EQ(2u, count(range, 1));
+    EXPECT_EQ(std::find(l.begin(), l.end(), 5), find_first_of(range, (needles.begin(), needles.end())));
+
+    std::vector<char> text({'a', 'b', ',', 'c', '\0'});
+    EXPECT_EQ(text.begin() + 2, find((text.begin(), null_sentinel()), ','));
+    EXPECT_EQ(1u, count((text.begin(), null_sentinel()), 'c'));
+}
+
+TEST(IteratorBasedForAlgorithmTest, IndexLoops)
+{
+    static_assert(is_index_loop_range<std::vector<float>::iterator, std::vector<float>::iterator>::value,
+                  "vectors are walked with index loops");
+    static_assert(!is_index_loop_range<std::list<float>::iterator, std::list<float>::iterator>::value,
+                  "lists are not contiguous");
+    static_assert(!is_index_loop_range<std::deque<float>::iterator, std::deque<float>::iterator>::value,
+                  "deques are walked segment by segment");
+
+    //1000 elements leave a remainder after the blocks of the index loop.
+    std::vector<float> v(1000);
+    std::iota(v.begin(), v.end(), 0.0f);
+    std::vector<const float*> visited;
+
+    for_each((v.cbegin(), v.cend()), [&visited](const float& x) { visited.push_back(&x); });
+    ASSERT_EQ(v.size(), visited.size());
+
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        EXPECT_EQ(&v[i], visited[i]);
+    }
+
+    for_each((v.begin(), v.end()), [](float& x) { x = x * 2.0f + 1.0f; });
+    EXPECT_EQ(1.0f, v.front());
+    EXPECT_EQ(1999.0f, v.back());
+
+    std::vector<float> out(v.size());
+    EXPECT_EQ(out.end(), transform((v.cbegin(), v.cend()), out.begin(), [](float x) { return x - 1.0f; }));
+    EXPECT_EQ(0.0f, out.front());
+    EXPECT_EQ(1998.0f, out.back());
+
+    //In place, and with an output that starts inside the input, the results are those of storing them one by one.
+    std::vector<float> expected(v);
+    std::transform(expected.begin(), expected.end(), expected.begin(), [](float x) { return x / 2.0f; });
+    transform((v.begin(), v.end()), v.begin(), [](float x) { return x / 2.0f; });
+    EXPECT_EQ(expected, v);
+
+    std::transform(expected.begin(), expected.end() - 1, expected.begin() + 1, [](float x) { return x + 1.0f; });
+    EXPECT_EQ(v.end(), transform((v.begin(), v.end() - 1), v.begin() + 1, [](float x) { return x + 1.0f; }));
+    EXPECT_EQ(expected, v);
+
+    std::vector<float> empty;
+    EXPECT_EQ(out.begin(), transform((empty.cbegin(), empty.cend()), out.begin(), [](float x) { return x; }));
+    visited.clear();
+    for_each((empty.begin(), empty.end()), [&visited](float& x) { visited.push_back(&x); });
+    EXPECT_TRUE(visited.empty());
+}
+
+TEST(IteratorBasedForAlgorithmTest, SizeClasses)
+{
+    EXPECT_EQ(max_tiny_range, tiny_range_threshold());
+    EXPECT_EQ(size_class::tiny, classify_size(0));
+    EXPECT_EQ(size_class::tiny, classify_size(16));
+    EXPECT_EQ(size_class::medium, classify_size(17));
+    EXPECT_EQ(size_class::medium, classify_size(std::size_t(1) << 30));
+    EXPECT_EQ(size_class::large, classify_size(parallel_range_threshold(), true));
+    EXPECT_EQ(size_class::medium, classify_size(parallel_range_threshold() - 1, true));
+
+    //Every size up to and past the tiny ones visits the elements in order, whatever the threshold.
+    for (std::size_t threshold : {std::size_t(0), std::size_t(5), max_tiny_range, max_tiny_range + 10}) {
+        set_tiny_range_threshold(threshold);
+        EXPECT_GE(max_tiny_range, tiny_range_threshold());
+
+        for (std::size_t n = 0; n <= 20; ++n) {
+            std::vector<int> v(n);
+            std::iota(v.begin(), v.end(), 1);
+            std::vector<int> visited;
+
+            for_each((v.cbegin(), v.cend()), [&visited](int x) { visited.push_back(x); });
+            EXPECT_EQ(v, visited);
+
+            std::vector<int> squares(n + 1, -1);
+            EXPECT_EQ(squares.begin() + static_cast<std::ptrdiff_t>(n),
+                      transform((v.cbegin(), v.cend()), squares.begin(), [](int x) { return x * x; }));
+            EXPECT_EQ(-1, squares.back());
+
+            for (std::size_t i = 0; i < n; ++i) {
+                EXPECT_EQ(v[i] * v[i], squares[i]);
+            }
+
+            std::vector<float> odd;
+            std::vector<float> f(v.begin(), v.end());
+            copy_if((f.cbegin(), f.cend()), std::back_inserter(odd), [](float x) { return static_cast<int>(x) % 2; });
+            EXPECT_EQ((n + 1) / 2, odd.size());
+
+            std::string bytes(n, 'a');
+            EXPECT_EQ(n, count((bytes.cbegin(), bytes.cend()), 'a'));
+
+            std::vector<int> best;
+            top_k((v.cbegin(), v.cend()), 3, std::back_inserter(best));
+            EXPECT_EQ(std::min<std::size_t>(n, 3), best.size());
+            EXPECT_TRUE(best.empty() || best.front() == static_cast<int>(n));
+        }
+    }
+
+    set_tiny_range_threshold(max_tiny_range);
+}
+
+TEST(IteratorBasedForAlgorithmTest, Equal)
+{
+    std::string a("delimited,fields"), b("delimited,fields"), c("delimited,field!");
+    std::vector<char> v(a.begin(), a.end());
+    std::list<char> l(a.begin(), a.end());
+
+    EXPECT_TRUE(equal((a.begin(), a.end()), (b.begin(), b.end())));
+    EXPECT_FALSE(equal((a.begin(), a.end()), (c.begin(), c.end())));
+    EXPECT_FALSE(equal((a.begin(), a.end()), (b.begin(), b.end() - 1)));
+    EXPECT_TRUE(equal((a.begin(), a.begin()), (c.begin(), c.begin())));
+    EXPECT_TRUE(equal((a.cbegin(), a.cend()), (v.begin(), v.end())));
+    EXPECT_TRUE(equal((v.begin(), v.end()), (l.begin(), l.end())));
+    EXPECT_FALSE(equal((l.begin(), l.end()), (c.begin(), c.end())));
+}
+
+TEST(IteratorBasedForAlgorithmTest, ChecksumsAndHashes)
+{
+    std::string digits = "123456789";
+    std::vector<unsigned char> zeros(32, 0), ones(32, 0xff);
+
+    EXPECT_EQ(0xE3069283u, crc32c((digits.cbegin(), digits.cend())));
+    EXPECT_EQ(0x8A9136AAu, crc32c((zeros.cbegin(), zeros.cend())));
+    EXPECT_EQ(0x62A8AB43u, crc32c((ones.cbegin(), ones.cend())));
+    EXPECT_EQ(0u, crc32c((digits.cbegin(), digits.cbegin())));
+
+    std::string empty, sentence = "Nobody inspects the spammish repetition";
+    EXPECT_EQ(0xEF46DB3751D8E999u, xxhash64((empty.cbegin(), empty.cend())));
+    EXPECT_EQ(0xFBCEA83C8A378BF1u, xxhash64((sentence.cbegin(), sentence.cend())));
+    EXPECT_NE(xxhash64((sentence.cbegin(), sentence.cend())), xxhash64((sentence.cbegin(), sentence.cend()), 1));
+
+    //Lengths around the interleaved blocks, compared with the tables and continued across a split.
+    std::vector<std::uint8_t> bytes(3 * 3 * simd::crc32c_stream_bytes + 11);
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<std::uint8_t>(i * 131 + (i >> 7));
+    }
+
+    for (std::size_t n : {std::size_t(7), 3 * simd::crc32c_stream_bytes - 1, 3 * simd::crc32c_stream_bytes,
+                          bytes.size()}) {
+        const std::uint32_t crc = crc32c((bytes.cbegin(), bytes.cbegin() + std::ptrdiff_t(n)));
+        EXPECT_EQ(~simd::crc32c_software(~0u, bytes.data(), n), crc);
+
+        const auto middle = bytes.cbegin() + std::ptrdiff_t(n / 3);
+        EXPECT_EQ(crc, crc32c((middle, bytes.cbegin() + std::ptrdiff_t(n)), crc32c((bytes.cbegin(), middle))));
+    }
+}
+
+TEST(IteratorBasedForAlgorithmTest, Utf8)
+{
+    const std::string text = "ascii \xC3\xA9 \xE6\x97\xA5 \xF0\x9F\x98\x80";
+    EXPECT_TRUE(validate_utf8((text.cbegin(), text.cend())));
+
+    for (const std::string& invalid : {std::string("\xC0\xAF"), std::string("\xED\xA0\x80"),
+                                      std::string("\xF4\x90\x80\x80"), std::string("\xE6\x97"),
+                                      std::string("a\x80"), std::string("\xFF")}) {
+        std::string padded(40, 'x');
+        padded += invalid;
+        EXPECT_FALSE(validate_utf8((invalid.cbegin(), invalid.cend())));
+        EXPECT_FALSE(validate_utf8((padded.cbegin(), padded.cend())));
+
+        std::u16string out(padded.size(), u'\0');
+        EXPECT_THROW(utf8_to_utf16((padded.cbegin(), padded.cend()), out.begin()), std::invalid_argument);
+    }
+
+    std::u16string out(text.size(), u'\0');
+    out.erase(utf8_to_utf16((text.cbegin(), text.cend()), out.begin()), out.end());
+    EXPECT_TRUE(u"ascii é 日 \U0001F600" == out);
+
+    //A sequence across the blocks that are transcoded into a buffer before they are copied to the output.
+    std::string long_text(4094, 'a');
+    for (int i = 0; i < 100; ++i) {
+        long_text += "\xE6\x97\xA5\xC3\xA9";
+    }
+
+    std::u16string expected(4094, u'a');
+    for (int i = 0; i < 100; ++i) {
+        expected += u"日é";
+    }
+
+    std::u16string appended;
+    utf8_to_utf16((long_text.cbegin(), long_text.cend()), std::back_inserter(appended));
+    EXPECT_TRUE(expected == appended);
+}
+
+TEST(IteratorBasedForAlgorithmTest, ByteswapAndDecode)
+{
+    const std::vector<std::uint8_t> bytes = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09};
+
+    auto big = decode_be<std::uint32_t>((bytes.cbegin(), bytes.cend()));
+    auto little = decode_le<std::uint16_t>((bytes.cbegin() + 1, bytes.cend()));
+    ASSERT_EQ(2u, big.size());
+    ASSERT_EQ(4u, little.size());
+    EXPECT_EQ(0x01020304u, *big.begin());
+    EXPECT_EQ(0x05060708u, big.begin()[1]);
+    EXPECT_EQ(0x0302u, *little.begin());
+    EXPECT_EQ(0x0908u, little.begin()[3]);
+
+    //Blocks of decode_block values and a partial one, into contiguous and other outputs.
+    std::vector<std::uint8_t> records(8 * (2 * decode_block + 5));
+    std::vector<std::uint64_t> expected(records.size() / 8);
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        records[i] = static_cast<std::uint8_t>(i * 29 + 3);
+        expected[i / 8] = expected[i / 8] << 8 | records[i];
+    }
+
+    auto values = decode_be<std::uint64_t>((records.cbegin(), records.cend()));
+    std::vector<std::uint64_t> decoded(values.size());
+    EXPECT_EQ(decoded.end(), copy(values, decoded.begin()));
+    EXPECT_EQ(expected, decoded);
+
+    std::list<std::uint64_t> listed;
+    copy(values, std::back_inserter(listed));
+    EXPECT_TRUE(std::equal(listed.begin(), listed.end(), expected.begin()));
+
+    EXPECT_EQ(std::accumulate(expected.begin(), expected.end(), std::uint64_t(0)), reduce(values, std::uint64_t(0)));
+
+    std::size_t calls = 0;
+    for_each(values, [&calls, &expected](std::uint64_t _x) { EXPECT_EQ(expected[calls++], _x); });
+    EXPECT_EQ(expected.size(), calls);
+
+    std::vector<std::uint64_t> swapped(expected.size());
+    std::vector<std::uint64_t> native(expected.size());
+    std::memcpy(native.data(), records.data(), records.size());
+    byteswap_copy((native.cbegin(), native.cend()), swapped.begin());
+    EXPECT_EQ(native_byte_order() == byte_order::little ? expected : native, swapped);
+
+    std::deque<std::uint16_t> words = {0x1234, 0xABCD};
+    std::vector<std::uint16_t> swapped_words;
+    byteswap_copy((words.cbegin(), words.cend()), std::back_inserter(swapped_words));
+    EXPECT_EQ((std::vector<std::uint16_t>{0x3412, 0xCDAB}), swapped_words);
+
+    const float one = 1.0f;
+    std::uint8_t one_big[4];
+    std::uint32_t one_bits;
+    std::memcpy(&one_bits, &one, 4);
+    for (int i = 0; i < 4; ++i) {
+        one_big[i] = static_cast<std::uint8_t>(one_bits >> (24 - 8 * i));
+    }
+    EXPECT_EQ(1.0f, *decode_be<float>(ptr_range(one_big, 4)).begin());
+}
+
+TEST(IteratorBasedForAlgorithmTest, CopyAndMove)
+{
+    EXPECT_TRUE((is_bulk_copyable<std::vector<int>::const_iterator, std::vector<int>::const_iterator,
+                                  std::vector<int>::iterator>::value));
+    EXPECT_TRUE((is_bulk_copyable<const double*, const double*, double*>::value));
+    EXPECT_FALSE((is_bulk_copyable<std::vector<int>::iterator, std::vector<int>::iterator,
+                                   std::vector<int>::const_iterator>::value));
+    EXPECT_FALSE((is_bulk_copyable<std::vector<int>::iterator, std::vector<int>::iterator,
+                                   std::vector<long>::iterator>::value));
+    EXPECT_FALSE((is_bulk_copyable<std::vector<std::string>::iterator, std::vector<std::string>::iterator,
+                                   std::vector<std::string>::iterator>::value));
+    EXPECT_FALSE((is_bulk_copyable<std::list<int>::iterator, std::list<int>::iterator, int*>::value));
+
+    std::vector<int> source(1000);
+    std::iota(source.begin(), source.end(), 0);
+    std::vector<int> destination(1000, -1);
+
+    EXPECT_EQ(destination.begin() + 998, copy((source.cbegin() + 1, source.cend() - 1), destination.begin()));
+    EXPECT_EQ(std::vector<int>(source.begin() + 1, source.end() - 1),
+              std::vector<int>(destination.begin(), destination.end() - 2));
+    EXPECT_EQ(-1, destination.back());
+
+    //Overlapping copy towards the front.
+    copy((source.begin() + 10, source.end()), source.begin());
+    EXPECT_EQ(10, source[0]);
+    EXPECT_EQ(999, source[989]);
+
+    std::list<int> l;
+    copy((destination.begin(), destination.begin() + 3), std::back_inserter(l));
+    EXPECT_EQ(std::list<int>({1, 2, 3}), l);
+
+    std::vector<std::string> words({"alpha", "beta"});
+    std::vector<std::string> moved(2);
+    move((words.begin(), words.end()), moved.begin());
+    EXPECT_EQ(std::vector<std::string>({"alpha", "beta"}), moved);
+}
+
+TEST(IteratorBasedForAlgorithmTest, CopyWithStreamingStores)
+{
+    std::size_t previous = streaming_threshold();
+    set_streaming_threshold(0);
+
+    for (std::size_t n : {0u, 1u, 15u, 17u, 100u, 4099u}) {
+        std::vector<unsigned char> source(n + 3);
+        std::vector<unsigned char> destination(n + 3, 0);
+
+        for (std::size_t i = 0; i < source.size(); ++i) {
+            source[i] = static_cast<unsigned char>(i * 7);
+        }
+
+        //Odd offsets exercise the unaligned head and tail of the streaming copy.
+        copy((source.cbegin() + 1, source.cbegin() + 1 + static_cast<std::ptrdiff_t>(n)), destination.begin() + 3);
+        EXPECT_TRUE(std::equal(source.begin() + 1, source.begin() + 1 + static_cast<std::ptrdiff_t>(n),
+                               destination.begin() + 3));
+        EXPECT_EQ(0, destination[0]);
+    }
+
+    set_streaming_threshold(previous);
+    EXPECT_EQ(previous, streaming_threshold());
+}
+
+TEST(IteratorBasedForAlgorithmTest, ToContainer)
+{
+    std::vector<int> v(1000);
+    std::iota(v.begin(), v.end(), 0);
+
+    //Sized ranges, contiguous and not, are reserved for exactly.
+    std::vector<int> copied = to<std::vector<int>>((v.cbegin() + 10, v.cend()));
+    EXPECT_EQ(std::vector<int>(v.begin() + 10, v.end()), copied);
+    EXPECT_EQ(copied.size(), copied.capacity());
+
+    std::deque<int> d(v.begin(), v.end());
+    std::vector<double> widened = to<std::vector<double>>((d.cbegin(), d.cend()));
+    EXPECT_EQ(std::vector<double>(v.begin(), v.end()), widened);
+    EXPECT_EQ(widened.size(), widened.capacity());
+
+    //Ranges of unknown size cross several chunks and still allocate the container once.
+    std::list<int> l(v.begin(), v.end());
+    std::vector<int> listed = to<std::vector>((l.cbegin(), l.cend()));
+    EXPECT_EQ(v, listed);
+    EXPECT_EQ(listed.size(), listed.capacity());
+
+    std::istringstream input("3 1 4 1 5 9 2 6");
+    std::vector<int> parsed = to<std::vector<int>>((std::istream_iterator<int>(input), std::istream_iterator<int>()));
+    EXPECT_EQ((std::vector<int>{3, 1, 4, 1, 5, 9, 2, 6}), parsed);
+
+    std::string text = "materialized";
+    EXPECT_EQ(text, to<std::string>((text.cbegin(), text.cend())));
+
+    //Containers without reserve().
+    EXPECT_EQ(l, to<std::list>((v.cbegin(), v.cend())));
+    EXPECT_EQ((std::set<int>{1, 2, 4, 5, 9}), to<std::set<int>>((parsed.cbegin() + 1, parsed.cbegin() + 7)));
+    EXPECT_TRUE(to<std::vector<int>>((v.cbegin(), v.cbegin())).empty());
+}
+
+TEST(IteratorBasedForAlgorithmTest, StreamingPolicy)
+{
+    EXPECT_EQ(0u, execution::streaming.threshold());
+    EXPECT_EQ(128u, execution::streaming.above(128).threshold());
+    EXPECT_EQ(last_level_cache_size(), execution::streaming.automatic().threshold());
+    EXPECT_LT(0u, last_level_cache_size());
+
+    //Sizes around the streaming block exercise partial blocks, and the offset an unaligned destination.
+    for (std::size_t n : {0u, 1u, 5u, 1023u, 1024u, 3000u}) {
+        std::vector<float> in(n);
+        std::vector<float> out(n + 1, -1.0f);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            in[i] = static_cast<float>(i);
+        }
+
+        auto end = transform(execution::streaming, (in.cbegin(), in.cend()), out.begin() + 1,
+                             [](float x) { return x * 2.0f; });
+        EXPECT_EQ(out.end(), end);
+        EXPECT_EQ(-1.0f, out[0]);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            EXPECT_EQ(2.0f * static_cast<float>(i), out[i + 1]);
+        }
+
+        fill(execution::streaming, (out.begin() + 1, out.end()), 7.0f);
+        EXPECT_EQ(static_cast<std::ptrdiff_t>(n), std::count(out.begin(), out.end(), 7.0f));
+
+        std::vector<float> copied(n, 0.0f);
+        copy(execution::streaming, (out.cbegin() + 1, out.cend()), copied.begin());
+        EXPECT_TRUE(std::equal(copied.begin(), copied.end(), out.begin() + 1));
+    }
+
+    //Below the threshold and for non-contiguous outputs the elements are stored normally.
+    std::vector<int> values = {1, 2, 3};
+    fill(execution::streaming.above(1 << 20), (values.begin(), values.end()), 4);
+    EXPECT_EQ(std::vector<int>({4, 4, 4}), values);
+
+    std::list<int> squares;
+    transform(execution::streaming, (values.cbegin(), values.cend()), std::back_inserter(squares),
+              [](int x) { return x * x; });
+    EXPECT_EQ(std::list<int>({16, 16, 16}), squares);
+}
+
+TEST(IteratorBasedForAlgorithmTest, SegmentedDeque)
+{
+    EXPECT_FALSE((is_segmented_range<std::vector<int>::iterator, std::vector<int>::iterator>::value));
+#if defined(__GLIBCXX__)
+    EXPECT_TRUE((is_segmented_range<std::deque<int>::iterator, std::deque<int>::iterator>::value));
+    EXPECT_TRUE((is_segmented_range<std::deque<int>::const_iterator, std::deque<int>::const_iterator>::value));
+#endif
+
+    std::deque<int> d(1000);
+    std::iota(d.begin(), d.end(), 0);
+
+    //Sub-ranges inside one block, across one boundary and across many blocks, including empty ones.
+    const std::pair<std::size_t, std::size_t> bounds[] = {{0, 0}, {3, 10}, {100, 300}, {0, 1000}, {127, 128},
+                                                           {128, 256}, {5, 995}};
+
+    for (const auto& b : bounds) {
+        auto first = d.cbegin() + static_cast<std::ptrdiff_t>(b.first);
+        auto last = d.cbegin() + static_cast<std::ptrdiff_t>(b.second);
+
+        std::size_t elements = 0;
+        long sum = 0;
+        for_each_segment((first, last), [&elements](auto _first, auto _last) {
+            elements += static_cast<std::size_t>(_last - _first);
+        });
+        for_each((first, last), [&sum](int x) { sum += x; });
+        EXPECT_EQ(b.second - b.first, elements);
+        EXPECT_EQ(std::accumulate(first, last, 0L), sum);
+
+        std::vector<int> copied(b.second - b.first);
+        EXPECT_EQ(copied.end(), copy((first, last), copied.begin()));
+        EXPECT_TRUE(std::equal(copied.begin(), copied.end(), first));
+
+        std::list<int> listed;
+        copy((first, last), std::back_inserter(listed));
+        EXPECT_TRUE(std::equal(listed.begin(), listed.end(), first));
+
+        std::deque<int> target(b.second - b.first + 7, -1);
+        auto end = copy((first, last), target.begin() + 7);
+        EXPECT_TRUE(target.end() == end);
+        EXPECT_TRUE(std::equal(first, last, target.begin() + 7));
+    }
+
+    fill((d.begin() + 50, d.begin() + 700), 9);
+    EXPECT_EQ(49, d[49]);
+    EXPECT_EQ(650, std::count(d.begin() + 50, d.end(), 9));
+    EXPECT_EQ(700, d[700]);
+
+    std::deque<std::string> names(300, "a");
+    std::vector<std::string> moved(300);
+    move((names.begin(), names.end()), moved.begin());
+    EXPECT_EQ(300, std::count(moved.begin(), moved.end(), "a"));
+}
+
+TEST(IteratorBasedForAlgorithmTest, RingBuffer)
+{
+    int buffer[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+    //Five elements starting at slot 6 wrap after two of them.
+    auto ring = ring_range(buffer, 8, 6, 5);
+    std::vector<int> seen;
+
+    for (int x : ring) {
+        seen.push_back(x);
+    }
+
+    EXPECT_EQ(std::vector<int>({6, 7, 0, 1, 2}), seen);
+    EXPECT_EQ(5u, ring.size());
+    EXPECT_EQ(1, ring.begin()[3]);
+
+    auto segments = ring_segments(ring);
+    EXPECT_EQ(buffer + 6, segments.first.data());
+    EXPECT_EQ(2u, segments.first.size());
+    EXPECT_EQ(buffer, segments.second.data());
+    EXPECT_EQ(3u, segments.second.size());
+
+    std::size_t pieces = 0;
+    for_each_segment(ring, [&pieces](int*, int*) { ++pieces; });
+    EXPECT_EQ(2u, pieces);
+
+    long sum = 0;
+    for_each(ring, [&sum](int x) { sum += x; });
+    EXPECT_EQ(16, sum);
+
+    std::vector<int> copied(5);
+    copy(ring, copied.begin());
+    EXPECT_EQ(seen, copied);
+
+    //A full buffer ends where it starts, and a range that does not wrap is a single segment.
+    auto full = ring_range(static_cast<const int*>(buffer), 8, 3, 8);
+    EXPECT_EQ(8, std::distance(full.begin(), full.end()));
+    EXPECT_EQ(3, *full.begin());
+    EXPECT_EQ(2, *(full.end() - 1));
+
+    auto flat = ring_range(buffer, 8, 1, 4);
+    EXPECT_TRUE(ring_segments(flat).second.empty());
+
+    fill(ring_range(buffer, 8, 7, 3), -1);
+    EXPECT_EQ(std::vector<int>({-1, -1, 2, 3, 4, 5, 6, -1}), std::vector<int>(buffer, buffer + 8));
+
+    ring_iterator<const int> converted = ring.begin();
+    EXPECT_EQ(6, *converted);
+    EXPECT_TRUE(ring_segments(ring_range(buffer, 8, 0, 0)).first.empty());
+}
+
+TEST(IteratorBasedForAlgorithmTest, ProxyIteratorsAndPackedBits)
+{
+    EXPECT_TRUE(is_iterator<std::vector<bool>::iterator>::value);
+    EXPECT_TRUE(is_iterator<std::vector<bool>::const_iterator>::value);
+    EXPECT_TRUE(is_iterator<std::istreambuf_iterator<char>>::value);
+
+    std::vector<bool> bits(1000);
+
+    for (std::size_t i = 0; i < bits.size(); ++i) {
+        bits[i] = i % 7 == 3 || (i >= 600 && i < 700);
+    }
+
+#if defined(__GLIBCXX__)
+    EXPECT_TRUE((is_bit_range<std::vector<bool>::iterator, std::vector<bool>::iterator>::value));
+#endif
+
+    //Sub-ranges starting and ending inside words, inside one word and across many.
+    const std::pair<std::size_t, std::size_t> bounds[] = {{0, 0}, {0, 1000}, {3, 4}, {5, 60}, {63, 65}, {70, 700},
+                                                           {600, 700}, {1, 999}};
+
+    for (const auto& b : bounds) {
+        auto first = bits.cbegin() + static_cast<std::ptrdiff_t>(b.first);
+        auto last = bits.cbegin() + static_cast<std::ptrdiff_t>(b.second);
+
+        EXPECT_EQ(static_cast<std::size_t>(std::count(first, last, true)), count((first, last), true));
+        EXPECT_EQ(static_cast<std::size_t>(std::count(first, last, false)), count((first, last), false));
+        EXPECT_TRUE(std::find(first, last, true) == find((first, last), true));
+        EXPECT_TRUE(std::find(first, last, false) == find((first, last), false));
+
+        std::vector<std::size_t> expected;
+        std::vector<std::size_t> indices;
+
+        for (std::size_t i = b.first; i < b.second; ++i) {
+            if (bits[i]) {
+                expected.push_back(i - b.first);
+            }
+        }
+
+        for_each_set_bit((first, last), [&indices](std::size_t i) { indices.push_back(i); });
+        EXPECT_EQ(expected, indices);
+    }
+
+    std::vector<bool> zeros(130, false);
+    EXPECT_TRUE(zeros.end() == find((zeros.begin(), zeros.end()), true));
+    EXPECT_EQ(0u, count((zeros.begin(), zeros.end()), true));
+
+    std::list<bool> flags({false, true, true});
+    std::vector<std::size_t> set;
+    for_each_set_bit((flags.begin(), flags.end()), [&set](std::size_t i) { set.push_back(i); });
+    EXPECT_EQ(std::vector<std::size_t>({1, 2}), set);
+}
+
+TEST(IteratorBasedForAlgorithmTest, Concat)
+{
+    std::vector<int> a = {1, 2, 3};
+    std::vector<int> b;
+    std::vector<int> c = {4, 5};
+
+    auto joined = concat((a.begin(), a.end()), (b.begin(), b.end()), (c.begin(), c.end()));
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5}), std::vector<int>(joined.begin(), joined.end()));
+    EXPECT_TRUE((is_segmented_range<decltype(joined.begin()), decltype(joined.end())>::value));
+
+    //Each range is a segment, so copies of contiguous fragments run one bulk copy per fragment.
+    std::vector<std::size_t> segment_sizes;
+    for_each_segment(joined, [&segment_sizes](std::vector<int>::iterator first, std::vector<int>::iterator last) {
+        segment_sizes.push_back(static_cast<std::size_t>(last - first));
+    });
+    EXPECT_EQ((std::vector<std::size_t>{3, 2}), segment_sizes);
+
+    std::vector<int> out(5);
+    EXPECT_EQ(out.end(), copy(joined, out.begin()));
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5}), out);
+
+    fill(make_iterator_range(std::next(joined.begin(), 2), std::next(joined.begin(), 4)), 0);
+    EXPECT_EQ((std::vector<int>{1, 2, 0}), a);
+    EXPECT_EQ((std::vector<int>{0, 5}), c);
+
+    int sum = 0;
+    for_each(joined, [&sum](int x) { sum += x; });
+    EXPECT_EQ(8, sum);
+
+    //A run-time list of fragments, with deque fragments split into their own blocks.
+    std::deque<char> d(1000, 'x');
+    std::vector<iterator_range<std::deque<char>::iterator>> fragments = {(d.begin(), d.begin() + 600),
+                                                                         (d.begin() + 600, d.end())};
+    std::size_t count = 0;
+    for_each_segment(concat(fragments), [&count](char* first, char* last) {
+        count += static_cast<std::size_t>(last - first);
+    });
+    EXPECT_EQ(1000u, count);
+    EXPECT_EQ(1000, std::distance(concat(fragments).begin(), concat(fragments).end()));
+
+    std::vector<iterator_range<std::vector<int>::iterator>> none;
+    EXPECT_TRUE(concat(none).empty());
+    EXPECT_TRUE(concat((b.begin(), b.end())).empty());
+}
+
+TEST(IteratorBasedForAlgorithmTest, Join)
+{
+    std::vector<std::vector<int>> rows = {{1, 2}, {}, {3}, {}, {4, 5, 6}, {}};
+
+    auto flat = join((rows.begin(), rows.end()));
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5, 6}), std::vector<int>(flat.begin(), flat.end()));
+    EXPECT_EQ(21, reduce(flat, 0));
+    EXPECT_EQ(720, reduce(flat, 1, [](int a, int b) { return a * b; }));
+
+    std::vector<std::size_t> segment_sizes;
+    for_each_segment(flat, [&segment_sizes](std::vector<int>::iterator first, std::vector<int>::iterator last) {
+        segment_sizes.push_back(static_cast<std::size_t>(last - first));
+    });
+    EXPECT_EQ((std::vector<std::size_t>{2, 1, 3}), segment_sizes);
+
+    std::vector<int> out(6);
+    EXPECT_EQ(out.end(), copy(flat, out.begin()));
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5, 6}), out);
+
+    //A partial joined range starts and stops inside inner ranges.
+    fill(make_iterator_range(std::next(flat.begin()), std::next(flat.begin(), 4)), 0);
+    EXPECT_EQ((std::vector<int>{1, 0}), rows[0]);
+    EXPECT_EQ((std::vector<int>{0}), rows[2]);
+    EXPECT_EQ((std::vector<int>{0, 5, 6}), rows[4]);
+
+    std::vector<std::vector<int>> empty_rows(3);
+    EXPECT_TRUE(join((empty_rows.begin(), empty_rows.end())).empty());
+
+    std::list<std::deque<int>> blocks = {std::deque<int>(1000, 1), std::deque<int>(), std::deque<int>(10, 2)};
+    EXPECT_EQ(1020, reduce(join((blocks.cbegin(), blocks.cend())), 0));
+
+    std::string text;
+    std::vector<std::string> words = {"join", "", "ed"};
+    for_each(join((words.cbegin(), words.cend())), [&text](char c) { text += c; });
+    EXPECT_EQ("joined", text);
+}
+
+TEST(IteratorBasedForAlgorithmTest, Strided)
+{
+    //Interleaved RGB pixels, of which the last one lacks its blue channel.
+    std::vector<std::uint8_t> rgb(3 * 100 - 1);
+    std::iota(rgb.begin(), rgb.end(), std::uint8_t(0));
+
+    auto green = strided((rgb.cbegin() + 1, rgb.cend()), 3);
+    auto blue = strided((rgb.cbegin() + 2, rgb.cend()), 3);
+    EXPECT_EQ(100u, green.size());
+    EXPECT_EQ(99u, blue.size());
+    EXPECT_EQ(std::uint8_t(4), green.begin()[1]);
+    EXPECT_EQ(std::uint8_t(3 * 99 + 1), *(green.end() - 1));
+    EXPECT_EQ(green.begin() + 2, std::find(green.begin(), green.end(), std::uint8_t(7)));
+
+    std::vector<std::uint8_t> expected;
+    std::vector<std::uint8_t> channel(100);
+
+    for (std::size_t i = 2; i < rgb.size(); i += 3) {
+        expected.push_back(rgb[i]);
+    }
+
+    EXPECT_EQ(channel.begin() + 99, copy(blue, channel.begin()));
+    EXPECT_EQ(expected, std::vector<std::uint8_t>(channel.begin(), channel.begin() + 99));
+
+    std::size_t sum = 0;
+    for_each(blue, [&sum](std::uint8_t x) { sum += x; });
+    EXPECT_EQ(std::accumulate(expected.begin(), expected.end(), std::size_t(0)), sum);
+
+    //A part of a strided range starts at its own element.
+    std::vector<float> iq(2 * 5000);
+    std::iota(iq.begin(), iq.end(), 0.0f);
+    auto in_phase = strided((iq.cbegin(), iq.cend()), 2);
+    std::vector<float> samples(4000);
+    copy(make_iterator_range(in_phase.begin() + 1000, in_phase.end()), samples.begin());
+
+    float sum_in_phase = 0;
+    for_each(make_iterator_range(in_phase.begin() + 1000, in_phase.end()), [&sum_in_phase](float x) {
+        sum_in_phase += x;
+    });
+
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        ASSERT_EQ(float(2 * (i + 1000)), samples[i]);
+    }
+
+    EXPECT_EQ(std::accumulate(samples.begin(), samples.end(), 0.0f), sum_in_phase);
+
+    //Mutable elements, and element types without kernels, are visited in place.
+    std::vector<int> quadrature(6, 1);
+    for_each(strided((quadrature.begin() + 1, quadrature.end()), 2), [](int& x) { x = 0; });
+    EXPECT_EQ((std::vector<int>{1, 0, 1, 0, 1, 0}), quadrature);
+
+    std::deque<long> values = {1, 2, 3, 4, 5, 6, 7};
+    auto odd = strided((values.begin(), values.end()), 2);
+    std::vector<long> copied(4);
+    copy(odd, copied.begin());
+    EXPECT_EQ((std::vector<long>{1, 3, 5, 7}), copied);
+    EXPECT_EQ(7u, strided((values.begin(), values.end()), 0).size());
+    EXPECT_TRUE(strided((values.begin(), values.begin()), 3).empty());
+}
+
+TEST(IteratorBasedForAlgorithmTest, IncrementalReduce)
+{
+    std::vector<long long> samples;
+    incremental_reduce<long long> total;
+    EXPECT_EQ(0, total.update((samples.cbegin(), samples.cend())));
+
+    //Every update adds only the new elements, even after the vector reallocated.
+    for (int batch = 1; batch <= 20; ++batch) {
+        for (int i = 0; i < batch * 10; ++i) {
+            samples.push_back(batch * 1000 + i);
+        }
+
+        const long long expected = std::accumulate(samples.begin(), samples.end(), 0LL);
+        EXPECT_EQ(expected, total.update((samples.cbegin(), samples.cend())));
+    }
+
+    EXPECT_EQ(samples.size(), total.last());
+    total.erase_front((samples.cbegin(), samples.cend()), 100, std::minus<>());
+    EXPECT_EQ(100u, total.first());
+    EXPECT_EQ(std::accumulate(samples.begin() + 100, samples.end(), 0LL), total.value());
+
+    //Strings are combined in order, across the segments of a deque.
+    std::deque<std::string> words;
+    incremental_reduce<std::string> text;
+    for (const char* word : {"in", "cre", "men", "tal"}) {
+        words.push_back(word);
+        text.update((words.cbegin(), words.cend()));
+    }
+    EXPECT_EQ("incremental", text.value());
+
+    //A sliding maximum and an order-sensitive window, compared with recomputing every window.
+    auto larger = [](int _a, int _b) { return std::max(_a, _b); };
+    windowed_reduce<int, decltype(larger)> peak(INT_MIN, larger);
+    windowed_reduce<std::string> recent;
+    std::vector<int> values;
+    std::vector<std::string> letters;
+    std::size_t first = 0;
+
+    for (int step = 0; step < 500; ++step) {
+        values.push_back(static_cast<int>((step * 7919) % 251));
+        letters.push_back(std::string(1, static_cast<char>('a' + step % 26)));
+        peak.update((values.cbegin(), values.cend()));
+        recent.update((letters.cbegin(), letters.cend()));
+
+        const std::size_t drop = step % 3 == 0 ? static_cast<std::size_t>(step % 5) : 0;
+        peak.erase_front(drop);
+        recent.erase_front(drop);
+        first = std::min(values.size(), first + drop);
+
+        ASSERT_EQ(values.size() - first, peak.size());
+        if (!peak.empty()) {
+            EXPECT_EQ(*std::max_element(values.begin() + std::ptrdiff_t(first), values.end()), peak.value());
+        }
+        EXPECT_EQ(std::accumulate(letters.begin() + std::ptrdiff_t(first), letters.end(), std::string()),
+                  recent.value());
+    }
+
+    peak.erase_front(values.size());
+    EXPECT_TRUE(peak.empty());
+    EXPECT_EQ(INT_MIN, peak.value());
+}
+
+TEST(IteratorBasedForAlgorithmTest, CartesianProduct)
+{
+    std::vector<int> rows = {1, 2, 3};
+    std::list<char> columns = {'a', 'b'};
+    std::vector<std::string> layers = {"x", "y"};
+    std::vector<std::string> expected;
+
+    for (int r : rows) {
+        for (char c : columns) {
+            for (const std::string& l : layers) {
+                expected.push_back(std::to_string(r) + c + l);
+            }
+        }
+    }
+
+    auto product = cartesian_product((rows.begin(), rows.end()), (columns.begin(), columns.end()),
+                                     (layers.begin(), layers.end()));
+    std::vector<std::string> stepped;
+
+    for (auto element : product) {
+        stepped.push_back(std::to_string(std::get<0>(element)) + std::get<1>(element) + std::get<2>(element));
+    }
+
+    EXPECT_EQ(expected, stepped);
+
+    std::vector<std::string> nested;
+    for_each(product, [&nested](std::tuple<int&, char&, std::string&> _element) {
+        nested.push_back(std::to_string(std::get<0>(_element)) + std::get<1>(_element) + std::get<2>(_element));
+    });
+
+    EXPECT_EQ(expected, nested);
+
+    //The elements are references into the ranges.
+    for_each(cartesian_product((rows.begin(), rows.end()), (columns.begin(), columns.end())),
+             [](std::tuple<int&, char&> _element) { ++std::get<0>(_element); });
+    EXPECT_EQ(std::vector<int>({3, 4, 5}), rows);
+
+    //A product with an empty range is empty, wherever the empty range is.
+    std::vector<int> none;
+    auto empty = cartesian_product((rows.begin(), rows.end()), (none.begin(), none.end()),
+                                   (columns.begin(), columns.end()));
+    EXPECT_TRUE(empty.begin() == empty.end());
+    int calls = 0;
+    for_each(empty, [&calls](std::tuple<int&, int&, char&>) { ++calls; });
+    EXPECT_EQ(0, calls);
+
+    //The product of a single range visits it as it is.
+    auto single = cartesian_product((rows.begin(), rows.end()));
+    int sum = 0;
+
+    for (std::tuple<int&> element : single) {
+        sum += std::get<0>(element);
+    }
+
+    EXPECT_EQ(12, sum);
+    EXPECT_TRUE(std::next(single.begin()) != single.begin());
+}
+
+TEST(IteratorBasedForAlgorithmTest, Reversed)
+{
+    std::vector<int> values = {1, 2, 3, 4, 5};
+    auto backwards = reversed((values.begin(), values.end()));
+    EXPECT_TRUE((std::is_same<decltype(backwards.begin().base()), int* const&>::value));
+    EXPECT_EQ(5u, backwards.size());
+    EXPECT_EQ(5, *backwards.begin());
+    EXPECT_EQ(3, backwards.begin()[2]);
+    EXPECT_TRUE(std::equal(values.rbegin(), values.rend(), backwards.begin(), backwards.end()));
+
+    //Suffix sums, in place.
+    int suffix = 0;
+    for_each(backwards, [&suffix](int& x) { x = suffix += x; });
+    EXPECT_EQ((std::vector<int>{15, 14, 12, 9, 5}), values);
+
+    std::vector<int> copied(5);
+    EXPECT_EQ(copied.end(), copy(backwards, copied.begin()));
+    EXPECT_EQ((std::vector<int>{5, 9, 12, 14, 15}), copied);
+    EXPECT_EQ(std::string("54295"), reduce(reversed((copied.begin(), copied.end())), std::string(),
+                                          [](std::string s, int x) { return s + std::to_string(x % 10); }));
+
+    //The last match, as a position in the reversed and in the underlying range.
+    std::vector<int> repeated = {1, 2, 1, 2, 1};
+    auto last_two = find(reversed((repeated.cbegin(), repeated.cend())), 2);
+    EXPECT_EQ(&repeated[3], &*last_two);
+    EXPECT_EQ(&repeated[4], last_two.base());
+    EXPECT_EQ(reversed((repeated.cbegin(), repeated.cend())).end(),
+              find(reversed((repeated.cbegin(), repeated.cend())), 3));
+
+    std::string text = "key=value=more";
+    for (std::size_t n = 0; n <= text.size(); ++n) {
+        auto prefix = reversed((text.cbegin(), text.cbegin() + static_cast<std::ptrdiff_t>(n)));
+        const char* expected = text.data();
+
+        for (std::size_t i = 0; i < n; ++i) {
+            expected = text[i] == '=' ? text.data() + i + 1 : expected;
+        }
+
+        ASSERT_EQ(expected, find(prefix, '=').base());
+    }
+
+    //Bidirectional iterators are walked backwards without a size.
+    std::list<int> list = {1, 2, 3};
+    std::vector<int> from_list;
+    for (int x : reversed((list.begin(), list.end()))) {
+        from_list.push_back(x);
+    }
+
+    EXPECT_EQ((std::vector<int>{3, 2, 1}), from_list);
+    EXPECT_EQ(6, reduce(reversed((list.begin(), list.end())), 0));
+    EXPECT_EQ(std::next(list.begin()), find(reversed((list.begin(), list.end())), 1).base());
+
+    auto twice = reversed(reversed((list.begin(), list.end())));
+    EXPECT_TRUE((std::is_same<decltype(twice.begin()), std::list<int>::iterator>::value));
+    EXPECT_EQ(list.begin(), twice.begin());
+    EXPECT_TRUE(reversed((list.begin(), list.begin())).empty());
+}
+
+TEST(IteratorBasedForAlgorithmTest, CopyIfAndRemoveIf)
+{
+    std::vector<float> prices(1000);
+    for (std::size_t i = 0; i < prices.size(); ++i) {
+        prices[i] = float((i * 37) % 101);
+    }
+
+    std::vector<float> expected;
+    std::copy_if(prices.begin(), prices.end(), std::back_inserter(expected), [](float x) { return x > 90; });
+
+    std::vector<float> selected(expected.size());
+    EXPECT_EQ(selected.end(), copy_if((prices.cbegin(), prices.cend()), selected.begin(), [](float x) {
+        return x > 90;
+    }));
+    EXPECT_EQ(expected, selected);
+
+    //Non-contiguous outputs and element types without kernels.
+    std::list<float> listed;
+    copy_if((prices.cbegin(), prices.cend()), std::back_inserter(listed), [](float x) { return x > 90; });
+    EXPECT_EQ(expected, std::vector<float>(listed.begin(), listed.end()));
+
+    std::vector<float> kept(prices);
+    auto end = remove_if((kept.begin(), kept.end()), [](float x) { return x <= 90; });
+    EXPECT_EQ(expected, std::vector<float>(kept.begin(), end));
+
+    std::list<std::string> words = {"a", "bb", "c", "dd", "eee"};
+    auto words_end = remove_if((words.begin(), words.end()), [](const std::string& s) { return s.size() == 1; });
+    EXPECT_EQ((std::vector<std::string>{"bb", "dd", "eee"}), std::vector<std::string>(words.begin(), words_end));
+
+    std::vector<long> none = {1, 2, 3};
+    EXPECT_EQ(none.end(), remove_if((none.begin(), none.end()), [](long x) { return x > 5; }));
+    EXPECT_EQ(none.begin(), remove_if((none.begin(), none.end()), [](long x) { return x > 0; }));
+}
+
+TEST(IteratorBasedForAlgorithmTest, TopK)
+{
+    std::mt19937 random(17);
+    std::uniform_real_distribution<float> score(0.0f, 1.0f);
+    std::vector<float> scores(100000);
+    std::generate(scores.begin(), scores.end(), [&]() { return score(random); });
+
+    std::vector<float> descending(scores);
+    std::sort(descending.begin(), descending.end(), std::greater<float>());
+
+    for (std::size_t k : {1u, 10u, 100u, 5000u}) {
+        std::vector<float> best(k);
+        EXPECT_EQ(best.end(), top_k((scores.cbegin(), scores.cend()), k, best.begin()));
+        EXPECT_EQ(std::vector<float>(descending.begin(), descending.begin() + static_cast<std::ptrdiff_t>(k)), best);
+
+        std::vector<float> worst;
+        top_k((scores.cbegin(), scores.cend()), k, std::back_inserter(worst), std::less<>());
+        EXPECT_EQ(std::vector<float>(descending.rbegin(), descending.rbegin() + static_cast<std::ptrdiff_t>(k)), worst);
+    }
+
+    //Ascending elements beat the bound every time, so the candidates are trimmed over and over.
+    std::vector<std::int32_t> ascending(20000);
+    std::iota(ascending.begin(), ascending.end(), -10000);
+    std::vector<std::int32_t> largest;
+    top_k((ascending.cbegin(), ascending.cend()), 3, std::back_inserter(largest));
+    EXPECT_EQ((std::vector<std::int32_t>{9999, 9998, 9997}), largest);
+
+    //Equivalent elements.
+    std::vector<std::uint8_t> bytes(5000);
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<std::uint8_t>((i * 7) % 10);
+    }
+
+    std::vector<std::uint8_t> smallest;
+    top_k((bytes.cbegin(), bytes.cend()), 1001, std::back_inserter(smallest), std::less<std::uint8_t>());
+    EXPECT_EQ(std::vector<std::uint8_t>(500, 0), std::vector<std::uint8_t>(smallest.begin(), smallest.begin() + 500));
+    EXPECT_EQ(std::vector<std::uint8_t>(500, 1), std::vector<std::uint8_t>(smallest.begin() + 500, smallest.end() - 1));
+    EXPECT_EQ(2, smallest.back());
+
+    //Ranges without kernels, other comparisons, and fewer elements than requested.
+    std::list<std::string> words = {"pear", "fig", "banana", "kiwi", "apple"};
+    std::vector<std::string> longest;
+    top_k((words.begin(), words.end()), 2, std::back_inserter(longest), [](const std::string& a, const std::string& b) {
+        return a.size() > b.size();
+    });
+    EXPECT_EQ((std::vector<std::string>{"banana", "apple"}), longest);
+
+    std::vector<double> few = {2.5, -1.0, 7.0};
+    std::vector<double> all;
+    top_k((few.cbegin(), few.cend()), 10, std::back_inserter(all));
+    EXPECT_EQ((std::vector<double>{7.0, 2.5, -1.0}), all);
+
+    std::vector<double> none;
+    EXPECT_EQ(none.begin(), top_k((few.cbegin(), few.cend()), 0, none.begin()));
+}
+
+TEST(IteratorBasedForAlgorithmTest, Histogram)
+{
+    std::string text = "abracadabra";
+    std::vector<std::size_t> frequencies = histogram((text.cbegin(), text.cend()), 256);
+    EXPECT_EQ(5u, frequencies['a']);
+    EXPECT_EQ(2u, frequencies['b']);
+    EXPECT_EQ(1u, frequencies['d']);
+    EXPECT_EQ(text.size(), std::accumulate(frequencies.begin(), frequencies.end(), std::size_t(0)));
+
+    //Bytes above 127 count as unsigned whatever the signedness of char.
+    std::string high = {char(200), char(200), char(1)};
+    EXPECT_EQ(2u, histogram((high.cbegin(), high.cend()), 256)[200]);
+
+    std::vector<int> ages(1003);
+    for (std::size_t i = 0; i < ages.size(); ++i) {
+        ages[i] = int((i * 7) % 90);
+    }
+
+    std::vector<std::size_t> expected(9);
+    for (int age : ages) {
+        ++expected[std::size_t(age / 10)];
+    }
+
+    auto decade = [](int age) { return age / 10; };
+    EXPECT_EQ(expected, histogram((ages.cbegin(), ages.cend()), 9, decade));
+
+    std::list<int> listed(ages.begin(), ages.end());
+    EXPECT_EQ(expected, histogram((listed.cbegin(), listed.cend()), 9, decade));
+
+    //Histograms too large for sub-histograms.
+    std::vector<std::size_t> wide = histogram((ages.cbegin(), ages.cend()), 100000);
+    EXPECT_EQ(100000u, wide.size());
+    EXPECT_EQ(std::size_t(std::count(ages.begin(), ages.end(), 42)), wide[42]);
+
+    EXPECT_THROW(histogram((ages.cbegin(), ages.cend()), 8, decade), std::out_of_range);
+    EXPECT_THROW(histogram((listed.cbegin(), listed.cend()), 8, decade), std::out_of_range);
+    EXPECT_EQ(std::vector<std::size_t>(3), histogram((ages.cend(), ages.cend()), 3));
+}
+
+TEST(IteratorBasedForAlgorithmTest, Sketches)
+{
+    std::vector<std::uint32_t> keys(20000);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = static_cast<std::uint32_t>(i * 2654435761u);
+    }
+
+    //A Bloom filter holds every key it was built from and rejects most others.
+    bloom_filter filter = build_bloom((keys.cbegin(), keys.cend()), 10 * keys.size(), 7);
+    EXPECT_EQ(262144u, filter.bits());
+    EXPECT_TRUE(std::all_of(keys.begin(), keys.end(), [&filter](std::uint32_t k) { return filter.contains(k); }));
+
+    std::size_t false_positives = 0;
+    for (std::uint32_t k = 0; k < 10000; ++k) {
+        const std::uint32_t other = k * 2654435761u + 1;
+        false_positives += std::find(keys.begin(), keys.end(), other) == keys.end() && filter.contains(other) ? 1 : 0;
+    }
+
+    EXPECT_LT(false_positives, 100u);
+
+    //Every key hashes the same whatever its type, so single insertions and blocks agree.
+    bloom_filter single(filter.bits(), filter.hashes());
+    for (std::uint32_t k : keys) {
+        single.add(static_cast<std::uint64_t>(k));
+    }
+
+    EXPECT_EQ(filter.words(), single.words());
+    EXPECT_THROW(single.merge(bloom_filter(64, 7)), std::invalid_argument);
+    EXPECT_THROW(bloom_filter(64, 0), std::invalid_argument);
+
+    //HyperLogLog counts distinct keys within a few percent, and merging counts the union.
+    std::list<std::uint32_t> repeated;
+    for (int round = 0; round < 3; ++round) {
+        repeated.insert(repeated.end(), keys.begin(), keys.begin() + 15000);
+    }
+
+    hyperloglog_sketch distinct = hyperloglog((repeated.cbegin(), repeated.cend()));
+    EXPECT_NEAR(15000.0, distinct.estimate(), 15000.0 * 0.03);
+    EXPECT_NEAR(10.0, hyperloglog((keys.cbegin(), keys.cbegin() + 10)).estimate(), 0.5);
+    EXPECT_EQ(0.0, hyperloglog_sketch().estimate());
+
+    distinct.merge(hyperloglog((keys.cbegin() + 10000, keys.cend())));
+    EXPECT_NEAR(20000.0, distinct.estimate(), 20000.0 * 0.03);
+    EXPECT_THROW(distinct.merge(hyperloglog_sketch(10)), std::invalid_argument);
+    EXPECT_THROW(hyperloglog_sketch(3), std::invalid_argument);
+
+    //Count-min never underestimates, and with few keys per counter it is exact for most.
+    std::vector<int> skewed;
+    for (int k = 0; k < 200; ++k) {
+        skewed.insert(skewed.end(), static_cast<std::size_t>(k % 10 + 1), k);
+    }
+
+    count_min_sketch counts = count_min((skewed.cbegin(), skewed.cend()), 4096, 4);
+    std::size_t exact = 0;
+    for (int k = 0; k < 200; ++k) {
+        EXPECT_GE(counts.estimate(k), static_cast<std::uint64_t>(k % 10 + 1));
+        exact += counts.estimate(k) == static_cast<std::uint64_t>(k % 10 + 1) ? 1 : 0;
+    }
+
+    EXPECT_GT(exact, 190u);
+    EXPECT_EQ(0u, counts.estimate(1000));
+
+    counts.merge(counts);
+    EXPECT_GE(counts.estimate(9), 20u);
+}
+
+TEST(IteratorBasedForAlgorithmTest, GenerateRandom)
+{
+    //The same seed gives the same values, and the pieces of a range filled on their own give those of the whole.
+    std::vector<double> whole(1003), pieces(1003), other(1003);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    generate_random((whole.begin(), whole.end()), unit, 7);
+    generate_random_at((pieces.begin(), pieces.begin() + 520), unit, 7, 0);
+    generate_random_at((pieces.begin() + 520, pieces.end()), unit, 7, 520);
+    generate_random((other.begin(), other.end()), unit, 8);
+
+    EXPECT_EQ(whole, pieces);
+    EXPECT_NE(whole, other);
+    EXPECT_TRUE(std::all_of(whole.begin(), whole.end(), [](double x) { return x >= -1.0 && x < 1.0; }));
+    EXPECT_NEAR(0.0, std::accumulate(whole.begin(), whole.end(), 0.0) / 1003, 0.1);
+    EXPECT_THROW(generate_random_at((pieces.begin(), pieces.end()), unit, 7, 6), std::invalid_argument);
+
+    //Pairs of normal values are split across pieces and an odd end alike.
+    std::vector<float> normal(20001), normal_pieces(20001);
+    std::normal_distribution<float> bell(5.0f, 2.0f);
+    generate_random((normal.begin(), normal.end()), bell, 1);
+    generate_random_at((normal_pieces.begin(), normal_pieces.begin() + 4), bell, 1, 0);
+    generate_random_at((normal_pieces.begin() + 4, normal_pieces.end()), bell, 1, 4);
+
+    const double mean = std::accumulate(normal.begin(), normal.end(), 0.0) / normal.size();
+    double variance = 0;
+    for (float x : normal) {
+        variance += (x - mean) * (x - mean) / normal.size();
+    }
+
+    EXPECT_EQ(normal, normal_pieces);
+    EXPECT_NEAR(5.0, mean, 0.05);
+    EXPECT_NEAR(4.0, variance, 0.15);
+
+    //Integers cover their closed interval, including the full range of the type.
+    std::vector<int> dice(6000);
+    generate_random((dice.begin(), dice.end()), std::uniform_int_distribution<int>(1, 6), 3);
+    std::vector<std::size_t> faces(7);
+    for (int x : dice) {
+        ASSERT_TRUE(x >= 1 && x <= 6);
+        ++faces[x];
+    }
+
+    EXPECT_TRUE(std::all_of(faces.begin() + 1, faces.end(), [](std::size_t c) { return c > 850 && c < 1150; }));
+
+    std::vector<std::uint64_t> bits(64);
+    generate_random((bits.begin(), bits.end()), std::uniform_int_distribution<std::uint64_t>(), 3);
+    EXPECT_TRUE(std::any_of(bits.begin(), bits.end(), [](std::uint64_t x) { return x >> 63; }));
+
+    std::vector<char> coins(10000);
+    generate_random((coins.begin(), coins.end()), std::bernoulli_distribution(0.25), 4);
+    EXPECT_NEAR(2500, std::count(coins.begin(), coins.end(), 1), 150);
+
+    std::vector<double> waits(10000);
+    generate_random((waits.begin(), waits.end()), std::exponential_distribution<double>(2.0), 5);
+    EXPECT_NEAR(0.5, std::accumulate(waits.begin(), waits.end(), 0.0) / waits.size(), 0.03);
+
+    //Other distributions draw every element from an engine of its own, so they are reproducible piecewise too.
+    std::vector<int> counts(101), counts_pieces(101);
+    std::poisson_distribution<int> arrivals(3.0);
+    generate_random((counts.begin(), counts.end()), arrivals, 9);
+    generate_random_at((counts_pieces.begin(), counts_pieces.begin() + 40), arrivals, 9, 0);
+    generate_random_at((counts_pieces.begin() + 40, counts_pieces.end()), arrivals, 9, 40);
+    EXPECT_EQ(counts, counts_pieces);
+}
+
+TEST(IteratorBasedForAlgorithmTest, PhiloxEngine)
+{
+    philox_engine engine(11, 2);
+    std::vector<std::uint32_t> words(10);
+    for (std::uint32_t& word : words) {
+        word = engine();
+    }
+
+    std::array<std::uint32_t, 8> blocks;
+    simd::philox4x32(11, 2, 0, 2, blocks.data());
+    EXPECT_TRUE(std::equal(blocks.begin(), blocks.end(), words.begin()));
+
+    for (unsigned long long skip : {0ull, 1ull, 3ull, 4ull, 6ull}) {
+        philox_engine skipped(11, 2);
+        skipped();
+        skipped.discard(skip);
+        EXPECT_EQ(words[1 + skip], skipped());
+    }
+
+    EXPECT_NE(philox_engine(11, 3)(), philox_engine(11, 2)());
+    std::uniform_int_distribution<int> die(1, 6);
+    int roll = die(engine);
+    EXPECT_TRUE(roll >= 1 && roll <= 6);
+}
+
+TEST(IteratorBasedForAlgorithmTest, BranchlessSearch)
+{
+    std::vector<int> v;
+
+    for (int i = 0; i < 1000; ++i) {
+        v.push_back(i / 3 * 2);
+    }
+
+    for (std::size_t n : {0u, 1u, 2u, 7u, 64u, 999u}) {
+        auto range = (v.cbegin() + 1, v.cbegin() + 1 + static_cast<std::ptrdiff_t>(n));
+        auto index = make_eytzinger_index(range);
+        EXPECT_EQ(n, index.size());
+
+        for (int value = -1; value <= 700; ++value) {
+            auto expected = std::equal_range(range.begin(), range.end(), value);
+            EXPECT_EQ(expected.first, lower_bound(range, value));
+            EXPECT_EQ(expected.second, upper_bound(range, value));
+            EXPECT_EQ(expected.first, equal_range(range, value).begin());
+            EXPECT_EQ(expected.second, equal_range(range, value).end());
+            EXPECT_EQ(expected.first, index.lower_bound(value));
+            EXPECT_EQ(expected.second, index.upper_bound(value));
+            EXPECT_EQ(static_cast<std::size_t>(expected.second - expected.first), index.equal_range(value).size());
+        }
+    }
+
+    //Descending ranges are searched with the comparison they are sorted by.
+    std::vector<std::string> words = {"pear", "lime", "lime", "kiwi", "fig"};
+    auto descending = (words.begin(), words.end());
+    EXPECT_EQ(words.begin() + 1, lower_bound(descending, "lime", std::greater<>()));
+    EXPECT_EQ(words.begin() + 3, upper_bound(descending, "lime", std::greater<>()));
+    EXPECT_EQ(words.begin() + 4, make_eytzinger_index(descending, std::greater<>()).lower_bound("grape"));
+    EXPECT_EQ(words.end(), make_eytzinger_index(descending, std::greater<>()).upper_bound("apple"));
+}
+
+TEST(IteratorBasedForAlgorithmTest, Allocators)
+{
+    std::vector<int> a = {1, 2};
+    std::vector<int> b = {3};
+    std::vector<iterator_range<std::vector<int>::iterator>> fragments = {(a.begin(), a.end()), (b.begin(), b.end())};
+    std::size_t allocations = 0;
+
+    {
+        auto joined = concat(std::allocator_arg, counting_allocator<char>(&allocations), fragments);
+        EXPECT_EQ(2u, allocations);
+        EXPECT_EQ((std::vector<int>{1, 2, 3}), std::vector<int>(joined.begin(), joined.end()));
+
+        std::vector<int> sorted(100);
+        std::iota(sorted.begin(), sorted.end(), 0);
+        eytzinger_index<std::vector<int>::const_iterator, std::less<>, counting_allocator<char>> index(
+                (sorted.cbegin(), sorted.cend()), std::less<>(), counting_allocator<char>(&allocations));
+        EXPECT_EQ(4u, allocations);
+        EXPECT_EQ(sorted.cbegin() + 42, index.lower_bound(42));
+    }
+
+    EXPECT_EQ(0u, allocations);
+}
+
+TEST(IteratorBasedForAlgorithmTest, ResumableRanges)
+{
+    std::vector<int> v(1000);
+    std::iota(v.begin(), v.end(), 0);
+    std::vector<int> seen;
+
+    auto loop = make_resumable((v.cbegin(), v.cend()));
+    EXPECT_TRUE(loop.resume(300, [&seen](int x) { seen.push_back(x); }));
+    EXPECT_EQ(300u, seen.size());
+    EXPECT_EQ(700u, loop.remaining().size());
+    EXPECT_EQ(300, loop.remaining().front());
+
+    //A copy continues independently from the same position.
+    auto copy = loop;
+    EXPECT_FALSE(copy.resume(1000, [](int) { }));
+    EXPECT_TRUE(copy.done());
+    EXPECT_FALSE(loop.done());
+
+    while (loop.resume_for(std::chrono::microseconds(200), [&seen](int x) { seen.push_back(x); })) { }
+
+    EXPECT_EQ(v, seen);
+    EXPECT_TRUE(loop.remaining().empty());
+    EXPECT_FALSE(loop.resume_for(std::chrono::seconds(1), [](int) { ADD_FAILURE(); }));
+
+    //Cheap elements are processed many at a time between looks at the clock.
+    std::vector<int> many(1 << 20, 1);
+    auto cheap = make_resumable((many.cbegin(), many.cend()));
+    long sum = 0;
+    cheap.resume_for(std::chrono::milliseconds(1), [&sum](int x) { sum += x; });
+    EXPECT_LT(1u, cheap.stride());
+    EXPECT_EQ(static_cast<long>(many.size() - cheap.remaining().size()), sum);
+}
+
+TEST(IteratorBasedForAlgorithmTest, ResumableRangesKeepToTheirBudget)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::list<int> l(200, 0);
+    auto loop = make_resumable((l.cbegin(), l.cend()));
+    std::size_t processed = 0;
+    std::size_t slices = 0;
+
+    auto spin = [&processed](int) {
+        const clock::time_point until = clock::now() + std::chrono::microseconds(20);
+
+        while (clock::now() < until) { }
+
+        ++processed;
+    };
+
+    for (bool more = true; more; ++slices) {
+        const std::size_t before = processed;
+        more = loop.resume_for(std::chrono::milliseconds(1), spin);
+
+        //No more than fit into the budget, plus the elements between the last two looks at the clock.
+        EXPECT_LE(1u, processed - before);
+        EXPECT_GE(53u, processed - before);
+    }
+
+    EXPECT_EQ(l.size(), processed);
+    EXPECT_LE(4u, slices);
+}
+
+TEST(IteratorBasedForAlgorithmTest, FusedPasses)
+{
+    //A single-pass range feeds every function from one traversal.
+    std::istringstream input("4 8 15 16 23 42");
+    auto numbers = (std::istream_iterator<int>(input), std::istream_iterator<int>());
+    int calls = 0;
+    std::array<int, 2> parity = {{0, 0}};
+    std::vector<int> seen;
+
+    auto functions = for_each_fused(numbers,
+                                    [&calls](int) { ++calls; },
+                                    [&parity](int x) { ++parity[x % 2]; },
+                                    [&seen](int x) { seen.push_back(x); });
+    EXPECT_EQ(6, calls);
+    EXPECT_EQ(4, parity[0]);
+    EXPECT_EQ(std::vector<int>({4, 8, 15, 16, 23, 42}), seen);
+    std::get<0>(functions)(0);
+    EXPECT_EQ(7, calls);
+
+    //Segmented ranges are walked segment by segment, as by reduce().
+    std::deque<int> values;
+
+    for (int i = 0; i < 2000; ++i) {
+        values.push_back((i * 37) % 1001 - 500);
+    }
+
+    auto min_op = [](int a, int b) { return std::min(a, b); };
+    auto max_op = [](int a, int b) { return std::max(a, b); };
+    auto stats = reduce_many((values.begin(), values.end()), std::make_tuple(0L, INT_MAX, INT_MIN, std::size_t(0)),
+                             std::plus<>(), min_op, max_op, [](std::size_t n, int) { return n + 1; });
+
+    EXPECT_EQ(std::accumulate(values.begin(), values.end(), 0L), std::get<0>(stats));
+    EXPECT_EQ(*std::min_element(values.begin(), values.end()), std::get<1>(stats));
+    EXPECT_EQ(*std::max_element(values.begin(), values.end()), std::get<2>(stats));
+    EXPECT_EQ(values.size(), std::get<3>(stats));
+
+    std::vector<int> empty;
+    EXPECT_EQ(std::make_tuple(5), reduce_many((empty.begin(), empty.end()), std::make_tuple(5), std::plus<>()));
+}
+
+TEST(IteratorBasedForAlgorithmTest, UniqueAndRunLength)
+{
+    std::vector<std::uint32_t> ids;
+
+    for (std::uint32_t id = 0; id < 200; ++id) {
+        ids.insert(ids.end(), id % 7 == 0 ? 100 : id % 3 + 1, id * 5);
+    }
+
+    std::vector<std::uint32_t> distinct;
+    for (std::uint32_t id : unique((ids.begin(), ids.end()))) {
+        distinct.push_back(id);
+    }
+
+    std::vector<std::uint32_t> expected(ids);
+    expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+    EXPECT_EQ(expected, distinct);
+
+    std::vector<std::pair<std::uint32_t, std::size_t>> runs;
+    for (auto run : run_length((ids.begin(), ids.end()))) {
+        runs.emplace_back(run.first, run.second);
+    }
+
+    ASSERT_EQ(200u, runs.size());
+
+    for (std::uint32_t id = 0; id < 200; ++id) {
+        EXPECT_EQ(id * 5, runs[id].first);
+        EXPECT_EQ(id % 7 == 0 ? 100u : id % 3 + 1, runs[id].second);
+    }
+
+    auto encoded = run_length((ids.begin(), ids.end()));
+    EXPECT_EQ(100u, encoded.begin().count());
+    EXPECT_EQ(ids.begin() + 100, encoded.begin().run().end());
+    EXPECT_EQ(200, std::distance(encoded.begin(), encoded.end()));
+
+    std::list<std::string> words({"a", "a", "b", "c", "c", "c"});
+    std::string initials;
+    for (const std::string& word : unique((words.begin(), words.end()))) {
+        initials += word;
+    }
+    EXPECT_EQ("abc", initials);
+
+    std::ostringstream counts;
+    for (auto run : run_length((words.begin(), words.end()))) {
+        counts << run.first << run.second;
+    }
+    EXPECT_EQ("a2b1c3", counts.str());
+
+    std::vector<double> empty;
+    EXPECT_TRUE(run_length((empty.begin(), empty.end())).empty());
+    EXPECT_TRUE(unique((empty.begin(), empty.end())).empty());
+}
@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include <IteratorBasedForAny.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+namespace
+{
+
+    int sum(any_iterator_range<const int&> _range) {
+        int result = 0;
+
+        for (int x : _range) {
+            result += x;
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Iterator over a vector that is too large to be stored inline in an any_iterator.
+     */
+    class large_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using reference = const int&;
+        using pointer = const int*;
+
+    private:
+        const int* m_current;
+        char m_padding[2 * any_iterator_inline_size];
+
+    public:
+        explicit large_iterator(const int* _current) : m_current(_current), m_padding() { }
+
+        reference operator*() const { return *m_current; }
+
+        large_iterator& operator++() {
+            ++m_current;
+            return *this;
+        }
+
+        large_iterator operator++(int) {
+            large_iterator previous = *this;
+            ++m_current;
+            return previous;
+        }
+
+        large_iterator& operator--() {
+            --m_current;
+            return *this;
+        }
+
+        large_iterator& operator+=(difference_type _n) {
+            m_current += _n;
+            return *this;
+        }
+
+        difference_type operator-(const large_iterator& rhs) const { return m_current - rhs.m_current; }
+
+        bool operator==(const large_iterator& rhs) const { return m_current == rhs.m_current; }
+        bool operator!=(const large_iterator& rhs) const { return m_current != rhs.m_current; }
+    };
+
+    /**
+     * @brief Sentinel ending a range of ints at the first zero.
+     */
+    struct zero_sentinel {
+    };
+
+    bool operator!=(const int* _it, zero_sentinel) { return *_it != 0; }
+
+} // namespace
+
+TEST(IteratorBasedForAnyTest, ErasesContainers)
+{
+    std::vector<int> v = {1, 2, 3};
+    std::list<int> l = {4, 5};
+    std::deque<int> d = {6};
+
+    EXPECT_EQ(6, sum((v.cbegin(), v.cend())));
+    EXPECT_EQ(9, sum((l.cbegin(), l.cend())));
+    EXPECT_EQ(6, sum((d.cbegin(), d.cend())));
+    EXPECT_EQ(0, sum(any_iterator_range<const int&>()));
+
+    //Mutable references write through to the container.
+    std::list<std::string> names = {"a", "b"};
+    any_iterator_range<std::string&, std::bidirectional_iterator_tag> range((names.begin(), names.end()));
+
+    for (std::string& name : range) {
+        name += "!";
+    }
+
+    EXPECT_EQ((std::list<std::string>{"a!", "b!"}), names);
+    EXPECT_EQ(2u, range.begin()->size());
+    EXPECT_EQ("b!", *--range.end());
+
+    //Elements may be converted to a value Reference.
+    any_iterator_range<long> longs((v.begin(), v.end()));
+    EXPECT_EQ(6L, std::accumulate(longs.begin(), longs.end(), 0L));
+}
+
+TEST(IteratorBasedForAnyTest, RandomAccess)
+{
+    std::vector<int> v(100);
+    std::iota(v.begin(), v.end(), 0);
+
+    using range_type = any_iterator_range<int&, std::random_access_iterator_tag>;
+    range_type range((v.begin(), v.end()));
+
+    EXPECT_EQ(100u, range.size());
+    EXPECT_EQ(42, range.begin()[42]);
+    EXPECT_EQ(99, *(range.end() - 1));
+    EXPECT_TRUE(range.begin() < range.end());
+    EXPECT_TRUE(range.end() >= range.begin() + 100);
+
+    std::reverse(range.begin(), range.end());
+    EXPECT_EQ(99, v.front());
+    EXPECT_EQ(0, v.back());
+
+    std::sort(range.begin(), range.end());
+    EXPECT_TRUE(std::is_sorted(v.begin(), v.end()));
+    EXPECT_TRUE(std::binary_search(range.begin(), range.end(), 57));
+
+    //A sized sentinel is turned into the end iterator.
+    iterator_range<std::vector<int>::iterator, std::vector<int>::iterator> full((v.begin(), v.end()));
+    range_type copy = full;
+    EXPECT_EQ(100, copy.end() - copy.begin());
+}
+
+TEST(IteratorBasedForAnyTest, Storage)
+{
+    using iterator = any_iterator<const int&, std::random_access_iterator_tag>;
+
+    EXPECT_TRUE(iterator::stores_inline<std::vector<int>::const_iterator>());
+    EXPECT_TRUE(iterator::stores_inline<std::list<int>::const_iterator>());
+    EXPECT_TRUE(iterator::stores_inline<std::deque<int>::const_iterator>());
+    EXPECT_FALSE(iterator::stores_inline<large_iterator>());
+
+    const int values[] = {1, 2, 3, 4};
+    iterator first = large_iterator(values);
+    iterator last = large_iterator(values + 4);
+    EXPECT_EQ(4, last - first);
+
+    iterator copy = first;
+    ++first;
+    EXPECT_EQ(1, *copy);
+    EXPECT_EQ(2, *first);
+
+    iterator moved = std::move(first);
+    EXPECT_EQ(2, *moved);
+    moved = copy;
+    EXPECT_EQ(1, *moved);
+    moved = iterator(std::vector<int>::const_iterator());
+    moved = std::move(copy);
+    EXPECT_EQ(1, moved[0]);
+
+    EXPECT_TRUE(iterator() == iterator());
+    EXPECT_FALSE(iterator() == moved);
+}
+
+TEST(IteratorBasedForAnyTest, Sentinels)
+{
+    const int values[] = {3, 1, 4, 0, 5};
+    iterator_range<const int*, zero_sentinel> until_zero(values, zero_sentinel());
+
+    EXPECT_EQ(8, sum(until_zero));
+
+    any_iterator_range<const int&> range = until_zero;
+    EXPECT_EQ(3, std::distance(range.begin(), range.end()));
+    EXPECT_EQ(1, *std::next(range.begin()));
+}
+
+TEST(IteratorBasedForAnyTest, Batches)
+{
+    std::vector<int> v(1000);
+    std::iota(v.begin(), v.end(), 0);
+    std::list<int> l(v.begin(), v.end());
+    const int expected = std::accumulate(v.begin(), v.end(), 0);
+
+    any_iterator_range<const int&> contiguous((v.cbegin(), v.cend()));
+    any_iterator_range<const int&> linked((l.cbegin(), l.cend()));
+
+    EXPECT_TRUE(contiguous.is_contiguous());
+    EXPECT_FALSE(linked.is_contiguous());
+    EXPECT_EQ(v.data(), contiguous.contiguous().data());
+    EXPECT_EQ(1000u, contiguous.contiguous().size());
+    EXPECT_TRUE(linked.contiguous().empty());
+
+    for (const any_iterator_range<const int&>& range : {contiguous, linked}) {
+        std::vector<std::size_t> sizes;
+        int total = 0;
+
+        range.for_each_batch([&](span<const int> _batch) {
+            sizes.push_back(_batch.size());
+
+            for (int x : _batch) {
+                total += x;
+            }
+        });
+
+        EXPECT_EQ(expected, total);
+        EXPECT_EQ(range.is_contiguous() ? 1u : (1000 + any_iterator_batch_size - 1) / any_iterator_batch_size,
+                  sizes.size());
+
+        std::vector<int> elements;
+        range.for_each([&](int x) { elements.push_back(x); });
+        EXPECT_EQ(v, elements);
+    }
+
+    //Random access ranges that are not contiguous copy whole batches at once.
+    std::deque<int> d(v.begin(), v.end());
+    any_iterator_range<const int&, std::random_access_iterator_tag> deque_range((d.cbegin(), d.cend()));
+    auto it = deque_range.begin();
+    std::vector<int> batch(1000);
+    EXPECT_EQ(300u, it.next_batch(deque_range.end(), batch.data(), 300));
+    EXPECT_EQ(299, batch[299]);
+    EXPECT_EQ(300, *it);
+    EXPECT_EQ(700u, it.next_batch(deque_range.end(), batch.data(), 1000));
+    EXPECT_TRUE(it == deque_range.end());
+
+    //Converted elements are not viewed in place.
+    any_iterator_range<long> longs((v.begin(), v.end()));
+    EXPECT_FALSE(longs.is_contiguous());
+    long long_total = 0;
+    longs.for_each([&](long x) { long_total += x; });
+    EXPECT_EQ(expected, long_total);
+
+    any_iterator_range<const int&>().for_each([](int) { ADD_FAILURE(); });
+}
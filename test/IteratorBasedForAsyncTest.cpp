@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <IteratorBasedForAsync.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+#if ITERATOR_BASED_FOR_HAS_COROUTINES
+namespace
+{
+
+    /**
+     * @brief Coroutine that starts immediately and destroys itself when it finishes.
+     */
+    struct detached {
+        struct promise_type {
+            detached get_return_object() const { return detached(); }
+            std::suspend_never initial_suspend() const noexcept { return {}; }
+            std::suspend_never final_suspend() const noexcept { return {}; }
+            void return_void() const { }
+            void unhandled_exception() const { std::terminate(); }
+        };
+    };
+
+    struct consumer_state {
+        std::vector<int> values;
+        bool finished;
+
+        consumer_state() : values(), finished(false) { }
+    };
+
+    detached consume(async_channel<int>& channel, consumer_state& state) {
+        async_iterator_range<async_channel<int>> range(channel);
+
+        for (auto it = co_await range.begin(); it != range.end(); co_await ++it) {
+            state.values.push_back(*it);
+        }
+
+        state.finished = true;
+    }
+
+    detached consume_batches(async_channel<int>& channel, std::vector<std::size_t>& sizes) {
+        async_iterator_range<async_channel<int>> range(channel);
+
+        for (auto it = co_await range.begin(); it != range.end(); co_await ++it) {
+            sizes.push_back(range.batch().size());
+            range.skip_batch();
+        }
+    }
+
+} // namespace
+
+TEST(IteratorBasedForAsyncTest, ChannelIteration)
+{
+    async_channel<int> channel;
+    consumer_state state;
+
+    //Elements pushed before the consumer starts are taken as one batch.
+    channel.push(1);
+    channel.push(2);
+    consume(channel, state);
+    EXPECT_EQ((std::vector<int>{1, 2}), state.values);
+    EXPECT_FALSE(state.finished);
+
+    const int burst[] = {3, 4, 5, 6};
+    channel.push(burst, burst + 4);
+    channel.push(7);
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5, 6, 7}), state.values);
+
+    channel.close();
+    EXPECT_TRUE(state.finished);
+}
+
+TEST(IteratorBasedForAsyncTest, Batches)
+{
+    async_channel<int> channel;
+    std::vector<std::size_t> sizes;
+    const int burst[] = {1, 2, 3};
+
+    channel.push(burst, burst + 3);
+    consume_batches(channel, sizes);
+    channel.push(burst, burst + 2);
+    channel.push(burst, burst);
+    channel.close();
+    EXPECT_EQ((std::vector<std::size_t>{3, 2}), sizes);
+}
+
+TEST(IteratorBasedForAsyncTest, ProducerThread)
+{
+    async_channel<int> channel;
+    consumer_state state;
+    consume(channel, state);
+
+    std::thread producer([&channel]() {
+        for (int i = 0; i < 10000; ++i) {
+            channel.push(i);
+        }
+
+        channel.close();
+    });
+
+    producer.join();
+    ASSERT_TRUE(state.finished);
+    ASSERT_EQ(10000u, state.values.size());
+
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(i, state.values[i]);
+    }
+}
+#endif
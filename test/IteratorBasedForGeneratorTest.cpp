@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <IteratorBasedForGenerator.hpp>
+#include "IteratorBasedForTestAllocator.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+using IteratorBasedForTest::counting_allocator;
+
+#if ITERATOR_BASED_FOR_HAS_COROUTINES
+namespace
+{
+
+    generator<int> yield_squares(int n) {
+        for (int i = 0; i < n; ++i) {
+            co_yield i * i;
+        }
+    }
+
+    generator<std::string&> words(std::vector<std::string>& source) {
+        for (std::string& word : source) {
+            co_yield word;
+        }
+    }
+
+    generator<int> failing() {
+        co_yield 1;
+        throw std::runtime_error("failing");
+    }
+
+} // namespace
+
+TEST(IteratorBasedForGeneratorTest, CommaSyntax)
+{
+    EXPECT_TRUE(is_iterator<generator<int>::iterator>::value);
+
+    generator<int> g = yield_squares(5);
+    std::vector<int> values;
+
+    for (int x : (g.begin(), g.end())) {
+        values.push_back(x);
+    }
+
+    EXPECT_EQ((std::vector<int>{0, 1, 4, 9, 16}), values);
+    EXPECT_TRUE(g.begin() == g.end());
+
+    int sum = 0;
+
+    for (int x : yield_squares(4)) {
+        sum += x;
+    }
+
+    EXPECT_EQ(14, sum);
+    EXPECT_TRUE(yield_squares(0).range().empty());
+}
+
+TEST(IteratorBasedForGeneratorTest, YieldsReferences)
+{
+    std::vector<std::string> source = {"a", "b"};
+
+    for (std::string& word : words(source)) {
+        word += "!";
+    }
+
+    EXPECT_EQ((std::vector<std::string>{"a!", "b!"}), source);
+}
+
+TEST(IteratorBasedForGeneratorTest, RethrowsExceptions)
+{
+    generator<int> g = failing();
+    auto it = g.begin();
+    EXPECT_EQ(1, *it);
+    EXPECT_THROW(++it, std::runtime_error);
+    EXPECT_TRUE(it == g.end());
+}
+
+TEST(IteratorBasedForGeneratorTest, FrameAllocation)
+{
+    frame_pool& pool = frame_pool::local();
+
+    //A released frame is reused by the next generator of the same size.
+    {
+        generator<int> g = yield_squares(1);
+    }
+
+    const std::size_t cached = pool.cached();
+    EXPECT_LE(1u, cached);
+
+    for (int i = 0; i < 100; ++i) {
+        generator<int> g = yield_squares(3);
+        EXPECT_EQ(cached - 1, pool.cached());
+    }
+
+    EXPECT_EQ(cached, pool.cached());
+
+    std::size_t allocations = 0;
+
+    {
+        scoped_frame_allocator<counting_allocator<char>> scope((counting_allocator<char>(&allocations)));
+        generator<int> g = yield_squares(3);
+        EXPECT_EQ(1u, allocations);
+
+        int sum = 0;
+
+        for (int x : g) {
+            sum += x;
+        }
+
+        EXPECT_EQ(5, sum);
+    }
+
+    EXPECT_EQ(0u, allocations);
+    EXPECT_EQ(cached, pool.cached());
+}
+#endif
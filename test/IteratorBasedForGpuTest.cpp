@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <IteratorBasedForGpu.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <list>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+#if ITERATOR_BASED_FOR_HAS_SYCL
+//Ranges of const_iterators stage their elements in a device copy that is not const, whether or not a GPU is present.
+template class IteratorBasedForImpl::device_view<const float>;
+template class IteratorBasedForImpl::device_view<const double>;
+template class IteratorBasedForImpl::device_view<float>;
+#endif
+
+TEST(IteratorBasedForGpuTest, Transform)
+{
+    std::vector<float> in(100000);
+    std::iota(in.begin(), in.end(), 0.0f);
+    std::vector<float> out(in.size());
+
+    //A threshold of zero offloads every contiguous range when there is a GPU and runs on the host otherwise.
+    for (const execution::gpu_policy& policy : {execution::par_gpu, execution::par_gpu.above(0)}) {
+        auto end = transform(policy, (in.cbegin(), in.cend()), out.begin(), [](float x) { return 2 * x + 1; });
+
+        EXPECT_EQ(out.end(), end);
+
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            EXPECT_EQ(2 * in[i] + 1, out[i]);
+        }
+    }
+
+    //Ranges that cannot be offloaded are split across the host threads.
+    thread_pool pool(2);
+    std::deque<int> d(1000, 3);
+    std::vector<long> squares(d.size());
+    transform(execution::par_gpu.above(0).host(execution::par.on(pool)), (d.cbegin(), d.cend()), squares.begin(),
+              [](int x) { return static_cast<long>(x) * x; });
+    EXPECT_EQ(9000L, std::accumulate(squares.begin(), squares.end(), 0L));
+}
+
+TEST(IteratorBasedForGpuTest, ReduceAndSort)
+{
+    std::vector<double> v(1 << 16);
+    std::iota(v.begin(), v.end(), 1.0);
+    const double expected = static_cast<double>(v.size()) * (v.size() + 1) / 2;
+
+    EXPECT_EQ(expected + 5, reduce(execution::par_gpu.above(0), (v.cbegin(), v.cend()), 5.0));
+    EXPECT_EQ(double(v.size()), reduce(execution::par_gpu, (v.cbegin(), v.cend()), 0.0,
+                                       [](double a, double b) { return std::max(a, b); }));
+    EXPECT_EQ(7, reduce(execution::par_gpu, (v.cbegin(), v.cbegin()), 7));
+
+    std::vector<int, pinned_allocator<int>> pinned(100000);
+    std::mt19937 random(3);
+    std::generate(pinned.begin(), pinned.end(), [&random]() { return static_cast<int>(random() % 1000); });
+
+    sort(execution::par_gpu.above(0), (pinned.begin(), pinned.end()));
+    EXPECT_TRUE(std::is_sorted(pinned.begin(), pinned.end()));
+
+    sort(execution::par_gpu, (pinned.begin(), pinned.end()), std::greater<int>());
+    EXPECT_TRUE(std::is_sorted(pinned.begin(), pinned.end(), std::greater<int>()));
+
+    EXPECT_EQ(gpu_available(), execution::par_gpu.above(10).offloads(10));
+    EXPECT_FALSE(execution::par_gpu.above(10).offloads(9));
+    EXPECT_EQ(gpu_offload_threshold, execution::par_gpu.threshold());
+}
@@ -0,0 +1,510 @@
+#include <gtest/gtest.h>
+#include <IteratorBasedForIO.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+namespace
+{
+    std::vector<std::string> read_lines(block_reader& _reader) {
+        std::vector<std::string> result;
+
+        for (span<const char> line : lines(_reader)) {
+            result.emplace_back(line.data(), line.size());
+        }
+
+        return result;
+    }
+}
+
+TEST(IteratorBasedForIOTest, BytesAcrossBlocks)
+{
+    std::string text;
+
+    for (int i = 0; i < 1000; ++i) {
+        text += static_cast<char>('a' + i % 26);
+    }
+
+    std::istringstream stream(text);
+    block_reader reader(stream, 64);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(reader.data()) % block_reader::buffer_alignment);
+
+    std::string copied;
+
+    for (char c : block_byte_iterator(reader), block_byte_iterator()) {
+        copied += c;
+    }
+
+    EXPECT_EQ(text, copied);
+
+    std::istringstream empty;
+    block_reader empty_reader(empty);
+    EXPECT_TRUE(bytes(empty_reader).empty());
+}
+
+TEST(IteratorBasedForIOTest, LinesAcrossBlocks)
+{
+    //Blocks of 5 bytes split most lines, and the long line does not fit the initial buffer.
+    std::istringstream stream("first\nsecond line\n\n" + std::string(40, 'x') + "\nlast");
+    block_reader reader(stream, 5);
+
+    EXPECT_EQ(std::vector<std::string>({"first", "second line", "", std::string(40, 'x'), "last"}),
+              read_lines(reader));
+
+    std::istringstream terminated("a\nb\n");
+    block_reader terminated_reader(terminated);
+    EXPECT_EQ(std::vector<std::string>({"a", "b"}), read_lines(terminated_reader));
+}
+
+TEST(IteratorBasedForIOTest, Records)
+{
+    struct point {
+        std::int32_t x;
+        std::int32_t y;
+    };
+
+    std::string data;
+
+    for (std::int32_t i = 0; i < 100; ++i) {
+        point p = {i, -i};
+        data.append(reinterpret_cast<const char*>(&p), sizeof(p));
+    }
+
+    data += "abc";
+
+    std::istringstream stream(data);
+    block_reader reader(stream, 12);
+    std::int32_t count = 0;
+
+    for (const point& p : records<point>(reader)) {
+        EXPECT_EQ(count, p.x);
+        EXPECT_EQ(-count, p.y);
+        ++count;
+    }
+
+    EXPECT_EQ(100, count);
+}
+
+#if ITERATOR_BASED_FOR_HAS_FILE_DESCRIPTORS
+TEST(IteratorBasedForIOTest, FileDescriptor)
+{
+    std::FILE* file = std::tmpfile();
+    ASSERT_NE(nullptr, file);
+
+    const std::string text = "alpha\nbeta\ngamma\n";
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::fflush(file);
+    std::rewind(file);
+
+    block_reader reader(fileno(file), 4);
+    EXPECT_EQ(std::vector<std::string>({"alpha", "beta", "gamma"}), read_lines(reader));
+    std::fclose(file);
+
+    block_reader closed(-1);
+    EXPECT_THROW(closed.refill(), std::system_error);
+}
+#endif
+
+namespace
+{
+    //Decodes pairs of a count and a byte, any number of which make up a frame.
+    class run_length_decoder {
+    private:
+        std::size_t m_pending;
+        std::size_t m_count;
+        char m_value;
+        bool m_half;
+
+    public:
+        run_length_decoder() : m_pending(0), m_count(0), m_value(0), m_half(false) { }
+
+        decode_step decode(const char* _input, std::size_t _input_size, char* _output, std::size_t _output_size) {
+            std::size_t consumed = 0;
+            std::size_t produced = 0;
+
+            while (produced < _output_size) {
+                if (m_pending != 0) {
+                    const std::size_t n = std::min(m_pending, _output_size - produced);
+                    std::fill(_output + produced, _output + produced + n, m_value);
+                    produced += n;
+                    m_pending -= n;
+                } else if (consumed < _input_size) {
+                    if (m_half) {
+                        m_value = _input[consumed];
+                        m_pending = m_count;
+                    } else {
+                        m_count = static_cast<unsigned char>(_input[consumed]);
+                    }
+
+                    m_half = !m_half;
+                    ++consumed;
+                } else {
+                    break;
+                }
+            }
+
+            return decode_step{consumed, produced, !m_half && m_pending == 0};
+        }
+    };
+}
+
+TEST(IteratorBasedForIOTest, DecompressingRange)
+{
+    std::string compressed;
+    std::string expected;
+
+    for (int i = 0; i < 1000; ++i) {
+        const char value = i % 5 == 0 ? '\n' : static_cast<char>('a' + i % 26);
+        const std::size_t count = static_cast<std::size_t>(i % 200 + 1);
+        compressed += static_cast<char>(count);
+        compressed += value;
+        expected.append(count, value);
+    }
+
+    decompressing_range<run_length_decoder> from_memory = decompress<run_length_decoder>(
+        make_iterator_range(compressed.data(), compressed.data() + compressed.size()), run_length_decoder(), 64);
+    EXPECT_EQ(expected, std::string(from_memory.begin(), from_memory.end()));
+
+    std::istringstream stream(compressed);
+    block_reader compressed_reader(stream, 7);
+    decompressing_range<run_length_decoder> from_reader = decompress<run_length_decoder>(compressed_reader);
+    std::vector<std::string> expected_lines;
+    std::istringstream expected_stream(expected);
+
+    for (std::string line; std::getline(expected_stream, line);) {
+        expected_lines.push_back(line);
+    }
+
+    EXPECT_EQ(expected_lines, read_lines(from_reader.reader()));
+
+    std::string empty;
+    decompressing_range<run_length_decoder> nothing = decompress<run_length_decoder>((empty.begin(), empty.end()));
+    EXPECT_TRUE(nothing.begin() == nothing.end());
+
+    decompressing_range<run_length_decoder> truncated = decompress<run_length_decoder>(
+        (compressed.begin(), compressed.end() - 1));
+    EXPECT_THROW(std::string(truncated.begin(), truncated.end()), std::runtime_error);
+}
+
+#if ITERATOR_BASED_FOR_HAS_FILE_DESCRIPTORS
+namespace
+{
+    std::string write_temporary_file(const std::string& _contents) {
+        char path[] = "/tmp/iterator_based_for_XXXXXX";
+        const int descriptor = mkstemp(path);
+
+        if (descriptor >= 0) {
+            EXPECT_EQ(static_cast<ssize_t>(_contents.size()), ::write(descriptor, _contents.data(), _contents.size()));
+            ::close(descriptor);
+        }
+
+        return path;
+    }
+}
+
+TEST(IteratorBasedForIOTest, MappedFileRange)
+{
+    std::vector<std::int64_t> values(10000);
+
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<std::int64_t>(i * 3);
+    }
+
+    //A trailing partial record is not part of the range.
+    const std::string path = write_temporary_file(
+            std::string(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(std::int64_t)) + "xyz");
+
+    mapped_file_options options;
+    options.will_need = true;
+    options.huge_pages = true;
+    options.readahead = 4096;
+
+    mapped_file_range<std::int64_t> mapped(path, options);
+    ASSERT_EQ(values.size(), mapped.size());
+    EXPECT_TRUE(std::equal(values.begin(), values.end(), mapped.begin()));
+    EXPECT_EQ(mapped.data(), mapped.range().data());
+    EXPECT_EQ(9, mapped[3]);
+
+    std::int64_t sum = 0;
+
+    for (std::int64_t x : mapped.with_readahead()) {
+        sum += x;
+    }
+
+    EXPECT_EQ(3 * 9999 * 10000 / 2, sum);
+    EXPECT_TRUE(is_contiguous_iterator<readahead_iterator<std::int64_t>>::value);
+    EXPECT_EQ(values.size(), mapped.with_readahead().size());
+
+    mapped_file_range<std::int64_t> moved(std::move(mapped));
+    EXPECT_TRUE(mapped.empty());
+    EXPECT_EQ(values.size(), moved.size());
+    std::remove(path.c_str());
+
+    const std::string empty_path = write_temporary_file("");
+    mapped_file_range<char> empty(empty_path);
+    EXPECT_TRUE(empty.empty());
+    EXPECT_TRUE(empty.range().empty());
+    std::remove(empty_path.c_str());
+
+    EXPECT_THROW(mapped_file_range<char>("/nonexistent/iterator_based_for"), std::system_error);
+}
+
+TEST(IteratorBasedForIOTest, AsyncFileRange)
+{
+    std::vector<std::int32_t> values(100000);
+
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<std::int32_t>(i);
+    }
+
+    const std::string path = write_temporary_file(
+            std::string(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(std::int32_t)) + "xy");
+
+    //Exercise blocks that do not hold whole records, a single slot and several reading threads.
+    for (std::size_t block_size : {std::size_t(1), std::size_t(4094), std::size_t(65536), std::size_t(1) << 20}) {
+        for (std::size_t depth : {std::size_t(1), std::size_t(4)}) {
+            for (std::size_t threads : {std::size_t(1), std::size_t(3)}) {
+                if (block_size == 1 && threads > 1) {
+                    continue;
+                }
+
+                async_file_options options;
+                options.block_size = block_size;
+                options.depth = depth;
+                options.threads = threads;
+
+                async_file_range<std::int32_t> records(path, options);
+                EXPECT_FALSE(records.uses_io_uring());
+                std::vector<std::int32_t> read;
+
+                for (std::int32_t x : records) {
+                    read.push_back(x);
+                }
+
+                EXPECT_TRUE(read == values);
+            }
+        }
+    }
+
+    //Stopping part way through joins the threads while reads are buffered ahead.
+    async_file_options options;
+    options.block_size = 4096;
+    async_file_range<std::int32_t> partial(path, options);
+    std::size_t seen = 0;
+
+    for (auto it = partial.begin(); it != partial.end() && seen < 10; ++it) {
+        EXPECT_EQ(static_cast<std::int32_t>(seen), *it);
+        ++seen;
+    }
+
+    EXPECT_EQ(10u, seen);
+    std::remove(path.c_str());
+
+    const std::string empty_path = write_temporary_file("");
+    async_file_range<char> empty(empty_path);
+    EXPECT_TRUE(empty.begin() == empty.end());
+    std::remove(empty_path.c_str());
+
+    EXPECT_THROW(async_file_range<char>("/nonexistent/iterator_based_for"), std::system_error);
+
+    //A descriptor that cannot be read reports the error through the iteration.
+    async_file_range<char> unreadable(-1);
+    EXPECT_THROW(unreadable.begin(), std::system_error);
+}
+
+TEST(IteratorBasedForIOTest, AsyncFileSink)
+{
+    std::vector<std::int32_t> values(100000);
+
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<std::int32_t>(i * 7);
+    }
+
+    const std::string expected(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(std::int32_t));
+    const std::string path = write_temporary_file("");
+
+    //Blocks smaller than a record, blocks that do not hold whole records, a single block and double buffering.
+    for (std::size_t block_size : {std::size_t(1), std::size_t(4094), std::size_t(65536)}) {
+        for (std::size_t depth : {std::size_t(1), std::size_t(2)}) {
+            async_sink_options options;
+            options.block_size = block_size;
+            options.depth = depth;
+
+            {
+                async_file_sink<std::int32_t> sink(path, options);
+                std::copy(values.begin(), values.begin() + 50000, sink.begin());
+                sink.flush();
+                sink.write(values.data() + 50000, values.size() - 50000);
+                sink.close();
+            }
+
+            std::ifstream written(path, std::ios::binary);
+            const std::string contents((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>());
+            EXPECT_TRUE(contents == expected);
+        }
+    }
+
+    //The destructor writes what is left.
+    {
+        async_file_sink<char> sink(path);
+        sink.push('o');
+        sink.push('k');
+    }
+
+    std::ifstream written(path, std::ios::binary);
+    EXPECT_EQ("ok", std::string((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>()));
+    std::remove(path.c_str());
+
+    EXPECT_THROW(async_file_sink<char>("/nonexistent/iterator_based_for"), std::system_error);
+
+    //A descriptor that cannot be written reports the error from the next flush.
+    async_file_sink<char> unwritable(-1);
+    unwritable.push('x');
+    EXPECT_THROW(unwritable.flush(), std::system_error);
+    EXPECT_THROW(unwritable.close(), std::system_error);
+}
+
+TEST(IteratorBasedForIOTest, ColumnarFile)
+{
+    std::vector<double> prices(10000);
+    std::vector<std::int64_t> volumes(10000);
+    std::vector<std::uint8_t> sides(10000);
+
+    for (std::size_t i = 0; i < prices.size(); ++i) {
+        prices[i] = 100.0 + static_cast<double>(i) / 100.0;
+        volumes[i] = static_cast<std::int64_t>(i % 7) * 10;
+        sides[i] = static_cast<std::uint8_t>(i % 2);
+    }
+
+    columnar_writer writer(1000);
+    writer.add_column("price", (prices.begin(), prices.end()));
+    writer.add_column("volume", (volumes.cbegin(), volumes.cend()));
+    writer.add_column("side", (sides.begin(), sides.end()));
+    EXPECT_THROW(writer.add_column("price", (prices.begin(), prices.end())), std::invalid_argument);
+    EXPECT_THROW(writer.add_column("short", (prices.begin(), prices.end() - 1)), std::invalid_argument);
+    EXPECT_THROW(writer.add_column(std::string(40, 'x'), (prices.begin(), prices.end())), std::invalid_argument);
+
+    const std::string path = write_temporary_file("");
+    writer.write(path);
+
+    columnar_file file(path);
+    EXPECT_EQ(10000u, file.rows());
+    EXPECT_EQ(10u, file.block_count());
+    ASSERT_EQ(3u, file.column_count());
+    EXPECT_EQ("volume", file.column_name(1));
+    EXPECT_EQ(column_type::uint8, file.type(2));
+
+    iterator_range<const double*> price = file.column<double>("price");
+    iterator_range<const std::int64_t*> volume = file.column<std::int64_t>("volume");
+    EXPECT_TRUE(std::equal(prices.begin(), prices.end(), price.begin(), price.end()));
+    EXPECT_TRUE(std::equal(volumes.begin(), volumes.end(), volume.begin(), volume.end()));
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(volume.begin()) % columnar_alignment);
+    EXPECT_EQ(sides, std::vector<std::uint8_t>(file.column<std::uint8_t>("side").begin(),
+                                               file.column<std::uint8_t>("side").end()));
+
+    EXPECT_THROW(file.column<float>("price"), std::invalid_argument);
+    EXPECT_THROW(file.column<double>("missing"), std::invalid_argument);
+
+    column_statistics<double> statistics = file.statistics<double>("price");
+    ASSERT_EQ(10u, statistics.blocks());
+    EXPECT_EQ(110.0, statistics.min(1));
+    EXPECT_EQ(119.99, statistics.max(1));
+    EXPECT_EQ(std::vector<std::size_t>({2, 3}), statistics.blocks_overlapping(125.0, 135.0));
+
+    std::int64_t scanned = 0;
+    std::int64_t expected = 0;
+
+    for (std::size_t block : statistics.blocks_overlapping(125.0, 135.0)) {
+        for (std::size_t row : file.rows_of_block(block)) {
+            if (price.begin()[row] >= 125.0 && price.begin()[row] <= 135.0) {
+                scanned += volume.begin()[row];
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < prices.size(); ++i) {
+        expected += prices[i] >= 125.0 && prices[i] <= 135.0 ? volumes[i] : 0;
+    }
+
+    EXPECT_EQ(expected, scanned);
+    EXPECT_EQ(9000u, file.rows_of_block(9).begin()[0]);
+    EXPECT_EQ(1000u, file.rows_of_block(9).size());
+    std::remove(path.c_str());
+
+    const std::string not_columnar = write_temporary_file("not a columnar file");
+    EXPECT_THROW(columnar_file{not_columnar}, std::runtime_error);
+    std::remove(not_columnar.c_str());
+
+    EXPECT_THROW(columnar_writer(0), std::invalid_argument);
+}
+
+TEST(IteratorBasedForIOTest, SocketReceiveRange)
+{
+    int datagrams[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_DGRAM, 0, datagrams));
+    ASSERT_EQ(0, ::fcntl(datagrams[0], F_SETFL, ::fcntl(datagrams[0], F_GETFL) | O_NONBLOCK));
+
+    buffer_pool pool(2, 100);
+    EXPECT_EQ(128u, pool.buffer_size());
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(pool.try_acquire().data()) % buffer_pool::alignment);
+
+    const std::vector<std::string> sent({"quote", "", "trade", std::string(200, 'x'), "last"});
+
+    for (const std::string& message : sent) {
+        ASSERT_EQ(static_cast<ssize_t>(message.size()), ::send(datagrams[1], message.data(), message.size(), 0));
+    }
+
+    socket_receive_range feed(datagrams[0], pool);
+    std::vector<std::string> received;
+    std::vector<bool> truncated;
+    pooled_buffer kept;
+
+    for (pooled_buffer& message : feed) {
+        received.emplace_back(message.begin(), message.end());
+        truncated.push_back(message.truncated());
+        EXPECT_EQ(message.size(), message.range().size());
+        EXPECT_EQ(received.size() == 1 ? 1u : 0u, pool.available());
+
+        if (received.size() == 1) {
+            kept = std::move(message);
+        }
+    }
+
+    EXPECT_EQ(std::vector<std::string>({"quote", "", "trade", std::string(128, 'x'), "last"}), received);
+    EXPECT_EQ(std::vector<bool>({false, false, false, true, false}), truncated);
+    EXPECT_EQ("quote", std::string(kept.begin(), kept.end()));
+    EXPECT_EQ(1u, pool.available());
+    kept.reset();
+    EXPECT_EQ(2u, pool.available());
+    EXPECT_FALSE(kept);
+
+    ::close(datagrams[0]);
+    ::close(datagrams[1]);
+
+    int stream[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, stream));
+    ASSERT_EQ(5, ::send(stream[1], "hello", 5, 0));
+    ::shutdown(stream[1], SHUT_WR);
+
+    std::string bytes;
+    for (pooled_buffer& chunk : socket_receive_range(stream[0], pool)) {
+        bytes.append(chunk.begin(), chunk.end());
+    }
+
+    EXPECT_EQ("hello", bytes);
+    EXPECT_EQ(2u, pool.available());
+    ::close(stream[0]);
+    ::close(stream[1]);
+
+    EXPECT_THROW(socket_receive_range(-1, pool).begin(), std::system_error);
+}
+#endif
@@ -0,0 +1,1524 @@
+#include <gtest/gtest.h>
+#include <IteratorBasedForParallel.hpp>
+#include <IteratorBasedForAdaptors.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+TEST(IteratorBasedForParallelTest, ThreadPoolRunsEveryChunkOnce)
+{
+    thread_pool pool(3);
+    std::vector<std::atomic<int>> counts(1000);
+
+    for (auto& c : counts) {
+        c = 0;
+    }
+
+    pool.run_chunks(counts.size(), [&counts](std::size_t i) { ++counts[i]; });
+
+    for (auto& c : counts) {
+        EXPECT_EQ(1, c.load());
+    }
+
+    EXPECT_EQ(4u, pool.concurrency());
+}
+
+TEST(IteratorBasedForParallelTest, ThreadPoolRethrowsFirstException)
+{
+    thread_pool pool(2);
+
+    EXPECT_THROW(pool.run_chunks(100, [](std::size_t i) {
+        if (i == 42) {
+            throw std::runtime_error("chunk failed");
+        }
+    }), std::runtime_error);
+}
+
+TEST(IteratorBasedForParallelTest, ThreadPoolNestedLoops)
+{
+    thread_pool pool(2);
+    std::atomic<int> total(0);
+
+    pool.run_chunks(8, [&pool, &total](std::size_t) {
+        pool.run_chunks(8, [&total](std::size_t) { ++total; });
+    });
+
+    EXPECT_EQ(64, total.load());
+}
+
+TEST(IteratorBasedForParallelTest, ThreadPoolOptionsAndStatistics)
+{
+    thread_pool_options options;
+    options.workers = 2;
+    options.spin = std::chrono::microseconds(0);
+    thread_pool pool(options);
+    std::atomic<int> done(0);
+
+    EXPECT_EQ(3u, pool.concurrency());
+    EXPECT_EQ(0, pool.spin().count());
+
+    for (int i = 0; i < 10; ++i) {
+        pool.submit([&done]() { ++done; });
+    }
+
+    pool.run_until([&done]() { return done.load() == 10; });
+
+    //Tasks are counted when they are taken, so all ten are counted once they have run.
+    thread_pool_statistics statistics = pool.statistics();
+    EXPECT_EQ(10u, statistics.tasks);
+    EXPECT_LE(statistics.steals, statistics.tasks);
+    EXPECT_GE(statistics.idle.count(), 0);
+
+    pool.reset_statistics();
+    EXPECT_EQ(0u, pool.statistics().tasks);
+    EXPECT_EQ(std::chrono::microseconds(50), thread_pool(1).spin());
+
+    default_thread_pool();
+    EXPECT_THROW(configure_default_thread_pool(thread_pool_options()), std::logic_error);
+}
+
+TEST(IteratorBasedForParallelTest, ForEachPolicies)
+{
+    thread_pool pool(3);
+    std::vector<int> v(10000);
+    std::iota(v.begin(), v.end(), 0);
+
+    for_each(execution::seq, (v.begin(), v.end()), [](int& x) { x *= 2; });
+    for_each(execution::par.on(pool), (v.begin() + 1, v.end()), [](int& x) { x += 1; });
+    for_each(execution::par_unseq.on(pool), (v.begin(), v.end() - 1), [](int& x) { x *= 3; });
+
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        int expected = static_cast<int>(i) * 2 + (i > 0 ? 1 : 0);
+        EXPECT_EQ(i + 1 < v.size() ? expected * 3 : expected, v[i]);
+    }
+}
+
+TEST(IteratorBasedForParallelTest, ForEachVisitsEveryElement)
+{
+    thread_pool pool(3);
+    std::vector<std::thread::id> ids(4000);
+
+    for_each(execution::par.on(pool), (ids.begin(), ids.end()), [](std::thread::id& id) {
+        id = std::this_thread::get_id();
+        std::this_thread::yield();
+    });
+
+    for (const std::thread::id& id : ids) {
+        EXPECT_NE(std::thread::id(), id);
+    }
+}
+
+TEST(IteratorBasedForParallelTest, SmallRangesRunOnTheCallingThread)
+{
+    using chunk = iterator_range<std::vector<int>::iterator>;
+
+    thread_pool pool(3);
+    std::vector<int> v(parallel_range_threshold() - 1, 1);
+    std::size_t pieces = 0;
+
+    parallel_for(execution::par.on(pool), (v.begin(), v.end()), [&pieces](const chunk&) {
+        ++pieces;
+    });
+    EXPECT_EQ(1u, pieces);
+
+    const std::thread::id caller = std::this_thread::get_id();
+    for_each(execution::par.on(pool), (v.begin(), v.end()), [caller](int& x) {
+        EXPECT_EQ(caller, std::this_thread::get_id());
+        ++x;
+    });
+    EXPECT_EQ(2 * static_cast<int>(v.size()), reduce(execution::par.on(pool), (v.begin(), v.end()), 0));
+
+    //An explicit grain, or a lower threshold, splits them again.
+    std::atomic<std::size_t> split(0);
+    parallel_for(execution::par.on(pool), (v.begin(), v.end()), [&split](const chunk&) {
+        ++split;
+    }, 256);
+    EXPECT_LT(1u, split.load());
+
+    const std::size_t threshold = parallel_range_threshold();
+    set_parallel_range_threshold(0);
+    split = 0;
+    parallel_for(execution::par.on(pool), (v.begin(), v.begin() + 8), [&split](const chunk&) {
+        ++split;
+    });
+    EXPECT_LT(1u, split.load());
+    set_parallel_range_threshold(threshold);
+}
+
+TEST(IteratorBasedForParallelTest, ForEachForwardRangeRunsSequentially)
+{
+    std::list<int> l({1, 2, 3, 4});
+    int sum = 0;
+
+    for_each(execution::par, (l.begin(), l.end()), [&sum](int x) { sum += x; });
+
+    EXPECT_EQ(10, sum);
+}
+
+TEST(IteratorBasedForParallelTest, ScratchArenaBumpsAndRewinds)
+{
+    scratch_arena arena(256);
+
+    void* a = arena.allocate(24, 8);
+    scratch_arena::marker mark = arena.mark();
+    void* b = arena.allocate(1, 1);
+    void* c = arena.allocate(16, 64);
+
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a) % 8);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(c) % 64);
+    EXPECT_LT(static_cast<char*>(a), static_cast<char*>(b));
+    EXPECT_LT(static_cast<char*>(b), static_cast<char*>(c));
+
+    arena.rewind(mark);
+    EXPECT_EQ(b, arena.allocate(1, 1));
+
+    //Requests larger than the current block get a new block, kept after a reset.
+    void* large = arena.allocate(4096, 16);
+    std::size_t capacity = arena.capacity();
+    EXPECT_GE(capacity, 4096u + 256u);
+
+    arena.reset();
+    EXPECT_EQ(a, arena.allocate(24, 8));
+    EXPECT_EQ(large, arena.allocate(4096, 16));
+    EXPECT_EQ(capacity, arena.capacity());
+
+    {
+        scratch_scope scope(arena);
+        std::vector<int, scratch_allocator<int>> v{scratch_allocator<int>(arena)};
+
+        for (int i = 0; i < 1000; ++i) {
+            v.push_back(i);
+        }
+
+        EXPECT_EQ(499500, std::accumulate(v.begin(), v.end(), 0));
+    }
+
+    EXPECT_EQ(static_cast<char*>(large) + 4096, arena.allocate(1, 1));
+    arena.release();
+    EXPECT_EQ(0u, arena.capacity());
+}
+
+TEST(IteratorBasedForParallelTest, ForEachHandsEveryChunkItsThreadsArena)
+{
+    thread_pool pool(3);
+    std::vector<std::size_t> sums(20000);
+    std::iota(sums.begin(), sums.end(), 0);
+
+    auto body = [](std::size_t& x, scratch_arena& arena) {
+        EXPECT_EQ(&this_thread_scratch_arena(), &arena);
+        std::vector<std::size_t, scratch_allocator<std::size_t>> digits{scratch_allocator<std::size_t>(arena)};
+
+        for (std::size_t y = x; y > 0; y /= 10) {
+            digits.push_back(y % 10);
+        }
+
+        x = std::accumulate(digits.begin(), digits.end(), std::size_t(0));
+    };
+
+    for_each(execution::par.on(pool), (sums.begin(), sums.end()), body);
+    EXPECT_EQ(1u + 9u + 9u + 9u + 9u, sums[19999]);
+    EXPECT_EQ(0u, sums[0]);
+
+    //The arena is rewound after every element, so the first block serves the whole loop.
+    for_each(execution::par.on(pool), (sums.begin(), sums.end()), [](std::size_t&, scratch_arena& arena) {
+        std::fill_n(static_cast<char*>(arena.allocate(1000)), 1000, 'x');
+        EXPECT_EQ(64u * 1024u, arena.capacity());
+    });
+
+    std::list<std::size_t> l({123, 45});
+    for_each(execution::par.on(pool), (l.begin(), l.end()), body);
+    for_each(execution::seq, (sums.begin(), sums.begin() + 2), body);
+    EXPECT_EQ(std::list<std::size_t>({6, 9}), l);
+}
+
+TEST(IteratorBasedForParallelTest, NestedForEachKeepsOuterScratch)
+{
+    thread_pool pool(2);
+    std::vector<int> rows(64);
+    std::vector<int> columns(1000, 1);
+    std::iota(rows.begin(), rows.end(), 0);
+
+    for_each(execution::par.on(pool), (rows.begin(), rows.end()), [&](int& row, scratch_arena& arena) {
+        int* outer = static_cast<int*>(arena.allocate(sizeof(int) * 16, alignof(int)));
+        std::fill(outer, outer + 16, row);
+
+        for_each(execution::par.on(pool), (columns.begin(), columns.end()), [](int&, scratch_arena& inner) {
+            int* scratch = static_cast<int*>(inner.allocate(sizeof(int) * 16, alignof(int)));
+            std::fill(scratch, scratch + 16, -1);
+        });
+
+        row = std::accumulate(outer, outer + 16, 0);
+    });
+
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        EXPECT_EQ(static_cast<int>(i) * 16, rows[i]);
+    }
+}
+
+#if ITERATOR_BASED_FOR_HAS_STD_MEMORY_RESOURCE
+TEST(IteratorBasedForParallelTest, ScratchArenaIsAMemoryResource)
+{
+    thread_pool pool(2);
+    std::vector<std::string> words(5000, "scratch");
+
+    for_each(execution::par.on(pool), (words.begin(), words.end()), [](std::string& w, scratch_arena& arena) {
+        std::pmr::string upper(w.begin(), w.end(), &arena);
+        std::transform(upper.begin(), upper.end(), upper.begin(), [](char c) { return static_cast<char>(c - 32); });
+        w.assign(upper.begin(), upper.end());
+    });
+
+    EXPECT_EQ(std::vector<std::string>(5000, "SCRATCH"), words);
+}
+#endif
+
+TEST(IteratorBasedForParallelTest, ForEachCartesianProductSplitsTheFirstRange)
+{
+    thread_pool pool(3);
+    std::vector<int> rows(100);
+    std::list<int> columns(30);
+    std::iota(rows.begin(), rows.end(), 0);
+    std::iota(columns.begin(), columns.end(), 0);
+    std::vector<std::atomic<int>> visits(rows.size() * columns.size());
+
+    for (auto& v : visits) {
+        v = 0;
+    }
+
+    auto product = cartesian_product((rows.begin(), rows.end()), (columns.begin(), columns.end()));
+    auto visit = [&visits](std::tuple<int&, int&> _pair) { ++visits[std::get<0>(_pair) * 30 + std::get<1>(_pair)]; };
+
+    for_each(execution::par.on(pool), product, visit);
+    for_each(execution::seq, product, visit);
+
+    //A product whose first range has no constant-time size runs on the calling thread.
+    for_each(execution::par.on(pool), cartesian_product((columns.begin(), columns.end()), (rows.begin(), rows.end())),
+             [&visits](std::tuple<int&, int&> _pair) { ++visits[std::get<1>(_pair) * 30 + std::get<0>(_pair)]; });
+
+    for (auto& v : visits) {
+        EXPECT_EQ(3, v.load());
+    }
+}
+
+TEST(IteratorBasedForParallelTest, SplitPointIndexDividesNodeBasedRanges)
+{
+    std::map<int, long> book;
+
+    for (int price = 0; price < 10000; ++price) {
+        book[price] = price;
+    }
+
+    auto levels = (book.lower_bound(1000), book.upper_bound(8999));
+    split_point_index<std::map<int, long>::iterator> index(levels, 16);
+    EXPECT_EQ(8000u, index.size());
+    EXPECT_GE(index.pieces(), 16u);
+    EXPECT_LE(index.pieces(), 32u);
+    EXPECT_TRUE(index.points().front() == levels.begin() && index.points().back() == levels.end());
+
+    thread_pool pool(3);
+    std::atomic<long> sum(0);
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+
+    for_each(execution::par.on(pool), index, [&](std::pair<const int, long>& level) {
+        level.second *= 2;
+        sum += level.second;
+        std::this_thread::sleep_for(std::chrono::microseconds(5));
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(std::this_thread::get_id());
+    });
+
+    long expected = 0;
+
+    for (int price = 1000; price < 9000; ++price) {
+        expected += 2L * price;
+    }
+
+    EXPECT_EQ(expected, sum.load());
+    EXPECT_EQ(999, book[999]);
+    EXPECT_EQ(2000, book[1000]);
+    EXPECT_GT(threads.size(), 1u);
+
+    //Pieces cover the range in order, and the index stays usable while other elements are inserted.
+    book[5000] = 0;
+    std::mutex pieces_mutex;
+    std::vector<std::pair<int, int>> pieces;
+
+    parallel_for(execution::par.on(pool), index, [&](const iterator_range<std::map<int, long>::iterator>& _piece) {
+        std::lock_guard<std::mutex> lock(pieces_mutex);
+        pieces.emplace_back(_piece.begin()->first, std::prev(_piece.end())->first);
+    });
+
+    std::sort(pieces.begin(), pieces.end());
+    EXPECT_EQ(1000, pieces.front().first);
+    EXPECT_EQ(8999, pieces.back().second);
+
+    for (std::size_t i = 1; i < pieces.size(); ++i) {
+        EXPECT_EQ(pieces[i - 1].second + 1, pieces[i].first);
+    }
+
+    std::set<int> empty;
+    split_point_index<std::set<int>::iterator> nothing((empty.begin(), empty.end()), 8);
+    EXPECT_EQ(0u, nothing.pieces());
+    int visits = 0;
+    for_each(execution::par.on(pool), nothing, [&visits](int) { ++visits; });
+    for_each(execution::seq, split_point_index<std::set<int>::iterator>((empty.begin(), empty.end()), 0),
+             [&visits](int) { ++visits; });
+    EXPECT_EQ(0, visits);
+}
+
+TEST(IteratorBasedForParallelTest, BucketsOfUnorderedContainers)
+{
+    std::unordered_map<int, int> sessions;
+
+    for (int id = 0; id < 20000; ++id) {
+        sessions[id] = id % 7;
+    }
+
+    auto all = buckets(sessions);
+    EXPECT_EQ(sessions.bucket_count(), all.size());
+    EXPECT_TRUE(is_random_access_iterator<decltype(all.begin())>::value);
+
+    thread_pool pool(3);
+    std::atomic<std::size_t> visited(0);
+
+    for_each(execution::par.on(pool), all, [&visited](iterator_range<std::unordered_map<int, int>::local_iterator> b) {
+        for (auto& session : b) {
+            session.second += 1;
+            ++visited;
+        }
+    });
+
+    EXPECT_EQ(sessions.size(), visited.load());
+    EXPECT_EQ(4, sessions[3]);
+
+    const std::unordered_set<int> ids({1, 2, 3, 5, 8});
+    std::size_t total = 0;
+
+    auto id_buckets = buckets(ids);
+
+    for (auto it = id_buckets.begin(); it != id_buckets.end(); ++it) {
+        for (int id : *it) {
+            EXPECT_EQ(ids.bucket(id), it.bucket());
+            total += static_cast<std::size_t>(id);
+        }
+    }
+
+    EXPECT_EQ(19u, total);
+    EXPECT_FALSE(id_buckets[static_cast<std::ptrdiff_t>(ids.bucket(8))].empty());
+}
+
+TEST(IteratorBasedForParallelTest, ParallelForCoversRangeInGrainSizedPieces)
+{
+    thread_pool pool(3);
+    std::vector<std::atomic<int>> counts(5000);
+    std::atomic<std::size_t> largest(0);
+
+    for (auto& c : counts) {
+        c = 0;
+    }
+
+    parallel_for(execution::par.on(pool), (counts.begin() + 7, counts.end()),
+                 [&largest](const iterator_range<std::vector<std::atomic<int>>::iterator>& _chunk) {
+        std::size_t size = _chunk.size();
+        std::size_t seen = largest.load();
+
+        while (size > seen && !largest.compare_exchange_weak(seen, size)) { }
+
+        for (auto& c : _chunk) {
+            ++c;
+        }
+    }, 64);
+
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        EXPECT_EQ(i < 7 ? 0 : 1, counts[i].load());
+    }
+
+    EXPECT_LE(largest.load(), 64u);
+}
+
+TEST(IteratorBasedForParallelTest, ParallelForBalancesIrregularWork)
+{
+    thread_pool pool(3);
+    std::vector<int> v(2000);
+    std::iota(v.begin(), v.end(), 0);
+    std::atomic<long> sum(0);
+
+    //The first few elements are far more expensive than the rest.
+    parallel_for(execution::par.on(pool), (v.begin(), v.end()), [&sum](const iterator_range<std::vector<int>::iterator>& _chunk) {
+        for (int x : _chunk) {
+            if (x < 8) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+
+            sum += x;
+        }
+    }, 1);
+
+    EXPECT_EQ(1999L * 2000L / 2, sum.load());
+}
+
+TEST(IteratorBasedForParallelTest, ParallelForRethrowsException)
+{
+    thread_pool pool(2);
+    std::vector<int> v(1000);
+
+    EXPECT_THROW(parallel_for(execution::par.on(pool), (v.begin(), v.end()),
+                              [](const iterator_range<std::vector<int>::iterator>& _chunk) {
+        if (_chunk.begin() != _chunk.end() && _chunk.front() == 0 && _chunk.size() < 10) {
+            throw std::runtime_error("chunk failed");
+        }
+    }, 4), std::runtime_error);
+}
+
+TEST(IteratorBasedForParallelTest, GrainTunerTargetsPieceTime)
+{
+    grain_tuner tuner;
+    EXPECT_FALSE(tuner.tuned());
+    EXPECT_FALSE(tuner.runs_serially(10));
+    EXPECT_EQ(1000u / (4 * 16), tuner.grain(1000, 4));
+
+    //At 10 ns an element, a piece of tuned_piece_time holds 5000 elements.
+    tuner.record(1000, std::chrono::microseconds(10));
+    EXPECT_TRUE(tuner.tuned());
+    EXPECT_EQ(5000u, tuner.grain(1000000, 4));
+    EXPECT_EQ(250u, tuner.grain(1000, 4));
+    EXPECT_TRUE(tuner.runs_serially(4000));
+    EXPECT_FALSE(tuner.runs_serially(6000));
+
+    //Later measurements move the estimate a quarter of the way.
+    tuner.record(1000, std::chrono::microseconds(50));
+    EXPECT_EQ(2500u, tuner.grain(1000000, 4));
+
+    //Elements costing more than a piece are handed out one at a time.
+    tuner.record(1, std::chrono::milliseconds(10));
+    EXPECT_EQ(1u, tuner.grain(1000000, 4));
+}
+
+TEST(IteratorBasedForParallelTest, TunedLoopsLearnTheirGrain)
+{
+    thread_pool pool(3);
+    grain_tuner tuner;
+    std::vector<int> v(1 << 20, 1);
+
+    for (int i = 0; i < 3; ++i) {
+        std::atomic<long> sum(0);
+        std::atomic<std::size_t> pieces(0);
+
+        parallel_for(execution::par.on(pool).tuned(tuner), (v.cbegin(), v.cend()),
+                     [&](const iterator_range<std::vector<int>::const_iterator>& _piece) {
+            sum += std::accumulate(_piece.begin(), _piece.end(), 0L);
+            ++pieces;
+        });
+
+        EXPECT_EQ(static_cast<long>(v.size()), sum.load());
+        EXPECT_LE(1u, pieces.load());
+    }
+
+    EXPECT_TRUE(tuner.tuned());
+
+    //A range the tuner knows to be short runs as a single piece on the calling thread.
+    std::vector<std::thread::id> ids(16);
+    for_each(execution::par.tuned(tuner).on(pool), (ids.begin(), ids.end()), [](std::thread::id& id) {
+        id = std::this_thread::get_id();
+    });
+
+    for (const std::thread::id& id : ids) {
+        EXPECT_EQ(std::this_thread::get_id(), id);
+    }
+
+    //The macro keeps one tuner for each place it is written.
+    std::atomic<long> total(0);
+    for (int i = 0; i < 2; ++i) {
+        for_each(ITERATOR_BASED_FOR_TUNED(execution::par_unseq.on(pool)), (v.cbegin(), v.cend()),
+                 [&total](int x) { total += x; });
+    }
+
+    EXPECT_EQ(2 * static_cast<long>(v.size()), total.load());
+    EXPECT_NE(&tuner, ITERATOR_BASED_FOR_TUNED(execution::par).tuner());
+}
+
+TEST(IteratorBasedForParallelTest, LocalLoopsRunOneBlockPerThread)
+{
+    thread_pool pool(3);
+    std::vector<int> v(10001, 0);
+    std::mutex mutex;
+    std::vector<std::size_t> sizes;
+
+    parallel_for(execution::par.on(pool).local(), (v.begin(), v.end()),
+                 [&](const iterator_range<std::vector<int>::iterator>& _block) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sizes.push_back(_block.size());
+        }
+
+        for (int& x : _block) {
+            ++x;
+        }
+    });
+
+    EXPECT_TRUE(std::all_of(v.begin(), v.end(), [](int x) { return x == 1; }));
+    std::sort(sizes.begin(), sizes.end());
+    EXPECT_EQ((std::vector<std::size_t>{2500, 2500, 2500, 2501}), sizes);
+
+    //A grain size cuts every block into pieces.
+    sizes.clear();
+    parallel_for(execution::par.on(pool).local(), (v.begin(), v.end()),
+                 [&](const iterator_range<std::vector<int>::iterator>& _piece) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sizes.push_back(_piece.size());
+    }, 1000);
+
+    EXPECT_EQ(4u * 3u, sizes.size());
+    EXPECT_EQ(v.size(), std::accumulate(sizes.begin(), sizes.end(), std::size_t(0)));
+
+    EXPECT_THROW(for_each(execution::par_unseq.on(pool).local(), (v.begin(), v.end()), [&v](int& x) {
+        if (&x == &v[5000]) {
+            throw std::runtime_error("element");
+        }
+    }), std::runtime_error);
+}
+
+TEST(IteratorBasedForParallelTest, PinnedPoolsFirstTouchTheirBlocks)
+{
+    thread_pool pool(3, thread_affinity::compact);
+    EXPECT_EQ(4u, pool.concurrency());
+    EXPECT_EQ(!allowed_cpus().empty(), pool.pinned());
+
+    for (std::size_t i = 0; i < pool.concurrency(); ++i) {
+        EXPECT_LE(-1, pool.numa_node(i));
+    }
+
+    const std::size_t n = 1 << 20;
+    std::unique_ptr<double[]> values(new double[n]);
+    iterator_range<double*> range(values.get(), values.get() + n);
+    first_touch(execution::par.on(pool), range, 0.5);
+
+    EXPECT_TRUE(std::all_of(values.get(), values.get() + n, [](double x) { return x == 0.5; }));
+    EXPECT_LE(-1, numa_node_of(values.get() + n / 2));
+
+    std::atomic<std::size_t> count(0);
+    for_each(execution::par.on(pool).local(), range, [&count](double) { ++count; });
+    EXPECT_EQ(n, count.load());
+}
+
+TEST(IteratorBasedForParallelTest, NestedParallelFor)
+{
+    thread_pool pool(2);
+    std::vector<int> outer(16);
+    std::vector<int> inner(256);
+    std::atomic<int> total(0);
+
+    for_each(execution::par.on(pool), (outer.begin(), outer.end()), [&](int) {
+        for_each(execution::par.on(pool), (inner.begin(), inner.end()), [&total](int) { ++total; });
+    });
+
+    EXPECT_EQ(16 * 256, total.load());
+}
+
+namespace {
+
+    //An index range modelling the splittable range requirements without being an iterator_range.
+    struct index_range {
+        std::size_t first;
+        std::size_t last;
+
+        index_range(std::size_t _first, std::size_t _last) : first(_first), last(_last) { }
+
+        index_range(index_range& _range, split) : first(_range.first + (_range.last - _range.first) / 2),
+                                                  last(_range.last) {
+            _range.last = first;
+        }
+
+        bool empty() const { return first == last; }
+        bool is_divisible() const { return last - first > 10; }
+    };
+
+}
+
+TEST(IteratorBasedForParallelTest, ParallelForSplittableRange)
+{
+    thread_pool pool(3);
+    std::vector<std::atomic<int>> counts(1000);
+
+    for (auto& c : counts) {
+        c = 0;
+    }
+
+    parallel_for(execution::par.on(pool), index_range(0, counts.size()), [&counts](const index_range& _piece) {
+        EXPECT_LE(_piece.last - _piece.first, 10u);
+
+        for (std::size_t i = _piece.first; i != _piece.last; ++i) {
+            ++counts[i];
+        }
+    });
+
+    for (auto& c : counts) {
+        EXPECT_EQ(1, c.load());
+    }
+
+    std::vector<int> v(100);
+    std::atomic<int> pieces(0);
+    parallel_for(execution::par.on(pool), make_blocked_range((v.begin(), v.end()), 25),
+                 [&pieces](const blocked_iterator_range<std::vector<int>::iterator>& _piece) {
+        EXPECT_FALSE(_piece.is_divisible());
+        ++pieces;
+    });
+
+    EXPECT_EQ(4, pieces.load());
+}
+
+TEST(IteratorBasedForParallelTest, ReduceAndCount)
+{
+    thread_pool pool(3);
+    std::vector<long> v(100000);
+    std::iota(v.begin(), v.end(), 1L);
+    auto par = execution::par.on(pool);
+
+    EXPECT_EQ(100000L * 100001L / 2, reduce(par, (v.begin(), v.end())));
+    EXPECT_EQ(100000L * 100001L / 2 + 5, reduce(par, (v.begin(), v.end()), 5L));
+    EXPECT_EQ(100000L * 100001L / 2, reduce(execution::seq, (v.begin(), v.end()), 0L));
+    EXPECT_EQ(100000L, reduce(par, (v.begin(), v.end()), 0L, [](long a, long b) { return std::max(a, b); }));
+    EXPECT_EQ(7L, reduce(par, (v.begin(), v.begin()), 7L));
+    EXPECT_EQ(50000, count_if(par, (v.begin(), v.end()), [](long x) { return x % 2 == 0; }));
+    EXPECT_EQ(2L * 100000L, transform_reduce(par, (v.begin(), v.end()), 0L, std::plus<long>(),
+                                             [](long) { return 2L; }));
+
+    std::list<int> l({1, 2, 3, 4});
+    EXPECT_EQ(10, reduce(par, (l.begin(), l.end())));
+    EXPECT_EQ(2, count_if(par, (l.begin(), l.end()), [](int x) { return x > 2; }));
+
+    std::vector<std::string> words({"a", "b", "c"});
+    EXPECT_EQ(3u, transform_reduce(par, (words.begin(), words.end()), std::size_t(0), std::plus<std::size_t>(),
+                                   [](const std::string& _s) { return _s.size(); }));
+}
+
+TEST(IteratorBasedForParallelTest, AggregateByKey)
+{
+    thread_pool pool(3);
+    std::vector<long> v(100000);
+    std::iota(v.begin(), v.end(), 0L);
+    auto par = execution::par.on(pool);
+    auto last_digit = [](long x) { return x % 10; };
+    auto sum = [](long a, long x) { return a + x; };
+    auto count = [](std::size_t c, long) { return c + 1; };
+
+    flat_aggregate_table<long, long> sums = aggregate_by_key((v.begin(), v.end()), last_digit, 0L, sum);
+    ASSERT_EQ(10u, sums.size());
+    EXPECT_EQ(0L, sums.begin()->first);
+    EXPECT_EQ(2u * aggregate_reserve_limit, sums.slot_count());
+
+    for (const std::pair<long, long>& entry : sums) {
+        EXPECT_EQ(10000L * entry.first + 10L * 9999L * 10000L / 2, entry.second);
+    }
+
+    EXPECT_EQ(sums.end(), sums.find(10));
+    EXPECT_EQ(7L, sums.find(7)->first);
+
+    flat_aggregate_table<long, std::size_t> counts =
+        aggregate_by_key(par, (v.begin(), v.end()), [](long x) { return x % 1000; }, std::size_t(0), count,
+                         std::plus<std::size_t>());
+    ASSERT_EQ(1000u, counts.size());
+
+    for (const std::pair<long, std::size_t>& entry : counts) {
+        EXPECT_EQ(100u, entry.second);
+    }
+
+    flat_aggregate_table<long, long> distinct = aggregate_by_key(par, (v.begin(), v.end()), [](long x) { return x; },
+                                                                 0L, sum, std::plus<long>());
+    ASSERT_EQ(v.size(), distinct.size());
+    EXPECT_EQ(12345L, distinct.find(12345)->second);
+
+    std::list<std::string> words({"apple", "bee", "avocado", "cherry", "banana"});
+    flat_aggregate_table<char, std::string> by_initial =
+        aggregate_by_key(par, (words.begin(), words.end()), [](const std::string& _s) { return _s[0]; },
+                         std::string(), [](std::string a, const std::string& _s) { return a + _s; },
+                         std::plus<std::string>());
+    ASSERT_EQ(3u, by_initial.size());
+    EXPECT_EQ('a', by_initial.begin()->first);
+    EXPECT_EQ("appleavocado", by_initial.find('a')->second);
+    EXPECT_EQ("beebanana", by_initial.find('b')->second);
+
+    EXPECT_TRUE(aggregate_by_key((v.begin(), v.begin()), last_digit, 0L, sum).empty());
+}
+
+TEST(IteratorBasedForParallelTest, ReduceFromForeignThreads)
+{
+    thread_pool pool(2);
+    std::vector<int> v(20000, 1);
+    std::vector<std::thread> threads;
+    std::atomic<int> wrong(0);
+
+    for (int t = 0; t < 3; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 20; ++i) {
+                if (reduce(execution::par.on(pool), (v.begin(), v.end())) != 20000) {
+                    ++wrong;
+                }
+            }
+        });
+    }
+
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(0, wrong.load());
+}
+
+TEST(IteratorBasedForParallelTest, InclusiveAndExclusiveScan)
+{
+    thread_pool pool(3);
+    auto par = execution::par.on(pool);
+
+    for (std::size_t n : {0u, 1u, 7u, 5000u, 100003u}) {
+        std::vector<long> v(n);
+        std::iota(v.begin(), v.end(), 1L);
+
+        std::vector<long> expected(n);
+        std::partial_sum(v.begin(), v.end(), expected.begin());
+
+        std::vector<long> out(n, -1);
+        EXPECT_EQ(out.end(), inclusive_scan(par, (v.begin(), v.end()), out.begin()));
+        EXPECT_EQ(expected, out);
+
+        std::fill(out.begin(), out.end(), -1);
+        inclusive_scan(par, (v.begin(), v.end()), out.begin(), std::plus<long>(), 10L);
+        for (std::size_t i = 0; i < n; ++i) {
+            EXPECT_EQ(expected[i] + 10, out[i]);
+        }
+
+        std::fill(out.begin(), out.end(), -1);
+        EXPECT_EQ(out.end(), exclusive_scan(par, (v.begin(), v.end()), out.begin(), 3L));
+        for (std::size_t i = 0; i < n; ++i) {
+            EXPECT_EQ((i == 0 ? 0 : expected[i - 1]) + 3, out[i]);
+        }
+
+        std::vector<long> in_place(v);
+        inclusive_scan(par, (in_place.begin(), in_place.end()), in_place.begin());
+        EXPECT_EQ(expected, in_place);
+    }
+}
+
+namespace {
+
+    template <typename T, typename Policy>
+    void check_integral_scan_matches_serial_scan(const Policy& _policy) {
+        for (std::size_t n : {0u, 1u, 7u, 8u, 17u, 5000u, 100003u}) {
+            SCOPED_TRACE(n);
+            std::vector<T> v(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                v[i] = static_cast<T>((i * 7919) % 1000) - static_cast<T>(i % 3);
+            }
+
+            std::vector<T> inclusive(n);
+            std::partial_sum(v.begin(), v.end(), inclusive.begin());
+
+            std::vector<T> out(n);
+            EXPECT_EQ(out.end(), inclusive_scan(_policy, (v.cbegin(), v.cend()), out.begin()));
+            EXPECT_EQ(inclusive, out);
+
+            inclusive_scan(_policy, (v.begin(), v.end()), out.begin(), std::plus<>(), T(5));
+            for (std::size_t i = 0; i < n; ++i) {
+                EXPECT_EQ(static_cast<T>(inclusive[i] + 5), out[i]);
+            }
+
+            EXPECT_EQ(out.end(), exclusive_scan(_policy, (v.begin(), v.end()), out.begin(), T(5)));
+            for (std::size_t i = 0; i < n; ++i) {
+                EXPECT_EQ(static_cast<T>((i == 0 ? T(0) : inclusive[i - 1]) + 5), out[i]);
+            }
+
+            std::vector<T> in_place(v);
+            exclusive_scan(_policy, (in_place.begin(), in_place.end()), in_place.begin(), T(0));
+            for (std::size_t i = 0; i < n; ++i) {
+                EXPECT_EQ(i == 0 ? T(0) : inclusive[i - 1], in_place[i]);
+            }
+        }
+    }
+}
+
+TEST(IteratorBasedForParallelTest, IntegralScanMatchesSerialScan)
+{
+    thread_pool pool(3);
+    auto par = execution::par.on(pool);
+
+    check_integral_scan_matches_serial_scan<std::int32_t>(par);
+    check_integral_scan_matches_serial_scan<std::uint32_t>(par);
+    check_integral_scan_matches_serial_scan<std::int64_t>(par);
+    check_integral_scan_matches_serial_scan<std::uint64_t>(par);
+    check_integral_scan_matches_serial_scan<std::int32_t>(execution::seq);
+    check_integral_scan_matches_serial_scan<std::uint64_t>(execution::seq);
+}
+
+TEST(IteratorBasedForParallelTest, ScanWithOtherOperations)
+{
+    thread_pool pool(3);
+    auto par = execution::par.on(pool);
+    std::vector<int> v(20000);
+
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        v[i] = static_cast<int>((i * 7919) % 1000);
+    }
+
+    std::vector<int> expected(v.size());
+    std::partial_sum(v.begin(), v.end(), expected.begin(), [](int a, int b) { return std::max(a, b); });
+
+    std::vector<int> out(v.size());
+    inclusive_scan(par, (v.begin(), v.end()), out.begin(), [](int a, int b) { return std::max(a, b); });
+    EXPECT_EQ(expected, out);
+
+    //Non-arithmetic, non-commutative elements and a sequential output iterator.
+    std::vector<std::string> words(9000, "ab");
+    std::list<std::string> concatenated;
+    exclusive_scan(par, (words.begin(), words.end()), std::back_inserter(concatenated), std::string("x"));
+    EXPECT_EQ(words.size(), concatenated.size());
+    EXPECT_EQ("x", concatenated.front());
+    EXPECT_EQ(1 + 2 * (words.size() - 1), concatenated.back().size());
+
+    std::vector<std::string> prefixes(words.size());
+    inclusive_scan(par, (words.begin(), words.end()), prefixes.begin());
+    EXPECT_EQ(std::string(2 * words.size(), 'a').size(), prefixes.back().size());
+    EXPECT_EQ("abab", prefixes[1]);
+}
+
+TEST(IteratorBasedForParallelTest, CountingRanges)
+{
+    thread_pool pool(3);
+    auto par = execution::par.on(pool);
+    std::vector<int> squares(10000);
+
+    for_each(par, iota(0, 10000), [&squares](int i) { squares[static_cast<std::size_t>(i)] = i * i; });
+
+    for (int i : iota(0, 10000)) {
+        EXPECT_EQ(i * i, squares[static_cast<std::size_t>(i)]);
+    }
+
+    EXPECT_EQ(9999L * 10000L / 2, reduce(par, iota<long>(0, 10000)));
+    EXPECT_EQ(5000, count_if(par, iota(0, 10000), [](int i) { return i % 2 == 0; }));
+}
+
+namespace {
+
+    template <typename T>
+    std::vector<T> shuffled_values(std::size_t _n, unsigned _seed) {
+        std::mt19937_64 random(_seed);
+        std::vector<T> v(_n);
+
+        for (T& x : v) {
+            x = static_cast<T>(random() % 1000000) - static_cast<T>(std::is_signed<T>::value ? 500000 : 0);
+        }
+
+        return v;
+    }
+
+    template <typename T, typename Policy>
+    void check_sorts(const Policy& _policy) {
+        for (std::size_t n : {0u, 1u, 1000u, 5000u, 200000u}) {
+            std::vector<T> v = shuffled_values<T>(n, 7);
+            std::vector<T> expected = v;
+            std::sort(expected.begin(), expected.end());
+
+            std::vector<T> sorted = v;
+            sort(_policy, (sorted.begin(), sorted.end()));
+            EXPECT_EQ(expected, sorted);
+
+            sorted = v;
+            stable_sort(_policy, (sorted.begin(), sorted.end()));
+            EXPECT_EQ(expected, sorted);
+
+            //Sorting in descending order takes the comparison sort.
+            sorted = v;
+            sort(_policy, (sorted.begin(), sorted.end()), std::greater<>());
+            EXPECT_EQ(std::vector<T>(expected.rbegin(), expected.rend()), sorted);
+        }
+    }
+
+}
+
+TEST(IteratorBasedForParallelTest, FindReturnsLeftmostMatchWithoutScanningEverything)
+{
+    thread_pool pool(3);
+    std::vector<int> v(1 << 20);
+    std::iota(v.begin(), v.end(), 0);
+    std::atomic<std::size_t> calls(0);
+
+    auto it = find_if(execution::par.on(pool), (v.cbegin(), v.cend()), [&calls](int x) {
+        ++calls;
+        return x % 1000 == 999;
+    });
+
+    EXPECT_EQ(999, *it);
+    //Every piece stops at its first match, or earlier once a match to its left is known.
+    EXPECT_GT(v.size() / 4, calls.load());
+
+    EXPECT_EQ(v.cbegin() + 777777, find(execution::par_unseq.on(pool), (v.cbegin(), v.cend()), 777777));
+    EXPECT_EQ(v.cend(), find(execution::par.on(pool), (v.cbegin(), v.cend()), -1));
+    EXPECT_EQ(v.cbegin() + 5, find(execution::seq, (v.cbegin(), v.cend()), 5));
+
+    std::list<int> l(v.begin(), v.begin() + 100);
+    EXPECT_EQ(42, *find_if(execution::par, (l.cbegin(), l.cend()), [](int x) { return x > 41; }));
+
+    std::vector<int> empty;
+    EXPECT_EQ(empty.cend(), find(execution::par.on(pool), (empty.cbegin(), empty.cend()), 0));
+}
+
+TEST(IteratorBasedForParallelTest, AnyOfStopsAllThreadsAtFirstMatch)
+{
+    thread_pool pool(3);
+    std::vector<int> v(1 << 20, 0);
+    v[v.size() / 3] = 1;
+    v[v.size() / 2] = 1;
+    std::atomic<std::size_t> calls(0);
+
+    auto counted = [&calls](int x) {
+        ++calls;
+        return x == 1;
+    };
+
+    EXPECT_TRUE(any_of(execution::par.on(pool), (v.cbegin(), v.cend()), counted));
+    EXPECT_GT(v.size(), calls.load());
+
+    calls = 0;
+    EXPECT_TRUE(all_of(execution::par.on(pool), (v.cbegin(), v.cend()), [&calls](int x) {
+        ++calls;
+        return x >= 0;
+    }));
+    EXPECT_EQ(v.size(), calls.load());
+
+    EXPECT_FALSE(none_of(execution::par_unseq.on(pool), (v.cbegin(), v.cend()), [](int x) { return x == 1; }));
+    EXPECT_TRUE(none_of(execution::par.on(pool), (v.cbegin(), v.cend()), [](int x) { return x == 2; }));
+    EXPECT_FALSE(all_of(execution::seq, (v.cbegin(), v.cend()), [](int x) { return x == 0; }));
+    EXPECT_FALSE(any_of(execution::par.on(pool), (v.cbegin(), v.cbegin()), [](int) { return true; }));
+}
+
+TEST(IteratorBasedForParallelTest, CancellationTokenStopsLoops)
+{
+    thread_pool pool(3);
+    std::vector<int> v(1 << 20, 0);
+    cancellation_token token;
+    std::atomic<std::size_t> visited(0);
+
+    for_each(execution::par.on(pool).cancelled_by(token), (v.begin(), v.end()), [&](int&) {
+        ++visited;
+        token.cancel();
+    });
+
+    //Only the pieces already running when the token was cancelled are finished.
+    EXPECT_TRUE(token.cancelled());
+    EXPECT_GE(pool.concurrency() * (v.size() / (pool.concurrency() * 16) + 1), visited.load());
+
+    parallel_for(execution::par.on(pool).cancelled_by(token), (v.begin(), v.end()),
+                 [](const iterator_range<std::vector<int>::iterator>&) { ADD_FAILURE(); });
+
+    token.reset();
+    visited = 0;
+    for_each(execution::par.on(pool).cancelled_by(token).local(), (v.begin(), v.end()), [&](int&) { ++visited; });
+    EXPECT_EQ(v.size(), visited.load());
+}
+
+TEST(IteratorBasedForParallelTest, Sort)
+{
+    thread_pool pool(3);
+    auto par = execution::par.on(pool);
+
+    check_sorts<int>(par);
+    check_sorts<int>(execution::seq);
+    check_sorts<std::uint64_t>(par);
+    check_sorts<std::int16_t>(par);
+    check_sorts<double>(par);
+
+    std::vector<float> floats = {3.5f, -0.0f, -2.0f, 1e30f, 0.0f, -1e-30f, -7.25f};
+    floats.resize(4096, -3.0f);
+    std::vector<float> expected = floats;
+    std::sort(expected.begin(), expected.end());
+    sort(par, (floats.begin(), floats.end()));
+    EXPECT_TRUE(std::is_sorted(floats.begin(), floats.end()));
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), floats.begin()));
+
+    std::vector<std::string> words;
+
+    for (int x : shuffled_values<int>(100000, 3)) {
+        words.push_back(std::to_string(x));
+    }
+
+    std::vector<std::string> expected_words = words;
+    std::sort(expected_words.begin(), expected_words.end());
+    sort(par, (words.begin(), words.end()));
+    EXPECT_EQ(expected_words, words);
+}
+
+TEST(IteratorBasedForParallelTest, StableSortKeepsEquivalentElementsInOrder)
+{
+    thread_pool pool(3);
+    std::vector<std::pair<int, int>> v;
+
+    for (int x : shuffled_values<int>(300000, 5)) {
+        v.emplace_back(x % 100, static_cast<int>(v.size()));
+    }
+
+    auto by_key = [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; };
+    std::vector<std::pair<int, int>> expected = v;
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+
+    stable_sort(execution::par.on(pool), (v.begin(), v.end()), by_key);
+    EXPECT_EQ(expected, v);
+}
+
+TEST(IteratorBasedForParallelTest, NthElementAndPartialSort)
+{
+    thread_pool pool(3);
+    auto par = execution::par.on(pool);
+
+    for (std::size_t n : {1u, 1000u, 1000000u}) {
+        std::vector<int> v = shuffled_values<int>(n, 11);
+        std::vector<int> expected = v;
+        std::sort(expected.begin(), expected.end());
+
+        for (std::size_t nth : {std::size_t(0), n / 3, n - 1}) {
+            std::vector<int> selected = v;
+            auto it = selected.begin() + static_cast<std::ptrdiff_t>(nth);
+            nth_element(par, (selected.begin(), selected.end()), it);
+            EXPECT_EQ(expected[nth], *it);
+            EXPECT_TRUE(std::all_of(selected.begin(), it, [&](int x) { return x <= *it; }));
+            EXPECT_TRUE(std::all_of(it, selected.end(), [&](int x) { return x >= *it; }));
+        }
+
+        std::vector<int> partial = v;
+        auto middle = partial.begin() + static_cast<std::ptrdiff_t>(n / 2);
+        partial_sort(par, (partial.begin(), partial.end()), middle);
+        EXPECT_TRUE(std::equal(partial.begin(), middle, expected.begin()));
+
+        partial = v;
+        partial_sort(execution::seq, (partial.begin(), partial.end()), partial.end());
+        EXPECT_EQ(expected, partial);
+    }
+
+    //Ranges where most elements are equal end the partitioning early.
+    std::vector<int> same(500000, 4);
+    same[1234] = 1;
+    nth_element(par, (same.begin(), same.end()), same.begin() + 250000);
+    EXPECT_EQ(4, same[250000]);
+    EXPECT_EQ(1, *std::min_element(same.begin(), same.begin() + 250000));
+}
+
+namespace
+{
+
+    template <typename Queue>
+    void check_queue_transfers_in_order(Queue& _queue, int _count) {
+        std::thread producer([&]() {
+            std::vector<std::unique_ptr<int>> batch;
+
+            for (int i = 0; i < _count;) {
+                if (i % 3 == 0) {
+                    std::unique_ptr<int> value(new int(i++));
+                    EXPECT_TRUE(_queue.push(value));
+                    continue;
+                }
+
+                batch.clear();
+
+                for (int j = 0; j < 7 && i < _count; ++j) {
+                    batch.emplace_back(new int(i++));
+                }
+
+                for (std::size_t pushed = 0; pushed < batch.size(); std::this_thread::yield()) {
+                    pushed += _queue.try_push(batch.data() + pushed, batch.size() - pushed);
+                }
+            }
+
+            _queue.close();
+        });
+
+        int expected = 0;
+
+        for (auto& value : _queue.begin(), _queue.end()) {
+            ASSERT_TRUE(value != nullptr);
+            EXPECT_EQ(expected++, *value);
+            std::unique_ptr<int> taken = std::move(value);
+        }
+
+        producer.join();
+        EXPECT_EQ(_count, expected);
+
+        std::unique_ptr<int> late(new int(0));
+        EXPECT_FALSE(_queue.push(late));
+        EXPECT_TRUE(late != nullptr);
+    }
+
+}
+
+TEST(IteratorBasedForParallelTest, TopKMergesTheBestOfEveryBlock)
+{
+    thread_pool pool(3);
+    std::vector<float> scores(1 << 20);
+    for (std::size_t i = 0; i < scores.size(); ++i) {
+        scores[i] = static_cast<float>((i * 2654435761u) % 1000003);
+    }
+
+    std::vector<float> descending(scores);
+    std::sort(descending.begin(), descending.end(), std::greater<float>());
+
+    for (std::size_t k : {1u, 100u, 20000u, 100000u}) {
+        std::vector<float> best;
+        top_k(execution::par.on(pool), (scores.cbegin(), scores.cend()), k, std::back_inserter(best));
+        EXPECT_EQ(std::vector<float>(descending.begin(), descending.begin() + static_cast<std::ptrdiff_t>(k)), best);
+    }
+
+    std::vector<float> worst;
+    top_k(execution::seq, (scores.cbegin(), scores.cend()), 5, std::back_inserter(worst), std::less<>());
+    EXPECT_EQ(std::vector<float>(descending.rbegin(), descending.rbegin() + 5), worst);
+
+    std::deque<int> values(300000);
+    std::iota(values.begin(), values.end(), 0);
+    std::vector<int> largest(2);
+    top_k(execution::par.on(pool), (values.begin(), values.end()), 2, largest.begin());
+    EXPECT_EQ((std::vector<int>{299999, 299998}), largest);
+}
+
+TEST(IteratorBasedForParallelTest, BoundedQueuesAsInputRanges)
+{
+    spsc_queue<std::unique_ptr<int>> spsc(10);
+    EXPECT_EQ(16u, spsc.capacity());
+    check_queue_transfers_in_order(spsc, 20000);
+
+    bounded_queue<std::unique_ptr<int>> mpmc(10);
+    check_queue_transfers_in_order(mpmc, 20000);
+
+    spsc_queue<int> batches(4);
+    int values[6] = {1, 2, 3, 4, 5, 6};
+    EXPECT_EQ(4u, batches.try_push(values, 6));
+    EXPECT_EQ(0u, batches.try_push(values + 4, 2));
+    int popped[6] = {};
+    EXPECT_EQ(3u, batches.try_pop(popped, 3));
+    EXPECT_EQ(1u, batches.try_pop(popped + 3, 6));
+    EXPECT_EQ(0u, batches.try_pop(popped, 1));
+    EXPECT_EQ(4, popped[3]);
+
+    //Several producers and consumers see every element exactly once.
+    bounded_queue<int> shared(64);
+    std::atomic<long> total(0);
+    std::atomic<int> producers(3);
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < 3; ++p) {
+        threads.emplace_back([&, p]() {
+            for (int i = 1; i <= 10000; ++i) {
+                shared.push(i * 3 + p);
+            }
+
+            if (--producers == 0) {
+                shared.close();
+            }
+        });
+    }
+
+    for (int c = 0; c < 2; ++c) {
+        threads.emplace_back([&]() {
+            long sum = 0;
+
+            for (int x : shared.begin(), shared.end()) {
+                sum += x;
+            }
+
+            total += sum;
+        });
+    }
+
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(3L * (3L * 10000L * 10001L / 2) + 10000L * (0 + 1 + 2), total.load());
+}
+
+TEST(IteratorBasedForParallelTest, RcuContainerSnapshots)
+{
+    rcu_container<std::vector<std::shared_ptr<int>>> table;
+    table.store({std::make_shared<int>(1), std::make_shared<int>(2)});
+    std::weak_ptr<int> first;
+
+    {
+        auto snapshot = table.snapshot();
+        first = snapshot->front();
+        table.update([](std::vector<std::shared_ptr<int>>& _v) { _v.assign(1, std::make_shared<int>(3)); });
+
+        //The snapshot keeps its version alive and unchanged.
+        EXPECT_EQ(1u, table.reclaim());
+        EXPECT_FALSE(first.expired());
+        int sum = 0;
+
+        for (const std::shared_ptr<int>& x : snapshot) {
+            sum += *x;
+        }
+
+        EXPECT_EQ(3, sum);
+        EXPECT_EQ(3, *table.snapshot()->front());
+    }
+
+    EXPECT_EQ(0u, table.reclaim());
+    EXPECT_TRUE(first.expired());
+
+    //Readers always see one whole version while writers replace it.
+    rcu_container<std::vector<int>> versions(std::vector<int>(64, 0));
+    std::atomic<bool> done(false);
+    std::atomic<int> torn(0);
+    std::vector<std::thread> readers;
+
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&]() {
+            int last = 0;
+
+            while (!done.load()) {
+                auto snapshot = versions.snapshot();
+                const int version = snapshot->front();
+
+                for (int x : snapshot.begin(), snapshot.end()) {
+                    torn += x != version ? 1 : 0;
+                }
+
+                torn += version < last ? 1 : 0;
+                last = version;
+            }
+        });
+    }
+
+    for (int version = 1; version <= 2000; ++version) {
+        if (version % 2 == 0) {
+            versions.store(std::vector<int>(64, version));
+        } else {
+            versions.update([version](std::vector<int>& _v) { std::fill(_v.begin(), _v.end(), version); });
+        }
+    }
+
+    done = true;
+
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(0, torn.load());
+    EXPECT_EQ(0u, versions.reclaim());
+    EXPECT_EQ(2000, versions.snapshot()->back());
+}
+
+TEST(IteratorBasedForParallelTest, SharedCursorHandsOutEveryElementOnce)
+{
+    std::vector<int> v(100000, 0);
+    std::list<int> l(10000, 0);
+    shared_cursor<std::vector<int>::iterator> vector_cursor((v.begin(), v.end()));
+    shared_cursor<std::list<int>::iterator> list_cursor((l.begin(), l.end()));
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&vector_cursor, &list_cursor]() {
+            auto vector_consumer = vector_cursor.make_consumer();
+            auto vector_chunk = vector_cursor.empty_chunk();
+
+            while (vector_consumer.next(vector_chunk)) {
+                for (int& x : vector_chunk) {
+                    ++x;
+                }
+            }
+
+            auto list_chunk = list_cursor.empty_chunk();
+
+            while (list_cursor.claim(7, list_chunk) != 0) {
+                for (int& x : list_chunk) {
+                    ++x;
+                }
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_TRUE(std::all_of(v.begin(), v.end(), [](int x) { return x == 1; }));
+    EXPECT_TRUE(std::all_of(l.begin(), l.end(), [](int x) { return x == 1; }));
+
+    auto chunk = vector_cursor.empty_chunk();
+    EXPECT_EQ(0u, vector_cursor.claim(10, chunk));
+}
+
+TEST(IteratorBasedForParallelTest, SharedCursorAdaptsChunkSize)
+{
+    std::vector<int> v(1 << 24);
+    shared_cursor<std::vector<int>::iterator> cheap((v.begin(), v.end()));
+    auto consumer = cheap.make_consumer();
+    auto chunk = cheap.empty_chunk();
+    long sum = 0;
+    std::size_t largest = 0;
+
+    //Cheap elements grow the chunks until a chunk takes a measurable time. A preempted chunk shrinks them again.
+    for (int i = 0; i < 40 && consumer.next(chunk); ++i) {
+        sum += std::accumulate(chunk.begin(), chunk.end(), 0L);
+        largest = std::max(largest, consumer.chunk_size());
+    }
+
+    EXPECT_EQ(0, sum);
+    EXPECT_LT(1000u, largest);
+
+    //Elements costing more than the chunk time are claimed one at a time.
+    shared_cursor<std::vector<int>::iterator> expensive((v.begin(), v.begin() + 5));
+    auto slow = expensive.make_consumer();
+
+    while (slow.next(chunk)) {
+        EXPECT_EQ(1, chunk.end() - chunk.begin());
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+TEST(IteratorBasedForParallelTest, CopyIfRemoveIfAndPartition)
+{
+    thread_pool pool(3);
+    auto par = execution::par.on(pool);
+
+    for (std::size_t n : {0u, 5u, 100000u, 1000003u}) {
+        std::vector<std::int32_t> rows(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            rows[i] = static_cast<std::int32_t>((i * 7919) % 1000);
+        }
+
+        auto rare = [](std::int32_t x) { return x < 30; };
+        std::vector<std::int32_t> expected;
+        std::copy_if(rows.begin(), rows.end(), std::back_inserter(expected), rare);
+
+        std::vector<std::int32_t> selected(expected.size() + 1, -1);
+        EXPECT_EQ(selected.begin() + static_cast<std::ptrdiff_t>(expected.size()),
+                  copy_if(par, (rows.cbegin(), rows.cend()), selected.begin(), rare));
+        selected.pop_back();
+        EXPECT_EQ(expected, selected);
+
+        std::vector<std::int32_t> kept(rows);
+        auto end = remove_if(par, (kept.begin(), kept.end()), [&rare](std::int32_t x) { return !rare(x); });
+        EXPECT_EQ(expected, std::vector<std::int32_t>(kept.begin(), end));
+
+        std::vector<std::int32_t> parts(rows);
+        auto middle = partition(par, (parts.begin(), parts.end()), rare);
+        EXPECT_EQ(expected, std::vector<std::int32_t>(parts.begin(), middle));
+
+        std::vector<std::int32_t> rest;
+        std::remove_copy_if(rows.begin(), rows.end(), std::back_inserter(rest), rare);
+        EXPECT_EQ(rest, std::vector<std::int32_t>(middle, parts.end()));
+    }
+
+    //Sequential outputs, non-arithmetic elements and the sequenced policy.
+    std::vector<std::string> words(200000, "x");
+    for (std::size_t i = 0; i < words.size(); i += 1000) {
+        words[i] = "long";
+    }
+
+    std::list<std::string> listed;
+    copy_if(par, (words.cbegin(), words.cend()), std::back_inserter(listed), [](const std::string& s) {
+        return s.size() > 1;
+    });
+    EXPECT_EQ(200u, listed.size());
+
+    std::vector<std::string> long_words(words);
+    auto long_end = remove_if(par, (long_words.begin(), long_words.end()), [](const std::string& s) {
+        return s.size() == 1;
+    });
+    EXPECT_EQ(200, long_end - long_words.begin());
+    EXPECT_EQ("long", long_words[199]);
+
+    std::vector<int> small = {5, 1, 4, 2, 3};
+    auto small_middle = partition(execution::seq, (small.begin(), small.end()), [](int x) { return x % 2 == 0; });
+    EXPECT_EQ(2, small_middle - small.begin());
+    EXPECT_TRUE(std::all_of(small.begin(), small_middle, [](int x) { return x % 2 == 0; }));
+    EXPECT_EQ(small.begin() + 2, remove_if(execution::seq, (small.begin(), small.end()), [](int x) { return x > 2; }));
+}
+
+TEST(IteratorBasedForParallelTest, SketchesMergePerThreadSketches)
+{
+    thread_pool pool(3);
+    auto par = execution::par.on(pool);
+    std::vector<std::uint64_t> keys(1 << 19);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = i % 100000;
+    }
+
+    //Merged sketches equal the one built from all keys, since every sketch merges exactly.
+    EXPECT_EQ(build_bloom((keys.cbegin(), keys.cend()), 1 << 20, 5).words(),
+              build_bloom(par, (keys.cbegin(), keys.cend()), 1 << 20, 5).words());
+    EXPECT_EQ(hyperloglog((keys.cbegin(), keys.cend())).registers(),
+              hyperloglog(par, (keys.cbegin(), keys.cend())).registers());
+    EXPECT_EQ(hyperloglog((keys.cbegin(), keys.cend()), 12).registers(),
+              hyperloglog(execution::seq, (keys.cbegin(), keys.cend()), 12).registers());
+
+    count_min_sketch sequential = count_min((keys.cbegin(), keys.cend()));
+    count_min_sketch parallel = count_min(par, (keys.cbegin(), keys.cend()));
+
+    for (std::uint64_t k = 0; k < 1000; ++k) {
+        EXPECT_EQ(sequential.estimate(k), parallel.estimate(k));
+    }
+}
+
+TEST(IteratorBasedForParallelTest, GenerateRandomIndependentOfThreads)
+{
+    thread_pool pool(3);
+    std::vector<float> sequential(1000003), parallel(1000003);
+    std::normal_distribution<float> bell;
+
+    generate_random(execution::seq, (sequential.begin(), sequential.end()), bell, 17);
+    generate_random(execution::par.on(pool), (parallel.begin(), parallel.end()), bell, 17);
+    EXPECT_EQ(sequential, parallel);
+
+    std::vector<int> small(100), small_parallel(100);
+    generate_random((small.begin(), small.end()), std::uniform_int_distribution<int>(0, 9), 2);
+    generate_random(execution::par.on(pool), (small_parallel.begin(), small_parallel.end()),
+                    std::uniform_int_distribution<int>(0, 9), 2);
+    EXPECT_EQ(small, small_parallel);
+}
+
+TEST(IteratorBasedForParallelTest, Histogram)
+{
+    thread_pool pool(3);
+    auto par = execution::par.on(pool);
+
+    for (std::size_t n : {0u, 7u, 1000003u}) {
+        std::vector<std::uint16_t> samples(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            samples[i] = static_cast<std::uint16_t>((i * 7919) % 3000);
+        }
+
+        std::vector<std::size_t> expected(3000);
+        for (std::uint16_t sample : samples) {
+            ++expected[sample];
+        }
+
+        EXPECT_EQ(expected, histogram(par, (samples.cbegin(), samples.cend()), 3000));
+        EXPECT_EQ(expected, histogram(execution::seq, (samples.cbegin(), samples.cend()), 3000));
+
+        auto bucket = [](std::uint16_t x) { return x / 1000; };
+        std::vector<std::size_t> buckets = histogram(par, (samples.cbegin(), samples.cend()), 3, bucket);
+        EXPECT_EQ(n, std::accumulate(buckets.begin(), buckets.end(), std::size_t(0)));
+        const auto first_bucket = std::count_if(samples.begin(), samples.end(), [](std::uint16_t x) { return x < 1000; });
+        EXPECT_EQ(std::size_t(first_bucket), buckets[0]);
+    }
+
+    std::vector<std::uint8_t> bytes(1000000, 9);
+    bytes[777777] = 200;
+    EXPECT_THROW(histogram(par, (bytes.cbegin(), bytes.cend()), 100), std::out_of_range);
+}
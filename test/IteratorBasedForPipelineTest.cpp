@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <IteratorBasedForAdaptors.hpp>
+#include <IteratorBasedForPipeline.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+TEST(IteratorBasedForPipelineTest, KeepsOrder)
+{
+    std::vector<int> v(10000);
+    std::iota(v.begin(), v.end(), 0);
+    std::vector<std::string> out;
+
+    pipeline((v.cbegin(), v.cend()), 64)
+            | stage([](int x) { return 2 * x; })
+            | stage([](int x) { return x + 1; }, execution::par, 4)
+            | stage([](int x) { return std::to_string(x); })
+            | sink([&out](std::string s) { out.push_back(std::move(s)); });
+
+    ASSERT_EQ(v.size(), out.size());
+
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(std::to_string(2 * i + 1), out[i]);
+    }
+
+    //The sink sees the order of the source even directly after a parallel stage.
+    std::list<int> l(v.begin(), v.end());
+    std::vector<long> squares;
+
+    pipeline((l.cbegin(), l.cend()), 7, 2)
+            | stage([](int x) { return static_cast<long>(x) * x; }, execution::par, 3)
+            | sink([&squares](long x) { squares.push_back(x); });
+
+    ASSERT_EQ(v.size(), squares.size());
+    EXPECT_EQ(99980001L, squares.back());
+
+    for (std::size_t i = 1; i < squares.size(); ++i) {
+        EXPECT_LT(squares[i - 1], squares[i]);
+    }
+
+    std::vector<int> empty;
+    int calls = 0;
+    pipeline((empty.cbegin(), empty.cend())) | stage([](int x) { return x; }) | sink([&calls](int) { ++calls; });
+    EXPECT_EQ(0, calls);
+}
+
+TEST(IteratorBasedForPipelineTest, BoundsElementsInFlight)
+{
+    std::vector<int> v(20000, 1);
+    std::atomic<std::size_t> read(0);
+    std::size_t consumed = 0;
+    std::size_t most_in_flight = 0;
+
+    auto counted = transform((v.cbegin(), v.cend()), [&read](int x) {
+        ++read;
+        return x;
+    });
+
+    pipeline(counted, 16, 2)
+            | stage([](int x) { return x; }, execution::par, 3)
+            | sink([&](int) {
+                ++consumed;
+                most_in_flight = std::max(most_in_flight, read.load() - consumed);
+            });
+
+    EXPECT_EQ(v.size(), consumed);
+
+    //The source runs at most a window of 1 + (2 + 3) + 2 batches ahead of the sink, plus the batch it is reading.
+    EXPECT_GE(9u * 16u, most_in_flight);
+}
+
+TEST(IteratorBasedForPipelineTest, RethrowsExceptions)
+{
+    std::vector<int> v(100000);
+    std::iota(v.begin(), v.end(), 0);
+    std::size_t consumed = 0;
+
+    EXPECT_THROW(pipeline((v.cbegin(), v.cend()), 32)
+                         | stage([](int x) {
+                             if (x == 5000) {
+                                 throw std::runtime_error("stage");
+                             }
+
+                             return x;
+                         }, execution::par, 2)
+                         | sink([&consumed](int) { ++consumed; }),
+                 std::runtime_error);
+    EXPECT_GT(5000u, consumed);
+
+    EXPECT_THROW(pipeline((v.cbegin(), v.cend())) | sink([](int x) {
+                     if (x == 10) {
+                         throw std::logic_error("sink");
+                     }
+                 }),
+                 std::logic_error);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <IteratorBasedForProfile.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+namespace
+{
+    const loop_statistics* find_loop(const std::vector<loop_statistics>& _profile, std::uint64_t _trips) {
+        auto it = std::find_if(_profile.begin(), _profile.end(), [_trips](const loop_statistics& _loop) {
+            return _loop.sized_calls != 0 && _loop.trips == _trips;
+        });
+
+        return it == _profile.end() ? nullptr : &*it;
+    }
+}
+
+TEST(IteratorBasedForProfileTest, RecordsProfiledLoops)
+{
+    reset_loop_profile();
+
+    std::vector<int> v(1237, 1);
+    long sum = 0;
+
+    for (int i = 0; i < 3; ++i) {
+        for (int x : profiled((v.cbegin(), v.cend()))) {
+            sum += x;
+        }
+    }
+
+    //Ranges of unknown size count as calls without trips.
+    std::list<int> l(10, 2);
+
+    for (int x : profiled((l.cbegin(), l.cend()))) {
+        sum += x;
+    }
+
+    EXPECT_EQ(3 * 1237 + 20, sum);
+
+    std::vector<loop_statistics> profile = loop_profile();
+    const loop_statistics* loop = find_loop(profile, 3 * 1237);
+    ASSERT_NE(nullptr, loop);
+    EXPECT_EQ(3u, loop->calls);
+    EXPECT_EQ(3u, loop->sized_calls);
+
+    std::uint64_t bucketed = 0;
+
+    for (std::uint64_t count : loop->buckets) {
+        bucketed += count;
+    }
+
+    EXPECT_EQ(3u, bucketed);
+    EXPECT_LE(loop->nanoseconds / 3, loop->percentile(1.0));
+    EXPECT_LE(loop->percentile(0.5), loop->percentile(1.0));
+
+    EXPECT_TRUE(std::any_of(profile.begin(), profile.end(), [](const loop_statistics& _loop) {
+        return _loop.calls == 1 && _loop.sized_calls == 0;
+    }));
+
+    //Copies of a profiled range are plain ranges, so passing one on does not record the loop twice.
+    {
+        auto range = profiled((v.cbegin(), v.cend()));
+        iterator_range<std::vector<int>::const_iterator> copy = range;
+        EXPECT_EQ(v.size(), copy.size());
+    }
+
+    profile = loop_profile();
+    loop = find_loop(profile, v.size());
+    ASSERT_NE(nullptr, loop);
+    EXPECT_EQ(1u, loop->calls);
+
+    std::ostringstream out;
+    write_loop_profile(out);
+    EXPECT_EQ(0u, out.str().find("site\tcalls\tmean_trips"));
+    EXPECT_NE(std::string::npos, out.str().find("\t1237\t"));
+
+    reset_loop_profile();
+    EXPECT_TRUE(loop_profile().empty());
+}
+
+TEST(IteratorBasedForProfileTest, MergesThreads)
+{
+    reset_loop_profile();
+
+    std::vector<int> v(4099, 1);
+    auto loop = [&v]() {
+        long sum = 0;
+
+        for (int i = 0; i < 10; ++i) {
+            for (int x : profiled((v.cbegin(), v.cend()))) {
+                sum += x;
+            }
+        }
+
+        EXPECT_EQ(10 * 4099, sum);
+    };
+
+    std::thread first(loop);
+    std::thread second(loop);
+    first.join();
+    second.join();
+
+    std::vector<loop_statistics> profile = loop_profile();
+    const loop_statistics* merged = find_loop(profile, 20 * 4099);
+    ASSERT_NE(nullptr, merged);
+    EXPECT_EQ(20u, merged->calls);
+    EXPECT_EQ(0u, dropped_loop_samples());
+}
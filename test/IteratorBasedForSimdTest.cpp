@@ -0,0 +1,813 @@
+#include <gtest/gtest.h>
+#include <IteratorBasedForSimd.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+namespace {
+
+    const simd::instruction_set instruction_sets[] = {
+        simd::instruction_set::scalar, simd::instruction_set::sse2, simd::instruction_set::avx2,
+        simd::instruction_set::avx512, simd::instruction_set::neon
+    };
+
+    //Selects an instruction set for the lifetime of the object and restores the previous one afterwards.
+    class scoped_instruction_set {
+    private:
+        simd::instruction_set m_previous;
+
+    public:
+        explicit scoped_instruction_set(simd::instruction_set _set) : m_previous(simd::active_instruction_set()) {
+            simd::select_instruction_set(_set);
+        }
+
+        scoped_instruction_set(const scoped_instruction_set&) = delete;
+        scoped_instruction_set& operator=(const scoped_instruction_set&) = delete;
+
+        ~scoped_instruction_set() { simd::select_instruction_set(m_previous); }
+    };
+
+    template <typename T>
+    std::vector<T> test_values(std::size_t _n) {
+        std::vector<T> v(_n);
+
+        for (std::size_t i = 0; i < _n; ++i) {
+            v[i] = static_cast<T>((i * 37 + 11) % 101);
+        }
+
+        return v;
+    }
+
+    template <typename T>
+    void check_kernels_match_scalar() {
+        for (simd::instruction_set set : instruction_sets) {
+            if (!simd::is_supported(set)) {
+                continue;
+            }
+
+            scoped_instruction_set selected(set);
+            SCOPED_TRACE(simd::name(set));
+
+            for (std::size_t n : {0u, 1u, 3u, 15u, 16u, 17u, 64u, 255u, 1000u}) {
+                //Starting at an offset of one element makes every vector access unaligned.
+                std::vector<T> v = test_values<T>(n + 1);
+                auto range = (v.begin() + 1, v.end());
+                typename simd::sum_type<T>::type expected_sum = 0;
+
+                for (T x : range) {
+                    expected_sum += x;
+                }
+
+                EXPECT_EQ(expected_sum, simd::sum(range));
+
+                if (n != 0) {
+                    auto expected = std::minmax_element(range.begin(), range.end());
+                    EXPECT_EQ(std::make_pair(*expected.first, *expected.second), simd::min_max(range));
+                }
+
+                for (T needle : {T(11), T(100), T(0), T(102)}) {
+                    EXPECT_EQ(std::find(range.begin(), range.end(), needle), simd::find(range, needle));
+                }
+
+                std::vector<T> doubled(n);
+                EXPECT_EQ(doubled.end(), simd::transform(range, doubled.begin(), [](auto& x) { x = x + x; }));
+
+                std::vector<T> incremented(n);
+                simd::transform(range, incremented.begin(), [](T x) { return static_cast<T>(x + 1); });
+
+                for (std::size_t i = 0; i < n; ++i) {
+                    EXPECT_EQ(static_cast<T>(v[i + 1] + v[i + 1]), doubled[i]);
+                    EXPECT_EQ(static_cast<T>(v[i + 1] + 1), incremented[i]);
+                }
+
+                simd::fill(range, T(7));
+                EXPECT_EQ(static_cast<T>(11), v[0]);
+                EXPECT_EQ(std::vector<T>(n, T(7)), std::vector<T>(v.begin() + 1, v.end()));
+                EXPECT_EQ(range.end(), simd::find_not(range, T(7)));
+
+                if (n != 0) {
+                    const std::ptrdiff_t last_third = static_cast<std::ptrdiff_t>(n - 1 - n / 3);
+                    range.begin()[last_third] = T(8);
+                    EXPECT_EQ(range.begin() + last_third, simd::find_not(range, T(7)));
+                    EXPECT_EQ(n == 1 ? range.end() : range.begin(), simd::find_not(range, T(8)));
+                }
+            }
+        }
+    }
+
+}
+
+TEST(IteratorBasedForSimdTest, KernelsMatchScalarFloat)
+{
+    check_kernels_match_scalar<float>();
+}
+
+TEST(IteratorBasedForSimdTest, KernelsMatchScalarDouble)
+{
+    check_kernels_match_scalar<double>();
+}
+
+TEST(IteratorBasedForSimdTest, KernelsMatchScalarInt32)
+{
+    check_kernels_match_scalar<std::int32_t>();
+}
+
+TEST(IteratorBasedForSimdTest, KernelsMatchScalarUint8)
+{
+    check_kernels_match_scalar<std::uint8_t>();
+}
+
+TEST(IteratorBasedForSimdTest, WideSums)
+{
+    std::vector<std::uint8_t> bytes(300000, 255);
+    std::vector<std::int32_t> ints(1000, 2000000000);
+
+    for (simd::instruction_set set : instruction_sets) {
+        if (simd::is_supported(set)) {
+            scoped_instruction_set selected(set);
+
+            EXPECT_EQ(255u * 300000u, simd::sum((bytes.begin(), bytes.end())));
+            EXPECT_EQ(2000000000LL * 1000, simd::sum((ints.cbegin(), ints.cend())));
+        }
+    }
+}
+
+TEST(IteratorBasedForSimdTest, InstructionSetSelection)
+{
+    EXPECT_TRUE(simd::is_supported(simd::instruction_set::scalar));
+    EXPECT_TRUE(simd::is_supported(simd::active_instruction_set()));
+    EXPECT_EQ(simd::best_instruction_set(), simd::active_instruction_set());
+    EXPECT_EQ(std::string("scalar"), simd::name(simd::instruction_set::scalar));
+
+    {
+        scoped_instruction_set selected(simd::instruction_set::scalar);
+        EXPECT_EQ(simd::instruction_set::scalar, simd::active_instruction_set());
+    }
+
+    EXPECT_EQ(simd::best_instruction_set(), simd::active_instruction_set());
+}
+
+TEST(IteratorBasedForSimdTest, CountAndFindAnyMatchScalar)
+{
+    std::vector<std::uint8_t> bytes = test_values<std::uint8_t>(100000);
+    std::vector<float> floats = test_values<float>(1001);
+    const std::uint8_t needles[] = {100, 99, 98, 97, 96, 95, 94, 93, 92, 91, 90, 89, 88, 87, 86, 85, 84, 83};
+
+    for (simd::instruction_set set : instruction_sets) {
+        if (!simd::is_supported(set)) {
+            continue;
+        }
+
+        scoped_instruction_set selected(set);
+        SCOPED_TRACE(simd::name(set));
+
+        EXPECT_EQ(static_cast<std::size_t>(std::count(bytes.begin(), bytes.end(), 11)),
+                  simd::count((bytes.begin(), bytes.end()), 11));
+        EXPECT_EQ(static_cast<std::size_t>(std::count(floats.begin(), floats.end(), 11.0f)),
+                  simd::count((floats.begin(), floats.end()), 11.0f));
+
+        //Every byte lane counts up to 255 matches between two folds.
+        const std::vector<std::uint8_t> same(300 * 64 + 7, 42);
+        EXPECT_EQ(same.size(), simd::count((same.begin(), same.end()), 42));
+        EXPECT_EQ(std::size_t(0), simd::count((same.begin(), same.end()), 41));
+
+        for (std::size_t k = 0; k <= sizeof(needles); ++k) {
+            for (std::size_t n : {0u, 5u, 31u, 100000u}) {
+                auto expected = std::find_first_of(bytes.begin(), bytes.begin() + n, needles, needles + k);
+                EXPECT_EQ(static_cast<std::size_t>(expected - bytes.begin()),
+                          simd::find_any(bytes.data(), n, needles, k));
+            }
+        }
+    }
+}
+
+namespace {
+
+    //Strictly increasing values, each present with probability 1 / _spacing.
+    template <typename T>
+    std::vector<T> sorted_set(std::size_t _n, unsigned _spacing, unsigned _seed) {
+        std::vector<T> v;
+        T value = 0;
+        unsigned state = _seed;
+
+        while (v.size() < _n) {
+            state = state * 1103515245u + 12345u;
+            value = static_cast<T>(value + 1 + (state >> 16) % _spacing);
+            v.push_back(value);
+        }
+
+        return v;
+    }
+
+    template <typename T>
+    void check_set_operations_match_std() {
+        const std::size_t sizes[][2] = {{0, 0}, {0, 10}, {10, 0}, {7, 9}, {100, 130}, {1000, 1000}, {5, 4000},
+                                        {3000, 20}, {257, 255}};
+
+        for (simd::instruction_set set : instruction_sets) {
+            if (!simd::is_supported(set)) {
+                continue;
+            }
+
+            scoped_instruction_set selected(set);
+            SCOPED_TRACE(simd::name(set));
+
+            for (const auto& size : sizes) {
+                //The first set is a sub-range with an unaligned start of a larger array.
+                std::vector<T> a = sorted_set<T>(size[0] + 2, 3, 1);
+                std::vector<T> b = sorted_set<T>(size[1], size[0] < size[1] / 100 ? 300 : 3, 2);
+                auto ra = (a.cbegin() + 1, a.cend() - 1);
+                auto rb = (b.cbegin(), b.cend());
+                std::vector<T> expected;
+                std::vector<T> out(a.size() + b.size());
+
+                std::set_intersection(ra.begin(), ra.end(), rb.begin(), rb.end(), std::back_inserter(expected));
+                out.erase(simd::set_intersection(ra, rb, out.begin()), out.end());
+                EXPECT_EQ(expected, out);
+
+                expected.clear();
+                out.assign(a.size() + b.size(), 0);
+                std::set_union(ra.begin(), ra.end(), rb.begin(), rb.end(), std::back_inserter(expected));
+                out.erase(simd::set_union(ra, rb, out.begin()), out.end());
+                EXPECT_EQ(expected, out);
+
+                expected.clear();
+                out.assign(a.size() + b.size(), 0);
+                std::set_difference(ra.begin(), ra.end(), rb.begin(), rb.end(), std::back_inserter(expected));
+                out.erase(simd::set_difference(ra, rb, out.begin()), out.end());
+                EXPECT_EQ(expected, out);
+
+                expected.clear();
+                out.assign(a.size() + b.size(), 0);
+                std::set_difference(rb.begin(), rb.end(), ra.begin(), ra.end(), std::back_inserter(expected));
+                out.erase(simd::set_difference(rb, ra, out.begin()), out.end());
+                EXPECT_EQ(expected, out);
+            }
+        }
+    }
+
+}
+
+TEST(IteratorBasedForSimdTest, SetOperationsMatchStd)
+{
+    check_set_operations_match_std<std::uint32_t>();
+    check_set_operations_match_std<std::uint64_t>();
+
+    //The intersection writes exactly the common elements, so an output sized for them suffices.
+    std::vector<std::uint32_t> a = sorted_set<std::uint32_t>(1000, 2, 3);
+    std::vector<std::uint32_t> out(a.size());
+    EXPECT_EQ(out.end(), simd::set_intersection((a.cbegin(), a.cend()), (a.cbegin(), a.cend()), out.begin()));
+    EXPECT_EQ(a, out);
+}
+
+TEST(IteratorBasedForSimdTest, FusedExpressions)
+{
+    for (simd::instruction_set set : instruction_sets) {
+        if (!simd::is_supported(set)) {
+            continue;
+        }
+
+        scoped_instruction_set selected(set);
+        SCOPED_TRACE(simd::name(set));
+
+        for (std::size_t n : {0u, 1u, 7u, 16u, 33u, 1000u}) {
+            std::vector<float> a = test_values<float>(n);
+            std::vector<float> b = test_values<float>(n + 3);
+            std::vector<float> out(n);
+            auto r1 = (a.begin(), a.end());
+            auto r2 = (b.begin() + 3, b.end());
+
+            simd::assign((out.begin(), out.end()), r1 * 2.0f + r2);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                EXPECT_EQ(a[i] * 2.0f + b[i + 3], out[i]);
+            }
+
+            simd::assign((out.begin(), out.end()), -(r1 - r2) / 4.0f + 1);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                EXPECT_EQ(-(a[i] - b[i + 3]) / 4.0f + 1.0f, out[i]);
+            }
+
+            //In place, and with integers.
+            const std::vector<float> squared = a;
+            simd::assign(r1, 3 * r1 * r1);
+            std::vector<std::int32_t> counts = test_values<std::int32_t>(n);
+            const std::vector<std::int32_t> original = counts;
+            simd::assign((counts.begin(), counts.end()), (counts.begin(), counts.end()) - 50);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                EXPECT_EQ(3.0f * squared[i] * squared[i], a[i]);
+                EXPECT_EQ(original[i] - 50, counts[i]);
+            }
+        }
+    }
+
+    std::vector<float> shorter(3);
+    std::vector<float> longer(4);
+    auto s = (shorter.begin(), shorter.end());
+    auto l = (longer.begin(), longer.end());
+    EXPECT_THROW(s + l, std::invalid_argument);
+    EXPECT_THROW(simd::assign(s, l * 2.0f), std::invalid_argument);
+}
+
+namespace {
+
+    template <typename T, typename Index>
+    void check_gather_scatter_match_scalar() {
+        for (simd::instruction_set set : instruction_sets) {
+            if (!simd::is_supported(set)) {
+                continue;
+            }
+
+            scoped_instruction_set selected(set);
+            SCOPED_TRACE(simd::name(set));
+
+            //The largest size exceeds gather_prefetch_bytes, so it takes the prefetching loops.
+            for (std::size_t n : {0u, 1u, 7u, 16u, 33u, 1000u, 300000u}) {
+                std::vector<T> values = test_values<T>(n + 5);
+                std::vector<Index> indices(n);
+
+                for (std::size_t i = 0; i < n; ++i) {
+                    indices[i] = static_cast<Index>((i * 7919 + 3) % (n + 5));
+                }
+
+                std::vector<T> gathered(n);
+                EXPECT_EQ(gathered.end(), simd::gather((values.begin(), values.end()), (indices.begin(), indices.end()),
+                                                       gathered.begin()));
+
+                for (std::size_t i = 0; i < n; ++i) {
+                    ASSERT_EQ(values[indices[i]], gathered[i]);
+                }
+
+                //Scattering to a smaller array repeats indices; the last value written to each element wins.
+                const std::size_t size = n / 3 + 1;
+                std::vector<T> expected(size, T(1));
+                std::vector<T> scattered(size, T(1));
+
+                for (std::size_t i = 0; i < n; ++i) {
+                    indices[i] = static_cast<Index>(indices[i] % size);
+                    expected[indices[i]] = static_cast<T>(i);
+                }
+
+                std::vector<T> sources(n);
+
+                for (std::size_t i = 0; i < n; ++i) {
+                    sources[i] = static_cast<T>(i);
+                }
+
+                simd::scatter((sources.begin(), sources.end()), (indices.begin(), indices.end()),
+                              (scattered.begin(), scattered.end()));
+                EXPECT_EQ(expected, scattered);
+            }
+        }
+    }
+
+}
+
+TEST(IteratorBasedForSimdTest, GatherAndScatterMatchScalar)
+{
+    check_gather_scatter_match_scalar<float, std::int32_t>();
+    check_gather_scatter_match_scalar<double, std::uint32_t>();
+    check_gather_scatter_match_scalar<std::int32_t, std::uint32_t>();
+
+    std::vector<float> values(4);
+    std::vector<std::int32_t> indices(3);
+    std::vector<float> out(4);
+    auto destination = (out.begin(), out.end());
+    EXPECT_THROW(simd::scatter((values.begin(), values.end()), (indices.begin(), indices.end()), destination),
+                 std::invalid_argument);
+}
+
+namespace {
+
+    template <typename T>
+    void check_deinterleave_matches_scalar() {
+        for (simd::instruction_set set : instruction_sets) {
+            if (!simd::is_supported(set)) {
+                continue;
+            }
+
+            scoped_instruction_set selected(set);
+            SCOPED_TRACE(simd::name(set));
+
+            for (std::size_t stride : {0u, 1u, 2u, 3u, 4u, 5u, 8u}) {
+                for (std::size_t n : {0u, 1u, 15u, 64u, 65u, 200u, 1001u}) {
+                    //The input ends at the last element taken, so that any read past it is caught by sanitizers.
+                    const std::size_t step = stride ? stride : 1;
+                    std::vector<T> in = test_values<T>(n ? (n - 1) * step + 1 : 0);
+                    std::vector<T> out(n + 1, T(7));
+                    EXPECT_EQ(out.begin() + static_cast<std::ptrdiff_t>(n),
+                              simd::deinterleave((in.cbegin(), in.cend()), stride, out.begin()));
+
+                    for (std::size_t i = 0; i < n; ++i) {
+                        ASSERT_EQ(in[i * step], out[i]);
+                    }
+
+                    EXPECT_EQ(T(7), out[n]);
+                }
+            }
+        }
+    }
+
+}
+
+TEST(IteratorBasedForSimdTest, DeinterleaveMatchesScalar)
+{
+    check_deinterleave_matches_scalar<float>();
+    check_deinterleave_matches_scalar<double>();
+    check_deinterleave_matches_scalar<std::int32_t>();
+    check_deinterleave_matches_scalar<std::uint8_t>();
+}
+
+namespace {
+
+    template <typename T>
+    void check_transpose_matches_scalar() {
+        for (simd::instruction_set set : instruction_sets) {
+            if (!simd::is_supported(set)) {
+                continue;
+            }
+
+            scoped_instruction_set selected(set);
+            SCOPED_TRACE(simd::name(set));
+
+            for (std::size_t rows : {1u, 3u, 16u, 17u, 100u, 300u}) {
+                for (std::size_t columns : {1u, 8u, 33u, 64u, 257u}) {
+                    std::vector<T> in = test_values<T>(rows * columns);
+                    std::vector<T> out(rows * columns + 1, T(7));
+                    EXPECT_EQ(out.begin() + static_cast<std::ptrdiff_t>(rows * columns),
+                              simd::transpose((in.cbegin(), in.cend()), rows, columns, out.begin()));
+
+                    for (std::size_t r = 0; r < rows; ++r) {
+                        for (std::size_t c = 0; c < columns; ++c) {
+                            ASSERT_EQ(in[r * columns + c], out[c * rows + r]);
+                        }
+                    }
+
+                    EXPECT_EQ(T(7), out.back());
+                }
+            }
+        }
+    }
+
+}
+
+TEST(IteratorBasedForSimdTest, TransposeMatchesScalar)
+{
+    check_transpose_matches_scalar<float>();
+    check_transpose_matches_scalar<double>();
+    check_transpose_matches_scalar<std::int32_t>();
+    check_transpose_matches_scalar<std::uint8_t>();
+
+    std::vector<float> in(12);
+    std::vector<float> out(12);
+    EXPECT_THROW(simd::transpose((in.begin(), in.end()), 5, 2, out.begin()), std::invalid_argument);
+    EXPECT_THROW(simd::transpose((in.begin(), in.end()), 3, 0, out.begin()), std::invalid_argument);
+    EXPECT_EQ(out.begin(), simd::transpose((in.begin(), in.begin()), 0, 4, out.begin()));
+}
+
+namespace {
+
+    template <typename T>
+    void check_compress_matches_scalar() {
+        for (simd::instruction_set set : instruction_sets) {
+            if (!simd::is_supported(set)) {
+                continue;
+            }
+
+            scoped_instruction_set selected(set);
+            SCOPED_TRACE(simd::name(set));
+
+            for (std::size_t n : {0u, 1u, 7u, 16u, 33u, 1000u}) {
+                const std::vector<T> in = test_values<T>(n);
+
+                for (unsigned period : {1u, 2u, 3u, 7u}) {
+                    std::vector<std::uint8_t> keep(n);
+                    std::vector<T> expected;
+
+                    for (std::size_t i = 0; i < n; ++i) {
+                        keep[i] = (i * 5 + i / 3) % period == 0 ? 1 : 0;
+
+                        if (keep[i]) {
+                            expected.push_back(in[i]);
+                        }
+                    }
+
+                    //Only the kept elements are stored.
+                    std::vector<T> out(expected.size() + 1, T(7));
+                    EXPECT_EQ(out.begin() + static_cast<std::ptrdiff_t>(expected.size()),
+                              simd::compress((in.cbegin(), in.cend()), keep.data(), out.begin()));
+                    EXPECT_EQ(expected, std::vector<T>(out.begin(), out.end() - 1));
+                    EXPECT_EQ(T(7), out.back());
+
+                    std::vector<T> in_place(in);
+                    auto end = simd::compress((in_place.cbegin(), in_place.cend()), keep.data(), in_place.begin());
+                    EXPECT_EQ(expected, std::vector<T>(in_place.begin(), end));
+                }
+            }
+        }
+    }
+
+}
+
+TEST(IteratorBasedForSimdTest, CompressMatchesScalar)
+{
+    check_compress_matches_scalar<float>();
+    check_compress_matches_scalar<double>();
+    check_compress_matches_scalar<std::int32_t>();
+    check_compress_matches_scalar<std::uint8_t>();
+}
+
+namespace {
+
+    template <typename T>
+    void check_select_beyond_matches_scalar() {
+        for (simd::instruction_set set : instruction_sets) {
+            if (!simd::is_supported(set)) {
+                continue;
+            }
+
+            scoped_instruction_set selected(set);
+            SCOPED_TRACE(simd::name(set));
+
+            for (std::size_t n : {0u, 1u, 7u, 16u, 33u, 1000u}) {
+                const std::vector<T> in = test_values<T>(n);
+
+                for (bool greater : {true, false}) {
+                    const T bound = greater ? T(90) : T(10);
+                    std::vector<T> expected;
+
+                    for (T x : in) {
+                        if (greater ? x > bound : x < bound) {
+                            expected.push_back(x);
+                        }
+                    }
+
+                    //Selecting into an output with room for few elements takes several calls.
+                    for (std::size_t room : {std::size_t(64), std::size_t(1000)}) {
+                        std::vector<T> out(room);
+                        std::vector<T> all;
+
+                        for (std::size_t i = 0; i < n;) {
+                            std::size_t written = 0;
+                            i += simd::select_beyond((in.cbegin() + static_cast<std::ptrdiff_t>(i), in.cend()), bound,
+                                                     greater, out.data(), room, written);
+                            ASSERT_LE(written, room);
+                            all.insert(all.end(), out.begin(), out.begin() + static_cast<std::ptrdiff_t>(written));
+                        }
+
+                        EXPECT_EQ(expected, all);
+                    }
+                }
+            }
+        }
+    }
+
+}
+
+TEST(IteratorBasedForSimdTest, SelectBeyondMatchesScalar)
+{
+    check_select_beyond_matches_scalar<float>();
+    check_select_beyond_matches_scalar<double>();
+    check_select_beyond_matches_scalar<std::int32_t>();
+    check_select_beyond_matches_scalar<std::uint8_t>();
+}
+
+TEST(IteratorBasedForSimdTest, Utf8MatchesScalar)
+{
+    //ASCII runs, two-, three- and four-byte sequences, so that every kind of vector is met at every alignment.
+    const std::string pieces[] = {
+        "abcdefghijklmnopqrstuvwxyz0123456789", "\xC3\xA9", "\xE6\x97\xA5", "\xF0\x9F\x98\x80"
+    };
+    std::string text;
+    for (std::size_t i = 0; text.size() < 1200; ++i) {
+        text += i % 5 == 0 ? pieces[0].substr(0, i % 37) : pieces[(i * 7) % 4];
+    }
+
+    for (std::size_t n : {0u, 1u, 15u, 31u, 32u, 33u, 100u, 1000u, 1200u}) {
+        for (std::size_t corrupt : {std::size_t(0), n / 2, n / 3 + 1}) {
+            std::vector<std::uint8_t> bytes(text.begin(), text.begin() + static_cast<std::ptrdiff_t>(n));
+            if (corrupt < n && n / 2 != n / 3 + 1) {
+                bytes[corrupt] = corrupt == n / 2 ? 0x80 : 0xF8;
+            }
+
+            std::u16string expected(n, u'\0');
+            const bool valid = simd::scalar_kernels::validate_utf8(bytes.data(), n);
+            const std::size_t units = simd::scalar_kernels::utf8_to_utf16(bytes.data(), n, &expected[0]);
+            EXPECT_EQ(valid, units != simd::utf8_invalid);
+
+            for (simd::instruction_set set : instruction_sets) {
+                if (!simd::is_supported(set)) {
+                    continue;
+                }
+
+                scoped_instruction_set selected(set);
+                SCOPED_TRACE(simd::name(set));
+
+                std::u16string out(n, u'\0');
+                EXPECT_EQ(valid, simd::validate_utf8(bytes.data(), n));
+                EXPECT_EQ(units, simd::utf8_to_utf16(bytes.data(), n, &out[0]));
+                if (valid) {
+                    EXPECT_TRUE(expected.substr(0, units) == out.substr(0, units));
+                }
+            }
+        }
+    }
+
+    //An empty vector has no storage, so its data() may be a null pointer.
+    const std::vector<std::uint8_t> empty;
+    for (simd::instruction_set set : instruction_sets) {
+        if (!simd::is_supported(set)) {
+            continue;
+        }
+
+        scoped_instruction_set selected(set);
+        SCOPED_TRACE(simd::name(set));
+
+        char16_t unit = u'x';
+        EXPECT_TRUE(simd::validate_utf8(empty.data(), empty.size()));
+        EXPECT_EQ(std::size_t(0), simd::utf8_to_utf16(empty.data(), empty.size(), &unit));
+    }
+}
+
+TEST(IteratorBasedForSimdTest, ByteswapMatchesScalar)
+{
+    std::vector<std::uint8_t> in(8 * 100 + 3);
+    for (std::size_t i = 0; i < in.size(); ++i) {
+        in[i] = static_cast<std::uint8_t>(i * 13 + 1);
+    }
+
+    for (std::size_t width : {1u, 2u, 4u, 8u}) {
+        for (std::size_t n : {0u, 1u, 7u, 31u, 64u, 100u}) {
+            //Starting at an offset of one byte makes every vector access unaligned.
+            std::vector<std::uint8_t> expected(n * width);
+            for (std::size_t i = 0; i < expected.size(); ++i) {
+                expected[i] = in[1 + i - i % width + width - 1 - i % width];
+            }
+
+            for (simd::instruction_set set : instruction_sets) {
+                if (!simd::is_supported(set)) {
+                    continue;
+                }
+
+                scoped_instruction_set selected(set);
+                SCOPED_TRACE(simd::name(set));
+
+                std::vector<std::uint8_t> out(n * width + 1, 0xEE);
+                simd::byteswap(in.data() + 1, width, n, out.data());
+                EXPECT_EQ(expected, std::vector<std::uint8_t>(out.begin(), out.end() - 1));
+                EXPECT_EQ(0xEE, out.back());
+
+                std::vector<std::uint8_t> in_place(in.begin() + 1, in.begin() + 1 + std::ptrdiff_t(n * width));
+                simd::byteswap(in_place.data(), width, n, in_place.data());
+                EXPECT_EQ(expected, in_place);
+            }
+        }
+    }
+}
+
+TEST(IteratorBasedForSimdTest, Hash64MatchesScalar)
+{
+    std::vector<std::uint64_t> keys(203);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = i * UINT64_C(0x9E3779B97F4A7C15) ^ (i << 40);
+    }
+
+    //The finalizer of MurmurHash3 maps 0 to 0 and 1 to this value.
+    EXPECT_EQ(0u, simd::scalar_kernels::mix64(0));
+    EXPECT_EQ(UINT64_C(0xB456BCFC34C2CB2C), simd::scalar_kernels::mix64(1));
+
+    for (std::size_t n : {0u, 1u, 7u, 64u, 203u}) {
+        std::vector<std::uint64_t> expected(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            expected[i] = simd::scalar_kernels::mix64(keys[i]);
+        }
+
+        for (simd::instruction_set set : instruction_sets) {
+            if (!simd::is_supported(set)) {
+                continue;
+            }
+
+            scoped_instruction_set selected(set);
+            SCOPED_TRACE(simd::name(set));
+
+            std::vector<std::uint64_t> out(n);
+            simd::hash64(keys.data(), n, out.data());
+            EXPECT_EQ(expected, out);
+        }
+    }
+}
+
+namespace {
+
+    template <typename T>
+    void check_prefix_sum_matches_scalar() {
+        //Negative values for the signed types, and values near the top of the range that make the sums wrap for the
+        //unsigned ones.
+        std::vector<T> in = test_values<T>(1001);
+        for (std::size_t i = 0; i < in.size(); i += 3) {
+            in[i] = std::is_signed<T>::value ? static_cast<T>(-static_cast<long long>(i))
+                                             : static_cast<T>(std::numeric_limits<T>::max() / 7 - i);
+        }
+
+        for (std::size_t n : {0u, 1u, 3u, 15u, 16u, 17u, 64u, 255u, 1000u}) {
+            for (bool inclusive : {true, false}) {
+                const T carry = static_cast<T>(n % 5);
+                std::vector<T> expected(n);
+                const T expected_total = simd::scalar_kernels::prefix_sum(in.data() + 1, n, carry, inclusive,
+                                                                          expected.data());
+
+                for (simd::instruction_set set : instruction_sets) {
+                    if (!simd::is_supported(set)) {
+                        continue;
+                    }
+
+                    scoped_instruction_set selected(set);
+                    SCOPED_TRACE(simd::name(set));
+
+                    //Starting at an offset of one element makes every vector access unaligned.
+                    std::vector<T> out(n + 1);
+                    EXPECT_EQ(expected_total, simd::prefix_sum(in.data() + 1, n, carry, inclusive, out.data() + 1));
+                    EXPECT_EQ(expected, std::vector<T>(out.begin() + 1, out.end()));
+
+                    std::vector<T> in_place(in.begin() + 1, in.begin() + 1 + static_cast<std::ptrdiff_t>(n));
+                    EXPECT_EQ(expected_total, simd::prefix_sum(in_place.data(), n, carry, inclusive,
+                                                               in_place.data()));
+                    EXPECT_EQ(expected, in_place);
+                }
+            }
+        }
+    }
+}
+
+TEST(IteratorBasedForSimdTest, PrefixSumMatchesScalar)
+{
+    std::vector<std::int32_t> v = {1, 2, 3, 4, 5};
+    std::vector<std::int32_t> out(5);
+    EXPECT_EQ(25, simd::scalar_kernels::prefix_sum(v.data(), 5, 10, true, out.data()));
+    EXPECT_EQ((std::vector<std::int32_t>{11, 13, 16, 20, 25}), out);
+    EXPECT_EQ(25, simd::scalar_kernels::prefix_sum(v.data(), 5, 10, false, out.data()));
+    EXPECT_EQ((std::vector<std::int32_t>{10, 11, 13, 16, 20}), out);
+
+    check_prefix_sum_matches_scalar<std::int32_t>();
+    check_prefix_sum_matches_scalar<std::uint32_t>();
+    check_prefix_sum_matches_scalar<std::int64_t>();
+    check_prefix_sum_matches_scalar<std::uint64_t>();
+}
+
+TEST(IteratorBasedForSimdTest, Philox4x32MatchesKnownAnswers)
+{
+    //The known-answer vectors of Random123 for Philox4x32-10.
+    const std::uint32_t counters[3][4] = {{0, 0, 0, 0}, {~0u, ~0u, ~0u, ~0u},
+                                          {0x243F6A88u, 0x85A308D3u, 0x13198A2Eu, 0x03707344u}};
+    const std::uint32_t keys[3][2] = {{0, 0}, {~0u, ~0u}, {0xA4093822u, 0x299F31D0u}};
+    const std::array<std::uint32_t, 4> expected[3] = {{{0x6627E8D5u, 0xE169C58Du, 0xBC57AC4Cu, 0x9B00DBD8u}},
+                                                       {{0x408F276Du, 0x41C83B0Eu, 0xA20BC7C6u, 0x6D5451FDu}},
+                                                       {{0xD16CFE09u, 0x94FDCCEBu, 0x5001E420u, 0x24126EA1u}}};
+
+    for (int i = 0; i < 3; ++i) {
+        std::array<std::uint32_t, 4> out;
+        simd::scalar_kernels::philox4x32(counters[i], keys[i], out.data());
+        EXPECT_EQ(expected[i], out);
+    }
+
+    //The counters of the bulk kernel carry from the block into the stream words.
+    std::array<std::uint32_t, 4> out;
+    simd::scalar_kernels::philox4x32(~UINT64_C(0), ~UINT64_C(0), ~UINT64_C(0), 1, out.data());
+    EXPECT_EQ(expected[1], out);
+}
+
+TEST(IteratorBasedForSimdTest, Philox4x32MatchesScalar)
+{
+    //Blocks cross a carry of the low counter word, and the counts cover partial vectors on every width.
+    const std::uint64_t key = UINT64_C(0x0123456789ABCDEF), stream = 42, block = (UINT64_C(1) << 32) - 9;
+
+    for (std::size_t n : {0u, 1u, 3u, 8u, 17u, 100u}) {
+        std::vector<std::uint32_t> expected(4 * n);
+        simd::scalar_kernels::philox4x32(key, stream, block, n, expected.data());
+
+        for (simd::instruction_set set : instruction_sets) {
+            if (!simd::is_supported(set)) {
+                continue;
+            }
+
+            scoped_instruction_set selected(set);
+            SCOPED_TRACE(simd::name(set));
+
+            std::vector<std::uint32_t> out(4 * n);
+            simd::philox4x32(key, stream, block, n, out.data());
+            EXPECT_EQ(expected, out);
+        }
+    }
+}
@@ -2,6 +2,19 @@
 #include <IteratorBasedFor.hpp>
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <map>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 using namespace IteratorBasedForImpl;
@@ -84,7 +97,7 @@ TEST(IteratorBasedForTest, IsIterator)
     EXPECT_FALSE(is_iterator<std::vector<int>::iterator*>::value);
 }
 
-/*TEST(IteratorBasedForTest, CommaIteratorTypes)
+TEST(IteratorBasedForTest, CommaIteratorTypes)
 {
     std::string s("Test");
     std::vector<int> v({1, 2, 3, 4});
@@ -105,7 +118,7 @@ TEST(IteratorBasedForTest, CommaNonIteratorTypes)
 
 TEST(IteratorBasedForTest, ForVectorIterator)
 {
-    std::vector<int> v;
+    std::vector<int> v(10);
     std::iota(v.begin(), v.end(), 0);
 
     int n = 0;
@@ -115,5 +128,735 @@ TEST(IteratorBasedForTest, ForVectorIterator)
         n++;
     }
 
-    EXPECT_EQ(n, v.size());
-}*/
+    EXPECT_EQ(static_cast<std::size_t>(n), v.size());
+}
+
+namespace
+{
+    struct custom_swap_iterator {
+        int* p;
+
+        int& operator*() const { return *p; }
+        custom_swap_iterator& operator++() { ++p; return *this; }
+    };
+
+    void swap(custom_swap_iterator&, custom_swap_iterator&) { }
+
+    struct non_copyable_iterator {
+        int* p;
+
+        non_copyable_iterator(const non_copyable_iterator&) = delete;
+
+        int& operator*() const { return *p; }
+        non_copyable_iterator& operator++() { ++p; return *this; }
+    };
+
+    //Declares the traits of a forward iterator without being copyable or movable, as no real iterator does.
+    struct immovable_forward_iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = int*;
+        using reference = int&;
+
+        int* p;
+
+        immovable_forward_iterator(const immovable_forward_iterator&) = delete;
+        immovable_forward_iterator(immovable_forward_iterator&&) = delete;
+
+        int& operator*() const { return *p; }
+        immovable_forward_iterator& operator++() { ++p; return *this; }
+    };
+
+    //Copyable, but its assignments are deleted.
+    struct unassignable_forward_iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = int*;
+        using reference = int&;
+
+        int* p;
+
+        unassignable_forward_iterator(const unassignable_forward_iterator&) = default;
+        unassignable_forward_iterator& operator=(const unassignable_forward_iterator&) = delete;
+
+        int& operator*() const { return *p; }
+        unassignable_forward_iterator& operator++() { ++p; return *this; }
+    };
+
+    template <typename T>
+    void expect_fast_path_agrees() {
+        EXPECT_EQ(satisfies_iterator_requirements<T>::value, is_iterator<T>::value);
+#if ITERATOR_BASED_FOR_HAS_CONCEPTS
+        EXPECT_EQ(satisfies_iterator_requirements<T>::value, comma_iterator<T>);
+#endif
+    }
+}
+
+TEST(IteratorBasedForTest, IsIteratorAgreesWithFullRequirements)
+{
+    expect_fast_path_agrees<std::vector<int>::iterator>();
+    expect_fast_path_agrees<std::vector<int>::const_reverse_iterator>();
+    expect_fast_path_agrees<std::vector<bool>::iterator>();
+    expect_fast_path_agrees<std::string::iterator>();
+    expect_fast_path_agrees<std::deque<int>::iterator>();
+    expect_fast_path_agrees<std::list<int>::const_iterator>();
+    expect_fast_path_agrees<std::map<int, int>::iterator>();
+    expect_fast_path_agrees<std::set<int>::iterator>();
+    expect_fast_path_agrees<std::unordered_map<int, int>::iterator>();
+    expect_fast_path_agrees<std::move_iterator<std::vector<int>::iterator>>();
+    expect_fast_path_agrees<std::istreambuf_iterator<char>>();
+    expect_fast_path_agrees<std::ostream_iterator<int>>();
+    expect_fast_path_agrees<std::back_insert_iterator<std::vector<int>>>();
+    expect_fast_path_agrees<custom_swap_iterator>();
+    expect_fast_path_agrees<non_copyable_iterator>();
+    expect_fast_path_agrees<immovable_forward_iterator>();
+    expect_fast_path_agrees<unassignable_forward_iterator>();
+    EXPECT_FALSE(is_iterator<immovable_forward_iterator>::value);
+
+    expect_fast_path_agrees<int>();
+    expect_fast_path_agrees<int*>();
+    expect_fast_path_agrees<const char*>();
+    expect_fast_path_agrees<std::vector<int>::iterator&>();
+    expect_fast_path_agrees<std::string>();
+    expect_fast_path_agrees<A>();
+}
+
+namespace
+{
+    /**
+     * @brief Iterator over an int array that counts how many times it has been copied.
+     */
+    struct copy_counting_iterator {
+        static int copies;
+
+        int* p;
+
+        explicit copy_counting_iterator(int* _p) : p(_p) { }
+        copy_counting_iterator(const copy_counting_iterator& other) : p(other.p) { ++copies; }
+        copy_counting_iterator(copy_counting_iterator&&) = default;
+        copy_counting_iterator& operator=(const copy_counting_iterator& other) { p = other.p; ++copies; return *this; }
+        copy_counting_iterator& operator=(copy_counting_iterator&&) = default;
+
+        int& operator*() const { return *p; }
+        copy_counting_iterator& operator++() { ++p; return *this; }
+        bool operator!=(const copy_counting_iterator& rhs) const { return p != rhs.p; }
+        bool operator==(const copy_counting_iterator& rhs) const { return p == rhs.p; }
+    };
+
+    int copy_counting_iterator::copies = 0;
+
+    struct move_only_iterator {
+        int* p;
+
+        explicit move_only_iterator(int* _p) : p(_p) { }
+        move_only_iterator(const move_only_iterator&) = delete;
+        move_only_iterator(move_only_iterator&&) = default;
+        move_only_iterator& operator=(const move_only_iterator&) = delete;
+        move_only_iterator& operator=(move_only_iterator&&) = default;
+
+        int& operator*() const { return *p; }
+        move_only_iterator& operator++() { ++p; return *this; }
+        bool operator!=(const move_only_iterator& rhs) const { return p != rhs.p; }
+    };
+}
+
+TEST(IteratorBasedForTest, RangeMovesRvalueIterators)
+{
+    int a[] = {1, 2, 3};
+
+    copy_counting_iterator::copies = 0;
+    auto range = (copy_counting_iterator(a), copy_counting_iterator(a + 3));
+    EXPECT_EQ(0, copy_counting_iterator::copies);
+
+    copy_counting_iterator b(a);
+    copy_counting_iterator e(a + 3);
+    auto copied = (b, e);
+    EXPECT_EQ(2, copy_counting_iterator::copies);
+    EXPECT_EQ(range, copied);
+}
+
+TEST(IteratorBasedForTest, MoveOnlyIterator)
+{
+    int a[] = {1, 2, 3};
+
+    EXPECT_TRUE(is_iterator<move_only_iterator>::value);
+
+    int sum = 0;
+
+    for (int x : move_only_iterator(a), move_only_iterator(a + 3)) {
+        sum += x;
+    }
+
+    EXPECT_EQ(6, sum);
+}
+
+TEST(IteratorBasedForTest, IsSentinelFor)
+{
+    EXPECT_TRUE((is_sentinel_for<std::vector<int>::iterator, std::vector<int>::iterator>::value));
+    EXPECT_TRUE((is_sentinel_for<std::vector<int>::const_iterator, std::vector<int>::iterator>::value));
+    EXPECT_TRUE((is_sentinel_for<null_sentinel, std::vector<char>::iterator>::value));
+
+    EXPECT_FALSE((is_sentinel_for<int, std::vector<int>::iterator>::value));
+    EXPECT_FALSE((is_sentinel_for<std::list<int>::iterator, std::vector<int>::iterator>::value));
+    EXPECT_FALSE((is_sentinel_for<std::vector<int>::iterator&, std::vector<int>::iterator>::value));
+}
+
+TEST(IteratorBasedForTest, CommaIteratorSentinel)
+{
+    std::vector<char> v({'a', 'b', 'c', '\0', 'd'});
+    const std::vector<int> c({1, 2, 3});
+
+    auto range = (v.begin(), null_sentinel());
+    EXPECT_EQ(range, make_iterator_range(v.begin(), null_sentinel()));
+
+    std::string s;
+
+    for (auto it = range.begin(); it != range.end(); ++it) {
+        s += *it;
+    }
+
+    EXPECT_EQ("abc", s);
+
+    auto b = c.begin();
+    const auto e = c.end();
+    EXPECT_EQ((b, e), make_iterator_range(c.begin(), c.end()));
+
+    std::vector<int> m({1, 2, 3});
+    EXPECT_EQ((m.begin(), m.cend()), make_iterator_range(m.begin(), m.cend()));
+}
+
+#if defined(__cpp_range_based_for) && __cpp_range_based_for >= 201603L
+TEST(IteratorBasedForTest, ForIteratorSentinel)
+{
+    std::vector<char> v({'a', 'b', 'c', '\0', 'd'});
+    std::string s;
+
+    for (char x : v.begin(), null_sentinel()) {
+        s += x;
+    }
+
+    EXPECT_EQ("abc", s);
+}
+#endif
+
+namespace
+{
+    template <typename Range>
+    struct has_size_impl {
+        template <typename R>
+        static constexpr auto check(int) -> decltype(std::declval<const R&>().size(), std::true_type());
+
+        template <typename>
+        static constexpr std::false_type check(...);
+
+        using type = decltype(check<Range>(0));
+    };
+
+    template <typename Range>
+    struct has_size : has_size_impl<Range>::type { };
+
+    template <typename Range>
+    struct has_data_impl {
+        template <typename R>
+        static constexpr auto check(int) -> decltype(std::declval<const R&>().data(), std::true_type());
+
+        template <typename>
+        static constexpr std::false_type check(...);
+
+        using type = decltype(check<Range>(0));
+    };
+
+    template <typename Range>
+    struct has_data : has_data_impl<Range>::type { };
+}
+
+TEST(IteratorBasedForTest, IsContiguousIterator)
+{
+    EXPECT_TRUE(is_contiguous_iterator<int*>::value);
+    EXPECT_TRUE(is_contiguous_iterator<const int*>::value);
+    EXPECT_TRUE(is_contiguous_iterator<std::vector<int>::iterator>::value);
+    EXPECT_TRUE(is_contiguous_iterator<std::vector<int>::const_iterator>::value);
+    EXPECT_TRUE(is_contiguous_iterator<std::string::iterator>::value);
+
+    EXPECT_FALSE(is_contiguous_iterator<std::vector<bool>::iterator>::value);
+    EXPECT_FALSE(is_contiguous_iterator<std::vector<int>::reverse_iterator>::value);
+    EXPECT_FALSE(is_contiguous_iterator<std::deque<int>::iterator>::value);
+    EXPECT_FALSE(is_contiguous_iterator<std::list<int>::iterator>::value);
+}
+
+TEST(IteratorBasedForTest, RandomAccessRangeAccessors)
+{
+    std::vector<int> v({1, 2, 3, 4, 5});
+    auto range = (v.begin() + 1, v.end() - 1);
+
+    EXPECT_FALSE(range.empty());
+    EXPECT_EQ(3u, range.size());
+    EXPECT_EQ(2, range[0]);
+    EXPECT_EQ(4, range[2]);
+    EXPECT_EQ(2, range.front());
+    EXPECT_EQ(4, range.back());
+    EXPECT_EQ(&v[1], range.data());
+
+    range[1] = 10;
+    EXPECT_EQ(10, v[2]);
+
+    auto empty = (v.end(), v.end());
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(0u, empty.size());
+    EXPECT_EQ(v.data() + v.size(), empty.data());
+}
+
+TEST(IteratorBasedForTest, RangeAccessorsRequireConstantTime)
+{
+    std::list<int> l({1, 2, 3});
+    std::deque<int> d({1, 2, 3});
+    auto list_range = (l.begin(), l.end());
+
+    EXPECT_FALSE(list_range.empty());
+    EXPECT_EQ(1, list_range.front());
+    EXPECT_EQ(3, list_range.back());
+
+    EXPECT_FALSE(has_size<decltype(list_range)>::value);
+    EXPECT_FALSE(has_data<decltype(list_range)>::value);
+    EXPECT_TRUE(has_size<decltype((d.begin(), d.end()))>::value);
+    EXPECT_FALSE(has_data<decltype((d.begin(), d.end()))>::value);
+    EXPECT_TRUE(has_data<iterator_range<const int*>>::value);
+
+    std::vector<char> v({'a', '\0'});
+    EXPECT_FALSE(has_size<decltype((v.begin(), null_sentinel()))>::value);
+    EXPECT_FALSE((v.begin(), null_sentinel()).empty());
+}
+
+TEST(IteratorBasedForTest, RandomAccessSlicing)
+{
+    std::vector<int> v({0, 1, 2, 3, 4, 5, 6, 7});
+    auto range = (v.begin() + 1, v.end() - 1);
+
+    EXPECT_EQ(make_iterator_range(v.begin() + 1, v.begin() + 4), range.take(3));
+    EXPECT_EQ(range, range.take(100));
+    EXPECT_EQ(make_iterator_range(v.begin() + 3, v.end() - 1), range.drop(2));
+    EXPECT_TRUE(range.drop(100).empty());
+    EXPECT_EQ(make_iterator_range(v.begin() + 2, v.begin() + 5), range.slice(1, 4));
+    EXPECT_EQ(make_iterator_range(v.begin() + 5, v.end() - 1), range.slice(4, 100));
+    EXPECT_TRUE(range.slice(4, 2).empty());
+
+    auto halves = range.split_at(2);
+    EXPECT_EQ(range.take(2), halves.first);
+    EXPECT_EQ(range.drop(2), halves.second);
+}
+
+TEST(IteratorBasedForTest, ForwardSlicing)
+{
+    std::list<int> l({0, 1, 2, 3, 4});
+    auto range = (l.begin(), l.end());
+
+    EXPECT_EQ(std::vector<int>({0, 1}), std::vector<int>(range.take(2).begin(), range.take(2).end()));
+    EXPECT_EQ(std::vector<int>({3, 4}), std::vector<int>(range.drop(3).begin(), range.drop(3).end()));
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), std::vector<int>(range.slice(1, 4).begin(), range.slice(1, 4).end()));
+    EXPECT_EQ(range.drop(5), range.drop(10));
+
+    std::vector<char> s({'a', 'b', 'c', '\0'});
+    auto terminated = (s.begin(), null_sentinel());
+    auto halves = terminated.split_at(1);
+
+    EXPECT_EQ(make_iterator_range(s.begin(), s.begin() + 1), halves.first);
+    EXPECT_EQ(make_iterator_range(s.begin() + 1, null_sentinel()), halves.second);
+    EXPECT_EQ(make_iterator_range(s.begin(), s.begin() + 3), terminated.take(10));
+}
+
+TEST(IteratorBasedForTest, BlockedRangeSplitting)
+{
+    std::vector<int> v(10);
+    blocked_iterator_range<std::vector<int>::iterator> range = make_blocked_range((v.begin(), v.end()), 3);
+
+    EXPECT_TRUE(is_splittable_range<decltype(range)>::value);
+    EXPECT_FALSE(is_splittable_range<iterator_range<std::vector<int>::iterator>>::value);
+    EXPECT_EQ(3u, range.grainsize());
+    EXPECT_TRUE(range.is_divisible());
+
+    decltype(range) upper(range, split());
+
+    EXPECT_EQ(make_iterator_range(v.begin(), v.begin() + 5), range);
+    EXPECT_EQ(make_iterator_range(v.begin() + 5, v.end()), upper);
+    EXPECT_EQ(3u, upper.grainsize());
+
+    decltype(range) quarter(range, split());
+
+    EXPECT_EQ(2u, range.size());
+    EXPECT_EQ(3u, quarter.size());
+    EXPECT_FALSE(range.is_divisible());
+    EXPECT_FALSE(quarter.is_divisible());
+    EXPECT_EQ(sizeof(iterator_range<std::vector<int>::iterator>) + sizeof(std::size_t), sizeof(range));
+}
+
+TEST(IteratorBasedForTest, IndexBoundsAndDivisibility)
+{
+    std::vector<int> v({1, 2, 3, 4, 5});
+    auto range = (v.begin() + 1, v.end());
+    long sum = 0;
+
+    EXPECT_EQ(4, range.ssize());
+    EXPECT_TRUE((std::is_same<std::ptrdiff_t, decltype(range.ssize())>::value));
+
+    for (std::ptrdiff_t i = 0; i < range.ssize(); ++i) {
+        sum += range[i];
+    }
+
+    EXPECT_EQ(14, sum);
+    EXPECT_TRUE(range.is_divisible());
+    EXPECT_FALSE((v.begin(), v.begin() + 1).is_divisible());
+    EXPECT_FALSE((v.end(), v.end()).is_divisible());
+    EXPECT_EQ(0, (v.end(), v.end()).ssize());
+}
+
+#if ITERATOR_BASED_FOR_HAS_STD_RANGES
+TEST(IteratorBasedForTest, StdRangesViews)
+{
+    using vector_range = iterator_range<std::vector<int>::iterator>;
+
+    static_assert(std::ranges::view<vector_range> && std::ranges::borrowed_range<vector_range>);
+    static_assert(std::ranges::contiguous_range<vector_range> && std::ranges::sized_range<vector_range>);
+    static_assert(std::ranges::view<iterator_range<std::list<int>::iterator>>);
+    static_assert(std::ranges::view<iterator_range<char*, null_sentinel>>);
+    static_assert(std::ranges::view<blocked_iterator_range<int*>>);
+    static_assert(std::ranges::borrowed_range<blocked_iterator_range<int*>>);
+
+    std::vector<int> v({3, 1, 4, 1, 5});
+    std::ranges::sort((v.begin(), v.begin() + 3));
+    EXPECT_EQ(std::vector<int>({1, 3, 4, 1, 5}), v);
+
+    //A borrowed range returns an iterator into v rather than std::ranges::dangling from a temporary range.
+    auto found = std::ranges::find(vector_range(v.begin(), v.end()), 4);
+    EXPECT_EQ(v.begin() + 2, found);
+
+    auto tail = (v.begin(), v.end()) | std::views::drop(3);
+    EXPECT_EQ(2, std::ranges::distance(tail));
+    EXPECT_EQ(1, tail.front());
+}
+#endif
+
+namespace
+{
+    std::size_t sum_bytes(span<const char> _bytes) {
+        std::size_t sum = 0;
+
+        for (char c : _bytes) {
+            sum += static_cast<unsigned char>(c);
+        }
+
+        return sum;
+    }
+}
+
+TEST(IteratorBasedForTest, SpanConversion)
+{
+    std::vector<int> v({1, 2, 3, 4});
+    auto all = to_span((v.begin(), v.end()));
+    EXPECT_EQ(v.data(), all.data());
+    EXPECT_EQ(4u, all.size());
+
+    span<const int> tail = (v.cbegin() + 1, v.cend()).as_span();
+    EXPECT_EQ(v.data() + 1, tail.data());
+    EXPECT_EQ(3u, tail.size());
+
+    span<const int> converted = (v.begin() + 2, v.end());
+    EXPECT_EQ(3, converted[0]);
+
+    std::string s("abc");
+    EXPECT_EQ(294u, sum_bytes((s.cbegin(), s.cend())));
+
+    EXPECT_TRUE((std::is_convertible<iterator_range<std::vector<int>::iterator>, span<const int>>::value));
+    EXPECT_FALSE((std::is_convertible<iterator_range<std::vector<int>::const_iterator>, span<int>>::value));
+    EXPECT_FALSE((std::is_convertible<iterator_range<std::deque<int>::iterator>, span<int>>::value));
+    EXPECT_FALSE((std::is_convertible<iterator_range<char*, null_sentinel>, span<char>>::value));
+
+#if ITERATOR_BASED_FOR_HAS_STD_SPAN
+    std::span<const int> standard = (v.begin(), v.end());
+    EXPECT_EQ(v.data(), standard.data());
+    EXPECT_EQ(4u, standard.size());
+
+    std::span<int> from_span = all;
+    EXPECT_EQ(4u, from_span.size());
+#endif
+}
+
+TEST(IteratorBasedForTest, CountedRanges)
+{
+    std::list<int> l({1, 2, 3, 4, 5});
+    std::vector<int> seen;
+
+    for (int x : std::next(l.begin()), counted(3)) {
+        seen.push_back(x);
+    }
+
+    EXPECT_EQ(std::vector<int>({2, 3, 4}), seen);
+
+    auto list_range = (l.begin(), counted(4));
+    EXPECT_EQ(4, std::distance(list_range.begin(), list_range.end()));
+    EXPECT_EQ(1, list_range.front());
+    EXPECT_FALSE(has_size<decltype(list_range)>::value);
+    EXPECT_FALSE(is_bidirectional_iterator<decltype(list_range.begin())>::value);
+
+    std::vector<int> v({10, 20, 30, 40});
+    auto vector_range = (v.begin() + 1, counted(2));
+    EXPECT_EQ(2u, vector_range.size());
+    EXPECT_EQ(30, vector_range[1]);
+    EXPECT_TRUE(vector_range.end() == vector_range.begin() + 2);
+    EXPECT_EQ(v.begin() + 2, (vector_range.begin() + 1).base());
+    EXPECT_EQ(30, vector_range.back());
+    EXPECT_EQ(v.begin() + 3, vector_range.end().base());
+
+    int a[] = {7, 8, 9};
+    int sum = 0;
+
+    for (int& x : a + 1, counted(2)) {
+        sum += x;
+        x = 0;
+    }
+
+    EXPECT_EQ(17, sum);
+    EXPECT_EQ(0, a[2]);
+    EXPECT_TRUE((a, counted(0)).empty());
+
+    std::istringstream stream("1 2 3 4");
+    std::vector<int> read;
+
+    for (int x : std::istream_iterator<int>(stream), counted(2)) {
+        read.push_back(x);
+    }
+
+    EXPECT_EQ(std::vector<int>({1, 2}), read);
+}
+
+TEST(IteratorBasedForTest, CountingRanges)
+{
+    std::vector<int> seen;
+
+    for (auto i : iota(2, 6)) {
+        seen.push_back(i);
+    }
+
+    EXPECT_EQ(std::vector<int>({2, 3, 4, 5}), seen);
+    EXPECT_TRUE(iota(5, 2).empty());
+    EXPECT_TRUE(iota(3, 3).empty());
+
+    std::size_t n = 10;
+    auto wide = iota(0, n);
+    EXPECT_TRUE((std::is_same<std::size_t, decltype(*wide.begin())>::value));
+    EXPECT_EQ(10u, wide.size());
+    EXPECT_EQ(7u, wide[7]);
+
+    auto narrow = iota<std::int32_t>(0, n);
+    EXPECT_TRUE((std::is_same<std::int32_t, decltype(*narrow.begin())>::value));
+    EXPECT_EQ(45, std::accumulate(narrow.begin(), narrow.end(), 0));
+    EXPECT_EQ(9, narrow.back());
+    EXPECT_EQ(3, *std::lower_bound(narrow.begin(), narrow.end(), 3));
+
+    auto negative = iota(-3, 2);
+    EXPECT_EQ(5u, negative.size());
+    EXPECT_EQ(-3, negative.front());
+}
+
+namespace
+{
+    constexpr int squares[] = {0, 1, 4, 9, 16, 25, 36, 49};
+
+    constexpr int constant_sum(iterator_range<const int*> _range) {
+        int total = 0;
+
+        for (int x : _range) {
+            total += x;
+        }
+
+        return total;
+    }
+
+    struct lookup_table {
+        int values[4];
+    };
+
+    constexpr lookup_table prefix_sums(iterator_range<const int*> _range) {
+        lookup_table table = {{0, 0, 0, 0}};
+        int total = 0;
+
+        for (std::size_t i = 0; i < _range.size() && i < 4; ++i) {
+            total += _range[i];
+            table.values[i] = total;
+        }
+
+        return table;
+    }
+
+    struct throwing_iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = int;
+
+        throwing_iterator() { }
+        throwing_iterator(const throwing_iterator&) { }
+        throwing_iterator& operator=(const throwing_iterator&) { return *this; }
+
+        int operator*() const { return 0; }
+        throwing_iterator& operator++() { return *this; }
+        bool operator==(const throwing_iterator&) const { return true; }
+        bool operator!=(const throwing_iterator&) const { return false; }
+    };
+}
+
+TEST(IteratorBasedForTest, ConstantEvaluation)
+{
+    constexpr auto middle = ptr_range(squares).drop(2).take(4);
+    static_assert(middle.size() == 4 && !middle.empty(), "sub-ranges of constexpr arrays are constant expressions");
+    static_assert(middle.front() == 4 && middle[3] == 25, "element access is a constant expression");
+    static_assert(constant_sum(middle) == 54, "ranges can be iterated in constant evaluation");
+
+    constexpr lookup_table table = prefix_sums(ptr_range(squares).slice(1, 5));
+    static_assert(table.values[0] == 1 && table.values[3] == 30, "tables can be built from sub-ranges");
+
+    constexpr auto indices = (counting_iterator<int>(2), counting_iterator<int>(6));
+    static_assert(indices.size() == 4 && indices == iota(2, 6), "comma ranges are constant expressions");
+    static_assert(*indices.begin() == 2 && indices.back() == 5, "comma ranges can be iterated at compile time");
+
+    static_assert(noexcept(ptr_range(squares)), "pointer ranges are built without exceptions");
+    static_assert(noexcept((counting_iterator<int>(0), counting_iterator<int>(1))), "so are counting ranges");
+    static_assert(noexcept(std::declval<const iterator_range<const int*>&>().begin()), "begin() does not throw");
+
+    EXPECT_EQ(54, constant_sum(middle));
+    EXPECT_EQ(30, table.values[3]);
+}
+
+TEST(IteratorBasedForTest, NoexceptPropagation)
+{
+    using vector_range = iterator_range<std::vector<int>::iterator>;
+    std::vector<int> v = {1, 2, 3};
+    std::list<int> l = {1, 2, 3};
+    const vector_range range = (v.begin(), v.end());
+
+    static_assert(noexcept((v.begin(), v.end())), "the comma overload does not throw for vector iterators");
+    static_assert(noexcept((l.begin(), l.end())), "nor for list iterators");
+    static_assert(noexcept(make_iterator_range(v.begin(), v.end())), "make_iterator_range is noexcept");
+    static_assert(noexcept((l.begin(), counted(2))), "counted ranges are noexcept");
+    static_assert(noexcept(range.begin()) && noexcept(range.end()) && noexcept(range.size()), "accessors are noexcept");
+    static_assert(noexcept(range.empty()) && noexcept(range.front()) && noexcept(range[0]), "so is element access");
+    static_assert(noexcept(range.take(1)) && noexcept(range.drop(1)) && noexcept(range.slice(0, 1)),
+                  "slicing ranges of nothrow iterators is noexcept");
+    static_assert(noexcept(range == range) && noexcept(range.data()), "comparison and data() are noexcept");
+    static_assert(std::is_nothrow_move_constructible<vector_range>::value
+                  && std::is_nothrow_copy_constructible<vector_range>::value,
+                  "ranges move without throwing, so containers of ranges take the move_if_noexcept path");
+
+    static_assert(!noexcept((throwing_iterator(), throwing_iterator())), "throwing copies propagate");
+    static_assert(!noexcept(make_iterator_range(throwing_iterator(), throwing_iterator())), "to every factory");
+    static_assert(!noexcept(std::declval<const iterator_range<throwing_iterator>&>().begin()), "and accessor");
+    static_assert(!noexcept(std::declval<const iterator_range<throwing_iterator>&>().take(1)), "and slice");
+
+    std::vector<vector_range> ranges(1, range);
+    ranges.reserve(16);
+    EXPECT_EQ(3u, ranges.front().size());
+}
+
+TEST(IteratorBasedForTest, StaticRanges)
+{
+    float position[3] = {1.0f, 2.0f, 3.0f};
+    auto coordinates = make_static_range(position);
+    static_assert(std::is_same<static_range<float*, 3>, decltype(coordinates)>::value, "arrays give their extent");
+    static_assert(decltype(coordinates)::size() == 3 && decltype(coordinates)::extent == 3, "the size is constant");
+
+    float length = 0.0f;
+    coordinates.for_each([&length](float x) { length += x * x; });
+    EXPECT_EQ(14.0f, length);
+
+    float scaled[3] = {};
+    coordinates.for_each_indexed([&scaled](float x, std::size_t i) { scaled[i] = 2.0f * x; });
+    EXPECT_EQ(6.0f, scaled[2]);
+
+    //The index is a constant expression.
+    std::array<int, 4> lanes = {{1, 2, 3, 4}};
+    std::tuple<int, long, short, char> mixed;
+    make_static_range(lanes).for_each_indexed([&mixed](int x, auto i) { std::get<decltype(i)::value>(mixed) = x; });
+    EXPECT_EQ(3, std::get<2>(mixed));
+
+    for (int& lane : make_static_range(lanes)) {
+        lane *= 10;
+    }
+
+    const std::array<int, 4>& constant_lanes = lanes;
+    auto counter = make_static_range(constant_lanes).for_each([](int) { });
+    (void)counter;
+    auto constant_range = make_static_range(constant_lanes);
+    EXPECT_EQ(100, std::accumulate(constant_range.begin(), constant_range.end(), 0));
+
+    //Fixed windows of longer ranges, which still work wherever an iterator_range does.
+    std::vector<int> packet(16);
+    std::iota(packet.begin(), packet.end(), 0);
+    auto window = make_static_range<8>(packet.begin() + 4);
+    const iterator_range<std::vector<int>::iterator>& base = window;
+    EXPECT_EQ(8u, base.size());
+    EXPECT_EQ(11, window.back());
+    int visited = 0;
+    window.for_each([&visited](int x) { visited += x; });
+    EXPECT_EQ(60, visited);
+
+    constexpr auto table = make_static_range(squares);
+    static_assert(table.size() == 8 && table.back() == 49 && table[3] == 9, "static ranges are constexpr");
+    EXPECT_TRUE(make_static_range<0>(packet.begin()).empty());
+}
+
+TEST(IteratorBasedForTest, StatelessSentinelsTakeNoSpace)
+{
+    struct end_of_stream {
+        bool operator!=(const end_of_stream&) const { return false; }
+    };
+
+    static_assert(sizeof(iterator_range<const char*, null_sentinel>) == sizeof(const char*), "null_sentinel is free");
+    static_assert(sizeof(iterator_range<int*, end_of_stream>) == sizeof(int*), "so is any other empty sentinel");
+    static_assert(sizeof(iterator_range<int*>) == 2 * sizeof(int*), "iterators are still stored");
+    static_assert(sizeof(iterator_range<end_of_stream>) == 2, "two equal empty objects cannot share an address");
+
+    const char* text = "sentinel";
+    auto c_string = (text, null_sentinel());
+    EXPECT_EQ(text, c_string.begin());
+    EXPECT_EQ("nel", std::string(c_string.drop(5).begin(), text + 8));
+    EXPECT_TRUE((c_string == iterator_range<const char*, null_sentinel>(text, null_sentinel())));
+    EXPECT_FALSE(c_string.empty());
+}
+
+TEST(IteratorBasedForTest, PointerRanges)
+{
+    EXPECT_TRUE(is_comma_left_operand<int*>::value);
+    EXPECT_TRUE(is_comma_left_operand<const char*>::value);
+    EXPECT_TRUE(is_comma_left_operand<std::vector<int>::iterator>::value);
+    EXPECT_FALSE(is_comma_left_operand<int>::value);
+    EXPECT_FALSE(is_comma_left_operand<void*>::value);
+    EXPECT_FALSE(is_comma_left_operand<void (*)()>::value);
+
+    int a[] = {1, 2, 3, 4};
+    const int* p = a;
+
+    auto all = ptr_range(a);
+    EXPECT_TRUE((std::is_same<iterator_range<int*>, decltype(all)>::value));
+    EXPECT_EQ(4u, all.size());
+    EXPECT_EQ(a, all.data());
+
+    auto middle = ptr_range(p + 1, p + 3);
+    EXPECT_EQ(std::vector<int>({2, 3}), std::vector<int>(middle.begin(), middle.end()));
+
+    auto counted_buffer = ptr_range(p, std::size_t(3));
+    EXPECT_EQ(6, std::accumulate(counted_buffer.begin(), counted_buffer.end(), 0));
+    EXPECT_EQ(2u, ptr_range(a).drop(2).size());
+    EXPECT_EQ(3, to_span(ptr_range(a))[2]);
+
+    const char* text = "abc";
+    auto c_string = (text, null_sentinel());
+    std::string joined;
+
+    for (auto it = c_string.begin(); it != c_string.end(); ++it) {
+        joined += *it;
+    }
+
+    EXPECT_EQ("abc", joined);
+}
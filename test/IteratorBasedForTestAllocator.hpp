@@ -0,0 +1,43 @@
+#ifndef IteratorBasedForTestAllocator_H
+#define IteratorBasedForTestAllocator_H
+
+#include <cstddef>
+#include <memory>
+
+namespace IteratorBasedForTest
+{
+
+    /**
+     * @brief Allocator counting the allocations it makes that are still live.
+     */
+    template <typename T>
+    struct counting_allocator {
+        using value_type = T;
+
+        std::size_t* allocations;
+
+        explicit counting_allocator(std::size_t* _allocations) : allocations(_allocations) { }
+
+        template <typename U>
+        counting_allocator(const counting_allocator<U>& other) : allocations(other.allocations) { }
+
+        T* allocate(std::size_t n) {
+            ++*allocations;
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T* p, std::size_t n) {
+            --*allocations;
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        template <typename U>
+        bool operator==(const counting_allocator<U>& other) const { return allocations == other.allocations; }
+
+        template <typename U>
+        bool operator!=(const counting_allocator<U>& other) const { return allocations != other.allocations; }
+    };
+
+} // namespace IteratorBasedForTest
+
+#endif // IteratorBasedForTestAllocator_H
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include <IteratorBasedForTraits.hpp>
+
+#include <list>
+#include <vector>
+
+#ifdef IteratorBasedFor_H
+#error "IteratorBasedForTraits.hpp must not include the ranges and the comma overload"
+#endif
+
+using namespace IteratorBasedForImpl;
+
+namespace
+{
+
+    /**
+     * @brief A type whose address-of operator is overloaded to return something other than its address.
+     */
+    struct overloaded_address {
+        int value;
+
+        int operator&() const { return 0; }
+    };
+
+} // namespace
+
+TEST(IteratorBasedForTraitsTest, TraitsAreUsableWithoutTheRanges) {
+    static_assert(is_iterator<std::vector<int>::iterator>::value, "vector iterators are iterators");
+    static_assert(is_iterator<std::list<int>::const_iterator>::value, "list iterators are iterators");
+    static_assert(!is_iterator<int*>::value, "pointers are left to the built-in comma operator");
+    static_assert(!is_iterator<int>::value, "integers are not iterators");
+    static_assert(is_comma_left_operand<int*>::value, "pointers may precede a sentinel");
+    static_assert(is_sentinel_for<null_sentinel, const char*>::value, "null_sentinel ends C strings");
+    static_assert(is_random_access_iterator<std::vector<int>::iterator>::value, "vector iterators are random access");
+    static_assert(!is_random_access_iterator<std::list<int>::iterator>::value, "list iterators are bidirectional");
+    static_assert(is_contiguous_iterator<std::vector<int>::iterator>::value, "vector iterators are contiguous");
+
+    overloaded_address object = {42};
+    EXPECT_EQ(&object.value, &IteratorBasedForImpl::addressof(object)->value);
+
+    std::vector<int> v = {1, 2, 3};
+    EXPECT_EQ(v.data(), IteratorBasedForImpl::to_address(v.begin()));
+    EXPECT_EQ(v.data() + 3, IteratorBasedForImpl::to_address(v.end()));
+}
@@ -0,0 +1,129 @@
+#define ITERATOR_BASED_FOR_CHECKED
+#include <gtest/gtest.h>
+#include <IteratorBasedForAdaptors.hpp>
+
+#include <algorithm>
+#include <list>
+#include <numeric>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+namespace
+{
+    //A container that invalidates its iterators whenever it may reallocate and hands out checked iterators itself.
+    struct tracked_vector {
+        std::vector<int> values;
+        generation_counter generation;
+
+        tracked_vector() : values(), generation() { }
+
+        void push_back(int _value) {
+            if (values.size() == values.capacity()) {
+                generation.invalidate();
+            }
+
+            values.push_back(_value);
+        }
+
+        checked_iterator<std::vector<int>::iterator> checked_begin() {
+            return make_checked_iterator(values.begin(), generation);
+        }
+
+        checked_iterator<std::vector<int>::iterator> checked_end() {
+            return make_checked_iterator(values.end(), generation);
+        }
+    };
+}
+
+TEST(IteratorBasedForCheckedTest, IteratesValidRanges)
+{
+    tracked_vector v;
+
+    for (int i = 0; i < 100; ++i) {
+        v.push_back(i);
+    }
+
+    int sum = 0;
+
+    for (int x : checked((v.values.begin(), v.values.end()), v.generation)) {
+        sum += x;
+    }
+
+    EXPECT_EQ(4950, sum);
+
+    auto range = checked((v.values.begin(), v.values.end()), v.generation);
+    EXPECT_EQ(100u, range.size());
+    EXPECT_EQ(99, range[99]);
+    EXPECT_EQ(v.values.end() - 1, std::max_element(range.begin(), range.end()).base());
+
+    std::list<int> l(10, 1);
+    generation_counter list_generation;
+    EXPECT_EQ(10, std::accumulate(checked((l.begin(), l.end()), list_generation).begin(),
+                                  checked((l.begin(), l.end()), list_generation).end(), 0));
+
+    //Modifications that keep iterators valid do not invalidate them.
+    v.values.reserve(200);
+    v.generation.invalidate();
+    auto reserved = checked((v.values.begin(), v.values.end()), v.generation);
+    v.push_back(100);
+    EXPECT_EQ(0, *reserved.begin());
+}
+
+TEST(IteratorBasedForCheckedTest, DetectsInvalidation)
+{
+    tracked_vector v;
+    v.push_back(1);
+
+    auto range = checked((v.values.begin(), v.values.end()), v.generation);
+    auto it = range.begin();
+    EXPECT_EQ(1, *it);
+
+    for (int i = 0; i < 100; ++i) {
+        v.push_back(i);
+    }
+
+    EXPECT_THROW(*it, invalid_iterator_error);
+    EXPECT_THROW(++it, invalid_iterator_error);
+
+    //Modifying the container from inside the loop is caught at the next step.
+    EXPECT_THROW({
+        for (int x : checked((v.values.begin(), v.values.end()), v.generation)) {
+            v.push_back(x);
+        }
+    }, invalid_iterator_error);
+
+    //A copy of the owner starts its own history, and assigning to it invalidates its iterators.
+    tracked_vector copy = v;
+    auto copied = checked((copy.values.begin(), copy.values.end()), copy.generation);
+    EXPECT_EQ(1, *copied.begin());
+    copy = v;
+    EXPECT_THROW(*copied.begin(), invalid_iterator_error);
+}
+
+TEST(IteratorBasedForCheckedTest, DetectsMixedContainers)
+{
+    tracked_vector a;
+    tracked_vector b;
+    a.push_back(1);
+    b.push_back(2);
+
+    EXPECT_THROW({
+        for (int x : a.checked_begin(), b.checked_end()) {
+            (void)x;
+        }
+    }, invalid_iterator_error);
+    EXPECT_THROW(a.checked_end() - b.checked_begin(), invalid_iterator_error);
+
+    std::vector<int> values(10);
+    generation_counter generation;
+    EXPECT_THROW(checked((values.end(), values.begin()), generation), invalid_iterator_error);
+
+    int sum = 0;
+
+    for (int x : a.checked_begin(), a.checked_end()) {
+        sum += x;
+    }
+
+    EXPECT_EQ(1, sum);
+}
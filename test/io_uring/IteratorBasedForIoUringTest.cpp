@@ -0,0 +1,176 @@
+#define ITERATOR_BASED_FOR_USE_IO_URING
+#include <gtest/gtest.h>
+#include <IteratorBasedForIO.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdlib.h>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+#if ITERATOR_BASED_FOR_HAS_IO_URING
+namespace
+{
+    std::string write_temporary_file(const std::string& _contents) {
+        char path[] = "/tmp/iterator_based_for_XXXXXX";
+        const int descriptor = mkstemp(path);
+
+        if (descriptor >= 0) {
+            EXPECT_EQ(static_cast<ssize_t>(_contents.size()), ::write(descriptor, _contents.data(), _contents.size()));
+            ::close(descriptor);
+        }
+
+        return path;
+    }
+
+    //Whether the kernel lets this process set up a ring, which containers may forbid.
+    bool ring_available() {
+        try {
+            read_ring ring(4);
+            return ring.entries() >= 4;
+        } catch (const std::system_error&) {
+            return false;
+        }
+    }
+}
+
+TEST(IteratorBasedForIoUringTest, ReadsThroughTheRingOrFallsBack)
+{
+    std::vector<std::int32_t> values(100000);
+
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<std::int32_t>(i);
+    }
+
+    const std::string path = write_temporary_file(
+            std::string(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(std::int32_t)) + "xy");
+
+    //Blocks that do not hold whole records, a single slot, and the pread threads taking over when asked to.
+    for (bool use_io_uring : {true, false}) {
+        for (std::size_t block_size : {std::size_t(1), std::size_t(4094), std::size_t(65536), std::size_t(1) << 20}) {
+            for (std::size_t depth : {std::size_t(1), std::size_t(4), std::size_t(7)}) {
+                SCOPED_TRACE(std::to_string(use_io_uring) + "/" + std::to_string(block_size) + "/"
+                             + std::to_string(depth));
+
+                async_file_options options;
+                options.block_size = block_size;
+                options.depth = depth;
+                options.use_io_uring = use_io_uring;
+
+                async_file_range<std::int32_t> records(path, options);
+                EXPECT_EQ(use_io_uring && ring_available(), records.uses_io_uring());
+
+                std::vector<std::int32_t> read;
+
+                for (std::int32_t x : records) {
+                    read.push_back(x);
+                }
+
+                EXPECT_TRUE(read == values);
+            }
+        }
+    }
+
+    //Stopping part way through waits for the reads still in flight.
+    async_file_options options;
+    options.block_size = 4096;
+    async_file_range<std::int32_t> partial(path, options);
+    std::size_t seen = 0;
+
+    for (auto it = partial.begin(); it != partial.end() && seen < 10; ++it) {
+        EXPECT_EQ(static_cast<std::int32_t>(seen), *it);
+        ++seen;
+    }
+
+    EXPECT_EQ(10u, seen);
+
+    //A descriptor closed part way through fails the reads issued after it, which the iteration reports once it
+    //reaches them. The blocks before come through whole, and destroying the range waits for the reads in flight.
+    for (bool use_io_uring : {true, false}) {
+        SCOPED_TRACE(use_io_uring);
+
+        const int descriptor = ::open(path.c_str(), O_RDONLY);
+        ASSERT_LE(0, descriptor);
+
+        async_file_options failing;
+        failing.block_size = 4096;
+        failing.use_io_uring = use_io_uring;
+        std::size_t read = 0;
+
+        {
+            async_file_range<std::int32_t> records(descriptor, failing);
+            auto it = records.begin();
+
+            for (; read < 10; ++it, ++read) {
+                EXPECT_EQ(static_cast<std::int32_t>(read), *it);
+            }
+
+            ::close(descriptor);
+
+            EXPECT_THROW({
+                for (; it != records.end(); ++it, ++read) {
+                    EXPECT_EQ(static_cast<std::int32_t>(read), *it);
+                }
+            }, std::system_error);
+        }
+
+        //The increment leaving the last record of the last whole block is the one that throws.
+        EXPECT_LT(read, values.size());
+        EXPECT_EQ(0u, (read + 1) % (4096 / sizeof(std::int32_t)));
+    }
+
+    std::remove(path.c_str());
+
+    const std::string empty_path = write_temporary_file("");
+    async_file_range<char> empty(empty_path);
+    EXPECT_TRUE(empty.begin() == empty.end());
+    std::remove(empty_path.c_str());
+
+    //A failed read completes with an errno value, rethrown from the iteration as with pread.
+    async_file_range<char> unreadable(-1);
+    EXPECT_THROW(unreadable.begin(), std::system_error);
+}
+
+TEST(IteratorBasedForIoUringTest, CancelsReadsInFlight)
+{
+    if (!ring_available()) {
+        return;
+    }
+
+    //Reads from an empty pipe stay in flight until they are cancelled.
+    int ends[2];
+    ASSERT_EQ(0, ::pipe(ends));
+
+    read_ring ring(2);
+    char buffers[2][16];
+    ring.read(ends[0], buffers[0], sizeof(buffers[0]), 0, 0);
+    ring.read(ends[0], buffers[1], sizeof(buffers[1]), 0, 1);
+    ring.submit();
+    EXPECT_EQ(2u, ring.pending());
+
+    ring.cancel();
+    EXPECT_TRUE(ring.drain());
+    EXPECT_EQ(0u, ring.pending());
+
+    //The ring is still usable afterwards.
+    ASSERT_EQ(3, ::write(ends[1], "abc", 3));
+    ring.read(ends[0], buffers[0], sizeof(buffers[0]), 0, 0);
+    ring.wait();
+
+    int result = 0;
+    ring.collect([&result](unsigned _tag, int _result) {
+        EXPECT_EQ(0u, _tag);
+        result = _result;
+    });
+
+    EXPECT_EQ(3, result);
+    EXPECT_EQ(0, std::string(buffers[0], 3).compare("abc"));
+
+    ::close(ends[0]);
+    ::close(ends[1]);
+}
+#endif
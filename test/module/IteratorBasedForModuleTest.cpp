@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <numeric>
+#include <vector>
+
+import iterator_based_for;
+
+using namespace IteratorBasedForImpl;
+
+TEST(IteratorBasedForModuleTest, ImportedCommaOverloadBuildsRanges)
+{
+    std::vector<int> v(10);
+    std::iota(v.begin(), v.end(), 1);
+
+    int sum = 0;
+
+    for (int x : v.begin() + 2, v.end() - 2) {
+        sum += x;
+    }
+
+    EXPECT_EQ(3 + 4 + 5 + 6 + 7 + 8, sum);
+
+    std::list<int> l(v.begin(), v.end());
+    auto range = (l.begin(), l.end());
+    EXPECT_EQ(10, std::distance(range.begin(), range.end()));
+    EXPECT_EQ(1, range.front());
+}
+
+TEST(IteratorBasedForModuleTest, ImportedTraitsAndRanges)
+{
+    static_assert(is_iterator<std::vector<int>::iterator>::value, "vector iterators are iterators");
+    static_assert(!is_iterator<int*>::value, "pointers are left to the built-in comma operator");
+    static_assert(is_sentinel_for<null_sentinel, const char*>::value, "null_sentinel ends C strings");
+
+    std::int64_t total = 0;
+
+    for (std::int64_t i : iota<std::int64_t>(0, 100)) {
+        total += i;
+    }
+
+    EXPECT_EQ(4950, total);
+
+    const char* text = "module";
+    std::size_t length = 0;
+
+    for (char c : (text, null_sentinel())) {
+        length += c != '\0';
+    }
+
+    EXPECT_EQ(6u, length);
+
+    int array[4] = {1, 2, 3, 4};
+    EXPECT_EQ(10, std::accumulate(ptr_range(array).begin(), ptr_range(array).end(), 0));
+    EXPECT_EQ(4u, make_static_range(array).size());
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <IteratorBasedForMpi.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+namespace
+{
+
+    int world_rank() {
+        int rank = 0;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        return rank;
+    }
+
+    int world_size() {
+        int ranks = 1;
+        MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+        return ranks;
+    }
+
+    /**
+     * @brief Pair of the smallest and largest value seen, combined by an operation MPI does not know.
+     */
+    struct bounds {
+        long low;
+        long high;
+    };
+
+} // namespace
+
+TEST(IteratorBasedForMpiTest, PartitionCoversIndexSpace)
+{
+    for (std::size_t n : {0u, 1u, 7u, 1000u}) {
+        mpi_partition partition(n);
+        std::size_t covered = 0;
+
+        EXPECT_EQ(world_rank(), partition.rank());
+        EXPECT_EQ(world_size(), partition.ranks());
+
+        for (int r = 0; r < partition.ranks(); ++r) {
+            EXPECT_EQ(covered, partition.first(r));
+            EXPECT_GE(1u, partition.count(r) - partition.count(partition.ranks() - 1));
+
+            for (std::size_t i = partition.first(r); i < partition.first(r) + partition.count(r); ++i) {
+                EXPECT_EQ(r, partition.owner(i));
+            }
+
+            covered += partition.count(r);
+        }
+
+        EXPECT_EQ(n, covered);
+    }
+
+    std::vector<int> v(10);
+    auto local = partition((v.begin(), v.end()));
+    EXPECT_EQ(mpi_partition(10).count(), local.size());
+    EXPECT_EQ(static_cast<std::ptrdiff_t>(mpi_partition(10).first()), local.begin() - v.begin());
+}
+
+TEST(IteratorBasedForMpiTest, ReduceCombinesAllRanks)
+{
+    auto policy = distributed(execution::par);
+    auto indices = iota(0L, 100001L);
+
+    std::atomic<long> visited(0);
+    for_each(policy, indices, [&visited](long) { ++visited; });
+
+    long total = 0;
+    MPI_Allreduce(&visited, &total, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+    EXPECT_EQ(100001L, total);
+
+    EXPECT_EQ(5000050000L + 7, reduce(policy, indices, 7L));
+    EXPECT_EQ(5000050000L * 2, transform_reduce(policy, indices, 0L, std::plus<long>(), [](long i) { return 2 * i; }));
+    EXPECT_EQ(0, reduce(distributed(execution::seq), iota(0, 0), 0));
+
+    //Operations MPI does not know are combined from the gathered partial results.
+    bounds result = transform_reduce(policy, indices, bounds{50, 50}, [](bounds a, bounds b) {
+        return bounds{std::min(a.low, b.low), std::max(a.high, b.high)};
+    }, [](long i) { return bounds{i, i}; });
+
+    EXPECT_EQ(0L, result.low);
+    EXPECT_EQ(100000L, result.high);
+}
+
+TEST(IteratorBasedForMpiTest, ScansContinueAcrossRanks)
+{
+    auto policy = distributed(execution::par);
+    std::vector<long> v(10007);
+    std::iota(v.begin(), v.end(), 1L);
+    std::vector<long> out(v.size(), -1);
+
+    EXPECT_EQ(out.end(), inclusive_scan(policy, (v.cbegin(), v.cend()), out.begin()));
+
+    //Every rank writes its own block of the output.
+    mpi_partition partition(v.size());
+    for (std::size_t i = partition.first(); i < partition.first() + partition.count(); ++i) {
+        EXPECT_EQ(static_cast<long>((i + 1) * (i + 2) / 2), out[i]);
+    }
+
+    EXPECT_EQ(out.end(), exclusive_scan(policy, (v.cbegin(), v.cend()), out.begin(), 100L));
+
+    for (std::size_t i = partition.first(); i < partition.first() + partition.count(); ++i) {
+        EXPECT_EQ(static_cast<long>(100 + i * (i + 1) / 2), out[i]);
+    }
+}
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+
+    const int result = RUN_ALL_TESTS();
+    int failed = 0;
+    MPI_Allreduce(&result, &failed, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+
+    MPI_Finalize();
+    return failed;
+}
@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include <IteratorBasedFor.hpp>
+
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+TEST(IteratorBasedForOpenMPTest, IndexLoopOverRange)
+{
+    std::vector<int> v(10000);
+    std::iota(v.begin(), v.end(), 0);
+    auto range = (v.begin() + 1, v.end());
+    long sum = 0;
+
+    #pragma omp parallel for reduction(+ : sum)
+    for (std::ptrdiff_t i = 0; i < range.ssize(); ++i) {
+        sum += range[i];
+    }
+
+    EXPECT_EQ(9999L * 10000L / 2, sum);
+}
+
+TEST(IteratorBasedForOpenMPTest, IteratorLoopOverRange)
+{
+    std::vector<int> v(10000, 1);
+    auto range = (v.begin(), v.end());
+
+    #pragma omp parallel for
+    for (auto it = range.begin(); it < range.end(); ++it) {
+        *it += 1;
+    }
+
+    EXPECT_EQ(20000, std::accumulate(v.begin(), v.end(), 0));
+}
@@ -0,0 +1,72 @@
+#define ITERATOR_BASED_FOR_PROFILE
+#include <gtest/gtest.h>
+#include <IteratorBasedFor.hpp>
+#include <IteratorBasedForAlgorithm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+TEST(IteratorBasedForProfileBuildTest, RecordsEveryCommaLoop)
+{
+    reset_loop_profile();
+
+    std::vector<int> v(1000);
+    std::vector<int> w(333);
+    long sum = 0;
+
+    for (int i = 0; i < 5; ++i) {
+        for (int& x : v.begin(), v.end()) {
+            x = i;
+        }
+
+        for (int x : w.cbegin(), w.cend()) {
+            sum += x;
+        }
+    }
+
+    EXPECT_EQ(0, sum);
+
+    //The two loops are told apart by where they call the comma operator.
+    std::vector<loop_statistics> profile = loop_profile();
+    auto first = std::find_if(profile.begin(), profile.end(),
+                              [](const loop_statistics& _loop) { return _loop.trips == 5000; });
+    auto second = std::find_if(profile.begin(), profile.end(),
+                               [](const loop_statistics& _loop) { return _loop.trips == 5 * 333; });
+    ASSERT_NE(profile.end(), first);
+    ASSERT_NE(profile.end(), second);
+    EXPECT_EQ(5u, first->calls);
+    EXPECT_EQ(5u, second->calls);
+    EXPECT_NE(first->site, second->site);
+
+    //Comma ranges still convert to and behave like plain ranges.
+    iterator_range<std::vector<int>::iterator> range = (v.begin(), v.end());
+    EXPECT_EQ(v.size(), range.size());
+    EXPECT_EQ(4, range.front());
+}
+
+TEST(IteratorBasedForProfileBuildTest, CountsRangesBySizeClass)
+{
+    reset_loop_profile();
+
+    std::vector<float> tiny(4, 1.0f);
+    std::vector<float> medium(1000, 1.0f);
+
+    for (int i = 0; i < 3; ++i) {
+        for_each(iterator_range<std::vector<float>::iterator>(tiny.begin(), tiny.end()), [](float& x) { x += 1.0f; });
+    }
+
+    for_each(iterator_range<std::vector<float>::iterator>(medium.begin(), medium.end()), [](float& x) { x += 1.0f; });
+
+    size_class_statistics statistics = size_class_profile();
+    EXPECT_EQ(tiny_range_threshold(), statistics.tiny_threshold);
+    EXPECT_EQ(parallel_range_threshold(), statistics.parallel_threshold);
+    EXPECT_EQ(3u, statistics.calls[static_cast<std::size_t>(size_class::tiny)]);
+    EXPECT_EQ(1u, statistics.calls[static_cast<std::size_t>(size_class::medium)]);
+    EXPECT_EQ(0u, statistics.calls[static_cast<std::size_t>(size_class::large)]);
+
+    reset_loop_profile();
+    EXPECT_EQ(0u, size_class_profile().calls[static_cast<std::size_t>(size_class::tiny)]);
+}
@@ -0,0 +1,82 @@
+#define ITERATOR_BASED_FOR_SCOPED_COMMA
+#include <gtest/gtest.h>
+#include <IteratorBasedForAlgorithm.hpp>
+#include <IteratorBasedForParallel.hpp>
+
+#include <iterator>
+#include <list>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+    //An iterator of the program, which opts into the comma syntax by deriving from the tag.
+    struct tagged_iterator : IteratorBasedForImpl::comma_syntax {
+        const int* p;
+
+        explicit tagged_iterator(const int* _p) : IteratorBasedForImpl::comma_syntax(), p(_p) { }
+
+        const int& operator*() const { return *p; }
+        tagged_iterator& operator++() { ++p; return *this; }
+        bool operator!=(const tagged_iterator& _other) const { return p != _other.p; }
+    };
+
+    //A class type of unrelated code, which keeps the built-in comma operator.
+    struct unrelated {
+        int value;
+    };
+
+    template <typename Iterator>
+    int sum_without_import(Iterator _first, Iterator _last) {
+        int sum = 0;
+
+        for (int x : _first, _last) {
+            sum += x;
+        }
+
+        return sum;
+    }
+}
+
+TEST(IteratorBasedForScopedCommaTest, StdIteratorsKeepTheBuiltInCommaUnlessImported)
+{
+    std::vector<int> v = {1, 2, 3};
+
+    static_assert(std::is_same<decltype((v.begin(), v.end())), std::vector<int>::iterator>::value,
+                  "the comma overload must not be found without importing it");
+    static_assert(std::is_same<decltype((unrelated(), unrelated())), unrelated>::value,
+                  "unrelated class types must keep the built-in comma operator");
+
+    using namespace IteratorBasedForImpl::syntax;
+    int sum = 0;
+
+    for (int x : v.cbegin(), v.cend()) {
+        sum += x;
+    }
+
+    EXPECT_EQ(6, sum);
+
+    std::list<int> l = {4, 5};
+    auto range = (l.cbegin(), l.cend());
+    EXPECT_EQ(2, std::distance(range.begin(), range.end()));
+}
+
+TEST(IteratorBasedForScopedCommaTest, LibraryAndTaggedIteratorsFindTheOverloadByArgumentDependentLookup)
+{
+    const int values[] = {1, 2, 3, 4};
+
+    EXPECT_EQ(10, sum_without_import(tagged_iterator(values), tagged_iterator(values + 4)));
+    EXPECT_EQ(6, sum_without_import(IteratorBasedForImpl::counting_iterator<int>(1),
+                                    IteratorBasedForImpl::counting_iterator<int>(4)));
+}
+
+TEST(IteratorBasedForScopedCommaTest, LibraryAlgorithmsCompileInScopedMode)
+{
+    using namespace IteratorBasedForImpl;
+    std::vector<int> v(1000);
+    std::iota(v.begin(), v.end(), 0);
+
+    EXPECT_EQ(499500, reduce(execution::par, (v.cbegin(), v.cend()), 0));
+    EXPECT_EQ(v.cbegin() + 10, find((v.cbegin(), v.cend()), 10));
+}
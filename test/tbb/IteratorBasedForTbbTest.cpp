@@ -0,0 +1,62 @@
+//TBB comes first so that iterator_range and blocked_iterator_range declare their tbb::split constructors.
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
+#include <gtest/gtest.h>
+#include <IteratorBasedFor.hpp>
+
+#include <atomic>
+#include <numeric>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+TEST(IteratorBasedForTbbTest, RangeSplitsInHalves)
+{
+    std::vector<int> v(9);
+    auto range = (v.begin(), v.end());
+    decltype(range) upper(range, tbb::split());
+
+    EXPECT_EQ(make_iterator_range(v.begin(), v.begin() + 4), range);
+    EXPECT_EQ(make_iterator_range(v.begin() + 4, v.end()), upper);
+
+    auto single = (v.begin(), v.begin() + 1);
+    EXPECT_FALSE(single.is_divisible());
+}
+
+TEST(IteratorBasedForTbbTest, ParallelForOverCommaRange)
+{
+    std::vector<int> v(100000);
+    std::iota(v.begin(), v.end(), 0);
+    std::atomic<long> pieces(0);
+
+    tbb::parallel_for((v.begin(), v.end()), [&pieces](const iterator_range<std::vector<int>::iterator>& _piece) {
+        for (int& x : _piece) {
+            x *= 2;
+        }
+
+        ++pieces;
+    });
+
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        ASSERT_EQ(static_cast<int>(2 * i), v[i]);
+    }
+
+    EXPECT_GE(pieces.load(), 1);
+}
+
+TEST(IteratorBasedForTbbTest, ParallelReduceOverBlockedRange)
+{
+    std::vector<long> v(50000);
+    std::iota(v.begin(), v.end(), 1);
+
+    long sum = tbb::parallel_reduce(
+            make_blocked_range((v.cbegin(), v.cend()), 256), 0L,
+            [](const blocked_iterator_range<std::vector<long>::const_iterator>& _piece, long _sum) {
+                return std::accumulate(_piece.begin(), _piece.end(), _sum);
+            },
+            [](long _lhs, long _rhs) { return _lhs + _rhs; });
+
+    EXPECT_EQ(50000L * 50001L / 2, sum);
+}
@@ -0,0 +1,86 @@
+#define ITERATOR_BASED_FOR_TRACE
+#include <gtest/gtest.h>
+#include <IteratorBasedForPipeline.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+using namespace IteratorBasedForImpl;
+
+namespace
+{
+    std::atomic<std::size_t> begun[4];
+    std::atomic<std::size_t> ended[4];
+    std::atomic<std::size_t> elements[4];
+    std::atomic<std::size_t> steals;
+
+    void reset_events() {
+        for (std::size_t i = 0; i < 4; ++i) {
+            begun[i] = 0;
+            ended[i] = 0;
+            elements[i] = 0;
+        }
+
+        steals = 0;
+    }
+
+    const trace_hooks counting_hooks = {
+            [](trace_task _task, std::size_t _elements) {
+                ++begun[static_cast<int>(_task)];
+                elements[static_cast<int>(_task)] += _elements;
+            },
+            [](trace_task _task) { ++ended[static_cast<int>(_task)]; },
+            [](std::size_t _thief, std::size_t _victim) {
+                EXPECT_NE(_thief, _victim);
+                ++steals;
+            }};
+}
+
+TEST(IteratorBasedForTraceTest, ReportsLoopPiecesAndChunks)
+{
+    reset_events();
+    set_trace_hooks(&counting_hooks);
+
+    thread_pool pool(2);
+    std::vector<int> v(10000, 1);
+    for_each(execution::par.on(pool), (v.begin(), v.end()), [](int& x) { x += 1; });
+
+    const int piece = static_cast<int>(trace_task::loop_piece);
+    EXPECT_LT(1u, begun[piece].load());
+    EXPECT_EQ(begun[piece].load(), ended[piece].load());
+    EXPECT_EQ(v.size(), elements[piece].load());
+
+    pool.run_chunks(5, [](std::size_t) { });
+    EXPECT_EQ(5u, begun[static_cast<int>(trace_task::chunk)].load());
+    EXPECT_EQ(5u, ended[static_cast<int>(trace_task::chunk)].load());
+
+    set_trace_hooks(nullptr);
+    for_each(execution::par.on(pool), (v.begin(), v.end()), [](int& x) { x += 1; });
+    EXPECT_EQ(begun[piece].load(), ended[piece].load());
+    EXPECT_EQ(v.size(), elements[piece].load());
+    EXPECT_EQ(3, v.front());
+}
+
+TEST(IteratorBasedForTraceTest, ReportsPipelineBatches)
+{
+    reset_events();
+    set_trace_hooks(&counting_hooks);
+
+    std::vector<int> v(1000);
+    std::iota(v.begin(), v.end(), 0);
+    long sum = 0;
+
+    pipeline((v.cbegin(), v.cend()), 100)
+            | stage([](int x) { return x * 2; }, execution::par, 2)
+            | sink([&sum](int x) { sum += x; });
+
+    set_trace_hooks(nullptr);
+
+    const int batch = static_cast<int>(trace_task::pipeline_batch);
+    EXPECT_EQ(999000, sum);
+    EXPECT_EQ(10u, begun[batch].load());
+    EXPECT_EQ(10u, ended[batch].load());
+    EXPECT_EQ(v.size(), elements[batch].load());
+}